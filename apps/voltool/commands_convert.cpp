@@ -27,11 +27,11 @@
  **********************************************************************/
 
 #include "commands_convert.h"
+#include "volumestreamconverter.h"
 #include "voreen/core/io/volumeserializer.h"
 #include "voreen/core/io/volumeserializerpopulator.h"
 #include "voreen/core/datastructures/volume/volumeatomic.h"
 #include "voreen/core/datastructures/volume/volumecollection.h"
-#include "voreen/core/datastructures/volume/operators/volumeoperatorconvert.h"
 #include "tgt/vector.h"
 
 #ifdef VRN_WITH_DEVIL
@@ -274,37 +274,23 @@ CommandConvert::CommandConvert() :
 }
 
 bool CommandConvert::execute(const std::vector<std::string>& parameters) {
-    VolumeHandle* targetDataset_ = 0;
-
-    VolumeSerializerPopulator volLoadPop;
-    const VolumeSerializer* serializer = volLoadPop.getVolumeSerializer();
-
-    VolumeCollection* volumeCollection = serializer->read(parameters[1]);
-    const VolumeHandleBase* sourceDataset_ = volumeCollection->first();
-
-    VolumeOperatorConvert voConvert;
+    // read, converted and written slab by slab in a single pass
+    VolumeStreamConverter converter;
     if (parameters[0] == "8") {
-        //targetDataset_ = new VolumeUInt8(sourceDataset_->getDimensions(), sourceDataset_->getSpacing(), sourceDataset_->getTransformation());
-        targetDataset_ = voConvert.apply<uint8_t>(sourceDataset_);
+        converter.setOutputFormat("uint8");
     }
     else if (parameters[0] == "12") {
-        //targetDataset_ = new VolumeUInt16(sourceDataset_->getDimensions(), sourceDataset_->getSpacing(), sourceDataset_->getTransformation(), 12);
-        targetDataset_ = voConvert.apply<uint16_t>(sourceDataset_);
-        targetDataset_->getWritableRepresentation<Volume>()->setBitsStored(12);
+        converter.setOutputFormat("uint16");
+        converter.setBitsStored(12);
     }
     else if (parameters[0] == "16") {
-        //targetDataset_ = new VolumeUInt16(sourceDataset_->getDimensions(), sourceDataset_->getSpacing(), sourceDataset_->getTransformation());
-        targetDataset_ = voConvert.apply<uint16_t>(sourceDataset_);
+        converter.setOutputFormat("uint16");
     }
     else {
-        delete sourceDataset_;
         throw tgt::Exception("Unknown target!");
     }
 
-    serializer->write(parameters.back(), targetDataset_);
-
-    delete volumeCollection;
-    delete targetDataset_;
+    converter.convert(parameters[1], parameters.back());
     return true;
 }
 
@@ -319,16 +305,85 @@ CommandConvertFormat::CommandConvertFormat() :
 }
 
 bool CommandConvertFormat::execute(const std::vector<std::string>& parameters) {
-    VolumeSerializerPopulator volLoadPop;
-    const VolumeSerializer* serializer = volLoadPop.getVolumeSerializer();
+    VolumeStreamConverter converter;
+    converter.convert(parameters[0], parameters.back());
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+CommandConvertStream::CommandConvertStream() :
+    Command("--convertstream", "",
+            "Convert Volume Datasets in a single pass, slab by slab\n"
+            "\t\tOPTIONS:\n"
+            "\t\ttype=TYPE: convert to the type, e.g. uint8, uint16, float, Vector4(uint8)\n"
+            "\t\tbits=N: bits stored of the integer type, e.g. 12\n"
+            "\t\trange=MIN:MAX: intensity range of float data mapped onto integers\n"
+            "\t\tswap: swap the byte order of the input\n"
+            "\t\tmirrorx, mirrory: mirror the slices\n"
+            "\t\ttransposexy: swap the x and y axes\n"
+            "\t\tcompress: compress the data file, if supported by the format\n"
+            "\t\tslab=MB: size of the slabs read",
+            "<[OPTION ...] IN OUT>", -1)
+{
+    loggerCat_ += "." + name_;
+}
+
+bool CommandConvertStream::checkParameters(const std::vector<std::string>& parameters) {
+    return (parameters.size() >= 2);
+}
 
-    VolumeCollection* volumeCollection = serializer->read(parameters[0]);
-    const VolumeHandleBase* sourceDataset = volumeCollection->first();
+bool CommandConvertStream::execute(const std::vector<std::string>& parameters) {
+    VolumeStreamConverter converter;
+    bool mirrorX = false;
+    bool mirrorY = false;
 
-    serializer->write(parameters.back(), sourceDataset);
+    for (size_t i = 0; i + 2 < parameters.size(); ++i) {
+        const std::string& option = parameters[i];
+        const std::string::size_type separator = option.find('=');
+        const std::string key = option.substr(0, separator);
+        const std::string value = (separator != std::string::npos) ? option.substr(separator + 1) : "";
+
+        if (key == "type") {
+            converter.setOutputFormat(value);
+        }
+        else if (key == "bits") {
+            converter.setBitsStored(cast<int>(value));
+        }
+        else if (key == "range") {
+            const std::string::size_type colon = value.find(':');
+            if (colon == std::string::npos)
+                throw tgt::Exception("Invalid range, expected MIN:MAX: " + value);
+            tgt::vec2 range(cast<float>(value.substr(0, colon)), cast<float>(value.substr(colon + 1)));
+            if (range.x >= range.y)
+                throw tgt::Exception("Invalid range, expected MIN < MAX: " + value);
+            converter.setIntensityRange(range);
+        }
+        else if (key == "swap") {
+            converter.setSwapEndianness(true);
+        }
+        else if (key == "mirrorx") {
+            mirrorX = true;
+        }
+        else if (key == "mirrory") {
+            mirrorY = true;
+        }
+        else if (key == "transposexy") {
+            converter.setTransposeXY(true);
+        }
+        else if (key == "compress") {
+            converter.setCompressed(true);
+        }
+        else if (key == "slab") {
+            converter.setSlabSize(static_cast<size_t>(cast<int>(value)) << 20);
+        }
+        else {
+            throw tgt::Exception("Unknown option: " + option);
+        }
+    }
+    converter.setMirror(mirrorX, mirrorY);
 
-    delete volumeCollection;
-    //delete serializer;
+    converter.convert(parameters[parameters.size() - 2], parameters.back());
     return true;
 }
 
@@ -63,6 +63,13 @@ public:
     bool execute(const std::vector<std::string>& parameters);
 };
 
+class CommandConvertStream : public Command {
+public:
+    CommandConvertStream();
+    bool execute(const std::vector<std::string>& parameters);
+    bool checkParameters(const std::vector<std::string>& parameters);
+};
+
 }   //namespace voreen
 
 #endif //VRN_COMMANDS_CONVERT_H
@@ -36,6 +36,7 @@
 #include "commands_create.h"
 #include "commands_modify.h"
 
+#include "voreen/core/voreenapplication.h"
 #include "voreen/core/utils/cmdparser/commandlineparser.h"
 
 #include "tgt/init.h"
@@ -56,12 +57,11 @@ using namespace voreen;
 int main(int argc, char** argv) {
     std::string loggerCat_ = "voreen.voltool";
 
-#ifdef VRN_NO_OPENGL
-    Singleton<LogManager>::init(new LogManager());
-//     Singleton<FileSystem>::init(new FileSystem());
-#else
-    tgt::init();
-#endif
+    // the application initializes tgt and loads the modules, whose volume readers and writers
+    // are used by the commands. It does not get the arguments, which are parsed below.
+    VoreenApplication app("voltool", "Voltool", 1, argv, VoreenApplication::APP_AUTOLOAD_MODULES);
+    app.initialize();
+
     //add a console logger:
     tgt::Log* clog = new tgt::ConsoleLog();
     clog->addCat("", true, tgt::Debug);
@@ -78,6 +78,7 @@ int main(int argc, char** argv) {
     cmdparser.addCommand(new CommandStackRaw());
     cmdparser.addCommand(new CommandConvert());
     cmdparser.addCommand(new CommandConvertFormat());
+    cmdparser.addCommand(new CommandConvertStream());
 
     cmdparser.addCommand(new CommandCreate());
     cmdparser.addCommand(new CommandGenerateMask());
@@ -103,5 +104,6 @@ int main(int argc, char** argv) {
     if (argc == 1)
         cmdparser.displayHelp();
 
+    app.deinitialize();
     return EXIT_SUCCESS;
 }
@@ -47,12 +47,14 @@ SOURCES	+= voltool.cpp \
            commands_convert.cpp \
            commands_create.cpp \
            commands_modify.cpp \
-           commands_registration.cpp
+           commands_registration.cpp \
+           volumestreamconverter.cpp
 
 HEADERS +=  commands_grad.h \
             commands_convert.h \
             commands_create.h \
             commands_modify.h \
-            commands_registration.h
+            commands_registration.h \
+            volumestreamconverter.h
 
 exists(voltool-internal.pri) : include(voltool-internal.pri)
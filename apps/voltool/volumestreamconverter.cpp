@@ -0,0 +1,706 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#include "volumestreamconverter.h"
+
+#include "voreen/core/io/volumereader.h"
+#include "voreen/core/io/volumewriter.h"
+#include "voreen/core/io/volumeserializer.h"
+#include "voreen/core/io/volumeserializerpopulator.h"
+#include "voreen/core/datastructures/volume/volumecollection.h"
+#include "voreen/core/datastructures/volume/volumehandle.h"
+#include "voreen/core/datastructures/volume/volumefactory.h"
+#include "voreen/core/datastructures/volume/diskrepresentation.h"
+#include "voreen/core/processors/profiling.h"
+#include "voreen/core/utils/backgroundthread.h"
+#include "voreen/core/utils/stringconversion.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace voreen {
+
+namespace {
+
+bool isFloatingPointType(const std::string& type) {
+    return (type.find("float") != std::string::npos || type.find("double") != std::string::npos);
+}
+
+bool isSignedIntegerType(const std::string& type) {
+    return !isFloatingPointType(type) && type.find("uint") == std::string::npos;
+}
+
+/// Deletes the collection and its volumes.
+void deleteCollection(VolumeCollection* collection) {
+    if (!collection)
+        return;
+    for (size_t i = 0; i < collection->size(); ++i)
+        delete collection->at(i);
+    delete collection;
+}
+
+/**
+ * Returns the factor mapping the normalized values of an integer volume, which refer
+ * to its type's range, onto the range of the bits stored, e.g., 16 for 12 bit data in 16 bit voxels.
+ */
+float getBitsStoredFactor(const Volume* volume) {
+    const int bitsPerChannel = volume->getBitsAllocated() / std::max(volume->getNumChannels(), 1);
+    const int bitsStored = volume->getBitsStored();
+    if (bitsStored <= 0 || bitsStored >= bitsPerChannel || bitsPerChannel > 32)
+        return 1.f;
+    return static_cast<float>((std::pow(2.0, bitsPerChannel) - 1.0) / (std::pow(2.0, bitsStored) - 1.0));
+}
+
+double toMB(uint64_t numBytes) {
+    return static_cast<double>(numBytes) / (1024.0 * 1024.0);
+}
+
+} // namespace
+
+class VolumeStreamConverter::ReadThread : public BackgroundThread {
+public:
+    ReadThread(VolumeStreamConverter* converter, size_t firstSlice)
+        : converter_(converter)
+        , firstSlice_(firstSlice)
+        , slab_(0)
+        , last_(false)
+    {}
+
+    ~ReadThread() {
+        // run() may still assign the slab, when the thread is deleted without having been joined
+        join();
+        // only set, if the slab has not been taken
+        delete slab_;
+    }
+
+    /// Reads the slab, called by run() or directly, if the thread could not be started.
+    void read() {
+        try {
+            slab_ = converter_->readSlab(firstSlice_, last_);
+        }
+        catch (std::exception& e) {
+            error_ = e.what();
+            if (error_.empty())
+                error_ = "Failed to read slices";
+        }
+    }
+
+    /// Returns the slab read and passes its ownership, valid after join().
+    Volume* takeSlab(bool& last) {
+        Volume* slab = slab_;
+        slab_ = 0;
+        last = last_;
+        return slab;
+    }
+
+    /// Returns the message of the error occurred while reading, valid after join().
+    const std::string& getError() const {
+        return error_;
+    }
+
+protected:
+    virtual void run() {
+        read();
+    }
+
+private:
+    VolumeStreamConverter* converter_;
+    size_t firstSlice_;
+    Volume* slab_;
+    bool last_;
+    std::string error_;
+};
+
+//------------------------------------------------------------------------
+
+const std::string VolumeStreamConverter::loggerCat_("voreen.voltool.VolumeStreamConverter");
+
+VolumeStreamConverter::VolumeStreamConverter()
+    : bitsStored_(0)
+    , intensityRange_(0.f, 1.f)
+    , hasIntensityRange_(false)
+    , swapEndianness_(false)
+    , mirrorX_(false)
+    , mirrorY_(false)
+    , transposeXY_(false)
+    , compressed_(false)
+    , slabSize_(VolumeSlabWriter::SLAB_SIZE)
+    , sliceReader_(0)
+    , inputCollection_(0)
+    , diskInput_(0)
+    , memoryInput_(0)
+    , inputPrototype_(0)
+    , prototype_(0)
+    , inputDims_(0, 0, 0)
+    , slabSlices_(1)
+    , rounding_(0.f)
+    , readThread_(0)
+    , nextSlice_(0)
+    , numSlices_(0)
+    , bytesRead_(0)
+    , bytesConverted_(0)
+    , readWaitTime_(0.0)
+    , convertTime_(0.0)
+{}
+
+VolumeStreamConverter::~VolumeStreamConverter() {
+    close();
+}
+
+void VolumeStreamConverter::setOutputFormat(const std::string& format) {
+    outputFormat_ = format;
+}
+
+void VolumeStreamConverter::setBitsStored(int bitsStored) {
+    bitsStored_ = bitsStored;
+}
+
+void VolumeStreamConverter::setIntensityRange(const tgt::vec2& range) {
+    tgtAssert(range.x < range.y, "invalid intensity range");
+    intensityRange_ = range;
+    hasIntensityRange_ = true;
+}
+
+void VolumeStreamConverter::setSwapEndianness(bool swap) {
+    swapEndianness_ = swap;
+}
+
+void VolumeStreamConverter::setMirror(bool mirrorX, bool mirrorY) {
+    mirrorX_ = mirrorX;
+    mirrorY_ = mirrorY;
+}
+
+void VolumeStreamConverter::setTransposeXY(bool transpose) {
+    transposeXY_ = transpose;
+}
+
+void VolumeStreamConverter::setCompressed(bool compressed) {
+    compressed_ = compressed;
+}
+
+void VolumeStreamConverter::setSlabSize(size_t numBytes) {
+    slabSize_ = std::max<size_t>(numBytes, 1);
+}
+
+void VolumeStreamConverter::convert(const std::string& inputFile, const std::string& outputFile)
+    throw (tgt::FileException)
+{
+    const double start = Profiler::now();
+    bytesRead_ = 0;
+    bytesConverted_ = 0;
+    readWaitTime_ = 0.0;
+    convertTime_ = 0.0;
+    numSlices_ = 0;
+
+    VolumeSerializerPopulator populator;
+    const VolumeSerializer* serializer = populator.getVolumeSerializer();
+    VolumeWriter* writer = serializer->getWriters(outputFile).front()->create();
+    writer->setCompressed(compressed_);
+
+    double rangeTime = 0.0;
+    try {
+        open(inputFile);
+        rangeTime = Profiler::now() - start;
+
+        LINFO("Converting " << inputFile << " (" << VolumeFactory().getType(inputPrototype_) << ") to " << outputFile
+              << " (" << VolumeFactory().getType(prototype_) << ") using " << writer->getClassName()
+              << (writer->streamsSlabs() ? "" : ", which assembles the volume in memory"));
+
+        startReading(0);
+        writer->writeSlabs(outputFile, this);
+    }
+    catch (tgt::FileException&) {
+        delete writer;
+        close();
+        throw;
+    }
+    catch (std::bad_alloc&) {
+        delete writer;
+        close();
+        throw tgt::FileException("Not enough memory for converting the volume", inputFile);
+    }
+    catch (std::exception& e) {
+        // e.g. serialization errors of writers
+        delete writer;
+        close();
+        throw tgt::FileException(e.what(), outputFile);
+    }
+    delete writer;
+    close();
+
+    const double duration = std::max(Profiler::now() - start, 1e-6);
+    LINFO("Converted " << numSlices_ << " slices in " << duration << " s: "
+          << toMB(bytesRead_) << " MB read (" << toMB(bytesRead_) / duration << " MB/s), "
+          << toMB(bytesConverted_) << " MB written before encoding (" << toMB(bytesConverted_) / duration << " MB/s)");
+    LINFO("Waited " << readWaitTime_ << " s for reading, converted for " << convertTime_ << " s"
+          << (rangeTime > 0.01 ? ", intensity range pass and setup took " + dtos(rangeTime) + " s" : ""));
+}
+
+void VolumeStreamConverter::open(const std::string& inputFile) throw (tgt::FileException, std::bad_alloc) {
+    close();
+    inputFile_ = inputFile;
+
+    VolumeSerializerPopulator populator;
+    const VolumeSerializer* serializer = populator.getVolumeSerializer();
+
+    // the first reader reading a single slice is used for reading the slabs
+    std::vector<VolumeReader*> readers = serializer->getReaders(inputFile);
+    for (size_t i = 0; i < readers.size() && !sliceReader_; ++i) {
+        VolumeReader* reader = readers[i]->create();
+        VolumeCollection* collection = 0;
+        try {
+            collection = reader->readSlices(inputFile, 0, 1);
+        }
+        catch (std::exception& e) {
+            LDEBUG(reader->getClassName() << " does not read slices: " << e.what());
+        }
+        if (collection && collection->size() > 0 && collection->first()->getDimensions().z == 1
+            && collection->first()->hasRepresentation<Volume>())
+        {
+            sliceReader_ = reader;
+            inputCollection_ = collection;
+        }
+        else {
+            deleteCollection(collection);
+            delete reader;
+        }
+    }
+
+    const VolumeHandleBase* handle = 0;
+    if (sliceReader_) {
+        handle = inputCollection_->first();
+        inputPrototype_ = handle->getRepresentation<Volume>()->createNew(tgt::svec3(1, 1, 1),
+                                                                         VolumeRepresentation::VolumeBorders(), false);
+        inputDims_ = tgt::svec3(handle->getDimensions().x, handle->getDimensions().y, 0);
+        LINFO("Reading slabs by " << sliceReader_->getClassName());
+    }
+    else {
+        inputCollection_ = serializer->read(inputFile);
+        if (!inputCollection_ || inputCollection_->size() == 0)
+            throw tgt::FileException("No volume read", inputFile);
+        handle = inputCollection_->first();
+        inputDims_ = handle->getDimensions();
+
+        const DiskRepresentation* disk = handle->hasRepresentation<DiskRepresentation>() ?
+            handle->getRepresentation<DiskRepresentation>() : 0;
+        // data aligned to the end of the file can not be read in slabs
+        if (disk && disk->getOffset() >= 0) {
+            diskInput_ = disk;
+            inputPrototype_ = VolumeFactory().create(disk->getFormat(), tgt::svec3(1, 1, 1));
+            LINFO("Reading slabs from the data file " << disk->getFileName());
+        }
+        else {
+            memoryInput_ = handle->getRepresentation<Volume>();
+            if (!memoryInput_)
+                throw tgt::FileException("No volume data read", inputFile);
+            inputPrototype_ = memoryInput_->createNew(tgt::svec3(1, 1, 1), VolumeRepresentation::VolumeBorders(), false);
+            LWARNING("No reader of " << inputFile << " reads slices, the input is held in memory");
+        }
+    }
+    if (inputCollection_->size() > 1)
+        LWARNING(inputFile << " contains " << inputCollection_->size() << " volumes, only the first is converted");
+
+    VolumeFactory vf;
+    const std::string inputType = vf.getType(inputPrototype_);
+    if (!inputPrototype_ || inputType.empty())
+        throw tgt::FileException("Unsupported input data type", inputFile);
+
+    // output format
+    if (outputFormat_.empty() || outputFormat_ == inputType) {
+        prototype_ = inputPrototype_->createNew(tgt::svec3(1, 1, 1), VolumeRepresentation::VolumeBorders(), false);
+    }
+    else {
+        prototype_ = vf.create(outputFormat_, tgt::svec3(1, 1, 1));
+        if (!prototype_)
+            throw tgt::FileException("Unknown output format: " + outputFormat_, inputFile);
+        if (prototype_->getNumChannels() != inputPrototype_->getNumChannels())
+            throw tgt::FileException("Output format " + outputFormat_ + " does not match the number of channels", inputFile);
+    }
+    if (bitsStored_ > 0)
+        prototype_->setBitsStored(bitsStored_);
+
+    const size_t sliceSize = inputDims_.x * inputDims_.y * inputPrototype_->getBytesPerVoxel();
+    slabSlices_ = std::max<size_t>(slabSize_ / std::max<size_t>(sliceSize, 1), 1);
+
+    // value mapping: floating point data is mapped from its intensity range, when converted into integers,
+    // integer data by its normalized values with respect to the bits stored
+    const std::string outputType = vf.getType(prototype_);
+    const int numChannels = inputPrototype_->getNumChannels();
+    std::vector<tgt::vec2> ranges;
+    if (isFloatingPointType(inputType) && !isFloatingPointType(outputType)) {
+        if (hasIntensityRange_)
+            ranges.assign(numChannels, intensityRange_);
+        else
+            ranges = computeIntensityRanges();
+    }
+    mapping_.assign(numChannels, tgt::vec2(1.f, 0.f));
+    const bool identity = (inputType == outputType) && ranges.empty()
+                          && (getBitsStoredFactor(inputPrototype_) == getBitsStoredFactor(prototype_));
+    for (int c = 0; c < numChannels && !identity; ++c) {
+        tgt::vec2& m = mapping_[c];
+        if (!ranges.empty()) {
+            const float spread = ranges[c].y - ranges[c].x;
+            m = (spread > 0.f) ? tgt::vec2(1.f / spread, -ranges[c].x / spread) : tgt::vec2(0.f);
+            LINFO("Mapping the intensity range " << ranges[c] << " of channel " << c << " onto " << outputType);
+        }
+        if (!isFloatingPointType(inputType))
+            m.x *= getBitsStoredFactor(inputPrototype_);
+        if (!isFloatingPointType(outputType))
+            m /= getBitsStoredFactor(prototype_);
+    }
+
+    // the normalized values are truncated towards zero when stored as integers, and negative values of
+    // signed types are normalized by the magnitude of the minimum, so the rounding depends on the sign
+    rounding_ = tgt::vec2(0.f);
+    if (!identity && !isFloatingPointType(outputType)) {
+        const int bitsPerChannel = prototype_->getBitsAllocated() / numChannels;
+        if (isSignedIntegerType(outputType)) {
+            const double magnitude = std::pow(2.0, bitsPerChannel - 1);
+            rounding_ = tgt::vec2(static_cast<float>(0.5 / (magnitude - 1.0)), static_cast<float>(0.5 / magnitude));
+        }
+        else {
+            rounding_.x = static_cast<float>(0.5 / (std::pow(2.0, bitsPerChannel) - 1.0));
+        }
+    }
+}
+
+void VolumeStreamConverter::close() {
+    if (readThread_) {
+        readThread_->interrupt();
+        delete readThread_;
+        readThread_ = 0;
+    }
+    delete sliceReader_;
+    sliceReader_ = 0;
+    deleteCollection(inputCollection_);
+    inputCollection_ = 0;
+    diskInput_ = 0;
+    memoryInput_ = 0;
+    delete inputPrototype_;
+    inputPrototype_ = 0;
+    delete prototype_;
+    prototype_ = 0;
+    mapping_.clear();
+    rounding_ = tgt::vec2(0.f);
+}
+
+Volume* VolumeStreamConverter::readSlab(size_t firstSlice, bool& last) throw (tgt::FileException, std::bad_alloc) {
+    last = true;
+
+    if (sliceReader_) {
+        // one additional slice is requested, which tells whether there are further slabs,
+        // since the readers clamp the range to the depth, which is not known in advance
+        VolumeCollection* collection = sliceReader_->readSlices(inputFile_, firstSlice, firstSlice + slabSlices_ + 1);
+        if (!collection || collection->size() == 0) {
+            delete collection;
+            throw tgt::CorruptedFileException("No slices read", inputFile_);
+        }
+        VolumeHandle* handle = dynamic_cast<VolumeHandle*>(collection->first());
+        const Volume* volume = handle ? handle->getRepresentation<Volume>() : 0;
+        if (!volume || tgt::svec2(volume->getDimensions().xy()) != inputDims_.xy()
+            || volume->getDimensions().z > slabSlices_ + 1)
+        {
+            deleteCollection(collection);
+            throw tgt::CorruptedFileException("Slices read do not match the volume", inputFile_);
+        }
+        Volume* slab = const_cast<Volume*>(volume);
+        handle->releaseVolumes();
+        deleteCollection(collection);
+
+        const size_t depth = slab->getDimensions().z;
+        last = (depth <= slabSlices_);
+        if (!last) {
+            // the additional slice is read again with the next slab
+            Volume* trimmed = 0;
+            try {
+                trimmed = slab->createNew(tgt::svec3(inputDims_.x, inputDims_.y, slabSlices_),
+                                          VolumeRepresentation::VolumeBorders(), true);
+            }
+            catch (...) {
+                delete slab;
+                throw;
+            }
+            memcpy(trimmed->getData(), slab->getData(), trimmed->getNumBytes());
+            delete slab;
+            slab = trimmed;
+        }
+        return slab;
+    }
+
+    if (firstSlice >= inputDims_.z)
+        return 0;
+    const size_t numSlices = std::min(slabSlices_, inputDims_.z - firstSlice);
+    last = (firstSlice + numSlices >= inputDims_.z);
+
+    if (diskInput_) {
+        DiskRepresentation* sub = diskInput_->getSubVolume(tgt::svec3(inputDims_.x, inputDims_.y, numSlices),
+                                                           tgt::svec3(0, 0, firstSlice));
+        Volume* slab = 0;
+        try {
+            RepresentationConverterLoadFromDisk converter;
+            slab = static_cast<Volume*>(converter.convert(sub));
+        }
+        catch (...) {
+            delete sub;
+            throw;
+        }
+        delete sub;
+        if (!slab)
+            throw tgt::CorruptedFileException("Failed to read slices", diskInput_->getFileName());
+        return slab;
+    }
+
+    // copied, since the slab is modified in place
+    tgtAssert(memoryInput_, "no input");
+    Volume* slab = memoryInput_->createNew(tgt::svec3(inputDims_.x, inputDims_.y, numSlices),
+                                           VolumeRepresentation::VolumeBorders(), true);
+    const size_t sliceSize = inputDims_.x * inputDims_.y * memoryInput_->getBytesPerVoxel();
+    memcpy(slab->getData(), static_cast<const char*>(memoryInput_->getData()) + firstSlice * sliceSize,
+           numSlices * sliceSize);
+    return slab;
+}
+
+void VolumeStreamConverter::startReading(size_t firstSlice) {
+    tgtAssert(!readThread_, "already reading");
+    nextSlice_ = firstSlice;
+    readThread_ = new ReadThread(this, firstSlice);
+    try {
+        readThread_->start();
+    }
+    catch (VoreenException& e) {
+        LWARNING("Failed to start reading thread, reading synchronously: " << e.what());
+        readThread_->read();
+    }
+}
+
+Volume* VolumeStreamConverter::finishReading(bool& last) throw (tgt::IOException) {
+    tgtAssert(readThread_, "not reading");
+    const double start = Profiler::now();
+    readThread_->join();
+    readWaitTime_ += Profiler::now() - start;
+
+    Volume* slab = readThread_->takeSlab(last);
+    std::string error = readThread_->getError();
+    delete readThread_;
+    readThread_ = 0;
+    if (!error.empty())
+        throw tgt::IOException(error, inputFile_);
+    return slab;
+}
+
+Volume* VolumeStreamConverter::nextSlab() throw (tgt::IOException) {
+    // after the last slab
+    if (!readThread_)
+        return 0;
+
+    bool last = false;
+    Volume* slab = finishReading(last);
+    if (!slab)
+        return 0;
+
+    // the next slab is read, while this one is converted and written
+    const size_t depth = slab->getDimensions().z;
+    if (!last)
+        startReading(nextSlice_ + depth);
+
+    const double start = Profiler::now();
+    const uint64_t numBytes = slab->getNumBytes();
+    Volume* result = 0;
+    try {
+        if (swapEndianness_)
+            swapEndianness(slab);
+        result = transformSlab(slab);
+    }
+    catch (std::bad_alloc&) {
+        delete slab;
+        throw tgt::IOException("Not enough memory for converting the slices", inputFile_);
+    }
+    if (result != slab)
+        delete slab;
+    convertTime_ += Profiler::now() - start;
+
+    numSlices_ += depth;
+    bytesRead_ += numBytes;
+    bytesConverted_ += result->getNumBytes();
+    return result;
+}
+
+size_t VolumeStreamConverter::getNumSlices() const {
+    // the readers clamp the slice range, so the depth of the input read by slices is not known in advance
+    return sliceReader_ ? 0 : inputDims_.z;
+}
+
+VolumeHandle* VolumeStreamConverter::createHeader() const {
+    tgtAssert(prototype_ && inputCollection_, "no input");
+    const tgt::svec3 dims = transposeXY_ ? tgt::svec3(inputDims_.y, inputDims_.x, numSlices_)
+                                         : tgt::svec3(inputDims_.x, inputDims_.y, numSlices_);
+    Volume* volume = prototype_->createNew(dims, VolumeRepresentation::VolumeBorders(), false);
+
+    // the input's meta data, i.e., spacing, offset of the first slice, transformation and modality
+    const VolumeHandleBase* input = inputCollection_->first();
+    VolumeHandle* header = new VolumeHandle(volume, input);
+    if (transposeXY_) {
+        tgt::vec3 spacing = input->getSpacing();
+        header->setSpacing(tgt::vec3(spacing.y, spacing.x, spacing.z));
+    }
+    return header;
+}
+
+std::vector<tgt::vec2> VolumeStreamConverter::computeIntensityRanges() throw (tgt::FileException, std::bad_alloc) {
+    const int numChannels = inputPrototype_->getNumChannels();
+    std::vector<tgt::vec2> ranges(numChannels, tgt::vec2(std::numeric_limits<float>::max(),
+                                                         -std::numeric_limits<float>::max()));
+    LINFO("Determining the intensity range, which may be passed instead");
+
+    bool last = false;
+    for (size_t firstSlice = 0; !last; ) {
+        Volume* slab = readSlab(firstSlice, last);
+        if (!slab)
+            break;
+        if (swapEndianness_)
+            swapEndianness(slab);
+
+        const long numVoxels = static_cast<long>(slab->getNumVoxels());
+        for (int c = 0; c < numChannels; ++c) {
+            float minValue = ranges[c].x;
+            float maxValue = ranges[c].y;
+            #ifdef _OPENMP
+            #pragma omp parallel
+            #endif
+            {
+                float threadMin = minValue;
+                float threadMax = maxValue;
+                #ifdef _OPENMP
+                #pragma omp for
+                #endif
+                for (long i = 0; i < numVoxels; ++i) {
+                    const float value = slab->getVoxelFloat(static_cast<size_t>(i), c);
+                    threadMin = std::min(threadMin, value);
+                    threadMax = std::max(threadMax, value);
+                }
+                #ifdef _OPENMP
+                #pragma omp critical (VolumeStreamConverter_range)
+                #endif
+                {
+                    ranges[c].x = std::min(ranges[c].x, threadMin);
+                    ranges[c].y = std::max(ranges[c].y, threadMax);
+                }
+            }
+        }
+        firstSlice += slab->getDimensions().z;
+        delete slab;
+    }
+    return ranges;
+}
+
+void VolumeStreamConverter::swapEndianness(Volume* slab) const {
+    const size_t numChannels = static_cast<size_t>(std::max(slab->getNumChannels(), 1));
+    const size_t elementSize = slab->getBytesPerVoxel() / numChannels;
+    if (elementSize <= 1 || slab->getBytesPerVoxel() % numChannels != 0)
+        return;
+
+    char* data = static_cast<char*>(slab->getData());
+    const long numElements = static_cast<long>(slab->getNumVoxels() * numChannels);
+    #ifdef _OPENMP
+    #pragma omp parallel for
+    #endif
+    for (long i = 0; i < numElements; ++i) {
+        char* element = data + static_cast<size_t>(i) * elementSize;
+        std::reverse(element, element + elementSize);
+    }
+}
+
+Volume* VolumeStreamConverter::transformSlab(Volume* slab) const throw (std::bad_alloc) {
+    const bool copy = isCopy();
+    if (copy && !mirrorX_ && !mirrorY_ && !transposeXY_)
+        return slab;
+
+    const tgt::svec3 inDims = slab->getDimensions();
+    const tgt::svec3 outDims = transposeXY_ ? tgt::svec3(inDims.y, inDims.x, inDims.z) : inDims;
+    Volume* result = prototype_->createNew(outDims, VolumeRepresentation::VolumeBorders(), true);
+
+    const size_t voxelSize = slab->getBytesPerVoxel();
+    const int numChannels = slab->getNumChannels();
+    const bool copyRows = copy && !mirrorX_ && !transposeXY_;
+    const char* src = static_cast<const char*>(slab->getData());
+    char* dest = static_cast<char*>(result->getData());
+
+    const long numRows = static_cast<long>(outDims.y * outDims.z);
+    #ifdef _OPENMP
+    #pragma omp parallel for
+    #endif
+    for (long row = 0; row < numRows; ++row) {
+        const size_t z = static_cast<size_t>(row) / outDims.y;
+        const size_t y = static_cast<size_t>(row) % outDims.y;
+        const size_t destRow = static_cast<size_t>(row) * outDims.x;
+
+        if (copyRows) {
+            const size_t srcY = mirrorY_ ? inDims.y - 1 - y : y;
+            memcpy(dest + destRow * voxelSize, src + (z * inDims.y + srcY) * inDims.x * voxelSize, inDims.x * voxelSize);
+            continue;
+        }
+
+        for (size_t x = 0; x < outDims.x; ++x) {
+            size_t srcX = transposeXY_ ? y : x;
+            size_t srcY = transposeXY_ ? x : y;
+            if (mirrorX_)
+                srcX = inDims.x - 1 - srcX;
+            if (mirrorY_)
+                srcY = inDims.y - 1 - srcY;
+            const size_t srcIndex = (z * inDims.y + srcY) * inDims.x + srcX;
+
+            if (copy) {
+                memcpy(dest + (destRow + x) * voxelSize, src + srcIndex * voxelSize, voxelSize);
+            }
+            else {
+                for (int c = 0; c < numChannels; ++c) {
+                    const tgt::vec2& m = mapping_[c];
+                    const float value = slab->getVoxelFloat(srcIndex, c) * m.x + m.y;
+                    result->setVoxelFloat(value >= 0.f ? value + rounding_.x : value - rounding_.y, destRow + x, c);
+                }
+            }
+        }
+    }
+    return result;
+}
+
+bool VolumeStreamConverter::isCopy() const {
+    tgtAssert(inputPrototype_ && prototype_, "no input");
+    VolumeFactory vf;
+    if (vf.getType(inputPrototype_) != vf.getType(prototype_))
+        return false;
+    for (size_t c = 0; c < mapping_.size(); ++c) {
+        if (mapping_[c] != tgt::vec2(1.f, 0.f))
+            return false;
+    }
+    return true;
+}
+
+} // namespace voreen
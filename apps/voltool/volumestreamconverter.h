@@ -0,0 +1,198 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef VRN_VOLUMESTREAMCONVERTER_H
+#define VRN_VOLUMESTREAMCONVERTER_H
+
+#include "voreen/core/io/volumeslabwriter.h"
+
+#include "tgt/exception.h"
+#include "tgt/vector.h"
+
+#include <string>
+#include <vector>
+
+namespace voreen {
+
+class DiskRepresentation;
+class VolumeCollection;
+class VolumeHandle;
+class VolumeHandleBase;
+class VolumeReader;
+
+/**
+ * Converts a volume file into another format in a single pass over the data,
+ * without holding the volume in memory as a whole.
+ *
+ * The input is read slab by slab in the background: by the readSlices() of the first
+ * registered reader supporting it, by slabs of the lazily loaded disk representation,
+ * or, if neither is available, from the volume read as a whole. Each slab is
+ * byte swapped, converted to the output type and mirrored/transposed in a single
+ * parallel pass, while the previous slab is compressed and written. Writers
+ * streaming the slabs (see VolumeWriter::streamsSlabs()) thereby write the file
+ * with bounded memory, all other registered writers receive the assembled volume.
+ *
+ * The transformations only rearrange the voxels within the slices, since
+ * the slices are read and written in order.
+ */
+class VolumeStreamConverter : public VolumeSlabWriter::SlabSource {
+public:
+    VolumeStreamConverter();
+    virtual ~VolumeStreamConverter();
+
+    /**
+     * Sets the VolumeFactory type the data is converted to, e.g. "uint8" or "float".
+     * Empty keeps the input type, which is the default.
+     */
+    void setOutputFormat(const std::string& format);
+
+    /// Sets the number of bits used of the integer output type, 0 uses all, e.g. 12 for "uint16".
+    void setBitsStored(int bitsStored);
+
+    /**
+     * Sets the intensity range of floating point input, which is mapped onto the
+     * range of an integer output type. If it is not set, the range is determined
+     * by an additional pass over the input.
+     *
+     * @param range range.x < range.y
+     */
+    void setIntensityRange(const tgt::vec2& range);
+
+    /// Swaps the byte order of the input data, e.g. of big endian raw files.
+    void setSwapEndianness(bool swap);
+
+    /// Mirrors the slices along the input's x and/or y axis.
+    void setMirror(bool mirrorX, bool mirrorY);
+
+    /// Swaps the x and y axes of the slices, after mirroring.
+    void setTransposeXY(bool transpose);
+
+    /// Enables the compression of the written data, if supported by the writer.
+    void setCompressed(bool compressed);
+
+    /// Sets the number of bytes of the input slabs aimed for. Default: VolumeSlabWriter::SLAB_SIZE.
+    void setSlabSize(size_t numBytes);
+
+    /**
+     * Converts the input file to the output file, whose writer is
+     * determined by its extension, and logs the throughput.
+     *
+     * @throw tgt::FileException if the input can not be read or the output not be written
+     */
+    void convert(const std::string& inputFile, const std::string& outputFile)
+        throw (tgt::FileException);
+
+    /// Returns the converted slabs, called by the writer.
+    virtual Volume* nextSlab() throw (tgt::IOException);
+
+    /// Returns the depth of the input, if known in advance, called by the writer.
+    virtual size_t getNumSlices() const;
+
+    /// Returns the header of the converted volume, called by the writer.
+    virtual VolumeHandle* createHeader() const;
+
+private:
+    /// Reads the input slabs in the background.
+    class ReadThread;
+
+    /// Determines how the input is read and the conversion of its values.
+    void open(const std::string& inputFile) throw (tgt::FileException, std::bad_alloc);
+
+    /// Releases the input.
+    void close();
+
+    /**
+     * Reads the slab starting at the passed slice, null if there is none.
+     * Called by the read thread.
+     *
+     * @param last set to true, if the slab is the last one
+     */
+    Volume* readSlab(size_t firstSlice, bool& last) throw (tgt::FileException, std::bad_alloc);
+
+    /// Starts reading the slab at the passed slice in the background.
+    void startReading(size_t firstSlice);
+
+    /// Waits for the slab being read and returns it, see readSlab().
+    Volume* finishReading(bool& last) throw (tgt::IOException);
+
+    /// Determines the intensity range of each channel of floating point input by a pass over all slabs.
+    std::vector<tgt::vec2> computeIntensityRanges() throw (tgt::FileException, std::bad_alloc);
+
+    /// Swaps the byte order of each channel of the slab in place.
+    void swapEndianness(Volume* slab) const;
+
+    /**
+     * Converts and transforms the input slab into a slab of the output format,
+     * which is the input slab itself, if it is neither converted nor transformed.
+     */
+    Volume* transformSlab(Volume* slab) const throw (std::bad_alloc);
+
+    /// Returns whether the data is only copied, i.e., not converted.
+    bool isCopy() const;
+
+    std::string outputFormat_;
+    int bitsStored_;
+    tgt::vec2 intensityRange_;
+    bool hasIntensityRange_;
+    bool swapEndianness_;
+    bool mirrorX_;
+    bool mirrorY_;
+    bool transposeXY_;
+    bool compressed_;
+    size_t slabSize_;
+
+    // input, one of them is used for reading slabs
+    std::string inputFile_;
+    VolumeReader* sliceReader_;                 ///< reader supporting readSlices()
+    VolumeCollection* inputCollection_;         ///< first slice, or the volume read as a whole; describes the input
+    const DiskRepresentation* diskInput_;       ///< lazily loaded input volume
+    const Volume* memoryInput_;                 ///< input volume in memory
+
+    Volume* inputPrototype_;                    ///< input format, holds no data
+    Volume* prototype_;                         ///< output format, holds no data
+    tgt::svec3 inputDims_;                      ///< depth is 0, if unknown
+    size_t slabSlices_;                         ///< number of slices per input slab
+    std::vector<tgt::vec2> mapping_;            ///< per channel: scale and bias of the float values
+    tgt::vec2 rounding_;                        ///< added to non-negative and subtracted from negative mapped values
+
+    ReadThread* readThread_;
+    size_t nextSlice_;                          ///< first slice of the slab being read
+    size_t numSlices_;                          ///< slices returned so far
+
+    // statistics
+    uint64_t bytesRead_;
+    uint64_t bytesConverted_;
+    double readWaitTime_;                       ///< spent waiting for the read thread
+    double convertTime_;
+
+    static const std::string loggerCat_;
+};
+
+} // namespace voreen
+
+#endif // VRN_VOLUMESTREAMCONVERTER_H
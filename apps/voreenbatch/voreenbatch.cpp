@@ -0,0 +1,503 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+
+#include "tgt/logmanager.h"
+#include "tgt/filesystem.h"
+#include "tgt/offscreen/offscreencanvas.h"
+
+#include "voreen/core/voreenapplication.h"
+#include "voreen/core/utils/voreenpainter.h"
+#include "voreen/core/utils/cmdparser/singlecommand.h"
+#include "voreen/core/utils/cmdparser/multiplecommand.h"
+#include "voreen/core/io/serialization/serialization.h"
+#include "voreen/core/io/volumeserializer.h"
+#include "voreen/core/io/volumeserializerpopulator.h"
+#include "voreen/core/network/networkevaluator.h"
+#include "voreen/core/network/parametersweep.h"
+#include "voreen/core/network/workspace.h"
+#include "voreen/core/network/processornetwork.h"
+#include "voreen/core/processors/canvasrenderer.h"
+#include "voreen/core/ports/renderport.h"
+#include "voreen/core/ports/volumeport.h"
+
+#include "modules/base/processors/render/cpuraycaster.h"
+
+#ifdef VRN_MODULE_DEVIL
+#include <IL/il.h>
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+
+using namespace voreen;
+
+namespace {
+
+const std::string loggerCat_("voreen.voreenbatch");
+
+/**
+ * Command line application that evaluates a workspace without a window:
+ * with an off-screen OpenGL context, if available, or restricted to the
+ * processors not requiring OpenGL otherwise.
+ */
+class VoreenBatchApplication : public VoreenApplication {
+public:
+    VoreenBatchApplication(int argc, char** argv)
+        : VoreenApplication("voreenbatch", "VoreenBatch", argc, argv,
+            ApplicationFeatures(APP_ALL &~ (APP_HTML_LOGGING | APP_PROCESSOR_WIDGETS | APP_PROPERTY_WIDGETS)))
+        , outputDirectory_(".")
+        , imageFormat_("png")
+        , volumeFormat_("vvd")
+        , width_(0)
+        , height_(0)
+        , cpuOnly_(false)
+        , maxCachedResults_(32)
+    {}
+
+    virtual void prepareCommandParser() {
+        VoreenApplication::prepareCommandParser();
+
+        CommandlineParser* p = getCommandLineParser();
+        p->addCommand(new SingleCommand<std::string>(&workspaceFilename_, "--workspace", "-w",
+            "Workspace to evaluate", "<workspace file>"));
+        p->addCommand(new MultipleCommand<std::string, std::string>(&propertyNames_, &propertyValues_, "--set", "-s",
+            "Assigns a value to a property before the evaluation. Vectors are passed as \"( x y z )\", "
+            "cameras as \"px py pz fx fy fz ux uy uz\" and volumes as file names",
+            "<processor.property> <value>"));
+        p->addCommand(new MultipleCommand<std::string, std::string>(&sweepNames_, &sweepValues_, "--sweep", "",
+            "Evaluates the workspace for all combinations of the swept property values, separated by ';'. "
+            "The outputs of each point are suffixed by the point's index",
+            "<processor.property> <value1;value2;...>"));
+        p->addCommand(new SingleCommand<std::string>(&timingsFilename_, "--timings", "",
+            "File the sweep timings are written to (default: <output directory>/timings.csv)", "<csv file>"));
+        p->addCommand(new SingleCommand<int>(&maxCachedResults_, "--sweepCache", "",
+            "Maximum number of memoized processor results during a sweep, 0 disables the memoization (default: 32)",
+            "<count>"));
+        p->addCommand(new MultipleCommand<std::string>(&portNames_, "--port", "-p",
+            "Writes the data of the passed render or volume port. By default, the images of all canvases "
+            "and the unconnected volume outports are written", "<processor.port>"));
+        p->addCommand(new SingleCommand<std::string>(&outputDirectory_, "--output", "-o",
+            "Directory the outputs are written to (default: current directory)", "<directory>"));
+        p->addCommand(new SingleCommand<std::string>(&imageFormat_, "--imageFormat", "",
+            "File extension of the written images (default: png)", "<extension>"));
+        p->addCommand(new SingleCommand<std::string>(&volumeFormat_, "--volumeFormat", "",
+            "File extension of the written volumes (default: vvd)", "<extension>"));
+        p->addCommand(new SingleCommand<int, int>(&width_, &height_, "--size", "",
+            "Overrides the canvas sizes stored in the workspace", "<width> <height>"));
+        p->addCommand(new SingleCommandZeroArguments(&cpuOnly_, "--cpu", "",
+            "Does not create an OpenGL context and only evaluates processors not requiring it"));
+    }
+
+    std::string workspaceFilename_;
+    std::vector<std::string> propertyNames_;
+    std::vector<std::string> propertyValues_;
+    std::vector<std::string> sweepNames_;
+    std::vector<std::string> sweepValues_;
+    std::string timingsFilename_;
+    std::vector<std::string> portNames_;
+    std::string outputDirectory_;
+    std::string imageFormat_;
+    std::string volumeFormat_;
+    int width_;
+    int height_;
+    bool cpuOnly_;
+    int maxCachedResults_;
+};
+
+/// Replaces the characters not suitable for file names.
+std::string toFilename(const std::string& name) {
+    std::string result = name;
+    for (size_t i = 0; i < result.size(); ++i) {
+        if (result[i] == ' ' || result[i] == '/' || result[i] == '\\' || result[i] == ':')
+            result[i] = '_';
+    }
+    return result;
+}
+
+/// Assigns the value passed as string to the property with the qualified name.
+bool setProperty(ProcessorNetwork* network, const std::string& name, const std::string& value) {
+    Property* property = ParameterSweep::findProperty(network, name);
+    if (!property) {
+        LERROR("No property " << name << " in network, expected <processor.property>");
+        return false;
+    }
+    try {
+        ParameterSweep::setPropertyValue(property, value);
+    }
+    catch (const VoreenException& e) {
+        LERROR("Failed to assign '" << value << "' to property " << name << ": " << e.what());
+        return false;
+    }
+    LINFO("Set " << name << " = " << value);
+    return true;
+}
+
+/**
+ * Writes an RGBA float image, stored row by row starting with the bottom row,
+ * using DevIL, or as portable float map if DevIL is not available.
+ */
+bool writeImage(const std::string& filename, const std::vector<tgt::vec4>& image, const tgt::ivec2& size) {
+#ifdef VRN_MODULE_DEVIL
+    if (tgt::FileSystem::fileExtension(filename, true) != "pfm") {
+        ilInit();
+        ILuint img;
+        ilGenImages(1, &img);
+        ilBindImage(img);
+        ilTexImage(size.x, size.y, 1, 4, IL_RGBA, IL_FLOAT, const_cast<tgt::vec4*>(&image[0]));
+        ilEnable(IL_FILE_OVERWRITE);
+        ilResetWrite();
+        ILboolean success = ilSaveImage(const_cast<char*>(filename.c_str()));
+        ilDeleteImages(1, &img);
+        if (!success)
+            LERROR("Failed to write image " << filename);
+        return (success != 0);
+    }
+#endif
+
+    // portable float map: RGB, rows from bottom to top like the image
+    std::string pfmFilename = tgt::FileSystem::fileExtension(filename, true) == "pfm" ?
+        filename : filename.substr(0, filename.rfind('.')) + ".pfm";
+    FILE* file = fopen(pfmFilename.c_str(), "wb");
+    if (!file) {
+        LERROR("Unable to open file " << pfmFilename << " for writing");
+        return false;
+    }
+    fprintf(file, "PF\n%d %d\n-1.0\n", size.x, size.y);
+    std::vector<float> row(size.x * 3);
+    for (int y = 0; y < size.y; ++y) {
+        for (int x = 0; x < size.x; ++x) {
+            const tgt::vec4& color = image[y * size.x + x];
+            row[3*x] = color.r;
+            row[3*x + 1] = color.g;
+            row[3*x + 2] = color.b;
+        }
+        fwrite(&row[0], sizeof(float), row.size(), file);
+    }
+    bool success = (ferror(file) == 0);
+    fclose(file);
+    return success;
+}
+
+/// Writes the image of a render port, either from its render target or from a CPURaycaster.
+bool writeRenderPort(RenderPort* port, const std::string& filename) {
+    if (port->isInport()) {
+        std::vector<const Port*> connected = port->getConnected();
+        if (connected.empty()) {
+            LWARNING("Render port " << port->getQualifiedName() << " is not connected");
+            return false;
+        }
+        port = const_cast<RenderPort*>(static_cast<const RenderPort*>(connected.front()));
+    }
+
+    if (port->hasRenderTarget()) {
+        try {
+            port->saveToImage(filename);
+        }
+        catch (const VoreenException& e) {
+            LERROR(e.what());
+            return false;
+        }
+    }
+    else if (CPURaycaster* raycaster = dynamic_cast<CPURaycaster*>(port->getProcessor())) {
+        if (raycaster->getImage().empty()) {
+            LWARNING("No image rendered by " << raycaster->getName());
+            return false;
+        }
+        if (!writeImage(filename, raycaster->getImage(), raycaster->getImageSize()))
+            return false;
+    }
+    else {
+        LWARNING("No image in render port " << port->getQualifiedName());
+        return false;
+    }
+
+    LINFO("Wrote " << port->getQualifiedName() << " to " << filename);
+    return true;
+}
+
+bool writeVolumePort(VolumePort* port, const std::string& filename) {
+    if (!port->hasData()) {
+        LWARNING("No volume in port " << port->getQualifiedName());
+        return false;
+    }
+
+    try {
+        VolumeSerializerPopulator populator;
+        populator.getVolumeSerializer()->write(filename, port->getData());
+    }
+    catch (const tgt::Exception& e) {
+        LERROR("Failed to write volume " << filename << ": " << e.what());
+        return false;
+    }
+
+    LINFO("Wrote " << port->getQualifiedName() << " to " << filename);
+    return true;
+}
+
+/**
+ * Writes the passed ports to the directory, named after their processor and port with
+ * the suffix appended. Returns the number of ports that could not be written.
+ */
+int writePorts(const std::vector<Port*>& ports, const std::string& directory, const std::string& suffix,
+               const VoreenBatchApplication* app, tgt::OffscreenCanvas* context)
+{
+    int numFailed = 0;
+    for (size_t i = 0; i < ports.size(); ++i) {
+        // canvases are named after their processor, other ports after processor and port
+        std::string filename = directory + "/" + toFilename(dynamic_cast<CanvasRenderer*>(ports[i]->getProcessor()) ?
+            ports[i]->getProcessor()->getName() : ports[i]->getQualifiedName()) + suffix;
+        bool success = false;
+        if (RenderPort* renderPort = dynamic_cast<RenderPort*>(ports[i])) {
+            if (context)
+                context->getGLFocus();
+            success = writeRenderPort(renderPort, filename + "." + app->imageFormat_);
+        }
+        else if (VolumePort* volumePort = dynamic_cast<VolumePort*>(ports[i]))
+            success = writeVolumePort(volumePort, filename + "." + app->volumeFormat_);
+        else
+            LERROR("Port " << ports[i]->getQualifiedName() << " is neither a render nor a volume port");
+        if (!success)
+            numFailed++;
+    }
+    return numFailed;
+}
+
+/// Writes the ports after each point of a parameter sweep, suffixed by the zero-padded point index.
+class SweepWriter : public ParameterSweepObserver {
+public:
+    SweepWriter(const std::vector<Port*>& ports, const std::string& directory,
+                const VoreenBatchApplication* app, tgt::OffscreenCanvas* context)
+        : numFailed_(0)
+        , ports_(ports)
+        , directory_(directory)
+        , app_(app)
+        , context_(context)
+    {}
+
+    virtual void sweepPointEvaluated(const ParameterSweep* sweep, size_t point) {
+        size_t numDigits = 1;
+        for (size_t n = sweep->getNumPoints(); n >= 10; n /= 10)
+            numDigits++;
+        std::ostringstream suffix;
+        suffix << "_" << std::setw(numDigits) << std::setfill('0') << point;
+
+        std::vector<std::string> values = sweep->getPointValues(point);
+        std::ostringstream description;
+        for (size_t i = 0; i < values.size(); ++i)
+            description << (i > 0 ? ", " : "") << sweep->getParameterName(i) << " = " << values[i];
+        LINFO("Point " << point + 1 << "/" << sweep->getNumPoints() << ": " << description.str());
+
+        numFailed_ += writePorts(ports_, directory_, suffix.str(), app_, context_);
+    }
+
+    int numFailed_;
+
+private:
+    std::vector<Port*> ports_;
+    std::string directory_;
+    const VoreenBatchApplication* app_;
+    tgt::OffscreenCanvas* context_;
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    VoreenBatchApplication* app = new VoreenBatchApplication(argc, argv);
+    app->initialize();
+
+    if (app->workspaceFilename_.empty()) {
+        app->getCommandLineParser()->displayUsage();
+        delete app;
+        return EXIT_FAILURE;
+    }
+
+    // off-screen context, unless only the CPU is to be used
+    tgt::OffscreenCanvas* context = 0;
+    if (!app->cpuOnly_) {
+        context = new tgt::OffscreenCanvas("voreenbatch", tgt::ivec2(1));
+        context->init();
+        if (context->hasContext()) {
+            app->initializeGL();
+        }
+        else {
+            LWARNING("No off-screen OpenGL context available (backend: " << tgt::OffscreenCanvas::getBackendName()
+                     << "), evaluating processors not requiring OpenGL only");
+            delete context;
+            context = 0;
+        }
+    }
+
+    Workspace* workspace = new Workspace(context);
+    try {
+        workspace->load(app->workspaceFilename_);
+    }
+    catch (SerializationException& e) {
+        LERROR("Failed to load workspace " << app->workspaceFilename_ << ": " << e.what());
+        delete workspace;
+        delete context;
+        app->deinitialize();
+        delete app;
+        return EXIT_FAILURE;
+    }
+    std::vector<std::string> errors = workspace->getErrors();
+    for (size_t i = 0; i < errors.size(); ++i)
+        LWARNING(errors[i]);
+
+    ProcessorNetwork* network = workspace->getProcessorNetwork();
+    NetworkEvaluator* evaluator = new NetworkEvaluator(context);
+    evaluator->setOpenGLEnabled(context != 0);
+    app->setNetworkEvaluator(evaluator);
+
+    // each canvas renders into its own drawable of the shared context
+    std::vector<CanvasRenderer*> canvasRenderers = network->getProcessorsByType<CanvasRenderer>();
+    std::vector<tgt::OffscreenCanvas*> canvases;
+    std::vector<VoreenPainter*> painters;
+    if (context) {
+        for (size_t i = 0; i < canvasRenderers.size(); ++i) {
+            tgt::ivec2 size(app->width_, app->height_);
+            if (tgt::hor(tgt::lessThanEqual(size, tgt::ivec2(0)))) {
+                IntVec2Property* sizeProperty = dynamic_cast<IntVec2Property*>(canvasRenderers[i]->getProperty("canvasSize"));
+                size = sizeProperty ? sizeProperty->get() : tgt::ivec2(512);
+            }
+            tgt::OffscreenCanvas* canvas = new tgt::OffscreenCanvas(canvasRenderers[i]->getName(), size,
+                tgt::GLCanvas::RGBAD, context);
+            canvas->init();
+            VoreenPainter* painter = new VoreenPainter(canvas, evaluator, canvasRenderers[i]);
+            canvas->setPainter(painter);
+            canvasRenderers[i]->setCanvas(canvas);
+            canvases.push_back(canvas);
+            painters.push_back(painter);
+        }
+    }
+    evaluator->setProcessorNetwork(network);
+
+    int numFailed = 0;
+    for (size_t i = 0; i < app->propertyNames_.size(); ++i) {
+        if (!setProperty(network, app->propertyNames_[i], app->propertyValues_[i]))
+            numFailed++;
+    }
+
+    // write the requested ports or, by default, the canvases and the unconnected volume outports
+    std::string directory = app->outputDirectory_;
+    if (!tgt::FileSystem::dirExists(directory))
+        tgt::FileSystem::createDirectoryRecursive(directory);
+
+    std::vector<Port*> ports;
+    if (!app->portNames_.empty()) {
+        for (size_t i = 0; i < app->portNames_.size(); ++i) {
+            size_t separator = app->portNames_[i].rfind('.');
+            Processor* processor = (separator != std::string::npos ?
+                network->getProcessor(app->portNames_[i].substr(0, separator)) : 0);
+            Port* port = (processor ? processor->getPort(app->portNames_[i].substr(separator + 1)) : 0);
+            if (port)
+                ports.push_back(port);
+            else {
+                LERROR("No port " << app->portNames_[i] << " in network");
+                numFailed++;
+            }
+        }
+    }
+    else {
+        for (size_t i = 0; i < canvasRenderers.size(); ++i)
+            ports.insert(ports.end(), canvasRenderers[i]->getInports().begin(), canvasRenderers[i]->getInports().end());
+        for (size_t i = 0; i < network->getProcessors().size(); ++i) {
+            const std::vector<Port*>& outports = network->getProcessors()[i]->getOutports();
+            for (size_t j = 0; j < outports.size(); ++j) {
+                if (dynamic_cast<VolumePort*>(outports[j]) && !outports[j]->isConnected())
+                    ports.push_back(outports[j]);
+            }
+        }
+    }
+
+    if (app->sweepNames_.empty()) {
+        evaluator->process();
+        numFailed += writePorts(ports, directory, "", app, context);
+    }
+    else {
+        ParameterSweep sweep(network, evaluator);
+        sweep.setMaxCachedResults(static_cast<size_t>(std::max(app->maxCachedResults_, 0)));
+        for (size_t i = 0; i < app->sweepNames_.size(); ++i) {
+            std::vector<std::string> values;
+            std::istringstream stream(app->sweepValues_[i]);
+            std::string value;
+            while (std::getline(stream, value, ';')) {
+                if (!value.empty())
+                    values.push_back(value);
+            }
+            try {
+                sweep.addParameter(app->sweepNames_[i], values);
+            }
+            catch (const VoreenException& e) {
+                LERROR("Invalid sweep parameter " << app->sweepNames_[i] << ": " << e.what());
+                numFailed++;
+            }
+        }
+
+        SweepWriter writer(ports, directory, app, context);
+        sweep.addObserver(&writer);
+        sweep.run();
+        sweep.removeObserver(&writer);
+        numFailed += writer.numFailed_;
+
+        std::string timingsFilename = app->timingsFilename_.empty() ? directory + "/timings.csv" : app->timingsFilename_;
+        if (sweep.writeTimings(timingsFilename))
+            LINFO("Wrote sweep timings to " << timingsFilename);
+        else
+            numFailed++;
+    }
+
+    // clean up: the network is deleted along with the workspace
+    if (context)
+        context->getGLFocus();
+    evaluator->deinitializeNetwork();
+    for (size_t i = 0; i < canvasRenderers.size(); ++i)
+        canvasRenderers[i]->setCanvas(0);
+    for (size_t i = 0; i < painters.size(); ++i) {
+        delete painters[i];
+        delete canvases[i];
+    }
+    app->setNetworkEvaluator(0);
+    delete workspace;
+    delete evaluator;
+
+    if (context) {
+        context->getGLFocus();
+        app->deinitializeGL();
+        delete context;
+    }
+    app->deinitialize();
+    delete app;
+
+    return (numFailed == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,38 @@
+####################################################
+# Project file for the Voreen batch runner, which
+# evaluates workspaces without a windowing system
+####################################################
+TARGET = voreenbatch
+TEMPLATE = app
+LANGUAGE = C++
+
+CONFIG += console
+CONFIG -= qt
+
+# include config
+!exists(../../config.txt) {
+  error("config.txt not found! copy config-default.txt to config.txt and edit!")
+}
+include(../../config.txt)
+
+# Include common configuration
+include(../../commonconf.pri)
+
+# Include generic app configuration
+include(../voreenapp.pri)
+
+# Off-screen OpenGL context: EGL (default on unix) or OSMesa.
+# Without either, only processors not requiring OpenGL are evaluated.
+# Note: GLEW has to be built with the respective support (GLEW_EGL / GLEW_OSMESA).
+unix {
+  !contains(DEFINES, TGT_WITH_OSMESA) : DEFINES += TGT_WITH_EGL
+  contains(DEFINES, TGT_WITH_EGL) : LIBS += -lEGL
+  else : contains(DEFINES, TGT_WITH_OSMESA) : LIBS += -lOSMesa
+}
+
+SOURCES += \
+    voreenbatch.cpp \
+    $${VRN_HOME}/ext/tgt/offscreen/offscreencanvas.cpp
+
+HEADERS += \
+    $${VRN_HOME}/ext/tgt/offscreen/offscreencanvas.h
@@ -313,6 +313,9 @@ void LogManager::reinit(const std::string& logDir) {
 void LogManager::log(const std::string &cat, LogLevel level, const std::string &msg,
                      const std::string &extendedInfo)
 {
+    // messages may be logged concurrently, e.g., by background threads, by processors
+    // evaluated on worker threads of the NetworkEvaluator or by parallel volume readers
+    MutexLock lock(mutex_);
     vector<Log*>::iterator it;
     for (it = logs_.begin(); it != logs_.end(); it++) {
         if (*it != 0)
@@ -324,6 +327,7 @@ void LogManager::log(const std::string &cat, LogLevel level, const std::string &
 
 void LogManager::addLog(Log* log) {
     ConsoleLog* clog = dynamic_cast<ConsoleLog*>(log);
+    MutexLock lock(mutex_);
     if (clog) {
         delete consoleLog_;
         consoleLog_ = clog;
@@ -334,6 +338,7 @@ void LogManager::addLog(Log* log) {
 
 void LogManager::removeLog(Log* log) {
     ConsoleLog* clog = dynamic_cast<ConsoleLog*>(log);
+    MutexLock lock(mutex_);
     if (clog) {
         delete consoleLog_;
         consoleLog_ = clog;
@@ -344,7 +349,7 @@ void LogManager::removeLog(Log* log) {
                 iter = logs_.erase(iter);
             else
                 ++iter;
-        }        
+        }
     }
 }
 
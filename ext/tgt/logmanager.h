@@ -32,6 +32,7 @@
 #include "tgt/assert.h"
 #include <stdarg.h>
 #include "tgt/singleton.h"
+#include "tgt/mutex.h"
 #include "tgt/types.h"
 
 namespace tgt {
@@ -197,6 +198,7 @@ protected:
     std::string logDir_;
 	std::vector<Log*> logs_;
     ConsoleLog* consoleLog_;
+    Mutex mutex_;   ///< serializes the logging of concurrent threads
 };
     
 } // namespace
@@ -0,0 +1,132 @@
+/**********************************************************************
+ *                                                                    *
+ * tgt - Tiny Graphics Toolbox                                        *
+ *                                                                    *
+ * Copyright (C) 2006-2011 Visualization and Computer Graphics Group, *
+ * Department of Computer Science, University of Muenster, Germany.   *
+ * <http://viscg.uni-muenster.de>                                     *
+ *                                                                    *
+ * This file is part of the tgt library. This library is free         *
+ * software; you can redistribute it and/or modify it under the terms *
+ * of the GNU Lesser General Public License version 2.1 as published  *
+ * by the Free Software Foundation.                                   *
+ *                                                                    *
+ * This library is distributed in the hope that it will be useful,    *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU Lesser General Public License for more details.                *
+ *                                                                    *
+ * You should have received a copy of the GNU Lesser General Public   *
+ * License in the file "LICENSE.txt" along with this library.         *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ **********************************************************************/
+
+#include "tgt/mutex.h"
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+namespace tgt {
+
+#ifdef WIN32
+
+struct Mutex::Data {
+    CRITICAL_SECTION mutex_;
+};
+
+struct Condition::Data {
+    CONDITION_VARIABLE condition_;
+};
+
+Mutex::Mutex()
+    : data_(new Data())
+{
+    InitializeCriticalSection(&data_->mutex_);
+}
+
+Mutex::~Mutex() {
+    DeleteCriticalSection(&data_->mutex_);
+    delete data_;
+}
+
+void Mutex::lock() {
+    EnterCriticalSection(&data_->mutex_);
+}
+
+void Mutex::unlock() {
+    LeaveCriticalSection(&data_->mutex_);
+}
+
+Condition::Condition()
+    : data_(new Data())
+{
+    InitializeConditionVariable(&data_->condition_);
+}
+
+Condition::~Condition() {
+    delete data_;
+}
+
+void Condition::wait(Mutex& mutex) {
+    SleepConditionVariableCS(&data_->condition_, &mutex.data_->mutex_, INFINITE);
+}
+
+void Condition::notifyAll() {
+    WakeAllConditionVariable(&data_->condition_);
+}
+
+#else
+
+struct Mutex::Data {
+    pthread_mutex_t mutex_;
+};
+
+struct Condition::Data {
+    pthread_cond_t condition_;
+};
+
+Mutex::Mutex()
+    : data_(new Data())
+{
+    pthread_mutex_init(&data_->mutex_, 0);
+}
+
+Mutex::~Mutex() {
+    pthread_mutex_destroy(&data_->mutex_);
+    delete data_;
+}
+
+void Mutex::lock() {
+    pthread_mutex_lock(&data_->mutex_);
+}
+
+void Mutex::unlock() {
+    pthread_mutex_unlock(&data_->mutex_);
+}
+
+Condition::Condition()
+    : data_(new Data())
+{
+    pthread_cond_init(&data_->condition_, 0);
+}
+
+Condition::~Condition() {
+    pthread_cond_destroy(&data_->condition_);
+    delete data_;
+}
+
+void Condition::wait(Mutex& mutex) {
+    pthread_cond_wait(&data_->condition_, &mutex.data_->mutex_);
+}
+
+void Condition::notifyAll() {
+    pthread_cond_broadcast(&data_->condition_);
+}
+
+#endif
+
+} // namespace tgt
@@ -0,0 +1,103 @@
+/**********************************************************************
+ *                                                                    *
+ * tgt - Tiny Graphics Toolbox                                        *
+ *                                                                    *
+ * Copyright (C) 2006-2011 Visualization and Computer Graphics Group, *
+ * Department of Computer Science, University of Muenster, Germany.   *
+ * <http://viscg.uni-muenster.de>                                     *
+ *                                                                    *
+ * This file is part of the tgt library. This library is free         *
+ * software; you can redistribute it and/or modify it under the terms *
+ * of the GNU Lesser General Public License version 2.1 as published  *
+ * by the Free Software Foundation.                                   *
+ *                                                                    *
+ * This library is distributed in the hope that it will be useful,    *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU Lesser General Public License for more details.                *
+ *                                                                    *
+ * You should have received a copy of the GNU Lesser General Public   *
+ * License in the file "LICENSE.txt" along with this library.         *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef TGT_MUTEX_H
+#define TGT_MUTEX_H
+
+#include "tgt/types.h"
+
+namespace tgt {
+
+class Condition;
+
+/**
+ * Non-recursive mutex based on pthreads or the Win32 critical sections,
+ * for code shared by threads that are not necessarily OpenMP threads.
+ *
+ * @see MutexLock for locking a scope
+ */
+class TGT_API Mutex {
+public:
+    Mutex();
+    ~Mutex();
+
+    /// Blocks until the mutex is acquired by the calling thread.
+    void lock();
+
+    /// Releases the mutex, which has to be held by the calling thread.
+    void unlock();
+
+private:
+    friend class Condition;
+    struct Data;
+
+    // not copyable
+    Mutex(const Mutex&);
+    Mutex& operator=(const Mutex&);
+
+    Data* data_;
+};
+
+/**
+ * Holds a mutex for the lifetime of the object.
+ */
+class TGT_API MutexLock {
+public:
+    explicit MutexLock(Mutex& mutex) : mutex_(mutex) { mutex_.lock(); }
+    ~MutexLock() { mutex_.unlock(); }
+
+private:
+    MutexLock(const MutexLock&);
+    MutexLock& operator=(const MutexLock&);
+
+    Mutex& mutex_;
+};
+
+/**
+ * Condition variable, on which threads block until they are notified by another thread.
+ * Spurious wake-ups are possible, thus the awaited state has to be checked in a loop.
+ */
+class TGT_API Condition {
+public:
+    Condition();
+    ~Condition();
+
+    /// Releases the mutex, blocks until notified and acquires the mutex again. The mutex has to be held.
+    void wait(Mutex& mutex);
+
+    /// Wakes up all waiting threads.
+    void notifyAll();
+
+private:
+    struct Data;
+
+    Condition(const Condition&);
+    Condition& operator=(const Condition&);
+
+    Data* data_;
+};
+
+} // namespace tgt
+
+#endif // TGT_MUTEX_H
@@ -0,0 +1,281 @@
+/**********************************************************************
+ *                                                                    *
+ * tgt - Tiny Graphics Toolbox                                        *
+ *                                                                    *
+ * Copyright (C) 2006-2011 Visualization and Computer Graphics Group, *
+ * Department of Computer Science, University of Muenster, Germany.   *
+ * <http://viscg.uni-muenster.de>                                     *
+ *                                                                    *
+ * This file is part of the tgt library. This library is free         *
+ * software; you can redistribute it and/or modify it under the terms *
+ * of the GNU Lesser General Public License version 2.1 as published  *
+ * by the Free Software Foundation.                                   *
+ *                                                                    *
+ * This library is distributed in the hope that it will be useful,    *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU Lesser General Public License for more details.                *
+ *                                                                    *
+ * You should have received a copy of the GNU Lesser General Public   *
+ * License in the file "LICENSE.txt" along with this library.         *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ **********************************************************************/
+
+#include "tgt/offscreen/offscreencanvas.h"
+#include "tgt/logmanager.h"
+
+#if defined(TGT_WITH_EGL)
+    #include <EGL/egl.h>
+    #include <EGL/eglext.h>
+#elif defined(TGT_WITH_OSMESA)
+    #include <GL/osmesa.h>
+#endif
+
+namespace tgt {
+
+const std::string OffscreenCanvas::loggerCat_("tgt.OffscreenCanvas");
+
+OffscreenCanvas::OffscreenCanvas(const std::string& title,
+                                 const ivec2& size,
+                                 const GLCanvas::Buffers buffers,
+                                 OffscreenCanvas* sharedCanvas)
+    : GLCanvas(title, size, buffers)
+    , sharedCanvas_(sharedCanvas)
+    , display_(0)
+    , config_(0)
+    , context_(0)
+    , surface_(0)
+{
+    // there is no front buffer: flushing after painting is sufficient
+    doubleBuffered_ = false;
+}
+
+OffscreenCanvas::~OffscreenCanvas() {
+    destroyDrawable();
+
+    if (!sharedCanvas_ && context_) {
+#if defined(TGT_WITH_EGL)
+        EGLDisplay display = static_cast<EGLDisplay>(display_);
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(display, static_cast<EGLContext>(context_));
+        eglTerminate(display);
+#elif defined(TGT_WITH_OSMESA)
+        OSMesaDestroyContext(static_cast<OSMesaContext>(context_));
+#endif
+    }
+    context_ = 0;
+}
+
+void OffscreenCanvas::init() {
+    if (sharedCanvas_) {
+        if (!sharedCanvas_->hasContext()) {
+            LERROR("Shared canvas has no context");
+            return;
+        }
+        display_ = sharedCanvas_->display_;
+        config_ = sharedCanvas_->config_;
+        context_ = sharedCanvas_->context_;
+    }
+    else if (!createContext()) {
+        return;
+    }
+
+    if (!createDrawable())
+        return;
+
+    getGLFocus();
+    GLCanvas::init();
+}
+
+bool OffscreenCanvas::hasContext() const {
+    return (context_ != 0);
+}
+
+bool OffscreenCanvas::createContext() {
+#if defined(TGT_WITH_EGL)
+    EGLDisplay display = EGL_NO_DISPLAY;
+
+#if defined(EGL_EXT_device_enumeration) && defined(EGL_EXT_platform_device)
+    // prefer a display on a device, which works without an X server
+    PFNEGLQUERYDEVICESEXTPROC queryDevices =
+        reinterpret_cast<PFNEGLQUERYDEVICESEXTPROC>(eglGetProcAddress("eglQueryDevicesEXT"));
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    if (queryDevices && getPlatformDisplay) {
+        const EGLint MAX_DEVICES = 16;
+        EGLDeviceEXT devices[MAX_DEVICES];
+        EGLint numDevices = 0;
+        if (queryDevices(MAX_DEVICES, devices, &numDevices)) {
+            for (EGLint i = 0; i < numDevices && display == EGL_NO_DISPLAY; ++i) {
+                display = getPlatformDisplay(EGL_PLATFORM_DEVICE_EXT, devices[i], 0);
+                if (display != EGL_NO_DISPLAY && !eglInitialize(display, 0, 0))
+                    display = EGL_NO_DISPLAY;
+            }
+        }
+    }
+#endif
+
+    if (display == EGL_NO_DISPLAY) {
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        if (display == EGL_NO_DISPLAY || !eglInitialize(display, 0, 0)) {
+            LERROR("Failed to initialize EGL display");
+            return false;
+        }
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        LERROR("EGL display does not support desktop OpenGL");
+        eglTerminate(display);
+        return false;
+    }
+
+    const EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE,    EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE,        8,
+        EGL_GREEN_SIZE,      8,
+        EGL_BLUE_SIZE,       8,
+        EGL_ALPHA_SIZE,      (buffers_ & ALPHA_BUFFER) ? 8 : 0,
+        EGL_DEPTH_SIZE,      (buffers_ & DEPTH_BUFFER) ? 24 : 0,
+        EGL_STENCIL_SIZE,    (buffers_ & STENCIL_BUFFER) ? 8 : 0,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint numConfigs = 0;
+    if (!eglChooseConfig(display, configAttributes, &config, 1, &numConfigs) || numConfigs < 1) {
+        LERROR("No suitable EGL frame buffer configuration");
+        eglTerminate(display);
+        return false;
+    }
+
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, 0);
+    if (context == EGL_NO_CONTEXT) {
+        LERROR("Failed to create EGL context (error 0x" << std::hex << eglGetError() << ")");
+        eglTerminate(display);
+        return false;
+    }
+
+    display_ = display;
+    config_ = config;
+    context_ = context;
+
+    EGLint value = 0;
+    eglGetConfigAttrib(display, config, EGL_RED_SIZE, &value);     rgbaSize_.r = value;
+    eglGetConfigAttrib(display, config, EGL_GREEN_SIZE, &value);   rgbaSize_.g = value;
+    eglGetConfigAttrib(display, config, EGL_BLUE_SIZE, &value);    rgbaSize_.b = value;
+    eglGetConfigAttrib(display, config, EGL_ALPHA_SIZE, &value);   rgbaSize_.a = value;
+    eglGetConfigAttrib(display, config, EGL_DEPTH_SIZE, &value);   depthSize_ = value;
+    eglGetConfigAttrib(display, config, EGL_STENCIL_SIZE, &value); stencilSize_ = value;
+    return true;
+
+#elif defined(TGT_WITH_OSMESA)
+    OSMesaContext context = OSMesaCreateContextExt(OSMESA_RGBA,
+        (buffers_ & DEPTH_BUFFER) ? 24 : 0, (buffers_ & STENCIL_BUFFER) ? 8 : 0, 0, 0);
+    if (!context) {
+        LERROR("Failed to create OSMesa context");
+        return false;
+    }
+    context_ = context;
+
+    rgbaSize_ = ivec4(8);
+    depthSize_ = (buffers_ & DEPTH_BUFFER) ? 24 : 0;
+    stencilSize_ = (buffers_ & STENCIL_BUFFER) ? 8 : 0;
+    return true;
+
+#else
+    LERROR("Compiled without off-screen context support (define TGT_WITH_EGL or TGT_WITH_OSMESA)");
+    return false;
+#endif
+}
+
+bool OffscreenCanvas::createDrawable() {
+#if defined(TGT_WITH_EGL)
+    const EGLint surfaceAttributes[] = {
+        EGL_WIDTH,  size_.x,
+        EGL_HEIGHT, size_.y,
+        EGL_NONE
+    };
+    EGLSurface surface = eglCreatePbufferSurface(static_cast<EGLDisplay>(display_),
+        static_cast<EGLConfig>(config_), surfaceAttributes);
+    if (surface == EGL_NO_SURFACE) {
+        LERROR("Failed to create EGL pbuffer of size " << size_);
+        return false;
+    }
+    surface_ = surface;
+    return true;
+
+#elif defined(TGT_WITH_OSMESA)
+    buffer_.resize(static_cast<size_t>(size_.x) * size_.y * 4);
+    return true;
+
+#else
+    return false;
+#endif
+}
+
+void OffscreenCanvas::destroyDrawable() {
+#if defined(TGT_WITH_EGL)
+    if (surface_) {
+        EGLDisplay display = static_cast<EGLDisplay>(display_);
+        if (eglGetCurrentSurface(EGL_DRAW) == static_cast<EGLSurface>(surface_))
+            eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroySurface(display, static_cast<EGLSurface>(surface_));
+    }
+#endif
+    surface_ = 0;
+    buffer_.clear();
+}
+
+void OffscreenCanvas::swap() {
+    glFlush();
+}
+
+void OffscreenCanvas::getGLFocus() {
+    if (!context_)
+        return;
+#if defined(TGT_WITH_EGL)
+    eglMakeCurrent(static_cast<EGLDisplay>(display_), static_cast<EGLSurface>(surface_),
+                   static_cast<EGLSurface>(surface_), static_cast<EGLContext>(context_));
+#elif defined(TGT_WITH_OSMESA)
+    if (!buffer_.empty())
+        OSMesaMakeCurrent(static_cast<OSMesaContext>(context_), &buffer_[0], GL_UNSIGNED_BYTE, size_.x, size_.y);
+#endif
+}
+
+void OffscreenCanvas::toggleFullScreen() {
+    LWARNING("toggleFullScreen() not available for off-screen canvases");
+}
+
+void OffscreenCanvas::repaint() {
+    getGLFocus();
+    paint();
+}
+
+void OffscreenCanvas::update() {
+    repaint();
+}
+
+void OffscreenCanvas::resize(const ivec2& size) {
+    if (size == size_)
+        return;
+
+    destroyDrawable();
+    size_ = size;
+    if (context_ && createDrawable())
+        getGLFocus();
+
+    sizeChanged(size);
+}
+
+std::string OffscreenCanvas::getBackendName() {
+#if defined(TGT_WITH_EGL)
+    return "EGL";
+#elif defined(TGT_WITH_OSMESA)
+    return "OSMesa";
+#else
+    return "none";
+#endif
+}
+
+} // namespace tgt
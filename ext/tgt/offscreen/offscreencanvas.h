@@ -0,0 +1,111 @@
+/**********************************************************************
+ *                                                                    *
+ * tgt - Tiny Graphics Toolbox                                        *
+ *                                                                    *
+ * Copyright (C) 2006-2011 Visualization and Computer Graphics Group, *
+ * Department of Computer Science, University of Muenster, Germany.   *
+ * <http://viscg.uni-muenster.de>                                     *
+ *                                                                    *
+ * This file is part of the tgt library. This library is free         *
+ * software; you can redistribute it and/or modify it under the terms *
+ * of the GNU Lesser General Public License version 2.1 as published  *
+ * by the Free Software Foundation.                                   *
+ *                                                                    *
+ * This library is distributed in the hope that it will be useful,    *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU Lesser General Public License for more details.                *
+ *                                                                    *
+ * You should have received a copy of the GNU Lesser General Public   *
+ * License in the file "LICENSE.txt" along with this library.         *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef TGT_OFFSCREENCANVAS_H
+#define TGT_OFFSCREENCANVAS_H
+
+#include "tgt/glcanvas.h"
+
+#include <vector>
+
+namespace tgt {
+
+/**
+ * Canvas without a window, for rendering on machines without a windowing system.
+ *
+ * The OpenGL context is created through EGL (define TGT_WITH_EGL), preferably on
+ * a display enumerated by EGL_EXT_device_enumeration, so that neither an X server
+ * nor a window is required. Alternatively, Mesa's off-screen interface can be used
+ * (define TGT_WITH_OSMESA), which renders in software into a buffer in main memory.
+ * Without either backend, init() fails and hasContext() returns false.
+ *
+ * Several canvases can share the context of the first one, each rendering into its
+ * own pbuffer (EGL) or image buffer (OSMesa).
+ *
+ * @note GLEW has to be built with support for the respective backend
+ *       (GLEW_EGL or GLEW_OSMESA), since it resolves the extension entry points
+ *       through glXGetProcAddress otherwise.
+ */
+class OffscreenCanvas : public GLCanvas {
+public:
+    /**
+     * @param sharedCanvas if not null, the canvas renders with the context of this canvas,
+     *      which has to be initialized before and must outlive this canvas
+     */
+    OffscreenCanvas(const std::string& title = "",
+                    const ivec2& size = ivec2(DEFAULT_WINDOW_WIDTH, DEFAULT_WINDOW_HEIGHT),
+                    const GLCanvas::Buffers buffers = RGBAD,
+                    OffscreenCanvas* sharedCanvas = 0);
+
+    virtual ~OffscreenCanvas();
+
+    /// Creates the context, if not shared, and the drawable of the canvas.
+    virtual void init();
+
+    /// Returns true, if init() has successfully created the context.
+    bool hasContext() const;
+
+    /// Flushes the rendering commands, since there is no front buffer to swap.
+    virtual void swap();
+
+    /// Makes the context current on the drawable of this canvas.
+    virtual void getGLFocus();
+
+    /// Not available without a window.
+    virtual void toggleFullScreen();
+
+    /// Paints the canvas immediately.
+    virtual void repaint();
+
+    /// Same as repaint(), since there is no event loop to defer the painting to.
+    virtual void update();
+
+    /// Recreates the drawable with the passed size and notifies the painter.
+    void resize(const ivec2& size);
+
+    /// Returns the name of the compiled-in backend ("EGL", "OSMesa" or "none").
+    static std::string getBackendName();
+
+private:
+    bool createContext();
+    bool createDrawable();
+    void destroyDrawable();
+
+    OffscreenCanvas* sharedCanvas_;
+
+    // EGL: EGLDisplay, EGLConfig, EGLContext and EGLSurface;
+    // OSMesa: the OSMesaContext (context_) only
+    void* display_;
+    void* config_;
+    void* context_;
+    void* surface_;
+
+    std::vector<unsigned char> buffer_; ///< OSMesa color buffer
+
+    static const std::string loggerCat_;
+};
+
+} // namespace tgt
+
+#endif // TGT_OFFSCREENCANVAS_H
@@ -29,6 +29,7 @@
 
 #include <iostream>
 #include <fstream>
+#include <iomanip>
 
 using std::string;
 
@@ -409,9 +410,7 @@ void ShaderObject::setDirectives(GLuint id) {
 	glProgramParameteriEXT(id, GL_GEOMETRY_VERTICES_OUT_EXT, verticesOut_);
 }
 
-bool ShaderObject::compileShader() {
-    isCompiled_ = false;
-
+void ShaderObject::preprocess() {
     ShaderPreprocessor p(this);
     source_ = p.getResult();
 
@@ -423,7 +422,16 @@ bool ShaderObject::compileShader() {
         if (p.getGeomShaderVerticesOut())
             verticesOut_ = p.getGeomShaderVerticesOut();        
     }
-    
+}
+
+bool ShaderObject::compileShader() {
+    isCompiled_ = false;
+    preprocess();
+    return compilePreprocessed();
+}
+
+bool ShaderObject::compilePreprocessed() {
+    isCompiled_ = false;
     uploadSource();
 
     glCompileShader(id_);
@@ -614,6 +622,12 @@ void Shader::detachObjectsByType(ShaderObject::ShaderType type) {
 }
 
 bool Shader::linkProgram() {
+    // objects are left uncompiled, if the program has been restored from the program cache
+    for (ShaderObjects::iterator iter = objects_.begin(); iter != objects_.end(); ++iter) {
+        if (!(*iter)->isCompiled())
+            (*iter)->compileShader();
+    }
+
     if (isLinked_) {
         // program is already linked: detach and re-attach everything
         for (ShaderObjects::iterator iter = objects_.begin(); iter != objects_.end(); ++iter) {
@@ -631,6 +645,7 @@ bool Shader::linkProgram() {
 
     isLinked_ = false;
     glLinkProgram(id_);
+    resetUniformLocations();
     GLint check = 0;
     glGetProgramiv(id_, GL_LINK_STATUS, &check);
     if (check)
@@ -639,6 +654,10 @@ bool Shader::linkProgram() {
     return isLinked_;
 }
 
+void Shader::resetUniformLocations() {
+    uniformLocations_.clear();
+}
+
 string Shader::getLinkerLog() const {
     GLint len;
     glGetProgramiv(id_, GL_INFO_LOG_LENGTH , &len);
@@ -658,33 +677,69 @@ string Shader::getLinkerLog() const {
 }
 
 bool Shader::rebuild() {
-    if (isLinked_) {
-        // program is already linked: detach and re-attach everything
-        for (ShaderObjects::iterator iter = objects_.begin(); iter != objects_.end(); ++iter) {
-            glDetachShader(id_, (*iter)->id_);
-            (*iter)->uploadSource();
-            if (!(*iter)->compileShader()) {
-                LERROR("Failed to compile shader object.");
-                LERROR("Compiler Log: \n" << (*iter)->getCompilerLog());
-                return false;
-            }
-            
-            glAttachShader(id_, (*iter)->id_);
+    if (buildProgram())
+        return true;
+
+    for (ShaderObjects::iterator iter = objects_.begin(); iter != objects_.end(); ++iter) {
+        if (!(*iter)->isCompiled()) {
+            LERROR("Failed to compile shader object " << (*iter)->filename_);
+            LERROR("Compiler Log: \n" << (*iter)->getCompilerLog());
+            return false;
         }
     }
+    LERROR("Shader::rebuild(): Failed to link shader." );
+    LERROR("Linker Log: \n" << getLinkerLog());
+    return false;
+}
+
+bool Shader::buildProgram() {
     isLinked_ = false;
-    glLinkProgram(id_);
-    GLint check = 0;
-    glGetProgramiv(id_, GL_LINK_STATUS, &check);
 
-    if (check) {
-        isLinked_ = true;
-        return true;
-    } else {
-        LERROR("Shader::rebuild(): Failed to link shader." );
-        LERROR("Linker Log: \n" << getLinkerLog());
+    const bool useCache = ShaderManager::isInited() && ShdrMgr.useProgramCache();
+    std::string key;
+    bool compiled = true;
+    if (useCache) {
+        for (ShaderObjects::iterator iter = objects_.begin(); iter != objects_.end(); ++iter)
+            (*iter)->preprocess();
+
+        key = getProgramCacheKey();
+        if (ShdrMgr.restoreProgram(this, key)) {
+            resetUniformLocations();
+            isLinked_ = true;
+            return true;
+        }
+
+        glProgramParameteri(id_, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        for (ShaderObjects::iterator iter = objects_.begin(); iter != objects_.end(); ++iter)
+            compiled &= (*iter)->compilePreprocessed();
+    }
+    else {
+        for (ShaderObjects::iterator iter = objects_.begin(); iter != objects_.end(); ++iter)
+            compiled &= (*iter)->compileShader();
+    }
+
+    if (!compiled || !linkProgram())
         return false;
+
+    if (useCache)
+        ShdrMgr.storeProgram(this, key);
+    return true;
+}
+
+std::string Shader::getProgramCacheKey() const {
+    std::ostringstream key;
+    for (ShaderObjects::const_iterator iter = objects_.begin(); iter != objects_.end(); ++iter) {
+        const ShaderObject* obj = *iter;
+        key << "#object " << obj->shaderType_ << "\n";
+        if (obj->shaderType_ == ShaderObject::GEOMETRY_SHADER)
+            key << obj->inputType_ << " " << obj->outputType_ << " " << obj->verticesOut_ << "\n";
+        key << obj->source_.size() << "\n" << obj->source_;
     }
+    for (std::map<std::string, GLuint>::const_iterator it = fragDataLocations_.begin(); it != fragDataLocations_.end(); ++it)
+        key << "#fragdata " << it->first << " " << it->second << "\n";
+    for (std::map<std::string, GLuint>::const_iterator it = attributeLocations_.begin(); it != attributeLocations_.end(); ++it)
+        key << "#attribute " << it->first << " " << it->second << "\n";
+    return key.str();
 }
 
 bool Shader::rebuildFromFile() {
@@ -707,6 +762,7 @@ void Shader::setHeaders(const string& customHeader) {
 void Shader::bindFragDataLocation(GLuint colorNumber, std::string name) {
     if (GpuCaps.getShaderVersion() >= GpuCapabilities::GlVersion::SHADER_VERSION_130) {
         glBindFragDataLocationEXT(id_, colorNumber, name.c_str());
+        fragDataLocations_[name] = colorNumber;
     }
 }
 
@@ -737,15 +793,6 @@ void Shader::loadSeparate(const string& vert_filename, const string& geom_filena
             delete vert;
             throw Exception("Failed to load vertex shader " + vert_filename + ": " + e.what());
         }
-
-        vert->uploadSource();
-
-        if (!vert->compileShader()) {
-            LERROR("Failed to compile vertex shader " << vert_filename);
-            LERROR("Compiler Log: \n" << vert->getCompilerLog());
-            delete vert;
-            throw Exception("Failed to compile vertex shader: " + vert_filename);
-        }
     }
 
 	if (!geom_filename.empty()) {
@@ -764,15 +811,6 @@ void Shader::loadSeparate(const string& vert_filename, const string& geom_filena
             delete geom;
             throw Exception("Failed to load geometry shader " + geom_filename + ": " + e.what());
         }
-
-        geom->uploadSource();
-        if (!geom->compileShader()) {
-            LERROR("Failed to compile geometry shader " << geom_filename);
-            LERROR("Compiler Log: \n" << geom->getCompilerLog());
-            delete vert;
-            delete geom;
-            throw Exception("Failed to compile geometry shader: " + geom_filename);
-        }
     }
 
     if (!frag_filename.empty()) {
@@ -795,17 +833,6 @@ void Shader::loadSeparate(const string& vert_filename, const string& geom_filena
             
         if (GpuCaps.getShaderVersion() >= GpuCapabilities::GlVersion::SHADER_VERSION_130)
             bindFragDataLocation(0, "FragData0");
-
-        frag->uploadSource();
-
-        if (!frag->compileShader()) {
-            LERROR("Failed to compile fragment shader " << frag_filename);
-            LERROR("Compiler Log: \n" << frag->getCompilerLog());
-            delete vert;
-            delete geom;
-            delete frag;
-            throw Exception("Failed to compile fragment shader: " + frag_filename);               
-        }
     }
 
     // Attach ShaderObjects, dtor will take care of freeing them
@@ -816,29 +843,54 @@ void Shader::loadSeparate(const string& vert_filename, const string& geom_filena
 	if (geom)
         attachObject(geom);
 
-    if (!linkProgram()) {
-        LERROR("Failed to link shader (" << vert_filename << ","  << frag_filename << "," << geom_filename << ")");
+    // compile and link, unless the program binary is cached
+    if (!buildProgram()) {
+        string error;
+        if (vert && !vert->isCompiled()) {
+            LERROR("Failed to compile vertex shader " << vert_filename);
+            LERROR("Compiler Log: \n" << vert->getCompilerLog());
+            error = "Failed to compile vertex shader: " + vert_filename;
+        }
+        else if (geom && !geom->isCompiled()) {
+            LERROR("Failed to compile geometry shader " << geom_filename);
+            LERROR("Compiler Log: \n" << geom->getCompilerLog());
+            error = "Failed to compile geometry shader: " + geom_filename;
+        }
+        else if (frag && !frag->isCompiled()) {
+            LERROR("Failed to compile fragment shader " << frag_filename);
+            LERROR("Compiler Log: \n" << frag->getCompilerLog());
+            error = "Failed to compile fragment shader: " + frag_filename;
+        }
+        else {
+            LERROR("Failed to link shader (" << vert_filename << ","  << frag_filename << "," << geom_filename << ")");
+            if (vert) {
+                LERROR(vert->filename_ << " Vertex shader compiler log: \n" << vert->getCompilerLog());
+            }
+            if (geom) {
+                LERROR(geom->filename_ << " Geometry shader compiler log: \n" << geom->getCompilerLog());
+            }
+            if (frag) {
+                LERROR(frag->filename_ << " Fragment shader compiler log: \n" << frag->getCompilerLog());
+            }
+            LERROR("Linker Log: \n" << getLinkerLog());
+            error = "Failed to link shader (" + vert_filename + "," + frag_filename + "," + geom_filename + ")";
+        }
+
         if (vert) {
-            LERROR(vert->filename_ << " Vertex shader compiler log: \n" << vert->getCompilerLog());
             detachObject(vert);
             delete vert;
         }
         if (geom) {
-            LERROR(geom->filename_ << " Geometry shader compiler log: \n" << geom->getCompilerLog());
             detachObject(geom);
             delete geom;
         }
 		if (frag) {
-            LERROR(frag->filename_ << " Fragment shader compiler log: \n" << frag->getCompilerLog());
             detachObject(frag);
             delete frag;
         }
-
-        LERROR("Linker Log: \n" << getLinkerLog());
-        throw Exception("Failed to link shader (" + vert_filename + "," + frag_filename + "," + geom_filename + ")");
+        throw Exception(error);
     }
 
-
     if (vert && vert->getCompilerLog().size() > 1) {
         LDEBUG("Vertex shader compiler log for file '" << vert_filename
                << "': \n" << vert->getCompilerLog());
@@ -861,7 +913,13 @@ void Shader::loadSeparate(const string& vert_filename, const string& geom_filena
 
 GLint Shader::getUniformLocation(const string& name) {
     GLint l;
-    l = glGetUniformLocation(id_, name.c_str());
+    std::map<string, GLint>::const_iterator it = uniformLocations_.find(name);
+    if (it != uniformLocations_.end())
+        l = it->second;
+    else {
+        l = glGetUniformLocation(id_, name.c_str());
+        uniformLocations_.insert(std::make_pair(name, l));
+    }
     if (l == -1 && !ignoreError_)
         LWARNING("Failed to locate uniform Location: " << name);
     return l;
@@ -1355,6 +1413,7 @@ void Shader::setAttribute(GLint index, const Vector4<GLuint>& v) {
 // Attribute locations
 void Shader::setAttributeLocation(GLuint index, const std::string& name) {
     glBindAttribLocation(id_, index, name.c_str());
+    attributeLocations_[name] = index;
 }
 
 GLint Shader::getAttributeLocation(const string& name) {
@@ -1402,6 +1461,8 @@ SINGLETON_CLASS_SOURCE(ShaderManager)
 
 ShaderManager::ShaderManager()
   : ResourceManager<Shader>(false)
+  , programCacheEnabled_(true)
+  , programCacheSupported_(-1)
 {}
 
 Shader* ShaderManager::load(const string& filename, const string& customHeader,
@@ -1483,4 +1544,149 @@ bool ShaderManager::rebuildAllShadersFromFile() {
     return result;
 }
 
+void ShaderManager::setProgramCacheEnabled(bool enabled) {
+    programCacheEnabled_ = enabled;
+}
+
+bool ShaderManager::isProgramCacheEnabled() const {
+    return programCacheEnabled_;
+}
+
+void ShaderManager::setProgramCachePath(const string& path) {
+    programCachePath_ = path;
+    if (!programCachePath_.empty() && !FileSys.dirExists(programCachePath_)) {
+        if (!FileSys.createDirectoryRecursive(programCachePath_)) {
+            LWARNING("Failed to create program cache directory " << programCachePath_ << ". Program binaries are kept in memory only.");
+            programCachePath_.clear();
+        }
+    }
+}
+
+string ShaderManager::getProgramCachePath() const {
+    return programCachePath_;
+}
+
+void ShaderManager::clearProgramCache() {
+    programCache_.clear();
+}
+
+bool ShaderManager::useProgramCache() {
+    if (!programCacheEnabled_)
+        return false;
+
+    if (programCacheSupported_ < 0) {
+        GLint numFormats = 0;
+        if (GLEW_ARB_get_program_binary)
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+        programCacheSupported_ = (numFormats > 0 ? 1 : 0);
+        if (!programCacheSupported_)
+            LINFO("Program binaries not supported, program cache disabled");
+
+        // binaries are only valid for the driver they have been created by
+        const GLubyte* vendor = glGetString(GL_VENDOR);
+        const GLubyte* renderer = glGetString(GL_RENDERER);
+        const GLubyte* version = glGetString(GL_VERSION);
+        driverString_ = string(vendor ? reinterpret_cast<const char*>(vendor) : "") + "\n"
+            + (renderer ? reinterpret_cast<const char*>(renderer) : "") + "\n"
+            + (version ? reinterpret_cast<const char*>(version) : "");
+    }
+    return (programCacheSupported_ == 1);
+}
+
+string ShaderManager::getProgramHash(const string& key, string& fullKey) {
+    fullKey = key + "#driver\n" + driverString_;
+
+    // 64 bit FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < fullKey.size(); ++i) {
+        hash ^= static_cast<unsigned char>(fullKey[i]);
+        hash *= 1099511628211ULL;
+    }
+
+    std::ostringstream str;
+    str << std::hex << std::setw(16) << std::setfill('0') << hash << "_" << std::dec << fullKey.size();
+    return str.str();
+}
+
+bool ShaderManager::restoreProgram(Shader* shader, const string& key) {
+    string fullKey;
+    string hash = getProgramHash(key, fullKey);
+
+    std::map<string, ProgramBinary>::iterator it = programCache_.find(hash);
+    if (it == programCache_.end() && !programCachePath_.empty()) {
+        // not yet used in this session: look up the cache directory
+        string filename = programCachePath_ + "/" + hash + ".bin";
+        std::ifstream file(filename.c_str(), std::ios::binary);
+        if (file.good()) {
+            uint32_t keyLength = 0;
+            uint32_t format = 0;
+            uint32_t dataLength = 0;
+            file.read(reinterpret_cast<char*>(&keyLength), sizeof(keyLength));
+            file.read(reinterpret_cast<char*>(&format), sizeof(format));
+            file.read(reinterpret_cast<char*>(&dataLength), sizeof(dataLength));
+
+            ProgramBinary binary;
+            if (file.good() && keyLength == fullKey.size() && dataLength > 0) {
+                binary.key_.resize(keyLength);
+                binary.data_.resize(dataLength);
+                file.read(&binary.key_[0], keyLength);
+                file.read(&binary.data_[0], dataLength);
+                binary.format_ = static_cast<GLenum>(format);
+            }
+            if (file.good() && binary.key_ == fullKey)
+                it = programCache_.insert(std::make_pair(hash, binary)).first;
+        }
+    }
+
+    if (it == programCache_.end() || it->second.key_ != fullKey)
+        return false;
+
+    const ProgramBinary& binary = it->second;
+    glProgramBinary(shader->id_, binary.format_, &binary.data_[0], static_cast<GLsizei>(binary.data_.size()));
+    GLint check = 0;
+    glGetProgramiv(shader->id_, GL_LINK_STATUS, &check);
+    if (!check) {
+        // rejected by the driver, e.g., after an update: rebuild from source
+        LDEBUG("Cached program binary rejected by the driver");
+        programCache_.erase(it);
+        return false;
+    }
+    return true;
+}
+
+void ShaderManager::storeProgram(Shader* shader, const string& key) {
+    GLint length = 0;
+    glGetProgramiv(shader->id_, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    ProgramBinary binary;
+    string hash = getProgramHash(key, binary.key_);
+    binary.data_.resize(length);
+    GLsizei written = 0;
+    glGetProgramBinary(shader->id_, length, &written, &binary.format_, &binary.data_[0]);
+    if (written <= 0)
+        return;
+    binary.data_.resize(written);
+    programCache_[hash] = binary;
+
+    if (!programCachePath_.empty()) {
+        string filename = programCachePath_ + "/" + hash + ".bin";
+        std::ofstream file(filename.c_str(), std::ios::binary);
+        uint32_t keyLength = static_cast<uint32_t>(binary.key_.size());
+        uint32_t format = static_cast<uint32_t>(binary.format_);
+        uint32_t dataLength = static_cast<uint32_t>(binary.data_.size());
+        file.write(reinterpret_cast<const char*>(&keyLength), sizeof(keyLength));
+        file.write(reinterpret_cast<const char*>(&format), sizeof(format));
+        file.write(reinterpret_cast<const char*>(&dataLength), sizeof(dataLength));
+        file.write(binary.key_.data(), keyLength);
+        file.write(&binary.data_[0], dataLength);
+        if (!file.good()) {
+            LWARNING("Failed to write program binary " << filename);
+            file.close();
+            FileSys.deleteFile(filename);
+        }
+    }
+}
+
 } // namespace
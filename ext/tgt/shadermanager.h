@@ -26,7 +26,9 @@
 #define TGT_SHADERMANAGER_H
 
 #include <list>
+#include <map>
 #include <string>
+#include <vector>
 
 #include "tgt/exception.h"
 #include "tgt/manager.h"
@@ -104,6 +106,12 @@ public:
      */
 	void setDirectives(GLuint id);
 
+    /**
+     * Resolves the includes and the geometry shader directives of the source.
+     * Called by compileShader().
+     */
+    void preprocess();
+
     bool compileShader();
 
     bool isCompiled() const { return isCompiled_; }
@@ -152,6 +160,9 @@ public:
 protected:
     void uploadSource();
 
+    /// Uploads and compiles the preprocessed source.
+    bool compilePreprocessed();
+
 	std::string filename_;
     ShaderType shaderType_;
 
@@ -235,7 +246,8 @@ public:
     //
 
     /**
-     * Returns uniform location, or -1 on failure
+     * Returns uniform location, or -1 on failure.
+     * Locations are cached until the program is relinked.
      */
     GLint getUniformLocation(const std::string& name);
     
@@ -387,6 +399,21 @@ protected:
 		const std::string& fragFilename, const std::string& customHeader = "")
         throw (Exception);
 
+    /**
+     * Compiles and links the attached shader objects, unless the program
+     * binary is found in the program cache of the ShaderManager.
+     *
+     * @return true if the program has been linked
+     */
+    bool buildProgram();
+
+    /**
+     * Returns a string identifying the program binary: the preprocessed
+     * sources, the geometry shader directives and the bound locations.
+     * Requires preprocessed shader objects.
+     */
+    std::string getProgramCacheKey() const;
+
     typedef std::list<ShaderObject*> ShaderObjects;
     ShaderObjects objects_;
 
@@ -394,6 +421,14 @@ protected:
     bool isLinked_;
     bool ignoreError_;
 
+    /// Discards the cached uniform locations, to be called whenever the program has been (re)linked.
+    void resetUniformLocations();
+
+    std::map<std::string, GLuint> fragDataLocations_;   ///< bindings affect the linked program
+    std::map<std::string, GLuint> attributeLocations_;
+
+    std::map<std::string, GLint> uniformLocations_;     ///< locations of the current link, including failed lookups
+
     static const std::string loggerCat_;
 };
 
@@ -467,7 +502,50 @@ public:
 
     bool rebuildAllShadersFromFile();
 
+    /**
+     * Enables or disables the cache of linked program binaries, which saves
+     * the compilation and linking of programs that have been built before.
+     * Programs are identified by a hash of their preprocessed sources and the
+     * OpenGL driver. The cache is held in memory and, if a path has been set,
+     * persisted on disk. Requires GL_ARB_get_program_binary. Enabled by default.
+     */
+    void setProgramCacheEnabled(bool enabled);
+    bool isProgramCacheEnabled() const;
+
+    /// Sets the directory the program binaries are persisted in. Pass an empty string to keep them in memory only.
+    void setProgramCachePath(const std::string& path);
+    std::string getProgramCachePath() const;
+
+    /// Discards the program binaries held in memory.
+    void clearProgramCache();
+
 protected:
+    friend class Shader;
+
+    struct ProgramBinary {
+        std::string key_;
+        GLenum format_;
+        std::vector<char> data_;
+    };
+
+    /// Returns whether program binaries are supported and enabled.
+    bool useProgramCache();
+
+    /// Loads the cached binary of the program identified by \p key into \p shader, if present.
+    bool restoreProgram(Shader* shader, const std::string& key);
+
+    /// Adds the binary of the linked program of \p shader to the cache.
+    void storeProgram(Shader* shader, const std::string& key);
+
+    /// Appends the OpenGL vendor, renderer and version to \p key and hashes it.
+    std::string getProgramHash(const std::string& key, std::string& fullKey);
+
+    bool programCacheEnabled_;
+    int programCacheSupported_;     ///< -1: not yet determined
+    std::string programCachePath_;
+    std::string driverString_;
+    std::map<std::string, ProgramBinary> programCache_;    ///< binaries by hash
+
     static const std::string loggerCat_;   
 };
 
@@ -210,6 +210,12 @@ std::string TextureManager::getEnding(const std::string& filename) const {
     return ending;
 }
 
+bool TextureManager::isSupported(const std::string& filename) const {
+    std::string ending = getEnding(filename);
+    std::transform (ending.begin(), ending.end(), ending.begin(), lower_case);
+    return (readers_.find(ending) != readers_.end());
+}
+
 void TextureManager::registerReader(TextureReader* r) {
     readerSet_.insert(r);
     LDEBUG("TextureManager: Registering reader: " << r->getName());
@@ -73,6 +73,11 @@ public:
     */
     void registerReader(TextureReader* r);
 
+    /**
+    *   Returns whether a registered TextureReader supports the file's ending.
+    */
+    bool isSupported(const std::string& filename) const;
+
     /**
     *   Loads a texture from file.
     *   @param filename Texture Filename
@@ -89,6 +89,7 @@ SOURCES += \
     gpucapabilitieswindows.cpp \
     init.cpp \
     light.cpp \
+    mutex.cpp \
     naturalcubicspline.cpp \
     painter.cpp \
     physmem.cpp \
@@ -139,6 +140,7 @@ HEADERS += \
     tgt_math.h \
     matrix.h \
     mouse.h \
+    mutex.h \
     naturalcubicspline.h \
     painter.h \
     physmem.h \
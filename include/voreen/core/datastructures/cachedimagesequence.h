@@ -0,0 +1,129 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef VRN_CACHEDIMAGESEQUENCE_H
+#define VRN_CACHEDIMAGESEQUENCE_H
+
+#include "voreen/core/datastructures/imagesequence.h"
+#include "voreen/core/voreencoredefine.h"
+
+#include "tgt/texture.h"
+
+#include <list>
+#include <set>
+
+namespace voreen {
+
+/**
+ * ImageSequence that loads its images on first access and keeps only the most
+ * recently used ones in memory, within a budget of texture bytes.
+ *
+ * The sequence owns the textures of the images added by addImage(). These remain
+ * valid as long as the sequence exists: evicting an image only frees the texture's
+ * data, which is reloaded on the next call of at().
+ */
+class VRN_CORE_API CachedImageSequence : public ImageSequence {
+
+public:
+
+    /**
+     * @param cacheSize maximum number of bytes of the loaded textures.
+     *        The most recently accessed texture is kept even if it exceeds the budget.
+     * @param filter filter mode of the loaded textures
+     * @param uploadTextures if true, the images are loaded as OpenGL textures,
+     *        otherwise only their pixel data is kept
+     */
+    CachedImageSequence(size_t cacheSize, tgt::Texture::Filter filter = tgt::Texture::LINEAR,
+                        bool uploadTextures = true);
+
+    /// Deletes the textures of the added images.
+    virtual ~CachedImageSequence();
+
+    /**
+     * Appends an image file to the sequence, which is loaded on first access.
+     */
+    virtual void addImage(const std::string& filename);
+
+    /**
+     * Adds the passed texture, which is neither loaded nor evicted by the sequence.
+     */
+    virtual void add(tgt::Texture* texture);
+
+    virtual void remove(const tgt::Texture* texture);
+    virtual void remove(size_t i);
+
+    /**
+     * Returns the texture at the specified index position, after loading
+     * its image if it is not in memory.
+     */
+    virtual tgt::Texture* at(size_t i) const;
+
+    virtual tgt::Texture* front() const;
+    virtual tgt::Texture* back() const;
+
+    /**
+     * Clears the sequence and deletes the textures of the added images.
+     */
+    virtual void clear();
+
+    /**
+     * Sets the maximum number of bytes of the loaded textures
+     * and evicts the least recently used ones exceeding it.
+     */
+    void setCacheSize(size_t cacheSize);
+
+    size_t getCacheSize() const;
+
+    /// Returns the number of bytes of the currently loaded textures.
+    size_t getNumCachedBytes() const;
+
+protected:
+    /// Loads the image of the texture at position \p i into it.
+    bool load(size_t i) const;
+
+    /// Frees the data of the passed texture.
+    void evict(tgt::Texture* texture) const;
+
+    /// Evicts the least recently used textures, until the loaded ones fit into the cache.
+    void shrink() const;
+
+    std::vector<std::string> filenames_;        ///< image files, empty for added textures
+    size_t cacheSize_;
+    tgt::Texture::Filter filter_;
+    bool uploadTextures_;
+
+    mutable std::list<tgt::Texture*> loaded_;   ///< loaded textures, most recently used first
+    mutable std::set<const tgt::Texture*> failed_;  ///< textures whose image could not be loaded
+    mutable size_t cachedBytes_;
+
+    static const std::string loggerCat_;
+};
+
+}   // namespace
+
+#endif
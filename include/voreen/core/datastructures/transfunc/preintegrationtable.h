@@ -0,0 +1,127 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef VRN_PREINTEGRATIONTABLE_H
+#define VRN_PREINTEGRATIONTABLE_H
+
+#include "voreen/core/voreencoredefine.h"
+#include "tgt/vector.h"
+
+#include <string>
+#include <vector>
+
+namespace tgt {
+    class Texture;
+}
+
+namespace voreen {
+
+/**
+ * Pre-integrated lookup table for a 1D transfer function.
+ *
+ * Entry (sf, sb) holds the color and opacity of a ray segment of length
+ * samplingStepSize whose scalar value varies linearly from the front sample sf
+ * to the back sample sb. Colors are stored non-premultiplied and the opacity
+ * already accounts for the segment length, so no opacity correction must be
+ * applied during compositing.
+ *
+ * The integrals are evaluated via the summed-area tables (prefix sums) of the
+ * extinction and the extinction-weighted color of the transfer function, which
+ * are kept between updates: changing only the sampling step size recomputes the
+ * opacities without re-integrating the transfer function.
+ *
+ * Entry i refers to the scalar value (i+0.5)/dimension.
+ */
+class VRN_CORE_API PreIntegrationTable {
+public:
+    /**
+     * @param dimension number of front and back scalar bins
+     */
+    PreIntegrationTable(size_t dimension = 256);
+    ~PreIntegrationTable();
+
+    /**
+     * Computes the table.
+     *
+     * @param classification RGBA values in [0,1] of the transfer function at the bin centers.
+     *      The opacities refer to the base sampling interval 1/SAMPLING_BASE_INTERVAL_RCP,
+     *      as for the regular opacity correction. The size has to match the table dimension.
+     * @param samplingStepSize length of the ray segments in texture coordinates
+     */
+    void compute(const std::vector<tgt::vec4>& classification, float samplingStepSize);
+
+    /**
+     * Recomputes the opacities for another ray segment length, reusing the integrals
+     * of the last compute() call. Does nothing if the step size has not changed.
+     */
+    void setSamplingStepSize(float samplingStepSize);
+
+    float getSamplingStepSize() const;
+
+    size_t getDimension() const;
+
+    /// Returns the entry for the given front and back bin.
+    tgt::vec4 getEntry(size_t front, size_t back) const;
+
+    /// Returns the bilinearly interpolated entry for the given front and back scalar values in [0,1].
+    tgt::vec4 lookup(float front, float back) const;
+
+    /// Returns the row-major table data (the back sample selects the row).
+    const tgt::vec4* getData() const;
+
+    /**
+     * Returns a 2D float texture holding the table, with the front sample
+     * along the x axis. The texture is created resp. updated on demand and
+     * therefore requires an active OpenGL context.
+     */
+    tgt::Texture* getTexture();
+
+    /// Reciprocal of the base sampling interval the transfer function opacities refer to.
+    static const float SAMPLING_BASE_INTERVAL_RCP;
+
+private:
+    /// Fills the table from the prefix sums for the current step size.
+    void integrate();
+
+    size_t dimension_;
+    float samplingStepSize_;
+
+    std::vector<double> extinctionIntegral_; ///< prefix sums of the extinction per bin
+    std::vector<tgt::dvec3> colorIntegral_;  ///< prefix sums of extinction-weighted color per bin
+    std::vector<tgt::vec4> pointValues_;     ///< classification at the bin centers
+    std::vector<tgt::vec4> table_;
+
+    tgt::Texture* tex_;
+    bool textureInvalid_;
+
+    static const std::string loggerCat_;
+};
+
+} // namespace voreen
+
+#endif // VRN_PREINTEGRATIONTABLE_H
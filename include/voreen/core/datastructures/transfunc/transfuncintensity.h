@@ -30,12 +30,14 @@
 #define VRN_TRANSFUNCINTENSITY_H
 
 #include "voreen/core/datastructures/transfunc/transfunc.h"
+#include "voreen/core/datastructures/transfunc/transfunclookuptable.h"
 
 #include "tgt/vector.h"
 
 namespace voreen {
 
 class TransFuncMappingKey;
+class PreIntegrationTable;
 
 /**
  * One dimensional, piece-wise linear transfer function based on key values.
@@ -114,6 +116,24 @@ public:
      */
     tgt::col4 getMappingForValue(float value) const;
 
+    /**
+     * Returns the value to which the input value is being mapped, in float precision.
+     * The enclosing keys are found by binary search. Thresholds are not applied.
+     *
+     * @param value the intensity value for which the mapping is requested
+     * @return the RGBA value in [0,1] the input value is mapped to
+     */
+    tgt::vec4 getMappingForValueFloat(float value) const;
+
+    /**
+     * Returns a float lookup table of the transfer function including the thresholds,
+     * for classifying many samples on the CPU. The table is cached and only refilled
+     * when the keys, thresholds or domain have changed.
+     *
+     * @param resolution number of table entries
+     */
+    const TransFuncLookupTable& getLookupTable(size_t resolution = 4096);
+
     /**
      * Returns the number of keys in this transfer function.
      *
@@ -275,6 +295,16 @@ public:
     virtual void setDomain(tgt::vec2 domain, int dimension = 0);
     virtual void setDomain(float lower, float upper, int dimension) { setDomain(tgt::vec2(lower, upper), dimension); } 
 
+    /**
+     * Returns the pre-integration table of the transfer function for the given sampling step size.
+     * The table is cached: it is only re-integrated when the keys, thresholds or domain have changed
+     * since the last call, whereas a changed step size merely updates the opacities.
+     *
+     * @param samplingStepSize length of the ray segments in texture coordinates
+     * @param dimension number of bins per table axis, 0 selects the width of the transfer function
+     */
+    PreIntegrationTable* getPreIntegrationTable(float samplingStepSize, size_t dimension = 0);
+
 protected:
     /**
      * Loads a transfer function from an file with ending tfi.
@@ -358,6 +388,12 @@ protected:
      */
     void generateKeys(unsigned char* data);
 
+    /**
+     * Returns the state the classification depends on (keys, thresholds, domain)
+     * together with the given resolution, for detecting changes of cached tables.
+     */
+    std::vector<float> getStateSignature(size_t resolution) const;
+
     std::vector<TransFuncMappingKey*> keys_; ///< internal representation of the transfer function as a set of keys
 
     float lowerThreshold_; ///< lower threshold
@@ -365,6 +401,12 @@ protected:
 
     tgt::vec2 domain_;
 
+    PreIntegrationTable* preIntegrationTable_;       ///< cached pre-integration table, created on demand
+    std::vector<float> preIntegrationSignature_;    ///< transfer function state the cached table refers to
+
+    TransFuncLookupTable lookupTable_;              ///< cached float lookup table
+    std::vector<float> lookupTableSignature_;       ///< transfer function state the lookup table refers to
+
     static const std::string loggerCat_; ///< logger category
 };
 
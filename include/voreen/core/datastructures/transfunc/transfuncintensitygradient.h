@@ -30,6 +30,7 @@
 #define VRN_TRANSFUNCINTENSITYGRADIENT_H
 
 #include "voreen/core/datastructures/transfunc/transfunc.h"
+#include "voreen/core/datastructures/transfunc/transfunclookuptable.h"
 
 namespace tgt {
     class FramebufferObject;
@@ -172,6 +173,14 @@ public:
      */
     void updateTexture();
 
+    /**
+     * Returns a float lookup table with the dimensions of the transfer function,
+     * indexed by intensity and gradient magnitude. The primitives are rasterized
+     * on the CPU like they are painted into the texture, so no OpenGL context is
+     * required. The table is cached and only refilled when a primitive has changed.
+     */
+    const TransFuncLookupTable& getLookupTable();
+
     /**
      * Returns the i.th primitive of the transfer function or 0
      * if no such primitive exists.
@@ -230,6 +239,9 @@ protected:
 private:
     tgt::FramebufferObject* fbo_;        ///< used for rendering the primitives to the texture
 
+    TransFuncLookupTable lookupTable_;             ///< cached CPU lookup table
+    std::vector<float> lookupTableSignature_;      ///< primitive geometry the lookup table refers to
+
     static const std::string loggerCat_; ///< the logger category
 };
 
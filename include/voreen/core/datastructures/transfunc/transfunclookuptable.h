@@ -0,0 +1,85 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef VRN_TRANSFUNCLOOKUPTABLE_H
+#define VRN_TRANSFUNCLOOKUPTABLE_H
+
+#include "voreen/core/voreencoredefine.h"
+#include "tgt/vector.h"
+
+#include <vector>
+
+namespace voreen {
+
+/**
+ * Float-precision lookup table of a 1D or 2D transfer function for CPU-side
+ * classification, so that no GL texture has to be downloaded.
+ *
+ * Entry (i, j) holds the RGBA value in [0,1] for the normalized coordinates
+ * (i/(width-1), j/(height-1)). Lookups interpolate linearly between the entries
+ * and clamp coordinates to [0,1]. All lookup functions are const and may be called
+ * concurrently.
+ */
+class VRN_CORE_API TransFuncLookupTable {
+public:
+    TransFuncLookupTable();
+
+    /// Resizes the table and clears all entries.
+    void resize(size_t width, size_t height = 1);
+
+    size_t getWidth() const;
+    size_t getHeight() const;
+
+    /// Returns the row-major table data.
+    tgt::vec4* getData();
+    const tgt::vec4* getData() const;
+
+    /// Returns the linearly interpolated value for the normalized intensity.
+    tgt::vec4 lookup(float intensity) const;
+
+    /// Returns the bilinearly interpolated value for the normalized intensity and gradient magnitude.
+    tgt::vec4 lookup(float intensity, float gradientMagnitude) const;
+
+    /**
+     * Classifies count intensities at once, four at a time using SSE2 where available.
+     * Only the first row is used for 2D tables.
+     */
+    void lookup(const float* intensities, tgt::vec4* colors, size_t count) const;
+
+    /// Classifies count pairs of intensity and gradient magnitude at once.
+    void lookup(const float* intensities, const float* gradientMagnitudes, tgt::vec4* colors, size_t count) const;
+
+private:
+    size_t width_;
+    size_t height_;
+    std::vector<tgt::vec4> data_;
+};
+
+} // namespace voreen
+
+#endif // VRN_TRANSFUNCLOOKUPTABLE_H
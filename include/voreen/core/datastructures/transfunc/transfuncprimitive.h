@@ -34,6 +34,8 @@
 #include "tgt/vector.h"
 #include "tgt/tgt_gl.h"
 
+#include <vector>
+
 namespace voreen {
 
 /**
@@ -72,6 +74,13 @@ public:
      */
     virtual void paint() = 0;
 
+    /**
+     * Appends the triangles painted by paint() together with their vertex colors,
+     * so that the primitive can be rasterized without OpenGL. Each three consecutive
+     * vertices form one triangle; colors are RGBA in [0,1].
+     */
+    virtual void getTriangles(std::vector<tgt::vec2>& vertices, std::vector<tgt::vec4>& colors) const = 0;
+
     /**
      * Paints the primitive for display in an editor. An outline and control points are added.
      */
@@ -231,6 +240,11 @@ public:
      */
     void paint();
 
+    /**
+     * Returns the triangles of paint(), splitting each quad into two triangles.
+     */
+    void getTriangles(std::vector<tgt::vec2>& vertices, std::vector<tgt::vec4>& colors) const;
+
     /**
      * Paints the quad for selection purposes. Therefor the color used in painting is set
      * to [id, 123, 123].
@@ -339,6 +353,11 @@ public:
      */
     void paint();
 
+    /**
+     * Returns the triangles of the triangle strip painted by paint().
+     */
+    void getTriangles(std::vector<tgt::vec2>& vertices, std::vector<tgt::vec4>& colors) const;
+
     /**
      * Paints the banana for selection purposes. Therefor the color used in painting is set
      * to [id, 123, 123].
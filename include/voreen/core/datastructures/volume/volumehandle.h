@@ -234,6 +234,15 @@ public:
         addDerivedDataInternal<T>(data);
     }
 
+    /**
+     * Adds a derived data item whose type is only known at runtime,
+     * e.g., an item restored by deserialization.
+     *
+     * @note The handle takes ownership of the passed data item.
+     * @note An existing item of the same type is replaced and deleted.
+     */
+    void addDerivedData(VolumeDerivedData* data);
+
     /**
      * Removes and deletes the derived data item with the specified type T,
      * which must be a concrete subtype of VolumeDerivedData.
@@ -0,0 +1,73 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef VRN_VOLUMESTATISTICS_H
+#define VRN_VOLUMESTATISTICS_H
+
+#include "voreen/core/datastructures/volume/volume.h"
+#include "voreen/core/datastructures/volume/volumederiveddata.h"
+
+#include <vector>
+
+namespace voreen {
+
+/**
+ * Minimum, maximum, mean and standard deviation of each channel of a volume,
+ * converted to float as by Volume::getVoxelFloat().
+ */
+class VRN_CORE_API VolumeStatistics : public VolumeDerivedData {
+public:
+    /// Empty default constructor required by VolumeDerivedData interface.
+    VolumeStatistics();
+
+    /// Computes the statistics in a single parallel pass over the volume.
+    virtual VolumeDerivedData* createFrom(const VolumeHandleBase* handle) const;
+
+    /// @see VolumeDerivedData
+    virtual void serialize(XmlSerializer& s) const;
+
+    /// @see VolumeDerivedData
+    virtual void deserialize(XmlDeserializer& s);
+
+    size_t getNumChannels() const;
+
+    float getMin(size_t channel = 0) const;
+    float getMax(size_t channel = 0) const;
+    float getMean(size_t channel = 0) const;
+    float getStandardDeviation(size_t channel = 0) const;
+
+protected:
+    std::vector<float> min_;
+    std::vector<float> max_;
+    std::vector<float> mean_;
+    std::vector<float> standardDeviation_;
+};
+
+} // namespace voreen
+
+#endif // VRN_VOLUMESTATISTICS_H
@@ -34,6 +34,8 @@
 
 namespace voreen {
 
+class RawVolumeReader;
+
 /**
  * Reader for <tt>.dat</tt> files.
  *
@@ -117,12 +119,24 @@ public:
      * \param   lastSlice   last slice to load, if 0 all slices from volume will be loaded
      * \param   timeframe   time frame to select from volume, if -1 all time frames will be selected
      **/
-    virtual VolumeCollection* readSlices(const std::string& url, size_t firstSlice = 0, size_t lastSlice = 0, int timeframe = -1)
+    virtual VolumeCollection* readSlices(const std::string& url, size_t firstSlice, size_t lastSlice, int timeframe)
+        throw (tgt::FileException, std::bad_alloc);
+
+    /// Loads the given slices of all time frames, see VolumeReader::readSlices().
+    virtual VolumeCollection* readSlices(const std::string& url, size_t firstSlice = 0, size_t lastSlice = 0)
         throw (tgt::FileException, std::bad_alloc);
 
     virtual VolumeCollection* readBrick(const std::string& url, tgt::ivec3 brickStartPos, int brickSize)
         throw(tgt::FileException, std::bad_alloc);
 
+protected:
+    /**
+     * Creates the reader used for reading the raw data referenced by a .dat file.
+     * Subclasses may return a RawVolumeReader that reads the data from another source.
+     * The caller takes ownership.
+     */
+    virtual RawVolumeReader* createRawVolumeReader();
+
 private:
     static const std::string loggerCat_;
 
@@ -36,6 +36,10 @@ namespace voreen {
 
 /**
  * Writes the volume into a .dat and a .raw file.
+ *
+ * The raw data is streamed by a VolumeSlabWriter, optionally converted
+ * to the output format, and both files only replace existing ones once
+ * they have been written completely.
  */
 class VRN_CORE_API DatVolumeWriter : public VolumeWriter {
 public:
@@ -45,7 +49,13 @@ public:
     virtual std::string getClassName() const   { return "DatVolumeWriter"; }
     virtual std::string getFormatDescription() const { return "Voreen dat/raw format"; }
 
-    std::string getDatFileString(const VolumeHandleBase* const volumeHandle, const std::string& rawFileName);
+    /**
+     * Returns the content of the dat-file.
+     *
+     * @param outputVolume describes the type of the written data, if it is converted, see createOutputVolume()
+     */
+    std::string getDatFileString(const VolumeHandleBase* const volumeHandle, const std::string& rawFileName,
+                                 const Volume* outputVolume = 0);
 
     /**
      * Writes the data of a volume into a dat- and a raw-file.
@@ -56,6 +66,15 @@ public:
     virtual void write(const std::string& filename, const VolumeHandleBase* volumeHandle)
         throw (tgt::IOException);
 
+    /**
+     * Streams the slabs into the raw-file and writes the dat-file afterwards,
+     * once the dimensions are known.
+     */
+    virtual void writeSlabs(const std::string& filename, VolumeSlabWriter::SlabSource* source)
+        throw (tgt::IOException);
+
+    virtual bool streamsSlabs() const;
+
 private:
     static const std::string loggerCat_;
 };
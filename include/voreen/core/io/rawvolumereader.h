@@ -131,19 +131,63 @@ public:
         throw (tgt::FileException, std::bad_alloc);
 
     /**
-     * Constructs a volume from a set of raw slice files by stacking them in z-direction.
+     * Constructs a volume from a set of slice files by stacking them in z-direction.
      *
-     * @note Read hints are applied for each slice.
+     * Slices whose extension is supported by a module's volume reader (e.g. TIFF) are
+     * read by it, other images supported by a texture reader (e.g. PNG) are read through
+     * the TextureManager, all remaining files are read as raw data using the read hints.
+     * The first readable slice determines format and dimensions of the stack. The slices
+     * are read in parallel by at most MAX_READ_THREADS threads, raw slices directly into
+     * the stack. Slices that cannot be read or do not match the first slice are left empty.
+     *
+     * @note Read hints are applied for each raw slice.
      */
     virtual VolumeHandle* readSliceStack(const std::vector<std::string>& sliceFiles)
         throw(tgt::FileException, std::bad_alloc);
 
+protected:
+    /**
+     * Reads the data of the volume created by readSlices(), which has already been cleared.
+     * The default implementation reads them from the raw file. Subclasses may override this
+     * in order to read the data from another source, e.g. an archive.
+     *
+     * @param volume the volume to fill, its data size determines the number of bytes to read
+     * @param fileName the raw file passed to readSlices()
+     * @param offset number of bytes to skip at the beginning of the raw file, including
+     *        the header skip and the skipped slices and time frames
+     * @param checkEOF if true, a truncated file is reported as error
+     */
+    virtual void readVolumeData(Volume* volume, const std::string& fileName, uint64_t offset, bool checkEOF)
+        throw (tgt::CorruptedFileException, tgt::IOException);
+
+    /// Returns the hints the volume is currently read with.
+    const ReadHints& getReadHints() const;
+
 private:
+    /// Returns the module's volume reader supporting the slice file, or null.
+    const VolumeReader* findSliceReader(const std::string& fileName) const;
+
+    /// Returns whether the slice file is an image read by a texture reader.
+    bool isTextureSlice(const std::string& fileName) const;
+
+    /// Creates a reader for slices of findSliceReader(): a copy of it, a raw reader with the current hints or null for textures.
+    VolumeReader* createSliceReader(const VolumeReader* sliceReader, bool texture) const;
+
+    /// Reads a slice using the passed reader, or the TextureManager if it is null.
+    Volume* readSlice(const std::string& fileName, VolumeReader* reader) const
+        throw (tgt::FileException, std::bad_alloc);
+
+    /// Reads a raw slice of the passed stack into \p data according to the read hints.
+    void readRawSlice(const std::string& fileName, char* data, const Volume* stack) const
+        throw (tgt::FileException);
+
     ReadHints extractReadHintsFromOrigin(const VolumeOrigin& origin) const;
     std::string encodeReadHintsIntoSearchString(const ReadHints& hints) const;
 
     ReadHints hints_;
 
+    static const int MAX_READ_THREADS;  ///< maximum number of slices readSliceStack() reads concurrently
+
     static const std::string loggerCat_;
 };
 
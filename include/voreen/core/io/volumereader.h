@@ -92,7 +92,8 @@ public:
      * to the newly built volume.
      *
      * Override this function in order to provide a brick-wise loading routine.
-     * The default implementation throws an exception.
+     * The default implementation throws an exception. Implementations clamp
+     * lastSlice to the depth of the volume, so that it can be read slab by slab.
      *  
      * @throw tgt::FileException if the data set could not be loaded
      */
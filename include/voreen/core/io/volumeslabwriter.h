@@ -0,0 +1,196 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef VRN_VOLUMESLABWRITER_H
+#define VRN_VOLUMESLABWRITER_H
+
+#include "voreen/core/voreencoredefine.h"
+#include "tgt/exception.h"
+#include "tgt/types.h"
+#include "tgt/vector.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace voreen {
+
+class ProgressBar;
+class Volume;
+class VolumeHandle;
+
+/**
+ * Writes a file of a volume dataset, used by the volume writers.
+ *
+ * The file is written under a temporary name next to the target file and
+ * only replaces the target file on commit(). Hence, an existing file stays
+ * intact until the new one is complete, and readers never see incomplete files.
+ * If the writer is deleted without commit, the temporary file is removed.
+ *
+ * The voxel data is written by writeVolume() in slabs of whole slices.
+ * Each slab is prepared on all cores, i.e., converted to the output format
+ * and encoded, e.g. compressed, if requested. A background thread writes the
+ * prepared slab to disk, while the next one is prepared. Therefore, at most
+ * two prepared slabs are held in memory at once.
+ */
+class VRN_CORE_API VolumeSlabWriter {
+public:
+    /**
+     * Encodes the slabs of the voxel data, e.g. compresses them.
+     * The slabs are passed in order, on the calling thread of writeVolume().
+     */
+    class VRN_CORE_API Encoder {
+    public:
+        virtual ~Encoder() {}
+
+        /**
+         * Encodes a slab of voxel data and stores the result in out.
+         * May use OpenMP.
+         *
+         * @param last true for the last slab of the volume
+         */
+        virtual void encode(const char* data, size_t numBytes, bool last, std::vector<char>& out)
+            throw (tgt::IOException) = 0;
+    };
+
+    /**
+     * Provides the voxel data of a volume slab by slab, e.g. while it is read,
+     * so that the volume is never held in memory as a whole (see writeSlabs()).
+     */
+    class VRN_CORE_API SlabSource {
+    public:
+        virtual ~SlabSource() {}
+
+        /**
+         * Returns the next slab of whole slices, in the format to be written,
+         * or null after the last one. The caller takes ownership.
+         */
+        virtual Volume* nextSlab() throw (tgt::IOException) = 0;
+
+        /// Returns the total number of slices to be provided, or 0 if it is not known in advance.
+        virtual size_t getNumSlices() const = 0;
+
+        /**
+         * Returns a handle describing the volume for the file header, i.e., its
+         * dimensions, data type and meta data, whose representation holds no voxel data.
+         * Its depth is the number of slices returned so far, i.e., it is complete
+         * after the last slab. The caller takes ownership.
+         */
+        virtual VolumeHandle* createHeader() const = 0;
+    };
+
+    /// Number of bytes per slab aimed for. A slab consists of at least one slice.
+    static const size_t SLAB_SIZE;
+
+    /**
+     * Opens the temporary file for the passed file name.
+     *
+     * @param progress receives the progress of writeVolume(), may be null
+     * @throw tgt::IOException if the temporary file could not be opened
+     */
+    VolumeSlabWriter(const std::string& fileName, ProgressBar* progress = 0)
+        throw (tgt::IOException);
+
+    /// Removes the temporary file, if it has not been committed.
+    ~VolumeSlabWriter();
+
+    /// Returns the name of the target file.
+    std::string getFileName() const;
+
+    /// Returns the name of the file, which is written until commit().
+    std::string getTemporaryFileName() const;
+
+    /// Writes the passed bytes, e.g. a file header.
+    void write(const void* data, size_t numBytes) throw (tgt::IOException);
+
+    /// Writes the passed string, e.g. a text file header.
+    void write(const std::string& text) throw (tgt::IOException);
+
+    /**
+     * Writes the voxel data of the volume slab by slab.
+     *
+     * @param outputVolume volume of the format the data is converted to, which only has to
+     *        provide its type (see VolumeWriter::createOutputVolume()). No conversion, if null.
+     *        Integer data is converted by its normalized values, floating point data into
+     *        integer types by mapping its intensity range to the normalized range.
+     * @param encoder encodes the (converted) slabs, may be null
+     * @param sliceAlignment the number of slices per slab is a multiple of it,
+     *        e.g. for encoders compressing groups of slices
+     *
+     * @return the number of bytes written
+     */
+    uint64_t writeVolume(const Volume* volume, const Volume* outputVolume = 0, Encoder* encoder = 0,
+                         size_t sliceAlignment = 1)
+        throw (tgt::IOException);
+
+    /**
+     * Writes the voxel data provided by the source slab by slab. Each slab is
+     * encoded, while the previous one is written and the source may already
+     * prepare the next one, so that at most three slabs are held in memory.
+     *
+     * @param encoder encodes the slabs, may be null. Receives the slabs as
+     *        provided by the source, hence it has to choose their size accordingly.
+     *
+     * @return the number of bytes written
+     */
+    uint64_t writeSlabs(SlabSource* source, Encoder* encoder = 0) throw (tgt::IOException);
+
+    /**
+     * Closes the temporary file and renames it to the target file name,
+     * replacing an existing file.
+     */
+    void commit() throw (tgt::IOException);
+
+private:
+    /// Writes prepared slabs in the background.
+    class WriteThread;
+
+    /**
+     * Converts the slices of the volume starting at firstSlice into the slab.
+     * If ranges are passed, the channels are normalized by them.
+     */
+    void convertSlab(const Volume* volume, size_t firstSlice, Volume* slab,
+                     const std::vector<tgt::vec2>& ranges) const;
+
+    /// Starts writing the data in the background, or writes it directly, if no thread can be started.
+    WriteThread* startWriting(const char* data, size_t numBytes) throw (tgt::IOException);
+
+    /// Waits for the thread to finish, deletes it and sets it to null.
+    void finishWriting(WriteThread*& thread) throw (tgt::IOException);
+
+    std::string fileName_;
+    std::fstream stream_;
+    ProgressBar* progress_;
+    bool committed_;
+
+    static const std::string loggerCat_;
+};
+
+} // namespace voreen
+
+#endif // VRN_VOLUMESLABWRITER_H
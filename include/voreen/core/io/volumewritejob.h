@@ -0,0 +1,126 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef VRN_VOLUMEWRITEJOB_H
+#define VRN_VOLUMEWRITEJOB_H
+
+#include "voreen/core/utils/backgroundthread.h"
+
+#include <string>
+#include <vector>
+
+namespace voreen {
+
+class ProgressBar;
+class VolumeHandle;
+class VolumeHandleBase;
+class VolumeSerializerPopulator;
+
+/**
+ * Writes volumes to files on a background thread, so that saving
+ * large volumes does not block the network evaluation.
+ *
+ * The volumes are copied when they are added, since the port data may
+ * change while they are written. The job uses writers of its own, whose
+ * settings and progress are not shared with the calling thread.
+ * The job may also be run synchronously by calling writeVolumes() directly.
+ */
+class VRN_CORE_API VolumeWriteJob : public BackgroundThread {
+public:
+    VolumeWriteJob();
+
+    /// Waits for the volumes to be written.
+    virtual ~VolumeWriteJob();
+
+    /**
+     * Adds a volume to be written to the passed file, whose writer is selected by the file
+     * extension. Must be called before the job is started.
+     *
+     * @param copy if true, the volume's RAM representation is copied. Otherwise, the volume
+     *        must not be accessed by others, changed or deleted until the job has finished.
+     */
+    void addVolume(const std::string& fileName, const VolumeHandleBase* volume, bool copy = true);
+
+    /// Returns the number of volumes to be written.
+    size_t getNumVolumes() const;
+
+    /**
+     * Sets the data type the voxels are converted to while they are written, as VolumeFactory
+     * type of the channels (e.g., "uint8", "uint16", "float"). Empty for no conversion (default).
+     *
+     * @see VolumeWriter::setOutputFormat
+     */
+    void setOutputDataType(const std::string& dataType);
+
+    /**
+     * Enables the compression of the data files by writers supporting it. Default: false.
+     *
+     * @see VolumeWriter::setCompressed
+     */
+    void setCompressed(bool compressed);
+
+    /// Progress bar to be updated in addition, when the job is run synchronously.
+    void setProgressBar(ProgressBar* progressBar);
+
+    /**
+     * Writes the volumes in the order they have been added. Failed writes do not
+     * stop the job, an interruption skips the remaining volumes.
+     */
+    void writeVolumes();
+
+    /// Returns the error messages of the failed writes, once the volumes have been written.
+    std::vector<std::string> getErrors() const;
+
+protected:
+    virtual void run();
+
+private:
+    /// Forwards the progress of the writers to the job.
+    class WriterProgressBar;
+
+    /// Sets the job's progress from the progress of the current volume.
+    void setVolumeProgress(float progress);
+
+    std::vector<std::string> fileNames_;
+    std::vector<const VolumeHandleBase*> volumes_;
+    std::vector<VolumeHandle*> volumeCopies_;
+    std::string dataType_;
+    bool compressed_;
+
+    VolumeSerializerPopulator* populator_;
+    WriterProgressBar* writerProgress_;
+    ProgressBar* progressBar_;
+    size_t currentVolume_;
+    std::vector<std::string> errors_;
+
+    static const std::string loggerCat_;
+};
+
+} // namespace
+
+#endif // VRN_VOLUMEWRITEJOB_H
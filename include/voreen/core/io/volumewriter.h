@@ -30,6 +30,7 @@
 #define VRN_VOLUMEWRITER_H
 
 #include "voreen/core/voreencoredefine.h"
+#include "voreen/core/io/volumeslabwriter.h"
 #include <string>
 #include <vector>
 
@@ -39,6 +40,7 @@ namespace voreen {
 
 // forward declarations
 class ProgressBar;
+class Volume;
 class VolumeHandleBase;
 
 /**
@@ -78,6 +80,25 @@ public:
     virtual void write(const std::string& fileName, const VolumeHandleBase* volumeHandle)
         throw (tgt::IOException) = 0;
 
+    /**
+     * Saves the volume provided slab by slab by the source, e.g. while it is read
+     * and converted, to the given file. The slabs are written as provided,
+     * i.e., the output format is ignored.
+     *
+     * The default implementation assembles the volume in memory and passes it to write().
+     * If the source knows its number of slices, each slab is copied into the volume and freed
+     * as it arrives, otherwise the slabs are collected first. Writers streaming the slabs
+     * to disk override it and streamsSlabs().
+     */
+    virtual void writeSlabs(const std::string& fileName, VolumeSlabWriter::SlabSource* source)
+        throw (tgt::IOException);
+
+    /**
+     * Returns whether writeSlabs() streams the slabs to disk,
+     * i.e., never holds the volume in memory as a whole.
+     */
+    virtual bool streamsSlabs() const;
+
     /**
      * Returns the filename extensions that are supported by the writer.
      */
@@ -119,7 +140,42 @@ public:
      */
     ProgressBar* getProgressBar() const;
 
+    /**
+     * Sets the data type the voxel data is converted to while it is written,
+     * as VolumeFactory type (e.g., "uint8", "uint16", "float"). The number of
+     * channels has to match the written volumes. Is ignored by writers not
+     * supporting the conversion. Default: empty, i.e., no conversion.
+     */
+    void setOutputFormat(const std::string& format);
+
+    /**
+     * Returns the data type the voxel data is converted to, empty if it is not converted.
+     */
+    std::string getOutputFormat() const;
+
+    /**
+     * Enables the compression of the data file, which is ignored by
+     * writers not supporting it. Default: false.
+     */
+    void setCompressed(bool compressed);
+
+    /**
+     * Returns whether the compression of the data file is enabled.
+     */
+    bool isCompressed() const;
+
 protected:
+    /**
+     * Returns a volume of the output format with the dimensions of the passed volume,
+     * which holds no data and describes the written data, e.g., for the file header.
+     * Returns null, if no output format is set or it equals the volume's format.
+     * The caller takes ownership.
+     *
+     * @throw tgt::IOException if the output format is unknown or does not match
+     *      the volume's number of channels
+     */
+    Volume* createOutputVolume(const Volume* volume) const throw (tgt::IOException);
+
     /// List of filename extensions supported by the writer.
     std::vector<std::string> extensions_;
 
@@ -133,6 +189,8 @@ protected:
 
 private:
     ProgressBar* progress_;
+    std::string outputFormat_;
+    bool compressed_;
 
 };
 
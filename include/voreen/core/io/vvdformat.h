@@ -33,35 +33,109 @@
 #include "voreen/core/datastructures/volume/volumeatomic.h"
 #include "voreen/core/datastructures/volume/volumehandle.h"
 #include "voreen/core/datastructures/volume/diskrepresentation.h"
+#include "voreen/core/io/volumeslabwriter.h"
 
 namespace voreen {
 
-///Helper class to save .vvd files.
+class ProgressBar;
+
+///Entry of the chunk index of a chunked .vvd data file.
+class VvdChunk : public Serializable {
+public:
+    VvdChunk(size_t size = 0, uint32_t checksum = 0) : size_(size), checksum_(checksum) {}
+
+    size_t getSize() const { return size_; }
+    uint32_t getChecksum() const { return checksum_; }
+
+    virtual void serialize(XmlSerializer& s) const;
+    virtual void deserialize(XmlDeserializer& s);
+private:
+    size_t size_;           ///< compressed size, the chunks are stored back to back
+    uint32_t checksum_;     ///< CRC-32 of the uncompressed chunk
+};
+
+/**
+ * Helper class to save .vvd files.
+ *
+ * The data file is either a flat raw file or, if an encoding is specified,
+ * consists of chunks of whole slices, which are compressed independently
+ * and listed with their checksums in the header. Chunked files are written
+ * and read in parallel, and reading a range of slices only inflates the
+ * chunks containing them.
+ */
 class VvdRawDataObject : public Serializable {
 public:
-    VvdRawDataObject() {}
+    VvdRawDataObject() : chunkSlices_(0) {}
     VvdRawDataObject(const Volume* volume, std::string filename); 
     
     tgt::ivec3 getDimensions() { return dimensions_; }
     std::string getFilename() { return filename_; }
     std::string getFormat() { return format_; }
 
+    /// Returns true, if the data file consists of compressed chunks.
+    bool isChunked() const { return !encoding_.empty(); }
+
+    /**
+     * Writes the volume data as chunks of zlib compressed slices, compressed
+     * in parallel, and fills the chunk index. Requires the zip module.
+     *
+     * @param outputVolume describes the format the data is converted to, may be null
+     */
+    void writeChunks(const Volume* volume, VolumeSlabWriter& writer, const Volume* outputVolume = 0)
+        throw (tgt::IOException);
+
+    /**
+     * Writes the slabs of the source as chunks of zlib compressed slices and fills the
+     * chunk index, but not the dimensions, which are only known afterwards (see setChunkIndex()).
+     * All slabs but the last one have to consist of a multiple of the first slab's slices.
+     * Requires the zip module.
+     */
+    void writeChunks(VolumeSlabWriter::SlabSource* source, VolumeSlabWriter& writer)
+        throw (tgt::IOException);
+
+    /// Takes over the encoding and chunk index of another data file description.
+    void setChunkIndex(const VvdRawDataObject& chunked);
+
+    /**
+     * Reads the slices [firstSlice, lastSlice) from the data file, all slices if both are 0.
+     * The range is clamped to the depth of the volume.
+     * Of a chunked file, only the chunks containing the slices are inflated, in parallel,
+     * and their checksums verified.
+     */
+    Volume* readSlices(const std::string& fileName, size_t firstSlice, size_t lastSlice, ProgressBar* progress = 0) const
+        throw (tgt::FileException);
+
     virtual void serialize(XmlSerializer& s) const;
     virtual void deserialize(XmlDeserializer& s);
 private:
     std::string filename_;
     tgt::ivec3 dimensions_;
     std::string format_;
+
+    std::string encoding_;          ///< empty for flat raw files
+    int chunkSlices_;               ///< number of slices per chunk
+    std::vector<VvdChunk> chunks_;
 };
 
 ///Helper class to save .vvd files.
 class VvdObject : public Serializable {
 public:
     VvdObject() {}
-    VvdObject(const VolumeHandleBase* vh, std::string rawFilename);
 
-    ///Because the filename is relative to the vvd file we need the directory
-    VolumeHandle* createVolume(std::string directory);
+    /**
+     * @param outputVolume describes the format the data is converted to when written, may be null.
+     *        Derived data is not stored in this case.
+     */
+    VvdObject(const VolumeHandleBase* vh, std::string rawFilename, const Volume* outputVolume = 0);
+
+    /**
+     * Because the filename is relative to the vvd file we need the directory.
+     * Passing a slice range [firstSlice, lastSlice) reads only these slices,
+     * derived data is then not restored.
+     */
+    VolumeHandle* createVolume(std::string directory, size_t firstSlice = 0, size_t lastSlice = 0, ProgressBar* progress = 0);
+
+    VvdRawDataObject& getRawData() { return rawData_; }
 
     virtual void serialize(XmlSerializer& s) const;
     virtual void deserialize(XmlDeserializer& s);
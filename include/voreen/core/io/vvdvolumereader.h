@@ -30,9 +30,14 @@
 #define VRN_VVDVOLUMEREADER_H
 
 #include "voreen/core/io/volumereader.h"
+#include "voreen/core/io/vvdformat.h"
 
 namespace voreen {
 
+/**
+ * Reads .vvd files with flat or chunked data files, see VvdRawDataObject.
+ * Derived data stored in the header is restored on the volume handles.
+ */
 class VvdVolumeReader : public VolumeReader {
 public:
     VvdVolumeReader(ProgressBar* progress = 0);
@@ -44,7 +49,18 @@ public:
     virtual VolumeCollection* read(const std::string& url)
         throw (tgt::FileException, std::bad_alloc);
 
+    /**
+     * Reads the slices [firstSlice, lastSlice) of each volume. Of chunked
+     * data files, only the chunks containing these slices are inflated.
+     */
+    virtual VolumeCollection* readSlices(const std::string& url, size_t firstSlice = 0, size_t lastSlice = 0)
+        throw (tgt::FileException, std::bad_alloc);
+
 private:
+    /// Deserializes the volume descriptions of the .vvd file.
+    std::vector<VvdObject> readVvdFile(const std::string& fileName) const
+        throw (tgt::FileException);
+
     static const std::string loggerCat_;
 };
 
@@ -34,8 +34,20 @@
 
 namespace voreen {
 
+class VvdObject;
+
 /**
  * Writes the volume into a .vvd and a .raw file (Voreen Volume Data, new Voreen format).
+ *
+ * If compression is enabled, the data file (.zraw) consists of independently compressed
+ * chunks of slices, which are listed with their checksums in the .vvd header.
+ * The hash, statistics and an existing intensity histogram of the volume are stored
+ * in the header in both cases, unless the data is converted to an output format.
+ * Compression requires the zip module, and compressed files cannot be read by
+ * previous versions.
+ *
+ * The data is streamed by a VolumeSlabWriter and both files only replace
+ * existing ones once they have been written completely.
  */
 class VRN_CORE_API VvdVolumeWriter : public VolumeWriter {
 public:
@@ -53,7 +65,24 @@ public:
      */
     virtual void write(const std::string& filename, const VolumeHandleBase* volumeHandle)
         throw (tgt::IOException);
+
+    /**
+     * Streams the slabs into the data file, compressed in chunks if compression
+     * is enabled, and writes the vvd-file afterwards, once the dimensions are known.
+     * Derived data is not stored, since it is not available for the whole volume.
+     */
+    virtual void writeSlabs(const std::string& filename, VolumeSlabWriter::SlabSource* source)
+        throw (tgt::IOException);
+
+    virtual bool streamsSlabs() const;
+
 private:
+    /// Returns whether the data is written compressed, i.e., compression is enabled and available.
+    bool useCompression() const;
+
+    /// Serializes the object into the vvd-file.
+    void writeHeader(const std::string& vvdname, const VvdObject& object) const throw (tgt::IOException);
+
     static const std::string loggerCat_;
 };
 
@@ -76,6 +76,28 @@ public:
 
     ~NetworkEvaluator();
 
+    /**
+     * Enables or disables the use of OpenGL, which is enabled by default.
+     *
+     * Without OpenGL, the evaluator does not issue any OpenGL calls itself
+     * and neither initializes nor processes processors that require OpenGL
+     * (see Processor::requiresOpenGL). Render ports are not assigned render
+     * targets in this mode. This allows to evaluate networks of CPU processors
+     * on machines without a graphics context, e.g., on server nodes.
+     *
+     * Must be set before a network is assigned.
+     */
+    void setOpenGLEnabled(bool enabled);
+
+    /// Returns whether the evaluator uses OpenGL. \sa setOpenGLEnabled
+    bool isOpenGLEnabled() const;
+
+    /**
+     * Returns true, if the passed processor is skipped by this evaluator,
+     * because it requires OpenGL and OpenGL is disabled.
+     */
+    bool isSkipped(const Processor* processor) const;
+
     /**
      * Assigns the processor network to be evaluated.
      *
@@ -259,6 +281,50 @@ private:
      */
     void assignRenderTargets();
 
+    /**
+     * Calls beforeProcess(), process() and afterProcess() on the passed processor
+     * and logs exceptions thrown by it. The process wrappers are not notified.
+     *
+     * @param contextThread if true, the OpenGL focus is acquired before each call
+     *        and OpenGL errors are checked afterwards
+     *
+     * @return true, if the processor has been processed without exception
+     */
+    bool processProcessor(Processor* processor, bool contextThread);
+
+    /**
+     * Calls the passed processing stage (beforeProcess(), process() or afterProcess())
+     * of the processor within a profiling block and logs exceptions thrown by it.
+     *
+     * @return true, if no exception has been thrown
+     */
+    bool callProcessor(Processor* processor, void (Processor::*stage)(), const std::string& blockName);
+
+    /**
+     * Evaluates the rendering order with independent processors that do not use
+     * OpenGL (see Processor::usesOpenGL) running concurrently on worker threads.
+     * The OpenGL processors are processed in rendering order on the calling thread,
+     * which holds the context. A processor is not started before all processors
+     * it is connected to by ports or property links and that precede it in the
+     * rendering order have been finished.
+     *
+     * @param processed receives the processors that have been processed
+     * @param topologyChanged set to true, if the evaluation has been stopped, because
+     *        a processor has invalidated the network topology (see checkForInvalidPorts)
+     *
+     * @return false, if the network is not eligible for concurrent evaluation
+     *         (no OpenMP, loops, or less than two independent CPU-only processors
+     *         to be processed). In this case, no processor has been processed.
+     */
+    bool processConcurrently(std::set<Processor*>& processed, bool& topologyChanged);
+
+    /**
+     * Prepares a CPU-only processor for being processed on a worker thread:
+     * makes sure that its input volumes have a RAM representation and frees
+     * the OpenGL representations of the volumes that are replaced by it.
+     */
+    void prepareConcurrentProcessing(Processor* processor);
+
     /**
      * Check the states of all processors in the network and returns true,
      * if any invalidation state is greater or equal INVALID_PORTS.
@@ -305,6 +371,8 @@ private:
 
     bool processPending_;
 
+    bool openGLEnabled_;
+
     /// Used for performance profiling (experimental).
     PerformanceRecord performanceRecord_;
 };
@@ -0,0 +1,214 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef VRN_PARAMETERSWEEP_H
+#define VRN_PARAMETERSWEEP_H
+
+#include "voreen/core/network/networkevaluator.h"
+#include "voreen/core/utils/exception.h"
+#include "voreen/core/utils/observer.h"
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace voreen {
+
+class ParameterSweep;
+class ProcessorNetwork;
+class Property;
+class VolumeHandleBase;
+
+/**
+ * Is notified by a ParameterSweep after each evaluated point,
+ * e.g., for writing the results of the point.
+ */
+class VRN_CORE_API ParameterSweepObserver : public Observer {
+public:
+    virtual void sweepPointEvaluated(const ParameterSweep* sweep, size_t point) = 0;
+};
+
+#ifdef DLL_TEMPLATE_INST
+template class VRN_CORE_API Observable<ParameterSweepObserver>;
+#endif
+
+/**
+ * Evaluates a processor network for all points of a grid of property values.
+ *
+ * Only the properties whose value differs from the previous point are assigned,
+ * so that the NetworkEvaluator only processes the processors affected by them.
+ * The points are visited in an order in which the parameters affecting the most
+ * processors, i.e., the most upstream ones, vary slowest.
+ *
+ * Processors that only have volume outports and depend on parameters varying faster
+ * than others they do not depend on, such as processors on parallel branches,
+ * would nevertheless be recomputed for the same parameter values repeatedly. Their
+ * results are therefore kept in memory, keyed by the values of the parameters
+ * they depend on, and restored instead of reprocessing the processor.
+ *
+ * The evaluation time of each point and of each processor is recorded and can
+ * be written to a CSV file.
+ */
+class VRN_CORE_API ParameterSweep : public Observable<ParameterSweepObserver>, private NetworkEvaluator::ProcessWrapper {
+public:
+    /**
+     * @param network the network to sweep, must be assigned to the evaluator
+     * @param evaluator the evaluator used for processing the network
+     */
+    ParameterSweep(ProcessorNetwork* network, NetworkEvaluator* evaluator);
+
+    /// Hands the currently used memoized results back to their ports and deletes the others.
+    ~ParameterSweep();
+
+    /**
+     * Adds a parameter to the grid.
+     *
+     * @param propertyName qualified name of the property: <processor>.<property id>
+     * @param values the values to assign, converted by setPropertyValue()
+     *
+     * @throw VoreenException if the property does not exist or no values are passed
+     */
+    void addParameter(const std::string& propertyName, const std::vector<std::string>& values)
+        throw (VoreenException);
+
+    /// Returns the number of parameters added.
+    size_t getNumParameters() const;
+
+    /// Returns the qualified property name of the passed parameter.
+    std::string getParameterName(size_t parameter) const;
+
+    /// Returns the number of grid points, i.e., the product of the parameters' value counts.
+    size_t getNumPoints() const;
+
+    /// Returns the parameter values of the passed point, in the order the parameters have been added.
+    std::vector<std::string> getPointValues(size_t point) const;
+
+    /**
+     * Sets the maximum number of memoized processor results, which are evicted
+     * least recently used first. Zero disables the memoization. Default: 32.
+     */
+    void setMaxCachedResults(size_t maxResults);
+
+    /**
+     * Evaluates the network for all grid points in order, notifying
+     * the observers after each point.
+     */
+    void run();
+
+    /// Writes the timings of the last run() as comma-separated values.
+    bool writeTimings(const std::string& filename) const;
+
+    /// Returns the number of processor evaluations saved by restoring memoized results during the last run().
+    size_t getNumRestoredResults() const;
+
+    /**
+     * Assigns a value passed as string to a property, converted according to the property's type:
+     * numbers, booleans, option keys and strings are converted by the property's variant,
+     * vectors are passed as "( x y z )", cameras as "px py pz fx fy fz ux uy uz" (position, focus,
+     * up vector) and volumes as file names.
+     *
+     * @throw VoreenException if the value cannot be converted
+     */
+    static void setPropertyValue(Property* property, const std::string& value) throw (VoreenException);
+
+    /// Returns the property with the qualified name <processor>.<property id>, or null.
+    static Property* findProperty(const ProcessorNetwork* network, const std::string& propertyName);
+
+private:
+    struct Parameter {
+        Property* property_;
+        std::string name_;
+        std::vector<std::string> values_;
+        std::set<Processor*> affected_;     ///< processors invalidated by assigning the parameter
+    };
+
+    struct CachedResult {
+        std::vector<const VolumeHandleBase*> volumes_;  ///< one per outport
+        size_t lastUse_;
+    };
+
+    struct PointTiming {
+        size_t point_;
+        double duration_;
+        size_t numProcessed_;
+        size_t numRestored_;
+        std::map<const Processor*, double> processorDurations_;
+    };
+
+    /// Determines the visiting order of the parameters and the memoized processors.
+    void analyze();
+
+    /// Returns the parameter value indices of the point, in visiting order.
+    std::vector<size_t> getValueIndices(size_t point) const;
+
+    /// Returns the cache key of the processor for the passed value indices.
+    std::string getKey(Processor* processor, const std::vector<size_t>& valueIndices) const;
+
+    /// Restores the memoized results of the processors, whose key has changed.
+    size_t restoreResults(const std::vector<size_t>& valueIndices, size_t point);
+
+    /// Memoizes the results of the processors, which are not yet memoized.
+    void storeResults(const std::vector<size_t>& valueIndices, size_t point);
+
+    /// Evicts the least recently used results, which are not currently in a port.
+    void evictResults();
+
+    /// Hands back or deletes all memoized results.
+    void clearResults();
+
+    bool isInPort(Processor* processor, const CachedResult& result) const;
+
+    virtual void beforeProcess(Processor* p);
+    virtual void afterProcess(Processor* p);
+
+    ProcessorNetwork* network_;
+    NetworkEvaluator* evaluator_;
+
+    std::vector<Parameter> parameters_;     ///< in the order added
+    std::vector<size_t> order_;             ///< parameter indices, slowest varying first
+
+    /// processors that are memoized, in topological order, and the parameters (visiting order) they depend on
+    std::vector<Processor*> memoized_;
+    std::map<Processor*, std::vector<size_t> > dependencies_;
+    std::map<Processor*, std::map<std::string, CachedResult> > results_;
+    std::map<Processor*, std::string> currentKeys_;
+    size_t maxCachedResults_;
+    size_t numCachedResults_;
+
+    std::vector<PointTiming> timings_;
+    PointTiming* currentTiming_;                        ///< timing of the point being evaluated
+    std::map<const Processor*, double> processStart_;
+    size_t numRestored_;
+
+    static const std::string loggerCat_;
+};
+
+} // namespace voreen
+
+#endif // VRN_PARAMETERSWEEP_H
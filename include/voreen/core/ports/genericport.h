@@ -69,6 +69,16 @@ public:
      */
     virtual bool hasData() const;
 
+    /// Returns whether the port deletes its data, when it is replaced. Can only be used on outports.
+    bool ownsData() const;
+
+    /**
+     * Sets whether the port deletes its data, when it is replaced, without replacing it.
+     * Allows to pass the ownership of the current data to the caller and back.
+     * Can only be used on outports.
+     */
+    void setDataOwnership(bool takeOwnership);
+
     /// Return the data stored in this port (if this is an outport) or the data of all the connected outports (if this is an inport).
     virtual std::vector<const T*> getAllData() const;
 
@@ -157,6 +167,18 @@ bool GenericPort<T>::hasData() const {
     return (getData() != 0);
 }
 
+template <typename T>
+bool GenericPort<T>::ownsData() const {
+    tgtAssert(isOutport(), "called ownsData on inport!");
+    return ownsData_;
+}
+
+template <typename T>
+void GenericPort<T>::setDataOwnership(bool takeOwnership) {
+    tgtAssert(isOutport(), "called setDataOwnership on inport!");
+    ownsData_ = takeOwnership;
+}
+
 template <typename T>
 std::vector<const T*> GenericPort<T>::getAllData() const {
     std::vector<const T*> allData;
@@ -112,6 +112,10 @@ public:
      *
      * If the port is an outport: invalidate all connected (in)ports.
      * If the port is an inport: invalidate processor with the given InvalidationLevel and set hasChanged=true.
+     *
+     * @note If called on a worker thread (see Processor::isWorkerThread), the propagation
+     *       from an outport to the connected ports is deferred until the NetworkEvaluator
+     *       has joined the processor's evaluation.
      */
     void invalidate();
 
@@ -369,6 +373,10 @@ private:
     /// Set to true by after successful initialization.
     bool initialized_;
 
+    /// Set, if the invalidation of an outport has been triggered on a worker thread
+    /// and has to be propagated by the NetworkEvaluator on the context thread.
+    bool invalidationDeferred_;
+
     /// category used in logging
     static const std::string loggerCat_;
 };
@@ -155,6 +155,42 @@ public:
      */
     virtual bool isUtility() const;
 
+    /**
+     * Returns whether the processor accesses OpenGL during beforeProcess(),
+     * process() and afterProcess().
+     *
+     * Processors returning false may be run by the NetworkEvaluator on a
+     * worker thread concurrently to other processors that do not depend on them.
+     * In this case, they must neither issue OpenGL calls (including the creation
+     * of hardware volumes or textures) nor modify their properties while processing,
+     * since both is only allowed on the thread holding the OpenGL context.
+     *
+     * The default implementation returns true.
+     */
+    virtual bool usesOpenGL() const;
+
+    /**
+     * Returns false, if the processor can be evaluated without an OpenGL context
+     * at all, i.e., if neither initialize() nor process() depend on it.
+     * A NetworkEvaluator with disabled OpenGL only evaluates such processors.
+     *
+     * Unlike processors returning false for usesOpenGL(), such processors may issue
+     * OpenGL calls, if a context is available, and are then run on the context thread.
+     *
+     * The default implementation returns usesOpenGL().
+     *
+     * @see NetworkEvaluator::setOpenGLEnabled
+     */
+    virtual bool requiresOpenGL() const;
+
+    /**
+     * Returns true, if the calling thread is a worker thread the NetworkEvaluator
+     * runs processors on that do not use OpenGL.
+     *
+     * @see usesOpenGL
+     */
+    static bool isWorkerThread();
+
     /**
      * Returns the name of this processor instance.
      *
@@ -532,6 +568,14 @@ private:
      */
     void deregisterWidget();
 
+    /**
+     * Marks the calling thread as worker thread or context thread.
+     * To be called by the NetworkEvaluator.
+     *
+     * @see isWorkerThread
+     */
+    static void setWorkerThread(bool workerThread);
+
     /// Name of the Processor instance.
     std::string name_;
 
@@ -127,15 +127,8 @@ protected:
     std::string name_;
     PerformanceRecord& pr_;
 
-    clock_t start_;
-    clock_t end_;
-
-#ifdef _MSC_VER  // use high-performance counter on windows systems
-    bool useHpf_;
-    LARGE_INTEGER hpfTicksPerSecond_;
-    LARGE_INTEGER hpfStart_;
-    LARGE_INTEGER hpfEnd_;
-#endif
+    double start_;  ///< wall clock time in seconds, see Profiler::now()
+    double end_;
 
     //static const std::string loggerCat_;
 };
@@ -143,6 +136,121 @@ protected:
 #define PROFILING_BLOCK(name) \
     ProfilingBlock block(name, performanceRecord_);
 
+//----------------------------------------------------------------
+
+/**
+ * @brief Process-wide recorder of timed spans, which can be exported
+ *  as Chrome trace (chrome://tracing, Perfetto) or as summary table.
+ *
+ * Each thread writes into its own ring buffer, so that recording does not
+ * contend with other threads and the memory footprint stays bounded: once a
+ * buffer is full, its oldest events are overwritten. Recording is disabled
+ * by default, in which case spans cost a single flag check.
+ *
+ * All ProfilingBlocks are recorded as spans, when the profiler is enabled.
+ * Additionally, GPU time can be captured by GLTraceSpan via timer queries,
+ * which are resolved asynchronously by collectGLQueries().
+ */
+class VRN_CORE_API Profiler {
+public:
+    struct Event {
+        std::string name_;
+        std::string category_;
+        double start_;      ///< seconds, see now()
+        double duration_;   ///< seconds
+        int thread_;        ///< index of the recording thread, GPU events use gpuThread
+    };
+
+    /// Thread index of the events recorded by GL timer queries.
+    static const int gpuThread = 1000;
+
+    /// Enables or disables the recording of spans.
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+
+    /**
+     * Enables or disables GPU timing by GLTraceSpan. Only has an effect,
+     * if GL_ARB_timer_query is supported. Must be called with the GL context active.
+     */
+    static void setGLTimingEnabled(bool enabled);
+    static bool isGLTimingEnabled();
+
+    /// Sets the capacity of the ring buffers of threads that have not yet recorded any event.
+    static void setBufferSize(size_t numEvents);
+
+    /// Monotonic high-resolution wall clock time in seconds since the first call.
+    static double now();
+
+    /// Records a span of the calling thread.
+    static void addEvent(const std::string& name, const std::string& category, double start, double duration);
+
+    /// Assigns a name to the calling thread, which is displayed by trace viewers.
+    static void setThreadName(const std::string& name);
+
+    /**
+     * Converts the results of finished GL timer queries into events.
+     * Must be called with the GL context active.
+     *
+     * @param wait if true, blocks until all pending queries are available
+     */
+    static void collectGLQueries(bool wait = false);
+
+    /// Returns the events of all threads ordered by start time.
+    static std::vector<Event> getEvents();
+
+    /// Discards all recorded events.
+    static void clear();
+
+    /**
+     * Writes the recorded events in the Chrome trace event format (JSON).
+     *
+     * @return false, if the file could not be written
+     */
+    static bool writeChromeTrace(const std::string& filename);
+
+    /// Returns a table of the recorded spans aggregated by name and sorted by total time.
+    static std::string getSummary();
+
+private:
+    friend class GLTraceSpan;
+
+    /// Adds a pair of issued timestamp queries to the pending queries.
+    static void addGLQuery(const std::string& name, const std::string& category, unsigned int startQuery, unsigned int endQuery);
+
+    static bool enabled_;
+    static bool glTimingEnabled_;
+
+    static const std::string loggerCat_;
+};
+
+/**
+ * @brief Records the lifetime of the object as span, if the Profiler is enabled.
+ */
+class VRN_CORE_API TraceSpan {
+public:
+    TraceSpan(const std::string& name, const std::string& category);
+    ~TraceSpan();
+private:
+    std::string name_;
+    std::string category_;
+    double start_;
+};
+
+/**
+ * @brief Records the GPU time of the GL commands issued during the lifetime
+ *  of the object, if GL timing is enabled. Must be used with the GL context active.
+ */
+class VRN_CORE_API GLTraceSpan {
+public:
+    GLTraceSpan(const std::string& name, const std::string& category);
+    ~GLTraceSpan();
+private:
+    std::string name_;
+    std::string category_;
+    unsigned int queries_[2];
+    bool active_;
+};
+
 } // namespace
 
 #endif //VRN_PROFILING_H
@@ -36,6 +36,10 @@
 #include "voreen/core/properties/buttonproperty.h"
 
 #include "voreen/core/processors/cache.h"
+#include "voreen/core/utils/backgroundthread.h"
+
+#include "tgt/timer.h"
+#include "tgt/event/eventhandler.h"
 
 namespace voreen {
 
@@ -55,7 +59,7 @@ protected:
     tgt::mat4 computeConversionMatrix(const VolumeHandleBase* originVolume, const VolumeHandleBase* destinationVolume) const;
 };
 
-class CachingVolumeProcessor : public VolumeProcessor {
+class VRN_CORE_API CachingVolumeProcessor : public VolumeProcessor {
 public:
     CachingVolumeProcessor();
     virtual ~CachingVolumeProcessor();
@@ -73,6 +77,149 @@ protected:
     Cache cache_;
 };
 
+/**
+ * Base class for expensive volume processors that compute their output
+ * on a background thread, so that the network evaluation is not blocked.
+ *
+ * Subclasses implement createJob() and setResult() and call startComputation()
+ * from process() whenever the output has to be recomputed. While a job is running,
+ * the outport keeps the previous result. A computation that is superseded by a
+ * new one, or by a result restored from the cache, is interrupted and its result
+ * discarded. Once a job has finished, the processor invalidates itself and the
+ * result is passed to setResult() during the next network evaluation.
+ *
+ * If background computation is disabled or no timer is available
+ * for polling the job (e.g., in non-GUI applications), the job is run
+ * synchronously within process().
+ */
+class VRN_CORE_API AsyncVolumeProcessor : public CachingVolumeProcessor {
+public:
+    /**
+     * Computation of the processor's output volume. Runs on a background thread
+     * and must therefore neither access the processor nor its ports or properties.
+     * All parameters have to be passed to the job on its creation.
+     */
+    class VRN_CORE_API Job : public BackgroundThread {
+    public:
+        Job();
+        virtual ~Job();
+
+        /**
+         * Registers an input volume of the computation, which is to be accessed
+         * via getInput(). Before the job is started in the background, the inputs
+         * are replaced by copies of their RAM representations owned by the job,
+         * since the port data may change in the meantime.
+         *
+         * @return the index of the input
+         */
+        size_t addInput(const VolumeHandleBase* input);
+
+        /// Replaces the inputs by copies owned by the job.
+        void copyInputs();
+
+        /**
+         * Performs the computation and returns the resulting volume, which may be null.
+         * Implementations should call isInterrupted() and setProgress() regularly.
+         *
+         * @throw std::exception on failure
+         */
+        virtual VolumeHandle* compute() = 0;
+
+        /// Returns the result of the finished job and passes its ownership to the caller.
+        VolumeHandle* takeResult();
+
+        /// Returns the message of the exception thrown by compute(), if any.
+        std::string getErrorMessage() const;
+
+        /// Progress bar to be updated in addition, when the job is run synchronously.
+        void setProgressBar(ProgressBar* progressBar);
+
+    protected:
+        virtual void run();
+
+        const VolumeHandleBase* getInput(size_t index) const;
+
+        /**
+         * Passes the ownership of the copy of the input made by copyInputs() to the caller,
+         * so that the computation can modify it in place instead of copying it once more.
+         * getInput() keeps returning the copy, which has to outlive its use.
+         *
+         * @return the copy, or null if the input has not been copied,
+         *  e.g., when the job is run synchronously
+         */
+        VolumeHandle* takeInputCopy(size_t index);
+
+        void setProgress(float progress);
+
+    private:
+        std::vector<const VolumeHandleBase*> inputs_;
+        std::vector<VolumeHandle*> inputCopies_;
+        VolumeHandle* result_;
+        std::string errorMessage_;
+        ProgressBar* progressBar_;
+    };
+
+    AsyncVolumeProcessor();
+    virtual ~AsyncVolumeProcessor();
+
+    /// Polls the running job.
+    virtual void timerEvent(tgt::TimeEvent* e);
+
+protected:
+    /// Creates the timer polling the running job, if the application provides one.
+    virtual void initialize() throw (tgt::Exception);
+    virtual void deinitialize() throw (tgt::Exception);
+
+    /// Hands over the result of a finished job and cancels obsolete ones.
+    virtual void beforeProcess();
+
+    /// Starts polling a running job. Results are not cached until the job has finished.
+    virtual void afterProcess();
+
+    /**
+     * Creates the job computing the output from the current inputs and property values.
+     * Is called by startComputation() on the processing thread.
+     *
+     * @return the job, or null, if there is nothing to compute. In this case,
+     *         setResult() is called with null.
+     */
+    virtual Job* createJob() = 0;
+
+    /**
+     * Assigns the result of a finished job to the outport(s).
+     * The processor takes ownership of the passed volume, which may be null.
+     */
+    virtual void setResult(VolumeHandle* result) = 0;
+
+    /**
+     * Starts the computation of the output, cancelling a running one.
+     * To be called from process().
+     */
+    void startComputation();
+
+    /// Interrupts the running computation and discards its result.
+    void cancelComputation();
+
+    /// Returns whether a job is currently running in the background.
+    bool isComputing() const;
+
+    BoolProperty computeInBackground_;
+
+private:
+    /// Passes the result of the finished job to setResult().
+    void finishComputation();
+
+    /// Deletes cancelled jobs that have returned. If wait is true, blocks until all have returned.
+    void cleanupCancelledJobs(bool wait);
+
+    Job* job_;                          ///< currently running job
+    std::vector<Job*> cancelledJobs_;   ///< interrupted jobs that have not returned yet
+    tgt::Timer* timer_;                 ///< polls the running job
+    tgt::EventHandler eventHandler_;
+
+    static const std::string loggerCat_;
+};
+
 }   //namespace
 
 #endif  //VRN_VOLUMEPROCESSOR_H
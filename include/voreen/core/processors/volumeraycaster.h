@@ -98,6 +98,14 @@ protected:
     virtual void bindVolumes(tgt::Shader* shader, const std::vector<VolumeStruct> &volumes,
         const tgt::Camera* camera = 0, const tgt::vec4& lightPosition = tgt::vec4(0.f));
 
+    /**
+     * Binds the pre-integration table of the given transfer function to the texture unit
+     * and passes it to the shader, if pre-integrated classification is selected.
+     * The table refers to the sampling step size of the last bindVolumes() call,
+     * which therefore has to be called first.
+     */
+    void bindPreIntegrationTable(tgt::Shader* shader, TransFunc* transFunc, tgt::TextureUnit& unit);
+
     FloatProperty samplingRate_;  ///< Sampling rate of the raycasting, specified relative to the size of one voxel
     FloatProperty isoValue_;      ///< The used isovalue, when isosurface raycasting is enabled
 
@@ -114,6 +122,7 @@ protected:
 
     tgt::ivec2 size_;                                  ///< The size expected by the processors connected to the outports. ()
     bool switchToInteractionMode_;                     ///< Needed to switch to/from interactionmode.
+    float samplingStepSize_;                           ///< Step size passed to the shader by the last bindVolumes() call
 
     static const std::string loggerCat_; ///< category used in logging
 
@@ -0,0 +1,108 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef VRN_BACKGROUNDTHREAD_H
+#define VRN_BACKGROUNDTHREAD_H
+
+#include "voreen/core/voreencoredefine.h"
+#include "voreen/core/utils/exception.h"
+
+#include <string>
+
+namespace voreen {
+
+/**
+ * Minimal platform thread executing run() in the background,
+ * based on pthreads or the Win32 thread API.
+ *
+ * Threads are not cancelled forcefully: interrupt() only sets a flag that
+ * run() is expected to poll via isInterrupted(). A started thread has to be
+ * joined before the object is deleted, which is done by the destructor
+ * as a last resort.
+ */
+class VRN_CORE_API BackgroundThread {
+public:
+    BackgroundThread();
+
+    /// Interrupts and joins the thread, if it is still running.
+    virtual ~BackgroundThread();
+
+    /**
+     * Starts the thread. Must only be called once.
+     *
+     * @throw VoreenException if the thread could not be created
+     */
+    void start() throw (VoreenException);
+
+    /**
+     * Blocks until run() has returned. Does nothing, if the thread
+     * has not been started or has already been joined.
+     */
+    void join();
+
+    /// Requests run() to return as soon as possible.
+    void interrupt();
+
+    /// Returns whether interrupt() has been called.
+    bool isInterrupted() const;
+
+    /// Returns whether the thread has been started and run() has returned.
+    bool isFinished() const;
+
+    /// Returns the progress of the computation in [0, 1] as last reported by run().
+    float getProgress() const;
+
+protected:
+    /// The computation to be performed in the background.
+    virtual void run() = 0;
+
+    /// To be called by run() for reporting its progress.
+    void setProgress(float progress);
+
+private:
+    struct ThreadData;
+
+    /// Entry point of the native thread, calls run().
+    static void* threadEntry(void* thread);
+#ifdef WIN32
+    static unsigned __stdcall win32ThreadEntry(void* thread);
+#endif
+
+    ThreadData* data_;  ///< native thread handle and mutex guarding the state below
+    bool started_;
+    bool joined_;
+    bool interrupted_;
+    bool finished_;
+    float progress_;
+
+    static const std::string loggerCat_;
+};
+
+} // namespace
+
+#endif // VRN_BACKGROUNDTHREAD_H
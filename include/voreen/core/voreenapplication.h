@@ -163,6 +163,13 @@ public:
      */
     virtual void deinitializeGL() throw (VoreenException);
 
+    /**
+     * Returns true, if initializeGL() has been called successfully.
+     * Applications running without an OpenGL context, such as the
+     * headless batch runner, never initialize OpenGL.
+     */
+    bool isInitializedGL() const;
+
 
     //
     // Modules
@@ -405,6 +412,7 @@ private:
     std::string shaderPath_;
 
     std::string overrideGLSLVersion_; ///< cmdparser writes the passed shader version string to this
+    std::string traceFile_;           ///< if set, a Chrome trace of the session is written to this file on deinitialization
 };
 
 } // namespace
@@ -47,6 +47,7 @@ public:
     ConsolePlugin(QWidget* parent = 0, tgt::LogLevel logLevel = tgt::Info, bool autoScroll = true);
     ~ConsolePlugin();
 
+    /// Logs the message, may be called by any thread.
     void log(const std::string& msg);
 
 public slots:
@@ -64,6 +65,9 @@ private:
 private slots:
     void disableToggled();
 
+    /// Appends the message to the text box, called in the GUI thread.
+    void appendMessage(const QString& msg);
+
 };
 
 } // namespace voreen
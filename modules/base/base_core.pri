@@ -151,7 +151,8 @@ SOURCES += \
     $${VRN_MODULE_DIR}/base/io/quadhidacvolumereader.cpp \
     $${VRN_MODULE_DIR}/base/io/synth2dreader.cpp \
     $${VRN_MODULE_DIR}/base/io/rawvoxvolumereader.cpp \
-    $${VRN_MODULE_DIR}/base/io/tuvvolumereader.cpp  
+    $${VRN_MODULE_DIR}/base/io/tuvvolumereader.cpp \
+    $${VRN_MODULE_DIR}/base/io/zlibcodec.cpp
 
 # 
 # Processor headers
@@ -302,7 +303,8 @@ HEADERS += \
     $${VRN_MODULE_DIR}/base/io/quadhidacvolumereader.h \
     $${VRN_MODULE_DIR}/base/io/synth2dreader.h \
     $${VRN_MODULE_DIR}/base/io/rawvoxvolumereader.h \
-    $${VRN_MODULE_DIR}/base/io/tuvvolumereader.h 
+    $${VRN_MODULE_DIR}/base/io/tuvvolumereader.h \
+    $${VRN_MODULE_DIR}/base/io/zlibcodec.h
     
 #
 # Processor shaders (only necessary for making them visible in Visual Studio)
@@ -328,6 +330,10 @@ SHADER_SOURCES += \
     $${VRN_MODULE_DIR}/base/glsl/image/depthdarkening.frag \
     $${VRN_MODULE_DIR}/base/glsl/image/depthpeeling.frag \
     $${VRN_MODULE_DIR}/base/glsl/image/depthpeeling.vert \
+    $${VRN_MODULE_DIR}/base/glsl/image/depthpeelingblend.frag \
+    $${VRN_MODULE_DIR}/base/glsl/image/depthpeelingcomposite.frag \
+    $${VRN_MODULE_DIR}/base/glsl/image/depthpeelingdual.frag \
+    $${VRN_MODULE_DIR}/base/glsl/image/depthpeelingfront.frag \
     $${VRN_MODULE_DIR}/base/glsl/image/distance.frag \
     $${VRN_MODULE_DIR}/base/glsl/image/edgedetect.frag \
     $${VRN_MODULE_DIR}/base/glsl/image/fade.frag \
@@ -0,0 +1,68 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#include "modules/mod_sampler2d.frag"
+
+uniform SAMPLER2D_TYPE colorTex_;               // opaque scene
+uniform SAMPLER2D_TYPE depthTex_;
+uniform TEXTURE_PARAMETERS textureParameters_;
+uniform SAMPLER2D_TYPE frontTex_;               // front-to-back accumulated layers (premultiplied)
+uniform TEXTURE_PARAMETERS frontTexParameters_;
+uniform SAMPLER2D_TYPE backTex_;                // back-to-front accumulated layers (premultiplied)
+uniform TEXTURE_PARAMETERS backTexParameters_;
+
+// If true, the alpha channel of frontTex_ holds the accumulated opacity (dual depth peeling) and
+// backTex_ is used, otherwise it holds the remaining transmittance (front-to-back peeling).
+uniform bool dualPeeling_;
+
+void main() {
+    vec2 fragCoord = gl_FragCoord.xy;
+
+    vec4 opaque = textureLookup2Dscreen(colorTex_, textureParameters_, fragCoord);
+    float opaqueDepth = textureLookup2Dscreen(depthTex_, textureParameters_, fragCoord).z;
+    vec4 front = textureLookup2Dscreen(frontTex_, frontTexParameters_, fragCoord);
+
+    // everything behind the front layers (premultiplied)
+    vec3 behindColor = opaque.rgb * opaque.a;
+    float behindAlpha = opaque.a;
+    float transmittance = front.a;
+    if (dualPeeling_) {
+        vec4 back = textureLookup2Dscreen(backTex_, backTexParameters_, fragCoord);
+        behindColor = back.rgb + (1.0 - back.a) * behindColor;
+        behindAlpha = back.a + (1.0 - back.a) * behindAlpha;
+        transmittance = 1.0 - front.a;
+    }
+
+    vec3 color = front.rgb + transmittance * behindColor;
+    float alpha = 1.0 - transmittance * (1.0 - behindAlpha);
+    if (alpha > 0.0)
+        FragData0 = vec4(color / alpha, alpha);
+    else
+        FragData0 = vec4(0.0);
+    gl_FragDepth = opaqueDepth;
+}
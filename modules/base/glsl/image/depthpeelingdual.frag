@@ -0,0 +1,92 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#include "modules/mod_sampler2d.frag"
+
+// The depth target is cleared to -MAX_DEPTH and rendered with MAX blending, so that
+// writing (-depth, depth) yields (-nearest, farthest) depth of the remaining layers.
+#define MAX_DEPTH 1.0
+
+uniform SAMPLER2D_TYPE depthTex_;               // depth of the opaque scene
+uniform TEXTURE_PARAMETERS depthTexParameters_;
+uniform SAMPLER2D_TYPE prevDepthTex_;           // (-nearest, farthest) depth of the remaining layers
+uniform TEXTURE_PARAMETERS prevDepthTexParameters_;
+uniform SAMPLER2D_TYPE prevFrontTex_;           // front layers accumulated so far
+uniform TEXTURE_PARAMETERS prevFrontTexParameters_;
+uniform bool initPass_;
+
+void main() {
+    vec2 fragCoord = gl_FragCoord.xy * screenDimRCP_;
+    float fragDepth = gl_FragCoord.z;
+
+    if (initPass_) {
+        // fragments hidden by the opaque scene never contribute
+        float opaqueDepth = textureLookup2Dnormalized(depthTex_, depthTexParameters_, fragCoord).z;
+        if (fragDepth >= opaqueDepth)
+            discard;
+        FragData0 = vec4(-fragDepth, fragDepth, 0.0, 0.0);
+        FragData1 = vec4(0.0);
+        FragData2 = vec4(0.0);
+        return;
+    }
+
+    vec2 depthRange = textureLookup2Dnormalized(prevDepthTex_, prevDepthTexParameters_, fragCoord).xy;
+    vec4 front = textureLookup2Dnormalized(prevFrontTex_, prevFrontTexParameters_, fragCoord);
+    float nearestDepth = -depthRange.x;
+    float farthestDepth = depthRange.y;
+
+    // pass on the front accumulation: due to MAX blending only the nearest fragment may increase it
+    FragData1 = front;
+    FragData2 = vec4(0.0);
+
+    if (fragDepth < nearestDepth || fragDepth > farthestDepth) {
+        // already peeled or hidden by the opaque scene
+        FragData0 = vec4(-MAX_DEPTH, -MAX_DEPTH, 0.0, 0.0);
+        return;
+    }
+
+    if (fragDepth > nearestDepth && fragDepth < farthestDepth) {
+        // inner layer, defines the depth range of the next pass
+        FragData0 = vec4(-fragDepth, fragDepth, 0.0, 0.0);
+        return;
+    }
+
+    // nearest or farthest layer: peel it
+    FragData0 = vec4(-MAX_DEPTH, -MAX_DEPTH, 0.0, 0.0);
+    vec4 color = gl_Color;
+    if (fragDepth == nearestDepth) {
+        // front-to-back compositing, alpha holds the accumulated opacity
+        float transmittance = 1.0 - front.a;
+        FragData1.rgb += color.rgb * color.a * transmittance;
+        FragData1.a = 1.0 - transmittance * (1.0 - color.a);
+    }
+    else {
+        // back layers are composited back-to-front in a separate pass
+        FragData2 = color;
+    }
+}
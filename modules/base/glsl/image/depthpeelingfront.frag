@@ -0,0 +1,54 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#include "modules/mod_sampler2d.frag"
+
+uniform SAMPLER2D_TYPE depthTex_;               // depth of the opaque scene
+uniform TEXTURE_PARAMETERS depthTexParameters_;
+uniform SAMPLER2D_TYPE prevDepthTex_;           // depth of the previously peeled layer
+uniform TEXTURE_PARAMETERS prevDepthTexParameters_;
+uniform bool firstLayer_;
+
+void main() {
+    vec2 fragCoord = gl_FragCoord.xy * screenDimRCP_;
+
+    // fragments hidden by the opaque scene never contribute
+    float opaqueDepth = textureLookup2Dnormalized(depthTex_, depthTexParameters_, fragCoord).z;
+    if (gl_FragCoord.z >= opaqueDepth)
+        discard;
+
+    // peel away everything up to the previous layer
+    if (!firstLayer_) {
+        float prevDepth = textureLookup2Dnormalized(prevDepthTex_, prevDepthTexParameters_, fragCoord).z;
+        if (gl_FragCoord.z <= prevDepth)
+            discard;
+    }
+
+    FragData0 = gl_Color;
+    gl_FragDepth = gl_FragCoord.z;
+}
@@ -28,6 +28,7 @@
 
 #include "mhdvolumereader.h"
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 
@@ -37,6 +38,10 @@
 #include "voreen/core/utils/stringconversion.h"
 #include "voreen/core/datastructures/volume/volumeatomic.h"
 #include "voreen/core/datastructures/volume/diskrepresentation.h"
+#include "voreen/core/datastructures/volume/volumefactory.h"
+#include "voreen/core/io/progressbar.h"
+
+#include "zlibcodec.h"
 
 using tgt::vec3;
 using tgt::ivec3;
@@ -132,6 +137,9 @@ VolumeCollection* MhdVolumeReader::read(const std::string &url)
     string voxelType = "";
     int numChannels = 1;
     int64_t headerSkip = 0;
+    bool compressed = false;
+    bool local = false;
+    uint64_t localDataOffset = 0;
 
     tgt::File* file = FileSys.open(fileName);
     if ((!file) || (!file->isOpen())) {
@@ -171,9 +179,13 @@ VolumeCollection* MhdVolumeReader::read(const std::string &url)
                 if(rawFilename == "LIST") 
                     throw tgt::FileException("Slice-list mode not supported!");
                 if(rawFilename == "LOCAL") {
-                    rawFilename = fileName;
+                    local = true;
                     headerSkip = -1;
+                    localDataOffset = file->tell();
                 }
+
+                //ElementDataFile is the last attribute, LOCAL data follows:
+                break;
             }
             else if(parsedLine.getName() == "ElementByteOrderMSB") {
                 if(parsedLine.getDataBool())
@@ -182,6 +194,12 @@ VolumeCollection* MhdVolumeReader::read(const std::string &url)
             else if(parsedLine.getName() == "HeaderSize") {
                 headerSkip = parsedLine.getDataInt();
             }
+            else if(parsedLine.getName() == "CompressedData") {
+                compressed = parsedLine.getDataBool();
+            }
+            else if(parsedLine.getName() == "CompressedDataSize") {
+                //not needed, the end of the zlib stream is detected while inflating
+            }
             //Metadata:
             else if(parsedLine.getName() == "Offset") {
                 offset = parsedLine.getDataVec3();
@@ -245,11 +263,42 @@ VolumeCollection* MhdVolumeReader::read(const std::string &url)
 
     VolumeRepresentation* volume;
     string directory = tgt::FileSystem::dirName(fileName);
-    string fullRawFilename = directory+"/"+rawFilename;
+    string fullRawFilename = (local ? fileName : directory+"/"+rawFilename);
     if(!FileSys.fileExists(fullRawFilename))
         throw tgt::FileException("Raw file '" + fullRawFilename + "' does not exist!");
 
-    volume = (Volume*) new DiskRepresentation(fullRawFilename , voreenVoxelType, dimensions, headerSkip);
+    if(compressed) {
+        //compressed data has to be inflated into memory, it cannot be read lazily from disk:
+        if(!ZlibCodec::isAvailable())
+            throw tgt::FileException("CompressedData requires zlib, which is provided by the zip module", fileName);
+
+        VolumeFactory vf;
+        Volume* data = vf.create(voreenVoxelType, dimensions);
+        if(!data)
+            throw tgt::FileException("Unsupported voxel type: " + voxelType + ", " + itos(numChannels) + " channels");
+
+        uint64_t dataOffset = local ? localDataOffset : static_cast<uint64_t>(std::max<int64_t>(headerSkip, 0));
+        if(getProgressBar()) {
+            getProgressBar()->setTitle("Loading Volume");
+            getProgressBar()->setMessage("Inflating volume: " + fullRawFilename);
+        }
+        try {
+            ZlibCodec::decompress(fullRawFilename, dataOffset, data->getData(), data->getNumBytes(), 0, getProgressBar());
+        }
+        catch(...) {
+            delete data;
+            if(getProgressBar())
+                getProgressBar()->hide();
+            throw;
+        }
+        if(getProgressBar())
+            getProgressBar()->hide();
+
+        volume = data;
+    }
+    else {
+        volume = (Volume*) new DiskRepresentation(fullRawFilename , voreenVoxelType, dimensions, headerSkip);
+    }
 
     VolumeHandle* vh = new VolumeHandle(volume, spacing, offset);
     vh->setOrigin(origin);
@@ -34,6 +34,8 @@
 #include "tgt/matrix.h"
 #include <iomanip>
 
+#include "zlibcodec.h"
+
 namespace voreen {
 
 const std::string MhdVolumeWriter::loggerCat_("voreen.io.MhdVolumeWriter");
@@ -52,35 +54,90 @@ void MhdVolumeWriter::write(const std::string& filename, const VolumeHandleBase*
         return;
     }
 
+    bool compressed = isCompressed();
+    if (compressed && !ZlibCodec::isAvailable()) {
+        LWARNING("CompressedData requires the zip module, writing raw data");
+        compressed = false;
+    }
+
     std::string mhdname = filename;
-    std::string rawname = getFileNameWithoutExtension(filename) + ".raw";
+    std::string rawname = getFileNameWithoutExtension(filename) + (compressed ? ".zraw" : ".raw");
     LINFO("saving " << mhdname << " and " << rawname);
 
-    std::fstream mhdout(mhdname.c_str(), std::ios::out);
-    std::fstream rawout(rawname.c_str(), std::ios::out | std::ios::binary);
+    Volume* outputVolume = createOutputVolume(volume);
+    try {
+        // write data file first, since the header contains the compressed size
+        VolumeSlabWriter rawout(rawname, getProgressBar());
+        uint64_t compressedSize = 0;
+        if (compressed) {
+            ZlibCodec::Encoder encoder(ZlibCodec::FORMAT_ZLIB);
+            compressedSize = rawout.writeVolume(volume, outputVolume, &encoder);
+        }
+        else {
+            rawout.writeVolume(volume, outputVolume);
+        }
+        rawout.commit();
+
+        VolumeSlabWriter mhdout(mhdname);
+        mhdout.write(getMhdFileString(volumeHandle, rawname, compressedSize, outputVolume));
+        mhdout.commit();
+    }
+    catch (...) {
+        delete outputVolume;
+        throw;
+    }
+    delete outputVolume;
+}
+
+void MhdVolumeWriter::writeSlabs(const std::string& filename, VolumeSlabWriter::SlabSource* source)
+    throw (tgt::IOException)
+{
+    tgtAssert(source, "No source");
+
+    bool compressed = isCompressed();
+    if (compressed && !ZlibCodec::isAvailable()) {
+        LWARNING("CompressedData requires the zip module, writing raw data");
+        compressed = false;
+    }
 
-    if (!mhdout.is_open() || !rawout.is_open() || mhdout.bad() || rawout.bad())
-        throw tgt::IOException();
+    std::string mhdname = filename;
+    std::string rawname = getFileNameWithoutExtension(filename) + (compressed ? ".zraw" : ".raw");
+    LINFO("saving " << mhdname << " and " << rawname);
 
-    mhdout << getMhdFileString(volumeHandle, rawname);
-    if (mhdout.bad())
-        throw tgt::IOException();
-    mhdout.close();
+    VolumeSlabWriter rawout(rawname);
+    uint64_t compressedSize = 0;
+    if (compressed) {
+        ZlibCodec::Encoder encoder(ZlibCodec::FORMAT_ZLIB);
+        compressedSize = rawout.writeSlabs(source, &encoder);
+    }
+    else {
+        rawout.writeSlabs(source);
+    }
+    rawout.commit();
 
-    // write raw file
-    const char* data = static_cast<const char*>(volume->getData());
-    size_t numbytes = volume->getNumBytes();
-    rawout.write(data, numbytes);
-    if (rawout.bad())
-        throw tgt::IOException();
-    rawout.close();
+    VolumeHandle* header = source->createHeader();
+    try {
+        VolumeSlabWriter mhdout(mhdname);
+        mhdout.write(getMhdFileString(header, rawname, compressedSize, header->getRepresentation<Volume>()));
+        mhdout.commit();
+    }
+    catch (...) {
+        delete header;
+        throw;
+    }
+    delete header;
+}
+
+bool MhdVolumeWriter::streamsSlabs() const {
+    return true;
 }
 
-std::string MhdVolumeWriter::getMhdFileString(const VolumeHandleBase* const volumeHandle, const std::string& rawFileName)
+std::string MhdVolumeWriter::getMhdFileString(const VolumeHandleBase* const volumeHandle, const std::string& rawFileName,
+                                              uint64_t compressedDataSize, const Volume* outputVolume)
 {
     std::ostringstream mhdout;
     tgtAssert(volumeHandle, "No volume handle");
-    const Volume* volume = volumeHandle->getRepresentation<Volume>();
+    const Volume* volume = outputVolume ? outputVolume : volumeHandle->getRepresentation<Volume>();
     if (!volume) {
         LWARNING("No volume casted volume data!");
         return "";
@@ -281,6 +338,10 @@ std::string MhdVolumeWriter::getMhdFileString(const VolumeHandleBase* const volu
     mhdout << "ElementByteOrderMSB = False" << std::endl;
     mhdout << "ElementNumberOfChannels = " << numChannels << std::endl;
     mhdout << "HeaderSize = 0" << std::endl;
+    if (compressedDataSize > 0) {
+        mhdout << "CompressedData = True" << std::endl;
+        mhdout << "CompressedDataSize = " << compressedDataSize << std::endl;
+    }
     //ElementDataFile has to be last:
     mhdout << "ElementDataFile = " << tgt::FileSystem::fileName(rawFileName) << std::endl;
 
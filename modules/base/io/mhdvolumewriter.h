@@ -35,7 +35,13 @@
 namespace voreen {
 
 /**
- * Writes the volume into a .mhd and a .raw file.
+ * Writes the volume into a .mhd and a .raw file, or a zlib compressed
+ * .zraw file, if compression is enabled and the zip module is available.
+ * The data is compressed in parallel blocks into a single zlib stream, see ZlibCodec.
+ *
+ * The data is streamed by a VolumeSlabWriter, optionally converted to the
+ * output format, and both files only replace existing ones once they
+ * have been written completely.
  */
 class VRN_CORE_API MhdVolumeWriter : public VolumeWriter {
 public:
@@ -45,7 +51,14 @@ public:
     virtual std::string getClassName() const   { return "MhdVolumeWriter"; }
     virtual std::string getFormatDescription() const { return "MetaIO mhd format"; }
 
-    std::string getMhdFileString(const VolumeHandleBase* const volumeHandle, const std::string& rawFileName);
+    /**
+     * Returns the content of the mhd-file.
+     *
+     * @param compressedDataSize size of the zlib compressed data file, 0 if the data is not compressed
+     * @param outputVolume describes the type of the written data, if it is converted, see createOutputVolume()
+     */
+    std::string getMhdFileString(const VolumeHandleBase* const volumeHandle, const std::string& rawFileName,
+                                 uint64_t compressedDataSize = 0, const Volume* outputVolume = 0);
 
     /**
      * Writes the data of a volume into a mhd- and a raw-file.
@@ -56,6 +69,15 @@ public:
     virtual void write(const std::string& filename, const VolumeHandleBase* volumeHandle)
         throw (tgt::IOException);
 
+    /**
+     * Streams the slabs into the (compressed) raw-file and writes the mhd-file
+     * afterwards, once the dimensions and the compressed size are known.
+     */
+    virtual void writeSlabs(const std::string& filename, VolumeSlabWriter::SlabSource* source)
+        throw (tgt::IOException);
+
+    virtual bool streamsSlabs() const;
+
 private:
     static const std::string loggerCat_;
 };
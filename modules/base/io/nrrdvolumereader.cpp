@@ -30,6 +30,7 @@
 
 #include <fstream>
 #include <iostream>
+#include <sstream>
 
 #include "tgt/exception.h"
 #include "tgt/vector.h"
@@ -39,6 +40,8 @@
 #include "voreen/core/io/rawvolumereader.h"
 #include "voreen/core/datastructures/volume/volumeatomic.h"
 
+#include "zlibcodec.h"
+
 using tgt::vec3;
 using tgt::ivec3;
 
@@ -98,6 +101,10 @@ VolumeCollection* NrrdVolumeReader::read(const std::string &url, int timeframe)
     bool error = false;
     int numFrames = 1;
     int dimension = 3;
+    std::string encoding = "raw";
+    bool bigEndian = false;
+    int lineSkip = 0;
+    int64_t byteSkip = 0;
 
     // NNRD fields for voxel to world matrix
     vec3 spaceOrigin(0.f);
@@ -106,13 +113,34 @@ VolumeCollection* NrrdVolumeReader::read(const std::string &url, int timeframe)
     vec3 dirZ(0.f, 0.f, 1.f);
 
     LINFO("NrrdVolumeReader: " << fileName);
-    TextFileReader reader(fileName);
-    reader.setSeparators(":\t\n\r");
-    if (!reader) {
+    std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+    if (!file) {
         LERROR("Unable to open " << fileName);
         return 0;
     }
 
+    // The header ends with an empty line, which is followed by the data,
+    // if it is not stored in a separate data file.
+    std::string header;
+    std::string line;
+    bool hasAttachedData = false;
+    uint64_t dataOffset = 0;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line[line.size() - 1] == '\r')
+            line.erase(line.size() - 1);
+        if (line.empty()) {
+            hasAttachedData = true;
+            dataOffset = static_cast<uint64_t>(file.tellg());
+            break;
+        }
+        header += line + "\n";
+    }
+    file.close();
+
+    std::istringstream headerStream(header);
+    TextFileReader reader(&headerStream);
+    reader.setSeparators(":\t\n\r");
+
     std::string type;
     std::istringstream args;
     int bits = 0;
@@ -197,19 +225,55 @@ VolumeCollection* NrrdVolumeReader::read(const std::string &url, int timeframe)
                 LERROR("Could not parse Space Origin field from NRRD header.");
                 error = true;
             }
+        } else if (type == "encoding") {
+            args >> encoding;
+            LINFO("Value: " << encoding);
+        } else if (type == "endian") {
+            std::string endian;
+            args >> endian;
+            bigEndian = (endian == "big");
+            LINFO("Value: " << endian);
+        } else if (type == "line skip" || type == "lineskip") {
+            args >> lineSkip;
+            LINFO("Value: " << lineSkip);
+        } else if (type == "byte skip" || type == "byteskip") {
+            args >> byteSkip;
+            LINFO("Value: " << byteSkip);
         } else {
             LWARNING("Unknown type: " << type);
         }
-        //... "encoding:" and other value-types should be added
         if (args.fail()) {
             LERROR("Format error");
             error = true;
         }
     }
 
+    // gzip compressed data is decompressed by zlib, byte skip then refers to the decompressed data
+    bool compressed = false;
+    if (encoding == "gzip" || encoding == "gz") {
+        compressed = true;
+        if (!ZlibCodec::isAvailable()) {
+            LERROR("Encoding '" << encoding << "' requires zlib, which is provided by the zip module");
+            error = true;
+        }
+        else if (byteSkip < 0) {
+            LERROR("Byte skip -1 is only supported for raw encoding");
+            error = true;
+        }
+    }
+    else if (encoding != "raw") {
+        LERROR("Unsupported encoding: " << encoding << " (supported: raw, gzip)");
+        error = true;
+    }
+
+    if (objectFilename.empty() && !hasAttachedData) {
+        LERROR("Neither data file nor attached data specified");
+        error = true;
+    }
+
     if (!error) {
-        RawVolumeReader rawReader(getProgressBar());
         RawVolumeReader::ReadHints h(resolution, sliceThickness, bits, model, format);
+        h.bigEndianByteOrder_ = bigEndian;
         
         // TODO:  does not work as expected - fix
         //        handle space orientation (RAS/LPS/etc.) as well
@@ -220,8 +284,12 @@ VolumeCollection* NrrdVolumeReader::read(const std::string &url, int timeframe)
                                       dirX.z, dirY.z, dirZ.z, spaceOrigin.z,
                                       0.f   , 0.f   , 0.f   , 1.f          );*/
 
+        if (objectFilename.empty()) {
+            // data is attached to the header
+            objectFilename = fileName;
+        }
         // do we have a relative path?
-        if ((objectFilename.substr(0,1) != "/")  && (objectFilename.substr(0,1) != "\\") &&
+        else if ((objectFilename.substr(0,1) != "/")  && (objectFilename.substr(0,1) != "\\") &&
             (objectFilename.substr(1,2) != ":/") && (objectFilename.substr(1,2) != ":\\"))
         {
             size_t p = fileName.find_last_of("\\");
@@ -232,6 +300,32 @@ VolumeCollection* NrrdVolumeReader::read(const std::string &url, int timeframe)
             objectFilename = fileName.substr(0, p + 1) + objectFilename;
         }
 
+        // a separate data file starts with the data
+        if (objectFilename != fileName)
+            dataOffset = 0;
+
+        if (lineSkip > 0) {
+            std::ifstream dataFile(objectFilename.c_str(), std::ios::in | std::ios::binary);
+            dataFile.seekg(static_cast<std::streamoff>(dataOffset));
+            for (int i = 0; i < lineSkip && std::getline(dataFile, line); ++i)
+                ;
+            if (!dataFile)
+                throw tgt::CorruptedFileException("Unable to skip lines of data file", objectFilename);
+            dataOffset = static_cast<uint64_t>(dataFile.tellg());
+        }
+
+        if (byteSkip < 0) {
+            // raw data is aligned to the end of the data file
+            uint64_t bytesPerVoxel = (format == "FLOAT" || model == "RGBA") ? 4 : (format == "UCHAR" ? 1 : 2);
+            uint64_t dataSize = bytesPerVoxel * static_cast<uint64_t>(tgt::hmul(resolution)) * numFrames;
+            std::ifstream dataFile(objectFilename.c_str(), std::ios::in | std::ios::binary);
+            dataFile.seekg(0, std::ios::end);
+            uint64_t fileSize = static_cast<uint64_t>(dataFile.tellg());
+            if (!dataFile || fileSize < dataOffset + dataSize)
+                throw tgt::CorruptedFileException("Data file too small", objectFilename);
+            byteSkip = static_cast<int64_t>(fileSize - dataSize - dataOffset);
+        }
+
         int start = 0;
         int end = numFrames;
         if (timeframe != -1) {
@@ -242,23 +336,43 @@ VolumeCollection* NrrdVolumeReader::read(const std::string &url, int timeframe)
             end = timeframe+1;
         }
 
+        RawVolumeReader* rawReader;
+        if (compressed) {
+            rawReader = new ZlibRawVolumeReader(getProgressBar(), dataOffset);
+            h.headerskip_ = static_cast<size_t>(byteSkip);
+        }
+        else {
+            rawReader = new RawVolumeReader(getProgressBar());
+            h.headerskip_ = static_cast<size_t>(dataOffset + byteSkip);
+        }
+
         VolumeCollection* toReturn = new VolumeCollection();
-        for (int frame = start; frame < end; ++frame) {
-            h.timeframe_ = frame;
-            rawReader.setReadHints(h);
-
-            VolumeCollection* collection = rawReader.read(objectFilename);
-            if (!collection->empty()) {
-                VolumeOrigin origin(fileName);
-                origin.addSearchParameter("timeframe", itos(frame));
-                VolumeHandle* vh = static_cast<VolumeHandle*>(collection->first());
-                vh->setOrigin(origin);
-                vh->setTimestep(static_cast<float>(frame));
-                oldVolumePosition(vh);
-                toReturn->add(vh);
+        try {
+            for (int frame = start; frame < end; ++frame) {
+                h.timeframe_ = frame;
+                rawReader->setReadHints(h);
+
+                VolumeCollection* collection = rawReader->read(objectFilename);
+                if (!collection->empty()) {
+                    VolumeOrigin origin(fileName);
+                    origin.addSearchParameter("timeframe", itos(frame));
+                    VolumeHandle* vh = static_cast<VolumeHandle*>(collection->first());
+                    vh->setOrigin(origin);
+                    vh->setTimestep(static_cast<float>(frame));
+                    oldVolumePosition(vh);
+                    toReturn->add(vh);
+                }
+                delete collection;
             }
-            delete collection;
         }
+        catch (...) {
+            for (size_t i = 0; i < toReturn->size(); ++i)
+                delete toReturn->at(i);
+            delete toReturn;
+            delete rawReader;
+            throw;
+        }
+        delete rawReader;
         return toReturn;
 
     } else
@@ -37,6 +37,10 @@ namespace voreen {
  * Reader for <tt>.nrrd</tt> volume files (nearly raw raster data).
  * TODO: This reader is still incomplete and largely untested.
  *
+ * Supports detached and attached headers with raw or gzip encoding, the latter
+ * requires the zip module. gzip streams written by NrrdVolumeWriter are
+ * decompressed in parallel, see ZlibCodec.
+ *
  * See http://teem.sourceforge.net/nrrd/ for details about the file format.
  */
 class NrrdVolumeReader : public VolumeReader {
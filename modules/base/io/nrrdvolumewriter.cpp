@@ -31,6 +31,8 @@
 #include "voreen/core/datastructures/volume/volumehandle.h"
 #include "tgt/filesystem.h"
 
+#include "zlibcodec.h"
+
 namespace voreen {
 
 const std::string NrrdVolumeWriter::loggerCat_ = "voreen.base.NrrdVolumeWriter";
@@ -51,8 +53,14 @@ void NrrdVolumeWriter::write(const std::string& filename, const VolumeHandleBase
         return;
     }
 
+    bool compressed = isCompressed();
+    if (compressed && !ZlibCodec::isAvailable()) {
+        LWARNING("gzip encoding requires the zip module, writing raw data");
+        compressed = false;
+    }
+
     std::string nhdrname = filename;
-    std::string rawname = getFileNameWithoutExtension(filename) + ".raw";
+    std::string rawname = getFileNameWithoutExtension(filename) + (compressed ? ".raw.gz" : ".raw");
     LINFO("saving " << nhdrname << " and " << rawname);
 
     std::fstream nhdrout(nhdrname.c_str(), std::ios::out);
@@ -96,12 +104,21 @@ void NrrdVolumeWriter::write(const std::string& filename, const VolumeHandleBase
     nhdrout << "sizes:        " << dimensions.x << " " << dimensions.y << " " << dimensions.z << std::endl;
     nhdrout << "spacings:     " << spacing.x << " " << spacing.y << " " << spacing.z << std::endl;
     nhdrout << "datafile:     " << tgt::FileSystem::fileName(rawname) << std::endl;
-    nhdrout << "encoding:     raw" << std::endl;
+    nhdrout << "encoding:     " << (compressed ? "gzip" : "raw") << std::endl;
+    if (type != "uchar") {
+        // the voxel data is written as it is in memory, i.e., in the byte order of the host
+        const uint16_t byteOrderProbe = 1;
+        const bool littleEndian = (*reinterpret_cast<const unsigned char*>(&byteOrderProbe) == 1);
+        nhdrout << "endian:       " << (littleEndian ? "little" : "big") << std::endl;
+    }
 
     nhdrout.close();
 
     // write raw file
-    rawout.write(data, numbytes);
+    if (compressed)
+        ZlibCodec::compress(rawout, data, numbytes, ZlibCodec::FORMAT_GZIP, 6, getProgressBar());
+    else
+        rawout.write(data, numbytes);
     rawout.close();
 }
 
@@ -35,7 +35,9 @@ namespace voreen {
 
 /**
  * Writer for <tt>.nrrd</tt> volume files (nearly raw raster data).
- * Writes the volume into a .nhdr and a .raw file.
+ * Writes the volume into a .nhdr and a .raw file, or a gzip compressed
+ * .raw.gz file, if compression is enabled and the zip module is available.
+ * The data is compressed in parallel blocks, see ZlibCodec.
  *
  * See http://teem.sourceforge.net/nrrd/ for details about the file format.
  */
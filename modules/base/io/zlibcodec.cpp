@@ -0,0 +1,535 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#include "zlibcodec.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "tgt/exception.h"
+
+#include "voreen/core/io/progressbar.h"
+#include "voreen/core/utils/stringconversion.h"
+#include "voreen/core/datastructures/volume/volume.h"
+
+#ifdef VRN_MODULE_ZIP
+#include <zlib.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace voreen {
+
+const std::string ZlibCodec::loggerCat_ = "voreen.base.ZlibCodec";
+const size_t ZlibCodec::BLOCK_SIZE = 1 << 22;
+
+#ifdef VRN_MODULE_ZIP
+
+namespace {
+
+// gzip member header written by compress():
+// ID1 ID2 CM FLG MTIME(4) XFL OS XLEN(2), followed by the subfield SI1 SI2 LEN(2) member size(4)
+const size_t GZIP_HEADER_SIZE = 20;
+const size_t GZIP_TRAILER_SIZE = 8;
+const size_t INPUT_BUFFER_SIZE = 1 << 20;
+const uint64_t MAX_DICTIONARY_SIZE = 1 << 15;
+
+bool seekFile(FILE* file, uint64_t offset) {
+#if defined(_MSC_VER)
+    return (_fseeki64(file, static_cast<__int64>(offset), SEEK_SET) == 0);
+#elif defined(__MINGW32__)
+    return (fseeko64(file, static_cast<off64_t>(offset), SEEK_SET) == 0);
+#else
+    return (fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0);
+#endif
+}
+
+void putUInt16(unsigned char* p, uint32_t value) {
+    p[0] = static_cast<unsigned char>(value & 0xFF);
+    p[1] = static_cast<unsigned char>((value >> 8) & 0xFF);
+}
+
+void putUInt32(unsigned char* p, uint32_t value) {
+    putUInt16(p, value & 0xFFFF);
+    putUInt16(p + 2, value >> 16);
+}
+
+uint32_t getUInt16(const unsigned char* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8);
+}
+
+uint32_t getUInt32(const unsigned char* p) {
+    return getUInt16(p) | (getUInt16(p + 2) << 16);
+}
+
+/**
+ * Deflates a block into a raw deflate stream, which is appended to out at position pos.
+ * All but the last block of a stream are terminated by a sync flush instead of the
+ * final block, so that the blocks can be concatenated.
+ */
+bool deflateBlock(const Bytef* data, uint64_t numBytes, const Bytef* dictionary, uInt dictionarySize,
+                  bool last, int level, std::vector<unsigned char>& out, size_t pos)
+{
+    z_stream strm;
+    memset(&strm, 0, sizeof(z_stream));
+    if (deflateInit2(&strm, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return false;
+
+    if (dictionarySize > 0 && deflateSetDictionary(&strm, dictionary, dictionarySize) != Z_OK) {
+        deflateEnd(&strm);
+        return false;
+    }
+
+    out.resize(pos + deflateBound(&strm, static_cast<uLong>(numBytes)) + 16);
+    strm.next_in = const_cast<Bytef*>(data);
+    strm.avail_in = static_cast<uInt>(numBytes);
+
+    const int flush = last ? Z_FINISH : Z_SYNC_FLUSH;
+    int ret = Z_OK;
+    do {
+        size_t used = pos + strm.total_out;
+        if (used == out.size())
+            out.resize(out.size() + (1 << 16));
+        strm.next_out = &out[used];
+        strm.avail_out = static_cast<uInt>(out.size() - used);
+        ret = deflate(&strm, flush);
+    } while (ret == Z_OK && strm.avail_out == 0);
+
+    out.resize(pos + strm.total_out);
+    deflateEnd(&strm);
+    return (last ? (ret == Z_STREAM_END) : (ret == Z_OK && strm.avail_in == 0));
+}
+
+/// Position and size of a gzip member written by compress().
+struct GzipMember {
+    uint64_t offset_;           ///< position of the member in the file
+    uint32_t size_;             ///< size of the member including header and trailer
+    uint32_t crc_;
+    uint64_t dataOffset_;       ///< position of the member's data in the decompressed stream
+    uint32_t dataSize_;
+};
+
+/**
+ * Locates the gzip members of a stream written by compress() by their size
+ * subfield, until they cover the passed number of decompressed bytes.
+ * Returns false, if the stream has not been written by compress().
+ */
+bool indexGzipMembers(FILE* file, uint64_t offset, uint64_t numBytes, std::vector<GzipMember>& members) {
+    uint64_t dataOffset = 0;
+    while (dataOffset < numBytes) {
+        unsigned char header[GZIP_HEADER_SIZE];
+        if (!seekFile(file, offset) || fread(header, GZIP_HEADER_SIZE, 1, file) != 1)
+            return false;
+        if (header[0] != 0x1f || header[1] != 0x8b || header[2] != Z_DEFLATED || header[3] != 0x04
+            || getUInt16(header + 10) != 8 || header[12] != 'V' || header[13] != 'R' || getUInt16(header + 14) != 4)
+            return false;
+
+        GzipMember member;
+        member.offset_ = offset;
+        member.size_ = getUInt32(header + 16);
+        if (member.size_ < GZIP_HEADER_SIZE + GZIP_TRAILER_SIZE)
+            return false;
+
+        unsigned char trailer[GZIP_TRAILER_SIZE];
+        if (!seekFile(file, offset + member.size_ - GZIP_TRAILER_SIZE) || fread(trailer, GZIP_TRAILER_SIZE, 1, file) != 1)
+            return false;
+        member.crc_ = getUInt32(trailer);
+        member.dataSize_ = getUInt32(trailer + 4);
+        member.dataOffset_ = dataOffset;
+        if (member.dataSize_ == 0)
+            return false;
+
+        members.push_back(member);
+        offset += member.size_;
+        dataOffset += member.dataSize_;
+    }
+    return true;
+}
+
+/**
+ * Inflates a gzip member and copies the part overlapping the decompressed range [skip, skip + numBytes)
+ * to dest. Members lying completely inside the range are inflated directly into dest.
+ */
+bool inflateGzipMember(FILE* file, const GzipMember& member, char* dest, uint64_t skip, uint64_t numBytes,
+                       std::vector<Bytef>& in, std::vector<Bytef>& out)
+{
+    const uint64_t begin = std::max(member.dataOffset_, skip);
+    const uint64_t end = std::min(member.dataOffset_ + member.dataSize_, skip + numBytes);
+    if (begin >= end)
+        return true;
+
+    in.resize(member.size_ - GZIP_HEADER_SIZE - GZIP_TRAILER_SIZE);
+    if (!file || !seekFile(file, member.offset_ + GZIP_HEADER_SIZE) || fread(&in[0], in.size(), 1, file) != 1)
+        return false;
+
+    Bytef* target;
+    if (begin == member.dataOffset_ && end == member.dataOffset_ + member.dataSize_) {
+        target = reinterpret_cast<Bytef*>(dest + (begin - skip));
+    }
+    else {
+        out.resize(member.dataSize_);
+        target = &out[0];
+    }
+
+    z_stream strm;
+    memset(&strm, 0, sizeof(z_stream));
+    if (inflateInit2(&strm, -MAX_WBITS) != Z_OK)
+        return false;
+    strm.next_in = &in[0];
+    strm.avail_in = static_cast<uInt>(in.size());
+    strm.next_out = target;
+    strm.avail_out = member.dataSize_;
+    int ret = inflate(&strm, Z_FINISH);
+    bool success = (ret == Z_STREAM_END) && (strm.avail_out == 0);
+    inflateEnd(&strm);
+
+    success = success && (crc32(crc32(0L, Z_NULL, 0), target, member.dataSize_) == member.crc_);
+    if (success && target == &out[0])
+        memcpy(dest + (begin - skip), &out[begin - member.dataOffset_], static_cast<size_t>(end - begin));
+    return success;
+}
+
+/**
+ * Inflates a zlib or gzip stream serially, concatenated gzip members are decoded as one stream.
+ */
+void inflateStream(FILE* file, const std::string& fileName, char* dest, uint64_t numBytes, uint64_t skip,
+                   ProgressBar* progress)
+    throw (tgt::CorruptedFileException)
+{
+    z_stream strm;
+    memset(&strm, 0, sizeof(z_stream));
+    // detect zlib or gzip header automatically
+    if (inflateInit2(&strm, MAX_WBITS + 32) != Z_OK)
+        throw tgt::CorruptedFileException("failed to initialize zlib", fileName);
+
+    std::vector<Bytef> in(INPUT_BUFFER_SIZE);
+    std::vector<Bytef> discarded(skip > 0 ? INPUT_BUFFER_SIZE : 0);
+    std::string error;
+    uint64_t done = 0;
+    while (done < numBytes) {
+        if (strm.avail_in == 0) {
+            size_t numRead = fread(&in[0], 1, in.size(), file);
+            if (numRead == 0) {
+                error = "unexpected end of compressed data";
+                break;
+            }
+            strm.next_in = &in[0];
+            strm.avail_in = static_cast<uInt>(numRead);
+
+            if (progress)
+                progress->setProgress(static_cast<float>(done) / static_cast<float>(numBytes));
+        }
+
+        if (skip > 0) {
+            strm.next_out = &discarded[0];
+            strm.avail_out = static_cast<uInt>(std::min<uint64_t>(skip, discarded.size()));
+        }
+        else {
+            strm.next_out = reinterpret_cast<Bytef*>(dest + done);
+            strm.avail_out = static_cast<uInt>(std::min<uint64_t>(numBytes - done, 1 << 30));
+        }
+
+        uInt available = strm.avail_out;
+        int ret = inflate(&strm, Z_NO_FLUSH);
+        if (skip > 0)
+            skip -= available - strm.avail_out;
+        else
+            done += available - strm.avail_out;
+
+        if (ret == Z_STREAM_END) {
+            if (done < numBytes && inflateReset(&strm) != Z_OK) {
+                error = "failed to reset zlib";
+                break;
+            }
+        }
+        else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+            error = (strm.msg ? std::string(strm.msg) : "invalid compressed data");
+            break;
+        }
+    }
+    inflateEnd(&strm);
+
+    if (!error.empty())
+        throw tgt::CorruptedFileException(error, fileName);
+}
+
+} // namespace
+
+#endif // VRN_MODULE_ZIP
+
+bool ZlibCodec::isAvailable() {
+#ifdef VRN_MODULE_ZIP
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint64_t ZlibCodec::compress(std::ostream& out, const void* data, uint64_t numBytes, Format format,
+                             int level, ProgressBar* progress)
+    throw (tgt::IOException)
+{
+    const char* bytes = static_cast<const char*>(data);
+
+    // the blocks are compressed in batches to limit the memory of the compressed data
+#ifdef _OPENMP
+    const uint64_t batchSize = 4 * omp_get_max_threads() * BLOCK_SIZE;
+#else
+    const uint64_t batchSize = BLOCK_SIZE;
+#endif
+    const uint64_t numBatches = std::max<uint64_t>((numBytes + batchSize - 1) / batchSize, 1);
+
+    Encoder encoder(format, level);
+    std::vector<char> compressed;
+    uint64_t written = 0;
+    for (uint64_t i = 0; i < numBatches; ++i) {
+        const uint64_t start = i * batchSize;
+        const uint64_t size = std::min<uint64_t>(batchSize, numBytes - std::min(start, numBytes));
+        encoder.encode(bytes + start, static_cast<size_t>(size), i == numBatches - 1, compressed);
+
+        if (!compressed.empty())
+            out.write(&compressed[0], compressed.size());
+        if (out.fail())
+            throw tgt::IOException("failed to write compressed volume data");
+        written += compressed.size();
+
+        if (progress)
+            progress->setProgress(static_cast<float>(i + 1) / static_cast<float>(numBatches));
+    }
+
+    return written;
+}
+
+ZlibCodec::Encoder::Encoder(Format format, int level)
+    : format_(format)
+    , level_(level)
+    , started_(false)
+    , checksum_(1)
+{}
+
+void ZlibCodec::Encoder::encode(const char* data, size_t numBytes, bool last, std::vector<char>& out)
+    throw (tgt::IOException)
+{
+#ifdef VRN_MODULE_ZIP
+    const Bytef* bytes = reinterpret_cast<const Bytef*>(data);
+    const int numBlocks = static_cast<int>(std::max<size_t>((numBytes + BLOCK_SIZE - 1) / BLOCK_SIZE, 1));
+    out.clear();
+
+    if (format_ == FORMAT_ZLIB && !started_) {
+        // deflate with 32K window, level hint and check bits
+        unsigned char header[2];
+        header[0] = 0x78;
+        header[1] = static_cast<unsigned char>((level_ < 2 ? 0 : (level_ < 6 ? 1 : (level_ == 6 ? 2 : 3))) << 6);
+        header[1] = static_cast<unsigned char>(header[1] + 31 - ((header[0] << 8) + header[1]) % 31);
+        out.insert(out.end(), header, header + 2);
+        checksum_ = adler32(0L, Z_NULL, 0);
+    }
+    started_ = true;
+
+    std::vector<std::vector<unsigned char> > compressed(numBlocks);
+    std::vector<uLong> checksums(numBlocks);
+    std::vector<char> failed(numBlocks, 0);
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic)
+    #endif
+    for (int i = 0; i < numBlocks; ++i) {
+        const size_t start = i * BLOCK_SIZE;
+        const size_t size = std::min<size_t>(BLOCK_SIZE, numBytes - std::min(start, numBytes));
+        std::vector<unsigned char>& block = compressed[i];
+
+        if (format_ == FORMAT_GZIP) {
+            checksums[i] = crc32(crc32(0L, Z_NULL, 0), bytes + start, static_cast<uInt>(size));
+            failed[i] = !deflateBlock(bytes + start, size, 0, 0, true, level_, block, GZIP_HEADER_SIZE);
+            if (!failed[i]) {
+                size_t dataEnd = block.size();
+                block.resize(dataEnd + GZIP_TRAILER_SIZE);
+                unsigned char* header = &block[0];
+                memset(header, 0, GZIP_HEADER_SIZE);
+                header[0] = 0x1f;
+                header[1] = 0x8b;
+                header[2] = Z_DEFLATED;
+                header[3] = 0x04;   // FEXTRA
+                header[9] = 0xFF;   // unknown OS
+                putUInt16(header + 10, 8);
+                header[12] = 'V';
+                header[13] = 'R';
+                putUInt16(header + 14, 4);
+                putUInt32(header + 16, static_cast<uint32_t>(block.size()));
+                putUInt32(&block[dataEnd], static_cast<uint32_t>(checksums[i]));
+                putUInt32(&block[dataEnd + 4], static_cast<uint32_t>(size));
+            }
+        }
+        else {
+            // the end of the preceding block serves as dictionary, as in a serially deflated stream,
+            // the first block of a slab uses the end of the preceding slab
+            const Bytef* dictionary;
+            size_t dictionarySize;
+            if (start > 0) {
+                dictionarySize = std::min<size_t>(start, static_cast<size_t>(MAX_DICTIONARY_SIZE));
+                dictionary = bytes + start - dictionarySize;
+            }
+            else {
+                dictionarySize = dictionary_.size();
+                dictionary = dictionary_.empty() ? 0 : reinterpret_cast<const Bytef*>(&dictionary_[0]);
+            }
+            checksums[i] = adler32(adler32(0L, Z_NULL, 0), bytes + start, static_cast<uInt>(size));
+            failed[i] = !deflateBlock(bytes + start, size, dictionary, static_cast<uInt>(dictionarySize),
+                                      last && i == numBlocks - 1, level_, block, 0);
+        }
+    }
+
+    for (int i = 0; i < numBlocks; ++i) {
+        if (failed[i])
+            throw tgt::IOException("failed to compress volume data");
+
+        if (format_ == FORMAT_ZLIB) {
+            const size_t start = i * BLOCK_SIZE;
+            const size_t size = std::min<size_t>(BLOCK_SIZE, numBytes - std::min(start, numBytes));
+            checksum_ = adler32_combine(checksum_, checksums[i], static_cast<z_off_t>(size));
+        }
+
+        out.insert(out.end(), compressed[i].begin(), compressed[i].end());
+        std::vector<unsigned char>().swap(compressed[i]);
+    }
+
+    if (format_ == FORMAT_ZLIB) {
+        // keep the end of the data as dictionary of the next slab
+        dictionary_.insert(dictionary_.end(), data, data + numBytes);
+        if (dictionary_.size() > MAX_DICTIONARY_SIZE)
+            dictionary_.erase(dictionary_.begin(), dictionary_.end() - static_cast<size_t>(MAX_DICTIONARY_SIZE));
+
+        if (last) {
+            unsigned char trailer[4];
+            trailer[0] = static_cast<unsigned char>((checksum_ >> 24) & 0xFF);
+            trailer[1] = static_cast<unsigned char>((checksum_ >> 16) & 0xFF);
+            trailer[2] = static_cast<unsigned char>((checksum_ >> 8) & 0xFF);
+            trailer[3] = static_cast<unsigned char>(checksum_ & 0xFF);
+            out.insert(out.end(), trailer, trailer + 4);
+        }
+    }
+#else
+    throw tgt::IOException("Compressed volume data requires zlib, which is provided by the zip module");
+#endif
+}
+
+void ZlibCodec::decompress(const std::string& fileName, uint64_t offset, void* dest, uint64_t numBytes,
+                           uint64_t skip, ProgressBar* progress)
+    throw (tgt::CorruptedFileException, tgt::IOException)
+{
+#ifdef VRN_MODULE_ZIP
+    FILE* file = fopen(fileName.c_str(), "rb");
+    if (!file)
+        throw tgt::IOException("Unable to open compressed file for reading", fileName);
+
+    std::vector<GzipMember> members;
+    if (!indexGzipMembers(file, offset, skip + numBytes, members)) {
+        LDEBUG("Inflating " << fileName << " serially");
+        if (!seekFile(file, offset)) {
+            fclose(file);
+            throw tgt::IOException("Unable to seek compressed data", fileName);
+        }
+        try {
+            inflateStream(file, fileName, static_cast<char*>(dest), numBytes, skip, progress);
+        }
+        catch (...) {
+            fclose(file);
+            throw;
+        }
+        fclose(file);
+        return;
+    }
+    fclose(file);
+
+    // the members written by compress() are independent and therefore inflated in parallel
+    std::vector<char> failed(members.size(), 0);
+    const int numMembers = static_cast<int>(members.size());
+    int numInflated = 0;
+    #ifdef _OPENMP
+    #pragma omp parallel
+    #endif
+    {
+        FILE* memberFile = fopen(fileName.c_str(), "rb");
+        std::vector<Bytef> in;
+        std::vector<Bytef> out;
+
+        #ifdef _OPENMP
+        #pragma omp for schedule(dynamic)
+        #endif
+        for (int i = 0; i < numMembers; ++i) {
+            failed[i] = !inflateGzipMember(memberFile, members[i], static_cast<char*>(dest), skip, numBytes, in, out);
+
+            #ifdef _OPENMP
+            #pragma omp atomic
+            #endif
+            ++numInflated;
+
+#ifdef _OPENMP
+            // progress bars may only be updated from the calling thread
+            if (omp_get_thread_num() == 0)
+#endif
+            if (progress)
+                progress->setProgress(static_cast<float>(numInflated) / static_cast<float>(numMembers));
+        }
+
+        if (memberFile)
+            fclose(memberFile);
+    }
+
+    for (size_t i = 0; i < members.size(); ++i) {
+        if (failed[i])
+            throw tgt::CorruptedFileException("failed to inflate compressed block " + itos(static_cast<int>(i)), fileName);
+    }
+#else
+    throw tgt::IOException("Compressed volume data requires zlib, which is provided by the zip module", fileName);
+#endif
+}
+
+//---------------------------------------------------------------------------------------
+
+ZlibRawVolumeReader::ZlibRawVolumeReader(ProgressBar* progress, uint64_t streamOffset)
+    : RawVolumeReader(progress)
+    , streamOffset_(streamOffset)
+{}
+
+VolumeReader* ZlibRawVolumeReader::create(ProgressBar* progress) const {
+    return new ZlibRawVolumeReader(progress);
+}
+
+void ZlibRawVolumeReader::readVolumeData(Volume* volume, const std::string& fileName, uint64_t offset, bool /*checkEOF*/)
+    throw (tgt::CorruptedFileException, tgt::IOException)
+{
+    // a truncated stream is always reported, since its end is detected by zlib
+    ZlibCodec::decompress(fileName, streamOffset_, volume->getData(), volume->getNumBytes(), offset, getProgressBar());
+}
+
+} // namespace voreen
@@ -0,0 +1,145 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef VRN_ZLIBCODEC_H
+#define VRN_ZLIBCODEC_H
+
+#include "voreen/core/io/rawvolumereader.h"
+#include "voreen/core/io/volumeslabwriter.h"
+
+#include <iostream>
+#include <string>
+
+namespace voreen {
+
+class ProgressBar;
+
+/**
+ * Compresses and decompresses raw volume data with zlib, as used by the gzip
+ * encoding of the NRRD format and the compressed data of the MetaImage format.
+ *
+ * Both are only available, if Voreen has been built with the zip module,
+ * which provides zlib. Otherwise, all calls throw an exception.
+ *
+ * The data is compressed in independent blocks of BLOCK_SIZE bytes on all cores:
+ * - FORMAT_GZIP writes each block as a separate gzip member, which is a regular
+ *   gzip stream for all gzip decoders. Each member header carries the size of
+ *   the member in an extra subfield ('V', 'R'), so that decompress() is able to
+ *   locate the members without inflating them and inflates them in parallel.
+ * - FORMAT_ZLIB writes a single zlib stream, since MetaImage decoders do not accept
+ *   concatenated streams. The blocks are byte-aligned by sync flushes and use the
+ *   end of the preceding block as dictionary, so this stream is decompressed serially.
+ */
+class ZlibCodec {
+public:
+    enum Format {
+        FORMAT_GZIP,
+        FORMAT_ZLIB
+    };
+
+    /// Number of uncompressed bytes per independently compressed block.
+    static const size_t BLOCK_SIZE;
+
+    /// Returns true, if Voreen has been built with zlib support.
+    static bool isAvailable();
+
+    /**
+     * Compresses the slabs passed by a VolumeSlabWriter into a single gzip
+     * or zlib stream, each slab in parallel blocks as by compress().
+     */
+    class Encoder : public VolumeSlabWriter::Encoder {
+    public:
+        /**
+         * @param level zlib compression level from 1 (fastest) to 9 (best)
+         */
+        Encoder(Format format, int level = 6);
+
+        virtual void encode(const char* data, size_t numBytes, bool last, std::vector<char>& out)
+            throw (tgt::IOException);
+
+    private:
+        Format format_;
+        int level_;
+        bool started_;                  ///< the zlib header has been written
+        unsigned long checksum_;        ///< Adler-32 of the data encoded so far (zlib)
+        std::vector<char> dictionary_;  ///< end of the data encoded so far (zlib)
+    };
+
+    /**
+     * Compresses the passed data and writes it to the stream.
+     *
+     * @param level zlib compression level from 1 (fastest) to 9 (best)
+     * @return the number of compressed bytes written
+     */
+    static uint64_t compress(std::ostream& out, const void* data, uint64_t numBytes, Format format,
+                             int level = 6, ProgressBar* progress = 0)
+        throw (tgt::IOException);
+
+    /**
+     * Decompresses a zlib or gzip stream, which may consist of multiple gzip members,
+     * into the passed buffer.
+     *
+     * @param fileName the file containing the compressed stream
+     * @param offset position of the compressed stream in the file
+     * @param dest buffer receiving numBytes decompressed bytes
+     * @param skip number of decompressed bytes to skip before the data
+     */
+    static void decompress(const std::string& fileName, uint64_t offset, void* dest, uint64_t numBytes,
+                           uint64_t skip = 0, ProgressBar* progress = 0)
+        throw (tgt::CorruptedFileException, tgt::IOException);
+
+private:
+    static const std::string loggerCat_;
+};
+
+/**
+ * Reads raw volume data from a zlib or gzip compressed stream.
+ * The header skip of the read hints, the skipped slices and time frames
+ * refer to the decompressed data, the stream itself starts at the passed
+ * position of the file.
+ */
+class ZlibRawVolumeReader : public RawVolumeReader {
+public:
+    ZlibRawVolumeReader(ProgressBar* progress = 0, uint64_t streamOffset = 0);
+
+    virtual std::string getClassName() const    { return "ZlibRawVolumeReader"; }
+    virtual std::string getFormatDescription() const  { return "Compressed raw volume data"; }
+
+    virtual VolumeReader* create(ProgressBar* progress = 0) const;
+
+protected:
+    virtual void readVolumeData(Volume* volume, const std::string& fileName, uint64_t offset, bool checkEOF)
+        throw (tgt::CorruptedFileException, tgt::IOException);
+
+private:
+    uint64_t streamOffset_;
+};
+
+} // namespace voreen
+
+#endif // VRN_ZLIBCODEC_H
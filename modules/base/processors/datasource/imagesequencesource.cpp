@@ -31,6 +31,7 @@
 #include "voreen/core/datastructures/volume/volumehandle.h"
 #include "voreen/core/voreenapplication.h"
 #include "voreen/core/datastructures/imagesequence.h"
+#include "voreen/core/datastructures/cachedimagesequence.h"
 #include "voreen/core/io/progressbar.h"
 
 #include "tgt/filesystem.h"
@@ -48,6 +49,8 @@ ImageSequenceSource::ImageSequenceSource()
       textureFiltering_("textureFiltering", "Enable Texture Filtering", true),
       uploadTextureData_("uploadTextures", "Upload Textures", true),
       showProgressBar_("showProgressBar", "Show Progress Bar", true),
+      loadOnDemand_("loadOnDemand", "Load Images on Demand", false),
+      textureCacheSize_("textureCacheSize", "Texture Cache Size (MB)", 512, 1, 65536),
       reloadSequence_("reloadSequence", "Reload"),
       clearSequence_("clearSequence", "Clear Sequence"),
       numImages_("numImages", "Num Images", 0, 0, 10000, VALID),
@@ -60,6 +63,8 @@ ImageSequenceSource::ImageSequenceSource()
 
     textureFiltering_.onChange(CallMemberAction<ImageSequenceSource>(this, &ImageSequenceSource::forceReload));
     uploadTextureData_.onChange(CallMemberAction<ImageSequenceSource>(this, &ImageSequenceSource::forceReload));
+    loadOnDemand_.onChange(CallMemberAction<ImageSequenceSource>(this, &ImageSequenceSource::forceReload));
+    textureCacheSize_.onChange(CallMemberAction<ImageSequenceSource>(this, &ImageSequenceSource::updateTextureCacheSize));
     reloadSequence_.onClick(CallMemberAction<ImageSequenceSource>(this, &ImageSequenceSource::forceReload));
     clearSequence_.onClick(CallMemberAction<ImageSequenceSource>(this, &ImageSequenceSource::unsetDirectoryName));
     numImages_.setWidgetsEnabled(false);
@@ -68,6 +73,8 @@ ImageSequenceSource::ImageSequenceSource()
     addProperty(textureFiltering_);
     addProperty(uploadTextureData_);
     addProperty(showProgressBar_);
+    addProperty(loadOnDemand_);
+    addProperty(textureCacheSize_);
     addProperty(reloadSequence_);
     addProperty(clearSequence_);
     addProperty(numImages_);
@@ -151,6 +158,28 @@ void ImageSequenceSource::loadImageSequence(const std::string& d)
 
     // load images as textures and collect them in an image sequence
     std::vector<std::string> filenames = tgt::FileSystem::readDirectory(dir, true, false);
+    tgt::Texture::Filter filterMode = textureFiltering_.get() ? tgt::Texture::LINEAR : tgt::Texture::NEAREST;
+
+    // images loaded on demand are only registered with the sequence, which owns their textures
+    outport_.setData(0);
+    delete imageSequence_;
+    if (loadOnDemand_.get()) {
+        CachedImageSequence* sequence = new CachedImageSequence(static_cast<size_t>(textureCacheSize_.get()) << 20,
+            filterMode, uploadTextureData_.get());
+        for (size_t i=0; i<filenames.size(); ++i) {
+            if (TexMgr.isSupported(filenames[i]))
+                sequence->addImage(dir + "/" + filenames[i]);
+            else
+                LWARNING("Unsupported image format: " << filenames[i]);
+        }
+        imageSequence_ = sequence;
+        outport_.setData(imageSequence_, false);
+
+        LINFO("Registered " << imageSequence_->size() << " images for loading on demand.");
+        numImages_.set(static_cast<int>(imageSequence_->size()));
+        return;
+    }
+    imageSequence_ = new ImageSequence();
 
     // create progress bar
     ProgressBar* progressDialog = 0;
@@ -164,7 +193,6 @@ void ImageSequenceSource::loadImageSequence(const std::string& d)
         }
     }
 
-    tgt::Texture::Filter filterMode = textureFiltering_.get() ? tgt::Texture::LINEAR : tgt::Texture::NEAREST;
     for (size_t i=0; i<filenames.size(); ++i) {
         if (progressDialog) {
             progressDialog->setMessage("Loading " + filenames[i] + " ...");
@@ -214,8 +242,11 @@ void ImageSequenceSource::clearSequence() {
     if (sequenceOwner_ && imageSequence_) {
         if (!imageSequence_->empty()) {
             LINFO("Clearing sequence");
-            for (size_t i=0; i<imageSequence_->size(); ++i) {
-                delete imageSequence_->at(i);
+            // a cached sequence deletes its textures itself, without loading them first
+            if (!dynamic_cast<CachedImageSequence*>(imageSequence_)) {
+                for (size_t i=0; i<imageSequence_->size(); ++i) {
+                    delete imageSequence_->at(i);
+                }
             }
             imageSequence_->clear();
             LGL_ERROR;
@@ -258,4 +289,9 @@ void ImageSequenceSource::unsetDirectoryName() {
     imageDirectory_.set("");
 }
 
+void ImageSequenceSource::updateTextureCacheSize() {
+    if (CachedImageSequence* sequence = dynamic_cast<CachedImageSequence*>(imageSequence_))
+        sequence->setCacheSize(static_cast<size_t>(textureCacheSize_.get()) << 20);
+}
+
 } // namespace
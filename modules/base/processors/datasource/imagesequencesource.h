@@ -42,6 +42,10 @@ namespace voreen {
 /**
  * Loads all image files from a directory and puts them out as ImageSequence
  * containing one OpenGL texture per image.
+ *
+ * If the images are loaded on demand, the sequence is a CachedImageSequence,
+ * which loads each image on first access and keeps only the most recently
+ * used ones within the texture cache size.
  */
 class ImageSequenceSource : public RenderProcessor {
 
@@ -112,12 +116,19 @@ protected:
      */
     virtual void unsetDirectoryName();
 
+    /**
+     * Passes the texture cache size to the sequence, if it loads its images on demand.
+     */
+    virtual void updateTextureCacheSize();
+
     ImageSequencePort outport_;         ///< The port the generated image sequence is written to.
 
     FileDialogProperty imageDirectory_; ///< Directory the images are loaded from.
     BoolProperty textureFiltering_;     ///< Enable linear filtering of loaded textures.
     BoolProperty uploadTextureData_;    ///< Determines whether the images' texture data is uploaded to the GPU.
     BoolProperty showProgressBar_;      ///< Determines whether a progress dialog is shown during image loading.
+    BoolProperty loadOnDemand_;         ///< Determines whether the images are loaded on first access instead of up front.
+    IntProperty textureCacheSize_;      ///< Maximum size in MB of the images kept in memory when loading on demand.
     ButtonProperty reloadSequence_;     ///< Button for reloading the current sequence.
     ButtonProperty clearSequence_;      ///< Button for clearing the current sequence.
     IntProperty numImages_;             ///< Read-only property providing the size of the sequence.
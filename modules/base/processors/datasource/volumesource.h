@@ -51,6 +51,7 @@ public:
     virtual std::string getClassName() const    { return "VolumeSource";    }
     virtual std::string getCategory() const     { return "Data Source";     }
     virtual CodeState getCodeState() const      { return CODE_STATE_STABLE; }
+    virtual bool requiresOpenGL() const         { return false; }
 
     virtual void invalidate(int inv = INVALID_RESULT);
 
@@ -29,6 +29,7 @@
 #include "depthpeelingprocessor.h"
 #include "voreen/core/processors/geometryrendererbase.h"
 #include "voreen/core/interaction/camerainteractionhandler.h"
+#include "voreen/core/utils/stringconversion.h"
 
 #include <typeinfo>
 
@@ -37,6 +38,7 @@
 #include "tgt/vector.h"
 #include "tgt/quadric.h"
 #include "tgt/textureunit.h"
+#include "tgt/gpucapabilities.h"
 
 using tgt::vec4;
 using tgt::vec3;
@@ -44,14 +46,55 @@ using tgt::TextureUnit;
 
 namespace voreen {
 
+namespace {
+
+/// clears the depth range target of an active dual depth peeling PortGroup to -1 and the color targets to 0
+void clearDualTargets() {
+    const GLfloat depthRange[4] = { -1.f, -1.f, 0.f, 0.f };
+    const GLfloat color[4] = { 0.f, 0.f, 0.f, 0.f };
+    glClearBufferfv(GL_COLOR, 0, depthRange);
+    glClearBufferfv(GL_COLOR, 1, color);
+    glClearBufferfv(GL_COLOR, 2, color);
+}
+
+} // namespace
+
+const std::string DepthPeelingProcessor::loggerCat_("voreen.DepthPeelingProcessor");
+
 DepthPeelingProcessor::DepthPeelingProcessor()
     : RenderProcessor()
     , inport_(Port::INPORT, "image.input")
     , outport_(Port::OUTPORT, "image.output")
     , cpPort_(Port::INPORT, "coprocessor.geometryrenderers", true)
+    , layerPort0_(Port::OUTPORT, "image.layer0", false)
+    , layerPort1_(Port::OUTPORT, "image.layer1", false)
+    , accumPort_(Port::OUTPORT, "image.accumulation", false)
+    , dualDepthPort0_(Port::OUTPORT, "image.dualdepth0", false, Processor::INVALID_RESULT, GL_RGBA32F_ARB)
+    , dualDepthPort1_(Port::OUTPORT, "image.dualdepth1", false, Processor::INVALID_RESULT, GL_RGBA32F_ARB)
+    , dualBackPort0_(Port::OUTPORT, "image.dualback0", false)
+    , dualBackPort1_(Port::OUTPORT, "image.dualback1", false)
+    , dualGroup0_(true)
+    , dualGroup1_(true)
     , shaderPrg_(0)
+    , frontPeelPrg_(0)
+    , dualPeelPrg_(0)
+    , blendPrg_(0)
+    , compositePrg_(0)
+    , occlusionQuery_(0)
+    , peelingMode_("peelingMode", "Peeling Mode")
+    , maxLayers_("maxLayers", "Maximum Layers", 8, 1, 64)
+    , useOcclusionQuery_("useOcclusionQuery", "Stop at Empty Layer", true)
+    , profileLayers_("profileLayers", "Profile Layers", false)
     , camera_("camera", "Camera", tgt::Camera(vec3(0.f, 0.f, 3.5f), vec3(0.f, 0.f, 0.f), vec3(0.f, 1.f, 0.f)))
 {
+    peelingMode_.addOption("single",      "Single Layer");
+    peelingMode_.addOption("frontToBack", "Front-to-Back");
+    peelingMode_.addOption("dual",        "Dual Depth Peeling");
+    peelingMode_.onChange(CallMemberAction<DepthPeelingProcessor>(this, &DepthPeelingProcessor::adjustPropertyVisibilities));
+    addProperty(peelingMode_);
+    addProperty(maxLayers_);
+    addProperty(useOcclusionQuery_);
+    addProperty(profileLayers_);
 
     addProperty(camera_);
     cameraHandler_ = new CameraInteractionHandler("cameraHandler", "Camera Handler", &camera_);
@@ -60,6 +103,16 @@ DepthPeelingProcessor::DepthPeelingProcessor()
     addPort(inport_);
     addPort(outport_);
     addPort(cpPort_);
+
+    addPrivateRenderPort(layerPort0_);
+    addPrivateRenderPort(layerPort1_);
+    addPrivateRenderPort(accumPort_);
+    addPrivateRenderPort(dualDepthPort0_);
+    addPrivateRenderPort(dualDepthPort1_);
+    addPrivateRenderPort(dualBackPort0_);
+    addPrivateRenderPort(dualBackPort1_);
+
+    adjustPropertyVisibilities();
 }
 
 DepthPeelingProcessor::~DepthPeelingProcessor() {
@@ -81,28 +134,87 @@ void DepthPeelingProcessor::initialize() throw (tgt::Exception) {
 
     shaderPrg_ = ShdrMgr.loadSeparate("image/depthpeeling.vert", "image/depthpeeling.frag",
         generateHeader(), false);
+    frontPeelPrg_ = ShdrMgr.loadSeparate("image/depthpeeling.vert", "image/depthpeelingfront.frag",
+        generateHeader(), false);
+    blendPrg_ = ShdrMgr.loadSeparate("passthrough.vert", "image/depthpeelingblend.frag",
+        generateHeader(), false);
+    compositePrg_ = ShdrMgr.loadSeparate("passthrough.vert", "image/depthpeelingcomposite.frag",
+        generateHeader(), false);
+
+    dualGroup0_.initialize();
+    dualGroup0_.addPort(dualDepthPort0_);
+    dualGroup0_.addPort(layerPort0_);
+    dualGroup0_.addPort(dualBackPort0_);
+    dualGroup1_.initialize();
+    dualGroup1_.addPort(dualDepthPort1_);
+    dualGroup1_.addPort(layerPort1_);
+    dualGroup1_.addPort(dualBackPort1_);
+
+    if (isDualDepthPeelingSupported()) {
+        try {
+            dualPeelPrg_ = ShdrMgr.loadSeparate("image/depthpeeling.vert", "image/depthpeelingdual.frag",
+                generateHeader() + dualGroup0_.generateHeader(0), false);
+            // bind the additional outputs and relink
+            if (dualPeelPrg_) {
+                dualGroup0_.generateHeader(dualPeelPrg_);
+                dualPeelPrg_->rebuild();
+            }
+        }
+        catch (const tgt::Exception& e) {
+            LWARNING("Failed to load dual depth peeling shader: " << e.what());
+            dualPeelPrg_ = 0;
+        }
+    }
+    if (!dualPeelPrg_)
+        LWARNING("Dual depth peeling not available, using front-to-back peeling instead");
+
+    glGenQueries(1, &occlusionQuery_);
+    LGL_ERROR;
 }
 
 void DepthPeelingProcessor::deinitialize() throw (tgt::Exception) {
+    if (occlusionQuery_)
+        glDeleteQueries(1, &occlusionQuery_);
+    occlusionQuery_ = 0;
+
+    dualGroup0_.deinitialize();
+    dualGroup1_.deinitialize();
+
     if (shaderPrg_)
         ShdrMgr.dispose(shaderPrg_);
     shaderPrg_ = 0;
+    if (frontPeelPrg_)
+        ShdrMgr.dispose(frontPeelPrg_);
+    frontPeelPrg_ = 0;
+    if (dualPeelPrg_)
+        ShdrMgr.dispose(dualPeelPrg_);
+    dualPeelPrg_ = 0;
+    if (blendPrg_)
+        ShdrMgr.dispose(blendPrg_);
+    blendPrg_ = 0;
+    if (compositePrg_)
+        ShdrMgr.dispose(compositePrg_);
+    compositePrg_ = 0;
+    LGL_ERROR;
 
     RenderProcessor::deinitialize();
 }
 
 void DepthPeelingProcessor::process() {
+    // dual depth peeling falls back to front-to-back peeling, if not supported
+    if (peelingMode_.isSelected("dual") && dualPeelPrg_)
+        processDualDepthPeeling();
+    else if (!peelingMode_.isSelected("single"))
+        processFrontToBack();
+    else
+        processSingleLayer();
+}
+
+void DepthPeelingProcessor::processSingleLayer() {
     outport_.activateTarget();
 
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    // set modelview and projection matrices
-    glMatrixMode(GL_PROJECTION);
-    tgt::loadMatrix(camera_.get().getProjectionMatrix());
-    glMatrixMode(GL_MODELVIEW);
-    tgt::loadMatrix(camera_.get().getViewMatrix());
-    LGL_ERROR;
-
     TextureUnit depthTexUnit;
     inport_.bindDepthTexture(depthTexUnit.getEnum());
     LGL_ERROR;
@@ -118,6 +230,251 @@ void DepthPeelingProcessor::process() {
     shaderPrg_->setUniform("depthTex_", depthTexUnit.getUnitNumber());
     inport_.setTextureParameters(shaderPrg_, "depthTexParameters_");
 
+    renderGeometry();
+
+    shaderPrg_->deactivate();
+    outport_.deactivateTarget();
+    LGL_ERROR;
+}
+
+void DepthPeelingProcessor::processFrontToBack() {
+    // the accumulation target holds the premultiplied color of all peeled layers
+    // and the remaining transmittance in its alpha channel
+    accumPort_.activateTarget();
+    glClearColor(0.f, 0.f, 0.f, 1.f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glClearColor(0.f, 0.f, 0.f, 0.f);
+    accumPort_.deactivateTarget();
+
+    tgt::Camera cam = camera_.get();
+    RenderPort* layerPorts[2] = { &layerPort0_, &layerPort1_ };
+    int layer = 0;
+    for (; layer < maxLayers_.get(); ++layer) {
+        ProfilingBlock* layerBlock = 0;
+        if (profileLayers_.get())
+            layerBlock = new ProfilingBlock("layer " + itos(layer), performanceRecord_);
+
+        RenderPort* layerPort = layerPorts[layer % 2];
+        RenderPort* prevLayerPort = layerPorts[(layer + 1) % 2];
+
+        // peel the nearest layer behind the previous one
+        layerPort->activateTarget("layer " + itos(layer));
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        TextureUnit depthUnit, prevDepthUnit;
+        inport_.bindDepthTexture(depthUnit.getEnum());
+        prevLayerPort->bindDepthTexture(prevDepthUnit.getEnum());
+
+        frontPeelPrg_->activate();
+        setGlobalShaderParameters(frontPeelPrg_, &cam);
+        frontPeelPrg_->setUniform("depthTex_", depthUnit.getUnitNumber());
+        inport_.setTextureParameters(frontPeelPrg_, "depthTexParameters_");
+        frontPeelPrg_->setUniform("prevDepthTex_", prevDepthUnit.getUnitNumber());
+        prevLayerPort->setTextureParameters(frontPeelPrg_, "prevDepthTexParameters_");
+        frontPeelPrg_->setUniform("firstLayer_", layer == 0);
+
+        beginOcclusionQuery();
+        renderGeometry();
+        bool layerEmpty = !endOcclusionQuery();
+
+        frontPeelPrg_->deactivate();
+        layerPort->deactivateTarget();
+
+        // blend the layer under the accumulated ones
+        if (!layerEmpty) {
+            accumPort_.activateTarget("layer " + itos(layer));
+            glDepthMask(GL_FALSE);
+            glEnable(GL_BLEND);
+            glBlendFuncSeparate(GL_DST_ALPHA, GL_ONE, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA);
+
+            TextureUnit colorUnit;
+            layerPort->bindColorTexture(colorUnit.getEnum());
+            blendPrg_->activate();
+            setGlobalShaderParameters(blendPrg_);
+            blendPrg_->setUniform("colorTex_", colorUnit.getUnitNumber());
+            layerPort->setTextureParameters(blendPrg_, "textureParameters_");
+            blendPrg_->setUniform("premultiplyAlpha_", true);
+            renderQuad();
+            blendPrg_->deactivate();
+
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            glDisable(GL_BLEND);
+            glDepthMask(GL_TRUE);
+            accumPort_.deactivateTarget();
+        }
+
+        if (layerBlock) {
+            // include the GPU work of this layer in its time
+            glFinish();
+            delete layerBlock;
+        }
+        LGL_ERROR;
+
+        if (layerEmpty)
+            break;
+    }
+    LDEBUG("Peeled " << layer << " layers");
+
+    compositeLayers(accumPort_, 0);
+}
+
+void DepthPeelingProcessor::processDualDepthPeeling() {
+    // render targets may have been resized since the last pass
+    dualGroup0_.reattachTargets();
+    dualGroup1_.reattachTargets();
+
+    PortGroup* groups[2] = { &dualGroup0_, &dualGroup1_ };
+    RenderPort* depthPorts[2] = { &dualDepthPort0_, &dualDepthPort1_ };
+    RenderPort* frontPorts[2] = { &layerPort0_, &layerPort1_ };
+    RenderPort* backPorts[2] = { &dualBackPort0_, &dualBackPort1_ };
+    tgt::Camera cam = camera_.get();
+
+    // the back accumulation holds the premultiplied color of the back layers
+    accumPort_.activateTarget();
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    accumPort_.deactivateTarget();
+
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendEquation(GL_MAX);
+
+    // initial pass: depth range of all layers in front of the opaque scene
+    {
+        ProfilingBlock* initBlock = 0;
+        if (profileLayers_.get())
+            initBlock = new ProfilingBlock("init", performanceRecord_);
+
+        groups[0]->activateTargets("init");
+        clearDualTargets();
+
+        TextureUnit depthUnit;
+        inport_.bindDepthTexture(depthUnit.getEnum());
+        dualPeelPrg_->activate();
+        setGlobalShaderParameters(dualPeelPrg_, &cam);
+        dualPeelPrg_->setUniform("depthTex_", depthUnit.getUnitNumber());
+        inport_.setTextureParameters(dualPeelPrg_, "depthTexParameters_");
+        dualPeelPrg_->setUniform("initPass_", true);
+        renderGeometry();
+        dualPeelPrg_->deactivate();
+        groups[0]->deactivateTargets();
+
+        if (initBlock) {
+            glFinish();
+            delete initBlock;
+        }
+    }
+
+    // each pass peels two layers
+    int current = 0;
+    int pass = 0;
+    for (; 2 * pass < maxLayers_.get(); ++pass) {
+        ProfilingBlock* passBlock = 0;
+        if (profileLayers_.get())
+            passBlock = new ProfilingBlock("layers " + itos(2 * pass) + "/" + itos(2 * pass + 1), performanceRecord_);
+
+        int prev = current;
+        current = 1 - current;
+
+        groups[current]->activateTargets("pass " + itos(pass));
+        clearDualTargets();
+
+        TextureUnit depthUnit, prevDepthUnit, prevFrontUnit;
+        inport_.bindDepthTexture(depthUnit.getEnum());
+        depthPorts[prev]->bindColorTexture(prevDepthUnit.getEnum());
+        frontPorts[prev]->bindColorTexture(prevFrontUnit.getEnum());
+
+        dualPeelPrg_->activate();
+        setGlobalShaderParameters(dualPeelPrg_, &cam);
+        dualPeelPrg_->setUniform("depthTex_", depthUnit.getUnitNumber());
+        inport_.setTextureParameters(dualPeelPrg_, "depthTexParameters_");
+        dualPeelPrg_->setUniform("prevDepthTex_", prevDepthUnit.getUnitNumber());
+        depthPorts[prev]->setTextureParameters(dualPeelPrg_, "prevDepthTexParameters_");
+        dualPeelPrg_->setUniform("prevFrontTex_", prevFrontUnit.getUnitNumber());
+        frontPorts[prev]->setTextureParameters(dualPeelPrg_, "prevFrontTexParameters_");
+        dualPeelPrg_->setUniform("initPass_", false);
+        renderGeometry();
+        dualPeelPrg_->deactivate();
+        groups[current]->deactivateTargets();
+
+        // blend the farthest layer over the accumulated back layers, counting its pixels:
+        // if there are none, every pixel had at most one layer left, which has been added to the front
+        accumPort_.activateTarget("pass " + itos(pass));
+        glBlendEquation(GL_FUNC_ADD);
+        glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+        TextureUnit backUnit;
+        backPorts[current]->bindColorTexture(backUnit.getEnum());
+        blendPrg_->activate();
+        setGlobalShaderParameters(blendPrg_);
+        blendPrg_->setUniform("colorTex_", backUnit.getUnitNumber());
+        backPorts[current]->setTextureParameters(blendPrg_, "textureParameters_");
+        blendPrg_->setUniform("premultiplyAlpha_", false);
+        beginOcclusionQuery();
+        renderQuad();
+        bool layersLeft = endOcclusionQuery();
+        blendPrg_->deactivate();
+        accumPort_.deactivateTarget();
+        glBlendEquation(GL_MAX);
+
+        if (passBlock) {
+            glFinish();
+            delete passBlock;
+        }
+        LGL_ERROR;
+
+        if (!layersLeft) {
+            ++pass;
+            break;
+        }
+    }
+    LDEBUG("Performed " << pass << " dual depth peeling passes");
+
+    glBlendEquation(GL_FUNC_ADD);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDisable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
+
+    compositeLayers(*frontPorts[current], &accumPort_);
+}
+
+void DepthPeelingProcessor::compositeLayers(RenderPort& front, RenderPort* back) {
+    outport_.activateTarget();
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    TextureUnit colorUnit, depthUnit, frontUnit, backUnit;
+    inport_.bindTextures(colorUnit.getEnum(), depthUnit.getEnum());
+    front.bindColorTexture(frontUnit.getEnum());
+    if (back)
+        back->bindColorTexture(backUnit.getEnum());
+
+    compositePrg_->activate();
+    setGlobalShaderParameters(compositePrg_);
+    compositePrg_->setUniform("colorTex_", colorUnit.getUnitNumber());
+    compositePrg_->setUniform("depthTex_", depthUnit.getUnitNumber());
+    inport_.setTextureParameters(compositePrg_, "textureParameters_");
+    compositePrg_->setUniform("frontTex_", frontUnit.getUnitNumber());
+    front.setTextureParameters(compositePrg_, "frontTexParameters_");
+    compositePrg_->setUniform("dualPeeling_", back != 0);
+    if (back) {
+        compositePrg_->setUniform("backTex_", backUnit.getUnitNumber());
+        back->setTextureParameters(compositePrg_, "backTexParameters_");
+    }
+    renderQuad();
+
+    compositePrg_->deactivate();
+    outport_.deactivateTarget();
+    TextureUnit::setZeroUnit();
+    LGL_ERROR;
+}
+
+void DepthPeelingProcessor::renderGeometry() {
+    // set modelview and projection matrices
+    glMatrixMode(GL_PROJECTION);
+    tgt::loadMatrix(camera_.get().getProjectionMatrix());
+    glMatrixMode(GL_MODELVIEW);
+    tgt::loadMatrix(camera_.get().getViewMatrix());
+    LGL_ERROR;
+
     std::vector<GeometryRendererBase*> portData = cpPort_.getConnectedProcessors();
     for (size_t i=0; i<portData.size(); i++) {
         GeometryRendererBase* pdcp = portData.at(i);
@@ -129,9 +486,6 @@ void DepthPeelingProcessor::process() {
         }
     }
 
-    shaderPrg_->deactivate();
-    outport_.deactivateTarget();
-
     // restore matrices
     glMatrixMode(GL_PROJECTION);
     glLoadIdentity();
@@ -140,4 +494,32 @@ void DepthPeelingProcessor::process() {
     LGL_ERROR;
 }
 
+void DepthPeelingProcessor::beginOcclusionQuery() {
+    if (useOcclusionQuery_.get() && occlusionQuery_)
+        glBeginQuery(GL_SAMPLES_PASSED, occlusionQuery_);
+}
+
+bool DepthPeelingProcessor::endOcclusionQuery() {
+    if (!useOcclusionQuery_.get() || !occlusionQuery_)
+        return true;
+
+    glEndQuery(GL_SAMPLES_PASSED);
+    GLuint samples = 0;
+    glGetQueryObjectuiv(occlusionQuery_, GL_QUERY_RESULT, &samples);
+    return (samples > 0);
+}
+
+bool DepthPeelingProcessor::isDualDepthPeelingSupported() const {
+    // float render targets with blending, MAX blend equation and three draw buffers
+    return GpuCaps.isOpenGlVersionSupported(tgt::GpuCapabilities::GlVersion::TGT_GL_VERSION_3_0)
+        && GpuCaps.getMaxColorAttachments() >= 3;
+}
+
+void DepthPeelingProcessor::adjustPropertyVisibilities() {
+    bool multiLayer = !peelingMode_.isSelected("single");
+    maxLayers_.setVisible(multiLayer);
+    useOcclusionQuery_.setVisible(multiLayer);
+    profileLayers_.setVisible(multiLayer);
+}
+
 } // namespace voreen
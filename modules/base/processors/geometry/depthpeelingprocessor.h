@@ -34,6 +34,9 @@
 #include "voreen/core/ports/genericcoprocessorport.h"
 
 #include "voreen/core/properties/cameraproperty.h"
+#include "voreen/core/properties/optionproperty.h"
+#include "voreen/core/properties/intproperty.h"
+#include "voreen/core/properties/boolproperty.h"
 
 namespace voreen {
 
@@ -42,6 +45,15 @@ class CameraInteractionHandler;
 
 /**
  * Implementation of the 'Order-Independent Transparency' approach by Cass Everitt.
+ *
+ * In single layer mode the nearest layer of the geometry behind the depth image of the inport
+ * is rendered, so that consecutive layers can be peeled by chaining several processors.
+ *
+ * The other modes peel up to maxLayers layers in front of the inport image within one process()
+ * call and composite them over it: front-to-back peeling renders the geometry once per layer,
+ * dual depth peeling (Bavoil and Myers) peels the nearest and the farthest remaining layer in
+ * each pass. An occlusion query stops peeling as soon as a layer stays empty.
+ * If enabled, the time spent on each layer is recorded in the performance record of the processor.
  */
 class DepthPeelingProcessor : public RenderProcessor {
 public:
@@ -61,14 +73,62 @@ protected:
     virtual void deinitialize() throw (tgt::Exception);
 
 private:
+    /// renders the nearest layer behind the inport depth (legacy mode)
+    void processSingleLayer();
+
+    /// peels one layer per pass and composites front-to-back
+    void processFrontToBack();
+
+    /// peels the nearest and the farthest layer in each pass
+    void processDualDepthPeeling();
+
+    /// blends the peeled layers over the inport image into the outport
+    void compositeLayers(RenderPort& front, RenderPort* back);
+
+    /// passes camera and viewport to all ready geometry renderers and lets them render
+    void renderGeometry();
+
+    /// starts counting the samples passed, if occlusion queries are enabled
+    void beginOcclusionQuery();
+
+    /// returns false, if occlusion queries are enabled and no sample passed since beginOcclusionQuery()
+    bool endOcclusionQuery();
+
+    /// returns whether dual depth peeling is supported by the GPU
+    bool isDualDepthPeelingSupported() const;
+
+    void adjustPropertyVisibilities();
+
     RenderPort inport_;
     RenderPort outport_;
     GenericCoProcessorPort<GeometryRendererBase> cpPort_;
 
+    RenderPort layerPort0_;         ///< peeled layers (front-to-back) or front accumulation (dual)
+    RenderPort layerPort1_;
+    RenderPort accumPort_;          ///< front accumulation (front-to-back) or back accumulation (dual)
+    RenderPort dualDepthPort0_;     ///< (-nearest, farthest) depth of the remaining layers (dual)
+    RenderPort dualDepthPort1_;
+    RenderPort dualBackPort0_;      ///< farthest layer of a pass (dual)
+    RenderPort dualBackPort1_;
+    PortGroup dualGroup0_;          ///< render targets of a dual depth peeling pass
+    PortGroup dualGroup1_;
+
     tgt::Shader* shaderPrg_;
+    tgt::Shader* frontPeelPrg_;
+    tgt::Shader* dualPeelPrg_;
+    tgt::Shader* blendPrg_;
+    tgt::Shader* compositePrg_;
+
+    GLuint occlusionQuery_;
 
+    StringOptionProperty peelingMode_;
+    IntProperty maxLayers_;
+    BoolProperty useOcclusionQuery_;
+    BoolProperty profileLayers_;
     CameraProperty camera_;
     CameraInteractionHandler* cameraHandler_;
+
+    static const std::string loggerCat_;
 };
 
 } // namespace voreen
@@ -28,36 +28,50 @@
 
 #include "cpuraycaster.h"
 #include "voreen/core/datastructures/transfunc/transfuncintensitygradient.h"
+#include "voreen/core/datastructures/transfunc/preintegrationtable.h"
+
+#include <algorithm>
 
 namespace voreen {
 
 using tgt::vec3;
 using tgt::vec4;
+using tgt::ivec2;
 using tgt::svec3;
 
 CPURaycaster::CPURaycaster()
   : VolumeRaycaster()
   , volumePort_(Port::INPORT, "volumehandle.volumehandle")
   , gradientVolumePort_(Port::INPORT, "volumehandle.gradientvolumehandle")
-  , entryPort_(Port::INPORT, "image.entryports")
-  , exitPort_(Port::INPORT, "image.exitports")
   , outport_(Port::OUTPORT, "image.output", true, INVALID_RESULT, GL_RGBA16F_ARB)
   , transferFunc_("transferFunction", "Transfer function")
   , texFilterMode_("textureFilterMode_", "Texture Filtering")
+  , camera_("camera", "Camera", tgt::Camera(vec3(0.f, 0.f, 3.5f), vec3(0.f, 0.f, 0.f), vec3(0.f, 1.f, 0.f)))
+  , headlessSize_("headlessSize", "Image Size (without OpenGL)", ivec2(512), ivec2(1), ivec2(8192))
+  , volume_(0)
+  , gradientVolume_(0)
+  , lookupTable_(0)
+  , preIntegrationTable_(0)
+  , imageDimensions_(0)
 {
     addPort(volumePort_);
     addPort(gradientVolumePort_);
-    addPort(entryPort_);
-    addPort(exitPort_);
     addPort(outport_);
 
     addProperty(transferFunc_);
+    addProperty(camera_);
+
+    // pre-integrated classification is looked up in the CPU-side table
+    classificationMode_.addOption("pre-integrated", "Pre-integrated TF");
+    addProperty(classificationMode_);
 
     // volume texture filtering
     texFilterMode_.addOption("nearest", "Nearest",  GL_NEAREST);
     texFilterMode_.addOption("linear",  "Linear",   GL_LINEAR);
     texFilterMode_.selectByKey("linear");
     addProperty(texFilterMode_);
+
+    addProperty(headlessSize_);
 }
 
 Processor* CPURaycaster::create() const {
@@ -65,18 +79,28 @@ Processor* CPURaycaster::create() const {
 }
 
 bool CPURaycaster::isReady() const {
-    return (volumePort_.hasData() && entryPort_.isConnected() && exitPort_.isConnected());
+    return volumePort_.hasData();
+}
+
+const std::vector<vec4>& CPURaycaster::getImage() const {
+    return image_;
+}
+
+ivec2 CPURaycaster::getImageSize() const {
+    return imageDimensions_;
 }
 
 void CPURaycaster::process() {
 
-    tgtAssert(volumePort_.getData()->getRepresentation<Volume>(), "no input volume");
+    const VolumeHandleBase* volumeHandle = volumePort_.getData();
+    volume_ = volumeHandle->getRepresentation<Volume>();
+    tgtAssert(volume_, "no input volume");
 
-    transferFunc_.setVolumeHandle(volumePort_.getData());
-    LGL_ERROR;
+    transferFunc_.setVolumeHandle(volumeHandle);
 
-    // determine TF type
-    intensityGradientTF_ = false;
+    // determine TF type and fetch its lookup table
+    bool intensityGradientTF = false;
+    lookupTable_ = 0;
     if (transferFunc_.get()) {
         TransFuncIntensity* tfi = dynamic_cast<TransFuncIntensity*>(transferFunc_.get());
         if (tfi == 0) {
@@ -86,196 +110,228 @@ void CPURaycaster::process() {
                 return;
             }
             else {
-                intensityGradientTF_ = true;
+                intensityGradientTF = true;
+                lookupTable_ = &tfig->getLookupTable();
             }
         } 
+        else
+            lookupTable_ = &tfi->getLookupTable();
+    }
+    if (!lookupTable_) {
+        LWARNING("No transfer function");
+        return;
     }
 
     // if 2D TF: check whether gradient volume is supplied
-    if (intensityGradientTF_ ) {
+    gradientVolume_ = 0;
+    if (intensityGradientTF) {
         if (!gradientVolumePort_.hasData() || gradientVolumePort_.getData()->getRepresentation<Volume>()->getNumChannels() < 3) {
             LERROR("To use 2D tfs a RGB or RGBA gradient volume is needed");
             return;
         }
-        if (gradientVolumePort_.getData()->getRepresentation<Volume>()->getDimensions() != volumePort_.getData()->getRepresentation<Volume>()->getDimensions()) {
+        if (gradientVolumePort_.getData()->getRepresentation<Volume>()->getDimensions() != volume_->getDimensions()) {
             LERROR("Gradient volume dimensions differ from intensity volume dimensions");
             return;
         }
+        gradientVolume_ = gradientVolumePort_.getData()->getRepresentation<Volume>();
     }
 
-    // activate outport
-    outport_.activateTarget();
-    outport_.clearTarget();
-    LGL_ERROR;
-
-    // create output buffer
-    tgt::vec4* output = new tgt::vec4[entryPort_.getSize().x * entryPort_.getSize().y];
-
-    // download entry/exit point textures
-    tgt::vec4* entryBuffer = reinterpret_cast<tgt::vec4*>(
-        entryPort_.getColorTexture()->downloadTextureToBuffer(GL_RGBA, GL_FLOAT));
-    tgt::vec4* exitBuffer = reinterpret_cast<tgt::vec4*>(
-        exitPort_.getColorTexture()->downloadTextureToBuffer(GL_RGBA, GL_FLOAT));
-    LGL_ERROR;
-
-    // iterate over viewport and perform ray casting for each fragment
-    for (int y=0; y < entryPort_.getSize().y; ++y) {
-        for (int x=0; x < entryPort_.getSize().x; ++x) {
-            vec4 gl_FragColor = vec4(0.f);
-            int p = (y * entryPort_.getSize().x + x);
-
-            vec4 frontPos = entryBuffer[p];
-            vec4 backPos = exitBuffer[p];
+    // use dimension with the highest resolution for calculating the sampling step size
+    volumeDimensions_ = vec3(volume_->getDimensions() - svec3(1));
+    samplingStepSize_ = 1.f / (tgt::max(volume_->getDimensions()) * samplingRate_.get());
+
+    // the pre-integration table refers to the sampling step size
+    preIntegrationTable_ = 0;
+    if (classificationMode_.isSelected("pre-integrated")) {
+        if (intensityGradientTF)
+            LWARNING("Pre-integrated classification requires a 1D transfer function");
+        else
+            preIntegrationTable_ = static_cast<TransFuncIntensity*>(transferFunc_.get())->getPreIntegrationTable(samplingStepSize_);
+    }
 
-            if ((frontPos == vec4(0.0)) && (backPos == vec4(0.0))) {
-                //background needs no raycasting
-            }
-            else {
-                //fragCoords are lying inside the boundingbox
-                gl_FragColor = directRendering(frontPos.xyz(), backPos.xyz());
+    // the image has the size of the render target, if there is one
+    bool useRenderTarget = outport_.hasRenderTarget();
+    imageDimensions_ = useRenderTarget ? outport_.getSize() : headlessSize_.get();
+    image_.assign(imageDimensions_.x * imageDimensions_.y, vec4(0.f));
+
+    // mapping from pixel coordinates and NDC depth to texture coordinates
+    tgt::Camera cam = camera_.get();
+    cam.setWindowRatio(static_cast<float>(imageDimensions_.x) / imageDimensions_.y);
+    tgt::mat4 viewProjectionInverse = tgt::mat4::identity;
+    (cam.getProjectionMatrix() * cam.getViewMatrix()).invert(viewProjectionInverse);
+    tgt::mat4 pixelToNDC = tgt::mat4::createTranslation(vec3(-1.f, -1.f, 0.f))
+        * tgt::mat4::createScale(vec3(2.f / imageDimensions_.x, 2.f / imageDimensions_.y, 1.f))
+        * tgt::mat4::createTranslation(vec3(0.5f, 0.5f, 0.f));
+    pixelToTexture_ = volumeHandle->getWorldToTextureMatrix() * viewProjectionInverse * pixelToNDC;
+
+    // render the tiles in parallel
+    const int tilesX = (imageDimensions_.x + TILE_SIZE - 1) / TILE_SIZE;
+    const int tilesY = (imageDimensions_.y + TILE_SIZE - 1) / TILE_SIZE;
+    const int numTiles = tilesX * tilesY;
+
+    #ifdef _OPENMP
+    #pragma omp parallel
+    #endif
+    {
+        // per-thread scratch: rays of the current tile that hit the volume
+        std::vector<vec3> first(TILE_SIZE * TILE_SIZE);
+        std::vector<vec3> last(TILE_SIZE * TILE_SIZE);
+        std::vector<int> pixels(TILE_SIZE * TILE_SIZE);
+        vec4 colors[PACKET_SIZE];
+
+        #ifdef _OPENMP
+        #pragma omp for schedule(dynamic)
+        #endif
+        for (int tile = 0; tile < numTiles; ++tile) {
+            ivec2 start(tile % tilesX * TILE_SIZE, tile / tilesX * TILE_SIZE);
+            ivec2 end = tgt::min(start + ivec2(TILE_SIZE), imageDimensions_);
+
+            int numRays = 0;
+            for (int y = start.y; y < end.y; ++y) {
+                for (int x = start.x; x < end.x; ++x) {
+                    if (setupRay(ivec2(x, y), first[numRays], last[numRays]))
+                        pixels[numRays++] = y * imageDimensions_.x + x;
+                }
             }
 
-            output[p] = gl_FragColor;
+            for (int i = 0; i < numRays; i += PACKET_SIZE) {
+                int count = std::min(PACKET_SIZE, numRays - i);
+                castRayPacket(&first[i], &last[i], count, colors);
+                for (int j = 0; j < count; ++j)
+                    image_[pixels[i + j]] = colors[j];
+            }
         }
     }
-    delete[] entryBuffer;
-    delete[] exitBuffer;
-
-    // draw output buffer to outport
-    glWindowPos2i(0, 0);
-    glDrawPixels(outport_.getSize().x, outport_.getSize().y, GL_RGBA, GL_FLOAT, output);
-    LGL_ERROR;
 
-    delete[] output;
-    outport_.deactivateTarget();
-    LGL_ERROR;
+    // copy the image to the outport
+    if (useRenderTarget) {
+        outport_.activateTarget();
+        outport_.clearTarget();
+        outport_.getColorTexture()->bind();
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, imageDimensions_.x, imageDimensions_.y, GL_RGBA, GL_FLOAT, &image_[0]);
+        outport_.deactivateTarget();
+        LGL_ERROR;
+    }
 }
 
-vec4 CPURaycaster::directRendering(const vec3& first, const vec3& last) {
-
-    tgtAssert(transferFunc_.get(), "no transfunc");
+bool CPURaycaster::setupRay(const ivec2& pixel, vec3& first, vec3& last) const {
+    vec4 nearPoint = pixelToTexture_ * vec4(static_cast<float>(pixel.x), static_cast<float>(pixel.y), -1.f, 1.f);
+    vec4 farPoint = pixelToTexture_ * vec4(static_cast<float>(pixel.x), static_cast<float>(pixel.y), 1.f, 1.f);
+    vec3 origin = nearPoint.xyz() / nearPoint.w;
+    vec3 direction = farPoint.xyz() / farPoint.w - origin;
+
+    // clip the segment between near and far plane against the unit cube
+    float tNear = 0.f;
+    float tFar = 1.f;
+    for (int i = 0; i < 3; ++i) {
+        if (std::abs(direction[i]) < 1e-12f) {
+            if (origin[i] < 0.f || origin[i] > 1.f)
+                return false;
+        }
+        else {
+            float t0 = -origin[i] / direction[i];
+            float t1 = (1.f - origin[i]) / direction[i];
+            if (t0 > t1)
+                std::swap(t0, t1);
+            tNear = std::max(tNear, t0);
+            tFar = std::min(tFar, t1);
+        }
+    }
+    if (tNear >= tFar)
+        return false;
 
-    // retrieve intensity volume
-    const Volume* volume = volumePort_.getData()->getRepresentation<Volume>();
-    tgtAssert(volume, "no input volume");
-    tgt::svec3 volDim = volume->getDimensions();
-    tgt::vec3 volDimF = tgt::vec3((volume->getDimensions() - svec3(1)));
+    first = origin + tNear * direction;
+    last = origin + tFar * direction;
+    return true;
+}
 
-    // retrieve gradient volume, if 2D TF is to be applied
-    const Volume* volumeGradient = 0;
-    if (intensityGradientTF_) {
-        volumeGradient = gradientVolumePort_.getData()->getRepresentation<Volume>();
-        tgtAssert(volumeGradient, "no gradient volume");
-        tgtAssert(volumeGradient->getNumChannels() >= 3, "gradient volume has less than three channels");
-        tgtAssert(volumeGradient->getDimensions() == volDim, "dimensions mismatch");
+void CPURaycaster::castRayPacket(const vec3* first, const vec3* last, int count, vec4* result) const {
+    // per-ray state
+    vec3 direction[PACKET_SIZE];
+    int numSamples[PACKET_SIZE];
+    float previousIntensity[PACKET_SIZE];
+    int active[PACKET_SIZE];
+    int numActive = 0;
+
+    for (int i = 0; i < count; ++i) {
+        result[i] = vec4(0.f);
+        previousIntensity[i] = -1.f;
+
+        // samples are taken at t = 0, samplingStepSize, ... up to the ray length
+        float length = tgt::length(last[i] - first[i]);
+        direction[i] = (length > 0.f) ? (last[i] - first[i]) / length : vec3(0.f);
+        numSamples[i] = std::min(static_cast<int>(length / samplingStepSize_) + 1, 255*255);
+        active[numActive++] = i;
     }
 
-    // use dimension with the highest resolution for calculating the sampling step size
-    float samplingStepSize = 1.f / (tgt::max(volDim) * samplingRate_.get());
-
-    // retrieve tf texture
-    tgt::Texture* tfTexture = transferFunc_.get()->getTexture();
-    tfTexture->downloadTexture();
-
-    // calculate ray parameters
-    float tend;
-    float t = 0.0f;
-    vec3 direction = last - first;
-    // if direction is a nullvector the entry- and exitparams are the same
-    // so special handling for tend is needed, otherwise we divide by zero
-    // furthermore both for-loops will cause only 1 pass overall.
-    // The test whether last and first are nullvectors is already done in main-function
-    // but however the framerates are higher with this test.
-    if (direction == vec3(0.0f) && last != vec3(0.0f) && first != vec3(0.0f))
-        tend = samplingStepSize / 2.0f;
-    else {
-        tend = length(direction);
-        direction = normalize(direction);
-    }
-    
-    // ray-casting loop
-    vec4 result = vec4(0.0f);
-    float depthT = -1.0f;
-    bool finished = false;
-    for (int loop=0; !finished && loop<255*255; ++loop) {
-        vec3 sample = first + t * direction;
-        float intensity = 0.f;
-        if (texFilterMode_.getValue() == GL_NEAREST) 
-            intensity = volume->getVoxelFloat(tgt::iround(sample*volDimF));
-        else if (texFilterMode_.getValue() == GL_LINEAR) 
-            intensity = volume->getVoxelFloatLinear(sample*volDimF);
-        else 
-            LERROR("Unknown texture filter mode");
-
-        // no shading is applied
-        vec4 color;
-        if (!intensityGradientTF_)
-            color = apply1DTF(tfTexture, intensity);
-        else {
-            tgt::vec3 grad;
-            if (texFilterMode_.getValue() == GL_NEAREST) {
-                tgt::ivec3 iSample = tgt::iround(sample*volDimF);
-                grad.x = volumeGradient->getVoxelFloat(iSample, 0);
-                grad.y = volumeGradient->getVoxelFloat(iSample, 1);
-                grad.z = volumeGradient->getVoxelFloat(iSample, 2);
-            }
-            else if (texFilterMode_.getValue() == GL_LINEAR) {
-                grad.x = volumeGradient->getVoxelFloatLinear(sample*volDimF, 0);
-                grad.y = volumeGradient->getVoxelFloatLinear(sample*volDimF, 1);
-                grad.z = volumeGradient->getVoxelFloatLinear(sample*volDimF, 2);
+    float intensities[PACKET_SIZE];
+    float gradientMagnitudes[PACKET_SIZE];
+    vec4 colors[PACKET_SIZE];
+    const bool nearest = (texFilterMode_.getValue() == GL_NEAREST);
+
+    for (int step = 0; numActive > 0; ++step) {
+        float t = step * samplingStepSize_;
+
+        // sample all active rays
+        for (int k = 0; k < numActive; ++k) {
+            int i = active[k];
+            vec3 pos = (first[i] + t * direction[i]) * volumeDimensions_;
+            if (nearest)
+                intensities[k] = volume_->getVoxelFloat(svec3(tgt::iround(pos)));
+            else
+                intensities[k] = volume_->getVoxelFloatLinear(pos);
+
+            if (gradientVolume_) {
+                vec3 grad;
+                for (int c = 0; c < 3; ++c) {
+                    if (nearest)
+                        grad[c] = gradientVolume_->getVoxelFloat(svec3(tgt::iround(pos)), c);
+                    else
+                        grad[c] = gradientVolume_->getVoxelFloatLinear(pos, c);
+                }
+                gradientMagnitudes[k] = tgt::clamp(tgt::length(grad), 0.f, 1.f);
             }
-            else 
-                LERROR("Unknown texture filter mode");
-
-            float gradMag = tgt::clamp(tgt::length(grad), 0.f, 1.f);
-            color = apply2DTF(tfTexture, intensity, gradMag);
         }
 
-        // perform compositing
-        if (color.a > 0.0f) {
-            // multiply alpha by samplingStepSize
-            // to accommodate for variable sampling rate
-            color.a *= samplingStepSize*200.f;
-            vec3 result_rgb = vec3(result.elem) + (1.0f - result.a) * color.a * vec3(color.elem);
-            result.a = result.a + (1.0f - result.a) * color.a;
-
-            result.r = result_rgb.r;
-            result.g = result_rgb.g;
-            result.b = result_rgb.b;
+        // classify the packet; no shading is applied
+        if (preIntegrationTable_) {
+            // segment between the previous and the current sample
+            for (int k = 0; k < numActive; ++k) {
+                int i = active[k];
+                float front = (previousIntensity[i] < 0.f) ? intensities[k] : previousIntensity[i];
+                colors[k] = preIntegrationTable_->lookup(front, intensities[k]);
+                previousIntensity[i] = intensities[k];
+            }
         }
+        else if (gradientVolume_)
+            lookupTable_->lookup(intensities, gradientMagnitudes, colors, numActive);
+        else
+            lookupTable_->lookup(intensities, colors, numActive);
+
+        // composite and retire finished rays
+        int numRemaining = 0;
+        for (int k = 0; k < numActive; ++k) {
+            int i = active[k];
+            vec4 color = colors[k];
+            vec4& res = result[i];
+
+            if (color.a > 0.f) {
+                // multiply alpha by samplingStepSize to accommodate for variable sampling rate
+                // (pre-integrated opacities already refer to the step size)
+                if (!preIntegrationTable_)
+                    color.a *= samplingStepSize_ * 200.f;
+                res.xyz() += (1.f - res.a) * color.a * color.xyz();
+                res.a += (1.f - res.a) * color.a;
+            }
 
-        // save first hit ray parameter for depth value calculation
-        if (depthT < 0.0f && result.a > 0.0f)
-            depthT = t;
-
-        // early ray termination
-        if (result.a >= 0.95f) {
-             result.a = 1.0f;
-             finished = true;
+            // early ray termination
+            if (res.a >= 0.95f)
+                res.a = 1.f;
+            else if (step + 1 < numSamples[i])
+                active[numRemaining++] = i;
         }
-
-        t += samplingStepSize;
-        finished = finished || (t > tend);
-    
-    } // ray-casting loop
-
-    // calculate depth value from ray parameter (todo)
-    // gl_FragDepth = 1.0;
-    // if (depthT >= 0.0)
-    //  gl_FragDepth = calculateDepthValue(depthT / tend);
-
-    return result;
-}
-
-vec4 CPURaycaster::apply1DTF(tgt::Texture* tfTexture, float intensity) {
-    vec4 value = vec4(tfTexture->texel<tgt::col4>(size_t(intensity * (tfTexture->getWidth()-1)))) / 255.f;
-    return value;
-}
-
-vec4 CPURaycaster::apply2DTF(tgt::Texture* tfTexture, float intensity, float gradientMagnitude) {
-    vec4 value = vec4(tfTexture->texel<tgt::vec4>(size_t(intensity * (tfTexture->getWidth()-1)),
-        size_t(gradientMagnitude * (tfTexture->getHeight()-1))));
-    return value;
+        numActive = numRemaining;
+    }
 }
 
 } // namespace voreen
@@ -32,13 +32,25 @@
 #include "voreen/core/processors/volumeraycaster.h"
 #include "voreen/core/properties/transfuncproperty.h"
 #include "voreen/core/properties/optionproperty.h"
+#include "voreen/core/properties/cameraproperty.h"
+#include "voreen/core/properties/vectorproperty.h"
 
 #include "voreen/core/ports/volumeport.h"
 
+#include <vector>
+
 namespace voreen {
 
+class PreIntegrationTable;
+class TransFuncLookupTable;
+
 /**
- * Performs a simple raycasting on the CPU.
+ * Performs raycasting on the CPU.
+ *
+ * The rays are set up analytically from the camera and the bounding box of the volume,
+ * so no entry/exit point textures are needed. The image is divided into tiles that are
+ * rendered in parallel, each tile casting its rays in packets that are classified
+ * together. The result is kept in memory and, if OpenGL is available, copied to the outport.
  */
 class CPURaycaster : public VolumeRaycaster {
 public:
@@ -49,30 +61,62 @@ public:
     virtual std::string getCategory() const   { return "Raycasting";   }
     virtual CodeState getCodeState() const    { return CODE_STATE_TESTING; }
 
-    /// All ports except the gradient port need to be connected. 
+    /// Only the volume port needs to be connected.
     virtual bool isReady() const;
 
+    /// Renders into getImage() without OpenGL, if the outport has no render target.
+    virtual bool requiresOpenGL() const  { return false; }
+
+    /**
+     * Returns the image rendered by the last process() call: RGBA colors,
+     * stored row by row starting with the bottom row.
+     */
+    const std::vector<tgt::vec4>& getImage() const;
+
+    /// Returns the size of the image rendered by the last process() call.
+    tgt::ivec2 getImageSize() const;
+
 protected:
     virtual void process();
 
+    /// Edge length of the square image tiles that are distributed among the threads.
+    static const int TILE_SIZE = 16;
+
+    /// Number of rays that are traversed in lockstep.
+    static const int PACKET_SIZE = 8;
+
+    /**
+     * Computes the entry and exit point of the ray through the given pixel in texture
+     * coordinates of the volume. Returns false, if the ray misses the volume.
+     */
+    bool setupRay(const tgt::ivec2& pixel, tgt::vec3& first, tgt::vec3& last) const;
+
     /**
-     * Performs the actual ray casting for a single ray, 
-     * which determined by the passed entry and exit points.
+     * Casts up to PACKET_SIZE rays, given by their entry and exit points,
+     * and writes the composited colors to result.
      */
-    virtual tgt::vec4 directRendering(const tgt::vec3& first, const tgt::vec3& last);
-    tgt::vec4 apply1DTF(tgt::Texture* tfTexture, float intensity);
-    tgt::vec4 apply2DTF(tgt::Texture* tfTexture, float intensity, float gradientMagnitude);
+    void castRayPacket(const tgt::vec3* first, const tgt::vec3* last, int count, tgt::vec4* result) const;
 
     VolumePort volumePort_;
     VolumePort gradientVolumePort_;
-    RenderPort entryPort_;
-    RenderPort exitPort_;
     RenderPort outport_;
 
     TransFuncProperty transferFunc_;   ///< the property that controls the transfer-function
     IntOptionProperty texFilterMode_;  ///< texture filtering mode to use for volume access
+    CameraProperty camera_;            ///< the camera the rays are cast from
+    IntVec2Property headlessSize_;     ///< image size used when the outport has no render target
+
+private:
+    // per-frame ray casting state, set up by process()
+    const Volume* volume_;
+    const Volume* gradientVolume_;
+    tgt::vec3 volumeDimensions_;                ///< dimensions minus one, for mapping texture to voxel coordinates
+    tgt::mat4 pixelToTexture_;                  ///< maps pixel coordinates and NDC depth to texture coordinates
+    const TransFuncLookupTable* lookupTable_;   ///< float lookup table of the transfer function
+    PreIntegrationTable* preIntegrationTable_;  ///< table of the current frame, if pre-integrated classification is selected
 
-    bool intensityGradientTF_;
+    std::vector<tgt::vec4> image_;
+    tgt::ivec2 imageDimensions_;
 };
 
 } // namespace voreen
@@ -73,6 +73,7 @@ SingleVolumeRaycaster::SingleVolumeRaycaster()
     addProperty(transferFunc_);
     addProperty(camera_);
     addProperty(gradientMode_);
+    classificationMode_.addOption("pre-integrated", "Pre-integrated TF");
     addProperty(classificationMode_);
     addProperty(shadeMode_);
     
@@ -274,8 +275,10 @@ void SingleVolumeRaycaster::process() {
         compositingMode2_.isSelected("iso") )
         raycastPrg_->setUniform("isoValue_", isoValue_.get());
 
-    if (classificationMode_.get() == "transfer-function") {
+    TextureUnit preIntegrationUnit;
+    if (!classificationMode_.isSelected("none")) {
         transferFunc_.get()->setUniform(raycastPrg_, "transferFunc_", transferUnit.getUnitNumber());
+        bindPreIntegrationTable(raycastPrg_, transferFunc_.get(), preIntegrationUnit);
     }
     
     if (compositingMode_.isSelected("mida"))
@@ -45,6 +45,7 @@ public:
     virtual std::string getClassName() const { return "VectorMagnitude"; }
     virtual std::string getCategory() const  { return "Volume Processing"; }
     virtual CodeState getCodeState() const   { return CODE_STATE_STABLE; }
+    virtual bool usesOpenGL() const          { return false; }
 
 protected:
     virtual void process();
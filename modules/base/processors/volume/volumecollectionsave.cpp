@@ -27,10 +27,11 @@
  **********************************************************************/
 
 #include "volumecollectionsave.h"
-#include "voreen/core/io/volumeserializer.h"
-#include "voreen/core/io/volumeserializerpopulator.h"
+#include "voreen/core/io/volumewritejob.h"
 #include "voreen/core/utils/stringconversion.h"
+#include "voreen/core/voreenapplication.h"
 #include "tgt/filesystem.h"
+#include "tgt/event/timeevent.h"
 
 namespace voreen {
 
@@ -41,36 +42,64 @@ VolumeCollectionSave::VolumeCollectionSave()
     inport_(Port::INPORT, "volumehandle.input", false, Processor::INVALID_RESULT),
     outputDirectory_("outputDirectory", "Directory", "Select directory...",
         "", "", FileDialogProperty::DIRECTORY, Processor::VALID),
+    outputDataType_("outputDataType", "Output Data Type", Processor::VALID),
+    compressed_("compressed", "Compress Data Files", false, Processor::VALID),
+    saveInBackground_("saveInBackground", "Save in Background", true, Processor::VALID),
     continousSave_("continousSave", "Save continuously", false, Processor::VALID),
     saveButton_("save", "Save"),
-    volumeSerializerPopulator_(0)
+    job_(0),
+    savePending_(false),
+    timer_(0),
+    eventHandler_()
 {
 
     outputDirectory_.onChange(CallMemberAction<VolumeCollectionSave>(this, &VolumeCollectionSave::saveCollection));
     addProperty(outputDirectory_);
 
+    outputDataType_.addOption("",       "Unchanged");
+    outputDataType_.addOption("uint8",  "8 Bit Unsigned Integer (uint8)");
+    outputDataType_.addOption("int8",   "8 Bit Signed Integer (int8)");
+    outputDataType_.addOption("uint16", "16 Bit Unsigned Integer (uint16)");
+    outputDataType_.addOption("int16",  "16 Bit Signed Integer (int16)");
+    outputDataType_.addOption("float",  "Float");
+    outputDataType_.addOption("double", "Double");
+    addProperty(outputDataType_);
+
+    addProperty(compressed_);
+    addProperty(saveInBackground_);
     addProperty(continousSave_);
 
     saveButton_.onChange(CallMemberAction<VolumeCollectionSave>(this, &VolumeCollectionSave::saveCollection));
     addProperty(saveButton_);
 
     addPort(inport_);
+
+    eventHandler_.addListenerToBack(this);
+    if (VoreenApplication::app())
+        timer_ = VoreenApplication::app()->createTimer(&eventHandler_);
 }
 
 VolumeCollectionSave::~VolumeCollectionSave() {
-    delete volumeSerializerPopulator_;
+    delete timer_;
+    // the job waits for the running save
+    delete job_;
 }
 
 Processor* VolumeCollectionSave::create() const {
     return new VolumeCollectionSave();
 }
 
-void VolumeCollectionSave::initialize() throw (tgt::Exception) {
-
-    VolumeProcessor::initialize();
+void VolumeCollectionSave::deinitialize() throw (tgt::Exception) {
+    if (timer_)
+        timer_->stop();
+    // a started save is completed, a pending one discarded
+    savePending_ = false;
+    if (job_) {
+        job_->join();
+        finishSave();
+    }
 
-    tgtAssert(!volumeSerializerPopulator_, "serializer populator already created");
-    volumeSerializerPopulator_ = new VolumeSerializerPopulator();
+    VolumeProcessor::deinitialize();
 }
 
 void VolumeCollectionSave::process() {
@@ -82,40 +111,98 @@ void VolumeCollectionSave::saveCollection() {
     if (!isInitialized())
         return;
 
-    tgtAssert(volumeSerializerPopulator_, "no populator");
-
     if (!inport_.hasData() || inport_.getData()->empty())
         return;
     if (outputDirectory_.get() == "")
         return;
 
+    // the running save is completed first, since both may write the same files
+    if (job_) {
+        savePending_ = true;
+        return;
+    }
+
+    VolumeWriteJob* job = new VolumeWriteJob();
+    job->setOutputDataType(outputDataType_.get());
+    job->setCompressed(compressed_.get());
+
+    // the volumes are copied for the background thread, since the collection may change meanwhile
+    bool background = saveInBackground_.get() && timer_;
+
     std::string directory = outputDirectory_.get();
-    const VolumeSerializer* serializer = volumeSerializerPopulator_->getVolumeSerializer();
     const VolumeCollection* inputCollection = inport_.getData();
     tgtAssert(inputCollection, "no collection");
-    try {
-        for (size_t i=0; i<inputCollection->size(); i++) {    
-            std::string volFilename = "";
-            if(dynamic_cast<VolumeHandle*>(inputCollection->at(i)))
-                volFilename = static_cast<VolumeHandle*>(inputCollection->at(i))->getOrigin().getFilename();
-            if (volFilename == "") {
-                volFilename = "volume";
-                if (i < 10)
-                    volFilename += "00";
-                else if (i < 100)
-                    volFilename += "0";
-                volFilename += itos(i) + ".dat";
-            }
-            else 
-                volFilename = tgt::FileSystem::fileName(volFilename);
-            std::string outputFilename = directory + "/" + volFilename;
-            serializer->write(outputFilename, inputCollection->at(i));
+    for (size_t i=0; i<inputCollection->size(); i++) {
+        std::string volFilename = "";
+        if(dynamic_cast<VolumeHandle*>(inputCollection->at(i)))
+            volFilename = static_cast<VolumeHandle*>(inputCollection->at(i))->getOrigin().getFilename();
+        if (volFilename == "") {
+            volFilename = "volume";
+            if (i < 10)
+                volFilename += "00";
+            else if (i < 100)
+                volFilename += "0";
+            volFilename += itos(i) + ".dat";
+        }
+        else
+            volFilename = tgt::FileSystem::fileName(volFilename);
+        std::string outputFilename = directory + "/" + volFilename;
+        job->addVolume(outputFilename, inputCollection->at(i), background);
+    }
+
+    if (background) {
+        try {
+            job->start();
+            job_ = job;
+            setProgress(0.f);
+            if (timer_->isStopped())
+                timer_->start(50);
+            return;
+        }
+        catch (VoreenException& e) {
+            LWARNING("Failed to start saving in background, saving synchronously: " << e.what());
         }
-    } 
-    catch (tgt::FileException e) {
-        LERROR("Failed to save volume collection: " << e.what());
-        //basename_.set("");
     }
+
+    job->setProgressBar(progressBar_);
+    job->writeVolumes();
+    reportErrors(job->getErrors());
+    delete job;
+}
+
+void VolumeCollectionSave::timerEvent(tgt::TimeEvent* e) {
+    if (!job_)
+        timer_->stop();
+    else if (!job_->isFinished())
+        setProgress(job_->getProgress());
+    else
+        finishSave();
+
+    if (e)
+        e->accept();
+}
+
+void VolumeCollectionSave::finishSave() {
+    tgtAssert(job_, "no save running");
+
+    VolumeWriteJob* job = job_;
+    job_ = 0;
+    setProgress(1.f);
+    reportErrors(job->getErrors());
+    delete job;
+
+    if (savePending_) {
+        savePending_ = false;
+        saveCollection();
+    }
+    else if (timer_) {
+        timer_->stop();
+    }
+}
+
+void VolumeCollectionSave::reportErrors(const std::vector<std::string>& errors) {
+    for (size_t i=0; i<errors.size(); i++)
+        LERROR("Failed to save volume collection: " << errors[i]);
 }
 
 }   // namespace
@@ -34,16 +34,20 @@
 #include "voreen/core/properties/filedialogproperty.h"
 #include "voreen/core/properties/boolproperty.h"
 #include "voreen/core/properties/buttonproperty.h"
+#include "voreen/core/properties/optionproperty.h"
 #include "voreen/core/ports/genericport.h"
 
 #include <string>
 
 namespace voreen {
 
-class VolumeHandle;
-class VolumeSerializer;
-class VolumeSerializerPopulator;
+class VolumeWriteJob;
 
+/**
+ * Saves the volumes of the input collection to a directory, by default on a
+ * background thread. A save requested while the previous one is still running
+ * is started once it has finished.
+ */
 class VolumeCollectionSave : public VolumeProcessor {
 public:
     VolumeCollectionSave();
@@ -57,18 +61,33 @@ public:
 
     virtual void saveCollection();
 
+    /// Polls the running save.
+    virtual void timerEvent(tgt::TimeEvent* e);
+
 protected:
     virtual void process();
-    virtual void initialize() throw (tgt::Exception);
+    virtual void deinitialize() throw (tgt::Exception);
 
 private:
+    /// Reports the result of the finished save and starts a pending one.
+    void finishSave();
+
+    /// Logs the errors of a save.
+    void reportErrors(const std::vector<std::string>& errors);
+
     VolumeCollectionPort inport_;
 
     FileDialogProperty outputDirectory_;
+    StringOptionProperty outputDataType_;
+    BoolProperty compressed_;
+    BoolProperty saveInBackground_;
     BoolProperty continousSave_;
     ButtonProperty saveButton_;
 
-    VolumeSerializerPopulator* volumeSerializerPopulator_;
+    VolumeWriteJob* job_;               ///< currently running save
+    bool savePending_;                  ///< a save has been requested while the job is running
+    tgt::Timer* timer_;                 ///< polls the running save
+    tgt::EventHandler eventHandler_;
 
     static const std::string loggerCat_; ///< category used in logging
 };
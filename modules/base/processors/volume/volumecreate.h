@@ -45,6 +45,7 @@ public:
     std::string getClassName() const  { return "VolumeCreate";      }
     std::string getCategory() const   { return "Volume Processing"; }
     CodeState getCodeState() const    { return CODE_STATE_STABLE;  }
+    virtual bool usesOpenGL() const   { return false; }
     Processor* create() const { return new VolumeCreate; }
 
 protected:
@@ -46,6 +46,7 @@ public:
     virtual std::string getCategory() const { return "Volume Processing"; }
     virtual std::string getClassName() const { return "VolumeCubify"; }
     virtual CodeState getCodeState() const { return CODE_STATE_STABLE; }
+    virtual bool usesOpenGL() const        { return false; }
 
 protected:
     virtual void process();
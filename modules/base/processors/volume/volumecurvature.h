@@ -46,6 +46,7 @@ public:
     virtual std::string getCategory() const  { return "Volume Processing"; }
     virtual std::string getClassName() const { return "VolumeCurvature"; }
     virtual CodeState getCodeState() const   { return CODE_STATE_STABLE; }
+    virtual bool usesOpenGL() const          { return false; }
 
 private:
     virtual void process();
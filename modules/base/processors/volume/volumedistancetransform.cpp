@@ -33,140 +33,174 @@
 
 namespace voreen {
 
-VolumeDistanceTransform::VolumeDistanceTransform()
-    : CachingVolumeProcessor()
-    , inport_(Port::INPORT, "volumehandle.input")
-    , outport_(Port::OUTPORT, "volumehandle.output", 0)
+/// Computes the distance transform of the input volume in the background.
+class VolumeDistanceTransform::DistanceTransformJob : public AsyncVolumeProcessor::Job {
+public:
+    DistanceTransformJob(const VolumeHandleBase* input) {
+        addInput(input);
+    }
 
-{
-    addPort(inport_);
-    addPort(outport_);
-}
+    virtual VolumeHandle* compute() {
+        VolumeUInt16* v = 0;
+        const VolumeHandleBase* handle = getInput(0);
+        const Volume* vol = handle->getRepresentation<Volume>();
+
+        // the copy of the input made for the background computation is transformed in place
+        VolumeHandle* copy = takeInputCopy(0);
+        VolumeHandle* result = 0;
+
+        if (!dynamic_cast<const VolumeUInt16*>(vol)) {
+            v = new VolumeUInt16(vol->getDimensions());
+            for (size_t z=0; z<v->getDimensions().z ; z++) {
+                for (size_t x=0; x<v->getDimensions().x ; x++)
+                    for (size_t y=0 ;y<v->getDimensions().y ; y++)
+                        if (vol->getVoxelFloat(x,y,z) > 0.5) {
+                            v->voxel(x,y,z) = 65535;
+                        }
+                        else
+                            v->voxel(x,y,z) = 0;
+            }
+            //LWARNING("Currently only 16 bit volumes supported.");
+            //return;
+            result = new VolumeHandle(v, handle);
+            delete copy;
+        }
+        else if (copy) {
+            v = static_cast<VolumeUInt16*>(copy->getWritableRepresentation<Volume>());
+            result = copy;
+        }
+        else {
+            v = dynamic_cast<VolumeUInt16*>(vol->clone());
+            result = new VolumeHandle(v, handle);
+        }
 
-VolumeDistanceTransform::~VolumeDistanceTransform() {}
+        uint16_t val = 65535;
+        uint16_t dist = 0;
 
-std::string VolumeDistanceTransform::getCategory() const {
-    return "Volume Processing";
-}
+        for (size_t z=1; z<v->getDimensions().z-1 ; z++){
+            if (isInterrupted()) {
+                delete result;
+                return 0;
+            }
+            setProgress(0.5f * z / v->getDimensions().z);
+            for (size_t x=1; x<v->getDimensions().x-1 ; x++)
+                for (size_t y=1 ;y<v->getDimensions().y-1 ; y++)
+                    if (v->voxel(x,y,z) > 0) {
 
-std::string VolumeDistanceTransform::getClassName() const {
-    return "VolumeDistanceTransform";
-}
+                        dist = 0;
+                        val =  255;
 
-Processor::CodeState VolumeDistanceTransform::getCodeState() const {
-    return CODE_STATE_EXPERIMENTAL;
-}
+                        if (v->voxel(x-1,y,z) + 1 < val + dist)         {   val = v->voxel(x-1,y,z);  dist = 3; }
+                        if (v->voxel(x,y-1,z) + 3 < val + dist)         {   val = v->voxel(x,y-1,z);  dist = 3; }
+                        if (v->voxel(x-1,y-1,z) + 4 < val + dist )      {   val = v->voxel(x-1,y-1,z); dist = 4; }
+                        if (v->voxel(x+1,y-1,z) + 4 < val + dist )      {   val = v->voxel(x+1,y-1,z); dist = 4; }
+                        if (v->voxel(x,y,z-1) + 3 < val + dist)         {   val = v->voxel(x,y,z-1);  dist = 3; }
 
-Processor* VolumeDistanceTransform::create() const {
-    return new VolumeDistanceTransform();
-}
+                        if (v->voxel(x-1,y,z-1) + 4  < val + dist){ val = v->voxel(x-1,y,z-1); dist = 4; }
+                        if (v->voxel(x,y-1,z-1) + 4  < val + dist){ val = v->voxel(x,y-1,z-1); dist = 4; }
 
-void VolumeDistanceTransform::process() {
-    distanceTransform();
-}
+                        if (v->voxel(x-1,y,z+1) + 4  < val + dist){ val = v->voxel(x-1,y,z+1); dist = 4; }
+                        if (v->voxel(x,y-1,z+1) + 4  < val + dist){ val = v->voxel(x,y-1,z+1); dist = 4; }
 
-// private methods
-//
 
-void VolumeDistanceTransform::distanceTransform() {
-    tgtAssert(inport_.hasData(), "Inport has not data");
+                        if (v->voxel(x-1,y-1,z+1) + 5 < val + dist){ val = v->voxel(x-1,y-1,z+1); dist = 5; }
+                        if (v->voxel(x-1,y-1,z-1) + 5 < val + dist){ val = v->voxel(x-1,y-1,z-1); dist = 5; }
+
+                        if (v->voxel(x+1,y-1,z-1) + 5 < val + dist){ val = v->voxel(x+1,y-1,z-1); dist = 5; }
+                        if (v->voxel(x+1,y-1,z+1) + 5 < val + dist){ val = v->voxel(x+1,y-1,z+1); dist = 5; }
 
-    VolumeUInt16* v = 0;
-    const VolumeHandleBase* handle = inport_.getData();
-    const Volume* vol = inport_.getData()->getRepresentation<Volume>();
-
-    if (!dynamic_cast<const VolumeUInt16*>(vol)) {
-        v = new VolumeUInt16(vol->getDimensions());
-        for (size_t z=0; z<v->getDimensions().z ; z++) {
-            for (size_t x=0; x<v->getDimensions().x ; x++)
-                for (size_t y=0 ;y<v->getDimensions().y ; y++)
-                    if (vol->getVoxelFloat(x,y,z) > 0.5) {
-                        v->voxel(x,y,z) = 65535;
+                        v->voxel(x,y,z) = val + dist;
                     }
-                    else
-                        v->voxel(x,y,z) = 0;
         }
-        //LWARNING("Currently only 16 bit volumes supported.");
-        //return;
-    }
-    else {
-        v = dynamic_cast<VolumeUInt16*>(inport_.getData()->getRepresentation<Volume>()->clone());
-    }
 
-    uint16_t val = 65535;
-    uint16_t dist = 0;
+        for (size_t z=v->getDimensions().z-2; z>2; z--){
+            if (isInterrupted()) {
+                delete result;
+                return 0;
+            }
+            setProgress(1.f - 0.5f * z / v->getDimensions().z);
+            for (size_t x=v->getDimensions().x-2; x>2; x--)
+                for (size_t y=v->getDimensions().y-2; y>2; y--)
+                    if (v->voxel(x,y,z) > 0) {
+                        dist = 0;
+                        val = v->voxel(x,y,z);
 
-    for (size_t z=1; z<v->getDimensions().z-1 ; z++){
-        for (size_t x=1; x<v->getDimensions().x-1 ; x++)
-            for (size_t y=1 ;y<v->getDimensions().y-1 ; y++)
-                if (v->voxel(x,y,z) > 0) {
+                        if (v->voxel(x+1,y,z) + 3 < val + dist)          { val = v->voxel(x+1,y,z); dist = 3; }
+                        if (v->voxel(x,y+1,z) + 3 < val + dist)          { val = v->voxel(x,y+1,z); dist = 3; }
+                        if (v->voxel(x+1,y+1,z) + 4 < val + dist)        { val = v->voxel(x+1,y+1,z); dist = 4; }
+                        if (v->voxel(x,y,z+1) + 3  < val + dist)         { val = v->voxel(x,y,z+1); dist = 3; }
 
-                    dist = 0;
-                    val =  255;
+                        if (v->voxel(x-1,y+1,z) + 4 < val + dist){ val = v->voxel(x-1,y+1,z); dist = 4; }
+                        if (v->voxel(x-1,y+1,z+1) + 5 < val + dist){ val = v->voxel(x-1,y+1,z+1); dist = 5; }
+                        if (v->voxel(x-1,y+1,z-1) + 5 < val + dist){ val = v->voxel(x-1,y+1,z-1); dist = 5; }
 
-                    if (v->voxel(x-1,y,z) + 1 < val + dist)         {   val = v->voxel(x-1,y,z);  dist = 3; }
-                    if (v->voxel(x,y-1,z) + 3 < val + dist)         {   val = v->voxel(x,y-1,z);  dist = 3; }
-                    if (v->voxel(x-1,y-1,z) + 4 < val + dist )      {   val = v->voxel(x-1,y-1,z); dist = 4; }
-                    if (v->voxel(x+1,y-1,z) + 4 < val + dist )      {   val = v->voxel(x+1,y-1,z); dist = 4; }
-                    if (v->voxel(x,y,z-1) + 3 < val + dist)         {   val = v->voxel(x,y,z-1);  dist = 3; }
+                        if (v->voxel(x+1,y,z+1) + 4 < val + dist){ val = v->voxel(x+1,y,z+1); dist = 4; }
+                        if (v->voxel(x,y+1,z+1) + 4 < val + dist){ val = v->voxel(x,y+1,z+1); dist = 4; }
+                        if (v->voxel(x+1,y+1,z+1) + 5 < val + dist){ val = v->voxel(x+1,y+1,z+1); dist = 5; }
 
-                    if (v->voxel(x-1,y,z-1) + 4  < val + dist){ val = v->voxel(x-1,y,z-1); dist = 4; }
-                    if (v->voxel(x,y-1,z-1) + 4  < val + dist){ val = v->voxel(x,y-1,z-1); dist = 4; }
+                        if (v->voxel(x+1,y,z-1) + 4 < val + dist){ val = v->voxel(x+1,y,z-1); dist = 4; }
+                        if (v->voxel(x,y+1,z-1) + 4 < val + dist){ val = v->voxel(x,y,z-1); dist = 4; }
+                        if (v->voxel(x+1,y+1,z-1)+ 5 < val + dist){ val = v->voxel(x+1,y+1,z-1); dist = 5; }
 
-                    if (v->voxel(x-1,y,z+1) + 4  < val + dist){ val = v->voxel(x-1,y,z+1); dist = 4; }
-                    if (v->voxel(x,y-1,z+1) + 4  < val + dist){ val = v->voxel(x,y-1,z+1); dist = 4; }
+                        if ((val + dist) <  v->voxel(x,y,z)) v->voxel(x,y,z) =  val + dist;
 
+                    }
 
-                    if (v->voxel(x-1,y-1,z+1) + 5 < val + dist){ val = v->voxel(x-1,y-1,z+1); dist = 5; }
-                    if (v->voxel(x-1,y-1,z-1) + 5 < val + dist){ val = v->voxel(x-1,y-1,z-1); dist = 5; }
+        }
 
-                    if (v->voxel(x+1,y-1,z-1) + 5 < val + dist){ val = v->voxel(x+1,y-1,z-1); dist = 5; }
-                    if (v->voxel(x+1,y-1,z+1) + 5 < val + dist){ val = v->voxel(x+1,y-1,z+1); dist = 5; }
+        //border cleaning, it was not transformed by distance mapping, property of the algorithm
+        for (size_t x =0; x< v->getDimensions().x;x++)
+            for (size_t y =0; y< v->getDimensions().y;y++)
+                for (size_t z =0; z< v->getDimensions().z;z++){
+                    if ( (x < 3) || (x > v->getDimensions().x-3) || (y < 3) || (y > v->getDimensions().y-3)
+                            || (z < 3) || (z > v->getDimensions().z-3))
+                       v->voxel(x,y,z) = 65535;
 
-                    v->voxel(x,y,z) = val + dist;
                 }
+        return result;
     }
+};
 
-    for (size_t z=v->getDimensions().z-2; z>2; z--){
-        for (size_t x=v->getDimensions().x-2; x>2; x--)
-            for (size_t y=v->getDimensions().y-2; y>2; y--)
-                if (v->voxel(x,y,z) > 0) {
-                    dist = 0;
-                    val = v->voxel(x,y,z);
+VolumeDistanceTransform::VolumeDistanceTransform()
+    : AsyncVolumeProcessor()
+    , inport_(Port::INPORT, "volumehandle.input")
+    , outport_(Port::OUTPORT, "volumehandle.output", 0)
 
-                    if (v->voxel(x+1,y,z) + 3 < val + dist)          { val = v->voxel(x+1,y,z); dist = 3; }
-                    if (v->voxel(x,y+1,z) + 3 < val + dist)          { val = v->voxel(x,y+1,z); dist = 3; }
-                    if (v->voxel(x+1,y+1,z) + 4 < val + dist)        { val = v->voxel(x+1,y+1,z); dist = 4; }
-                    if (v->voxel(x,y,z+1) + 3  < val + dist)         { val = v->voxel(x,y,z+1); dist = 3; }
+{
+    addPort(inport_);
+    addPort(outport_);
+}
 
-                    if (v->voxel(x-1,y+1,z) + 4 < val + dist){ val = v->voxel(x-1,y+1,z); dist = 4; }
-                    if (v->voxel(x-1,y+1,z+1) + 5 < val + dist){ val = v->voxel(x-1,y+1,z+1); dist = 5; }
-                    if (v->voxel(x-1,y+1,z-1) + 5 < val + dist){ val = v->voxel(x-1,y+1,z-1); dist = 5; }
+VolumeDistanceTransform::~VolumeDistanceTransform() {}
 
-                    if (v->voxel(x+1,y,z+1) + 4 < val + dist){ val = v->voxel(x+1,y,z+1); dist = 4; }
-                    if (v->voxel(x,y+1,z+1) + 4 < val + dist){ val = v->voxel(x,y+1,z+1); dist = 4; }
-                    if (v->voxel(x+1,y+1,z+1) + 5 < val + dist){ val = v->voxel(x+1,y+1,z+1); dist = 5; }
+std::string VolumeDistanceTransform::getCategory() const {
+    return "Volume Processing";
+}
 
-                    if (v->voxel(x+1,y,z-1) + 4 < val + dist){ val = v->voxel(x+1,y,z-1); dist = 4; }
-                    if (v->voxel(x,y+1,z-1) + 4 < val + dist){ val = v->voxel(x,y,z-1); dist = 4; }
-                    if (v->voxel(x+1,y+1,z-1)+ 5 < val + dist){ val = v->voxel(x+1,y+1,z-1); dist = 5; }
+std::string VolumeDistanceTransform::getClassName() const {
+    return "VolumeDistanceTransform";
+}
 
-                    if ((val + dist) <  v->voxel(x,y,z)) v->voxel(x,y,z) =  val + dist;
+Processor::CodeState VolumeDistanceTransform::getCodeState() const {
+    return CODE_STATE_EXPERIMENTAL;
+}
 
-                }
+Processor* VolumeDistanceTransform::create() const {
+    return new VolumeDistanceTransform();
+}
 
-    }
+void VolumeDistanceTransform::process() {
+    if (inport_.hasChanged())
+        startComputation();
+}
 
-    //border cleaning, it was not transformed by distance mapping, property of the algorithm
-    for (size_t x =0; x< v->getDimensions().x;x++)
-        for (size_t y =0; y< v->getDimensions().y;y++)
-            for (size_t z =0; z< v->getDimensions().z;z++){
-                if ( (x < 3) || (x > v->getDimensions().x-3) || (y < 3) || (y > v->getDimensions().y-3)
-                        || (z < 3) || (z > v->getDimensions().z-3))
-                   v->voxel(x,y,z) = 65535;
+AsyncVolumeProcessor::Job* VolumeDistanceTransform::createJob() {
+    tgtAssert(inport_.hasData(), "Inport has not data");
+    return new DistanceTransformJob(inport_.getData());
+}
 
-            }
-    outport_.setData(new VolumeHandle(v, handle));
+void VolumeDistanceTransform::setResult(VolumeHandle* result) {
+    outport_.setData(result);
 }
 
 }   // namespace
@@ -38,7 +38,7 @@ namespace voreen {
 
 class VolumeHandle;
 
-class VolumeDistanceTransform : public CachingVolumeProcessor {
+class VolumeDistanceTransform : public AsyncVolumeProcessor {
 public:
     VolumeDistanceTransform();
     virtual ~VolumeDistanceTransform();
@@ -46,15 +46,18 @@ public:
     virtual std::string getCategory() const;
     virtual std::string getClassName() const;
     virtual Processor::CodeState getCodeState() const;
+    virtual bool usesOpenGL() const { return false; }
     virtual Processor* create() const;
 
 protected:
     virtual void process();
 
-private:
-    void distanceTransform();
+    virtual Job* createJob();
+    virtual void setResult(VolumeHandle* result);
 
 private:
+    class DistanceTransformJob;
+
     VolumePort inport_;
     VolumePort outport_;
 };
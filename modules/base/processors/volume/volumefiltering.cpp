@@ -38,8 +38,30 @@ namespace voreen {
 
 const std::string VolumeFiltering::loggerCat_("voreen.VolumeFiltering");
 
+/// Applies the filtering operator to the input volume in the background.
+class VolumeFiltering::FilteringJob : public AsyncVolumeProcessor::Job {
+public:
+    FilteringJob(const VolumeHandleBase* input, const std::string& filteringOperator, int kernelSize)
+        : filteringOperator_(filteringOperator)
+        , kernelSize_(kernelSize)
+    {
+        addInput(input);
+    }
+
+    virtual VolumeHandle* compute() {
+        if (filteringOperator_ == "median")
+            return VolumeOperatorMedian::APPLY_OP(getInput(0), kernelSize_);
+        else
+            throw VoreenException("Unknown operator: " + filteringOperator_);
+    }
+
+private:
+    std::string filteringOperator_;
+    int kernelSize_;
+};
+
 VolumeFiltering::VolumeFiltering()
-    : CachingVolumeProcessor()
+    : AsyncVolumeProcessor()
     , inport_(Port::INPORT, "volumehandle.input")
     , outport_(Port::OUTPORT, "volumehandle.output", 0)
     , enableProcessing_("enableProcessing", "Enable")
@@ -78,13 +100,28 @@ Processor* VolumeFiltering::create() const {
 
 void VolumeFiltering::process() {
     if (!enableProcessing_.get()) {
+        cancelComputation();
         outport_.setData(const_cast<VolumeHandleBase*>(inport_.getData()), false);
     }
     else if (forceUpdate_ || inport_.hasChanged()) {
-        applyOperator();
+        forceUpdate_ = false;
+        startComputation();
     }
 }
 
+AsyncVolumeProcessor::Job* VolumeFiltering::createJob() {
+    tgtAssert(inport_.hasData(), "Inport has no data");
+
+    if (!inport_.getData()->getRepresentation<Volume>())
+        return 0;
+
+    return new FilteringJob(inport_.getData(), filteringOperator_.get(), kernelSize_.getValue());
+}
+
+void VolumeFiltering::setResult(VolumeHandle* result) {
+    outport_.setData(result);
+}
+
 // private methods
 //
 
@@ -92,33 +129,4 @@ void VolumeFiltering::forceUpdate() {
     forceUpdate_ = true;
 }
 
-void VolumeFiltering::applyOperator() {
-    tgtAssert(inport_.hasData(), "Inport has no data");
-
-    forceUpdate_ = false;
-
-    if (inport_.getData()->getRepresentation<Volume>()) {
-        const VolumeHandleBase* input = inport_.getData();
-        VolumeHandle* transformed = 0; // = input->clone();
-
-        if (filteringOperator_.isSelected("median")) {
-            //volOpMedian.setProgressBar(progressBar_);
-            transformed = VolumeOperatorMedian::APPLY_OP(input, kernelSize_.getValue());
-        }
-        //else if (filteringOperator_.isSelected("erosion")) {
-            //VolumeOperatorErosion volOpErosion(kernelSize_.getValue());
-            //volOpErosion(transformed);
-        //}
-        else {
-            LERROR("Unknown operator: " << filteringOperator_.get());
-        }
-
-        outport_.setData(transformed);
-    }
-    else {
-        outport_.setData(0);
-    }
-}
-
-
 }   // namespace
@@ -35,7 +35,7 @@
 
 namespace voreen {
 
-class VolumeFiltering : public CachingVolumeProcessor {
+class VolumeFiltering : public AsyncVolumeProcessor {
 public:
     VolumeFiltering();
     virtual ~VolumeFiltering();
@@ -44,12 +44,18 @@ public:
     virtual std::string getClassName() const      { return "VolumeFiltering"; }
     virtual std::string getCategory() const       { return "Volume Processing"; }
     virtual CodeState getCodeState() const        { return CODE_STATE_TESTING; }
+    virtual bool usesOpenGL() const               { return false; }
 
 protected:
     virtual void process();
+
+    virtual Job* createJob();
+    virtual void setResult(VolumeHandle* result);
+
 private:
+    class FilteringJob;
+
     void forceUpdate();
-    void applyOperator();
 
     VolumePort inport_;
     VolumePort outport_;
@@ -38,8 +38,32 @@ namespace voreen {
 
 const std::string VolumeMorphology::loggerCat_("voreen.VolumeMorphology");
 
+/// Applies the morphologic operator to the input volume in the background.
+class VolumeMorphology::MorphologyJob : public AsyncVolumeProcessor::Job {
+public:
+    MorphologyJob(const VolumeHandleBase* input, const std::string& morphologicOperator, int kernelSize)
+        : morphologicOperator_(morphologicOperator)
+        , kernelSize_(kernelSize)
+    {
+        addInput(input);
+    }
+
+    virtual VolumeHandle* compute() {
+        if (morphologicOperator_ == "dilation")
+            return VolumeOperatorDilation::APPLY_OP(getInput(0), kernelSize_);
+        else if (morphologicOperator_ == "erosion")
+            return VolumeOperatorErosion::APPLY_OP(getInput(0), kernelSize_);
+        else
+            throw VoreenException("Unknown operator: " + morphologicOperator_);
+    }
+
+private:
+    std::string morphologicOperator_;
+    int kernelSize_;
+};
+
 VolumeMorphology::VolumeMorphology()
-    : CachingVolumeProcessor()
+    : AsyncVolumeProcessor()
     , inport_(Port::INPORT, "volumehandle.input")
     , outport_(Port::OUTPORT, "volumehandle.output", 0)
     , enableProcessing_("enableProcessing", "Enable")
@@ -80,13 +104,28 @@ Processor* VolumeMorphology::create() const {
 
 void VolumeMorphology::process() {
     if (!enableProcessing_.get()) {
+        cancelComputation();
         outport_.setData(const_cast<VolumeHandleBase*>(inport_.getData()), false);
     }
     else if (forceUpdate_ || inport_.hasChanged()) {
-        applyOperator();
+        forceUpdate_ = false;
+        startComputation();
     }
 }
 
+AsyncVolumeProcessor::Job* VolumeMorphology::createJob() {
+    tgtAssert(inport_.hasData(), "Inport has no data");
+
+    if (!inport_.getData()->getRepresentation<Volume>())
+        return 0;
+
+    return new MorphologyJob(inport_.getData(), morphologicOperator_.get(), kernelSize_.getValue());
+}
+
+void VolumeMorphology::setResult(VolumeHandle* result) {
+    outport_.setData(result);
+}
+
 // private methods
 //
 
@@ -94,31 +133,4 @@ void VolumeMorphology::forceUpdate() {
     forceUpdate_ = true;
 }
 
-void VolumeMorphology::applyOperator() {
-    tgtAssert(inport_.hasData(), "Inport has no data");
-
-    forceUpdate_ = false;
-
-    if (inport_.getData()->getRepresentation<Volume>()) {
-        const VolumeHandleBase* input = inport_.getData();
-        VolumeHandle* transformed = 0;
-
-        if (morphologicOperator_.isSelected("dilation")) {
-            //volOpDilation.setProgressBar(progressBar_); //FIXME
-            transformed = VolumeOperatorDilation::APPLY_OP(input, kernelSize_.getValue());
-        }
-        else if (morphologicOperator_.isSelected("erosion")) {
-            //volOpErosion.setProgressBar(progressBar_); //FIXME
-            transformed = VolumeOperatorErosion::APPLY_OP(input, kernelSize_.getValue());
-        }
-        else {
-            LERROR("Unknown operator: " << morphologicOperator_.get());
-        }
-
-        outport_.setData(transformed);
-    }
-    else {
-        outport_.setData(0);
-    }
-}
 }   // namespace
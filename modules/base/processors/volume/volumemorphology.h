@@ -38,7 +38,7 @@ namespace voreen {
 /**
  * Provides the basic morphologic operators dilation and erosion.
  */
-class VolumeMorphology : public CachingVolumeProcessor {
+class VolumeMorphology : public AsyncVolumeProcessor {
 public:
     VolumeMorphology();
     virtual ~VolumeMorphology();
@@ -47,13 +47,18 @@ public:
     virtual std::string getClassName() const      { return "VolumeMorphology"; }
     virtual std::string getCategory() const       { return "Volume Processing"; }
     virtual CodeState getCodeState() const        { return CODE_STATE_STABLE; }
+    virtual bool usesOpenGL() const               { return false; }
 
 protected:
     virtual void process();
 
+    virtual Job* createJob();
+    virtual void setResult(VolumeHandle* result);
+
 private:
+    class MorphologyJob;
+
     void forceUpdate();
-    void applyOperator();
 
     VolumePort inport_;
     VolumePort outport_;
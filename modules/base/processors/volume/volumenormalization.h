@@ -41,6 +41,7 @@ public:
     std::string getClassName() const   { return "VolumeNormalization"; }
     std::string getCategory() const    { return "Volume Processing"; }
     CodeState getCodeState() const     { return CODE_STATE_EXPERIMENTAL; }
+    virtual bool usesOpenGL() const    { return false; }
 
     Processor* create() const          { return new VolumeNormalization; }
 
@@ -28,50 +28,78 @@
 
 #include "volumesave.h"
 #include "voreen/core/io/volumeserializer.h"
-#include "voreen/core/io/volumeserializerpopulator.h"
+#include "voreen/core/io/volumewritejob.h"
+#include "voreen/core/voreenapplication.h"
+
+#include "tgt/event/timeevent.h"
 
 namespace voreen {
 
+const std::string VolumeSave::loggerCat_("voreen.base.VolumeSave");
+
 VolumeSave::VolumeSave()
     : VolumeProcessor(),
     inport_(Port::INPORT, "volumehandle.input", false, Processor::INVALID_RESULT),
     filename_("outputfilename", "File", "Select file...",
              "", "*.dat", FileDialogProperty::SAVE_FILE, Processor::VALID),
+    outputDataType_("outputDataType", "Output Data Type", Processor::VALID),
+    compressed_("compressed", "Compress Data File", false, Processor::VALID),
+    saveInBackground_("saveInBackground", "Save in Background", true, Processor::VALID),
     continousSave_("continousSave", "Save continuously", false, Processor::VALID),
     saveButton_("save", "Save"),
-    volLoadPop_(0),
-    serializer_(0)
+    job_(0),
+    savePending_(false),
+    timer_(0),
+    eventHandler_()
 {
 
     filename_.onChange(CallMemberAction<VolumeSave>(this, &VolumeSave::saveVolume));
     addProperty(filename_);
 
+    outputDataType_.addOption("",       "Unchanged");
+    outputDataType_.addOption("uint8",  "8 Bit Unsigned Integer (uint8)");
+    outputDataType_.addOption("int8",   "8 Bit Signed Integer (int8)");
+    outputDataType_.addOption("uint16", "16 Bit Unsigned Integer (uint16)");
+    outputDataType_.addOption("int16",  "16 Bit Signed Integer (int16)");
+    outputDataType_.addOption("float",  "Float");
+    outputDataType_.addOption("double", "Double");
+    addProperty(outputDataType_);
+
+    addProperty(compressed_);
+    addProperty(saveInBackground_);
     addProperty(continousSave_);
 
     saveButton_.onChange(CallMemberAction<VolumeSave>(this, &VolumeSave::saveVolume));
     addProperty(saveButton_);
 
     addPort(inport_);
+
+    eventHandler_.addListenerToBack(this);
+    if (VoreenApplication::app())
+        timer_ = VoreenApplication::app()->createTimer(&eventHandler_);
 }
 
 VolumeSave::~VolumeSave() {
-    delete volLoadPop_;
-    //serializer will be deleted by populator
+    delete timer_;
+    // the job waits for the running save
+    delete job_;
 }
 
 Processor* VolumeSave::create() const {
     return new VolumeSave();
 }
 
-void VolumeSave::initialize() throw (tgt::Exception) {
-
-    VolumeProcessor::initialize();
-
-    if(!volLoadPop_)
-        volLoadPop_ = new VolumeSerializerPopulator();
-    if(!serializer_)
-        serializer_ = volLoadPop_->getVolumeSerializer();
+void VolumeSave::deinitialize() throw (tgt::Exception) {
+    if (timer_)
+        timer_->stop();
+    // a started save is completed, a pending one discarded
+    savePending_ = false;
+    if (job_) {
+        job_->join();
+        finishSave();
+    }
 
+    VolumeProcessor::deinitialize();
 }
 
 void VolumeSave::process() {
@@ -80,17 +108,82 @@ void VolumeSave::process() {
 }
 
 void VolumeSave::saveVolume() {
-    if(!inport_.getData() || !serializer_ || (filename_.get() == ""))
+    if (!isInitialized() || !inport_.getData() || (filename_.get() == ""))
         return;
 
-    try {
-        serializer_->write(filename_.get(), inport_.getData());
-    } catch(tgt::FileException e) {
-        LERROR(e.what());
-        filename_.set("");
+    // the running save is completed first, since both may write the same file
+    if (job_) {
+        savePending_ = true;
+        return;
+    }
+
+    VolumeWriteJob* job = new VolumeWriteJob();
+    job->setOutputDataType(outputDataType_.get());
+    job->setCompressed(compressed_.get());
+
+    // the volume is copied for the background thread, since the port data may change meanwhile
+    bool background = saveInBackground_.get() && timer_;
+    job->addVolume(filename_.get(), inport_.getData(), background);
+    if (background) {
+        try {
+            job->start();
+            job_ = job;
+            setProgress(0.f);
+            if (timer_->isStopped())
+                timer_->start(50);
+            return;
+        }
+        catch (VoreenException& e) {
+            LWARNING("Failed to start saving in background, saving synchronously: " << e.what());
+        }
+    }
+
+    job->setProgressBar(progressBar_);
+    job->writeVolumes();
+    reportErrors(job->getErrors());
+    delete job;
+}
+
+void VolumeSave::timerEvent(tgt::TimeEvent* e) {
+    if (!job_)
+        timer_->stop();
+    else if (!job_->isFinished())
+        setProgress(job_->getProgress());
+    else
+        finishSave();
+
+    if (e)
+        e->accept();
+}
+
+void VolumeSave::finishSave() {
+    tgtAssert(job_, "no save running");
+
+    VolumeWriteJob* job = job_;
+    job_ = 0;
+    setProgress(1.f);
+    reportErrors(job->getErrors());
+    delete job;
+
+    if (savePending_) {
+        savePending_ = false;
+        saveVolume();
+    }
+    else if (timer_) {
+        timer_->stop();
     }
 }
 
+void VolumeSave::reportErrors(const std::vector<std::string>& errors) {
+    if (errors.empty())
+        return;
+
+    LERROR(errors.front());
+    // no further attempts to write to the file
+    savePending_ = false;
+    filename_.set("");
+}
+
 bool VolumeSave::isEndProcessor() const {
     return true;
 }
@@ -35,13 +35,17 @@
 #include "voreen/core/properties/filedialogproperty.h"
 #include "voreen/core/properties/boolproperty.h"
 #include "voreen/core/properties/buttonproperty.h"
+#include "voreen/core/properties/optionproperty.h"
 
 namespace voreen {
 
-class VolumeHandle;
-class VolumeSerializer;
-class VolumeSerializerPopulator;
+class VolumeWriteJob;
 
+/**
+ * Saves the input volume, by default on a background thread, so that the
+ * network is not blocked while a large volume is written. A save requested
+ * while the previous one is still running is started once it has finished.
+ */
 class VolumeSave : public VolumeProcessor {
 public:
     VolumeSave();
@@ -55,19 +59,35 @@ public:
 
     virtual void saveVolume();
 
+    /// Polls the running save.
+    virtual void timerEvent(tgt::TimeEvent* e);
+
 protected:
     virtual void process();
-    virtual void initialize() throw (tgt::Exception);
+    virtual void deinitialize() throw (tgt::Exception);
 
 private:
+    /// Reports the result of the finished save and starts a pending one.
+    void finishSave();
+
+    /// Logs the first error of a save and resets the file name.
+    void reportErrors(const std::vector<std::string>& errors);
+
     VolumePort inport_;
 
     FileDialogProperty filename_;
+    StringOptionProperty outputDataType_;
+    BoolProperty compressed_;
+    BoolProperty saveInBackground_;
     BoolProperty continousSave_;
     ButtonProperty saveButton_;
 
-    VolumeSerializerPopulator* volLoadPop_;
-    const VolumeSerializer* serializer_;
+    VolumeWriteJob* job_;               ///< currently running save
+    bool savePending_;                  ///< a save has been requested while the job is running
+    tgt::Timer* timer_;                 ///< polls the running save
+    tgt::EventHandler eventHandler_;
+
+    static const std::string loggerCat_;
 };
 
 }   //namespace
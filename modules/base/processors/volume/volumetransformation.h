@@ -47,6 +47,7 @@ public:
     virtual std::string getCategory() const   { return "Volume Processing"; }
     virtual std::string getClassName() const  { return "VolumeTransformation"; }
     virtual CodeState getCodeState() const    { return CODE_STATE_TESTING; }
+    virtual bool usesOpenGL() const           { return false; }
 
 protected:
     virtual void process();
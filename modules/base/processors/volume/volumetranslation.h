@@ -45,6 +45,7 @@ public:
     virtual std::string getCategory() const   { return "Volume Processing"; }
     virtual std::string getClassName() const  { return "VolumeTranslation"; }
     virtual CodeState getCodeState() const    { return CODE_STATE_TESTING; }
+    virtual bool usesOpenGL() const           { return false; }
 
 protected:
     virtual void process();
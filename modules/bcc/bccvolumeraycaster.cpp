@@ -46,6 +46,7 @@ BccVolumeRaycaster::BccVolumeRaycaster()
     // tf properties
     addProperty(transferFunc_);
     addProperty(camera_);
+    classificationMode_.addOption("pre-integrated", "Pre-integrated TF");
     addProperty(classificationMode_);
 
 	// volume formats for the shader
@@ -307,8 +308,11 @@ void BccVolumeRaycaster::process() {
 	if (reconstruction_.isSelected("cwb"))
 		raycastPrg_->setUniform("lambda_", lambdaValue_.get());
 
-	if (classificationMode_.get() == "transfer-function")
+    tgt::TextureUnit preIntegrationUnit;
+    if (!classificationMode_.isSelected("none")) {
         transferFunc_.get()->setUniform(raycastPrg_, "transferFunc_", transferUnit.getUnitNumber());
+        bindPreIntegrationTable(raycastPrg_, transferFunc_.get(), preIntegrationUnit);
+    }
 
 	LGL_ERROR;
 
@@ -463,6 +467,7 @@ void BccVolumeRaycaster::bindVolumes(tgt::Shader* shader, const std::vector<Volu
 
 			shader->setUniform("samplingStepSize_", samplingStepSize);
 			shader->setUniform("samplingRate_", samplingRate);
+			samplingStepSize_ = samplingStepSize;
             
 			LGL_ERROR;
 		}
@@ -47,6 +47,7 @@ FccVolumeRaycaster::FccVolumeRaycaster()
 
     // tf properties
     addProperty(transferFunc_);
+    classificationMode_.addOption("pre-integrated", "Pre-integrated TF");
     addProperty(classificationMode_);
 
 	// camera position property
@@ -273,8 +274,11 @@ void FccVolumeRaycaster::process() {
         compositingMode2_.get() == "iso")
         raycastPrg_->setUniform("isoValue_", isoValue_.get());
 
-	if (classificationMode_.get() == "transfer-function")
+    tgt::TextureUnit preIntegrationUnit;
+    if (!classificationMode_.isSelected("none")) {
         transferFunc_.get()->setUniform(raycastPrg_, "transferFunc_", transferUnit.getUnitNumber());
+        bindPreIntegrationTable(raycastPrg_, transferFunc_.get(), preIntegrationUnit);
+    }
 
 	LGL_ERROR;
 
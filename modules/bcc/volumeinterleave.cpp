@@ -8,8 +8,49 @@ namespace voreen {
 
 const std::string VolumeInterleave::loggerCat_("voreen.VolumeInterleave");
 
+/// Combines the gradient and intensity volumes in the background.
+class VolumeInterleave::InterleaveJob : public AsyncVolumeProcessor::Job {
+public:
+    InterleaveJob(const VolumeHandleBase* gradients, const VolumeHandleBase* intensities) {
+        addInput(gradients);
+        addInput(intensities);
+    }
+
+    virtual VolumeHandle* compute() {
+        const VolumeAtomic<tgt::Vector3<uint16_t> >* inputGradient =
+            static_cast<const VolumeAtomic<tgt::Vector3<uint16_t> >*>(getInput(0)->getRepresentation<Volume>());
+        const VolumeAtomic<uint16_t>* inputIntensity =
+            static_cast<const VolumeAtomic<uint16_t>*>(getInput(1)->getRepresentation<Volume>());
+
+        VolumeAtomic<tgt::Vector4<uint16_t> >* output = new VolumeAtomic<tgt::Vector4<uint16_t> >(inputIntensity->getDimensions());
+
+        tgt::ivec3 pos;
+        tgt::ivec3 dim = inputIntensity->getDimensions();
+
+        for (pos.z = 0; pos.z < dim.z; ++pos.z) {
+            if (isInterrupted()) {
+                delete output;
+                return 0;
+            }
+            setProgress(static_cast<float>(pos.z) / static_cast<float>(dim.z));
+
+            for (pos.y = 0; pos.y < dim.y; ++pos.y) {
+                for (pos.x = 0; pos.x < dim.x; ++pos.x) {
+                    tgt::Vector3<uint16_t> gradient  = inputGradient->voxel(pos);
+                    uint16_t               intensity = inputIntensity->voxel(pos);
+
+                    output->voxel(pos) = tgt::Vector4<uint16_t>(gradient.x, gradient.y, gradient.z, intensity);
+                }
+            }
+        }
+        setProgress(1.f);
+
+        return new VolumeHandle(output, getInput(0));
+    }
+};
+
 VolumeInterleave::VolumeInterleave()
-    : CachingVolumeProcessor()
+    : AsyncVolumeProcessor()
     , inport1_(Port::INPORT, "volumehandle.input1")
     , inport2_(Port::INPORT, "volumehandle.input2")
     , outport_(Port::OUTPORT, "volumehandle.output", 0)
@@ -30,7 +71,8 @@ Processor* VolumeInterleave::create() const {
 
 void VolumeInterleave::process() {
 	if (forceUpdate_ || inport1_.hasChanged() || inport2_.hasChanged()) {
-        applyOperator();
+        forceUpdate_ = false;
+        startComputation();
     }
 }
 
@@ -38,68 +80,35 @@ void VolumeInterleave::forceUpdate() {
     forceUpdate_ = true;
 }
 
-void VolumeInterleave::applyOperator() {
-    const VolumeHandleBase* inputHandle1 = inport1_.getData();
-    const VolumeHandleBase* inputHandle2 = inport2_.getData();
-    const Volume* inputVolume1 = inputHandle1->getRepresentation<Volume>();
-    const Volume* inputVolume2 = inputHandle2->getRepresentation<Volume>();
-    VolumeHandle* outputVolume = 0;
-
-    forceUpdate_ = false;
+AsyncVolumeProcessor::Job* VolumeInterleave::createJob() {
+    const Volume* inputVolume1 = inport1_.getData()->getRepresentation<Volume>();
+    const Volume* inputVolume2 = inport2_.getData()->getRepresentation<Volume>();
 
     if (inputVolume1->getNumChannels() != 3) {
 		LERROR("Input volume 1 does not have 3, but " << inputVolume1->getNumChannels() << " channels.");
-		return;
+		return 0;
 	}
 
 	if (inputVolume2->getNumChannels() != 1) {
 		LERROR("Input volume 2 does not have 1, but " << inputVolume1->getNumChannels() << " channels.");
-		return;
+		return 0;
 	}
 
 	if (inputVolume1->getDimensions() != inputVolume2->getDimensions()) {
 		LERROR("Input volume 1 and 2 have different size.");
-		return;
+		return 0;
 	}
 
-    bool bit16 = inputVolume1->getBitsAllocated() > 8;
-
-    if (bit16) {
-
-		const VolumeAtomic<tgt::Vector3<uint16_t> >* inputGradient = static_cast<const VolumeAtomic<tgt::Vector3<uint16_t> > *>(inputVolume1);
-		const VolumeAtomic<uint16_t> *inputIntensity = static_cast<const VolumeAtomic<uint16_t> *>(inputVolume2);
-
-		VolumeAtomic<tgt::Vector4<uint16_t> >* output = new VolumeAtomic<tgt::Vector4<uint16_t> >(inputIntensity->getDimensions());
-
-		tgt::ivec3 pos;
-	    tgt::ivec3 dim = inputIntensity->getDimensions();
-
-       for (pos.z = 0; pos.z < dim.z; ++pos.z) {
-			if (progressBar_)
-	            progressBar_->setProgress(static_cast<float>(pos.z) / static_cast<float>(dim.z));
-
-            for (pos.y = 0; pos.y < dim.y; ++pos.y) {
-                for (pos.x = 0; pos.x < dim.x; ++pos.x) {
-					tgt::Vector3<uint16_t> gradient  = inputGradient->voxel(pos);
-					uint16_t               intensity = inputIntensity->voxel(pos);
-
-					output->voxel(pos) = tgt::Vector4<uint16_t>(gradient.x, gradient.y, gradient.z, intensity);
-                }
-            }
-        }
-
-		if (progressBar_)
-			progressBar_->setProgress(1.0f);
-
-		outputVolume = new VolumeHandle(output, inputHandle1);
-		
-	}
-    else {
+    if (inputVolume1->getBitsAllocated() <= 8) {
         LERROR("Unknown technique");
-		return;
+        return 0;
     }
 
-    outport_.setData(outputVolume);
+    return new InterleaveJob(inport1_.getData(), inport2_.getData());
+}
+
+void VolumeInterleave::setResult(VolumeHandle* result) {
+    outport_.setData(result);
 }
 
 }
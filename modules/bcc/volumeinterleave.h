@@ -10,7 +10,7 @@ namespace voreen {
 
 class VolumeHandle;
 
-class VolumeInterleave : public CachingVolumeProcessor {
+class VolumeInterleave : public AsyncVolumeProcessor {
 public:
     VolumeInterleave();
     virtual ~VolumeInterleave();
@@ -23,8 +23,12 @@ public:
 protected:
     virtual void process();
 
+    virtual Job* createJob();
+    virtual void setResult(VolumeHandle* result);
+
 private:
-	void applyOperator();
+    class InterleaveJob;
+
     void forceUpdate();
 
     VolumePort inport1_;
@@ -66,6 +66,7 @@
 #include <dcmtk/dcmdata/dcdicdir.h>
 #include <dcmtk/dcmdata/dcdict.h>
 #include <dcmtk/dcmdata/dcrledrg.h>
+#include <dcmtk/dcmdata/dcistrmb.h>
 
 #include <dcmtk/dcmjpeg/djdecode.h>    /* for dcmjpeg decoders */
 #include <dcmtk/dcmjpeg/dipijpeg.h>    /* for dcmimage JPEG plugin */
@@ -116,6 +117,13 @@
 #include <map>
 #include <algorithm>
 #include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <sys/stat.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 using std::string;
 using std::vector;
@@ -170,6 +178,17 @@ void DcmtkVolumeReader::setSecurityOptions(const DcmtkSecurityOptions& security)
 }
 
 int DcmtkVolumeReader::loadSlice(const std::string& fileName, size_t posScalar) {
+    std::string error;
+    if (!decodeSlice(fileName, &scalars_[posScalar * bytesPerVoxel_], error)) {
+        LERROR(error);
+        return 0;
+    }
+
+    // Return number of voxels rendered
+    return dx_ * dy_;
+}
+
+bool DcmtkVolumeReader::decodeSlice(const std::string& fileName, uint8_t* dest, std::string& error) const {
 
     DcmFileFormat fileformat;
     DcmDataset *dataset;  // Pixel data might be compressed
@@ -177,8 +196,8 @@ int DcmtkVolumeReader::loadSlice(const std::string& fileName, size_t posScalar)
     OFCondition status = fileformat.loadFile(fileName.c_str(), EXS_Unknown,
                                              EGL_withoutGL, DCM_MaxReadLength, ERM_autoDetect);
     if (status.bad()) {
-        LERROR("Error loading file " << fileName << ": " << status.text());
-        return 0;
+        error = "Error loading file " + fileName + ": " + status.text();
+        return false;
     }
 
     dataset = fileformat.getDataset();
@@ -196,21 +215,20 @@ int DcmtkVolumeReader::loadSlice(const std::string& fileName, size_t posScalar)
     }
 
     if (image.getStatus() != EIS_Normal) {
-        LERROR("Error creating DicomImage from file " << fileName << ": "
-               << image.getString(image.getStatus()));
-        return 0;
+        error = "Error creating DicomImage from file " + fileName + ": " + image.getString(image.getStatus());
+        return false;
     }
 
     // Render pixel data into scalar array
-    if (!image.getOutputData(&scalars_[posScalar * bytesPerVoxel_], dx_ * dy_ * bytesPerVoxel_, bitsStored_)) {
-        LERROR("Failed to render pixel data "
-               << image.getOutputDataSize(bitsStored_) << " vs. " << dx_ * dy_ * bytesPerVoxel_);
-
-        return 0;
+    if (!image.getOutputData(dest, dx_ * dy_ * bytesPerVoxel_, bitsStored_)) {
+        std::ostringstream message;
+        message << "Failed to render pixel data of file " << fileName << ": "
+                << image.getOutputDataSize(bitsStored_) << " vs. " << dx_ * dy_ * bytesPerVoxel_;
+        error = message.str();
+        return false;
     }
 
-    // Return number of voxels rendered
-    return dx_ * dy_;
+    return true;
 }
 
 
@@ -234,21 +252,21 @@ string getItemString(DcmItem* item, const DcmTagKey &tagKey) {
 /*
  * Sorts strings according to the x value of an vec3
  */
-bool slices_cmp_x(std::pair<string, tgt::vec3> a, std::pair<string, tgt::vec3> b) { //slow
+bool slices_cmp_x(const std::pair<string, tgt::vec3>& a, const std::pair<string, tgt::vec3>& b) {
    return a.second.x < b.second.x;
 }
 
 /*
  * Sorts strings according to the y value of an vec3
  */
-bool slices_cmp_y(std::pair<string, tgt::vec3> a, std::pair<string, tgt::vec3> b) { //slow
+bool slices_cmp_y(const std::pair<string, tgt::vec3>& a, const std::pair<string, tgt::vec3>& b) {
    return a.second.y < b.second.y;
 }
 
 /*
  * Sorts strings according to the z value of an vec3
  */
-bool slices_cmp_z(std::pair<string, tgt::vec3> a, std::pair<string, tgt::vec3> b) { //slow
+bool slices_cmp_z(const std::pair<string, tgt::vec3>& a, const std::pair<string, tgt::vec3>& b) {
    return a.second.z < b.second.z;
 }
 
@@ -257,6 +275,154 @@ char mytolower(char c) {
     return std::tolower(static_cast<unsigned char>(c));
 }
 
+/*
+ * DCMTK only locks its data dictionary and codec registry, if it has been built
+ * with thread support. Otherwise the files are read by a single thread.
+ */
+#ifdef WITH_THREADS
+const bool DCMTK_THREAD_SAFE = true;
+#else
+const bool DCMTK_THREAD_SAFE = false;
+#endif
+
+/*
+ * Returns whether all header tags needed for sorting a slice have been parsed, i.e., whether
+ * the dataset contains an element following the last of them, BitsStored (0028,0101).
+ */
+bool isHeaderComplete(DcmDataset* dataset) {
+    unsigned long numElements = dataset->card();
+    if (numElements == 0)
+        return false;
+    DcmObject* last = dataset->getElement(numElements - 1);
+    return (last && last->getTag() > DCM_BitsStored);
+}
+
+/*
+ * Parses the meta header and the dataset of a Dicom file up to the tags needed for listing
+ * and sorting it, but not the pixel data following them. The file is fed to the parser in
+ * chunks, which is considerably faster than DcmFileFormat::loadFile() on network shares,
+ * since the pixel data of compressed transfer syntaxes is neither read nor parsed.
+ */
+bool loadDicomHeader(const string& fileName, DcmFileFormat& fileformat, string& error) {
+    std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+    if (!file) {
+        error = "Unable to open file";
+        return false;
+    }
+
+    const std::streamsize chunkSize = 16384;
+    std::vector<char> buffer(static_cast<size_t>(chunkSize));
+    DcmInputBufferStream stream;
+    fileformat.transferInit();
+    OFCondition status = EC_StreamNotifyClient;
+    while (status == EC_StreamNotifyClient) {
+        file.read(&buffer[0], chunkSize);
+        std::streamsize count = file.gcount();
+        if (count > 0)
+            stream.setBuffer(&buffer[0], static_cast<Uint32>(count));
+        if (!file)
+            stream.setEos();
+
+        status = fileformat.read(stream, EXS_Unknown, EGL_noChange, DCM_MaxReadLength);
+        stream.releaseBuffer();
+
+        // the remaining elements are not needed
+        if (status == EC_StreamNotifyClient && isHeaderComplete(fileformat.getDataset()))
+            status = EC_Normal;
+    }
+    fileformat.transferEnd();
+
+    if (status.bad() && !isHeaderComplete(fileformat.getDataset())) {
+        error = status.text();
+        return false;
+    }
+    return true;
+}
+
+string getOptionalString(DcmItem* item, const DcmTagKey& tagKey) {
+    OFString s;
+    return (item->findAndGetOFString(tagKey, s).good() ? string(s.c_str()) : string());
+}
+
+/*
+ * Header tags of a slice, read by the sorting pass.
+ */
+struct SliceHeader {
+    bool loaded_;
+    string error_;
+
+    string studyInstanceUID_;
+    string seriesInstanceUID_;
+    string studyDescription_;
+    string seriesDescription_;
+    string modality_;
+
+    bool hasPosition_;
+    tgt::vec3 imagePositionPatient_;
+
+    int rows_;                  ///< -1, if not present
+    int columns_;
+    int bitsStored_;
+    int samplesPerPixel_;
+
+    string rowSpacing_;         ///< empty, if PixelSpacing is not present
+    string colSpacing_;
+
+    SliceHeader()
+        : loaded_(false)
+        , hasPosition_(false)
+        , rows_(-1)
+        , columns_(-1)
+        , bitsStored_(-1)
+        , samplesPerPixel_(-1)
+    {}
+};
+
+int getOptionalInt(DcmItem* item, const DcmTagKey& tagKey) {
+    OFString s;
+    return (item->findAndGetOFStringArray(tagKey, s).good() ? atoi(s.c_str()) : -1);
+}
+
+void readSliceHeader(const string& fileName, SliceHeader& header) {
+    DcmFileFormat fileformat;
+    if (!loadDicomHeader(fileName, fileformat, header.error_))
+        return;
+    DcmDataset* dataset = fileformat.getDataset();
+    header.loaded_ = true;
+
+    header.studyInstanceUID_ = getOptionalString(dataset, DCM_StudyInstanceUID);
+    header.seriesInstanceUID_ = getOptionalString(dataset, DCM_SeriesInstanceUID);
+    header.studyDescription_ = getOptionalString(dataset, DCM_StudyDescription);
+    header.seriesDescription_ = getOptionalString(dataset, DCM_SeriesDescription);
+    header.modality_ = getOptionalString(dataset, DCM_Modality);
+
+    OFString tmpStrPosX;
+    OFString tmpStrPosY;
+    OFString tmpStrPosZ;
+    if (dataset->findAndGetOFString(DCM_ImagePositionPatient, tmpStrPosX, 0).good() &&
+        dataset->findAndGetOFString(DCM_ImagePositionPatient, tmpStrPosY, 1).good() &&
+        dataset->findAndGetOFString(DCM_ImagePositionPatient, tmpStrPosZ, 2).good())
+    {
+        header.hasPosition_ = true;
+        header.imagePositionPatient_.x = static_cast<float>(atof(tmpStrPosX.c_str()));
+        header.imagePositionPatient_.y = static_cast<float>(atof(tmpStrPosY.c_str()));
+        header.imagePositionPatient_.z = static_cast<float>(atof(tmpStrPosZ.c_str()));
+    }
+
+    header.rows_ = getOptionalInt(dataset, DCM_Rows);
+    header.columns_ = getOptionalInt(dataset, DCM_Columns);
+    header.bitsStored_ = getOptionalInt(dataset, DCM_BitsStored);
+    header.samplesPerPixel_ = getOptionalInt(dataset, DCM_SamplesPerPixel);
+
+    OFString rowspacing_str, colspacing_str;
+    if (dataset->findAndGetOFString(DCM_PixelSpacing, rowspacing_str, 0).good() &&
+        dataset->findAndGetOFString(DCM_PixelSpacing, colspacing_str, 1).good())
+    {
+        header.rowSpacing_ = rowspacing_str.c_str();
+        header.colSpacing_ = colspacing_str.c_str();
+    }
+}
+
 } // namespace
 
 
@@ -282,48 +448,58 @@ VolumeHandle* DcmtkVolumeReader::readDicomFiles(const vector<string> &fileNames,
     if (!filter.empty())
         LINFO("Filter for SeriesInstanceUID set to: " << filter);
 
-    // First read metadata from all files.
+    // First read the header tags from all files, in parallel, since the time needed for opening
+    // a file outweighs the parsing effort. The pixel data is not read yet.
     // This might be suboptimal when it is already clear which files belong to a certain series
     // (i.e. from DICOMDIR). There it might be better to read metadata and slice data at the
     // same time.
-    bool found_first = false;
-    vector<string>::const_iterator it_files = fileNames.begin();
-    int i = 0;
-    if (getProgressBar() && !fileNames.empty())
+    if (getProgressBar() && !fileNames.empty()) {
         getProgressBar()->setTitle("Loading DICOM Data Set");
+        getProgressBar()->setMessage("Reading slice headers ...");
+    }
 
-    while (it_files != fileNames.end()) {
-        if (getProgressBar()) {
-            getProgressBar()->setMessage("Reading slice '" + tgt::FileSystem::fileName(*it_files) + "' ...");
-            getProgressBar()->setProgress(static_cast<float>(i) / static_cast<float>(fileNames.size()));
-        }
-        i++;
-
-        DcmFileFormat fileformat;
+    const int numFiles = static_cast<int>(fileNames.size());
+    vector<SliceHeader> headers(fileNames.size());
+    int numHeadersRead = 0;
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic) if(DCMTK_THREAD_SAFE)
+    #endif
+    for (int i = 0; i < numFiles; ++i) {
+        readSliceHeader(fileNames[i], headers[i]);
+
+        #ifdef _OPENMP
+        #pragma omp atomic
+        #endif
+        numHeadersRead++;
+#ifdef _OPENMP
+        // progress bars may only be updated from the calling thread
+        if (omp_get_thread_num() == 0)
+#endif
+        if (getProgressBar())
+            getProgressBar()->setProgress(static_cast<float>(numHeadersRead) / static_cast<float>(numFiles));
+    }
 
-        OFCondition status = fileformat.loadFile((*it_files).c_str());
-        if (status.bad()) {
+    bool found_first = false;
+    string lastFile;
+    for (size_t i = 0; i < fileNames.size(); ++i) {
+        const SliceHeader& header = headers[i];
+        if (!header.loaded_) {
             if (skipBroken) {
                 // File might be a broken DICOM but probably it is just some other non-DICOM file
                 // lying around in the directory, so just skip it.
-                LINFO("Skipping file " << (*it_files) << ": " << status.text());
-                it_files++;
+                LINFO("Skipping file " << fileNames[i] << ": " << header.error_);
                 continue;
             } else {
-                LERROR("Error loading file " << (*it_files) << ": " << status.text());
+                LERROR("Error loading file " << fileNames[i] << ": " << header.error_);
                 return 0;
             }
         }
 
-        DcmDataset *dataset = fileformat.getDataset();
-
-        OFString tmpString;
-        if (dataset->findAndGetOFString(DCM_StudyInstanceUID, tmpString).bad())
-            LERROR("no StudyInstanceUID in file " << (*it_files));
-        string studyInstanceUID(tmpString.c_str());
-        if (dataset->findAndGetOFString(DCM_SeriesInstanceUID, tmpString).bad())
-            LERROR("no SeriesInstanceUID in file " << (*it_files));
-        string seriesInstanceUID(tmpString.c_str());
+        if (header.studyInstanceUID_.empty())
+            LERROR("no StudyInstanceUID in file " << fileNames[i]);
+        if (header.seriesInstanceUID_.empty())
+            LERROR("no SeriesInstanceUID in file " << fileNames[i]);
+        const string& seriesInstanceUID = header.seriesInstanceUID_;
 
         // First file with matching series UID
         if (!found_first) {
@@ -336,40 +512,34 @@ VolumeHandle* DcmtkVolumeReader::readDicomFiles(const vector<string> &fileNames,
 
             if (seriesInstanceUID == filter) {
                 found_first = true;
-                LINFO("    Study Description : " << getItemString(dataset, DCM_StudyDescription));
-                LINFO("    Series Description : " << getItemString(dataset, DCM_SeriesDescription));
-                std::string mod = getItemString(dataset, DCM_Modality);
+                LINFO("    Study Description : " << header.studyDescription_);
+                LINFO("    Series Description : " << header.seriesDescription_);
+                std::string mod = header.modality_;
                 LINFO("    Modality : " << mod);
                 std::transform(mod.begin(), mod.end(), mod.begin(), mytolower);
                 modality_ = Modality(mod);
 
-                if (dataset->findAndGetOFStringArray(DCM_Rows, tmpString).good()) {
-                    dy_ = atoi(tmpString.c_str());
-                } else {
-                    LERROR("Can't retrieve DCM_Rows from file " << (*it_files));
+                dy_ = header.rows_;
+                if (dy_ < 0) {
+                    LERROR("Can't retrieve DCM_Rows from file " << fileNames[i]);
                     dy_ = 0;
                     found_first = false;
                 }
-                if (dataset->findAndGetOFStringArray(DCM_Columns, tmpString).good()) {
-                    dx_ = atoi(tmpString.c_str());
-                } else {
-                    LERROR("Can't retrieve DCM_Columns from file " << (*it_files));
+                dx_ = header.columns_;
+                if (dx_ < 0) {
+                    LERROR("Can't retrieve DCM_Columns from file " << fileNames[i]);
                     dx_ = 0;
                     found_first = false;
                 }
-                if (dataset->findAndGetOFStringArray(DCM_BitsStored, tmpString).good()) {
-                    bitsStored_ = atoi(tmpString.c_str());
-                }
-                else {
-                    LERROR("Can't retrieve DCM_BitsStored from file " << (*it_files));
+                bitsStored_ = header.bitsStored_;
+                if (bitsStored_ < 0) {
+                    LERROR("Can't retrieve DCM_BitsStored from file " << fileNames[i]);
                     bitsStored_ = 16;//TODO
                     found_first = false;
                 }
-                if (dataset->findAndGetOFStringArray(DCM_SamplesPerPixel, tmpString).good()) {
-                    samplesPerPixel_ = atoi(tmpString.c_str());
-                }
-                else {
-                    LERROR("Can't retrieve DCM_SamplesPerPixel from file " << (*it_files));
+                samplesPerPixel_ = header.samplesPerPixel_;
+                if (samplesPerPixel_ < 0) {
+                    LERROR("Can't retrieve DCM_SamplesPerPixel from file " << fileNames[i]);
                     samplesPerPixel_ = 1;
                     found_first = false;
                 }
@@ -377,57 +547,28 @@ VolumeHandle* DcmtkVolumeReader::readDicomFiles(const vector<string> &fileNames,
                 LINFO("    Size: " << dx_ << "x" << dy_ << ", " << bitsStored_*samplesPerPixel_ << " bits");
 
                 // Extract PixelSpacing
-                OFString rowspacing_str, colspacing_str;
-                if (dataset->findAndGetOFString(DCM_PixelSpacing, rowspacing_str, 0).good() &&
-                    dataset->findAndGetOFString(DCM_PixelSpacing, colspacing_str, 1).good()) {
-                    LINFO("    PixelSpacing: (" << rowspacing_str << "; " << colspacing_str << ")");
-                    if (rowspacing_str != colspacing_str)
-                        LWARNING("row-spacing != colspacing: " << rowspacing_str << " vs. " << colspacing_str);
-
-                    rowspacing = static_cast<float>(atof(rowspacing_str.c_str()));
-                    colspacing = static_cast<float>(atof(colspacing_str.c_str()));
+                if (!header.rowSpacing_.empty()) {
+                    LINFO("    PixelSpacing: (" << header.rowSpacing_ << "; " << header.colSpacing_ << ")");
+                    if (header.rowSpacing_ != header.colSpacing_)
+                        LWARNING("row-spacing != colspacing: " << header.rowSpacing_ << " vs. " << header.colSpacing_);
+
+                    rowspacing = static_cast<float>(atof(header.rowSpacing_.c_str()));
+                    colspacing = static_cast<float>(atof(header.colSpacing_.c_str()));
                 }
             }
         }
 
         // Matching series UID?
         if (seriesInstanceUID == filter) {
-            OFString tmpStrPosX;
-            OFString tmpStrPosY;
-            OFString tmpStrPosZ;
-            tgt::vec3 imagePositionPatient;
-            OFString imageType;
             // Position is given by z-component of ImagePositionPatient
-            if (dataset->findAndGetOFString(DCM_ImagePositionPatient, tmpStrPosX, 0).good() &&
-                dataset->findAndGetOFString(DCM_ImagePositionPatient, tmpStrPosY, 1).good() &&
-                dataset->findAndGetOFString(DCM_ImagePositionPatient, tmpStrPosZ, 2).good())
-            {
-                imagePositionPatient.x = static_cast<float>(atof(tmpStrPosX.c_str()));
-                imagePositionPatient.y = static_cast<float>(atof(tmpStrPosY.c_str()));
-                imagePositionPatient.z = static_cast<float>(atof(tmpStrPosZ.c_str()));
-            }
-            else {
-                LERROR("Can't retrieve DCM_ImagePositionPatient from file " << (*it_files));
-            }
-/* //TODO: necessary for some US(?) datasets
-            if (dataset->findAndGetOFString(DCM_ImageType, imageType, 3).good()) {
-                LINFO("Image type: " << imageType);
-            }
-            else {
-                LERROR("Can't retrieve DCM_ImageType from file " << (*it_files));
-                imageType = "M";
-            }
-            if (imageType == "M") {
-                LINFO("Add image to stack.");
-                slices.push_back(make_pair(*it_files, imagePositionPatient));
-            }
-*/
-            slices.push_back(make_pair(*it_files, imagePositionPatient));
+            if (!header.hasPosition_)
+                LERROR("Can't retrieve DCM_ImagePositionPatient from file " << fileNames[i]);
+            slices.push_back(make_pair(fileNames[i], header.imagePositionPatient_));
         }
         else {
-            LDEBUG("  File " << (*it_files) << " has different SeriesInstanceUID - skipping");
+            LDEBUG("  File " << fileNames[i] << " has different SeriesInstanceUID - skipping");
         }
-        it_files++;
+        lastFile = fileNames[i];
     }
 
     if (slices.size() == 0)
@@ -471,7 +612,7 @@ VolumeHandle* DcmtkVolumeReader::readDicomFiles(const vector<string> &fileNames,
         case 24: bytesPerVoxel_ = 3; break;
         case 32: bytesPerVoxel_ = 4; break;
         default:
-            throw tgt::CorruptedFileException("Unknown bit depth", *it_files);
+            throw tgt::CorruptedFileException("Unknown bit depth", lastFile);
     }
     // casts needed to handle files > 4 GB
     scalars_ = new uint8_t[(size_t)dx_ * (size_t)dy_ * (size_t)dz_ * (size_t)bytesPerVoxel_];
@@ -488,19 +629,35 @@ VolumeHandle* DcmtkVolumeReader::readDicomFiles(const vector<string> &fileNames,
     LINFO("Building volume...");
     LINFO("Reading slice data from " << slices.size() << " files...");
 
-    size_t posScalar = 0;
-    std::vector<std::pair<string, tgt::vec3> >::iterator it_slices = slices.begin();
-    i = 0;
-    while (it_slices != slices.end()) {
-        if (getProgressBar()) {
-            getProgressBar()->setMessage("Loading slice '" + tgt::FileSystem::fileName((*it_slices).first) + "' ...");
-            getProgressBar()->setProgress(static_cast<float>(i) / static_cast<float>(slices.size()));
-        }
-        i++;
-
-        int slicesize = loadSlice((*it_slices).first, posScalar);
-        posScalar += slicesize;
-        it_slices++;
+    // Decode the slices concurrently, each into its own section of the volume,
+    // if DCMTK has been built with thread support.
+    if (getProgressBar())
+        getProgressBar()->setMessage("Loading slices ...");
+    const size_t sliceSize = static_cast<size_t>(dx_) * static_cast<size_t>(dy_) * static_cast<size_t>(bytesPerVoxel_);
+    vector<string> errors(slices.size());
+    int numSlicesLoaded = 0;
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic) if(DCMTK_THREAD_SAFE)
+    #endif
+    for (int i = 0; i < dz_; ++i) {
+        uint8_t* slice = &scalars_[static_cast<size_t>(i) * sliceSize];
+        if (!decodeSlice(slices[i].first, slice, errors[i]))
+            memset(slice, 0, sliceSize);
+
+        #ifdef _OPENMP
+        #pragma omp atomic
+        #endif
+        numSlicesLoaded++;
+#ifdef _OPENMP
+        // progress bars may only be updated from the calling thread
+        if (omp_get_thread_num() == 0)
+#endif
+        if (getProgressBar())
+            getProgressBar()->setProgress(static_cast<float>(numSlicesLoaded) / static_cast<float>(dz_));
+    }
+    for (size_t i = 0; i < errors.size(); ++i) {
+        if (!errors[i].empty())
+            LERROR(errors[i]);
     }
     if (getProgressBar())
         getProgressBar()->hide();
@@ -581,67 +738,135 @@ vector<string> DcmtkVolumeReader::getFileNamesInDir(const string& dirName) {
 }
 
 
-VolumeHandle* DcmtkVolumeReader::readDICOMDIR(const string &fileName,
-                                        const string &filterSeriesInstanceUID)
-{
+namespace {
+
+void extractString(DcmDirectoryRecord* record, const DcmTagKey& field, std::string& output) {
+    OFString tmpString;
+    if (record->findAndGetOFString(field, tmpString).good())
+        output = tmpString.c_str();
+}
+
+/*
+ * A series listed by a DICOMDIR file, along with the files of its images.
+ */
+struct DicomDirSeries {
+    DcmtkSeriesInfo info_;
+    vector<string> files_;
+};
+
+struct DicomDirScan {
+    time_t modificationTime_;
+    off_t size_;
+    vector<DicomDirSeries> series_;
+};
+
+/*
+ * Returns the series listed by a DICOMDIR file. Scans are cached until the file is modified,
+ * since listing the series of a volume URL and loading one of them parse the same DICOMDIR.
+ */
+vector<DicomDirSeries> scanDicomDir(const string& fileName) {
+    static std::map<string, DicomDirScan> cache;
+
+    struct stat st;
+    bool exists = (stat(fileName.c_str(), &st) == 0);
+    std::map<string, DicomDirScan>::const_iterator cached = cache.find(fileName);
+    if (exists && cached != cache.end() && cached->second.modificationTime_ == st.st_mtime
+        && cached->second.size_ == st.st_size)
+    {
+        return cached->second.series_;
+    }
+
     //FIXME: Need real OS-independent function here
     string dir = string(fileName).substr(0, string(fileName).length() - string("DICOMDIR").length());
-    vector<string> files;
-
-    OFCondition status;
 
+    DicomDirScan scan;
     DcmDicomDir dicomdir(fileName.c_str());
     DcmDirectoryRecord* root = &(dicomdir.getRootRecord());
     DcmDirectoryRecord* PatientRecord = NULL;
     DcmDirectoryRecord* StudyRecord = NULL;
     DcmDirectoryRecord* SeriesRecord = NULL;
-    DcmDirectoryRecord* FileRecord = NULL;
+    DcmDirectoryRecord* ImageRecord = NULL;
     OFString tmpString;
+    voreen::DcmtkSeriesInfo tmp;
 
-    // Analyze DICOMDIR
+    // Analyze DICOMDIR:
     while ((PatientRecord = root->nextSub(PatientRecord)) != NULL) {
+        // patient level
+        tmp = voreen::DcmtkSeriesInfo();
 #if defined(VRN_DCMTK_VERSION_354)
-        LINFO("Patient Name : " << getItemString(PatientRecord, DCM_PatientsName));
+        extractString(PatientRecord, DCM_PatientsName, tmp.patientsName_);
 #else
-        LINFO("Patient Name : " << getItemString(PatientRecord, DCM_PatientName));
-#endif           
+        extractString(PatientRecord, DCM_PatientName, tmp.patientsName_);
+#endif
+        extractString(PatientRecord, DCM_PatientID, tmp.patientId_);
+
         while ((StudyRecord = PatientRecord->nextSub(StudyRecord)) != NULL) {
-            LINFO("  Study, UID : " << getItemString(StudyRecord, DCM_StudyInstanceUID));
-            LINFO("    Study Description : " << getItemString(StudyRecord, DCM_StudyDescription));
+            // study level
+            extractString(StudyRecord, DCM_StudyDate, tmp.studyDate_);
+            extractString(StudyRecord, DCM_StudyTime, tmp.studyTime_);
+            extractString(StudyRecord, DCM_Modality, tmp.modality_);
 
-            // Read all series and filter according to SeriesInstanceUID
             while ((SeriesRecord = StudyRecord->nextSub(SeriesRecord)) != NULL) {
-                string seriesUID = getItemString(SeriesRecord, DCM_SeriesInstanceUID);
-
-                if (!filterSeriesInstanceUID.empty() && seriesUID != filterSeriesInstanceUID)
-                    continue;
-
-                LINFO("    Series, Instance UID : " << seriesUID);
-                LINFO("      Series Description : " << getItemString(SeriesRecord, DCM_SeriesDescription));
-                LINFO("      Modality : " << getItemString(SeriesRecord, DCM_Modality));
-
-                while ((FileRecord = SeriesRecord->nextSub(FileRecord)) != NULL) {
-                    char *referencedFileID=NULL;
-                    if (FileRecord->findAndGetOFStringArray(DCM_ReferencedFileID, tmpString).good()) {
-                        referencedFileID = const_cast<char*>(tmpString.c_str());
-                    } else {
-                        LWARNING("Can't retrieve DCM_ReferencedFileID from DICOMDIR file!");
+                // series level
+                DicomDirSeries series;
+                while ((ImageRecord = SeriesRecord->nextSub(ImageRecord)) != NULL) {
+                    // image level: collect the referenced files
+                    if (ImageRecord->findAndGetOFStringArray(DCM_ReferencedFileID, tmpString).bad()) {
+                        LWARNINGC("voreen.dcmtk.DcmtkVolumeReader", "Can't retrieve DCM_ReferencedFileID from DICOMDIR file!");
+                        continue;
                     }
-
-                    string filename(referencedFileID);
+                    string filename(tmpString.c_str());
 #ifndef WIN32
                     size_t pos;
                     while ((pos = filename.find_first_of('\\')) != string::npos) {
                         filename.replace(pos, 1, "/");
                     }
 #endif
-                    files.push_back(dir + filename);
+                    series.files_.push_back(dir + filename);
                 }
+                std::ostringstream s;
+                s << series.files_.size();
+                tmp.numImages_ = s.str();
+
+                extractString(SeriesRecord, DCM_Modality, tmp.modality_);
+                extractString(SeriesRecord, DCM_SeriesDescription, tmp.description_);
+                extractString(SeriesRecord, DCM_SeriesInstanceUID, tmp.uid_);
+
+                // now we have all needed information about the series
+                series.info_ = tmp;
+                scan.series_.push_back(series);
             }
         }
     }
 
-    return readDicomFiles(files, filterSeriesInstanceUID);
+    if (exists) {
+        scan.modificationTime_ = st.st_mtime;
+        scan.size_ = st.st_size;
+        cache[fileName] = scan;
+    }
+    return scan.series_;
+}
+
+} // namespace
+
+VolumeHandle* DcmtkVolumeReader::readDICOMDIR(const string &fileName,
+                                        const string &filterSeriesInstanceUID)
+{
+    // If no series is specified, the first one listed is loaded.
+    vector<DicomDirSeries> series = scanDicomDir(fileName);
+    for (size_t i = 0; i < series.size(); ++i) {
+        if (!filterSeriesInstanceUID.empty() && series[i].info_.uid_ != filterSeriesInstanceUID)
+            continue;
+
+        LINFO("Patient Name : " << series[i].info_.patientsName_);
+        LINFO("    Series, Instance UID : " << series[i].info_.uid_);
+        LINFO("      Series Description : " << series[i].info_.description_);
+        LINFO("      Modality : " << series[i].info_.modality_);
+        return readDicomFiles(series[i].files_, series[i].info_.uid_);
+    }
+
+    LERROR("No series " << filterSeriesInstanceUID << " in " << fileName);
+    return 0;
 }
 
 
@@ -657,9 +882,9 @@ bool DcmtkVolumeReader::findSeriesDicomFile(const string &fileName, vector<Dcmtk
     DcmFileFormat fileformat;
     LINFO("  Reading file " << fileName);
 
-    OFCondition status = fileformat.loadFile(fileName.c_str());
-    if (status.bad()) {
-        LERROR("Error loading file " << fileName << ": " << status.text());
+    string error;
+    if (!loadDicomHeader(fileName, fileformat, error)) {
+        LERROR("Error loading file " << fileName << ": " << error);
         return false;
     }
 
@@ -697,75 +922,14 @@ bool DcmtkVolumeReader::findSeriesDicomFile(const string &fileName, vector<Dcmtk
 
 }
 
-namespace {
-
-void extractString(DcmDirectoryRecord* record, const DcmTagKey& field, std::string& output) {
-    OFString tmpString;
-    if (record->findAndGetOFString(field, tmpString).good())
-        output = tmpString.c_str();
-}
-
-} // namespace
-
 bool DcmtkVolumeReader::findSeriesDicomDir(const string &fileName, vector<DcmtkSeriesInfo> &series) const {
-
-    //FIXME: Need real OS-independent function here
-    string dir = string(fileName).substr(0, string(fileName).length() - string("DICOMDIR").length());
-
-    OFCondition status;
-
-    DcmDicomDir dicomdir(fileName.c_str());
-    DcmDirectoryRecord* root = &(dicomdir.getRootRecord());
-    DcmDirectoryRecord* PatientRecord = NULL;
-    DcmDirectoryRecord* StudyRecord = NULL;
-    DcmDirectoryRecord* SeriesRecord = NULL;
-    DcmDirectoryRecord* ImageRecord = NULL;
-    OFString tmpString;
-    voreen::DcmtkSeriesInfo tmp;
-
-    // Analyze DICOMDIR:
-    while ((PatientRecord = root->nextSub(PatientRecord)) != NULL) {
-        // patient level
-        tmp = voreen::DcmtkSeriesInfo();
-#if defined(VRN_DCMTK_VERSION_354)
-        extractString(PatientRecord, DCM_PatientsName, tmp.patientsName_);
-#else
-        extractString(PatientRecord, DCM_PatientName, tmp.patientsName_);
-#endif
-        extractString(PatientRecord, DCM_PatientID, tmp.patientId_);
-
-        while ((StudyRecord = PatientRecord->nextSub(StudyRecord)) != NULL) {
-            // study level
-            extractString(StudyRecord, DCM_StudyDate, tmp.studyDate_);
-            extractString(StudyRecord, DCM_StudyTime, tmp.studyTime_);
-            extractString(StudyRecord, DCM_Modality, tmp.modality_);
-
-            while ((SeriesRecord = StudyRecord->nextSub(SeriesRecord)) != NULL) {
-                // series level
-                int numimages = 0;
-                while ((ImageRecord = SeriesRecord->nextSub(ImageRecord)) != NULL) {
-                    // image level: count number of images
-                    numimages++;
-                }
-                std::ostringstream s;
-                s << numimages;
-                tmp.numImages_ = s.str();
-
-                extractString(SeriesRecord, DCM_Modality, tmp.modality_);
-                extractString(SeriesRecord, DCM_SeriesDescription, tmp.description_);
-                extractString(SeriesRecord, DCM_SeriesInstanceUID, tmp.uid_);
-
-                // now we have all needed information about the series
-                series.push_back(tmp);
-            }
-        }
-    }
-
+    vector<DicomDirSeries> dicomDirSeries = scanDicomDir(fileName);
+    for (size_t i = 0; i < dicomDirSeries.size(); ++i)
+        series.push_back(dicomDirSeries[i].info_);
     return true;
 }
 
 
-
 namespace {
 
 // Helper for analyzing a Dicom URL for C-MOVE
@@ -862,9 +1026,9 @@ VolumeCollection* DcmtkVolumeReader::read(const string &url)
 
         DcmFileFormat fileformat;
 
-        OFCondition status = fileformat.loadFile(fileName.c_str());
-        if (status.bad()) {
-                LERROR("Error loading file " << fileName << ": " << status.text());
+        string error;
+        if (!loadDicomHeader(fileName, fileformat, error)) {
+                LERROR("Error loading file " << fileName << ": " << error);
                 throw tgt::FileException("Failed to load", fileName);
         }
 
@@ -272,6 +272,15 @@ private:
      */
     virtual int loadSlice(const std::string& fileName, size_t posScalar);
 
+    /**
+     * Decodes the pixel data of a single Dicom image (=slice) into \p dest, which must
+     * provide space for dx_ * dy_ * bytesPerVoxel_ bytes. Does not log, so it can be
+     * called concurrently for several slices.
+     *
+     * @param error is set to the error message, if the slice could not be decoded
+     */
+    bool decodeSlice(const std::string& fileName, uint8_t* dest, std::string& error) const;
+
     uint8_t* scalars_;
     int dx_, dy_, dz_;
     int bitsStored_;
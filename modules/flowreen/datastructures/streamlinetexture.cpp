@@ -29,8 +29,10 @@
 #include "modules/flowreen/datastructures/flow3d.h"
 #include "modules/flowreen/utils/flowmath.h"
 #include "modules/flowreen/datastructures/streamlinetexture.h"
+#include "tgt/logmanager.h"
 #include <memory.h>
 
+#include <algorithm>
 #include <typeinfo>
 
 namespace voreen {
@@ -246,121 +248,91 @@ T* StreamlineTexture<T>::fastLIC(const Flow2D& flow, const SimpleTexture<float>&
         return 0;
 
     StreamlineTexture<T> outputTexture(inputTexSize * static_cast<int>(textureScaling));
-    const tgt::ivec2& outputTexSize = outputTexture.getDimensions().xy();
+    const tgt::ivec2 outputTexSize(outputTexture.getDimensions().xy());
     const int delta = static_cast<int>(sampling);
     const float stepSize = (0.5f / textureScaling);
     const float length = static_cast<float>(tgt::max(flow.dimensions_)) * 1.10f;
 
-    size_t numStreamlines = 0;
-    for (int y = 0; y < outputTexSize.y; y += delta) {
-        for (int x = 0; x < outputTexSize.x; x += delta) {
-            tgt::ivec2 ir0(x, y);
-            if (outputTexture[ir0].counter_ > 0)
-                continue;
+    // the seeding positions are grouped into tiles which are processed in parallel.
+    // The edge length of a tile is a multiple of the sampling, so that the seeding
+    // positions are the same as for a single pass over the entire texture.
+    //
+    const int tileSize = std::max(LIC_TILE_SIZE_2D / delta, 1) * delta;
+    const tgt::ivec2 numTiles((outputTexSize.x + tileSize - 1) / tileSize,
+        (outputTexSize.y + tileSize - 1) / tileSize);
+    const int tileCount = numTiles.x * numTiles.y;
+
+    int numStreamlines = 0;
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic) reduction(+:numStreamlines)
+    #endif
+    for (int tile = 0; tile < tileCount; ++tile) {
+        const tgt::ivec2 tileStart((tile % numTiles.x) * tileSize, (tile / numTiles.x) * tileSize);
+        const tgt::ivec2 tileEnd(tgt::min(tileStart + tgt::ivec2(tileSize), outputTexSize));
+
+        for (int y = tileStart.y; y < tileEnd.y; y += delta) {
+            for (int x = tileStart.x; x < tileEnd.x; x += delta) {
+                // The counter may be modified concurrently by another thread. This is
+                // harmless, as a stale value only results in an additional streamline.
+                //
+                tgt::ivec2 ir0(x, y);
+                if (outputTexture[ir0].counter_ > 0)
+                    continue;
 
-            // get the coordinates of the pixel in the input texture which corresponds
-            // to this position in the output texture and calculate its position within
-            // the flow.
-            //
-            tgt::ivec2 r0Input(ir0 / static_cast<int>(textureScaling));
-            tgt::ivec2 errorInput(0, 0);
-            tgt::vec2 r0 = flow.slicePosToFlowPos(r0Input, inputTexSize, &errorInput);
-            const tgt::vec2 v = flow.lookupFlow(r0);
+                // get the coordinates of the pixel in the input texture which corresponds
+                // to this position in the output texture and calculate its position within
+                // the flow.
+                //
+                tgt::ivec2 r0Input(ir0 / static_cast<int>(textureScaling));
+                tgt::ivec2 errorInput(0, 0);
+                tgt::vec2 r0 = flow.slicePosToFlowPos(r0Input, inputTexSize, &errorInput);
+                const tgt::vec2 v = flow.lookupFlow(r0);
 
-            if (v == tgt::vec2::zero)
-                continue;
+                if (v == tgt::vec2::zero)
+                    continue;
 
-            // start streamline computation
-            //
-            int indexR0 = 0;
-            std::deque<tgt::vec2> streamlineD =
-                FlowMath::computeStreamlineRungeKutta(flow, r0, length, stepSize, &indexR0, thresholds);
-            if (streamlineD.size() <= 1)
-                continue;
+                // start streamline computation
+                //
+                int indexR0 = 0;
+                std::deque<tgt::vec2> streamlineD =
+                    FlowMath::computeStreamlineRungeKutta(flow, r0, length, stepSize, &indexR0, thresholds);
+                if (streamlineD.size() <= 1)
+                    continue;
 
-            // also determine the round-off error which occurs if the flow positions was
-            // converted back directly to the coordinates of the output textures.
-            //
-            tgt::ivec2 errorOutput(0, 0);
-            flow.slicePosToFlowPos(ir0, outputTexSize, &errorOutput);
+                // also determine the round-off error which occurs if the flow positions was
+                // converted back directly to the coordinates of the output textures.
+                //
+                tgt::ivec2 errorOutput(0, 0);
+                flow.slicePosToFlowPos(ir0, outputTexSize, &errorOutput);
 
-            ++numStreamlines;
-            std::vector<tgt::vec2> streamline = FlowMath::dequeToVector(streamlineD);
-
-            // copy the streamline for second coordinate conversion
-            //
-            std::vector<tgt::vec2> streamlineCopy(streamline);
-
-            // convert the streamline into dimensions of the input texture
-            //
-            std::vector<tgt::ivec2> streamlineInput =
-                flow.flowPosToSlicePos(streamline, inputTexSize, errorInput);
-
-            // also convert the streamline into dimensions of the output texture
-            //
-            std::vector<tgt::ivec2> streamlineOutput =
-                flow.flowPosToSlicePos(streamlineCopy, outputTexSize, errorOutput);
-
-            // calculate initial intensity for the starting pixel
-            //
-            int L = maxKernelSize;
-            if (useAdaptiveKernelSize == true)
-                L = static_cast<int>(tgt::round(maxKernelSize * (tgt::length(v) / thresholds.y)));
-            const float k = 1.0f / (((2 * L) + 1));
-            float intensity0 = k * fastLICIntensity(inputTexture, indexR0, L, streamlineInput);
-
-            // determine the affected pixel in the output texture and add the
-            // initial intensity
-            //
-            tgt::ivec2& outputTexCoord = streamlineOutput[indexR0];
-            outputTexture[outputTexCoord].elem_ += T(intensity0);
-            ++(outputTexture[outputTexCoord].counter_);
-
-            // trace streamline in forward direction and update intensity
-            //
-            float intensity = intensity0;
-            int left = indexR0 + L + 1;
-            int right = indexR0 - L;
-            const int numPoints = static_cast<int>(streamlineInput.size());
-
-            for (int i = (indexR0 + 1); i < numPoints; ++i, ++left, ++right) {
-                int l = (left >= numPoints) ? (numPoints - 1) : left;
-                int r = (right <= 0) ? 0 : right;
-
-                intensity += (inputTexture[streamlineInput[l]] - inputTexture[streamlineInput[r]]) * k;
-
-                outputTexCoord = streamlineOutput[i];
-                outputTexture[outputTexCoord].elem_ += T(intensity);
-                ++(outputTexture[outputTexCoord].counter_);
-            }   // for (i
-
-            // trace streamline in backward direction and update intensity
-            //
-            intensity = intensity0;
-            left = indexR0 - L - 1;
-            right = indexR0 + L;
-            for (int i = (indexR0 - 1); i >= 0; --i, --left, --right) {
-                int l = (left <= 0) ? 0 : left;
-                int r = (right >= numPoints) ? (numPoints - 1) : right;
-
-                intensity += (inputTexture[streamlineInput[l]] - inputTexture[streamlineInput[r]]) * k;
-
-                outputTexCoord = streamlineOutput[i];
-                outputTexture[outputTexCoord].elem_ += T(intensity);
-                ++(outputTexture[outputTexCoord].counter_);
-            }   // for (i
-        }   // for (x
-    }   // for (y
+                ++numStreamlines;
+                std::vector<tgt::vec2> streamline = FlowMath::dequeToVector(streamlineD);
+
+                // copy the streamline for second coordinate conversion
+                //
+                std::vector<tgt::vec2> streamlineCopy(streamline);
+
+                // convert the streamline into dimensions of the input texture
+                //
+                std::vector<tgt::ivec2> streamlineInput =
+                    flow.flowPosToSlicePos(streamline, inputTexSize, errorInput);
+
+                // also convert the streamline into dimensions of the output texture
+                //
+                std::vector<tgt::ivec2> streamlineOutput =
+                    flow.flowPosToSlicePos(streamlineCopy, outputTexSize, errorOutput);
+
+                int L = maxKernelSize;
+                if (useAdaptiveKernelSize == true)
+                    L = static_cast<int>(tgt::round(maxKernelSize * (tgt::length(v) / thresholds.y)));
+                outputTexture.convolveStreamline(inputTexture, indexR0, L, streamlineInput,
+                    streamlineOutput);
+            }   // for (x
+        }   // for (y
+    }   // for (tile
 
-    size_t unhitPixels = 0;
     const size_t numPixels = outputTexture.getNumElements();
-    for (size_t i = 0; i < numPixels; ++i) {
-        if (outputTexture[i].counter_ > 1)
-            outputTexture[i].elem_ /= static_cast<unsigned char>(outputTexture[i].counter_);
-        else
-            if (outputTexture[i].counter_ <= 0)
-                ++unhitPixels;
-    }
+    size_t unhitPixels = outputTexture.normalizeFastLIC();
     std::cout << "# streamlines = " << numStreamlines << ", # unhit pixels = " << unhitPixels
         << " (" << static_cast<float>(100 * unhitPixels) / static_cast<float>(numPixels) << " %)\n";
 
@@ -369,6 +341,99 @@ T* StreamlineTexture<T>::fastLIC(const Flow2D& flow, const SimpleTexture<float>&
     return result;
 }
 
+template<typename T>
+T* StreamlineTexture<T>::fastLIC(const Flow3D& flow, const SimpleTexture<float>& inputTexture,
+                                 const size_t textureScaling, const size_t sampling,
+                                 const int maxKernelSize, const tgt::vec2& thresholds,
+                                 const bool useAdaptiveKernelSize)
+{
+    const tgt::ivec3 inputTexSize(inputTexture.getDimensions());
+    if (flow.dimensions_ != inputTexSize)
+        return 0;
+
+    StreamlineTexture<T> outputTexture(inputTexSize * static_cast<int>(textureScaling));
+    const tgt::ivec3 outputTexSize(outputTexture.getDimensions());
+    const int delta = static_cast<int>(sampling);
+    const float stepSize = (0.5f / textureScaling);
+    const float length = static_cast<float>(tgt::max(flow.dimensions_)) * 1.10f;
+
+    const int brickSize = std::max(LIC_TILE_SIZE_3D / delta, 1) * delta;
+    const tgt::ivec3 numBricks((outputTexSize.x + brickSize - 1) / brickSize,
+        (outputTexSize.y + brickSize - 1) / brickSize, (outputTexSize.z + brickSize - 1) / brickSize);
+    const int brickCount = numBricks.x * numBricks.y * numBricks.z;
+
+    int numStreamlines = 0;
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic) reduction(+:numStreamlines)
+    #endif
+    for (int brick = 0; brick < brickCount; ++brick) {
+        const tgt::ivec3 brickStart((brick % numBricks.x) * brickSize,
+            ((brick / numBricks.x) % numBricks.y) * brickSize,
+            (brick / (numBricks.x * numBricks.y)) * brickSize);
+        const tgt::ivec3 brickEnd(tgt::min(brickStart + tgt::ivec3(brickSize), outputTexSize));
+
+        for (int z = brickStart.z; z < brickEnd.z; z += delta) {
+            for (int y = brickStart.y; y < brickEnd.y; y += delta) {
+                for (int x = brickStart.x; x < brickEnd.x; x += delta) {
+                    tgt::ivec3 ir0(x, y, z);
+                    if (outputTexture[ir0].counter_ > 0)
+                        continue;
+
+                    tgt::ivec3 r0Input(ir0 / static_cast<int>(textureScaling));
+                    tgt::ivec3 errorInput(0, 0, 0);
+                    tgt::vec3 r0 = flow.toFlowPosition(r0Input, inputTexSize, &errorInput);
+                    const tgt::vec3 v = flow.lookupFlow(r0);
+
+                    if (v == tgt::vec3::zero)
+                        continue;
+
+                    int indexR0 = 0;
+                    std::deque<tgt::vec3> streamline =
+                        FlowMath::computeStreamlineRungeKutta(flow, r0, length, stepSize, &indexR0, thresholds);
+                    if (streamline.size() <= 1)
+                        continue;
+
+                    tgt::ivec3 errorOutput(0, 0, 0);
+                    flow.toFlowPosition(ir0, outputTexSize, &errorOutput);
+
+                    ++numStreamlines;
+
+                    // toTexturePosition() consumes the passed streamline, so copy it for
+                    // the second coordinate conversion
+                    //
+                    std::deque<tgt::vec3> streamlineCopy(streamline);
+                    std::deque<tgt::ivec3> streamlineInputD =
+                        flow.toTexturePosition(streamline, inputTexSize, errorInput);
+                    std::deque<tgt::ivec3> streamlineOutputD =
+                        flow.toTexturePosition(streamlineCopy, outputTexSize, errorOutput);
+
+                    std::vector<tgt::ivec3> streamlineInput(streamlineInputD.begin(), streamlineInputD.end());
+                    std::vector<tgt::ivec3> streamlineOutput(streamlineOutputD.begin(), streamlineOutputD.end());
+
+                    int L = maxKernelSize;
+                    if (useAdaptiveKernelSize == true)
+                        L = static_cast<int>(tgt::round(maxKernelSize * (tgt::length(v) / thresholds.y)));
+                    outputTexture.convolveStreamline(inputTexture, indexR0, L, streamlineInput,
+                        streamlineOutput);
+                }   // for (x
+            }   // for (y
+        }   // for (z
+    }   // for (brick
+
+    const size_t numVoxels = outputTexture.getNumElements();
+#ifdef TGT_DEBUG
+    size_t unhitVoxels = outputTexture.normalizeFastLIC();
+    LDEBUGC("voreen.flowreen.StreamlineTexture", "# streamlines = " << numStreamlines << ", # unhit voxels = "
+        << unhitVoxels << " (" << static_cast<float>(100 * unhitVoxels) / static_cast<float>(numVoxels) << " %)");
+#else
+    outputTexture.normalizeFastLIC();
+#endif
+
+    T* result = new T[numVoxels];
+    memcpy(result, outputTexture.getData(), sizeof(T) * numVoxels);
+    return result;
+}
+
 // private methods
 //
 template<typename T>
@@ -387,6 +452,93 @@ float StreamlineTexture<T>::fastLICIntensity(const SimpleTexture<float>& inputTe
     return intensity;
 }
 
+template<typename T>
+float StreamlineTexture<T>::fastLICIntensity(const SimpleTexture<float>& inputTexture,
+                                         const int indexR0, const int kernelSize,
+                                         const std::vector<tgt::ivec3>& streamline)
+{
+    float intensity = inputTexture[streamline[indexR0]];
+    for (int n = 1; n <= kernelSize; ++n) {
+        if (static_cast<size_t>(indexR0 + n) < streamline.size())
+            intensity += inputTexture[streamline[indexR0 + n]];
+
+        if ((indexR0 - n) >= 0)
+            intensity += inputTexture[streamline[indexR0 - n]];
+    }
+    return intensity;
+}
+
+template<typename T> template<typename P>
+void StreamlineTexture<T>::addIntensity(const P& position, const float intensity) {
+    StreamlineTextureElement elem = operator[](position);
+    #ifdef _OPENMP
+    #pragma omp atomic
+    #endif
+    elem.elem_ += T(intensity);
+    #ifdef _OPENMP
+    #pragma omp atomic
+    #endif
+    ++(elem.counter_);
+}
+
+template<typename T> template<typename P>
+void StreamlineTexture<T>::convolveStreamline(const SimpleTexture<float>& inputTexture,
+                                              const int indexR0, const int kernelSize,
+                                              const std::vector<P>& streamlineInput,
+                                              const std::vector<P>& streamlineOutput)
+{
+    // calculate initial intensity for the starting pixel and add it to
+    // the affected pixel in the output texture
+    //
+    const float k = 1.0f / (((2 * kernelSize) + 1));
+    float intensity0 = k * fastLICIntensity(inputTexture, indexR0, kernelSize, streamlineInput);
+    addIntensity(streamlineOutput[indexR0], intensity0);
+
+    // trace streamline in forward direction and update intensity
+    //
+    float intensity = intensity0;
+    int left = indexR0 + kernelSize + 1;
+    int right = indexR0 - kernelSize;
+    const int numPoints = static_cast<int>(streamlineInput.size());
+
+    for (int i = (indexR0 + 1); i < numPoints; ++i, ++left, ++right) {
+        int l = (left >= numPoints) ? (numPoints - 1) : left;
+        int r = (right <= 0) ? 0 : right;
+
+        intensity += (inputTexture[streamlineInput[l]] - inputTexture[streamlineInput[r]]) * k;
+        addIntensity(streamlineOutput[i], intensity);
+    }   // for (i
+
+    // trace streamline in backward direction and update intensity
+    //
+    intensity = intensity0;
+    left = indexR0 - kernelSize - 1;
+    right = indexR0 + kernelSize;
+    for (int i = (indexR0 - 1); i >= 0; --i, --left, --right) {
+        int l = (left <= 0) ? 0 : left;
+        int r = (right >= numPoints) ? (numPoints - 1) : right;
+
+        intensity += (inputTexture[streamlineInput[l]] - inputTexture[streamlineInput[r]]) * k;
+        addIntensity(streamlineOutput[i], intensity);
+    }   // for (i
+}
+
+template<typename T>
+size_t StreamlineTexture<T>::normalizeFastLIC() {
+    int unhit = 0;
+    const int numElements = static_cast<int>(numElements_);
+    #ifdef _OPENMP
+    #pragma omp parallel for reduction(+:unhit)
+    #endif
+    for (int i = 0; i < numElements; ++i) {
+        if (counter_[i] > 1)
+            data_[i] = T(data_[i] / static_cast<float>(counter_[i]));
+        else if (counter_[i] <= 0)
+            ++unhit;
+    }
+    return static_cast<size_t>(unhit);
+}
+
 // ----------------------------------------------------------------------------
 
 template class StreamlineTexture<float>;
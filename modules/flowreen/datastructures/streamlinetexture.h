@@ -77,11 +77,33 @@ public:
     static T* integrateDraw(const Flow3D& flow, const size_t textureScaling,
         const size_t sampling, const tgt::vec2& thresholds = tgt::vec2(0.0f));
 
+    /**
+     * Generates a FastLIC image of the given 2D flow by convolving the given input
+     * texture (usually white noise) along streamlines. The seeding positions on the
+     * output texture are grouped into tiles which are distributed among several
+     * threads if OpenMP is available. Hits on the output pixels are counted atomically,
+     * so that streamlines from different tiles may cross each other.
+     * The caller has to free the returned array by using delete [].
+     */
     static T* fastLIC(const Flow2D& flow, const SimpleTexture<float>& inputTexture,
         const size_t textureScaling, const size_t sampling, const int maxKernelSize,
         const tgt::vec2& threshold = tgt::vec2(0.0f), const bool useAdaptiveKernelSize = false);
 
+    /**
+     * Generates a FastLIC volume of the given 3D flow by convolving the given 3D input
+     * texture along 3D streamlines. Seeding is performed brick-wise in parallel like
+     * for the 2D variant. The dimensions of the input texture have to match the ones
+     * of the flow. The caller has to free the returned array by using delete [].
+     */
+    static T* fastLIC(const Flow3D& flow, const SimpleTexture<float>& inputTexture,
+        const size_t textureScaling, const size_t sampling, const int maxKernelSize,
+        const tgt::vec2& threshold = tgt::vec2(0.0f), const bool useAdaptiveKernelSize = false);
+
 private:
+    /** edge length of the tiles (2D) respectively bricks (3D) of seeding positions */
+    static const int LIC_TILE_SIZE_2D = 32;
+    static const int LIC_TILE_SIZE_3D = 8;
+
     // prevent objects of this class from being copied
     //
     StreamlineTexture(const StreamlineTexture&);
@@ -90,6 +112,35 @@ private:
     static float fastLICIntensity(const SimpleTexture<float>& inputTexture,
         const int indexR0, const int kernelSize, const std::vector<tgt::ivec2>& streamline);
 
+    static float fastLICIntensity(const SimpleTexture<float>& inputTexture,
+        const int indexR0, const int kernelSize, const std::vector<tgt::ivec3>& streamline);
+
+    /**
+     * Adds the given intensity to the element at the given position and increases
+     * its counter. Both operations are atomic, so this method may be called
+     * concurrently by several threads.
+     */
+    template<typename P>
+    void addIntensity(const P& position, const float intensity);
+
+    /**
+     * Performs the actual convolution along the given streamline in forward and
+     * backward direction, starting at the point with index indexR0, and adds the
+     * results to this texture.
+     *
+     * @param   streamlineInput the streamline in coordinates of the input texture
+     * @param   streamlineOutput    the streamline in coordinates of this texture
+     */
+    template<typename P>
+    void convolveStreamline(const SimpleTexture<float>& inputTexture, const int indexR0,
+        const int kernelSize, const std::vector<P>& streamlineInput,
+        const std::vector<P>& streamlineOutput);
+
+    /**
+     * Divides all elements by their counters and returns the number of unhit elements.
+     */
+    size_t normalizeFastLIC();
+
 private:
     size_t* const counter_;
 };
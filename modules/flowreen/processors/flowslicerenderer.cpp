@@ -33,6 +33,7 @@
 #include "flowslicerenderer.h"
 #include "modules/flowreen/datastructures/streamlinetexture.h"
 
+#include <algorithm>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -52,6 +53,7 @@ FlowSliceRenderer::FlowSliceRenderer()
     pixelSamplingProp_("pixelSamplingProp", "pixel sampling: ", 50, 1, 10000),
     arrowSizeProp_("arrowSizeProp", "arrow size (pixel / zoom): ", 10, 1, 2000),
     arrowSpacingProp_("arrowSpacingProp", "arrow spacing (x arrow size): ", 2, 1, 100),
+    flowTextureCacheSizeProp_("flowTextureCacheSize", "max. cached textures: ", 32, 0, 1024),
     zoom_(ZOOM_1X),
     permutation_(0, 1, 2),
     shader_(0),
@@ -62,6 +64,7 @@ FlowSliceRenderer::FlowSliceRenderer()
     flow3DTexture_(0),
     rebuildTexture_(true),
     arrowList_(0),
+    licVolume_(0),
     volInport_(Port::INPORT, "volumehandle.volumehandle"),
     imgOutport_(Port::OUTPORT, "image.outport"),
     privatePort1_(Port::OUTPORT, "image.temp1", false),
@@ -121,6 +124,8 @@ FlowSliceRenderer::FlowSliceRenderer()
     pixelSamplingProp_.onChange(invalidateAction);
     arrowSizeProp_.onChange(invalidateAction);
     arrowSpacingProp_.onChange(invalidateAction);
+    flowTextureCacheSizeProp_.onChange(
+        CallMemberAction<FlowSliceRenderer>(this, &FlowSliceRenderer::onFlowTextureCacheSizeChange));
 
     addProperty(techniqueProp_);
     addProperty(maxStreamlineLengthProp_);
@@ -138,6 +143,7 @@ FlowSliceRenderer::FlowSliceRenderer()
     addProperty(pixelSamplingProp_);
     addProperty(arrowSizeProp_);
     addProperty(arrowSpacingProp_);
+    addProperty(flowTextureCacheSizeProp_);
 
     addPort(volInport_);
     addPort(imgOutport_);
@@ -157,6 +163,7 @@ FlowSliceRenderer::~FlowSliceRenderer() {
     delete [] randomPositions_;
     delete noiseTexture_;
     delete flow2DTexture_;
+    clearFlowTextureCache();
 }
 
 void FlowSliceRenderer::deinitialize() throw (tgt::Exception) {
@@ -182,6 +189,43 @@ void FlowSliceRenderer::initialize() throw (tgt::Exception) {
 // protected methods
 //
 
+FlowSliceRenderer::FlowTextureKey::FlowTextureKey()
+    : flow_(0),
+    technique_(-1),
+    permutation_(0, 0, 0),
+    sliceNo_(0),
+    textureScaling_(0),
+    kernelSize_(0),
+    sampling_(0),
+    useAdaptiveKernelSize_(false),
+    thresholds_(0.0f)
+{
+}
+
+bool FlowSliceRenderer::FlowTextureKey::operator<(const FlowTextureKey& other) const {
+    if (flow_ != other.flow_)
+        return (flow_ < other.flow_);
+    if (technique_ != other.technique_)
+        return (technique_ < other.technique_);
+    for (size_t i = 0; i < 3; ++i) {
+        if (permutation_[i] != other.permutation_[i])
+            return (permutation_[i] < other.permutation_[i]);
+    }
+    if (sliceNo_ != other.sliceNo_)
+        return (sliceNo_ < other.sliceNo_);
+    if (textureScaling_ != other.textureScaling_)
+        return (textureScaling_ < other.textureScaling_);
+    if (kernelSize_ != other.kernelSize_)
+        return (kernelSize_ < other.kernelSize_);
+    if (sampling_ != other.sampling_)
+        return (sampling_ < other.sampling_);
+    if (useAdaptiveKernelSize_ != other.useAdaptiveKernelSize_)
+        return (useAdaptiveKernelSize_ < other.useAdaptiveKernelSize_);
+    if (thresholds_.x != other.thresholds_.x)
+        return (thresholds_.x < other.thresholds_.x);
+    return (thresholds_.y < other.thresholds_.y);
+}
+
 tgt::ivec3 FlowSliceRenderer::getCoordinatePermutation(const SliceAlignment& alignment) {
     switch (alignment) {
         case PLANE_XY:
@@ -425,42 +469,61 @@ tgt::Texture* FlowSliceRenderer::renderFlowTexture(const Flow3D& flow, const siz
     // on the nearest integral scaling factor.
     //
     tgt::ivec2 sliceSize = flow.getFlowSliceDimensions(permutation_);
+    const size_t numPixels = static_cast<size_t>(sliceSize.x * sliceSize.y * textureScaling * textureScaling);
+
+    FlowTextureKey key;
+    key.flow_ = &flow;
+    key.technique_ = static_cast<int>(technique);
+    key.permutation_ = permutation_;
+    key.sliceNo_ = sliceNo;
+    key.textureScaling_ = textureScaling;
+    key.kernelSize_ = kernelSizeProp_.get();
+    key.sampling_ = pixelSamplingProp_.get();
+    key.useAdaptiveKernelSize_ = useAdaptiveKernelSizeProp_.get();
+    key.thresholds_ = thresholds;
+
+    float* pixels = lookupFlowTexture(key);
+    if (pixels == 0) {
+        switch (technique) {
+            case TECHNIQUE_INTEGRATE_DRAW:
+                pixels = StreamlineTexture<float>::integrateDraw(flow.extractSlice(permutation_, sliceNo),
+                    textureScaling, sampling, thresholds);
+                break;
+
+            case TECHNIQUE_FAST_LIC:
+                {
+                    Flow2D flow2D = flow.extractSlice(permutation_, sliceNo);
+                    const int kernelSize = kernelSizeProp_.get();
+                    SimpleTexture<float> noiseTexture(flow2D.dimensions_, true);
+                    noiseTexture.createWhiteNoise();
+                    pixels = StreamlineTexture<float>::fastLIC(flow2D, noiseTexture,
+                        textureScaling, sampling, kernelSize, thresholds, useAdaptiveKernelSizeProp_.get());
+                }
+                break;
+
+            case TECHNIQUE_INTEGRATE_DRAW_PROJECTED:
+                pixels = integrateDraw(flow, sliceNo, textureScaling);
+                break;
+
+            case TECHNIQUE_FAST_LIC_PROJECTED:
+                pixels = fastLIC(flow, sliceNo, textureScaling);
+                break;
+
+            case TECHNIQUE_FAST_LIC_VOLUME:
+                pixels = fastLICVolumeSlice(flow, sliceNo, textureScaling, thresholds);
+                break;
+
+            default:
+                LERROR("renderFlowSlice(): unsupport rendering technique #'"
+                    << static_cast<int>(technique) << "'!");
+                return 0;
+        }
 
-    float* pixels = 0;
-    switch (technique) {
-        case TECHNIQUE_INTEGRATE_DRAW:
-            pixels = StreamlineTexture<float>::integrateDraw(flow.extractSlice(permutation_, sliceNo),
-                textureScaling, sampling, thresholds);
-            break;
-
-        case TECHNIQUE_FAST_LIC:
-            {
-                Flow2D flow2D = flow.extractSlice(permutation_, sliceNo);
-                const int kernelSize = kernelSizeProp_.get();
-                SimpleTexture<float> noiseTexture(flow2D.dimensions_, true);
-                noiseTexture.createWhiteNoise();
-                pixels = StreamlineTexture<float>::fastLIC(flow2D, noiseTexture,
-                    textureScaling, sampling, kernelSize, thresholds, useAdaptiveKernelSizeProp_.get());
-            }
-            break;
-
-        case TECHNIQUE_INTEGRATE_DRAW_PROJECTED:
-            pixels = integrateDraw(flow, sliceNo, textureScaling);
-            break;
-
-        case TECHNIQUE_FAST_LIC_PROJECTED:
-            pixels = fastLIC(flow, sliceNo, textureScaling);
-            break;
-
-        default:
-            LERROR("renderFlowSlice(): unsupport rendering technique #'"
-                << static_cast<int>(technique) << "'!");
+        if (pixels == 0)
             return 0;
+        cacheFlowTexture(key, pixels, numPixels);
     }
 
-    if (pixels == 0)
-        return 0;
-
     // no memory leak occurs when not deleting pointer pixels here, because
     // tgt::Texture's dtor will free the memory by using delete []
     //
@@ -469,6 +532,14 @@ tgt::Texture* FlowSliceRenderer::renderFlowTexture(const Flow3D& flow, const siz
         GL_FLOAT, tgt::Texture::NEAREST);
 }
 
+void FlowSliceRenderer::clearFlowTextureCache() {
+    flowTextureCache_.clear();
+    flowTextureCacheOrder_.clear();
+
+    delete [] licVolume_;
+    licVolume_ = 0;
+}
+
 void FlowSliceRenderer::initNoiseTexture(const tgt::ivec2& size) {
     if ((rebuildTexture_ == true) || (noiseTexture_ == 0)) {
         delete noiseTexture_;
@@ -702,107 +773,140 @@ float* FlowSliceRenderer::fastLIC(const Flow3D& flow, const size_t sliceNo, cons
     const float k = 1.0f / (((2.0f * kernelSize) + 1.0f) * textureScaling);
     const int delta = pixelSamplingProp_.get(); // 1/rate of pixels to be sampled on output texture
 
-    size_t numStreamlines = 0;
-    for (int y = 0; y < outputTexSize.y; y += delta) {
-        for (int x = 0; x < outputTexSize.x; x += delta) {
-            int index = y * outputTexSize.x + x;
-            if (numHits[index] > 0)
-                continue;
-
-            // get the coordinates of the pixel in the input texture which corresponds
-            // to this position in the output texture and calculate its position within
-            // the flow.
-            //
-            tgt::ivec2 r0Input = tgt::ivec2(x, y) / textureScaling;
-            tgt::ivec2 errorInput(0, 0);
-            tgt::vec3 r0 =
-                flow.slicePosToFlowPos(r0Input, inputTexSize, permutation_, sliceNo, &errorInput);
-
-            if (flow.lookupFlow(r0) == tgt::vec3::zero)
-                continue;
-
-            // also determine the round-off error which occurs if the flow positions was
-            // converted back directly to the coordinates of the output textures.
-            //
-            tgt::ivec2 errorOutput(0, 0);
-            flow.slicePosToFlowPos(tgt::ivec2(x, y), outputTexSize, permutation_, sliceNo, &errorOutput);
-
-            // start streamline computation
-            //
-            ++numStreamlines;
-            int indexR0 = 0;
-            std::deque<tgt::vec3> deque = FlowMath::computeStreamlineRungeKutta(flow, r0, 150.0f, stepSize, &indexR0);
-            std::vector<tgt::vec3> streamline = FlowMath::dequeToVector(deque);
-
-            // copy the streamline for second coordinate conversion
-            //
-            std::vector<tgt::vec3> streamlineCopy(streamline);
-
-            // convert the streamline into dimensions of the input texture
-            //
-            std::vector<tgt::ivec2> streamlineInput =
-                flow.flowPosToSlicePos(streamline, inputTexSize, permutation_, errorInput);
-
-            // also convert the streamline into dimensions of the output texture
-            //
-            std::vector<tgt::ivec2> streamlineOutput =
-                flow.flowPosToSlicePos(streamlineCopy, outputTexSize, permutation_, errorOutput);
-
-            // calculate initial intensity for the starting pixel
-            //
-            float intensity0 = k * initialFastLICIntensity(indexR0, kernelSize, streamlineInput);
-
-            // determine the affected pixel in the output texture and add the
-            // initial intensity
-            //
-            tgt::ivec2& outputTexCoord = streamlineOutput[indexR0];
-            size_t pixel = outputTexCoord.y * outputTexSize.x + outputTexCoord.x;
-            output[pixel] += intensity0;
-            ++numHits[pixel];
-
-            // trace streamline in forward direction and update intensity
-            //
-            float intensity = intensity0;
-            int left = indexR0 + kernelSize + 1;
-            int right = indexR0 - kernelSize;
-            const int numPoints = static_cast<int>(streamlineInput.size());
-
-            for (int i = (indexR0 + 1); i < numPoints; ++i, ++left, ++right) {
-                int l = (left >= numPoints) ? (numPoints - 1) : left;
-                const tgt::ivec2& a = streamlineInput[l];
+    // process the seeding positions in tiles of 32 x 32 pixels in parallel (see
+    // StreamlineTexture::fastLIC())
+    //
+    const int tileSize = std::max(32 / delta, 1) * delta;
+    const tgt::ivec2 numTiles((outputTexSize.x + tileSize - 1) / tileSize,
+        (outputTexSize.y + tileSize - 1) / tileSize);
+    const int tileCount = numTiles.x * numTiles.y;
+
+    int numStreamlines = 0;
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic) reduction(+:numStreamlines)
+    #endif
+    for (int tile = 0; tile < tileCount; ++tile) {
+        const tgt::ivec2 tileStart((tile % numTiles.x) * tileSize, (tile / numTiles.x) * tileSize);
+        const tgt::ivec2 tileEnd(tgt::min(tileStart + tgt::ivec2(tileSize), outputTexSize));
+        for (int y = tileStart.y; y < tileEnd.y; y += delta) {
+            for (int x = tileStart.x; x < tileEnd.x; x += delta) {
+                int index = y * outputTexSize.x + x;
+                if (numHits[index] > 0)
+                    continue;
 
-                int r = (right <= 0) ? 0 : right;
-                const tgt::ivec2& b = streamlineInput[r];
+                // get the coordinates of the pixel in the input texture which corresponds
+                // to this position in the output texture and calculate its position within
+                // the flow.
+                //
+                tgt::ivec2 r0Input = tgt::ivec2(x, y) / textureScaling;
+                tgt::ivec2 errorInput(0, 0);
+                tgt::vec3 r0 =
+                    flow.slicePosToFlowPos(r0Input, inputTexSize, permutation_, sliceNo, &errorInput);
 
-                intensity += (((*noiseTexture_)[a] / 255.0f) - ((*noiseTexture_)[b] / 255.0f)) * k;
+                if (flow.lookupFlow(r0) == tgt::vec3::zero)
+                    continue;
 
-                outputTexCoord = streamlineOutput[i];
-                pixel = outputTexCoord.y * outputTexSize.x + outputTexCoord.x;
+                // also determine the round-off error which occurs if the flow positions was
+                // converted back directly to the coordinates of the output textures.
+                //
+                tgt::ivec2 errorOutput(0, 0);
+                flow.slicePosToFlowPos(tgt::ivec2(x, y), outputTexSize, permutation_, sliceNo, &errorOutput);
+
+                // start streamline computation
+                //
+                ++numStreamlines;
+                int indexR0 = 0;
+                std::deque<tgt::vec3> deque = FlowMath::computeStreamlineRungeKutta(flow, r0, 150.0f, stepSize, &indexR0);
+                std::vector<tgt::vec3> streamline = FlowMath::dequeToVector(deque);
+
+                // copy the streamline for second coordinate conversion
+                //
+                std::vector<tgt::vec3> streamlineCopy(streamline);
+
+                // convert the streamline into dimensions of the input texture
+                //
+                std::vector<tgt::ivec2> streamlineInput =
+                    flow.flowPosToSlicePos(streamline, inputTexSize, permutation_, errorInput);
+
+                // also convert the streamline into dimensions of the output texture
+                //
+                std::vector<tgt::ivec2> streamlineOutput =
+                    flow.flowPosToSlicePos(streamlineCopy, outputTexSize, permutation_, errorOutput);
+
+                // calculate initial intensity for the starting pixel
+                //
+                float intensity0 = k * initialFastLICIntensity(indexR0, kernelSize, streamlineInput);
+
+                // determine the affected pixel in the output texture and add the
+                // initial intensity
+                //
+                tgt::ivec2& outputTexCoord = streamlineOutput[indexR0];
+                size_t pixel = outputTexCoord.y * outputTexSize.x + outputTexCoord.x;
+                #ifdef _OPENMP
+                #pragma omp atomic
+                #endif
+                output[pixel] += intensity0;
+                #ifdef _OPENMP
+                #pragma omp atomic
+                #endif
                 ++numHits[pixel];
-                output[pixel] += intensity;
-            }
-
-            // trace streamline in backward direction and update intensity
-            //
-            intensity = intensity0;
-            left = indexR0 - kernelSize - 1;
-            right = indexR0 + kernelSize;
-            for (int i = (indexR0 - 1); i >= 0; --i, --left, --right) {
-                int l = (left <= 0) ? 0 : left;
-                const tgt::ivec2& a = streamlineInput[l];
 
-                int r = (right >= numPoints) ? (numPoints - 1) : right;
-                const tgt::ivec2& b = streamlineInput[r];
-
-                intensity += (((*noiseTexture_)[a] / 255.0f) - ((*noiseTexture_)[b] / 255.0f)) * k;
-
-                outputTexCoord = streamlineOutput[i];
-                pixel = outputTexCoord.y * outputTexSize.x + outputTexCoord.x;
-                ++numHits[pixel];
-                output[pixel] += intensity;
+                // trace streamline in forward direction and update intensity
+                //
+                float intensity = intensity0;
+                int left = indexR0 + kernelSize + 1;
+                int right = indexR0 - kernelSize;
+                const int numPoints = static_cast<int>(streamlineInput.size());
+
+                for (int i = (indexR0 + 1); i < numPoints; ++i, ++left, ++right) {
+                    int l = (left >= numPoints) ? (numPoints - 1) : left;
+                    const tgt::ivec2& a = streamlineInput[l];
+
+                    int r = (right <= 0) ? 0 : right;
+                    const tgt::ivec2& b = streamlineInput[r];
+
+                    intensity += (((*noiseTexture_)[a] / 255.0f) - ((*noiseTexture_)[b] / 255.0f)) * k;
+
+                    outputTexCoord = streamlineOutput[i];
+                    pixel = outputTexCoord.y * outputTexSize.x + outputTexCoord.x;
+                    #ifdef _OPENMP
+                    #pragma omp atomic
+                    #endif
+                    ++numHits[pixel];
+                    #ifdef _OPENMP
+                    #pragma omp atomic
+                    #endif
+                    output[pixel] += intensity;
+                }
+
+                // trace streamline in backward direction and update intensity
+                //
+                intensity = intensity0;
+                left = indexR0 - kernelSize - 1;
+                right = indexR0 + kernelSize;
+                for (int i = (indexR0 - 1); i >= 0; --i, --left, --right) {
+                    int l = (left <= 0) ? 0 : left;
+                    const tgt::ivec2& a = streamlineInput[l];
+
+                    int r = (right >= numPoints) ? (numPoints - 1) : right;
+                    const tgt::ivec2& b = streamlineInput[r];
+
+                    intensity += (((*noiseTexture_)[a] / 255.0f) - ((*noiseTexture_)[b] / 255.0f)) * k;
+
+                    outputTexCoord = streamlineOutput[i];
+                    pixel = outputTexCoord.y * outputTexSize.x + outputTexCoord.x;
+                    #ifdef _OPENMP
+                    #pragma omp atomic
+                    #endif
+                    ++numHits[pixel];
+                    #ifdef _OPENMP
+                    #pragma omp atomic
+                    #endif
+                    output[pixel] += intensity;
+                }
             }
-        }
-    }
+        }   // for (y
+    }   // for (tile
 
     size_t unhitPixels = 0;
     for (size_t i = 0; i < numOutputPixels; ++i) {
@@ -837,6 +941,94 @@ float FlowSliceRenderer::initialFastLICIntensity(const int indexR0, const size_t
     return (intensity / 255.0f);
 }
 
+float* FlowSliceRenderer::fastLICVolumeSlice(const Flow3D& flow, const size_t sliceNo,
+                                             const int textureScaling, const tgt::vec2& thresholds)
+{
+    FlowTextureKey key;
+    key.flow_ = &flow;
+    key.technique_ = TECHNIQUE_FAST_LIC_VOLUME;
+    key.textureScaling_ = textureScaling;
+    key.kernelSize_ = kernelSizeProp_.get();
+    key.sampling_ = pixelSamplingProp_.get();
+    key.useAdaptiveKernelSize_ = useAdaptiveKernelSizeProp_.get();
+    key.thresholds_ = thresholds;
+
+    if ((licVolume_ == 0) || (key < licVolumeKey_) || (licVolumeKey_ < key)) {
+        delete [] licVolume_;
+
+        SimpleTexture<float> noiseTexture(flow.dimensions_, true);
+        noiseTexture.createWhiteNoise();
+        licVolume_ = StreamlineTexture<float>::fastLIC(flow, noiseTexture, textureScaling,
+            static_cast<size_t>(key.sampling_), key.kernelSize_, thresholds, key.useAdaptiveKernelSize_);
+        licVolumeKey_ = key;
+        if (licVolume_ == 0)
+            return 0;
+    }
+
+    const int& i = permutation_.x;
+    const int& j = permutation_.y;
+    const int& k = permutation_.z;
+
+    const tgt::ivec3 volumeSize(flow.dimensions_ * textureScaling);
+    const tgt::ivec2 sliceSize(volumeSize[i], volumeSize[j]);
+    float* pixels = new float[sliceSize.x * sliceSize.y];
+
+    tgt::ivec3 voxelPos(0, 0, 0);
+    voxelPos[k] = tgt::clamp(static_cast<int>(sliceNo) * textureScaling, 0, volumeSize[k] - 1);
+    for (int y = 0; y < sliceSize.y; ++y) {
+        voxelPos[j] = y;
+        for (int x = 0; x < sliceSize.x; ++x) {
+            voxelPos[i] = x;
+            size_t voxel = (voxelPos.z * volumeSize.y + voxelPos.y) * volumeSize.x + voxelPos.x;
+            pixels[(y * sliceSize.x) + x] = licVolume_[voxel];
+        }
+    }
+    return pixels;
+}
+
+float* FlowSliceRenderer::lookupFlowTexture(const FlowTextureKey& key) {
+    std::map<FlowTextureKey, std::vector<float> >::const_iterator it = flowTextureCache_.find(key);
+    if (it == flowTextureCache_.end())
+        return 0;
+
+    // mark the texture as most recently used
+    //
+    for (std::list<FlowTextureKey>::iterator itOrder = flowTextureCacheOrder_.begin();
+        itOrder != flowTextureCacheOrder_.end(); ++itOrder)
+    {
+        if (!(key < *itOrder) && !(*itOrder < key)) {
+            flowTextureCacheOrder_.splice(flowTextureCacheOrder_.begin(), flowTextureCacheOrder_, itOrder);
+            break;
+        }
+    }
+
+    const std::vector<float>& cached = it->second;
+    float* pixels = new float[cached.size()];
+    std::copy(cached.begin(), cached.end(), pixels);
+    return pixels;
+}
+
+void FlowSliceRenderer::cacheFlowTexture(const FlowTextureKey& key, const float* pixels,
+                                         const size_t numPixels)
+{
+    if ((pixels == 0) || (flowTextureCacheSizeProp_.get() <= 0))
+        return;
+
+    if (flowTextureCache_.find(key) == flowTextureCache_.end())
+        flowTextureCacheOrder_.push_front(key);
+    flowTextureCache_[key] = std::vector<float>(pixels, pixels + numPixels);
+
+    onFlowTextureCacheSizeChange();
+}
+
+void FlowSliceRenderer::onFlowTextureCacheSizeChange() {
+    const size_t maxSize = static_cast<size_t>(std::max(flowTextureCacheSizeProp_.get(), 0));
+    while (flowTextureCacheOrder_.size() > maxSize) {
+        flowTextureCache_.erase(flowTextureCacheOrder_.back());
+        flowTextureCacheOrder_.pop_back();
+    }
+}
+
 float* FlowSliceRenderer::integrateDraw(const Flow3D& flow, const size_t sliceNo, const int textureScaling)
 {
     const tgt::ivec2 sliceSize = flow.getFlowSliceDimensions(permutation_);
@@ -1066,7 +1258,7 @@ void FlowSliceRenderer::renderSpotMesh(const size_t tesselation) {
 }
 
 void FlowSliceRenderer::toggleProperties() {
-    const size_t numProps = 15;
+    const size_t numProps = 16;
     OptionProperty<ColorCodingAbility::ColorCodingMode>& colorCodingModeProp =
         colorCoding_.getColorCodingModeProp();
     IntOptionProperty& colorTableProp = colorCoding_.getColorTableProp();
@@ -1086,7 +1278,8 @@ void FlowSliceRenderer::toggleProperties() {
         &arrowSpacingProp_,         // 11
         &maxStreamlineLengthProp_,  // 12
         &thresholdProp_,            // 13
-        &colorProp                  // 14
+        &colorProp,                 // 14
+        &flowTextureCacheSizeProp_  // 15
     };
 
     bool isVisible[numProps] = {false};
@@ -1108,6 +1301,7 @@ void FlowSliceRenderer::toggleProperties() {
             break;
         case TECHNIQUE_FAST_LIC:
         case TECHNIQUE_FAST_LIC_PROJECTED:
+        case TECHNIQUE_FAST_LIC_VOLUME:
             isVisible[7] = true;
             isVisible[8] = true;    // no break here!
         case TECHNIQUE_INTEGRATE_DRAW:
@@ -1115,6 +1309,7 @@ void FlowSliceRenderer::toggleProperties() {
             isVisible[9] = true;
             isVisible[12] = true;
             isVisible[13] = true;
+            isVisible[15] = true;
             break;
         case TECHNIQUE_ARROW_PLOT_RAND:
             isVisible[2] = true;
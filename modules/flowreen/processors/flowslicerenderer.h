@@ -39,6 +39,9 @@
 #include "voreen/core/properties/boolproperty.h"
 #include "voreen/core/properties/optionproperty.h"
 
+#include <list>
+#include <map>
+
 namespace tgt { class Texture; }
 
 namespace voreen {
@@ -77,7 +80,8 @@ protected:
         TECHNIQUE_INTEGRATE_DRAW_PROJECTED,
         TECHNIQUE_FAST_LIC_PROJECTED,
         TECHNIQUE_SPOTNOISE_PROJECTED,
-        TECHNIQUE_SPOTNOISE
+        TECHNIQUE_SPOTNOISE,
+        TECHNIQUE_FAST_LIC_VOLUME
     };
 
     enum TextureZoom {
@@ -90,6 +94,26 @@ protected:
 
     typedef unsigned char BYTE;
 
+    /**
+     * Identifies a texture generated by <code>renderFlowTexture()</code> by
+     * all parameters the result depends on. Used as key for the texture cache.
+     */
+    struct FlowTextureKey {
+        FlowTextureKey();
+
+        bool operator<(const FlowTextureKey& other) const;
+
+        const Flow3D* flow_;
+        int technique_;
+        tgt::ivec3 permutation_;
+        size_t sliceNo_;
+        int textureScaling_;
+        int kernelSize_;
+        int sampling_;
+        bool useAdaptiveKernelSize_;
+        tgt::vec2 thresholds_;
+    };
+
     static tgt::ivec3 getCoordinatePermutation(const SliceAlignment& alignment);
 
 protected:
@@ -234,6 +258,13 @@ protected:
         const tgt::vec2& textureSize, const tgt::vec2& viewportSize,
         const std::vector<RenderPort*>& tempPorts, const bool projected = false);
 
+    /**
+     * Removes all textures from the cache used by <code>renderFlowTexture()</code>
+     * and frees the FastLIC volume. This has to be called whenever the input
+     * flow changes.
+     */
+    void clearFlowTextureCache();
+
     /**
      * Initializes the texture stored in noiseTexture_ with white noise and
      * frees a previously stored one. Used by FastLIC.
@@ -278,6 +309,30 @@ private:
      */
     float* fastLIC(const Flow3D& flow, const size_t sliceNo, const int textureScaling);
 
+    /**
+     * Returns the image of the specified slice taken from a FastLIC volume of the
+     * entire flow. The volume is generated on first use and kept in licVolume_ as
+     * long as the parameters affecting it remain unchanged, so that subsequent
+     * slices are available immediately.
+     * The caller has to free the returned pointer by using delete [].
+     */
+    float* fastLICVolumeSlice(const Flow3D& flow, const size_t sliceNo, const int textureScaling,
+        const tgt::vec2& thresholds);
+
+    /**
+     * Returns a copy of the cached texture for the given key or NULL if
+     * the cache does not contain it.
+     */
+    float* lookupFlowTexture(const FlowTextureKey& key);
+
+    /**
+     * Copies the given pixels into the cache and evicts the least recently
+     * used textures exceeding the cache size.
+     */
+    void cacheFlowTexture(const FlowTextureKey& key, const float* pixels, const size_t numPixels);
+
+    void onFlowTextureCacheSizeChange();
+
     /**
      * Calculates and returns the initial intensity by evaluating a convolution
      * integral for projected FastLIC.
@@ -373,6 +428,7 @@ protected:
     IntProperty pixelSamplingProp_;
     IntProperty arrowSizeProp_;
     IntProperty arrowSpacingProp_;
+    IntProperty flowTextureCacheSizeProp_;  /** max. number of slice textures held by the texture cache */
 
     ColorCodingAbility colorCoding_;
     TextureZoom zoom_;
@@ -387,6 +443,13 @@ protected:
     bool rebuildTexture_;           /** indicates whether the texture containing the slice image needs to be rebuilt. */
     GLuint arrowList_;
 
+    /** cache for textures generated by Integrate & Draw and FastLIC, most recently used first */
+    std::map<FlowTextureKey, std::vector<float> > flowTextureCache_;
+    std::list<FlowTextureKey> flowTextureCacheOrder_;
+
+    float* licVolume_;              /** FastLIC volume of the entire flow used by volume FastLIC */
+    FlowTextureKey licVolumeKey_;   /** parameters licVolume_ has been generated with */
+
     VolumePort volInport_;
     RenderPort imgOutport_;
     RenderPort privatePort1_;
@@ -86,6 +86,7 @@ void FlowSliceRenderer2D::process() {
 
     if (handleChanged == true) {
         updateNumSlices();  // validate the currently set values and adjust them if necessary
+        clearFlowTextureCache();
         rebuildTexture_ = true;
     }
 
@@ -51,6 +51,12 @@ FlowSliceRenderer3D::FlowSliceRenderer3D()
 {
     zoom_ = FlowSliceRenderer::ZOOM_1X;
 
+    // FastLIC on a volume generated once for the entire flow, so that moving the
+    // slices does not require any further LIC computations
+    //
+    techniqueProp_->addOption("fast LIC (volume)", "fast LIC (volume)",
+        TECHNIQUE_FAST_LIC_VOLUME);
+
     CallMemberAction<FlowSliceRenderer3D> invalidateXY(this,
         &FlowSliceRenderer3D::invalidateXYTexture);
     CallMemberAction<FlowSliceRenderer3D> invalidateXZ(this,
@@ -103,6 +109,7 @@ void FlowSliceRenderer3D::process() {
 
     if (handleChanged == true) {
         updateNumSlices();  // validate the currently set values and adjust them if necessary
+        clearFlowTextureCache();
         rebuildTexture_ = true;
     }
 
@@ -244,6 +251,7 @@ void FlowSliceRenderer3D::renderSlice(const Flow3D& flow3D, const float sliceNo,
             case TECHNIQUE_FAST_LIC:
             case TECHNIQUE_INTEGRATE_DRAW_PROJECTED:
             case TECHNIQUE_FAST_LIC_PROJECTED:
+            case TECHNIQUE_FAST_LIC_VOLUME:
                 *textureAddr = renderFlowTexture(flow3D, static_cast<size_t>(sliceNo), 1,
                     techniqueProp_->getValue(), thresholds);
                 break;
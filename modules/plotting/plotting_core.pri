@@ -52,8 +52,11 @@ SOURCES += \
     $${VRN_MODULE_DIR}/plotting/utils/plotbase.cpp \
     $${VRN_MODULE_DIR}/plotting/utils/plotentitysettings.cpp \
     $${VRN_MODULE_DIR}/plotting/utils/plotdata.cpp \
+    $${VRN_MODULE_DIR}/plotting/utils/plotdatacsvreader.cpp \
     $${VRN_MODULE_DIR}/plotting/utils/plotdatainserter.cpp \
+    $${VRN_MODULE_DIR}/plotting/utils/plotdecimator.cpp \
     $${VRN_MODULE_DIR}/plotting/utils/plotcell.cpp \
+    $${VRN_MODULE_DIR}/plotting/utils/plotcolumn.cpp \
     $${VRN_MODULE_DIR}/plotting/utils/plotfunction.cpp \
     $${VRN_MODULE_DIR}/plotting/utils/plotlibrarylatex.cpp \
     $${VRN_MODULE_DIR}/plotting/utils/plotlibrarylatexrender.cpp \
@@ -135,8 +138,11 @@ HEADERS += \
     $${VRN_MODULE_DIR}/plotting/utils/functionlibrary.h \
     $${VRN_MODULE_DIR}/plotting/utils/plotbase.h \
     $${VRN_MODULE_DIR}/plotting/utils/plotcell.h \
+    $${VRN_MODULE_DIR}/plotting/utils/plotcolumn.h \
     $${VRN_MODULE_DIR}/plotting/utils/plotdata.h \
+    $${VRN_MODULE_DIR}/plotting/utils/plotdatacsvreader.h \
     $${VRN_MODULE_DIR}/plotting/utils/plotdatainserter.h \
+    $${VRN_MODULE_DIR}/plotting/utils/plotdecimator.h \
     $${VRN_MODULE_DIR}/plotting/utils/plotfunction.h \
     $${VRN_MODULE_DIR}/plotting/utils/plotlibrarylatex.h \
     $${VRN_MODULE_DIR}/plotting/utils/plotlibrarylatexrender.h \
@@ -62,8 +62,6 @@ protected:
 private:
     void recalculate();
     PlotData* readCSVData();
-    void csvline_populate(std::vector<std::string> &record, const std::string& line);
-    std::string trimString(const std::string& oldString);
 
     PlotPort outPort_;
 
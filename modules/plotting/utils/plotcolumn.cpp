@@ -0,0 +1,102 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#include "plotcolumn.h"
+#include "plotcell.h"
+
+#include <limits>
+
+namespace voreen {
+
+PlotColumn::PlotColumn()
+{}
+
+void PlotColumn::clear() {
+    values_.clear();
+    cellTypes_.clear();
+    tagCodes_.clear();
+    dictionary_.clear();
+    dictionaryCodes_.clear();
+}
+
+void PlotColumn::reserve(size_t count) {
+    values_.reserve(count);
+    cellTypes_.reserve(count);
+    tagCodes_.reserve(count);
+}
+
+void PlotColumn::append(const PlotCellValue& cell) {
+    if (cell.isValue()) {
+        values_.push_back(cell.getValue());
+        cellTypes_.push_back(VALUE_CELL);
+        tagCodes_.push_back(-1);
+    }
+    else if (cell.isTag()) {
+        std::string tag = cell.getTag();
+        std::map<std::string, int>::const_iterator it = dictionaryCodes_.find(tag);
+        int code;
+        if (it == dictionaryCodes_.end()) {
+            code = static_cast<int>(dictionary_.size());
+            dictionary_.push_back(tag);
+            dictionaryCodes_.insert(std::make_pair(tag, code));
+        }
+        else
+            code = it->second;
+
+        values_.push_back(std::numeric_limits<plot_t>::quiet_NaN());
+        cellTypes_.push_back(TAG_CELL);
+        tagCodes_.push_back(code);
+    }
+    else {
+        values_.push_back(std::numeric_limits<plot_t>::quiet_NaN());
+        cellTypes_.push_back(EMPTY_CELL);
+        tagCodes_.push_back(-1);
+    }
+}
+
+size_t PlotColumn::size() const {
+    return values_.size();
+}
+
+const std::vector<plot_t>& PlotColumn::getValues() const {
+    return values_;
+}
+
+const std::vector<char>& PlotColumn::getCellTypes() const {
+    return cellTypes_;
+}
+
+const std::vector<int>& PlotColumn::getTagCodes() const {
+    return tagCodes_;
+}
+
+const std::vector<std::string>& PlotColumn::getDictionary() const {
+    return dictionary_;
+}
+
+} // namespace voreen
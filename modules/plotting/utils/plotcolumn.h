@@ -0,0 +1,99 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef VRN_PLOTCOLUMN_H
+#define VRN_PLOTCOLUMN_H
+
+#include "plotbase.h"
+#include "modules/plotting/plottingmoduledefine.h"
+
+#include <vector>
+#include <map>
+#include <string>
+
+namespace voreen {
+
+class PlotCellValue;
+
+/**
+ * \brief   Contiguous, column-wise copy of the cells of one PlotData column.
+ *
+ * Numeric values are stored in one plain plot_t array (NaN for cells not holding a value), tags
+ * are dictionary-encoded: each distinct tag is stored only once and the cells refer to it by
+ * an integer code. This layout allows predicates and aggregations to run in tight loops over
+ * contiguous memory instead of walking through PlotRowValue objects.
+ *
+ * \note    PlotColumns are derived from the rows by PlotData::getColumn() and not updated afterwards,
+ *          they do not know about highlighting.
+ **/
+class VRN_MODULE_PLOTTING_API PlotColumn {
+public:
+    /// type of the content of a single cell
+    enum CellType {
+        EMPTY_CELL = 0,
+        VALUE_CELL = 1,
+        TAG_CELL = 2
+    };
+
+    PlotColumn();
+
+    /// removes all cells and tags
+    void clear();
+
+    /// reserves memory for \a count cells
+    void reserve(size_t count);
+
+    /// appends the content of \a cell
+    void append(const PlotCellValue& cell);
+
+    /// Returns the number of cells in this column.
+    size_t size() const;
+
+    /// Returns the values of all cells, cells not holding a value are NaN.
+    const std::vector<plot_t>& getValues() const;
+
+    /// Returns the CellType of all cells.
+    const std::vector<char>& getCellTypes() const;
+
+    /// Returns the dictionary code of the tag of all cells, cells not holding a tag are -1.
+    const std::vector<int>& getTagCodes() const;
+
+    /// Returns all distinct tags of this column in order of their first occurrence, indexed by their code.
+    const std::vector<std::string>& getDictionary() const;
+
+private:
+    std::vector<plot_t> values_;                ///< values of all cells
+    std::vector<char> cellTypes_;               ///< CellType of all cells
+    std::vector<int> tagCodes_;                 ///< dictionary codes of all cells
+    std::vector<std::string> dictionary_;       ///< distinct tags
+    std::map<std::string, int> dictionaryCodes_; ///< maps each distinct tag to its code
+};
+
+} // namespace voreen
+
+#endif // VRN_PLOTCOLUMN_H
@@ -33,6 +33,7 @@
 
 #include "tgt/assert.h"
 #include "tgt/logmanager.h"
+#include "tgt/mutex.h"
 
 #include <map>
 #include <vector>
@@ -42,8 +43,36 @@
 
 namespace voreen {
 
+namespace {
+    // number of values a PlotPredicate checks in one call of checkValues()
+    const int PREDICATE_CHUNK_SIZE = 4096;
+
+    // returns a version not assigned to any PlotData before, PlotData may be modified by several threads
+    unsigned long nextPlotDataVersion() {
+        static tgt::Mutex mutex;
+        static unsigned long lastVersion = 0;
+        tgt::MutexLock lock(mutex);
+        return ++lastVersion;
+    }
+
+    // inserts a row of \a groupCell and the aggregated values of the group into \a target
+    void insertGroupRow(PlotData& target, const PlotCellValue& groupCell, const plot_t* aggregatedValues, int funcCount) {
+        std::vector<PlotCellValue> cells;
+        cells.push_back(groupCell);
+        for (int i = 0; i < funcCount; ++i) {
+            plot_t val = aggregatedValues[i];
+            if (val != val)
+                cells.push_back(PlotCellValue());
+            else
+                cells.push_back(PlotCellValue(val));
+        }
+        target.insert(cells);
+    }
+}
+
 PlotData::PlotData(int keyColumnCount, int dataColumnCount)
     : PlotBase(keyColumnCount, dataColumnCount)
+    , version_(nextPlotDataVersion())
 {
     intervals_.resize(keyColumnCount_ + dataColumnCount_);
 }
@@ -53,6 +82,7 @@ PlotData::PlotData(const PlotData& rhs)
     , rows_(rhs.rows_)
     , intervals_(rhs.intervals_)
     , sorted_(rhs.sorted_)
+    , version_(nextPlotDataVersion())
 {
     for (std::vector<PlotRowValue>::iterator it = rows_.begin(); it < rows_.end(); ++it) {
         it->parent_ = this;
@@ -86,6 +116,7 @@ PlotData& PlotData::operator=(const PlotData& rhs) {
         intervals_ = rhs.intervals_;
         sorted_ = rhs.sorted_;
         highlightedCells_.clear();
+        updateVersion();
 
         for (std::vector<PlotRowValue>::iterator it = rows_.begin(); it < rows_.end(); ++it) {
             it->parent_ = this;
@@ -107,6 +138,7 @@ PlotData& PlotData::operator=(const PlotData& rhs) {
         implicitRows_.clear();
         intervals_.clear();
         highlightedCells_.clear();
+        updateVersion();
         LERRORC("PlotData::operator=()", "bad_alloc occured, object won't contain any data!");
         return *this;
     }
@@ -117,6 +149,7 @@ PlotData& PlotData::operator=(const PlotData& rhs) {
         implicitRows_.clear();
         intervals_.clear();
         highlightedCells_.clear();
+        updateVersion();
         LERRORC("PlotData::operator=()", "unknown exception occured, object won't contain any data!");
         return *this;
     }
@@ -127,19 +160,11 @@ PlotData& PlotData::operator=(const PlotData& rhs) {
 void PlotData::select(const std::vector< std::pair< int, PlotPredicate*> >& predicates, PlotData& target) const {
     target.reset(keyColumnCount_, dataColumnCount_);
 
-    std::vector<PlotRowValue>::const_iterator rit;
-    bool matches;
-    for (rit = rows_.begin(); rit < rows_.end(); ++rit) {
-        matches = true;
-        for (size_t i = 0; i < predicates.size(); ++i) {
-            if (!predicates.at(i).second->check(rit->getCellAt(predicates.at(i).first))) {
-                matches = false;
-                break;
-            }
-        }
-        if (matches) {
-            target.insert(rit->getCells());
-        }
+    std::vector<char> mask;
+    evaluatePredicates(predicates, true, mask);
+    for (size_t i = 0; i < rows_.size(); ++i) {
+        if (mask[i])
+            target.insert(rows_[i].getCells());
     }
     for (int i = 0; i < getColumnCount(); ++i) {
         target.setColumnLabel(i,getColumnLabel(i));
@@ -188,25 +213,20 @@ void PlotData::select(const std::vector< int >& columns, int keyColumnCount, int
     if (columns.size() != 0) {
         columnCount = keyColumnCount + dataColumnCount;
 
+        std::vector<char> mask;
+        evaluatePredicates(predicates, true, mask);
+
         std::vector<PlotRowValue>::const_iterator it;
-        std::vector<std::pair<int, PlotPredicate*> >::const_iterator pit;
-        bool matches;
         int i;
-        for (it = rows_.begin(); it < rows_.end(); ++it) {
+        size_t row = 0;
+        for (it = rows_.begin(); it < rows_.end(); ++it, ++row) {
+            if (!mask[row])
+                continue;
             std::vector<PlotCellValue> cellsToInsert;
-            matches = true;
-            for (pit = predicates.begin(); pit < predicates.end(); ++pit) {
-                if (! pit->second->check(it->getCellAt(pit->first))) {
-                    matches = false;
-                    break;
-                }
-            }
-            if (matches) {
-                for (i=0; i< columnCount; ++i) {
-                    cellsToInsert.push_back(it->getCellAt(columns[i]));
-                }
-                target.insert(cellsToInsert);
+            for (i=0; i< columnCount; ++i) {
+                cellsToInsert.push_back(it->getCellAt(columns[i]));
             }
+            target.insert(cellsToInsert);
         }
         for (i = 0; i < columnCount; ++i) {
             target.setColumnLabel(i,getColumnLabel(columns[i]));
@@ -229,20 +249,18 @@ void PlotData::select(const std::vector<int>& columns, const std::vector<int>& r
     if (columns.size() != 0) {
         columnCount = keyColumnCount + dataColumnCount;
 
+        // mark the requested rows once instead of searching \a rows for each row
+        std::vector<char> selected(rows_.size(), 0);
+        for (size_t j = 0; j < rows.size(); ++j) {
+            if (rows[j] >= 0 && rows[j] < static_cast<int>(rows_.size()))
+                selected[rows[j]] = 1;
+        }
+
         std::vector<PlotRowValue>::const_iterator it;
         int i;
-        int zaehler = 0;
-        bool match;
-        for (it = rows_.begin(); it < rows_.end(); ++it) {
-            match = false;
-            for (size_t j = 0; j < rows.size(); ++j) {
-                if (zaehler == rows.at(j)) {
-                    match = true;
-                    break;
-                }
-            }
-            ++zaehler;
-            if (!match)
+        size_t row = 0;
+        for (it = rows_.begin(); it < rows_.end(); ++it, ++row) {
+            if (!selected[row])
                 continue;
             std::vector<PlotCellValue> cellsToInsert;
 
@@ -267,11 +285,11 @@ void PlotData::select(const std::vector<int>& columns, const std::vector<int>& r
 }
 
 plot_t PlotData::aggregate(int column, const AggregationFunction* function) const {
+    // the AggregationFunction may reorder the values, so we hand over a copy of the column
     std::vector<plot_t> values;
-    std::vector<PlotRowValue>::const_iterator it;
-    for (it = rows_.begin(); it < rows_.end(); ++it) {
-        values.push_back(it->getValueAt(column));
-    }
+    values.reserve(rows_.size());
+    for (std::vector<PlotRowValue>::const_iterator it = rows_.begin(); it < rows_.end(); ++it)
+        values.push_back(it->cells_[column].isValue() ? it->cells_[column].getValue() : std::numeric_limits<plot_t>::quiet_NaN());
 
     plot_t toReturn = function->evaluate(values);
     return toReturn;
@@ -312,6 +330,7 @@ bool PlotData::insert(const std::vector<plot_t>& values) {
         sorted_ = false;
         rows_.push_back(PlotRowValue(this, cellsToInsert));
         updateIntervals(rows_.back());
+        updateVersion();
         return true;
     }
     return false;
@@ -354,6 +373,7 @@ bool PlotData::insert(std::vector<std::pair<int, plot_t> >& values) {
         sorted_ = false;
         rows_.push_back(PlotRowValue(this, cellsToInsert));
         updateIntervals(rows_.back());
+        updateVersion();
         return true;
     }
     return false;
@@ -388,6 +408,7 @@ bool PlotData::insert(const std::vector<std::string>& tags) {
         sorted_ = false;
         rows_.push_back(PlotRowValue(this, cellsToInsert));
         updateIntervals(rows_.back());
+        updateVersion();
         return true;
     }
     return false;
@@ -424,6 +445,7 @@ bool PlotData::insert(const std::vector<std::pair<int, std::string> >& tags) {
         sorted_ = false;
         rows_.push_back(PlotRowValue(this, cellsToInsert));
         updateIntervals(rows_.back());
+        updateVersion();
         return true;
     }
     return false;
@@ -468,6 +490,7 @@ bool PlotData::insert(const std::vector< PlotCellValue >& cells) {
         sorted_ = false;
         rows_.push_back(PlotRowValue(this, newcells));
         updateIntervals(rows_.back());
+        updateVersion();
         return true;
     }
     return false;
@@ -508,6 +531,7 @@ bool PlotData::insert(std::vector< PlotCellValue >& cells) {
         sorted_ = false;
         rows_.push_back(PlotRowValue(this, cells));
         updateIntervals(rows_.back());
+        updateVersion();
         return true;
     }
     return false;
@@ -554,6 +578,7 @@ bool PlotData::insert(const std::vector< std::pair<int, PlotCellValue > >& cells
     sorted_ = false;
     rows_.push_back(PlotRowValue(this, cellsToInsert));
     updateIntervals(rows_.back());
+    updateVersion();
     return true;
     }
     return false;
@@ -566,26 +591,35 @@ std::vector<PlotRowValue>::const_iterator PlotData::lower_bound(const std::vecto
 }
 
 int PlotData::remove(const std::vector<std::pair<int, PlotPredicate*> >& predicates) {
-    std::vector<PlotRowValue>::iterator rit;
-    std::vector<std::pair<int, PlotPredicate*> >::const_iterator pit;
+    std::vector<char> mask;
+    evaluatePredicates(predicates, false, mask);
 
     int count = 0;
-    bool matched;
-    rit = rows_.begin();
-    while (rit < rows_.end()) {
-        matched = false;
-        for (pit = predicates.begin(); pit < predicates.end(); ++pit)
-            if (pit->second->check(rit->getCellAt(pit->first))) {
-                matched = true;
-                break;
-            }
-        if (matched) {
-            removePointersToCellsOfRow(*rit);
-            rit = rows_.erase(rit);
+    for (size_t i = 0; i < mask.size(); ++i) {
+        if (mask[i])
             ++count;
-        }
-        else {
-            ++rit;
+    }
+    if (count == 0)
+        return 0;
+
+    // compact rows_ in one pass - as this moves the remaining rows, all pointers in
+    // highlightedCells_ have to be collected again afterwards
+    highlightedCells_.clear();
+    size_t next = 0;
+    for (size_t i = 0; i < rows_.size(); ++i) {
+        if (mask[i])
+            continue;
+        if (next != i)
+            rows_[next] = rows_[i];
+        ++next;
+    }
+    rows_.erase(rows_.begin() + next, rows_.end());
+    updateVersion();
+
+    for (std::vector<PlotRowValue>::iterator it = rows_.begin(); it < rows_.end(); ++it) {
+        for (std::vector<PlotCellValue>::iterator cit = it->cells_.begin(); cit != it->cells_.end(); ++cit) {
+            if (cit->isHighlighted())
+                highlightedCells_.insert(&(*cit));
         }
     }
 
@@ -641,154 +675,84 @@ bool PlotData::groupBy(int groupColumn, const std::vector<std::pair<int, Aggrega
 
     target.reset(1, static_cast<int>(functions.size()));
 
-    // we will sort and group the data into hashmaps before applying the AggregationFunctions to them
-    std::map<plot_t, std::vector<plot_t>*> groupedByValues;
-    std::map<std::string, std::vector<plot_t>*> groupedByTags;
-    std::map<bool, std::vector<plot_t>*> groupedByNulls;
-
-    std::map<plot_t, std::vector<plot_t>*>::iterator gbvIt;
-    std::map<std::string, std::vector<plot_t>*>::iterator gbtIt;
-    std::map<bool, std::vector<plot_t>*>::iterator gbnIt;
-    // alright, we will start with grouping the data in our hashmaps
-    int funcCount = static_cast<int>(functions.size());
-    std::vector<PlotRowValue>::const_iterator rowIt;
-    for (rowIt = rows_.begin(); rowIt != rows_.end(); ++rowIt) {
-        const PlotCellValue& groupedCell = rowIt->getCellAt(groupColumn);
-
-        // check whether to group by value or by tag - here we group by value
-        if (groupedCell.isValue()) {
-            // check if the data in this cell is already in the hashmap -> a group for it already exists
-            gbvIt = groupedByValues.find(groupedCell.getValue());
-
-            // it is not in the hashmap -> create new group
-            if (gbvIt == groupedByValues.end()) {
-                // first we create an array of vector of plot_t where we will store the data which shall be aggregated:
-                std::vector<plot_t>* temp = new std::vector<plot_t>[funcCount]();
-                for (int i=0; i< funcCount; ++i) {
-                    temp[i].push_back(rowIt->getValueAt(functions[i].first));
-                }
-                groupedByValues.insert(std::pair<plot_t, std::vector<plot_t>*>(groupedCell.getValue(), temp));
-            }
-            // there is already an entry in the hashmap, so just push the values into the vector which shall be aggregated
-            else {
-                std::vector<plot_t>* temp = gbvIt->second;
-                for (int i=0; i< funcCount; ++i) {
-                    temp[i].push_back(rowIt->getValueAt(functions[i].first));
-                }
-            }
+    const int funcCount = static_cast<int>(functions.size());
+    const int rowCount = static_cast<int>(rows_.size());
+    PlotColumn groupCells;
+    getColumn(groupColumn, groupCells);
+    const std::vector<char>& cellTypes = groupCells.getCellTypes();
+    const std::vector<int>& tagCodes = groupCells.getTagCodes();
+    const std::vector<std::string>& dictionary = groupCells.getDictionary();
+
+    // assign a group index to each row: tags are grouped by their dictionary code, distinct
+    // values are looked up in a map, all null cells form a single group
+    std::map<plot_t, int> valueGroups;
+    std::vector<int> tagGroups(dictionary.size(), -1);
+    int nullGroup = -1;
+    int groupCount = 0;
+    std::vector<int> rowGroups(rowCount);
+    std::vector<int> groupSizes;
+    for (int row = 0; row < rowCount; ++row) {
+        int group;
+        if (cellTypes[row] == PlotColumn::VALUE_CELL) {
+            std::pair<std::map<plot_t, int>::iterator, bool> result =
+                valueGroups.insert(std::make_pair(groupCells.getValues()[row], groupCount));
+            group = result.first->second;
         }
-        else if(groupedCell.isNull()) {
-            gbnIt = groupedByNulls.find(groupedCell.isNull());
-            if (gbnIt == groupedByNulls.end()) {
-                // first we create an array of vector of plot_t where we will store the data which shall be aggregated:
-                std::vector<plot_t>* temp = new std::vector<plot_t>[funcCount];
-                for (int i=0; i< funcCount; ++i) {
-                    temp[i].push_back(rowIt->getValueAt(functions[i].first));
-                }
-                groupedByNulls.insert(std::pair<bool, std::vector<plot_t>*>(groupedCell.isNull(), temp));
-            }
-            // there is already an entry in the hashmap, so just push the values into the vector which shall be aggregated
-            else {
-                std::vector<plot_t>* temp = gbnIt->second;
-                for (int i=0; i< funcCount; ++i) {
-                    temp[i].push_back(rowIt->getValueAt(functions[i].first));
-                }
-            }
+        else if (cellTypes[row] == PlotColumn::TAG_CELL) {
+            int& tagGroup = tagGroups[tagCodes[row]];
+            if (tagGroup < 0)
+                tagGroup = groupCount;
+            group = tagGroup;
         }
-        // ok, we group by tag
         else {
-            // check if the data in this cell is already in the hashmap -> a group for it already exists
-            gbtIt = groupedByTags.find(groupedCell.getTag());
-
-            // it is not in the hashmap -> create new group
-            if (gbtIt == groupedByTags.end()) {
-                // first we create an array of vector of plot_t where we will store the data which shall be aggregated:
-                std::vector<plot_t>* temp = new std::vector<plot_t>[funcCount];
-                for (int i=0; i< funcCount; ++i) {
-                    temp[i].push_back(rowIt->getValueAt(functions[i].first));
-                }
-                groupedByTags.insert(std::pair<std::string, std::vector<plot_t>*>(groupedCell.getTag(), temp));
-            }
-            // there is already an entry in the hashmap, so just push the values into the vector which shall be aggregated
-            else {
-                std::vector<plot_t>* temp = gbtIt->second;
-                for (int i=0; i< funcCount; ++i) {
-                    temp[i].push_back(rowIt->getValueAt(functions[i].first));
-                }
-            }
+            if (nullGroup < 0)
+                nullGroup = groupCount;
+            group = nullGroup;
         }
-    }
-
-    // grouping is done, now, we will insert the grouped data into the target PlotData
-    // first insert all groupedByValues rows
-    for (gbvIt = groupedByValues.begin(); gbvIt != groupedByValues.end(); ++gbvIt) {
-        std::vector<PlotCellValue> cells;
-        cells.push_back(PlotCellValue(gbvIt->first));
-
-        for (int i=0; i<funcCount; ++i) {
-            plot_t val = functions[i].second->evaluate(gbvIt->second[i]);
-            if (val != val){
-                cells.push_back(PlotCellValue());
-            }
-            else {
-                cells.push_back(PlotCellValue(functions[i].second->evaluate(gbvIt->second[i])));
-            }
+        if (group == groupCount) {
+            ++groupCount;
+            groupSizes.push_back(0);
         }
-
-        target.insert(cells);
+        rowGroups[row] = group;
+        ++groupSizes[group];
     }
 
-    // now insert all groupedByTags rows
-    for (gbtIt = groupedByTags.begin(); gbtIt != groupedByTags.end(); ++gbtIt) {
-        std::vector<PlotCellValue> cells;
-        cells.push_back(PlotCellValue(gbtIt->first));
-
-        for (int i=0; i<funcCount; ++i) {
-            plot_t val = functions[i].second->evaluate(gbtIt->second[i]);
-            if (val != val){
-                cells.push_back(PlotCellValue());
-            }
-            else {
-                cells.push_back(PlotCellValue(functions[i].second->evaluate(gbtIt->second[i])));
-            }
-        }
-
-        target.insert(cells);
+    // gather the values to aggregate group-wise from the contiguous columns
+    std::vector< std::vector<plot_t> > groupedValues(groupCount * funcCount);
+    PlotColumn valueCells;
+    for (int i = 0; i < funcCount; ++i) {
+        getColumn(functions[i].first, valueCells);
+        const std::vector<plot_t>& values = valueCells.getValues();
+        for (int group = 0; group < groupCount; ++group)
+            groupedValues[group * funcCount + i].reserve(groupSizes[group]);
+        for (int row = 0; row < rowCount; ++row)
+            groupedValues[rowGroups[row] * funcCount + i].push_back(values[row]);
     }
-        // now insert all groupedByNulls rows
-    for (gbnIt = groupedByNulls.begin(); gbnIt != groupedByNulls.end(); ++gbnIt) {
-        std::vector<PlotCellValue> cells;
-        cells.push_back(PlotCellValue());
 
-        for (int i=0; i<funcCount; ++i) {
-            plot_t val = functions[i].second->evaluate(gbnIt->second[i]);
-            if (val != val){
-                cells.push_back(PlotCellValue());
-            }
-            else {
-                cells.push_back(PlotCellValue(functions[i].second->evaluate(gbnIt->second[i])));
-            }
-        }
-
-        target.insert(cells);
+    // the groups are independent of each other, so they can be aggregated in parallel
+    std::vector<plot_t> aggregated(groupCount * funcCount);
+    const int aggregationCount = groupCount * funcCount;
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic)
+    #endif
+    for (int i = 0; i < aggregationCount; ++i)
+        aggregated[i] = functions[i % funcCount].second->evaluate(groupedValues[i]);
+
+    // insert the grouped data into the target PlotData: first values, then tags (both sorted), then nulls
+    for (std::map<plot_t, int>::const_iterator it = valueGroups.begin(); it != valueGroups.end(); ++it)
+        insertGroupRow(target, PlotCellValue(it->first), funcCount > 0 ? &aggregated[it->second * funcCount] : 0, funcCount);
+
+    std::vector<std::pair<std::string, int> > sortedTags;
+    for (size_t code = 0; code < dictionary.size(); ++code) {
+        if (tagGroups[code] >= 0)
+            sortedTags.push_back(std::make_pair(dictionary[code], tagGroups[code]));
     }
+    std::sort(sortedTags.begin(), sortedTags.end());
+    for (std::vector<std::pair<std::string, int> >::const_iterator it = sortedTags.begin(); it != sortedTags.end(); ++it)
+        insertGroupRow(target, PlotCellValue(it->first), funcCount > 0 ? &aggregated[it->second * funcCount] : 0, funcCount);
 
-    // finally free all data which is not necessary anymore:
-    while (groupedByValues.size() > 0) {
-        gbvIt = groupedByValues.begin();
-        delete [] gbvIt->second;
-        groupedByValues.erase(gbvIt);
-    }
-    while (groupedByTags.size() > 0) {
-        gbtIt = groupedByTags.begin();
-        delete [] gbtIt->second;
-        groupedByTags.erase(gbtIt);
-    }
-    while (groupedByNulls.size() > 0) {
-        gbnIt = groupedByNulls.begin();
-        delete [] gbnIt->second;
-        groupedByNulls.erase(gbnIt);
-    }
+    if (nullGroup >= 0)
+        insertGroupRow(target, PlotCellValue(), funcCount > 0 ? &aggregated[nullGroup * funcCount] : 0, funcCount);
 
     for (int i = 0; i < static_cast<int>(functions.size()); ++i) {
         target.setColumnLabel(i+1,getColumnLabel(functions.at(i).first));
@@ -1065,18 +1029,25 @@ Interval<plot_t> PlotData::getSumInterval(const std::vector< int >& column) cons
             numberColumn.push_back(*colIt);
     }
 
-    std::vector<PlotRowValue>::const_iterator rowIt = rows_.begin();
+    // accumulate the row sums column by column
+    const int rowCount = static_cast<int>(rows_.size());
+    std::vector<plot_t> sums(rowCount, 0);
+    PlotColumn col;
+    for (colIt = numberColumn.begin(); colIt < numberColumn.end(); ++colIt) {
+        getColumn(*colIt, col);
+        const std::vector<plot_t>& values = col.getValues();
+        const std::vector<char>& cellTypes = col.getCellTypes();
+        for (int row = 0; row < rowCount; ++row) {
+            if (cellTypes[row] != PlotColumn::EMPTY_CELL)
+                sums[row] += fabs(values[row]);
+        }
+    }
+
     plot_t min = 0;
     plot_t max = 0;
-
-    for ( ; rowIt < rows_.end(); ++rowIt) {
-        plot_t temp = 0;
-        for (colIt = numberColumn.begin(); colIt < numberColumn.end(); ++colIt) {
-            if (!rowIt->getCellAt(*colIt).isNull())
-                temp += fabs(rowIt->getValueAt(*colIt));
-        }
-        if (temp > max)
-            max = temp;
+    for (int row = 0; row < rowCount; ++row) {
+        if (sums[row] > max)
+            max = sums[row];
     }
 
     return Interval<plot_t>(min, max);
@@ -1119,6 +1090,18 @@ int PlotData::getImplicitRowsCount() const {
     return static_cast<int>(implicitRows_.size());
 }
 
+void PlotData::getColumn(int column, PlotColumn& target) const {
+    tgtAssert(column >= 0 && column < getColumnCount(), "PlotData::getColumn: column out of bounds.");
+    target.clear();
+    target.reserve(rows_.size());
+    for (std::vector<PlotRowValue>::const_iterator it = rows_.begin(); it < rows_.end(); ++it)
+        target.append(it->cells_[column]);
+}
+
+unsigned long PlotData::getVersion() const {
+    return version_;
+}
+
 bool PlotData::rowsEmpty() const {
     return rows_.empty();
 }
@@ -1243,12 +1226,28 @@ void PlotData::removePointersToCellsOfRow(PlotRowValue& row) {
     }
 }
 
+void PlotData::reserveRows(int rowCount) {
+    if (rowCount <= static_cast<int>(rows_.capacity()))
+        return;
+    rows_.reserve(rowCount);
+
+    // rows_ has been reallocated - all pointers in highlightedCells_ have to be collected again
+    highlightedCells_.clear();
+    for (std::vector<PlotRowValue>::iterator it = rows_.begin(); it < rows_.end(); ++it) {
+        for (std::vector<PlotCellValue>::iterator cit = it->cells_.begin(); cit != it->cells_.end(); ++cit) {
+            if (cit->isHighlighted())
+                highlightedCells_.insert(&(*cit));
+        }
+    }
+}
+
 void PlotData::reset(int keyColumnCount, int dataColumnCount) {
     highlightedCells_.clear();
     rows_.clear();
     deleteImplicitRows();
     implicitRows_.clear();
     intervals_.clear();
+    updateVersion();
     sorted_ = false;
     PlotBase::reset(keyColumnCount, dataColumnCount);
     intervals_.resize(getColumnCount());
@@ -1268,6 +1267,65 @@ void PlotData::updateIntervals(const PlotRowValue& row) {
     }
 }
 
+void PlotData::updateVersion() const {
+    version_ = nextPlotDataVersion();
+}
+
+void PlotData::evaluatePredicates(const std::vector<std::pair<int, PlotPredicate*> >& predicates, bool matchAll, std::vector<char>& mask) const {
+    const int rowCount = static_cast<int>(rows_.size());
+    mask.assign(rowCount, matchAll ? 1 : 0);
+    if (rowCount == 0)
+        return;
+
+    std::vector<char> results(rowCount);
+    std::vector<char> tagResults;
+    const int chunkCount = (rowCount + PREDICATE_CHUNK_SIZE - 1) / PREDICATE_CHUNK_SIZE;
+    PlotColumn column;
+    std::vector<std::pair<int, PlotPredicate*> >::const_iterator pit;
+    for (pit = predicates.begin(); pit < predicates.end(); ++pit) {
+        const PlotPredicate* predicate = pit->second;
+        getColumn(pit->first, column);
+
+        // tags and null cells need to be checked only once per distinct content
+        const std::vector<std::string>& dictionary = column.getDictionary();
+        tagResults.resize(dictionary.size());
+        for (size_t i = 0; i < dictionary.size(); ++i)
+            tagResults[i] = predicate->check(PlotCellValue(dictionary[i]));
+        const char nullResult = predicate->check(PlotCellValue());
+
+        // numeric values are checked in chunks
+        const plot_t* values = &column.getValues()[0];
+        #ifdef _OPENMP
+        #pragma omp parallel for
+        #endif
+        for (int chunk = 0; chunk < chunkCount; ++chunk) {
+            int first = chunk * PREDICATE_CHUNK_SIZE;
+            int count = std::min(PREDICATE_CHUNK_SIZE, rowCount - first);
+            predicate->checkValues(values + first, count, &results[first]);
+        }
+
+        const char* cellTypes = &column.getCellTypes()[0];
+        const int* tagCodes = &column.getTagCodes()[0];
+        #ifdef _OPENMP
+        #pragma omp parallel for
+        #endif
+        for (int row = 0; row < rowCount; ++row) {
+            char result;
+            if (cellTypes[row] == PlotColumn::VALUE_CELL)
+                result = results[row];
+            else if (cellTypes[row] == PlotColumn::TAG_CELL)
+                result = tagResults[tagCodes[row]];
+            else
+                result = nullResult;
+
+            if (matchAll)
+                mask[row] = mask[row] && result;
+            else
+                mask[row] = mask[row] || result;
+        }
+    }
+}
+
 void PlotData::sortRows() const {
     if (! sorted_ && rows_.size() > 0) {
         // in many cases the data is sorted by construction, so we check that
@@ -1287,6 +1345,7 @@ void PlotData::sortRows() const {
             // here to be allowed to call std::sort
             PlotData* foo = const_cast<PlotData*>(this);
             std::sort(foo->rows_.begin(), foo->rows_.end());
+            updateVersion();
             sorted_ = true;
         }
     }
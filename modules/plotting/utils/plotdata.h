@@ -30,6 +30,7 @@
 #define VRN_PLOTDATA_H
 
 #include "plotbase.h"
+#include "plotcolumn.h"
 #include "interval.h"
 
 #include <vector>
@@ -382,6 +383,23 @@ public:
     /// Returns the number of PlotRowImplicits in this PlotData.
     int getImplicitRowsCount() const;
 
+    /**
+     * \brief   Copies the cells of the column with index \a column into the columnar representation \a target.
+     *
+     * The rows are the only storage of this PlotData, PlotColumns are derived from them on demand
+     * and not kept. Bulk operations (select, remove, aggregate, groupBy) build the columns they
+     * need for the duration of the operation.
+     **/
+    void getColumn(int column, PlotColumn& target) const;
+
+    /**
+     * \brief   Returns a number identifying the current content of this PlotData.
+     *
+     * The version changes on each modification of the rows (including sorting) and is unique
+     * among all PlotData instances, so it can be used to validate caches of derived data.
+     **/
+    unsigned long getVersion() const;
+
     /// Returns whether this PlotData has PlotRowValues or not.
     bool rowsEmpty() const;
     /// Returns whether this PlotData has PlotRowImplicits or not.
@@ -419,6 +437,14 @@ public:
      **/
     void setHighlight(const tgt::ivec2& cellPosition, bool value, bool additive);
 
+    /**
+     * \brief   Reserves memory for \a rowCount rows, so that inserting that many rows does not
+     *          reallocate (and thus copy) the already inserted rows.
+     *
+     * \param   rowCount    expected number of rows
+     **/
+    void reserveRows(int rowCount);
+
     /**
      * \brief Clears all data and resets key- and data column count.
      *
@@ -450,6 +476,17 @@ public:
 private:
     /// updateIntervals
     void updateIntervals(const PlotRowValue& row);
+    /// assigns a new version_ after the rows have been modified
+    void updateVersion() const;
+
+    /**
+     * \brief   Evaluates \a predicates on the columnar representation of this PlotData.
+     *
+     * \param   predicates  PlotPredicates paired with the index of the column to apply them to
+     * \param   matchAll    if true a row matches if it fulfills all predicates, otherwise if it fulfills any
+     * \param   mask        receives for each row whether it matches
+     **/
+    void evaluatePredicates(const std::vector<std::pair<int, PlotPredicate*> >& predicates, bool matchAll, std::vector<char>& mask) const;
     /// delete implicit rows and their values
     void deleteImplicitRows();
 
@@ -490,6 +527,8 @@ private:
     /// flag whether rows_ is sorted lexicographically by key columns or not
     mutable bool sorted_;
 
+    mutable unsigned long version_;             ///< version of the current content, see getVersion()
+
 };
 
 } // namespace voreen
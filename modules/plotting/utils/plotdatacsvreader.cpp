@@ -0,0 +1,547 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#include "plotdatacsvreader.h"
+#include "plotdata.h"
+#include "plotcell.h"
+
+#include "voreen/core/io/progressbar.h"
+#include "tgt/logmanager.h"
+
+#include <algorithm>
+#include <clocale>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <vector>
+
+#ifdef WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
+namespace voreen {
+
+const std::string PlotDataCSVReader::loggerCat_("voreen.plotting.PlotDataCSVReader");
+
+namespace {
+
+/// number of data rows used to infer the column types
+const size_t SCHEMA_PREFIX_ROWS = 1000;
+
+/// size of the chunks the data rows are split into for parallel parsing (in bytes)
+const size_t CHUNK_SIZE = 4 << 20;
+
+/// content of a parsed cell, also used for the inferred column types (CELL_EMPTY = not yet known)
+enum CellKind {
+    CELL_EMPTY = 0,
+    CELL_NUMBER = 1,
+    CELL_TEXT = 2
+};
+
+/**
+ * Read-only view of a whole file. The file is memory mapped if possible, otherwise it is
+ * read into a buffer.
+ */
+class MappedFile {
+public:
+    MappedFile()
+        : data_(0)
+        , size_(0)
+        , mapped_(false)
+    {}
+
+    ~MappedFile() {
+        close();
+    }
+
+    bool open(const std::string& filename) {
+        close();
+        if (map(filename))
+            return true;
+
+        // mapping failed or is not supported - fall back to reading the whole file
+        std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+        if (file.fail())
+            return false;
+        file.seekg(0, std::ios::end);
+        buffer_.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        if (!buffer_.empty())
+            file.read(&buffer_[0], buffer_.size());
+        if (file.fail())
+            return false;
+        data_ = buffer_.empty() ? 0 : &buffer_[0];
+        size_ = buffer_.size();
+        return true;
+    }
+
+    void close() {
+        if (mapped_) {
+#ifdef WIN32
+            UnmapViewOfFile(data_);
+#else
+            munmap(const_cast<char*>(data_), size_);
+#endif
+        }
+        std::vector<char>().swap(buffer_);
+        data_ = 0;
+        size_ = 0;
+        mapped_ = false;
+    }
+
+    const char* data() const {
+        return data_;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+private:
+    // not copyable
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+
+    bool map(const std::string& filename) {
+#ifdef WIN32
+        HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, 0);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0
+            || static_cast<unsigned long long>(fileSize.QuadPart) > std::numeric_limits<size_t>::max())
+        {
+            CloseHandle(file);
+            return false;
+        }
+        HANDLE mapping = CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+        CloseHandle(file);
+        if (!mapping)
+            return false;
+        // the view keeps the mapping alive
+        const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (!view)
+            return false;
+        data_ = static_cast<const char*>(view);
+        size_ = static_cast<size_t>(fileSize.QuadPart);
+#else
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat fileStat;
+        if (fstat(fd, &fileStat) != 0 || fileStat.st_size <= 0) {
+            ::close(fd);
+            return false;
+        }
+        void* view = mmap(0, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        // the mapping stays valid after closing the descriptor
+        ::close(fd);
+        if (view == MAP_FAILED)
+            return false;
+#ifdef MADV_SEQUENTIAL
+        madvise(view, static_cast<size_t>(fileStat.st_size), MADV_SEQUENTIAL);
+#endif
+        data_ = static_cast<const char*>(view);
+        size_ = static_cast<size_t>(fileStat.st_size);
+#endif
+        mapped_ = true;
+        return true;
+    }
+
+    const char* data_;
+    size_t size_;
+    bool mapped_;
+    std::vector<char> buffer_;
+};
+
+/// Cells of a line aligned part of the file, stored row by row.
+struct ParsedChunk {
+    ParsedChunk()
+        : rowCount(0)
+    {}
+
+    size_t rowCount;
+    std::vector<char> kinds;                ///< CellKind of all cells
+    std::vector<plot_t> values;             ///< values of all cells, only valid for CELL_NUMBER
+    std::vector<int> tagCodes;              ///< codes of the text of all cells into dictionary, -1 if not stored
+    std::vector<std::string> dictionary;    ///< distinct texts of this chunk
+    std::vector<char> firstKinds;           ///< CellKind of the first non-empty cell of each column
+};
+
+/// blanks and tabs are whitespaces unless they are used as delimiter (e.g. in TSV files)
+inline bool isWhitespace(char c, char delimiter) {
+    return (c == ' ' || c == '\t') && c != delimiter;
+}
+
+/**
+ * Returns the end of the line starting at \a pos (without line break) and sets \a next to the
+ * beginning of the following line.
+ */
+const char* findLineEnd(const char* pos, const char* end, const char*& next) {
+    const char* lineEnd = static_cast<const char*>(memchr(pos, '\n', end - pos));
+    if (lineEnd)
+        next = lineEnd + 1;
+    else
+        next = lineEnd = end;
+    if (lineEnd > pos && *(lineEnd - 1) == '\r')
+        --lineEnd;
+    return lineEnd;
+}
+
+/// removes leading and trailing whitespaces from \a str
+void trim(std::string& str) {
+    size_t start = str.find_first_not_of(" \t");
+    if (start == std::string::npos) {
+        str.clear();
+        return;
+    }
+    size_t last = str.find_last_not_of(" \t");
+    str.erase(last + 1);
+    str.erase(0, start);
+}
+
+/**
+ * Splits the line [begin, end) at \a delimiter into fields, fields in quotes may contain the
+ * delimiter and "" is resolved to ". Leading and trailing whitespaces are removed.
+ * The strings in \a fields are reused to avoid allocations.
+ *
+ * \return  number of fields found in the line
+ */
+size_t splitLine(const char* begin, const char* end, char delimiter, std::vector<std::string>& fields) {
+    size_t count = 0;
+    const char* pos = begin;
+    for (;;) {
+        // we are at the beginning of an entry, skip whitespaces and check if not already reached end of line
+        while (pos < end && isWhitespace(*pos, delimiter))
+            ++pos;
+        if (pos >= end)
+            break;
+
+        if (count == fields.size())
+            fields.push_back(std::string());
+        std::string& field = fields[count++];
+
+        if (*pos == '"') {
+            const char* start = pos + 1;
+            const char* quote = std::find(start, end, '"');
+            field.assign(start, quote);
+            // ensure we haven't found double quotes ("") which shall be resolved to one double quote
+            while (quote + 1 < end && *(quote + 1) == '"') {
+                start = quote + 1;
+                quote = std::find(quote + 2, end, '"');
+                field.append(start, quote);
+            }
+            trim(field);
+            // ignore everything until next delimiter
+            pos = std::find(quote, end, delimiter);
+        }
+        else {
+            const char* next = std::find(pos, end, delimiter);
+            const char* last = next;
+            while (last > pos && isWhitespace(*(last - 1), delimiter))
+                --last;
+            field.assign(pos, last);
+            pos = next;
+        }
+
+        if (pos >= end)
+            break;
+        ++pos;
+    }
+    return count;
+}
+
+/**
+ * Tries to read a number from the beginning of \a text like std::istream would do, the first
+ * ',' is treated as decimal point. \a scratch is used as buffer.
+ */
+bool parseNumber(const std::string& text, char decimalPoint, std::string& scratch, plot_t& value) {
+    scratch = text;
+    size_t comma = scratch.find(',');
+    if (comma != std::string::npos)
+        scratch[comma] = '.';
+    // strtod respects the C locale, std::istream parsing was done in the classic one
+    if (decimalPoint != '.')
+        std::replace(scratch.begin(), scratch.end(), '.', decimalPoint);
+
+    const char* start = scratch.c_str();
+    char* stop = 0;
+    double number = strtod(start, &stop);
+    if (stop == start)
+        return false;
+    // strtod also accepts inf, nan and hexadecimal numbers, std::istream does not
+    for (const char* c = start; c < stop; ++c) {
+        if (!((*c >= '0' && *c <= '9') || *c == '+' || *c == '-' || *c == 'e' || *c == 'E' || *c == decimalPoint))
+            return false;
+    }
+    value = static_cast<plot_t>(number);
+    return true;
+}
+
+/**
+ * Parses all lines in [begin, end) into \a chunk. Cells in columns of type CELL_NUMBER are only
+ * stored as values, cells in columns of type CELL_TEXT only as text, for columns of unknown type
+ * both is stored.
+ */
+void parseChunk(const char* begin, const char* end, char delimiter, char decimalPoint,
+                const std::vector<char>& columnTypes, ParsedChunk& chunk)
+{
+    const size_t columnCount = columnTypes.size();
+    const size_t expectedRows = std::count(begin, end, '\n') + 1;
+    chunk.kinds.reserve(expectedRows * columnCount);
+    chunk.values.reserve(expectedRows * columnCount);
+    chunk.tagCodes.reserve(expectedRows * columnCount);
+    chunk.firstKinds.assign(columnCount, CELL_EMPTY);
+
+    std::map<std::string, int> dictionaryCodes;
+    std::vector<std::string> fields;
+    std::string scratch;
+    const char* pos = begin;
+    while (pos < end) {
+        const char* next;
+        const char* lineEnd = findLineEnd(pos, end, next);
+        size_t fieldCount = splitLine(pos, lineEnd, delimiter, fields);
+
+        for (size_t i = 0; i < columnCount; ++i) {
+            char kind = CELL_EMPTY;
+            plot_t value = std::numeric_limits<plot_t>::quiet_NaN();
+            int code = -1;
+            if (i < fieldCount && !fields[i].empty()) {
+                const std::string& text = fields[i];
+                if (columnTypes[i] != CELL_TEXT && parseNumber(text, decimalPoint, scratch, value))
+                    kind = CELL_NUMBER;
+                else if (columnTypes[i] != CELL_NUMBER)
+                    kind = CELL_TEXT;
+
+                if (kind != CELL_EMPTY && columnTypes[i] != CELL_NUMBER) {
+                    std::map<std::string, int>::iterator it = dictionaryCodes.find(text);
+                    if (it == dictionaryCodes.end()) {
+                        it = dictionaryCodes.insert(std::make_pair(text, static_cast<int>(chunk.dictionary.size()))).first;
+                        chunk.dictionary.push_back(text);
+                    }
+                    code = it->second;
+                }
+                if (kind != CELL_EMPTY && chunk.firstKinds[i] == CELL_EMPTY)
+                    chunk.firstKinds[i] = kind;
+            }
+            chunk.kinds.push_back(kind);
+            chunk.values.push_back(value);
+            chunk.tagCodes.push_back(code);
+        }
+        ++chunk.rowCount;
+        pos = next;
+    }
+}
+
+/// skips \a count lines starting at \a pos and returns the beginning of the following line
+const char* skipLines(const char* pos, const char* end, size_t count) {
+    const char* next = pos;
+    for (size_t i = 0; i < count && pos < end; ++i) {
+        findLineEnd(pos, end, next);
+        pos = next;
+    }
+    return pos;
+}
+
+} // namespace
+
+PlotDataCSVReader::PlotDataCSVReader(ProgressBar* progress)
+    : separator_(';')
+    , headerLineCount_(1)
+    , keyColumnCount_(1)
+    , constantOrder_(false)
+    , progress_(progress)
+{}
+
+void PlotDataCSVReader::setSeparator(char separator) {
+    separator_ = separator;
+}
+
+void PlotDataCSVReader::setHeaderLineCount(int count) {
+    headerLineCount_ = std::max(count, 0);
+}
+
+void PlotDataCSVReader::setKeyColumnCount(int count) {
+    keyColumnCount_ = std::max(count, 0);
+}
+
+void PlotDataCSVReader::setConstantOrder(bool constantOrder) {
+    constantOrder_ = constantOrder;
+}
+
+void PlotDataCSVReader::setProgressBar(ProgressBar* progress) {
+    progress_ = progress;
+}
+
+void PlotDataCSVReader::reportProgress(float progress) const {
+    if (progress_)
+        progress_->setProgress(progress);
+}
+
+bool PlotDataCSVReader::read(const std::string& filename, PlotData& target) const {
+    target.reset(0, 0);
+
+    MappedFile file;
+    if (!file.open(filename)) {
+        LERROR("Unable to open data file: " << filename);
+        return false;
+    }
+    const char* begin = file.data();
+    const char* end = begin + file.size();
+    const char decimalPoint = localeconv()->decimal_point[0];
+
+    // header lines - the last one holds the column labels
+    std::vector<std::string> labels;
+    size_t labelCount = 0;
+    const char* pos = begin;
+    for (int i = 0; i < headerLineCount_ && pos < end; ++i) {
+        const char* next;
+        const char* lineEnd = findLineEnd(pos, end, next);
+        if (i == headerLineCount_ - 1)
+            labelCount = splitLine(pos, lineEnd, separator_, labels);
+        pos = next;
+    }
+    const char* dataBegin = pos;
+
+    // without labels the first non-empty data line determines the column count
+    size_t columnCount = labelCount;
+    for (pos = dataBegin; columnCount == 0 && pos < end; ) {
+        const char* next;
+        const char* lineEnd = findLineEnd(pos, end, next);
+        std::vector<std::string> fields;
+        columnCount = splitLine(pos, lineEnd, separator_, fields);
+        pos = next;
+    }
+
+    // infer the column types from a prefix of the data rows
+    std::vector<char> columnTypes(columnCount, CELL_EMPTY);
+    {
+        ParsedChunk prefix;
+        parseChunk(dataBegin, skipLines(dataBegin, end, SCHEMA_PREFIX_ROWS), separator_, decimalPoint, columnTypes, prefix);
+        columnTypes = prefix.firstKinds;
+    }
+
+    // split the data rows into line aligned chunks and parse them in parallel
+    std::vector<const char*> bounds(1, dataBegin);
+    while (bounds.back() < end) {
+        const char* chunkEnd = bounds.back() + std::min(CHUNK_SIZE, static_cast<size_t>(end - bounds.back()));
+        if (chunkEnd < end)
+            chunkEnd = skipLines(chunkEnd - 1, end, 1);
+        bounds.push_back(chunkEnd);
+    }
+    const int chunkCount = static_cast<int>(bounds.size()) - 1;
+    std::vector<ParsedChunk> chunks(chunkCount);
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic)
+    #endif
+    for (int i = 0; i < chunkCount; ++i) {
+        parseChunk(bounds[i], bounds[i + 1], separator_, decimalPoint, columnTypes, chunks[i]);
+#ifdef _OPENMP
+        // progress bars may only be updated from the calling thread
+        if (omp_get_thread_num() == 0)
+#endif
+            reportProgress(0.5f * static_cast<float>(i + 1) / static_cast<float>(chunkCount));
+    }
+
+    // columns without any non-empty cell in the prefix take the type of their first non-empty cell
+    for (size_t i = 0; i < columnCount; ++i) {
+        for (int j = 0; columnTypes[i] == CELL_EMPTY && j < chunkCount; ++j)
+            columnTypes[i] = chunks[j].firstKinds[i];
+    }
+
+    size_t rowCount = 0;
+    for (int i = 0; i < chunkCount; ++i)
+        rowCount += chunks[i].rowCount;
+
+    // set up target
+    const int offset = constantOrder_ ? 1 : 0;
+    if (constantOrder_) {
+        target.reset(1, static_cast<int>(columnCount));
+        target.setColumnLabel(0, "Index");
+    }
+    else {
+        int keyColumns = std::min(keyColumnCount_, static_cast<int>(columnCount));
+        target.reset(keyColumns, static_cast<int>(columnCount) - keyColumns);
+    }
+    for (size_t i = 0; i < columnCount; ++i) {
+        if (i < labelCount) {
+            target.setColumnLabel(static_cast<int>(i) + offset, labels[i]);
+        }
+        else {
+            std::stringstream label;
+            label << (i + offset);
+            target.setColumnLabel(static_cast<int>(i) + offset, label.str());
+        }
+    }
+
+    // assemble the rows in file order
+    target.reserveRows(static_cast<int>(rowCount));
+    std::vector<PlotCellValue> cells(columnCount + offset);
+    size_t row = 0;
+    for (int i = 0; i < chunkCount; ++i) {
+        ParsedChunk& chunk = chunks[i];
+        size_t cell = 0;
+        for (size_t r = 0; r < chunk.rowCount; ++r, ++row) {
+            if (constantOrder_)
+                cells[0].setValue(static_cast<plot_t>(row));
+            for (size_t c = 0; c < columnCount; ++c, ++cell) {
+                PlotCellValue& value = cells[c + offset];
+                if (chunk.kinds[cell] == CELL_NUMBER && columnTypes[c] == CELL_NUMBER)
+                    value.setValue(chunk.values[cell]);
+                else if (chunk.kinds[cell] != CELL_EMPTY && columnTypes[c] == CELL_TEXT)
+                    value.setTag(chunk.dictionary[chunk.tagCodes[cell]]);
+                else
+                    value.clear();
+            }
+            target.insert(cells);
+        }
+        // release the chunk as early as possible to keep the peak memory low
+        chunks[i] = ParsedChunk();
+        reportProgress(0.5f + 0.5f * static_cast<float>(i + 1) / static_cast<float>(chunkCount));
+    }
+
+    LINFO("Read " << row << " rows with " << columnCount << " columns from " << filename);
+    return true;
+}
+
+} // namespace voreen
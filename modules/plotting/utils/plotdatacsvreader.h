@@ -0,0 +1,102 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef VRN_PLOTDATACSVREADER_H
+#define VRN_PLOTDATACSVREADER_H
+
+#include "plotbase.h"
+#include "modules/plotting/plottingmoduledefine.h"
+
+#include <string>
+
+namespace voreen {
+
+class PlotData;
+class ProgressBar;
+
+/**
+ * \brief   Reads character separated text files (CSV, TSV, ...) into a PlotData.
+ *
+ * The file is memory mapped (or read in one block where mapping is not available) and split
+ * into line aligned chunks which are parsed in parallel. The column types are inferred from a
+ * prefix of the data rows, so the workers can convert numeric columns directly into plot_t
+ * values, while tags are interned per chunk. Afterwards the rows are assembled in file order.
+ *
+ * The type semantics are the same as in the former line based parser of PlotDataSource:
+ *  - the first non-empty cell of a column decides whether it is a number or a string column,
+ *  - numbers in a string column are inserted as tags holding the text of the cell,
+ *  - strings in a number column and empty cells are inserted as empty cells,
+ *  - the first ',' of a number is used as decimal separator.
+ *
+ * \note    Quoted fields may contain the separator but no line breaks.
+ **/
+class VRN_MODULE_PLOTTING_API PlotDataCSVReader {
+public:
+    /**
+     * \param   progress    progress bar reading progress is reported to, may be 0
+     **/
+    PlotDataCSVReader(ProgressBar* progress = 0);
+
+    /// sets the field separator, default is ';'
+    void setSeparator(char separator);
+
+    /// sets the number of header lines (the last one holds the column labels), default is 1
+    void setHeaderLineCount(int count);
+
+    /// sets the number of key columns, default is 1
+    void setKeyColumnCount(int count);
+
+    /// if true, an additional key column "Index" holding the row number is prepended, default is false
+    void setConstantOrder(bool constantOrder);
+
+    /// sets the progress bar reading progress is reported to, may be 0
+    void setProgressBar(ProgressBar* progress);
+
+    /**
+     * \brief   Reads the file \a filename into \a target, which is reset before.
+     *
+     * \return  false if the file could not be opened
+     **/
+    bool read(const std::string& filename, PlotData& target) const;
+
+private:
+    /// reports \a progress to progress_ if set
+    void reportProgress(float progress) const;
+
+    char separator_;
+    int headerLineCount_;
+    int keyColumnCount_;
+    bool constantOrder_;
+    ProgressBar* progress_;
+
+    static const std::string loggerCat_;
+};
+
+} // namespace voreen
+
+#endif // VRN_PLOTDATACSVREADER_H
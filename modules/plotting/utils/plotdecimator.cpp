@@ -0,0 +1,485 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#include "plotdecimator.h"
+#include "plotdata.h"
+#include "plotrow.h"
+
+#include <algorithm>
+#include <set>
+
+namespace voreen {
+
+namespace {
+    // lines with at most this number of visible points per pixel column are not decimated
+    const int LINE_POINTS_PER_PIXEL = 4;
+
+    // number of bits per axis of the Morton codes used for scatter plots
+    const int SCATTER_MAX_LEVEL = 16;
+
+    // finest grid level used for vertex clustering of surfaces
+    const int SURFACE_MAX_LEVEL = 12;
+
+    // spreads the lower 16 bits of \a v to the even bits of the result
+    unsigned int spreadBits(unsigned int v) {
+        v &= 0x0000ffff;
+        v = (v | (v << 8)) & 0x00ff00ff;
+        v = (v | (v << 4)) & 0x0f0f0f0f;
+        v = (v | (v << 2)) & 0x33333333;
+        v = (v | (v << 1)) & 0x55555555;
+        return v;
+    }
+
+    // inverse of spreadBits()
+    unsigned int compactBits(unsigned int v) {
+        v &= 0x55555555;
+        v = (v | (v >> 1)) & 0x33333333;
+        v = (v | (v >> 2)) & 0x0f0f0f0f;
+        v = (v | (v >> 4)) & 0x00ff00ff;
+        v = (v | (v >> 8)) & 0x0000ffff;
+        return v;
+    }
+
+    // maps \a value within [llf, llf + size] to [0, 2^maxLevel - 1]
+    unsigned int quantize(plot_t value, plot_t llf, plot_t size, int maxLevel) {
+        const plot_t cells = static_cast<plot_t>(1 << maxLevel);
+        plot_t q = (value - llf) / size * cells;
+        if (q < 0)
+            return 0;
+        if (q >= cells)
+            return (1 << maxLevel) - 1;
+        return static_cast<unsigned int>(q);
+    }
+}
+
+PlotDecimator::PlotDecimator()
+    : data_(0)
+    , version_(0)
+{}
+
+void PlotDecimator::clear() {
+    lines_.clear();
+    scatters_.clear();
+    surfaces_.clear();
+    data_ = 0;
+    version_ = 0;
+}
+
+void PlotDecimator::validate(const PlotData& data) {
+    if (data_ != &data || version_ != data.getVersion()) {
+        clear();
+        data_ = &data;
+        version_ = data.getVersion();
+    }
+}
+
+// - lines ----------------------------------------------------------------------------------------
+
+const std::vector<int>& PlotDecimator::decimateLine(const PlotData& data, int indexX, int indexY,
+                                                    const Interval<plot_t>& xDomain, int pixelWidth) {
+    validate(data);
+    pixelWidth = std::max(pixelWidth, 1);
+    std::pair<std::map<std::pair<int, int>, LineLod>::iterator, bool> entry =
+        lines_.insert(std::make_pair(std::make_pair(indexX, indexY), LineLod()));
+    LineLod& lod = entry.first->second;
+    if (entry.second)
+        buildLine(data, indexX, indexY, lod);
+
+    const int n = static_cast<int>(lod.rows_.size());
+    int first = 0;
+    int last = n;
+    if (lod.monotonic_) {
+        // restrict to the visible range plus one point on each side, so the line reaches the borders
+        first = static_cast<int>(std::lower_bound(lod.x_.begin(), lod.x_.end(), xDomain.getLeft()) - lod.x_.begin());
+        last = static_cast<int>(std::upper_bound(lod.x_.begin(), lod.x_.end(), xDomain.getRight()) - lod.x_.begin());
+        first = std::max(first - 1, 0);
+        last = std::min(last + 1, n);
+    }
+
+    lod.result_.clear();
+    const int count = last - first;
+    if (count <= LINE_POINTS_PER_PIXEL * pixelWidth || lod.minima_.empty()) {
+        lod.result_.assign(lod.rows_.begin() + first, lod.rows_.begin() + last);
+        return lod.result_;
+    }
+
+    // choose the finest level with at least pixelWidth buckets in the visible range
+    int level = 0;
+    int bucketSize = 2;
+    while (level + 1 < static_cast<int>(lod.minima_.size()) && count / (bucketSize * 2) >= pixelWidth) {
+        ++level;
+        bucketSize *= 2;
+    }
+
+    const std::vector<int>& minima = lod.minima_[level];
+    const std::vector<int>& maxima = lod.maxima_[level];
+    const int lastBucket = (last - 1) / bucketSize;
+    int positions[4];
+    for (int bucket = first / bucketSize; bucket <= lastBucket; ++bucket) {
+        positions[0] = bucket * bucketSize;
+        positions[1] = minima[bucket];
+        positions[2] = maxima[bucket];
+        positions[3] = std::min(positions[0] + bucketSize, n) - 1;
+        std::sort(positions, positions + 4);
+        for (int i = 0; i < 4; ++i) {
+            if (i == 0 || positions[i] != positions[i-1])
+                lod.result_.push_back(lod.rows_[positions[i]]);
+        }
+    }
+    return lod.result_;
+}
+
+void PlotDecimator::buildLine(const PlotData& data, int indexX, int indexY, LineLod& lod) const {
+    const bool tagsInX = (data.getColumnType(indexX) == PlotBase::STRING);
+    PlotColumn xColumn;
+    PlotColumn yColumn;
+    data.getColumn(indexX, xColumn);
+    data.getColumn(indexY, yColumn);
+    const std::vector<char>& xTypes = xColumn.getCellTypes();
+    const std::vector<char>& yTypes = yColumn.getCellTypes();
+    const int rowCount = data.getRowsCount();
+
+    lod.monotonic_ = true;
+    for (int row = 0; row < rowCount; ++row) {
+        // we ignore rows with null entries
+        if (xTypes[row] == PlotColumn::EMPTY_CELL || yTypes[row] == PlotColumn::EMPTY_CELL)
+            continue;
+        plot_t x = tagsInX ? static_cast<plot_t>(row) : xColumn.getValues()[row];
+        if (x != x || (!lod.x_.empty() && x < lod.x_.back()))
+            lod.monotonic_ = false;
+        lod.rows_.push_back(row);
+        lod.x_.push_back(x);
+        lod.y_.push_back(yColumn.getValues()[row]);
+    }
+
+    // build the min/max pyramid: level 0 combines 2 points, each further level 2 buckets of the previous one
+    const int n = static_cast<int>(lod.rows_.size());
+    int bucketCount = (n + 1) / 2;
+    while (n > 1) {
+        std::vector<int> minima(bucketCount);
+        std::vector<int> maxima(bucketCount);
+        const bool firstLevel = lod.minima_.empty();
+        for (int bucket = 0; bucket < bucketCount; ++bucket) {
+            int a, b, c, d;
+            if (firstLevel) {
+                a = c = 2 * bucket;
+                b = d = std::min(2 * bucket + 1, n - 1);
+            }
+            else {
+                const std::vector<int>& prevMinima = lod.minima_.back();
+                const std::vector<int>& prevMaxima = lod.maxima_.back();
+                int child = std::min(2 * bucket + 1, static_cast<int>(prevMinima.size()) - 1);
+                a = prevMinima[2 * bucket];
+                b = prevMinima[child];
+                c = prevMaxima[2 * bucket];
+                d = prevMaxima[child];
+            }
+            minima[bucket] = (lod.y_[b] < lod.y_[a]) ? b : a;
+            maxima[bucket] = (lod.y_[d] > lod.y_[c]) ? d : c;
+        }
+        lod.minima_.push_back(minima);
+        lod.maxima_.push_back(maxima);
+        if (bucketCount == 1)
+            break;
+        bucketCount = (bucketCount + 1) / 2;
+    }
+}
+
+// - scatter plots --------------------------------------------------------------------------------
+
+const std::vector<int>& PlotDecimator::decimateScatter(const PlotData& data, int indexX, int indexY, int indexHighlight,
+                                                       const Interval<plot_t>& xDomain, const Interval<plot_t>& yDomain,
+                                                       const tgt::ivec2& pixelSize) {
+    validate(data);
+    std::pair<std::map<std::pair<int, int>, ScatterLod>::iterator, bool> entry =
+        scatters_.insert(std::make_pair(std::make_pair(indexX, indexY), ScatterLod()));
+    ScatterLod& lod = entry.first->second;
+    if (entry.second)
+        buildScatter(data, indexX, indexY, lod);
+
+    lod.result_.clear();
+    if (lod.rows_.empty())
+        return lod.result_;
+
+    // choose the coarsest quadtree level whose cells are not larger than a pixel
+    const plot_t pixelWidth = xDomain.size() / std::max(pixelSize.x, 1);
+    const plot_t pixelHeight = yDomain.size() / std::max(pixelSize.y, 1);
+    int targetLevel = 0;
+    while (targetLevel < SCATTER_MAX_LEVEL
+           && (lod.size_.x / (1 << targetLevel) > pixelWidth || lod.size_.y / (1 << targetLevel) > pixelHeight))
+        ++targetLevel;
+
+    // highlighting does not change the version of the data, so highlighted rows are looked up on every query
+    for (size_t i = 0; i < lod.rows_.size(); ++i) {
+        const PlotRowValue& row = data.getRow(lod.rows_[i]);
+        if (row.getCellAt(indexHighlight).isHighlighted()
+            && xDomain.contains(row.getValueAt(indexX)) && yDomain.contains(row.getValueAt(indexY)))
+            lod.result_.push_back(lod.rows_[i]);
+    }
+    const size_t highlightedCount = lod.result_.size();
+
+    std::vector<int> candidates;
+    queryScatter(lod, 0, lod.rows_.size(), 0, 0, targetLevel, xDomain, yDomain, candidates);
+
+    // quadtree cells are not aligned to pixels, so keep only the first visible candidate per pixel
+    std::sort(candidates.begin(), candidates.end());
+    const tgt::ivec2 pixels = tgt::max(pixelSize, tgt::ivec2(1));
+    std::vector<char> occupied(pixels.x * pixels.y, 0);
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        const PlotRowValue& row = data.getRow(candidates[i]);
+        if (row.getCellAt(indexHighlight).isHighlighted())
+            continue;
+        plot_t x = row.getValueAt(indexX);
+        plot_t y = row.getValueAt(indexY);
+        if (!xDomain.contains(x) || !yDomain.contains(y))
+            continue;
+        int px = std::min(static_cast<int>((x - xDomain.getLeft()) / xDomain.size() * pixels.x), pixels.x - 1);
+        int py = std::min(static_cast<int>((y - yDomain.getLeft()) / yDomain.size() * pixels.y), pixels.y - 1);
+        char& pixel = occupied[py * pixels.x + px];
+        if (!pixel) {
+            pixel = 1;
+            lod.result_.push_back(candidates[i]);
+        }
+    }
+    if (highlightedCount > 0)
+        std::sort(lod.result_.begin(), lod.result_.end());
+    return lod.result_;
+}
+
+void PlotDecimator::buildScatter(const PlotData& data, int indexX, int indexY, ScatterLod& lod) const {
+    PlotColumn xColumn;
+    PlotColumn yColumn;
+    data.getColumn(indexX, xColumn);
+    data.getColumn(indexY, yColumn);
+    const std::vector<plot_t>& xValues = xColumn.getValues();
+    const std::vector<plot_t>& yValues = yColumn.getValues();
+    const int rowCount = data.getRowsCount();
+
+    // bounding box of all points holding values
+    tgt::dvec2 llf(0.0);
+    tgt::dvec2 urb(0.0);
+    bool empty = true;
+    for (int row = 0; row < rowCount; ++row) {
+        plot_t x = xValues[row];
+        plot_t y = yValues[row];
+        if (x != x || y != y)
+            continue;
+        if (empty) {
+            llf = urb = tgt::dvec2(x, y);
+            empty = false;
+        }
+        else {
+            llf = tgt::min(llf, tgt::dvec2(x, y));
+            urb = tgt::max(urb, tgt::dvec2(x, y));
+        }
+    }
+    if (empty)
+        return;
+
+    lod.llf_ = llf;
+    lod.size_ = urb - llf;
+    if (lod.size_.x <= 0)
+        lod.size_.x = 1;
+    if (lod.size_.y <= 0)
+        lod.size_.y = 1;
+
+    // sort the points along the Morton curve, points in the same quadtree cell become contiguous
+    std::vector<std::pair<unsigned int, int> > points;
+    points.reserve(rowCount);
+    for (int row = 0; row < rowCount; ++row) {
+        plot_t x = xValues[row];
+        plot_t y = yValues[row];
+        if (x != x || y != y)
+            continue;
+        unsigned int qx = quantize(x, lod.llf_.x, lod.size_.x, SCATTER_MAX_LEVEL);
+        unsigned int qy = quantize(y, lod.llf_.y, lod.size_.y, SCATTER_MAX_LEVEL);
+        points.push_back(std::make_pair(spreadBits(qx) | (spreadBits(qy) << 1), row));
+    }
+    std::sort(points.begin(), points.end());
+
+    lod.codes_.resize(points.size());
+    lod.rows_.resize(points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        lod.codes_[i] = points[i].first;
+        lod.rows_[i] = points[i].second;
+    }
+}
+
+void PlotDecimator::queryScatter(const ScatterLod& lod, size_t first, size_t last, int level, unsigned int prefix, int targetLevel,
+                                 const Interval<plot_t>& xDomain, const Interval<plot_t>& yDomain, std::vector<int>& result) const {
+    // skip cells outside the visible domain
+    const tgt::dvec2 cellSize = lod.size_ / static_cast<double>(1 << level);
+    const tgt::dvec2 cellLlf = lod.llf_ + tgt::dvec2(compactBits(prefix), compactBits(prefix >> 1)) * cellSize;
+    if (cellLlf.x > xDomain.getRight() || cellLlf.x + cellSize.x < xDomain.getLeft()
+        || cellLlf.y > yDomain.getRight() || cellLlf.y + cellSize.y < yDomain.getLeft())
+        return;
+
+    if (level == targetLevel || last - first == 1) {
+        result.push_back(lod.rows_[first]);
+        return;
+    }
+
+    const int shift = 2 * (SCATTER_MAX_LEVEL - level - 1);
+    std::vector<unsigned int>::const_iterator begin = lod.codes_.begin();
+    size_t childFirst = first;
+    for (unsigned int i = 0; i < 4; ++i) {
+        const unsigned int child = (prefix << 2) | i;
+        const unsigned long long childEnd = static_cast<unsigned long long>(child + 1) << shift;
+        size_t childLast = std::lower_bound(begin + childFirst, begin + last, childEnd) - begin;
+        if (childLast > childFirst)
+            queryScatter(lod, childFirst, childLast, level + 1, child, targetLevel, xDomain, yDomain, result);
+        childFirst = childLast;
+    }
+}
+
+// - surfaces -------------------------------------------------------------------------------------
+
+const std::vector<int>& PlotDecimator::decimateSurface(const PlotData& data, const std::vector<int>& triangleVertexIndices,
+                                                       int indexX, int indexY, const Interval<plot_t>& xDomain,
+                                                       const Interval<plot_t>& yDomain, int gridSize) {
+    // few triangles are rendered as they are
+    if (triangleVertexIndices.size() / 3 <= static_cast<size_t>(2 * gridSize * gridSize))
+        return triangleVertexIndices;
+
+    validate(data);
+    std::pair<std::map<std::pair<int, int>, SurfaceLod>::iterator, bool> entry =
+        surfaces_.insert(std::make_pair(std::make_pair(indexX, indexY), SurfaceLod()));
+    SurfaceLod& lod = entry.first->second;
+    if (entry.second || lod.triangles_ != &triangleVertexIndices || lod.triangleCount_ != triangleVertexIndices.size()) {
+        lod = SurfaceLod();
+        buildSurface(data, triangleVertexIndices, indexX, indexY, lod);
+    }
+
+    // choose the grid level having at least gridSize cells along each axis of the visible domain
+    int level = 0;
+    while (level < SURFACE_MAX_LEVEL
+           && (lod.size_.x / (1 << level) * gridSize > xDomain.size() || lod.size_.y / (1 << level) * gridSize > yDomain.size()))
+        ++level;
+    if (level == SURFACE_MAX_LEVEL)
+        return triangleVertexIndices;
+
+    std::map<int, std::vector<int> >::iterator levelIt = lod.levels_.find(level);
+    if (levelIt != lod.levels_.end())
+        return levelIt->second;
+
+    // cluster the vertices: the first row of each cell represents all rows in it,
+    // vertices without valid coordinates represent themselves
+    const int shift = SURFACE_MAX_LEVEL - level;
+    std::map<std::pair<int, int>, int> clusters;
+    std::vector<int> representatives(lod.cells_.size());
+    for (size_t row = 0; row < lod.cells_.size(); ++row) {
+        if (lod.cells_[row].x < 0) {
+            representatives[row] = static_cast<int>(row);
+            continue;
+        }
+        std::pair<int, int> cell(lod.cells_[row].x >> shift, lod.cells_[row].y >> shift);
+        representatives[row] = clusters.insert(std::make_pair(cell, static_cast<int>(row))).first->second;
+    }
+
+    // remap the triangles and remove the collapsed and duplicate ones,
+    // as well as those referring to rows not in the data
+    const int numRows = static_cast<int>(representatives.size());
+    std::vector<int>& triangles = lod.levels_[level];
+    std::set<std::vector<int> > rendered;
+    std::vector<int> key(3);
+    for (size_t i = 0; i + 2 < triangleVertexIndices.size(); i += 3) {
+        if (triangleVertexIndices[i] < 0 || triangleVertexIndices[i] >= numRows
+                || triangleVertexIndices[i+1] < 0 || triangleVertexIndices[i+1] >= numRows
+                || triangleVertexIndices[i+2] < 0 || triangleVertexIndices[i+2] >= numRows)
+            continue;
+        int a = representatives[triangleVertexIndices[i]];
+        int b = representatives[triangleVertexIndices[i+1]];
+        int c = representatives[triangleVertexIndices[i+2]];
+        if (a == b || b == c || a == c)
+            continue;
+        key[0] = a; key[1] = b; key[2] = c;
+        std::sort(key.begin(), key.end());
+        if (!rendered.insert(key).second)
+            continue;
+        triangles.push_back(a);
+        triangles.push_back(b);
+        triangles.push_back(c);
+    }
+    return triangles;
+}
+
+void PlotDecimator::buildSurface(const PlotData& data, const std::vector<int>& triangleVertexIndices, int indexX, int indexY,
+                                 SurfaceLod& lod) const {
+    lod.triangles_ = &triangleVertexIndices;
+    lod.triangleCount_ = triangleVertexIndices.size();
+
+    PlotColumn xColumn;
+    PlotColumn yColumn;
+    data.getColumn(indexX, xColumn);
+    data.getColumn(indexY, yColumn);
+    const std::vector<plot_t>& xValues = xColumn.getValues();
+    const std::vector<plot_t>& yValues = yColumn.getValues();
+    const int rowCount = data.getRowsCount();
+
+    // mark the rows used as vertices and compute their bounding box
+    std::vector<char> used(rowCount, 0);
+    for (size_t i = 0; i < triangleVertexIndices.size(); ++i) {
+        int row = triangleVertexIndices[i];
+        if (row >= 0 && row < rowCount)
+            used[row] = 1;
+    }
+    tgt::dvec2 llf(0.0);
+    tgt::dvec2 urb(0.0);
+    bool empty = true;
+    for (int row = 0; row < rowCount; ++row) {
+        if (!used[row] || xValues[row] != xValues[row] || yValues[row] != yValues[row]) {
+            used[row] = 0;
+            continue;
+        }
+        tgt::dvec2 p(xValues[row], yValues[row]);
+        if (empty) {
+            llf = urb = p;
+            empty = false;
+        }
+        else {
+            llf = tgt::min(llf, p);
+            urb = tgt::max(urb, p);
+        }
+    }
+    lod.llf_ = llf;
+    lod.size_ = urb - llf;
+    if (lod.size_.x <= 0)
+        lod.size_.x = 1;
+    if (lod.size_.y <= 0)
+        lod.size_.y = 1;
+
+    lod.cells_.assign(rowCount, tgt::ivec2(-1));
+    for (int row = 0; row < rowCount; ++row) {
+        if (!used[row])
+            continue;
+        lod.cells_[row].x = quantize(xValues[row], lod.llf_.x, lod.size_.x, SURFACE_MAX_LEVEL);
+        lod.cells_[row].y = quantize(yValues[row], lod.llf_.y, lod.size_.y, SURFACE_MAX_LEVEL);
+    }
+}
+
+} // namespace voreen
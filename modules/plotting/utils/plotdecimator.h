@@ -0,0 +1,168 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#ifndef VRN_PLOTDECIMATOR_H
+#define VRN_PLOTDECIMATOR_H
+
+#include "plotbase.h"
+#include "interval.h"
+#include "modules/plotting/plottingmoduledefine.h"
+
+#include "tgt/vector.h"
+
+#include <vector>
+#include <map>
+
+namespace voreen {
+
+class PlotData;
+
+/**
+ * \brief   Screen-space aware level of detail for line, scatter and surface plots.
+ *
+ * The PlotDecimator reduces the rows a PlotLibrary has to render to what can be distinguished
+ * on the output device. All decimation functions return indices of rows (or triangles made of
+ * row indices) of the original PlotData, so picking and highlighting keep working.
+ *
+ * Each function builds an auxiliary structure once per PlotData version and column
+ * combination, zooming only queries this structure:
+ *  - Lines: a pyramid holding the positions of the minimum and maximum of 2^k consecutive
+ *    points. For each bucket of the level matching the pixel width the first, last, minimum
+ *    and maximum point are kept, which preserves the visual envelope of the line.
+ *  - Scatter: the points sorted along a Morton curve (implicit quadtree). One representative
+ *    point is kept for each occupied quadtree cell not larger than a pixel.
+ *  - Surfaces: vertex clustering on a regular grid in the xy-plane, the grid resolution
+ *    depends on the zoomed domain. Each grid level is computed only once.
+ **/
+class VRN_MODULE_PLOTTING_API PlotDecimator {
+public:
+    PlotDecimator();
+
+    /**
+     * \brief   Returns the rows to render for the line through columns \a indexX and \a indexY.
+     *
+     * Rows containing null cells are skipped, the returned rows are in ascending order.
+     *
+     * \param   data        PlotData containing the line
+     * \param   indexX      index of the x column, for string columns the row index is used as x value
+     * \param   indexY      index of the y column
+     * \param   xDomain     currently visible x interval
+     * \param   pixelWidth  width of the visible x interval in pixels
+     **/
+    const std::vector<int>& decimateLine(const PlotData& data, int indexX, int indexY, const Interval<plot_t>& xDomain, int pixelWidth);
+
+    /**
+     * \brief   Returns the rows to render for the 2D scatter plot of columns \a indexX and \a indexY.
+     *
+     * Rows containing null cells are skipped, the returned rows are in ascending order. Visible
+     * rows whose cell in column \a indexHighlight is highlighted are always returned.
+     *
+     * \param   data            PlotData containing the points
+     * \param   indexX          index of the x column
+     * \param   indexY          index of the y column
+     * \param   indexHighlight  index of the column whose cells carry the highlight flag
+     * \param   xDomain         currently visible x interval
+     * \param   yDomain         currently visible y interval
+     * \param   pixelSize       size of the visible area in pixels
+     **/
+    const std::vector<int>& decimateScatter(const PlotData& data, int indexX, int indexY, int indexHighlight,
+        const Interval<plot_t>& xDomain, const Interval<plot_t>& yDomain, const tgt::ivec2& pixelSize);
+
+    /**
+     * \brief   Returns the triangles to render for the surface given by \a triangleVertexIndices.
+     *
+     * Triangles with vertices falling into the same grid cell collapse and are removed, the
+     * remaining triangles refer to one representative vertex per cell.
+     *
+     * \param   data                    PlotData containing the vertices
+     * \param   triangleVertexIndices   row indices of the vertices, three per triangle
+     * \param   indexX                  index of the x column
+     * \param   indexY                  index of the y column
+     * \param   xDomain                 currently visible x interval
+     * \param   yDomain                 currently visible y interval
+     * \param   gridSize                number of grid cells along each axis of the visible domain
+     **/
+    const std::vector<int>& decimateSurface(const PlotData& data, const std::vector<int>& triangleVertexIndices, int indexX, int indexY,
+        const Interval<plot_t>& xDomain, const Interval<plot_t>& yDomain, int gridSize);
+
+    /// Discards all cached data.
+    void clear();
+
+private:
+    /// level of detail structure of a single line
+    struct LineLod {
+        std::vector<int> rows_;                     ///< non-null rows in row order
+        std::vector<plot_t> x_;                     ///< x values of rows_
+        std::vector<plot_t> y_;                     ///< y values of rows_
+        bool monotonic_;                            ///< flag whether x_ is ascending
+        std::vector< std::vector<int> > minima_;    ///< per level: position of the minimum in each bucket of 2^(level+1) points
+        std::vector< std::vector<int> > maxima_;    ///< per level: position of the maximum in each bucket of 2^(level+1) points
+        std::vector<int> result_;                   ///< rows returned by the last query
+    };
+
+    /// level of detail structure of a scatter plot
+    struct ScatterLod {
+        std::vector<unsigned int> codes_;           ///< sorted Morton codes of the points
+        std::vector<int> rows_;                     ///< rows according to codes_
+        tgt::dvec2 llf_;                            ///< lower left corner of the bounding box
+        tgt::dvec2 size_;                           ///< size of the bounding box
+        std::vector<int> result_;                   ///< rows returned by the last query
+    };
+
+    /// level of detail structure of a surface
+    struct SurfaceLod {
+        const std::vector<int>* triangles_;         ///< triangles this structure was built for
+        size_t triangleCount_;                      ///< size of triangles_ at build time
+        tgt::dvec2 llf_;                            ///< lower left corner of the bounding box
+        tgt::dvec2 size_;                           ///< size of the bounding box
+        std::vector<tgt::ivec2> cells_;             ///< per row: cell at the finest grid level, x = -1 for unused rows
+        std::map<int, std::vector<int> > levels_;   ///< decimated triangles per grid level
+    };
+
+    /// checks whether the cached structures belong to \a data and clears them otherwise
+    void validate(const PlotData& data);
+
+    void buildLine(const PlotData& data, int indexX, int indexY, LineLod& lod) const;
+    void buildScatter(const PlotData& data, int indexX, int indexY, ScatterLod& lod) const;
+    void buildSurface(const PlotData& data, const std::vector<int>& triangleVertexIndices, int indexX, int indexY, SurfaceLod& lod) const;
+
+    /// collects one representative per quadtree cell of level \a targetLevel intersecting the given domain
+    void queryScatter(const ScatterLod& lod, size_t first, size_t last, int level, unsigned int prefix, int targetLevel,
+        const Interval<plot_t>& xDomain, const Interval<plot_t>& yDomain, std::vector<int>& result) const;
+
+    const PlotData* data_;      ///< PlotData the cached structures belong to
+    unsigned long version_;     ///< version of data_ the cached structures belong to
+
+    std::map<std::pair<int, int>, LineLod> lines_;          ///< cached lines by x and y column
+    std::map<std::pair<int, int>, ScatterLod> scatters_;    ///< cached scatter plots by x and y column
+    std::map<std::pair<int, int>, SurfaceLod> surfaces_;    ///< cached surfaces by x and y column
+};
+
+} // namespace voreen
+
+#endif // VRN_PLOTDECIMATOR_H
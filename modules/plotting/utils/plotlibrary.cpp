@@ -27,6 +27,7 @@
  **********************************************************************/
 
 #include "plotlibrary.h"
+#include "plotrow.h"
 
 #include "voreen/core/voreenapplication.h"
 
@@ -36,6 +37,11 @@ namespace voreen {
 
 const std::string PlotLibrary::loggerCat_("voreen.plotting.PlotLibrary");
 
+namespace {
+    // number of grid cells along the x and y axis used for the vertex clustering of surfaces
+    const int SURFACE_GRID_SIZE = 128;
+}
+
 PlotLibrary::PlotLibrary()
     : centerAxesFlag_(false)
     , labelFont_(VoreenApplication::app()->getFontPath("Vera.ttf"))
@@ -68,6 +74,7 @@ PlotLibrary::PlotLibrary()
     , texturePath_()
     , ppm_(NULL)
     , usePlotPickingManager_(false)
+    , decimationFlag_(true)
 {
     labelFont_.setSize(8);
     domain_[0] = Interval<plot_t>(0, 1, false, false);
@@ -590,4 +597,49 @@ void PlotLibrary::setViewPortClipping(bool value) {
     viewPortClipping_ = value;
 }
 
+void PlotLibrary::setDecimationFlag(bool value) {
+    decimationFlag_ = value;
+    if (!decimationFlag_)
+        decimator_.clear();
+}
+
+const std::vector<int>& PlotLibrary::getLineRows(const PlotData& data, int indexX, int indexY) {
+    if (decimationFlag_)
+        return decimator_.decimateLine(data, indexX, indexY, domain_[X_AXIS], windowSize_.x - marginLeft_ - marginRight_);
+
+    allRows_.clear();
+    for (int row = 0; row < data.getRowsCount(); ++row) {
+        const PlotRowValue& rowValue = data.getRow(row);
+        if (!rowValue.getCellAt(indexX).isNull() && !rowValue.getCellAt(indexY).isNull())
+            allRows_.push_back(row);
+    }
+    return allRows_;
+}
+
+const std::vector<int>& PlotLibrary::getScatterRows(const PlotData& data, int indexX, int indexY, int indexZ,
+                                                    int indexCM, int indexSize) {
+    // points of one pixel may differ in color and size, so only uniform points are decimated
+    if (decimationFlag_ && (dimension_ == TWO || indexZ == -1) && indexCM == -1 && indexSize == -1
+        && !logarithmicAxisFlags_[X_AXIS] && !logarithmicAxisFlags_[Y_AXIS]) {
+        tgt::ivec2 pixelSize(windowSize_.x - marginLeft_ - marginRight_, windowSize_.y - marginBottom_ - marginTop_);
+        return decimator_.decimateScatter(data, indexX, indexY, (indexZ == -1 ? indexY : indexZ),
+                                          domain_[X_AXIS], domain_[Y_AXIS], pixelSize);
+    }
+
+    allRows_.clear();
+    for (int row = 0; row < data.getRowsCount(); ++row) {
+        const PlotRowValue& rowValue = data.getRow(row);
+        if (!rowValue.getCellAt(indexX).isNull() && !rowValue.getCellAt(indexY).isNull())
+            allRows_.push_back(row);
+    }
+    return allRows_;
+}
+
+const std::vector<int>& PlotLibrary::getSurfaceTriangles(const PlotData& data, const std::vector<int>& triangleVertexIndices,
+                                                         int indexX, int indexY) {
+    if (!decimationFlag_)
+        return triangleVertexIndices;
+    return decimator_.decimateSurface(data, triangleVertexIndices, indexX, indexY, domain_[X_AXIS], domain_[Y_AXIS], SURFACE_GRID_SIZE);
+}
+
 } // namespace
@@ -31,6 +31,7 @@
 
 #include "colormap.h"
 #include "plotdata.h"
+#include "plotdecimator.h"
 #include "smartlabel.h"
 #include "plotentitysettings.h"
 
@@ -418,6 +419,7 @@ public:
     void setPlotPickingManager(PlotPickingManager* ppm);
     void setUsePlotPickingManager(bool value);
     void setViewPortClipping(bool value);
+    void setDecimationFlag(bool value);
 
     /// Calculates the outer eges for each axis and saves them in according selectionEdges member.
     virtual void calculateSelectionEdges();
@@ -487,6 +489,21 @@ protected:
     /// renders a single glyph, the z value is only used for 3d plots
     virtual void renderGlyph(plot_t x, plot_t y, plot_t z = 0, plot_t size = 1) = 0;
 
+    /// Returns the rows without null cells of the line through \a indexX and \a indexY to render
+    /// at the current domain, decimated to the viewport resolution if decimationFlag_ is set.
+    const std::vector<int>& getLineRows(const PlotData& data, int indexX, int indexY);
+
+    /// Returns the rows without null cells to render in a scatter plot at the current domain, 2D
+    /// scatter plots with linear axes and without color or size column are decimated to one point
+    /// per pixel if decimationFlag_ is set. Highlighted points are never dropped.
+    const std::vector<int>& getScatterRows(const PlotData& data, int indexX, int indexY, int indexZ,
+                                           int indexCM, int indexSize);
+
+    /// Returns the triangles of a surface to render at the current domain, simplified by vertex
+    /// clustering if decimationFlag_ is set.
+    const std::vector<int>& getSurfaceTriangles(const PlotData& data, const std::vector<int>& triangleVertexIndices,
+                                                int indexX, int indexY);
+
     inline virtual tgt::Vector2<plot_t> logScale2dtoLogCoordinates(plot_t x, plot_t y) const;
     inline virtual tgt::Vector2<plot_t> logScale2dtoLogCoordinates(const tgt::Vector2<plot_t>& point) const;
     inline virtual tgt::Vector3<plot_t> logScale3dtoLogCoordinates(plot_t x, plot_t y, plot_t z) const;
@@ -529,6 +546,9 @@ protected:
     std::string texturePath_;
     PlotPickingManager* ppm_;       ///< used to render pickable objects
     bool usePlotPickingManager_;    ///< if true, the color is set by PlotPickingManager if the render method is able to render pickable objects
+    bool decimationFlag_;           ///< flag whether to reduce lines, scatter plots and surfaces to the viewport resolution
+    PlotDecimator decimator_;       ///< caches the level of detail structures for decimation
+    std::vector<int> allRows_;      ///< rows returned by getLineRows() and getScatterRows() without decimation
 
     tgt::dvec2 plotToViewportScale_;
 
@@ -313,35 +313,27 @@ bool PlotLibraryLatex::setRenderStatus() {
 void PlotLibraryLatex::renderLine(const PlotData& data, int indexX, int indexY) {
     if (usePlotPickingManager_)
         return;
-    //row iterator
-    std::vector<PlotRowValue>::const_iterator it = data.getRowsBegin();
+    // rows to render, rows with null entries are already left out
+    const std::vector<int>& rows = getLineRows(data, indexX, indexY);
+    if (rows.size() < 2)
+        return;
     // check if only values or only tags in given cells
     bool tagsInX = (data.getColumnType(indexX) == PlotBase::STRING);
     bool lineIsHighlighted = data.isHighlighted(tgt::ivec2(-1,indexY));
     PlotLibraryFileBase::Projection_Coordinates point1, point2;
-    int i = 0;
     double x = 0.0; double y = 0.0; //they are set in the loop
-    //go to the first row with non null entries
-    while (it->getCellAt(indexX).isNull() || it->getCellAt(indexY).isNull()) {
-        ++it; ++i;
-    }
-    if (it == data.getRowsEnd() || it == --data.getRowsEnd())
-        return;
 
     // draw the line
-    double oldX = tagsInX ? i : it->getValueAt(indexX);
-    double oldY = it->getValueAt(indexY);
+    double oldX = tagsInX ? rows[0] : data.getRow(rows[0]).getValueAt(indexX);
+    double oldY = data.getRow(rows[0]).getValueAt(indexY);
     if (lineIsHighlighted)
         latexColor_ = highlightColor_;
     else
         latexColor_ = drawingColor_;
-    for (++it, ++i; it != data.getRowsEnd(); ++it, ++i) {
-        //we ignore rows with null entries
-        if (it->getCellAt(indexX).isNull() || it->getCellAt(indexY).isNull()) {
-            continue;
-        }
-        x = tagsInX ? i : it->getValueAt(indexX);
-        y = it->getValueAt(indexY);
+    for (size_t i = 1; i < rows.size(); ++i) {
+        const PlotRowValue& row = data.getRow(rows[i]);
+        x = tagsInX ? rows[i] : row.getValueAt(indexX);
+        y = row.getValueAt(indexY);
         point1 = convertPlotCoordinatesToViewport3Projection(oldX,oldY,0);
         point2 = convertPlotCoordinatesToViewport3Projection(x,y,0);
         latexLine(point1,point2,latexColor_,1,lineWidth_,lineStyle_);
@@ -354,14 +346,11 @@ void PlotLibraryLatex::renderLine(const PlotData& data, int indexX, int indexY)
     }
 
     // render the points
-    for (it = data.getRowsBegin(), i = 0; it != data.getRowsEnd(); ++it, ++i) {
-        //we ignore rows with null entries
-        if (it->getCellAt(indexX).isNull() || it->getCellAt(indexY).isNull()) {
-            continue;
-        }
-        x = tagsInX ? i : it->getValueAt(indexX);
-        y = it->getValueAt(indexY);
-        if (it->getCellAt(indexY).isHighlighted())
+    for (size_t i = 0; i < rows.size(); ++i) {
+        const PlotRowValue& row = data.getRow(rows[i]);
+        x = tagsInX ? rows[i] : row.getValueAt(indexX);
+        y = row.getValueAt(indexY);
+        if (row.getCellAt(indexY).isHighlighted())
             latexColor_ = highlightColor_;
         else
             latexColor_ = drawingColor_;
@@ -683,7 +672,8 @@ void PlotLibraryLatex::renderSurface(const PlotData& data, const std::vector<int
     PlotLibraryFileBase::Projection_Coordinates p3;
     PlotLibraryFileBase::Projection_Coordinates p4;
     std::vector< PlotLibraryFileBase::Projection_Coordinates > points;
-    for (std::vector<int>::const_iterator it = triangleVertexIndices.begin(); it < triangleVertexIndices.end(); it += 3) {
+    const std::vector<int>& triangles = getSurfaceTriangles(data, triangleVertexIndices, indexX, indexY);
+    for (std::vector<int>::const_iterator it = triangles.begin(); it < triangles.end(); it += 3) {
         points.clear();
         latexColor_ = drawingColor_;
         for (int i=0; i<3; ++i) {
@@ -1027,26 +1017,21 @@ void PlotLibraryLatex::renderScatter(const PlotData& data, int indexX, int index
     }
 
 
-    //row iterator
-    int i = 0;
-    std::vector<PlotRowValue>::const_iterator it = data.getRowsBegin();
-
-    for (; it != data.getRowsEnd(); ++it, ++i) {
-        //we ignore rows with null entries
-        if (it->getCellAt(indexX).isNull() || it->getCellAt(indexY).isNull()) {
-            continue;
-        }
-        x = it->getValueAt(indexX); y = it->getValueAt(indexY); z = (indexZ == -1 ? 0 : it->getValueAt(indexZ));
+    // rows to render, rows with null entries are already left out
+    const std::vector<int>& rows = getScatterRows(data, indexX, indexY, indexZ, indexCM, indexSize);
+    for (size_t i = 0; i < rows.size(); ++i) {
+        const PlotRowValue& row = data.getRow(rows[i]);
+        x = row.getValueAt(indexX); y = row.getValueAt(indexY); z = (indexZ == -1 ? 0 : row.getValueAt(indexZ));
         //check if the point is inside the domains
         if (domain_[X_AXIS].contains(x) && domain_[Y_AXIS].contains(y) && (dimension_ == TWO || domain_[Z_AXIS].contains(z))) {
             // set color
             if (texture_ != 0)
                 latexColor_ = textureColor;
-            else if ((indexZ != -1 && it->getCellAt(indexZ).isHighlighted())
-                    || (indexZ == -1 && it->getCellAt(indexY).isHighlighted()))
+            else if ((indexZ != -1 && row.getCellAt(indexZ).isHighlighted())
+                    || (indexZ == -1 && row.getCellAt(indexY).isHighlighted()))
                 latexColor_ = highlightColor_;
             else if (indexCM != -1 ) {
-                float c = static_cast<float>((it->getValueAt(indexCM) - colInterval.getLeft()) / colInterval.size());
+                float c = static_cast<float>((row.getValueAt(indexCM) - colInterval.getLeft()) / colInterval.size());
                 latexColor_ = colorMap_.getColorAtPosition(c);
             }
             else
@@ -1054,7 +1039,7 @@ void PlotLibraryLatex::renderScatter(const PlotData& data, int indexX, int index
             // set size
             if (indexSize != -1 ) {
                 size = minGlyphSize_ + (maxGlyphSize_ - minGlyphSize_) *
-                            (it->getValueAt(indexSize) - sizeInterval.getLeft()) / sizeInterval.size();
+                            (row.getValueAt(indexSize) - sizeInterval.getLeft()) / sizeInterval.size();
             }
             renderGlyph(x, y, z, size);
         }
@@ -154,8 +154,10 @@ bool PlotLibraryOpenGl::setRenderStatus() {
 }
 
 void PlotLibraryOpenGl::renderLine(const PlotData& data, int indexX, int indexY) {
-    //row iterator
-    std::vector<PlotRowValue>::const_iterator it = data.getRowsBegin();
+    // rows to render, rows with null entries are already left out
+    const std::vector<int>& rows = getLineRows(data, indexX, indexY);
+    if (rows.size() < 2)
+        return;
     // check if only values or only tags in given cells
     bool tagsInX = (data.getColumnType(indexX) == PlotBase::STRING);
     //set up some opengl settings
@@ -173,31 +175,21 @@ void PlotLibraryOpenGl::renderLine(const PlotData& data, int indexX, int indexY)
         else //DASHED
             glLineStipple(1, 0x00FF);
     }
-    int i = 0;
     double x = 0.0; double y = 0.0; //they are set in the loop
-    //go to the first row with non null entries
-    while (it->getCellAt(indexX).isNull() || it->getCellAt(indexY).isNull()) {
-        ++it; ++i;
-    }
-    if (it == data.getRowsEnd() || it == --data.getRowsEnd())
-        return;
 
     // draw the line
-    double oldX = tagsInX ? i : it->getValueAt(indexX);
-    double oldY = it->getValueAt(indexY);
+    double oldX = tagsInX ? rows[0] : data.getRow(rows[0]).getValueAt(indexX);
+    double oldY = data.getRow(rows[0]).getValueAt(indexY);
     if (usePlotPickingManager_)
         ppm_->setGLColor(-1, indexY);
     else if (lineIsHighlighted)
         glColor4fv(highlightColor_.elem);
     else
         glColor4fv(drawingColor_.elem);
-    for (++it, ++i; it != data.getRowsEnd(); ++it, ++i) {
-        //we ignore rows with null entries
-        if (it->getCellAt(indexX).isNull() || it->getCellAt(indexY).isNull()) {
-            continue;
-        }
-        x = tagsInX ? i : it->getValueAt(indexX);
-        y = it->getValueAt(indexY);
+    for (size_t i = 1; i < rows.size(); ++i) {
+        const PlotRowValue& row = data.getRow(rows[i]);
+        x = tagsInX ? rows[i] : row.getValueAt(indexX);
+        y = row.getValueAt(indexY);
         glBegin(GL_LINES);
             logGlVertex2d(oldX, oldY);
             logGlVertex2d(x, y);
@@ -212,16 +204,13 @@ void PlotLibraryOpenGl::renderLine(const PlotData& data, int indexX, int indexY)
     // render the points
     glPointSize(maxGlyphSize_);
     glBegin(GL_POINTS);
-    for (it = data.getRowsBegin(), i = 0; it != data.getRowsEnd(); ++it, ++i) {
-        //we ignore rows with null entries
-        if (it->getCellAt(indexX).isNull() || it->getCellAt(indexY).isNull()) {
-            continue;
-        }
-        x = tagsInX ? i : it->getValueAt(indexX);
-        y = it->getValueAt(indexY);
+    for (size_t i = 0; i < rows.size(); ++i) {
+        const PlotRowValue& row = data.getRow(rows[i]);
+        x = tagsInX ? rows[i] : row.getValueAt(indexX);
+        y = row.getValueAt(indexY);
         if (usePlotPickingManager_)
-            ppm_->setGLColor(i, indexY);
-        else if (it->getCellAt(indexY).isHighlighted())
+            ppm_->setGLColor(rows[i], indexY);
+        else if (row.getCellAt(indexY).isHighlighted())
             glColor4fv(highlightColor_.elem);
         else
             glColor4fv(drawingColor_.elem);
@@ -596,7 +585,8 @@ void PlotLibraryOpenGl::renderSurface(const PlotData& data, const std::vector<in
     glLineWidth(lineWidth_);
     // draw the triangles
     std::set<int> renderedHighlights; // we want to render each plot label // highlight only once
-    for (std::vector<int>::const_iterator it = triangleVertexIndices.begin(); it < triangleVertexIndices.end(); it += 3) {
+    const std::vector<int>& triangles = getSurfaceTriangles(data, triangleVertexIndices, indexX, indexY);
+    for (std::vector<int>::const_iterator it = triangles.begin(); it < triangles.end(); it += 3) {
         // render plot picking data?
         if (usePlotPickingManager_) {
             // to write out the PlotCell information to the ppm, we subdivide our triangle into three
@@ -951,26 +941,21 @@ void PlotLibraryOpenGl::renderScatter(const PlotData& data, int indexX, int inde
         if (sizeInterval.size() == 0)
             indexSize = -1;
     }
-    //row iterator
-    int i = 0;
-    std::vector<PlotRowValue>::const_iterator it = data.getRowsBegin();
-
-    for (; it != data.getRowsEnd(); ++it, ++i) {
-        //we ignore rows with null entries
-        if (it->getCellAt(indexX).isNull() || it->getCellAt(indexY).isNull()) {
-            continue;
-        }
-        x = it->getValueAt(indexX); y = it->getValueAt(indexY); z = (indexZ == -1 ? 0 : it->getValueAt(indexZ));
+    // rows to render, rows with null entries are already left out
+    const std::vector<int>& rows = getScatterRows(data, indexX, indexY, indexZ, indexCM, indexSize);
+    for (size_t i = 0; i < rows.size(); ++i) {
+        const PlotRowValue& row = data.getRow(rows[i]);
+        x = row.getValueAt(indexX); y = row.getValueAt(indexY); z = (indexZ == -1 ? 0 : row.getValueAt(indexZ));
         //check if the point is inside the domains
         if (domain_[X_AXIS].contains(x) && domain_[Y_AXIS].contains(y) && (dimension_ == TWO || domain_[Z_AXIS].contains(z))) {
             // set color
             if (usePlotPickingManager_)
-                ppm_->setGLColor(i,indexZ == -1 ? indexY : indexZ);
-            else if ((indexZ != -1 && it->getCellAt(indexZ).isHighlighted())
-                    || (indexZ == -1 && it->getCellAt(indexY).isHighlighted()))
+                ppm_->setGLColor(rows[i],indexZ == -1 ? indexY : indexZ);
+            else if ((indexZ != -1 && row.getCellAt(indexZ).isHighlighted())
+                    || (indexZ == -1 && row.getCellAt(indexY).isHighlighted()))
                 glColor4fv(highlightColor_.elem);
             else if (indexCM != -1 ) {
-                float c = static_cast<float>((it->getValueAt(indexCM) - colInterval.getLeft()) / colInterval.size());
+                float c = static_cast<float>((row.getValueAt(indexCM) - colInterval.getLeft()) / colInterval.size());
                 tgt::Color cc = colorMap_.getColorAtPosition(c);
                 glColor4fv(cc.elem);
             }
@@ -979,7 +964,7 @@ void PlotLibraryOpenGl::renderScatter(const PlotData& data, int indexX, int inde
             // set size
             if (indexSize != -1 ) {
                 size = minGlyphSize_ + (maxGlyphSize_ - minGlyphSize_) *
-                            (it->getValueAt(indexSize) - sizeInterval.getLeft()) / sizeInterval.size();
+                            (row.getValueAt(indexSize) - sizeInterval.getLeft()) / sizeInterval.size();
             }
             renderGlyph(x, y, z, size);
         }
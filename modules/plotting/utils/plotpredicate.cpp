@@ -32,6 +32,7 @@
 #include <sstream>
 #include <iomanip>
 #include <string>
+#include <algorithm>
 
 namespace voreen {
 
@@ -45,6 +46,13 @@ namespace {
     }
 }
 
+// PlotPredicate methods -----------------------------------------------------------
+
+void PlotPredicate::checkValues(const plot_t* values, size_t count, char* results) const {
+    for (size_t i = 0; i < count; ++i)
+        results[i] = check(PlotCellValue(values[i]));
+}
+
 // PlotPredicateLess methods -------------------------------------------------------
 
 PlotPredicateLess::PlotPredicateLess()
@@ -88,6 +96,16 @@ bool PlotPredicateLess::check(const PlotCellValue& value) const {
         || (value.isTag() && threshold_.isTag() && value.getTag() < threshold_.getTag()));
 }
 
+void PlotPredicateLess::checkValues(const plot_t* values, size_t count, char* results) const {
+    if (!threshold_.isValue()) {
+        std::fill(results, results + count, 0);
+        return;
+    }
+    const plot_t threshold = threshold_.getValue();
+    for (size_t i = 0; i < count; ++i)
+        results[i] = (values[i] < threshold);
+}
+
 Interval<plot_t> PlotPredicateLess::getIntervalRepresentation() const {
     return Interval<plot_t>(-std::numeric_limits<plot_t>::max(), threshold_.getValue(), false, true);
 }
@@ -162,6 +180,16 @@ bool PlotPredicateEqual::check(const PlotCellValue& value) const {
         (value.isTag() && threshold_.isTag() && value.getTag() == threshold_.getTag()));
 }
 
+void PlotPredicateEqual::checkValues(const plot_t* values, size_t count, char* results) const {
+    if (!threshold_.isValue()) {
+        std::fill(results, results + count, 0);
+        return;
+    }
+    const plot_t threshold = threshold_.getValue();
+    for (size_t i = 0; i < count; ++i)
+        results[i] = (values[i] == threshold);
+}
+
 Interval<plot_t> PlotPredicateEqual::getIntervalRepresentation() const {
     return Interval<plot_t>(threshold_.getValue(), threshold_.getValue(), false, false);
 }
@@ -236,6 +264,16 @@ bool PlotPredicateGreater::check(const PlotCellValue& value) const {
         (value.isTag() && threshold_.isTag() && value.getTag() > threshold_.getTag()));
 }
 
+void PlotPredicateGreater::checkValues(const plot_t* values, size_t count, char* results) const {
+    if (!threshold_.isValue()) {
+        std::fill(results, results + count, 0);
+        return;
+    }
+    const plot_t threshold = threshold_.getValue();
+    for (size_t i = 0; i < count; ++i)
+        results[i] = (values[i] > threshold);
+}
+
 Interval<plot_t> PlotPredicateGreater::getIntervalRepresentation() const {
     return Interval<plot_t>(threshold_.getValue(), std::numeric_limits<plot_t>::max(), true, false);
 }
@@ -321,6 +359,17 @@ bool PlotPredicateBetween::check(const PlotCellValue& value) const {
         value.getTag() > lowerThreshold_.getTag() && value.getTag() < upperThreshold_.getTag()));
 }
 
+void PlotPredicateBetween::checkValues(const plot_t* values, size_t count, char* results) const {
+    if (!lowerThreshold_.isValue() || !upperThreshold_.isValue()) {
+        std::fill(results, results + count, 0);
+        return;
+    }
+    const plot_t lower = lowerThreshold_.getValue();
+    const plot_t upper = upperThreshold_.getValue();
+    for (size_t i = 0; i < count; ++i)
+        results[i] = (values[i] > lower && values[i] < upper);
+}
+
 Interval<plot_t> PlotPredicateBetween::getIntervalRepresentation() const {
     return Interval<plot_t>(lowerThreshold_.getValue(), upperThreshold_.getValue(), true, true);
 }
@@ -417,6 +466,17 @@ bool PlotPredicateNotBetween::check(const PlotCellValue& value) const {
         (value.getTag() <= lowerThreshold_.getTag() || value.getTag() >= upperThreshold_.getTag())));
 }
 
+void PlotPredicateNotBetween::checkValues(const plot_t* values, size_t count, char* results) const {
+    if (!lowerThreshold_.isValue() || !upperThreshold_.isValue()) {
+        std::fill(results, results + count, 0);
+        return;
+    }
+    const plot_t lower = lowerThreshold_.getValue();
+    const plot_t upper = upperThreshold_.getValue();
+    for (size_t i = 0; i < count; ++i)
+        results[i] = (values[i] <= lower || values[i] >= upper);
+}
+
 Interval<plot_t> PlotPredicateNotBetween::getIntervalRepresentation() const {
     return Interval<plot_t>(upperThreshold_.getValue(),lowerThreshold_.getValue(), false, false);
 }
@@ -522,6 +582,17 @@ bool PlotPredicateBetweenOrEqual::check(const PlotCellValue& value) const {
     return false;
 }
 
+void PlotPredicateBetweenOrEqual::checkValues(const plot_t* values, size_t count, char* results) const {
+    if (!lowerThreshold_.isValue() || !upperThreshold_.isValue()) {
+        std::fill(results, results + count, 0);
+        return;
+    }
+    const plot_t lower = lowerThreshold_.getValue();
+    const plot_t upper = upperThreshold_.getValue();
+    for (size_t i = 0; i < count; ++i)
+        results[i] = (values[i] >= lower && values[i] <= upper);
+}
+
 Interval<plot_t> PlotPredicateBetweenOrEqual::getIntervalRepresentation() const {
     return Interval<plot_t>(lowerThreshold_.getValue(), upperThreshold_.getValue(), false, false);
 }
@@ -627,6 +698,17 @@ bool PlotPredicateNotBetweenOrEqual::check(const PlotCellValue& value) const {
     return false;
 }
 
+void PlotPredicateNotBetweenOrEqual::checkValues(const plot_t* values, size_t count, char* results) const {
+    if (!lowerThreshold_.isValue() || !upperThreshold_.isValue()) {
+        std::fill(results, results + count, 0);
+        return;
+    }
+    const plot_t lower = lowerThreshold_.getValue();
+    const plot_t upper = upperThreshold_.getValue();
+    for (size_t i = 0; i < count; ++i)
+        results[i] = (values[i] < lower || values[i] > upper);
+}
+
 Interval<plot_t> PlotPredicateNotBetweenOrEqual::getIntervalRepresentation() const {
     return Interval<plot_t>(upperThreshold_.getValue(),lowerThreshold_.getValue(), true, true);
 }
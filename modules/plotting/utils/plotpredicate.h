@@ -59,6 +59,16 @@ public:
     /// checks whether value stored in PlotCell \a value fulfills the predicate
     virtual bool check(const PlotCellValue& value) const = 0;
 
+    /**
+     * Checks the \a count numeric values in \a values at once and stores in \a results whether
+     * they fulfill the predicate (as check() would do for a PlotCellValue holding the value).
+     * NaN entries stand for cells not holding a value, their results are ignored by the caller.
+     *
+     * The default implementation calls check() for each value, predicates comparing against
+     * numeric thresholds override this with a tight loop.
+     */
+    virtual void checkValues(const plot_t* values, size_t count, char* results) const;
+
     /// Returns an interval representation of the PlotPredicate if possible, non numeric predicates return an empty interval.
     virtual Interval<plot_t> getIntervalRepresentation() const = 0;
 
@@ -113,6 +123,8 @@ public:
 
     /// checks whether value stored in PlotCell \a value fulfills the predicate
     bool check(const PlotCellValue& value) const;
+    /// checks all numeric values in \a values in one tight loop
+    void checkValues(const plot_t* values, size_t count, char* results) const;
 
     /// Returns an interval representation of the PlotPredicate if possible, non numeric predicates return an empty interval.
     virtual Interval<plot_t> getIntervalRepresentation() const;
@@ -178,6 +190,8 @@ public:
 
     /// checks whether value stored in PlotCell \a value fulfills the predicate
     bool check(const PlotCellValue& value) const;
+    /// checks all numeric values in \a values in one tight loop
+    void checkValues(const plot_t* values, size_t count, char* results) const;
 
     /// Returns an interval representation of the PlotPredicate if possible, non numeric predicates return an empty interval.
     virtual Interval<plot_t> getIntervalRepresentation() const;
@@ -242,6 +256,8 @@ public:
 
     /// checks whether value stored in PlotCell \a value fulfills the predicate
     bool check(const PlotCellValue& value) const;
+    /// checks all numeric values in \a values in one tight loop
+    void checkValues(const plot_t* values, size_t count, char* results) const;
 
     /// Returns an interval representation of the PlotPredicate if possible, non numeric predicates return an empty interval.
     virtual Interval<plot_t> getIntervalRepresentation() const;
@@ -313,6 +329,8 @@ public:
 
     /// checks whether value stored in PlotCell \a value fulfills the predicate
     bool check(const PlotCellValue& value) const;
+    /// checks all numeric values in \a values in one tight loop
+    void checkValues(const plot_t* values, size_t count, char* results) const;
 
     /// creates a deep copy of the current PlotPredicate
     virtual PlotPredicate* clone() const;
@@ -381,6 +399,8 @@ public:
 
     /// checks whether value stored in PlotCell \a value fulfills the predicate
     bool check(const PlotCellValue& value) const;
+    /// checks all numeric values in \a values in one tight loop
+    void checkValues(const plot_t* values, size_t count, char* results) const;
 
     /// creates a deep copy of the current PlotPredicate
     virtual PlotPredicate* clone() const;
@@ -449,6 +469,8 @@ public:
 
     /// checks whether value stored in PlotCell \a value fulfills the predicate
     virtual bool check(const PlotCellValue& value) const;
+    /// checks all numeric values in \a values in one tight loop
+    virtual void checkValues(const plot_t* values, size_t count, char* results) const;
 
     /// creates a deep copy of the current PlotPredicate
     virtual PlotPredicate* clone() const;
@@ -517,6 +539,8 @@ public:
 
     /// checks whether value stored in PlotCell \a value fulfills the predicate
     virtual bool check(const PlotCellValue& value) const;
+    /// checks all numeric values in \a values in one tight loop
+    virtual void checkValues(const plot_t* values, size_t count, char* results) const;
 
     /// creates a deep copy of the current PlotPredicate
     virtual PlotPredicate* clone() const;
@@ -36,15 +36,17 @@ The author's contact address is:
 #include "voreen/core/io/progressbar.h"
 #include "tgt/exception.h"
 
-FILE *DDS_file;
+#include <algorithm>
+#include <locale>
+#include <sstream>
+#include <vector>
 
-char DDS_ID[] = "DDS v3d\n";
-char DDS_ID2[] = "DDS v3e\n";
-
-unsigned int DDS_buffer;
-int DDS_bufsize, DDS_bitcnt;
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
-unsigned short int DDS_INTEL = 1;
+static const char DDS_ID[] = "DDS v3d\n";
+static const char DDS_ID2[] = "DDS v3e\n";
 
 inline unsigned int DDS_shiftl(const unsigned int value, const int bits) {
     return ((bits >= 32) ? 0 : value << bits);
@@ -54,12 +56,6 @@ inline unsigned int DDS_shiftr(const unsigned int value, const int bits) {
     return ((bits >= 32) ? 0 : value >> bits);
 }
 
-void initbuffer() {
-    DDS_buffer = 0;
-    DDS_bufsize = 0;
-    DDS_bitcnt = 0;
-}
-
 void DDS_swapuint(unsigned int *x) {
     unsigned int tmp = *x;
 
@@ -69,73 +65,57 @@ void DDS_swapuint(unsigned int *x) {
          ((tmp & 0xff000000) >> 24);
 }
 
-void writebits(FILE *file, unsigned int value, int bits) {
-    if (bits < 0 || bits > 32)
-        ERRORMSG();
-
-    if (bits == 0)
-        return ;
+namespace {
 
-    value &= DDS_shiftl(1, bits) - 1;
+// state of a bit stream being written, kept per stream so that several files can be written concurrently
+struct DDSBitWriter {
+    DDSBitWriter(FILE *file)
+        : file_(file), buffer_(0), bufsize_(0), bitcnt_(0)
+    {}
 
-    if (DDS_bufsize + bits < 32) {
-        DDS_buffer = DDS_shiftl(DDS_buffer, bits) | value;
-        DDS_bufsize += bits;
-    } else {
-        DDS_buffer = DDS_shiftl(DDS_buffer, 32 - DDS_bufsize);
-        DDS_bufsize += bits - 32;
-        DDS_buffer |= DDS_shiftr(value, DDS_bufsize);
-        if (DDS_ISINTEL)
-            DDS_swapuint(&DDS_buffer);
-        if (fwrite(&DDS_buffer, 4, 1, file) != 1)
+    void writebits(unsigned int value, int bits) {
+        if (bits < 0 || bits > 32)
             ERRORMSG();
-        DDS_buffer = value & (DDS_shiftl(1, DDS_bufsize) - 1);
-    }
 
-    DDS_bitcnt += bits;
-}
+        if (bits == 0)
+            return ;
 
-void flushbits(FILE *file) {
-    if (DDS_bufsize > 0) {
-        DDS_buffer = DDS_shiftl(DDS_buffer, 32 - DDS_bufsize);
-        if (DDS_ISINTEL)
-            DDS_swapuint(&DDS_buffer);
-        if (fwrite(&DDS_buffer, (DDS_bufsize + 7) / 8, 1, file) != 1)
-            ERRORMSG();
-        DDS_bitcnt += (32 - DDS_bufsize) & 7;
-    }
-}
+        value &= DDS_shiftl(1, bits) - 1;
 
-unsigned int readbits(FILE *file, int bits) {
-    unsigned int value;
-
-    if (bits < 0 || bits > 32)
-        ERRORMSG();
+        if (bufsize_ + bits < 32) {
+            buffer_ = DDS_shiftl(buffer_, bits) | value;
+            bufsize_ += bits;
+        } else {
+            buffer_ = DDS_shiftl(buffer_, 32 - bufsize_);
+            bufsize_ += bits - 32;
+            buffer_ |= DDS_shiftr(value, bufsize_);
+            if (DDS_ISINTEL)
+                DDS_swapuint(&buffer_);
+            if (fwrite(&buffer_, 4, 1, file_) != 1)
+                ERRORMSG();
+            buffer_ = value & (DDS_shiftl(1, bufsize_) - 1);
+        }
 
-    if (bits == 0)
-        return (0);
+        bitcnt_ += bits;
+    }
 
-    if (bits < DDS_bufsize) {
-        DDS_bufsize -= bits;
-        value = DDS_shiftr(DDS_buffer, DDS_bufsize);
-    } else {
-        value = DDS_shiftl(DDS_buffer, bits - DDS_bufsize);
-        DDS_buffer = 0;
-        size_t read = fread(&DDS_buffer, 1, 4, file);
-        if (read == 0)
-            return value;//ERRORMSG();  //FIXME: we ignore this error, necessary to load the
-                                        //       16-bit bonsai PVM files from The Volume  Library. joerg
-        if (DDS_ISINTEL)
-            DDS_swapuint(&DDS_buffer);
-        DDS_bufsize += 32 - bits;
-        value |= DDS_shiftr(DDS_buffer, DDS_bufsize);
+    void flushbits() {
+        if (bufsize_ > 0) {
+            buffer_ = DDS_shiftl(buffer_, 32 - bufsize_);
+            if (DDS_ISINTEL)
+                DDS_swapuint(&buffer_);
+            if (fwrite(&buffer_, (bufsize_ + 7) / 8, 1, file_) != 1)
+                ERRORMSG();
+            bitcnt_ += (32 - bufsize_) & 7;
+        }
     }
 
-    DDS_buffer &= DDS_shiftl(1, DDS_bufsize) - 1;
-    DDS_bitcnt += bits;
+    FILE *file_;
+    unsigned int buffer_;
+    int bufsize_, bitcnt_;
+};
 
-    return (value);
-}
+} // namespace
 
 inline int DDS_code(int bits) {
     return (bits > 1 ? bits - 1 : bits);
@@ -145,65 +125,58 @@ inline int DDS_decode(int bits) {
     return (bits >= 1 ? bits + 1 : bits);
 }
 
-// deinterleave a byte stream
+// deinterleave a byte stream, the blocks of skip*block bytes are processed in parallel
 void deinterleave(unsigned char *data, unsigned int bytes, unsigned int skip, unsigned int block = 0, BOOLINT restore = FALSE) {
-    unsigned int i, j, k;
-
-    unsigned char *data2, *ptr;
-
     if (skip <= 1)
         return ;
 
-    if (block == 0) {
-        if ((data2 = (unsigned char *)malloc(bytes)) == NULL)
-            ERRORMSG();
-
-        if (!restore)
-            for (ptr = data2, i = 0; i < skip; i++)
-                for (j = i; j < bytes; j += skip)
-                    * ptr++ = data[j];
-        else
-            for (ptr = data, i = 0; i < skip; i++)
-                for (j = i; j < bytes; j += skip)
-                    data2[j] = *ptr++;
-
-        memcpy(data, data2, bytes);
-    } else {
-        if ((data2 = (unsigned char *)malloc((bytes < skip * block) ? bytes : skip * block)) == NULL)
-            ERRORMSG();
-
-        if (!restore) {
-            for (k = 0; k < bytes / skip / block; k++) {
-                for (ptr = data2, i = 0; i < skip; i++)
-                    for (j = i; j < skip*block; j += skip)
-                        * ptr++ = data[k * skip * block + j];
-
-                memcpy(data + k*skip*block, data2, skip*block);
-            }
-
-            for (ptr = data2, i = 0; i < skip; i++)
-                for (j = i; j < bytes - k*skip*block; j += skip)
-                    * ptr++ = data[k * skip * block + j];
-
-            memcpy(data + k*skip*block, data2, bytes - k*skip*block);
-        } else {
-            for (k = 0; k < bytes / skip / block; k++) {
-                for (ptr = data + k * skip * block, i = 0; i < skip; i++)
-                    for (j = i; j < skip*block; j += skip)
-                        data2[j] = *ptr++;
+    const size_t chunk = (block == 0 || static_cast<size_t>(skip) * block > bytes) ? bytes : static_cast<size_t>(skip) * block;
+    const int numChunks = static_cast<int>((bytes + chunk - 1) / chunk);
+
+    bool failed = false;
+
+    #ifdef _OPENMP
+    #pragma omp parallel
+    #endif
+    {
+        unsigned char *data2 = (unsigned char *)malloc(chunk);
+        if (data2 == NULL) {
+            #ifdef _OPENMP
+            #pragma omp critical
+            #endif
+            failed = true;
+        }
 
-                memcpy(data + k*skip*block, data2, skip*block);
+        #ifdef _OPENMP
+        #pragma omp for schedule(dynamic)
+        #endif
+        for (int k = 0; k < numChunks; k++) {
+            if (data2 == NULL)
+                continue;
+
+            unsigned char *src = data + k * chunk;
+            const size_t size = std::min(chunk, bytes - k * chunk);
+            unsigned char *ptr = data2;
+
+            if (!restore) {
+                for (size_t i = 0; i < skip; i++)
+                    for (size_t j = i; j < size; j += skip)
+                        *ptr++ = src[j];
+            } else {
+                const unsigned char *sptr = src;
+                for (size_t i = 0; i < skip; i++)
+                    for (size_t j = i; j < size; j += skip)
+                        data2[j] = *sptr++;
             }
 
-            for (ptr = data + k * skip * block, i = 0; i < skip; i++)
-                for (j = i; j < bytes - k*skip*block; j += skip)
-                    data2[j] = *ptr++;
-
-            memcpy(data + k*skip*block, data2, bytes - k*skip*block);
+            memcpy(src, data2, size);
         }
+
+        free(data2);
     }
 
-    free(data2);
+    if (failed)
+        ERRORMSG();
 }
 
 // interleave a byte stream
@@ -235,18 +208,18 @@ void writeDDSfile(char *filename, unsigned char *data, unsigned int bytes, unsig
     if (strip < 1 || strip > 65536)
         strip = 1;
 
-    if ((DDS_file = fopen(filename, "wb")) == NULL)
+    FILE *file;
+    if ((file = fopen(filename, "wb")) == NULL)
         ERRORMSG();
 
-    fprintf(DDS_file, (version == 1) ? DDS_ID : DDS_ID2, 0); //supress gcc warning
-    //fprintf(DDS_file, (version == 1) ? DDS_ID : DDS_ID2);
+    fputs((version == 1) ? DDS_ID : DDS_ID2, file);
 
     deinterleave(data, bytes, skip, DDS_INTERLEAVE);
 
-    initbuffer();
+    DDSBitWriter writer(file);
 
-    writebits(DDS_file, skip - 1, 2);
-    writebits(DDS_file, strip++ -1, 16);
+    writer.writebits(skip - 1, 2);
+    writer.writebits(strip++ -1, 16);
 
     ptr1 = ptr2 = data;
     pre1 = pre2 = 0;
@@ -292,8 +265,8 @@ void writeDDSfile(char *filename, unsigned char *data, unsigned int bytes, unsig
             if (bits1 > bits2)
                 bits2 = bits1;
         } else {
-            writebits(DDS_file, cnt2, DDS_RL);
-            writebits(DDS_file, DDS_code(bits2), 3);
+            writer.writebits(cnt2, DDS_RL);
+            writer.writebits(DDS_code(bits2), 3);
 
             while (cnt2-- > 0) {
                 tmp2 = *ptr2++;
@@ -308,7 +281,7 @@ void writeDDSfile(char *filename, unsigned char *data, unsigned int bytes, unsig
                 while (act2 > 127)
                     act2 -= 256;
 
-                writebits(DDS_file, act2 + (1 << bits2) / 2, bits2);
+                writer.writebits(act2 + (1 << bits2) / 2, bits2);
             }
 
             cnt2 = cnt1;
@@ -324,8 +297,8 @@ void writeDDSfile(char *filename, unsigned char *data, unsigned int bytes, unsig
         if (bits1 > bits2)
             bits2 = bits1;
     } else {
-        writebits(DDS_file, cnt2, DDS_RL);
-        writebits(DDS_file, DDS_code(bits2), 3);
+        writer.writebits(cnt2, DDS_RL);
+        writer.writebits(DDS_code(bits2), 3);
 
         while (cnt2-- > 0) {
             tmp2 = *ptr2++;
@@ -340,7 +313,7 @@ void writeDDSfile(char *filename, unsigned char *data, unsigned int bytes, unsig
             while (act2 > 127)
                 act2 -= 256;
 
-            writebits(DDS_file, act2 + (1 << bits2) / 2, bits2);
+            writer.writebits(act2 + (1 << bits2) / 2, bits2);
         }
 
         cnt2 = cnt1;
@@ -348,8 +321,8 @@ void writeDDSfile(char *filename, unsigned char *data, unsigned int bytes, unsig
     }
 
     if (cnt2 != 0) {
-        writebits(DDS_file, cnt2, DDS_RL);
-        writebits(DDS_file, DDS_code(bits2), 3);
+        writer.writebits(cnt2, DDS_RL);
+        writer.writebits(DDS_code(bits2), 3);
 
         while (cnt2-- > 0) {
             tmp2 = *ptr2++;
@@ -364,12 +337,12 @@ void writeDDSfile(char *filename, unsigned char *data, unsigned int bytes, unsig
             while (act2 > 127)
                 act2 -= 256;
 
-            writebits(DDS_file, act2 + (1 << bits2) / 2, bits2);
+            writer.writebits(act2 + (1 << bits2) / 2, bits2);
         }
     }
 
-    flushbits(DDS_file);
-    fclose(DDS_file);
+    writer.flushbits();
+    fclose(file);
 
     if (nofree == 0)
         free(data);
@@ -379,95 +352,230 @@ void writeDDSfile(char *filename, unsigned char *data, unsigned int bytes, unsig
 
 // read a Differential Data Stream
 unsigned char *readDDSfile(char *filename, voreen::ProgressBar* progress, unsigned int *bytes) {
-    int version = 1;
+    return DDSDecoder(progress).decodeFile(filename, bytes);
+}
 
-    unsigned int skip, strip;
+DDSDecoder::DDSDecoder(voreen::ProgressBar* progress)
+    : progress_(progress)
+    , stream_(0)
+    , size_(0)
+{}
 
-    unsigned char *data = 0, *ptr = 0;
+unsigned char* DDSDecoder::decodeFile(const char* filename, unsigned int* bytes) {
+    FILE *file;
+    if ((file = fopen(filename, "rb")) == NULL)
+        return (NULL);
 
-    unsigned int cnt, cnt1, cnt2;
-    int bits, act;
+    // the whole stream is read at once, so that the blocks can be decoded independently
+    std::vector<unsigned char> stream;
+    size_t cnt = 0, blkcnt;
+    do {
+        stream.resize(cnt + DDS_BLOCKSIZE);
+        blkcnt = fread(&stream[cnt], 1, DDS_BLOCKSIZE, file);
+        cnt += blkcnt;
+    } while (blkcnt == DDS_BLOCKSIZE);
+    fclose(file);
 
-    if ((DDS_file = fopen(filename, "rb")) == NULL)
+    if (cnt == 0)
         return (NULL);
 
-    for (cnt = 0; DDS_ID[cnt] != '\0'; cnt++)
-        if (fgetc(DDS_file) != DDS_ID[cnt]) {
-            fclose(DDS_file);
-            version = 0;
-            break;
-        }
-
-    if (version == 0) {
-        if ((DDS_file = fopen(filename, "rb")) == NULL)
-            return (NULL);
+    return decode(&stream[0], cnt, bytes);
+}
 
-        for (cnt = 0; DDS_ID2[cnt] != '\0'; cnt++)
-            if (fgetc(DDS_file) != DDS_ID2[cnt]) {
-                fclose(DDS_file);
-                return (NULL);
-            }
+unsigned char* DDSDecoder::decode(const unsigned char* stream, size_t size, unsigned int* bytes) {
+    const size_t idLength = strlen(DDS_ID);
+    if (size < idLength)
+        return (NULL);
 
+    int version;
+    if (memcmp(stream, DDS_ID, idLength) == 0)
+        version = 1;
+    else if (memcmp(stream, DDS_ID2, idLength) == 0)
         version = 2;
-    }
+    else
+        return (NULL);
 
-    initbuffer();
+    stream_ = stream + idLength;
+    size_ = size - idLength;
 
-    skip = readbits(DDS_file, 2) + 1;
-    strip = readbits(DDS_file, 16) + 1;
+    const unsigned int skip = peekbits(0, 2) + 1;
+    const size_t strip = peekbits(2, 16) + 1;
 
-    data = NULL;
-    cnt = act = 0;
+    std::vector<Checkpoint> checkpoints;
+    const size_t cnt = scanRuns(18, checkpoints);
 
-    while ((cnt1 = readbits(DDS_file, DDS_RL)) != 0) {
-        if (progress)
-            progress->setProgress(static_cast<float>(cnt) / static_cast<float>(DDS_BLOCKSIZE - 1));
+    stream_ = 0;
+    if (cnt == 0)
+        return (NULL);
+    if (cnt > 0xffffffffu)
+        ERRORMSG();
 
-        bits = DDS_decode(readbits(DDS_file, 3));
+    unsigned char *data;
+    if ((data = (unsigned char *)malloc(cnt)) == NULL)
+        ERRORMSG();
 
-        for (cnt2 = 0; cnt2 < cnt1; cnt2++) {
-            if (cnt <= strip)
-                act += readbits(DDS_file, bits) - (1 << bits) / 2;
-            else
-                act += *(ptr - strip) - *(ptr - strip - 1) + readbits(DDS_file, bits) - (1 << bits) / 2;
+    stream_ = stream + idLength;
+    extractResiduals(checkpoints, cnt, data);
+    stream_ = 0;
+    if (progress_)
+        progress_->setProgress(0.6f);
 
-            while (act < 0)
-                act += 256;
-            while (act > 255)
-                act -= 256;
+    undoStripPrediction(data, cnt, strip);
+    undoPrediction(data, cnt);
+    if (progress_)
+        progress_->setProgress(0.9f);
 
-            if (cnt % DDS_BLOCKSIZE == 0) {
-                if (data == NULL) {
-                    if ((data = (unsigned char *)malloc(DDS_BLOCKSIZE)) == NULL)
-                        ERRORMSG();
-                } else
-                    if ((data = (unsigned char *)realloc(data, cnt + DDS_BLOCKSIZE)) == NULL)
-                        ERRORMSG();
+    if (version == 1)
+        interleave(data, static_cast<unsigned int>(cnt), skip);
+    else
+        interleave(data, static_cast<unsigned int>(cnt), skip, DDS_INTERLEAVE);
 
-                ptr = &data[cnt];
-            }
+    if (progress_)
+        progress_->setProgress(1.f);
 
-            *ptr++ = act;
-            cnt++;
-        }
+    *bytes = static_cast<unsigned int>(cnt);
+
+    return (data);
+}
+
+inline unsigned int DDSDecoder::peekbits(size_t bitpos, int bits) const {
+    if (bits == 0)
+        return (0);
+
+    // the bits are stored msb first, so a 64 bit big-endian window covers 32 bits at any bit offset
+    const size_t byte = bitpos >> 3;
+    uint64_t window = 0;
+    if (byte + 8 <= size_) {
+        for (int i = 0; i < 8; i++)
+            window = (window << 8) | stream_[byte + i];
+    } else {
+        // reading beyond the end yields zeros, which is needed for truncated files
+        // such as the 16-bit bonsai PVM files from The Volume Library
+        for (size_t i = byte; i < byte + 8; i++)
+            window = (window << 8) | (i < size_ ? stream_[i] : 0);
     }
 
-    fclose(DDS_file);
+    return static_cast<unsigned int>((window << (bitpos & 7)) >> (64 - bits));
+}
 
-    if (cnt == 0)
-        return (NULL);
+size_t DDSDecoder::scanRuns(size_t bitpos, std::vector<Checkpoint>& checkpoints) const {
+    const size_t streamBits = 8 * size_;
 
-    if ((data = (unsigned char *)realloc(data, cnt)) == NULL)
-        ERRORMSG();
+    Checkpoint checkpoint;
+    checkpoint.bitpos_ = bitpos;
+    checkpoint.offset_ = 0;
+    checkpoints.push_back(checkpoint);
 
-    if (version == 1)
-        interleave(data, cnt, skip);
-    else
-        interleave(data, cnt, skip, DDS_INTERLEAVE);
+    // only the run headers are decoded, the residuals are skipped
+    size_t cnt = 0;
+    while (bitpos < streamBits) {
+        const unsigned int cnt1 = peekbits(bitpos, DDS_RL);
+        if (cnt1 == 0)
+            break;
 
-    *bytes = cnt;
+        const int bits = DDS_decode(peekbits(bitpos + DDS_RL, 3));
+        bitpos += DDS_RL + 3 + cnt1 * bits;
+        cnt += cnt1;
 
-    return (data);
+        if (cnt - checkpoints.back().offset_ >= DDS_BLOCKSIZE) {
+            checkpoint.bitpos_ = bitpos;
+            checkpoint.offset_ = cnt;
+            checkpoints.push_back(checkpoint);
+
+            if (progress_)
+                progress_->setProgress(0.3f * std::min(1.f, static_cast<float>(bitpos) / static_cast<float>(streamBits)));
+        }
+    }
+
+    return cnt;
+}
+
+void DDSDecoder::extractResiduals(const std::vector<Checkpoint>& checkpoints, size_t bytes, unsigned char* data) const {
+    const int numBlocks = static_cast<int>(checkpoints.size());
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic)
+    #endif
+    for (int b = 0; b < numBlocks; b++) {
+        size_t bitpos = checkpoints[b].bitpos_;
+        size_t cnt = checkpoints[b].offset_;
+        const size_t end = (b + 1 < numBlocks) ? checkpoints[b + 1].offset_ : bytes;
+
+        while (cnt < end) {
+            const unsigned int cnt1 = peekbits(bitpos, DDS_RL);
+            const int bits = DDS_decode(peekbits(bitpos + DDS_RL, 3));
+            const unsigned int bias = (1 << bits) / 2;
+            bitpos += DDS_RL + 3;
+
+            for (unsigned int cnt2 = 0; cnt2 < cnt1; cnt2++) {
+                // residuals are stored modulo 256
+                data[cnt++] = static_cast<unsigned char>(peekbits(bitpos, bits) - bias);
+                bitpos += bits;
+            }
+        }
+    }
+}
+
+void DDSDecoder::undoStripPrediction(unsigned char* data, size_t bytes, size_t strip) {
+    // the encoder predicts the difference to the previous byte by the difference strip bytes earlier,
+    // so each column of the strip-wide rows is an independent running sum
+    const size_t first = strip + 1;
+    if (bytes <= first)
+        return;
+
+    const size_t numRows = (bytes - first + strip - 1) / strip;
+    const size_t columns = 64;
+    const int numColumnBlocks = static_cast<int>((strip + columns - 1) / columns);
+
+    #ifdef _OPENMP
+    #pragma omp parallel for
+    #endif
+    for (int c = 0; c < numColumnBlocks; c++) {
+        const size_t begin = c * columns;
+        for (size_t r = 0; r < numRows; r++) {
+            unsigned char* row = data + first + r * strip;
+            const size_t end = std::min(std::min(begin + columns, strip), bytes - (first + r * strip));
+            for (size_t j = begin; j < end; j++)
+                row[j] += row[j - strip];
+        }
+    }
+}
+
+void DDSDecoder::undoPrediction(unsigned char* data, size_t bytes) {
+    // running sum modulo 256 of the differences to the previous byte, computed as a parallel prefix sum
+    int numChunks = 1;
+#ifdef _OPENMP
+    if (bytes >= DDS_BLOCKSIZE)
+        numChunks = omp_get_max_threads();
+#endif
+    const size_t chunk = (bytes + numChunks - 1) / numChunks;
+    std::vector<unsigned char> sums(numChunks, 0);
+
+    #ifdef _OPENMP
+    #pragma omp parallel for
+    #endif
+    for (int c = 0; c < numChunks; c++) {
+        unsigned char act = 0;
+        const size_t end = std::min(bytes, (c + 1) * chunk);
+        for (size_t i = c * chunk; i < end; i++) {
+            act += data[i];
+            data[i] = act;
+        }
+        sums[c] = act;
+    }
+
+    for (int c = 1; c < numChunks; c++)
+        sums[c] += sums[c - 1];
+
+    #ifdef _OPENMP
+    #pragma omp parallel for
+    #endif
+    for (int c = 1; c < numChunks; c++) {
+        const unsigned char offset = sums[c - 1];
+        const size_t end = std::min(bytes, (c + 1) * chunk);
+        for (size_t i = c * chunk; i < end; i++)
+            data[i] += offset;
+    }
 }
 
 // write a RAW file
@@ -475,12 +583,13 @@ void writeRAWfile(char *filename, unsigned char *data, unsigned int bytes, int n
     if (bytes < 1)
         ERRORMSG();
 
-    if ((DDS_file = fopen(filename, "wb")) == NULL)
+    FILE *file;
+    if ((file = fopen(filename, "wb")) == NULL)
         ERRORMSG();
-    if (fwrite(data, 1, bytes, DDS_file) != bytes)
+    if (fwrite(data, 1, bytes, file) != bytes)
         ERRORMSG();
 
-    fclose(DDS_file);
+    fclose(file);
 
     if (nofree == 0)
         free(data);
@@ -491,7 +600,8 @@ unsigned char *readRAWfile(char *filename, unsigned int *bytes) {
     unsigned char *data;
     unsigned int cnt, blkcnt;
 
-    if ((DDS_file = fopen(filename, "rb")) == NULL)
+    FILE *file;
+    if ((file = fopen(filename, "rb")) == NULL)
         return (NULL);
 
     data = NULL;
@@ -505,10 +615,12 @@ unsigned char *readRAWfile(char *filename, unsigned int *bytes) {
             if ((data = (unsigned char *)realloc(data, cnt + DDS_BLOCKSIZE)) == NULL)
                 ERRORMSG();
 
-        blkcnt = static_cast<unsigned int>(fread(&data[cnt], 1, DDS_BLOCKSIZE, DDS_file));
+        blkcnt = static_cast<unsigned int>(fread(&data[cnt], 1, DDS_BLOCKSIZE, file));
         cnt += blkcnt;
     } while (blkcnt == DDS_BLOCKSIZE);
 
+    fclose(file);
+
     if (cnt == 0) {
         free(data);
         return (NULL);
@@ -517,8 +629,6 @@ unsigned char *readRAWfile(char *filename, unsigned int *bytes) {
     if ((data = (unsigned char *)realloc(data, cnt)) == NULL)
         ERRORMSG();
 
-    fclose(DDS_file);
-
     *bytes = cnt;
 
     return (data);
@@ -775,19 +885,14 @@ unsigned char *readPVMvolume(char *filename, voreen::ProgressBar* progress,
         else
             throw tgt::CorruptedFileException("PVM file corrupted", filename);
 
-#ifndef WIN32
-        // need to switch to default locale "C" to prevent problems when current locale uses comma
-        // instead of decimal point
-        const char* oldlocale = setlocale(LC_NUMERIC, "C");
-#endif
-
-        if (sscanf((char *)&data[5], "%d %d %d\n%g %g %g\n", width, height, depth, &sx, &sy, &sz) != 6)
+        // parse with the classic locale to prevent problems when the current locale uses comma
+        // instead of decimal point. Switching the process-wide locale is not thread-safe.
+        std::istringstream header(std::string((char *)&data[5], std::min<size_t>(bytes - 5, DDS_MAXSTR)));
+        header.imbue(std::locale::classic());
+        header >> *width >> *height >> *depth >> sx >> sy >> sz;
+        if (header.fail())
             ERRORMSG();
 
-#ifndef WIN32
-    setlocale(LC_NUMERIC, oldlocale);
-#endif
-
         if (*width < 1 || *height < 1 || *depth < 1 || sx <= 0.0f || sy <= 0.0f || sz <= 0.0f)
             ERRORMSG();
         ptr = (unsigned char *)strchr((char *) & data[5], '\n') + 1;
@@ -21,11 +21,69 @@ The author's contact address is:
 #ifndef DDSBASE_H
 #define DDSBASE_H
 
+#include "tgt/types.h"
+
+#include <vector>
+
 namespace voreen {
     class ProgressBar;
 }
 
-// TODO: this should be integrated into some class and unneccessary stuff removed
+/**
+ * Decodes a Differential Data Stream (DDS), which is used for compressing PVM files.
+ *
+ * All decoding state is kept in the instance, so that several streams
+ * can be decoded concurrently by separate decoders.
+ *
+ * The run-length coded stream can only be parsed sequentially, but parsing
+ * the run headers while skipping the residuals is cheap. The decoder records a
+ * checkpoint every DDS_BLOCKSIZE decoded bytes during this scan, after which the
+ * residuals of the blocks are extracted, the predictors are undone and the
+ * DDS v3e interleaving is restored in parallel, if OpenMP is available.
+ */
+class DDSDecoder {
+public:
+    DDSDecoder(voreen::ProgressBar* progress = 0);
+
+    /**
+     * Reads and decodes a DDS file.
+     *
+     * @return the decoded data allocated with malloc, or NULL if the file
+     *      could not be opened or is no DDS file
+     */
+    unsigned char* decodeFile(const char* filename, unsigned int* bytes);
+
+    /**
+     * Decodes a DDS stream in memory, starting with the DDS id.
+     *
+     * @return the decoded data allocated with malloc, or NULL if the stream is no DDS stream
+     */
+    unsigned char* decode(const unsigned char* stream, size_t size, unsigned int* bytes);
+
+private:
+    struct Checkpoint {
+        size_t bitpos_;     ///< bit position of a run header
+        size_t offset_;     ///< number of bytes decoded before the run
+    };
+
+    /// Returns the bits at the passed bit position, zeros beyond the end of the stream.
+    unsigned int peekbits(size_t bitpos, int bits) const;
+
+    /// Scans the run headers and returns the number of decoded bytes.
+    size_t scanRuns(size_t bitpos, std::vector<Checkpoint>& checkpoints) const;
+
+    /// Writes the residuals modulo 256, one block per checkpoint.
+    void extractResiduals(const std::vector<Checkpoint>& checkpoints, size_t bytes, unsigned char* data) const;
+
+    static void undoStripPrediction(unsigned char* data, size_t bytes, size_t strip);
+    static void undoPrediction(unsigned char* data, size_t bytes);
+
+    voreen::ProgressBar* progress_;
+    const unsigned char* stream_;   ///< stream being decoded, without DDS id
+    size_t size_;
+};
+
+// TODO: unneccessary stuff should be removed
 
 void writeDDSfile(char *filename,unsigned char *data,unsigned int bytes,unsigned int skip=0,unsigned int strip=0,int nofree=0);
 unsigned char *readDDSfile(char *filename, voreen::ProgressBar* progress, unsigned int *bytes);
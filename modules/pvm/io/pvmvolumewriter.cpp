@@ -0,0 +1,110 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+// include this before any windows headers
+#include "ddsbase.h"
+
+#include "pvmvolumewriter.h"
+
+#include "voreen/core/datastructures/volume/volumeatomic.h"
+#include "voreen/core/datastructures/volume/volumehandle.h"
+#include "voreen/core/io/progressbar.h"
+
+#include "tgt/exception.h"
+
+namespace voreen {
+
+const std::string PVMVolumeWriter::loggerCat_ = "voreen.pvm.PVMVolumeWriter";
+
+PVMVolumeWriter::PVMVolumeWriter(ProgressBar* progress)
+    : VolumeWriter(progress)
+{
+    extensions_.push_back("pvm");
+}
+
+VolumeWriter* PVMVolumeWriter::create(ProgressBar* progress) const {
+    return new PVMVolumeWriter(progress);
+}
+
+void PVMVolumeWriter::write(const std::string& filename, const VolumeHandleBase* volumeHandle)
+    throw (tgt::IOException)
+{
+    tgtAssert(volumeHandle, "No volume handle");
+    const Volume* volume = volumeHandle->getRepresentation<Volume>();
+    if (!volume) {
+        LWARNING("No volume");
+        return;
+    }
+
+    unsigned int components;
+    if (dynamic_cast<const VolumeUInt8*>(volume))
+        components = 1;
+    else if (dynamic_cast<const VolumeUInt16*>(volume))
+        components = 2;
+    else {
+        LERROR("Format currently not supported: only 8 and 16 bit unsigned volumes can be written");
+        throw tgt::IOException("Unsupported volume format for PVM: " + filename);
+    }
+
+    const tgt::svec3 dims = volume->getDimensions();
+    const tgt::vec3 spacing = volumeHandle->getSpacing();
+    LINFO("Writing PVM volume " << filename);
+
+    if (getProgressBar())
+        getProgressBar()->setProgress(0.f);
+
+    const unsigned char* data = static_cast<const unsigned char*>(volume->getData());
+    unsigned char* bigEndian = 0;
+    if (components == 2) {
+        // PVM stores 16 bit values big-endian, see PVMVolumeReader
+        const size_t numBytes = volume->getNumBytes();
+        bigEndian = new unsigned char[numBytes];
+        for (size_t i = 0; i < numBytes; i += 2) {
+            bigEndian[i] = data[i + 1];
+            bigEndian[i + 1] = data[i];
+        }
+        data = bigEndian;
+    }
+
+    try {
+        writePVMvolume(const_cast<char*>(filename.c_str()), const_cast<unsigned char*>(data),
+                       static_cast<unsigned int>(dims.x), static_cast<unsigned int>(dims.y),
+                       static_cast<unsigned int>(dims.z), components,
+                       spacing.x, spacing.y, spacing.z);
+    }
+    catch (tgt::FileException& e) {
+        delete[] bigEndian;
+        throw tgt::IOException(e.what(), filename);
+    }
+    delete[] bigEndian;
+
+    if (getProgressBar())
+        getProgressBar()->setProgress(1.f);
+}
+
+} // namespace voreen
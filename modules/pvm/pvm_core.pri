@@ -1,13 +1,15 @@
 
-# pvm reader
+# pvm reader and writer
 SOURCES += \
     $${VRN_MODULE_DIR}/pvm/io/ddsbase.cpp \
-    $${VRN_MODULE_DIR}/pvm/io/pvmvolumereader.cpp
+    $${VRN_MODULE_DIR}/pvm/io/pvmvolumereader.cpp \
+    $${VRN_MODULE_DIR}/pvm/io/pvmvolumewriter.cpp
     
 HEADERS += \
     $${VRN_MODULE_DIR}/pvm/io/codebase.h \
     $${VRN_MODULE_DIR}/pvm/io/ddsbase.h \
-    $${VRN_MODULE_DIR}/pvm/io/pvmvolumereader.h
+    $${VRN_MODULE_DIR}/pvm/io/pvmvolumereader.h \
+    $${VRN_MODULE_DIR}/pvm/io/pvmvolumewriter.h
 
 ### Local Variables:
 ### mode:conf-unix
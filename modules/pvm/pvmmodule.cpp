@@ -29,6 +29,7 @@
 #include "pvmmodule.h"
 
 #include "io/pvmvolumereader.h"
+#include "io/pvmvolumewriter.h"
 
 namespace voreen {
 
@@ -39,6 +40,7 @@ PVMModule::PVMModule()
     setXMLFileName("pvm/pvmmodule.xml");
 
     addVolumeReader(new PVMVolumeReader(0));
+    addVolumeWriter(new PVMVolumeWriter());
 }
 
 } // namespace
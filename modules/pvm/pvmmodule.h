@@ -39,7 +39,7 @@ public:
     PVMModule();
 
     virtual std::string getDescription() const {
-        return "Provides a volume reader for Stefan Roettger's PVM format.";
+        return "Provides a volume reader and writer for Stefan Roettger's PVM format.";
     }
 };
 
@@ -17,11 +17,21 @@
 #include "voreen/core/datastructures/volume/volumeatomic.h"
 #include "voreen/core/datastructures/volume/volumeoperator.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #if WIN32
 #ifndef __MINGW32__
     #define fseeko _fseeki64
+    #define ftello _ftelli64
 #else
     #define fseeko fseeko64
+    #define ftello ftello64
 #endif
 #endif
 
@@ -32,17 +42,92 @@ namespace voreen {
 
     const std::string SEGYVolumeReader::loggerCat_ = "voreen.segy.SEGYVolumeReader";
 
-    // ::::::::::::::: Default Values :::::::::::::::
-    // >>>>>>>>>> change later if needed >>>>>>>>>>>>
-    tgt::vec3 spacing_ = ivec3(1, 1, 1);
-    float timeStep_ = -1.0f;
-    std::string metaString_ = "";
-    std::string unit_ = "";
-    // ----------------------------------------------
+    const size_t SEGYVolumeReader::noTrace = static_cast<size_t>(-1);
+
+    namespace {
+
+    // ::::::: Converters From Big-Endian :::::::
+    // ------------------------------------------
+    // SEG-Y data is stored big-endian. The samples are assembled from their bytes, which is
+    // independent of the host's byte order and compiles to vectorized byte swaps.
+
+    inline uint16_t readBigEndian16(const unsigned char* x) {
+        return static_cast<uint16_t>((x[0] << 8) | x[1]);
+    }
+
+    inline uint32_t readBigEndian32(const unsigned char* x) {
+        return (static_cast<uint32_t>(x[0]) << 24) | (static_cast<uint32_t>(x[1]) << 16)
+            | (static_cast<uint32_t>(x[2]) << 8) | static_cast<uint32_t>(x[3]);
+    }
+
+    // scale factors of the IBM 370 exponents: 16^(e-64) / 2^24 for the 24 bit fraction
+    struct IBMScaleTable {
+        double scale_[128];
+        IBMScaleTable() {
+            for (int e = 0; e < 128; e++)
+                scale_[e] = std::ldexp(1.0, 4 * (e - 64) - 24);
+        }
+    };
+    const IBMScaleTable ibmScaleTable;
+
+    // converts big-endian IBM 370 single precision floats to IEEE floats
+    void convertIBMFloat(const unsigned char* src, float* dest, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            uint32_t ibm = readBigEndian32(src + 4*i);
+            float value = static_cast<float>(static_cast<double>(ibm & 0x00FFFFFF) * ibmScaleTable.scale_[(ibm >> 24) & 0x7F]);
+            dest[i] = (ibm & 0x80000000) ? -value : value;
+        }//for
+    }
+
+    void convertIEEEFloat(const unsigned char* src, float* dest, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            uint32_t value = readBigEndian32(src + 4*i);
+            memcpy(&dest[i], &value, 4);
+        }//for
+    }
+
+    void convertInt32(const unsigned char* src, int32_t* dest, size_t count) {
+        for (size_t i = 0; i < count; i++)
+            dest[i] = static_cast<int32_t>(readBigEndian32(src + 4*i));
+    }
+
+    void convertInt16(const unsigned char* src, int16_t* dest, size_t count) {
+        for (size_t i = 0; i < count; i++)
+            dest[i] = static_cast<int16_t>(readBigEndian16(src + 2*i));
+    }
+
+    // inline and cross-line number of a trace, read from its header
+    struct TraceKey {
+        int sequenceNum_;
+        int inline_;
+        int crossline_;
+    };
+
+    bool readTraceKey(FILE* fin, uint64_t traceOffset, TraceKey& key) {
+        unsigned char header[SEGY_CROSSLINE_NUM_BYTE_NUM + 3];
+        if (fseeko(fin, traceOffset, SEEK_SET) != 0 || fread(header, sizeof(header), 1, fin) != 1)
+            return false;
+        key.sequenceNum_ = static_cast<int>(readBigEndian32(header + SEGY_TRACE_SEQUENCE_NUM_WITHIN_LINE_BYTE_NUM - 1));
+        key.inline_ = static_cast<int>(readBigEndian32(header + SEGY_INLINE_NUM_BYTE_NUM - 1));
+        key.crossline_ = static_cast<int>(readBigEndian32(header + SEGY_CROSSLINE_NUM_BYTE_NUM - 1));
+        return true;
+    }
+
+    } // namespace
 
     // constructor
     SEGYVolumeReader::SEGYVolumeReader(ProgressBar* progress)
     : VolumeReader(progress)
+    , dimensions_(0)
+    , spacing_(1.f)
+    , samplesPerDataTrace_(0)
+    , dataSampleFormat_(0)
+    , extendedTextualFileHeaderRecords_(0)
+    , sizeOfSample_(0)
+    , indexedFileSize_(0)
+    , dataOffset_(0)
+    , traceSize_(0)
+    , numTraces_(0)
     {
         extensions_.push_back("sgy");
         extensions_.push_back("segy");
@@ -59,10 +144,7 @@ namespace voreen {
     } // read
 
 
-    // >>>>>>> TO DO: update progress per upload step if required >>>>>
     // >>>>>>> TO DO: change spacing if required >>>>>>>>>>>>>>>>>>>>>>
-    // >>>>>>> TO DO: find out why converting gives better results? >>>
-    // >>>>>>> TO DO: check if slice order need change >>>>>>>>>>>>>>>>
     // >>>>>>> assumming identity matrix for transformation >>>>>>>>>>>
     // --------------------------------------------------------------
     VolumeCollection* SEGYVolumeReader::readSlices(const std::string& fileName, size_t firstSlice, size_t lastSlice)
@@ -72,67 +154,69 @@ namespace voreen {
         readHeaderInfo(fileName);
 
         // check if we have to read only some slices instead of the whole volume.
+        ivec3 start(0);
+        ivec3 dimensions = dimensions_;
         if ( ! (firstSlice==0 && lastSlice==0)) {
-            if (lastSlice > firstSlice) {
-                dimensions_.z = static_cast<int>(lastSlice - firstSlice);
-            }
+            lastSlice = std::min(lastSlice, static_cast<size_t>(dimensions_.z));
+            if (firstSlice >= lastSlice)
+                throw tgt::CorruptedFileException("Invalid slice range", fileName);
+            start.z = static_cast<int>(firstSlice);
+            dimensions.z = static_cast<int>(lastSlice - firstSlice);
         }//if
 
-        std::string info = "Loading SEG-Y file " + fileName + " ";
-
-        if (dimensions_ == tgt::ivec3::zero) {
-            throw tgt::CorruptedFileException("No readHints set.", fileName);
-        }
+        Volume* volume = readSubVolume(fileName, start, dimensions);
+        return createVolumeCollection(volume, fileName, start);
+    } // readSlices
 
-        FILE* fin;
-        fin = fopen(fileName.c_str(),"rb");
+    VolumeCollection* SEGYVolumeReader::readBrick(const std::string& fileName, tgt::ivec3 brickStartPos, int brickSize)
+        throw(tgt::FileException, std::bad_alloc)
+    {
+        readHeaderInfo(fileName);
 
-        if (fin==NULL) {
-            throw tgt::IOException("Unable to open raw file for reading", fileName);
+        if (brickSize <= 0 || tgt::hor(tgt::lessThan(brickStartPos, ivec3(0)))
+            || tgt::hor(tgt::greaterThanEqual(brickStartPos, dimensions_)))
+        {
+            throw tgt::CorruptedFileException("Invalid brick", fileName);
         }
 
+        ivec3 dimensions = tgt::min(ivec3(brickSize), dimensions_ - brickStartPos);
+        Volume* volume = readSubVolume(fileName, brickStartPos, dimensions);
+        return createVolumeCollection(volume, fileName, brickStartPos);
+    } // readBrick
 
-        // --------------------------------------------------------------------
+    /**********************************************************
+     * ::::::::::::::::::: Helper Methods ::::::::::::::::::: *
+     **********************************************************/
 
-        // Now create proper volume type:
+    Volume* SEGYVolumeReader::readSubVolume(const std::string& fileName, ivec3 start, ivec3 dimensions)
+        throw(tgt::CorruptedFileException, tgt::IOException, std::bad_alloc)
+    {
+        std::string info = "Loading SEG-Y file " + fileName + " ";
 
+        // Now create proper volume type:
         Volume* volume;
-
-        // >>>>>>>>>> assuming default spacing, i.e. 1.0 >>>>>>>>>>>>
-
-        if (dataSampleFormat_ == SEGY_IBM_FLOAT ||
-            dataSampleFormat_ == SEGY_IEEE_FLOAT)
-        {
+        if (dataSampleFormat_ == SEGY_IBM_FLOAT) {
+            LINFO(info << "(4-byte IBM float)");
+            volume = new VolumeFloat(dimensions);
+        }
+        else if (dataSampleFormat_ == SEGY_IEEE_FLOAT) {
             LINFO(info << "(4-byte float)");
-            volume = new VolumeFloat(dimensions_);
+            volume = new VolumeFloat(dimensions);
         }
-        else if (dataSampleFormat_ == SEGY_INT32)
-        {
+        else if (dataSampleFormat_ == SEGY_INT32) {
             LINFO(info << "(4-byte int)");
-            volume = new VolumeInt32(dimensions_);
+            volume = new VolumeInt32(dimensions);
         }
-        else if (dataSampleFormat_ == SEGY_INT16)
-        {
+        else if (dataSampleFormat_ == SEGY_INT16) {
             LINFO(info << "(2-byte int)");
-            volume = new VolumeInt16(dimensions_);
-        }
-        else if (dataSampleFormat_ == SEGY_INT8)
-        {
-            LINFO(info << "(1-byte int)");
-            volume = new VolumeInt8(dimensions_);
+            volume = new VolumeInt16(dimensions);
         }
         else {
-            fclose(fin);
-            throw tgt::CorruptedFileException("Unsupported format code # " + dataSampleFormat_, fileName);
+            LINFO(info << "(1-byte int)");
+            volume = new VolumeInt8(dimensions);
         }
 
-
-        // --------------------------------------------------------------------
-
-        // Now upload data from file into volume
-
-
-        // clear volume to be ready for uploading data from file
+        // missing traces remain zero
         volume->clear();
 
         if (getProgressBar()) {
@@ -140,84 +224,102 @@ namespace voreen {
             getProgressBar()->setMessage("Loading volume: " + tgt::FileSystem::fileName(fileName));
         }
 
-        // >>>>>>>>>>>>> TO DO: update progress per upload step >>>>>>>>>>>
-
-        size_t offset;
-
-        // Reposition stream position indicator to first slice:
-        offset = SEGY_TEXTUAL_HEADER_SIZE + SEGY_BINARY_HEADER_SIZE
-                    + extendedTextualFileHeaderRecords_ * SEGY_TEXTUAL_HEADER_SIZE
-                    + (SEGY_TRACE_HEADER_SIZE + samplesPerDataTrace_ * sizeOfSample_) // i.e. dimension_.x
-                        * dimensions_.y // i.e. number of cross-lines
-                        * firstSlice;
-
-        fseeko (fin, offset, SEEK_SET);
-
-        //std::cout << "First slide .. position of file = " << ftell(fin) << "\n"; // >>>>>>>>>>>>> TESTING >>>>>>>>>>>
-
-        // read each trace and upload it to volume
-        for (size_t i = 0; i < (static_cast<size_t>(dimensions_.y) * static_cast<size_t>(dimensions_.z)); i++) {
-
-            //std::cout << "trace num = " << i << "\n"; // >>>>>>>>>>>>> TESTING >>>>>>>>>>>
-
-            // Reposition stream position indicator to trace data - skipping the trace header:
-            fseeko ( fin, SEGY_TRACE_HEADER_SIZE, SEEK_CUR);
-
-            //std::cout << "\t\tposition of file = " << ftell(fin) << "\n"; // >>>>>>>>>>>>> TESTING >>>>>>>>>>>
-
-            // read all samples of this trace into volume data
-            if (fread(reinterpret_cast<char*>(volume->getData())
-                      + samplesPerDataTrace_ * sizeOfSample_ * i,
-                      1, samplesPerDataTrace_ * sizeOfSample_, fin) == 0)
-                LWARNING("fread() failed");
-
-            // convert each sample value to little-endian based on its type:
-            if (dataSampleFormat_ == SEGY_IEEE_FLOAT)
-            {
-                float* samples = reinterpret_cast<float*>(volume->getData())
-                                + samplesPerDataTrace_ * i;
-
-                for (int y=0; y < samplesPerDataTrace_; y++) {
-                    endian_swap_32(&samples[y]);
-                }//for
-            }//if
-            else if (dataSampleFormat_ == SEGY_INT32)
-            {
-                int* samples = reinterpret_cast<int*>(volume->getData())
-                                + samplesPerDataTrace_ * i;
-
-                for (int y=0; y < samplesPerDataTrace_; y++) {
-                    endian_swap_32(&samples[y]);
-                }//for
-            }//else if
-            else if (dataSampleFormat_ == SEGY_INT16)
-            {
-                short* samples = reinterpret_cast<short*>(volume->getData())
-                                + samplesPerDataTrace_ * i;
-
-                for (int y=0; y < samplesPerDataTrace_; y++) {
-                    endian_swap_16(&samples[y]);
-                }//for
-            }//else if
-
-        }//for
-
-        if (lastSlice == 0) {
-            if (feof(fin) ) {
-                delete volume;
-                // throw exception
-                throw tgt::CorruptedFileException("unexpected EOF", fileName);
+        // Each thread reads whole inlines (or parts of them) with its own file handle, in blocks
+        // of consecutive traces of at most 16 MB, and converts the samples into the volume.
+        const size_t maxBlockTraces = std::max<size_t>(1, (16 << 20) / traceSize_);
+        const size_t numSamples = static_cast<size_t>(dimensions.x);
+        const size_t sampleOffset = SEGY_TRACE_HEADER_SIZE + start.x * sizeOfSample_;
+        char* data = reinterpret_cast<char*>(volume->getData());
+        bool failed = false;
+        int numInlinesRead = 0;
+
+        #ifdef _OPENMP
+        #pragma omp parallel
+        #endif
+        {
+            FILE* fin = fopen(fileName.c_str(), "rb");
+            if (fin == NULL) {
+                #ifdef _OPENMP
+                #pragma omp critical
+                #endif
+                failed = true;
             }
-        }
-
-        fclose(fin);
+            std::vector<unsigned char> buffer;
+
+            #ifdef _OPENMP
+            #pragma omp for schedule(dynamic)
+            #endif
+            for (int z = 0; z < dimensions.z; z++) {
+                int y = 0;
+                while (fin && y < dimensions.y) {
+                    size_t trace = getTrace(start.z + z, start.y + y);
+                    if (trace == noTrace) {
+                        y++;
+                        continue;
+                    }//if
+
+                    // collect consecutive traces into a block
+                    size_t blockTraces = 1;
+                    while (y + static_cast<int>(blockTraces) < dimensions.y && blockTraces < maxBlockTraces
+                           && getTrace(start.z + z, start.y + y + static_cast<int>(blockTraces)) == trace + blockTraces)
+                    {
+                        blockTraces++;
+                    }//while
+
+                    buffer.resize(blockTraces * traceSize_);
+                    if (fseeko(fin, dataOffset_ + static_cast<uint64_t>(trace) * traceSize_, SEEK_SET) != 0
+                        || fread(&buffer[0], traceSize_, blockTraces, fin) != blockTraces)
+                    {
+                        #ifdef _OPENMP
+                        #pragma omp critical
+                        #endif
+                        failed = true;
+                        break;
+                    }//if
+
+                    for (size_t t = 0; t < blockTraces; t++) {
+                        const unsigned char* src = &buffer[t * traceSize_ + sampleOffset];
+                        size_t voxel = (static_cast<size_t>(z) * dimensions.y + y + t) * numSamples;
+                        char* dest = data + voxel * sizeOfSample_;
+                        if (dataSampleFormat_ == SEGY_IBM_FLOAT)
+                            convertIBMFloat(src, reinterpret_cast<float*>(dest), numSamples);
+                        else if (dataSampleFormat_ == SEGY_IEEE_FLOAT)
+                            convertIEEEFloat(src, reinterpret_cast<float*>(dest), numSamples);
+                        else if (dataSampleFormat_ == SEGY_INT32)
+                            convertInt32(src, reinterpret_cast<int32_t*>(dest), numSamples);
+                        else if (dataSampleFormat_ == SEGY_INT16)
+                            convertInt16(src, reinterpret_cast<int16_t*>(dest), numSamples);
+                        else
+                            memcpy(dest, src, numSamples);
+                    }//for
+                    y += static_cast<int>(blockTraces);
+                }//while
+
+                #ifdef _OPENMP
+                #pragma omp atomic
+                #endif
+                numInlinesRead++;
+#ifdef _OPENMP
+                // progress bars may only be updated from the calling thread
+                if (omp_get_thread_num() == 0)
+#endif
+                if (getProgressBar())
+                    getProgressBar()->setProgress(static_cast<float>(numInlinesRead) / static_cast<float>(dimensions.z));
+            }//for
 
-        // --------------------------------------------------------------------
+            if (fin)
+                fclose(fin);
+        }
 
-        // >>>>>>>>>>> slice order ???!!! >>>>>>>>>>>>
+        if (failed) {
+            delete volume;
+            throw tgt::IOException("Failed to read traces", fileName);
+        }
 
-        // --------------------------------------------------------------------
+        return volume;
+    } // readSubVolume
 
+    VolumeCollection* SEGYVolumeReader::createVolumeCollection(Volume* volume, const std::string& fileName, ivec3 start) {
         VolumeCollection* volumeCollection = new VolumeCollection();
         VolumeHandle* volumeHandle = new VolumeHandle(volume, spacing_, vec3(0.0f));
 
@@ -225,80 +327,74 @@ namespace voreen {
         std::ostringstream searchStream;
         searchStream << "objectModel=" << "I" << "&";
         searchStream << "format=" << dataSampleFormat_ << "&";
-        searchStream << "dim_x=" << dimensions_.x << "&";
-        searchStream << "dim_y=" << dimensions_.y << "&";
-        searchStream << "dim_z=" << dimensions_.z << "&";
+        searchStream << "dim_x=" << volume->getDimensions().x << "&";
+        searchStream << "dim_y=" << volume->getDimensions().y << "&";
+        searchStream << "dim_z=" << volume->getDimensions().z << "&";
         searchStream << "spacing_x=" << spacing_.x << "&";
         searchStream << "spacing_y=" << spacing_.y << "&";
         searchStream << "spacing_z=" << spacing_.z << "&";
-        //searchStream << "headerskip=" << headerskip_;
+        searchStream << "first_inline=" << inlineNumbers_[start.z] << "&";
+        searchStream << "first_crossline=" << crosslineNumbers_[start.y] << "&";
+        searchStream << "first_sample=" << start.x;
         volumeHandle->setOrigin(VolumeOrigin("segy", fileName, searchStream.str()));
         oldVolumePosition(volumeHandle);
 
         volumeCollection->add(volumeHandle);
 
         return volumeCollection;
+    } // createVolumeCollection
 
-    } // readSlices
-
-    VolumeCollection* SEGYVolumeReader::readBrick(const std::string& /*fileName*/, tgt::ivec3 /*brickStartPos*/, int /*brickSize*/)
-        throw(tgt::FileException, std::bad_alloc)
-    {
-        std::cout << ">>>>>>>>>>>>> ops! requested readBrick()!!! Not ready yet. \n"; // >>>>>>>>>>>>> TESTING >>>>>>>>>>>
-        return 0;
-    } // readBrick
-
-    /**********************************************************
-     * ::::::::::::::::::: Helper Methods ::::::::::::::::::: *
-     **********************************************************/
+    size_t SEGYVolumeReader::getTrace(int inlineIndex, int crosslineIndex) const {
+        if (traceIndex_.empty())
+            return static_cast<size_t>(inlineIndex) * dimensions_.y + crosslineIndex;
+        else
+            return traceIndex_[static_cast<size_t>(inlineIndex) * dimensions_.y + crosslineIndex];
+    } // getTrace
 
-    // >>>>>> TO DO: handle exceptions correctly
     // current version assumes the followings:
-    // 1. no extended textual header records
-    // 2. all traces have same number of samples
-    // 3. all in-lines have same number of x-lines
+    // 1. all traces have same number of samples
     void SEGYVolumeReader::readHeaderInfo(const std::string& fileName)
+        throw(tgt::CorruptedFileException, tgt::IOException)
     {
         // create and open the file:
-        FILE* fin;
-        fin = fopen(fileName.c_str(),"rb");
-
-        size_t result; // to be used for fread() return value
-
-        // --------------------------------------------------------------------
-
-        // check for Extended Textual File Header Records
-        // >>>>>>>>> for now, assume no extra headers >>>>>>>>>>
-        extendedTextualFileHeaderRecords_ = 0;
-
-        // --------------------------------------------------------------------
-
-        // Now, get number of samples per data trace from Binary Header,
-        // >>>>>>>>>>>> assuming all traces have same number of samples >>>>>>>>>>
+        FILE* fin = fopen(fileName.c_str(), "rb");
+        if (fin == NULL)
+            throw tgt::IOException("Unable to open SEG-Y file for reading", fileName);
 
-        // Reposition stream position indicator to required byte no within Binary File Header:
-        fseeko ( fin, SEGY_SAMPLES_PER_DATA_TRACE_BYTE_NUM - 1, SEEK_SET);
+        fseeko(fin, 0, SEEK_END);
+        uint64_t fileSize = static_cast<uint64_t>(ftello(fin));
 
-        // copy the data, i.e. number of samples per trace:
-        result = fread (&samplesPerDataTrace_,sizeof(samplesPerDataTrace_),1,fin);
-        if (result != 1) {fputs ("Reading error",stderr); exit (3);}
-
-        // convert to little-endian:
-        endian_swap_16(&samplesPerDataTrace_);
+        // the index is kept for subsequent reads, e.g. of further bricks
+        if (fileName == indexedFileName_ && fileSize == indexedFileSize_) {
+            fclose(fin);
+            return;
+        }
+        indexedFileName_.clear();
 
         // --------------------------------------------------------------------
 
-        // Now get data sample format and update size of sample
-
-        // Reposition stream position indicator to required byte no within Binary File Header:
-        fseeko ( fin, SEGY_DATA_SAMPLE_FORMAT_BYTE_NUM - 1, SEEK_SET);
+        // Read the textual and binary file headers
+        unsigned char header[SEGY_TEXTUAL_HEADER_SIZE + SEGY_BINARY_HEADER_SIZE];
+        fseeko(fin, 0, SEEK_SET);
+        if (fread(header, sizeof(header), 1, fin) != 1) {
+            fclose(fin);
+            throw tgt::CorruptedFileException("Missing file headers", fileName);
+        }
 
-        // copy the data, i.e. number of samples per trace:
-        result = fread (&dataSampleFormat_,sizeof(dataSampleFormat_),1,fin);
-        if (result != 1) {fputs ("Reading error",stderr); exit (3);}
+        // assuming all traces have same number of samples
+        samplesPerDataTrace_ = static_cast<short>(readBigEndian16(header + SEGY_SAMPLES_PER_DATA_TRACE_BYTE_NUM - 1));
+        dataSampleFormat_ = static_cast<short>(readBigEndian16(header + SEGY_DATA_SAMPLE_FORMAT_BYTE_NUM - 1));
 
-        // convert to little-endian:
-        endian_swap_16(&dataSampleFormat_);
+        // extended textual file headers are only defined from rev. 1 on
+        extendedTextualFileHeaderRecords_ = 0;
+        if (readBigEndian16(header + SEGY_FORMAT_REVISION_NUM_BYTE_NUM - 1) >= 0x0100) {
+            extendedTextualFileHeaderRecords_ = static_cast<short>(
+                readBigEndian16(header + SEGY_NUM_OF_EXTENDED_TEXTUAL_FILE_HEADER_BYTE_NUM - 1));
+            if (extendedTextualFileHeaderRecords_ < 0) {
+                fclose(fin);
+                throw tgt::CorruptedFileException("Variable number of extended textual headers not supported", fileName);
+            }
+        }
 
         // calculate size of sample in bytes:
         if (dataSampleFormat_ == SEGY_IBM_FLOAT ||
@@ -306,178 +402,203 @@ namespace voreen {
             dataSampleFormat_ == SEGY_IEEE_FLOAT)
         {
             sizeOfSample_ = 4; //bytes
-        }//if
-
-        else if (dataSampleFormat_ == SEGY_INT16)
-        {
+        }
+        else if (dataSampleFormat_ == SEGY_INT16) {
             sizeOfSample_ = 2; //bytes
-        }//else if
-
-        else if (dataSampleFormat_ == SEGY_INT8)
-        {
+        }
+        else if (dataSampleFormat_ == SEGY_INT8) {
             sizeOfSample_ = 1; //bytes
-        }//else if
-
+        }
         else {
-            fputs ("wrong format",stderr); exit (3);
-            // throw tgt::CorruptedFileException("Unsupported format code # " + dataSampleFormat_, fileName);
-        }//else
-
-
-        // --------------------------------------------------------------------
-
-        // Now, get number of in-lines and x-lines by accessing each trace header
-        // >>>>>>>>> assuming all in-lines have same number of cross-lines >>>>>>>>>>>
-
-        // trace sequence number within line to be read from file
-        unsigned int traceSeqNum = 0; //initial value
-
-        // in-line number
-        unsigned int inLine = 0;
-
-        // cross-line number
-        unsigned int xLine = 0;
-
-        // Reposition stream position indicator to required byte num. of first trace header:
-        fseeko ( fin,
-               SEGY_TEXTUAL_HEADER_SIZE + SEGY_BINARY_HEADER_SIZE
-               + extendedTextualFileHeaderRecords_ * SEGY_TEXTUAL_HEADER_SIZE
-               + SEGY_TRACE_SEQUENCE_NUM_WITHIN_LINE_BYTE_NUM - 1,
-               SEEK_SET);
-
-        // go through each trace till end of file
-        while (1) {
-
-            // copy the data, i.e. trace sequence num. within line
-            result = fread (&traceSeqNum,sizeof(traceSeqNum),1,fin);
-            if (result != 1) {
-                //fputs ("Reading error",stderr);
-                //exit (3);
-                break;
-            }
-
-            // convert to little-endian:
-            endian_swap(traceSeqNum);
-
-            // calculate number of in-lines; once trace sequence number is 1 then we start a new in-line
-            if (traceSeqNum == 1) {
-                inLine++;
-            }//if
-
-            // calculate (max) number of cross-lines
-            if (traceSeqNum > xLine) {
-                xLine = traceSeqNum;
-            }//if
-
-
-            // Reposition stream position indicator for next trace:
-            fseeko ( fin,
-                   SEGY_TRACE_HEADER_SIZE
-                   + samplesPerDataTrace_ * sizeOfSample_
-                   - sizeof(traceSeqNum),
-                   SEEK_CUR);
+            fclose(fin);
+            std::ostringstream message;
+            message << "Unsupported format code # " << dataSampleFormat_;
+            throw tgt::CorruptedFileException(message.str(), fileName);
+        }
 
-        }//while
+        if (samplesPerDataTrace_ <= 0) {
+            fclose(fin);
+            throw tgt::CorruptedFileException("Invalid number of samples per trace", fileName);
+        }
 
+        dataOffset_ = SEGY_TEXTUAL_HEADER_SIZE + SEGY_BINARY_HEADER_SIZE
+            + static_cast<uint64_t>(extendedTextualFileHeaderRecords_) * SEGY_TEXTUAL_HEADER_SIZE;
+        traceSize_ = SEGY_TRACE_HEADER_SIZE + samplesPerDataTrace_ * sizeOfSample_;
+        numTraces_ = (fileSize > dataOffset_ ? static_cast<size_t>((fileSize - dataOffset_) / traceSize_) : 0);
+        if (numTraces_ == 0) {
+            fclose(fin);
+            throw tgt::CorruptedFileException("No traces", fileName);
+        }
+        if ((fileSize - dataOffset_) % traceSize_ != 0)
+            LWARNING("File size is not a multiple of the trace size, ignoring the incomplete last trace");
 
         // --------------------------------------------------------------------
 
-        // Now, update dimension of this volume:
-        dimensions_ = ivec3(samplesPerDataTrace_, xLine, inLine);
+        // Now, build the inline/cross-line index: from the first traces for regular files,
+        // otherwise by reading all trace headers
+        bool regular = buildRegularIndex(fin);
+        fclose(fin);
+        if (!regular)
+            buildFullIndex(fileName);
 
         // --------------------------------------------------------------------
 
-        // terminate
-        fclose (fin);
-
-
-        // print result:
-        // >>>>>>>>>>>>>>> Remove Later >>>>>>>>>>>>>
-        std::cout << "No. of samples per trace: " << samplesPerDataTrace_ << "\n";
-        std::cout << "No. of in-lines: " << inLine << "\n";
-        std::cout << "No. of cross-lines: " << xLine << "\n";
+        // Now, update dimension of this volume:
+        dimensions_ = ivec3(samplesPerDataTrace_,
+                            static_cast<int>(crosslineNumbers_.size()),
+                            static_cast<int>(inlineNumbers_.size()));
+        indexedFileName_ = fileName;
+        indexedFileSize_ = fileSize;
+
+        LINFO("No. of samples per trace: " << samplesPerDataTrace_);
+        LINFO("No. of in-lines: " << dimensions_.z << " (" << inlineNumbers_.front() << " - " << inlineNumbers_.back() << ")");
+        LINFO("No. of cross-lines: " << dimensions_.y << " (" << crosslineNumbers_.front() << " - " << crosslineNumbers_.back() << ")");
+        if (!regular)
+            LINFO("Irregular trace geometry, " << std::count(traceIndex_.begin(), traceIndex_.end(), noTrace) << " missing trace(s)");
 
     } //readHeaderInfo
 
+    bool SEGYVolumeReader::buildRegularIndex(FILE* fin) {
+        inlineNumbers_.clear();
+        crosslineNumbers_.clear();
+        traceIndex_.clear();
+
+        TraceKey first, second, last;
+        if (!readTraceKey(fin, dataOffset_, first))
+            return false;
+        if (numTraces_ == 1) {
+            inlineNumbers_.push_back(first.inline_);
+            crosslineNumbers_.push_back(first.crossline_);
+            return true;
+        }
+        if (!readTraceKey(fin, dataOffset_ + traceSize_, second)
+            || !readTraceKey(fin, dataOffset_ + static_cast<uint64_t>(numTraces_ - 1) * traceSize_, last))
+        {
+            return false;
+        }
 
+        // rev. 0 files without inline/cross-line numbers: lines are delimited by the trace sequence number
+        bool numbered = (first.inline_ != 0 || first.crossline_ != 0);
+        if (!numbered) {
+            first.inline_ = second.inline_ = 1;
+            first.crossline_ = first.sequenceNum_;
+            second.crossline_ = second.sequenceNum_;
+        }
 
-    // ::::::: Converters To/From Big-Endian/Little-Endian :::::::
-    // -----------------------------------------------------------
-
-    // convert between big-endian and little-endian values (16-bit unsigned short):
-    void SEGYVolumeReader::endian_swap (unsigned short& x)
-    {
-        x = (x>>8) |
-        (x<<8);
-    }//endian_swap
-
-    // convert between big-endian and little-endian values (32-bit unsigned int):
-    void SEGYVolumeReader::endian_swap (unsigned int& x)
-    {
-        x = (x>>24) |
-        ((x<<8) & 0x00FF0000) |
-        ((x>>8) & 0x0000FF00) |
-        (x<<24);
-    }//endian_swap
-
-    // convert between big-endian and little-endian values (32-bit float):
-    void SEGYVolumeReader::endian_swap (float& x)
-    {
-        // temp char to help is swap
-        char temp;
-
-        // char pointer pointing to the same float to allow swapping between bytes
-        char* charX = (char*) &x;
-
-        // swap bytes 0 and 3:
-        temp = charX[3];
-        charX[3] = charX[0];
-        charX[0] = temp;
-
-        // swap bytes 1 and 2
-        temp = charX[2];
-        charX[2] = charX[1];
-        charX[1] = temp;
-
-    }//endian_swap
-
-    // convert between big-endian and little-endian of 32-bit memory value:
-    void SEGYVolumeReader::endian_swap_32 (void* x)
-    {
-        // char pointer pointing to same location as x, to allow swapping between bytes
-        char* charX = (char*) x;
-
-        // temp char to help is swap
-        char temp;
-
-        // swap bytes 0 and 3:
-        temp = charX[3];
-        charX[3] = charX[0];
-        charX[0] = temp;
+        // sorted by inlines, with the cross-lines varying fastest?
+        if (first.inline_ != second.inline_ || first.crossline_ == second.crossline_)
+            return false;
+        int crosslineStep = second.crossline_ - first.crossline_;
+
+        // find the length of the first inline
+        size_t lineLength = 2;
+        TraceKey key;
+        while (lineLength < numTraces_) {
+            if (!readTraceKey(fin, dataOffset_ + static_cast<uint64_t>(lineLength) * traceSize_, key))
+                return false;
+            bool newLine = numbered ? (key.inline_ != first.inline_) : (key.sequenceNum_ == first.sequenceNum_);
+            if (newLine)
+                break;
+            lineLength++;
+        }//while
+        if (numTraces_ % lineLength != 0)
+            return false;
+        size_t numLines = numTraces_ / lineLength;
+        int inlineStep = 1;
+        if (numbered && numLines > 1) {
+            inlineStep = key.inline_ - first.inline_;
+            if (inlineStep == 0)
+                return false;
+        }
 
-        // swap bytes 1 and 2
-        temp = charX[2];
-        charX[2] = charX[1];
-        charX[1] = temp;
+        // verify by the last trace
+        if (numbered) {
+            if (last.inline_ != first.inline_ + static_cast<int>(numLines - 1) * inlineStep
+                || last.crossline_ != first.crossline_ + static_cast<int>(lineLength - 1) * crosslineStep)
+            {
+                return false;
+            }
+        }
+        else if (last.sequenceNum_ != first.sequenceNum_ + static_cast<int>(lineLength - 1) * crosslineStep) {
+            return false;
+        }
 
-    }//endian_swap_32
+        for (size_t i = 0; i < numLines; i++)
+            inlineNumbers_.push_back(first.inline_ + static_cast<int>(i) * inlineStep);
+        for (size_t i = 0; i < lineLength; i++)
+            crosslineNumbers_.push_back(first.crossline_ + static_cast<int>(i) * crosslineStep);
+        return true;
+    } // buildRegularIndex
 
-    // convert between big-endian and little-endian of 16-bit memory value:
-    void SEGYVolumeReader::endian_swap_16 (void* x)
+    void SEGYVolumeReader::buildFullIndex(const std::string& fileName)
+        throw(tgt::IOException)
     {
-        // char pointer pointing to same location as x, to allow swapping between bytes
-        char* charX = (char*) x;
-
-        // temp char to help is swap
-        char temp;
-
-        // swap:
-        temp = charX[1];
-        charX[1] = charX[0];
-        charX[0] = temp;
-
-    }//endian_swap_16
+        LINFO("Reading " << numTraces_ << " trace headers...");
+        std::vector<TraceKey> keys(numTraces_);
+        const int numTraces = static_cast<int>(numTraces_);
+        bool failed = false;
+
+        // only the headers are read, concurrently in contiguous ranges of traces
+        #ifdef _OPENMP
+        #pragma omp parallel
+        #endif
+        {
+            FILE* fin = fopen(fileName.c_str(), "rb");
+            #ifdef _OPENMP
+            #pragma omp for schedule(static)
+            #endif
+            for (int i = 0; i < numTraces; i++) {
+                if (!fin || !readTraceKey(fin, dataOffset_ + static_cast<uint64_t>(i) * traceSize_, keys[i])) {
+                    #ifdef _OPENMP
+                    #pragma omp critical
+                    #endif
+                    failed = true;
+                }
+            }//for
+            if (fin)
+                fclose(fin);
+        }
+        if (failed)
+            throw tgt::IOException("Failed to read trace headers", fileName);
+
+        // rev. 0 files without inline/cross-line numbers: each trace with sequence number 1 starts a new inline
+        bool numbered = false;
+        for (size_t i = 0; i < keys.size() && !numbered; i++)
+            numbered = (keys[i].inline_ != 0 || keys[i].crossline_ != 0);
+        if (!numbered) {
+            int line = 0;
+            for (size_t i = 0; i < keys.size(); i++) {
+                if (keys[i].sequenceNum_ == 1 || i == 0)
+                    line++;
+                keys[i].inline_ = line;
+                keys[i].crossline_ = keys[i].sequenceNum_;
+            }//for
+        }
 
+        inlineNumbers_.clear();
+        crosslineNumbers_.clear();
+        for (size_t i = 0; i < keys.size(); i++) {
+            inlineNumbers_.push_back(keys[i].inline_);
+            crosslineNumbers_.push_back(keys[i].crossline_);
+        }
+        std::sort(inlineNumbers_.begin(), inlineNumbers_.end());
+        inlineNumbers_.erase(std::unique(inlineNumbers_.begin(), inlineNumbers_.end()), inlineNumbers_.end());
+        std::sort(crosslineNumbers_.begin(), crosslineNumbers_.end());
+        crosslineNumbers_.erase(std::unique(crosslineNumbers_.begin(), crosslineNumbers_.end()), crosslineNumbers_.end());
+
+        traceIndex_.assign(inlineNumbers_.size() * crosslineNumbers_.size(), noTrace);
+        size_t numDuplicates = 0;
+        for (size_t i = 0; i < keys.size(); i++) {
+            size_t z = std::lower_bound(inlineNumbers_.begin(), inlineNumbers_.end(), keys[i].inline_) - inlineNumbers_.begin();
+            size_t y = std::lower_bound(crosslineNumbers_.begin(), crosslineNumbers_.end(), keys[i].crossline_) - crosslineNumbers_.begin();
+            size_t& trace = traceIndex_[z * crosslineNumbers_.size() + y];
+            if (trace != noTrace)
+                numDuplicates++;
+            trace = i;
+        }//for
+        if (numDuplicates > 0)
+            LWARNING(numDuplicates << " trace(s) with duplicate inline/cross-line numbers, using the last one");
+    } // buildFullIndex
 
     VolumeReader* SEGYVolumeReader::create(ProgressBar* progress) const {
         return new SEGYVolumeReader(progress);
@@ -20,17 +20,22 @@
 #define SEGY_SAMPLE_INTERVAL_BYTE_NUM 3217            // 2 bytes
 #define SEGY_SAMPLES_PER_DATA_TRACE_BYTE_NUM 3221     // 2 bytes
 #define SEGY_DATA_SAMPLE_FORMAT_BYTE_NUM 3225         // 2 bytes
-#define SEGY_FIXED_LENGTH_TRACE_FLAG_BYTE_NUM 3225    // 2 bytes
+#define SEGY_FORMAT_REVISION_NUM_BYTE_NUM 3501        // 2 bytes
+#define SEGY_FIXED_LENGTH_TRACE_FLAG_BYTE_NUM 3503    // 2 bytes
 #define SEGY_NUM_OF_EXTENDED_TEXTUAL_FILE_HEADER_BYTE_NUM 3505 // 2 bytes
-#define SEGY_DATA_SAMPLE_FORMAT_BYTE_NUM 3225         // 2 bytes
 // -------------------------------------
 // ::: Byte no. of some interesting values from SEGY Trace Header :::
 // NOTE: address = address of current trace header + byte no. - 1
 #define SEGY_TRACE_SEQUENCE_NUM_WITHIN_LINE_BYTE_NUM 1    // 4 bytes
+#define SEGY_INLINE_NUM_BYTE_NUM 189                      // 4 bytes (rev. 1)
+#define SEGY_CROSSLINE_NUM_BYTE_NUM 193                   // 4 bytes (rev. 1)
 // -------------------------------------
 
+#include <cstdio>
 #include <string>
+#include <vector>
 
+#include "tgt/types.h"
 #include "tgt/vector.h"
 #include "tgt/matrix.h"
 
@@ -38,8 +43,20 @@
 #include "voreen/core/datastructures/volume/modality.h"
 
 namespace voreen {
+
+class Volume;
+
 /**
     * Reader for <tt>.segy</tt> file containing a seismic volume dataset.
+    *
+    * The traces are mapped to the volume by an inline/cross-line index built from the
+    * trace headers: the samples of a trace form the x axis, the cross-lines the y axis
+    * and the inlines the z axis. Missing traces are filled with zeros. If the trace headers
+    * do not provide inline and cross-line numbers (rev. 0), each trace whose sequence number
+    * within its line is 1 starts a new inline.
+    *
+    * Traces are read in blocks of consecutive traces and converted concurrently,
+    * supporting IBM and IEEE floats as well as 1, 2 and 4 byte integers.
     */
 class SEGYVolumeReader : public VolumeReader {
 
@@ -53,9 +70,16 @@ public:
     virtual VolumeCollection* read(const std::string& fileName)
         throw(tgt::CorruptedFileException, tgt::IOException, std::bad_alloc);
 
+    /**
+     * Reads the inlines [firstSlice, lastSlice). If both are zero, the whole volume is read.
+     */
     virtual VolumeCollection* readSlices(const std::string& fileName, size_t firstSlice=0, size_t lastSlice=0)
         throw(tgt::CorruptedFileException, tgt::IOException, std::bad_alloc);
 
+    /**
+     * Reads a cube of brickSize samples, cross-lines and inlines starting at brickStartPos,
+     * clamped to the volume.
+     */
     virtual VolumeCollection* readBrick(const std::string& fileName, tgt::ivec3 brickStartPos, int brickSize)
         throw(tgt::FileException, std::bad_alloc);
 
@@ -64,9 +88,9 @@ public:
     enum {
         SEGY_IBM_FLOAT=1,    // 4-byte IBM floating-point
         SEGY_INT32=2,        // 4-byte two'scomplement integer
-        SEGY_INT16=2,        // 2-byte two'scomplement integer
+        SEGY_INT16=3,        // 2-byte two'scomplement integer
         SEGY_IEEE_FLOAT=5,   // 4-byte IEEE floating-point
-        SEGY_INT8=8,         // 1-byte two'scomplement integer
+        SEGY_INT8=8          // 1-byte two'scomplement integer
     };
 
 private:
@@ -75,10 +99,6 @@ private:
 
     tgt::ivec3 dimensions_;
     tgt::vec3 spacing_;
-    tgt::mat4 transformation_;
-    float timeStep_;
-    Modality modality_;
-    std::string metaString_;
     std::string unit_;
 
     // these are the header info required to be retrieved before any reading attempt:
@@ -87,26 +107,39 @@ private:
     short extendedTextualFileHeaderRecords_;
     size_t sizeOfSample_;
 
-    // retrieves header info for a given SEGY file:
-    virtual void readHeaderInfo(const std::string& fileName);
+    // trace geometry, determined by readHeaderInfo():
+    std::string indexedFileName_;       // file the index has been built for
+    uint64_t indexedFileSize_;
+    uint64_t dataOffset_;               // byte offset of the first trace header
+    size_t traceSize_;                  // bytes per trace, including its header
+    size_t numTraces_;
+    std::vector<int> inlineNumbers_;    // inline number of each z index
+    std::vector<int> crosslineNumbers_; // cross-line number of each y index
+    std::vector<size_t> traceIndex_;    // trace per (z, y), noTrace if missing; empty for regular files
 
+    static const size_t noTrace;
 
-    // ::::::: Converters To/From Big-Endian/Little-Endian :::::::
-    // -----------------------------------------------------------
-    // convert between big-endian and little-endian values (16-bit unsigned short):
-    void endian_swap (unsigned short& x);
+    // retrieves header info for a given SEGY file and builds the inline/cross-line index:
+    virtual void readHeaderInfo(const std::string& fileName)
+        throw(tgt::CorruptedFileException, tgt::IOException);
 
-    // convert between big-endian and little-endian values (32-bit unsigned int):
-    void endian_swap (unsigned int& x);
+    // builds the index from the first traces if the file is regularly sorted by inlines,
+    // returns false otherwise:
+    bool buildRegularIndex(FILE* fin);
 
-    // convert between big-endian and little-endian values (32-bit float):
-    void endian_swap (float& x);
+    // builds the index from all trace headers:
+    void buildFullIndex(const std::string& fileName)
+        throw(tgt::IOException);
 
-    // convert between big-endian and little-endian of any 32-bit memory value:
-    void endian_swap_32 (void* x);
+    // returns the number of the trace at the passed inline (z) and cross-line (y) index, or noTrace:
+    size_t getTrace(int inlineIndex, int crosslineIndex) const;
+
+    // reads the sub-volume of the passed dimensions starting at the passed sample, cross-line and inline:
+    Volume* readSubVolume(const std::string& fileName, tgt::ivec3 start, tgt::ivec3 dimensions)
+        throw(tgt::CorruptedFileException, tgt::IOException, std::bad_alloc);
 
-    // convert between big-endian and little-endian of any 16-bit memory value:
-    void endian_swap_16 (void* x);
+    // wraps a sub-volume into a collection:
+    VolumeCollection* createVolumeCollection(Volume* volume, const std::string& fileName, tgt::ivec3 start);
 
 }; // class SEGYVolumeReader
 
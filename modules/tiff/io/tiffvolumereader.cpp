@@ -39,6 +39,10 @@
 #include <iostream>
 #include <assert.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "tgt/exception.h"
 #include "tgt/vector.h"
 
@@ -51,6 +55,39 @@ namespace voreen {
 
 const std::string TiffVolumeReader::loggerCat_ = "voreen.tiff.TiffVolumeReader";
 
+namespace {
+
+// libtiff 4.0.0 (20111221) introduced BigTIFF support
+#if TIFFLIB_VERSION < 20111221
+bool isBigTiff(const std::string& fileName) {
+    std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+    unsigned char header[4];
+    if (!file.read(reinterpret_cast<char*>(header), 4))
+        return false;
+    return (header[0] == 'I' && header[1] == 'I' && header[2] == 43 && header[3] == 0)
+        || (header[0] == 'M' && header[1] == 'M' && header[2] == 0 && header[3] == 43);
+}
+#endif
+
+/// Creates a volume matching the pixel format, or returns null if the format is not supported.
+Volume* createVolume(uint16_t bitsPerSample, uint16_t samplesPerPixel, uint16_t sampleFormat, const ivec3& dimensions) {
+    const bool isSigned = (sampleFormat == SAMPLEFORMAT_INT);
+    if (bitsPerSample == 8 && samplesPerPixel == 1)
+        return isSigned ? static_cast<Volume*>(new VolumeInt8(dimensions)) : new VolumeUInt8(dimensions);
+    else if (bitsPerSample == 8 && samplesPerPixel == 3 && !isSigned)
+        return new Volume3xUInt8(dimensions);
+    else if (bitsPerSample == 8 && samplesPerPixel == 4 && !isSigned)
+        return new Volume4xUInt8(dimensions);
+    else if (bitsPerSample == 16 && samplesPerPixel == 1)
+        return isSigned ? static_cast<Volume*>(new VolumeInt16(dimensions)) : new VolumeUInt16(dimensions);
+    else if (bitsPerSample == 32 && samplesPerPixel == 1 && sampleFormat == SAMPLEFORMAT_IEEEFP)
+        return new VolumeFloat(dimensions);
+    else
+        return 0;
+}
+
+} // namespace
+
 TiffVolumeReader::TiffVolumeReader(ProgressBar* progress) : VolumeReader(progress)
 {
     extensions_.push_back("tiff");
@@ -59,213 +96,148 @@ TiffVolumeReader::TiffVolumeReader(ProgressBar* progress) : VolumeReader(progres
 
 VolumeCollection* TiffVolumeReader::read(const std::string &url)
     throw (tgt::FileException, tgt::IOException, std::bad_alloc)
+{
+    return readSlices(url, 0, 0);
+}
+
+VolumeCollection* TiffVolumeReader::readSlices(const std::string &url, size_t firstSlice, size_t lastSlice)
+    throw (tgt::FileException, std::bad_alloc)
 {
     VolumeOrigin origin(url);
     std::string fileName = origin.getPath();
 
-    ivec3 dimensions;
-    int band = 1;
-
     LINFO(fileName);
 
-    TIFF* tif = TIFFOpen(fileName.c_str(), "r");
-    if (tif) {
-        int dircount = 0;
-        do {
-            dircount++;
-        } while (TIFFReadDirectory(tif));
-        LDEBUG(dircount << " directories found");
-        dimensions.z = dircount;
-        TIFFClose(tif);
-    }
-    else {
-        LERROR("Failed to open tiffstack");
-        throw tgt::IOException("Failed to open TIFF stack", fileName);
-    }
-    if (dimensions.z == 1)
+    int band = 1;
+    int slices = 0;
+    std::vector<Page> pages = indexPages(fileName, band, slices);
+    LDEBUG(pages.size() << " directories found");
+    if (pages.size() == 1)
         throw tgt::CorruptedFileException("TIFF file contains only a single image, but TIFF stack expected", fileName);
 
-    uint16 depth, bps;
-    tif = TIFFOpen(fileName.c_str(), "r");
+    if (band < 1)
+        band = 1;
+    size_t numSlices = pages.size() / band;
+    if (slices > 0)
+        numSlices = std::min(numSlices, static_cast<size_t>(slices));
+    if (numSlices == 0)
+        throw tgt::CorruptedFileException("TIFF file contains less images than bands", fileName);
 
-    if (!tif) {
-        LERROR("Failed to open tiffstack");
-        throw tgt::IOException("Failed to open TIFF stack", fileName);
+    // check if we have to read only some slices instead of the whole volume
+    if (firstSlice == 0 && lastSlice == 0) {
+        lastSlice = numSlices;
     }
     else {
-        //TIFFReadDirectory(tif));
-        uint32 width, height;
+        lastSlice = std::min(lastSlice, numSlices);
+        if (firstSlice >= lastSlice)
+            throw tgt::CorruptedFileException("Invalid slice range", fileName);
+    }
 
-        TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &width);
-        TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &height);
-        TIFFGetField(tif, TIFFTAG_SAMPLESPERPIXEL, &depth);
-        TIFFGetField(tif, TIFFTAG_BITSPERSAMPLE, &bps);
-        dimensions.x = width;
-        dimensions.y = height;
-
-        uint16 count;
-        void *data;
-        int slices;
-        if (TIFFGetField(tif, 33471, &count, &data)) {
-            std::istringstream stream(static_cast<char*>(data));
-            TextFileReader reader(&stream);
-            reader.setSeparators("=");
-            LDEBUG(static_cast<char*>(data));
-            string type;
-            std::istringstream args;
-            while (reader.getNextLine(type, args, false)) {
-                LDEBUG(type << ": " << args.str());
-                if (type == "Band") {
-                    args >> band;
-                    LINFO("Band: " << band);
-                }
-                else if (type == "Z") {
-                    args >> slices;
-                    LINFO("Slices: " << slices);
-                    dimensions.z = slices;
-                }
-                else {
-                    // Parse lines of type <type> <value> and log results
-                    // Later on these data should be filled into the metadata structure of a volume
-                    int value;
-                    int pos = static_cast<int>(type.size()) - 1;
-                    while (isdigit(type[pos]) && pos > 0)
-                        --pos;
-                    type = type.substr(0, pos+1);
-                    std::stringstream valueStr(type.substr(pos+1, type.size()-1));
-                    valueStr >> value;
-                    LDEBUG("Type: " << type << " with value: " << value);
-                }
-            }
-        }
-        else
-            LERROR("Error");
-        TIFFClose(tif);
-        LINFO("depth: " << depth << " bps: " << bps);
+    const Page& format = pages.front();
+    ivec3 dimensions(format.width_, format.height_, static_cast<int>(lastSlice - firstSlice));
+    LINFO("depth: " << format.samplesPerPixel_ << " bps: " << format.bitsPerSample_);
+
+    if (format.samplesPerPixel_ > 1 && format.planarConfig_ != PLANARCONFIG_CONTIG) {
+        LERROR("TIFF images with separate color planes are not supported");
+        throw tgt::UnsupportedFormatException("tiff", fileName);
     }
 
     LINFO("stacking " << dimensions.z*band << " images with dimensions (" << dimensions.x
           << ", " << dimensions.y << ") into " << band << " datasets.");
     std::vector<Volume*> targetDataset;
-    std::vector<uint8_t*> scalars8;
-    std::vector<uint16_t*> scalars16;
-    bool use8BitDataset;
-    if (bps == 8) {
-        use8BitDataset = true;
+    for (int i=0; i<band; ++i) {
+        Volume* volume = createVolume(format.bitsPerSample_, format.samplesPerPixel_, format.sampleFormat_, dimensions);
+        if (!volume) {
+            for (size_t j=0; j<targetDataset.size(); ++j)
+                delete targetDataset[j];
+            LERROR("Unsupported pixel format: " << format.samplesPerPixel_ << " samples with "
+                   << format.bitsPerSample_ << " bits");
+            throw tgt::UnsupportedFormatException("tiff", fileName);
+        }
+        targetDataset.push_back(volume);
     }
 
-    else {
-        if (bps != 16)
-            LWARNING("Couldn't recognize bit depth. Trying 16 bit...");
-        use8BitDataset = false;
-    }
+    const size_t bytesPerPixel = targetDataset.front()->getBytesPerVoxel();
+    const size_t sliceBytes = bytesPerPixel * dimensions.x * dimensions.y;
+    const size_t firstPage = firstSlice * band;
+    const int numPages = dimensions.z * band;
 
-    if (use8BitDataset) {
-        for (int i=0; i<band; ++i) {
-            targetDataset.push_back(new VolumeUInt8(dimensions));
-            scalars8.push_back(reinterpret_cast<uint8_t*>(((VolumeUInt8*)targetDataset[i])->voxel()));
-        }
-    }
-    else {
-        for (int i=0; i<band; ++i) {
-            targetDataset.push_back(new VolumeUInt16(dimensions));
-            scalars16.push_back(reinterpret_cast<uint16_t*>(((VolumeUInt16*)targetDataset[i])->voxel()));
-        }
-    }
+    // 0: decoded, 1: skipped because of mismatching format, 2: read error
+    std::vector<char> pageStatus(numPages, 0);
+    bool openFailed = false;
 
-    tif = TIFFOpen(fileName.c_str(), "r");
-    if (!tif) {
-        LERROR("Failed to open TIFF stack");
-        throw tgt::IOException("Failed to open TIFF stack", fileName);
-    }
-    else {
-        int* minValue = new int[band];
-        int* maxValue = new int[band];
-        for (int i=0; i<band; ++i) {
-            minValue[i] = 65536;
-            maxValue[i] = 0;
+    #ifdef _OPENMP
+    #pragma omp parallel
+    #endif
+    {
+        // libtiff handles must not be shared between threads
+        TIFF* tif = TIFFOpen(fileName.c_str(), "r");
+        if (!tif) {
+            #ifdef _OPENMP
+            #pragma omp critical
+            #endif
+            openFailed = true;
         }
-        //(TIFFReadDirectory(tif));
-        uint32 width, height;
-        uint16 depth_, bps_;
 
-        for (int i=0; i < dimensions.z*band; i++) {
-            TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &width);
-            TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &height);
-            TIFFGetField(tif, TIFFTAG_SAMPLESPERPIXEL, &depth_);
-            TIFFGetField(tif, TIFFTAG_BITSPERSAMPLE, &bps_);
+        #ifdef _OPENMP
+        #pragma omp for schedule(dynamic)
+        #endif
+        for (int i=0; i < numPages; i++) {
+            const Page& page = pages[firstPage + i];
+            uint8_t* dest = static_cast<uint8_t*>(targetDataset[i % band]->getData()) + (i / band) * sliceBytes;
 
             // if size or type of current image do not match skip the image..
-            if ((dimensions.x != static_cast<int>(width)) || (dimensions.y != static_cast<int>(height)) || (bps != bps_) || (depth_ != depth)) {
-                LWARNING("Images dimensions of " << i << ". image do not match!");
+            if (page.width_ != format.width_ || page.height_ != format.height_ || page.bitsPerSample_ != format.bitsPerSample_
+                || page.samplesPerPixel_ != format.samplesPerPixel_ || page.sampleFormat_ != format.sampleFormat_)
+            {
+                memset(dest, 0, sliceBytes);
+                pageStatus[i] = 1;
             }
-            else {
-                int currentBand = i % band;
-                // Read in the possibly multiple strips
-                int stripMax, stripCount;
-                tsize_t stripSize;
-                unsigned long imageOffset, result;
-                unsigned long bufferSize;
-                stripSize = TIFFStripSize (tif);
-                stripMax = TIFFNumberOfStrips (tif);
-
-                imageOffset = 0;
-
-                bufferSize = stripMax * stripSize;
-                uint8_t* buffer = new uint8_t[bufferSize];
-
-                for (stripCount = 0; stripCount < stripMax; stripCount++) {
-                    if (static_cast<int>(result = TIFFReadEncodedStrip (tif, stripCount,
-                                    buffer + imageOffset,
-                                    stripSize)) == -1){
-                        LERROR("Read error on input strip number " << stripCount);
-                        delete[] buffer;
-                        delete[] minValue;
-                        delete[] maxValue;
-                        for (int i=0; i<band; ++i)
-                            delete targetDataset[i];
-                        TIFFClose(tif);
-                        throw tgt::CorruptedFileException("Read error on input strip number " + itos(stripCount));
-                    }
-                    imageOffset += result;
-                }
-                for (int j=0; j<dimensions.x*dimensions.y; ++j) {
-                    int value;
-                    if (use8BitDataset)
-                        value = buffer[j];
-                    else
-                        value = buffer[j*2] + 256*buffer[j*2+1];
-                    if (minValue[currentBand] > value)
-                        minValue[currentBand] = value;
-                    if (maxValue[currentBand] < value)
-                        maxValue[currentBand] = value;
-                }
-                if (use8BitDataset) {
-                    memcpy(scalars8[currentBand], buffer, dimensions.x * dimensions.y);
-                    scalars8[currentBand] += dimensions.x * dimensions.y;
-                }
-                else {
-                    memcpy(scalars16[currentBand], buffer, dimensions.x * dimensions.y * 2);
-                    scalars16[currentBand] += dimensions.x * dimensions.y;
-                }
-                delete[] buffer;
+            else if (!tif || !TIFFSetSubDirectory(tif, static_cast<toff_t>(page.offset_))
+                     || !decodePage(tif, page, dest, bytesPerPixel))
+            {
+                pageStatus[i] = 2;
             }
-            TIFFReadDirectory(tif);
 
+#ifdef _OPENMP
+            // progress bars may only be updated from the calling thread
+            if (omp_get_thread_num() == 0)
+#endif
             if (getProgressBar())
-                getProgressBar()->setProgress(static_cast<float>(i) / static_cast<float>(dimensions.z*band));
+                getProgressBar()->setProgress(static_cast<float>(i) / static_cast<float>(numPages));
+        }
+
+        if (tif)
+            TIFFClose(tif);
+    }
+
+    for (int i=0; i < numPages; i++) {
+        if (pageStatus[i] == 1) {
+            LWARNING("Images dimensions of " << (firstPage + i) << ". image do not match!");
         }
+        else if (pageStatus[i] == 2) {
+            for (int j=0; j<band; ++j)
+                delete targetDataset[j];
+            if (openFailed) {
+                LERROR("Failed to open TIFF stack");
+                throw tgt::IOException("Failed to open TIFF stack", fileName);
+            }
+            LERROR("Read error in image " << (firstPage + i));
+            throw tgt::CorruptedFileException("Read error in image " + itos(static_cast<int>(firstPage + i)), fileName);
+        }
+    }
 
-        TIFFClose(tif);
-        for (int i=0; i<band; ++i) {
-            LINFO("Band " << i << ": min/max value: " << minValue[i] << "/" << maxValue[i]);
-            if ( !use8BitDataset && maxValue[i] < 4096) {
+    for (int i=0; i<band; ++i) {
+        if (VolumeUInt8* volume8 = dynamic_cast<VolumeUInt8*>(targetDataset[i])) {
+            LINFO("Band " << i << ": min/max value: " << static_cast<int>(volume8->min()) << "/" << static_cast<int>(volume8->max()));
+        }
+        else if (VolumeUInt16* volume16 = dynamic_cast<VolumeUInt16*>(targetDataset[i])) {
+            LINFO("Band " << i << ": min/max value: " << volume16->min() << "/" << volume16->max());
+            if (volume16->max() < 4096) {
                 LINFO("Band " << i << ": Recognized 12 bit dataset.");
-                targetDataset[i]->setBitsStored(12);
+                volume16->setBitsStored(12);
             }
         }
-        delete[] minValue;
-        delete[] maxValue;
     }
 
     VolumeCollection* volumeCollection = new VolumeCollection();
@@ -280,6 +252,130 @@ VolumeCollection* TiffVolumeReader::read(const std::string &url)
     return volumeCollection;
 }
 
+std::vector<TiffVolumeReader::Page> TiffVolumeReader::indexPages(const std::string& fileName, int& band, int& slices) const
+    throw (tgt::FileException)
+{
+#if TIFFLIB_VERSION < 20111221
+    if (isBigTiff(fileName)) {
+        LERROR("BigTIFF files require libtiff 4");
+        throw tgt::UnsupportedFormatException("tiff", fileName);
+    }
+#endif
+
+    TIFF* tif = TIFFOpen(fileName.c_str(), "r");
+    if (!tif) {
+        LERROR("Failed to open tiffstack");
+        throw tgt::IOException("Failed to open TIFF stack", fileName);
+    }
+
+    uint16 count;
+    void *data;
+    if (TIFFGetField(tif, 33471, &count, &data)) {
+        std::istringstream stream(static_cast<char*>(data));
+        TextFileReader reader(&stream);
+        reader.setSeparators("=");
+        LDEBUG(static_cast<char*>(data));
+        string type;
+        std::istringstream args;
+        while (reader.getNextLine(type, args, false)) {
+            LDEBUG(type << ": " << args.str());
+            if (type == "Band") {
+                args >> band;
+                LINFO("Band: " << band);
+            }
+            else if (type == "Z") {
+                args >> slices;
+                LINFO("Slices: " << slices);
+            }
+            else {
+                // Parse lines of type <type> <value> and log results
+                // Later on these data should be filled into the metadata structure of a volume
+                int value;
+                int pos = static_cast<int>(type.size()) - 1;
+                while (isdigit(type[pos]) && pos > 0)
+                    --pos;
+                type = type.substr(0, pos+1);
+                std::stringstream valueStr(type.substr(pos+1, type.size()-1));
+                valueStr >> value;
+                LDEBUG("Type: " << type << " with value: " << value);
+            }
+        }
+    }
+
+    // read each directory once, the pages are then accessed directly by their offsets
+    std::vector<Page> pages;
+    do {
+        Page page;
+        uint32 width = 0, height = 0;
+        uint16 samplesPerPixel, bitsPerSample, sampleFormat, planarConfig;
+        TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &width);
+        TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &height);
+        TIFFGetFieldDefaulted(tif, TIFFTAG_SAMPLESPERPIXEL, &samplesPerPixel);
+        TIFFGetFieldDefaulted(tif, TIFFTAG_BITSPERSAMPLE, &bitsPerSample);
+        TIFFGetFieldDefaulted(tif, TIFFTAG_SAMPLEFORMAT, &sampleFormat);
+        TIFFGetFieldDefaulted(tif, TIFFTAG_PLANARCONFIG, &planarConfig);
+
+        page.offset_ = TIFFCurrentDirOffset(tif);
+        page.width_ = width;
+        page.height_ = height;
+        page.samplesPerPixel_ = samplesPerPixel;
+        page.bitsPerSample_ = bitsPerSample;
+        page.sampleFormat_ = sampleFormat;
+        page.planarConfig_ = planarConfig;
+        page.tiled_ = (TIFFIsTiled(tif) != 0);
+        pages.push_back(page);
+    } while (TIFFReadDirectory(tif));
+
+    TIFFClose(tif);
+    return pages;
+}
+
+bool TiffVolumeReader::decodePage(TIFF* tif, const Page& page, uint8_t* dest, size_t bytesPerPixel) const {
+    const size_t rowBytes = bytesPerPixel * page.width_;
+    const size_t sliceBytes = rowBytes * page.height_;
+
+    if (!page.tiled_) {
+        // strips cover whole rows, so they are decoded directly into the slice
+        uint32 rowsPerStrip = page.height_;
+        TIFFGetFieldDefaulted(tif, TIFFTAG_ROWSPERSTRIP, &rowsPerStrip);
+        const size_t stripBytes = rowBytes * std::min(rowsPerStrip, page.height_);
+        const tstrip_t numStrips = TIFFNumberOfStrips(tif);
+
+        for (tstrip_t strip = 0; strip < numStrips; ++strip) {
+            const size_t offset = strip * stripBytes;
+            if (offset >= sliceBytes)
+                break;
+            const size_t size = std::min(stripBytes, sliceBytes - offset);
+            if (TIFFReadEncodedStrip(tif, strip, dest + offset, static_cast<tsize_t>(size)) == -1)
+                return false;
+        }
+    }
+    else {
+        uint32 tileWidth = 0, tileLength = 0;
+        TIFFGetField(tif, TIFFTAG_TILEWIDTH, &tileWidth);
+        TIFFGetField(tif, TIFFTAG_TILELENGTH, &tileLength);
+        if (tileWidth == 0 || tileLength == 0)
+            return false;
+
+        // tiles are padded to the full tile size at the image border, so they are decoded into a buffer
+        std::vector<uint8_t> tile(TIFFTileSize(tif));
+        const size_t tileRowBytes = bytesPerPixel * tileWidth;
+        for (uint32 y = 0; y < page.height_; y += tileLength) {
+            const uint32 rows = std::min(tileLength, page.height_ - y);
+            for (uint32 x = 0; x < page.width_; x += tileWidth) {
+                if (TIFFReadTile(tif, &tile[0], x, y, 0, 0) == -1)
+                    return false;
+
+                const size_t columnBytes = bytesPerPixel * std::min(tileWidth, page.width_ - x);
+                for (uint32 row = 0; row < rows; ++row)
+                    memcpy(dest + (y + row) * rowBytes + x * bytesPerPixel, &tile[row * tileRowBytes], columnBytes);
+            }
+        }
+    }
+
+    return true;
+}
+
 VolumeReader* TiffVolumeReader::create(ProgressBar* progress) const {
     return new TiffVolumeReader(progress);
 }
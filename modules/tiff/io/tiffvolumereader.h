@@ -31,12 +31,22 @@
 
 #include "voreen/core/io/volumereader.h"
 
+#include <vector>
+
+// libtiff handle, see tiffio.h
+struct tiff;
+
 namespace voreen {
 
 class IOProgress;
 
 /**
  * Reads a multi-image TIFF file into a volume dataset.
+ *
+ * The directories of all pages are indexed once, after which the pages are
+ * decoded concurrently, each thread using its own TIFF handle, directly into
+ * the slices of the target volume. Stripped and tiled images with any compression
+ * supported by libtiff can be read. BigTIFF files require libtiff 4.
  */
 class TiffVolumeReader : public VolumeReader {
 public:
@@ -50,7 +60,39 @@ public:
     virtual VolumeCollection* read(const std::string& url)
         throw (tgt::FileException, tgt::IOException, std::bad_alloc);
 
+    /**
+     * Reads the slices [firstSlice, lastSlice) of each band.
+     * If both are zero, all slices are read.
+     */
+    virtual VolumeCollection* readSlices(const std::string& url, size_t firstSlice = 0, size_t lastSlice = 0)
+        throw (tgt::FileException, std::bad_alloc);
+
 private:
+    /// Directory entries of a page required for decoding it.
+    struct Page {
+        uint64_t offset_;           ///< file offset of the directory
+        uint32_t width_;
+        uint32_t height_;
+        uint16_t samplesPerPixel_;
+        uint16_t bitsPerSample_;
+        uint16_t sampleFormat_;
+        uint16_t planarConfig_;
+        bool tiled_;
+    };
+
+    /**
+     * Reads the directories of all pages and the number of bands and slices
+     * from the ImageJ/Leica description tag, if present.
+     */
+    std::vector<Page> indexPages(const std::string& fileName, int& bands, int& slices) const
+        throw (tgt::FileException);
+
+    /**
+     * Decodes the page the handle is positioned at into dest, which holds
+     * width*height*bytesPerPixel bytes. Returns false on a read error.
+     */
+    bool decodePage(tiff* tif, const Page& page, uint8_t* dest, size_t bytesPerPixel) const;
+
     static const std::string loggerCat_;
 };
 
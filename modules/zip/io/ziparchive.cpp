@@ -29,6 +29,7 @@
 #include "ziparchive.h"
 
 #include <algorithm>
+#include <cstdio>
 #include <cstring>
 
 #include <zlib.h>
@@ -38,11 +39,39 @@ using tgt::File;
 using tgt::RegularFile;
 using tgt::MemoryFile;
 
+namespace {
+
+// Seeks to an absolute offset, which may exceed 2 GB, within a C file handle.
+bool seekFile(FILE* file, uint64_t offset) {
+#if defined(_MSC_VER)
+    return (_fseeki64(file, static_cast<__int64>(offset), SEEK_SET) == 0);
+#elif defined(__MINGW32__)
+    return (fseeko64(file, static_cast<off64_t>(offset), SEEK_SET) == 0);
+#else
+    return (fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0);
+#endif
+}
+
+// Computes the CRC32 of a buffer, which may exceed the 32 bit length parameter of zlib.
+unsigned long computeCRC(const char* data, uint64_t numBytes) {
+    unsigned long crc = crc32(0L, Z_NULL, 0);
+    while (numBytes > 0) {
+        uInt chunk = static_cast<uInt>((numBytes < (1 << 30)) ? numBytes : (1 << 30));
+        crc = crc32(crc, reinterpret_cast<const Bytef*>(data), chunk);
+        data += chunk;
+        numBytes -= chunk;
+    }
+    return crc;
+}
+
+} // namespace
+
 namespace voreen {
 
 const std::string ZipArchive::loggerCat_ = "tgt.ZipArchive";
-const size_t ZipArchive::MAX_BUFFER_SIZE = 4096;
+const size_t ZipArchive::MAX_BUFFER_SIZE = 1 << 20;
 const uint16_t ZipArchive::ZIP_VERSION = 0x0014;
+const uint16_t ZipArchive::ZIP64_VERSION = 0x002D;
 
 ZipArchive::ZipArchive(const std::string& archiveName, const bool autoOpen)
     : archive_(0)
@@ -146,20 +175,22 @@ File* ZipArchive::extractFile(const std::string& fileName, const ZipArchive::Arc
         return 0;
     }
 
+    // The sizes are taken from the Central Directory, because the Local File Header
+    // contains zeros if a Data Descriptor is used or 0xFFFFFFFF for Zip64 entries.
+    //
     ZipLocalFileHeader& lfh = af.zipLocalFileHeader_;
-    size_t bufferSize = (lfh.compressionMethod == 0) ? lfh.uncompressedSize : lfh.compressedSize;
+    uint64_t bufferSize = (lfh.compressionMethod == 0) ? af.uncompressedSize_ : af.compressedSize_;
     if (bufferSize == 0) {
         LERROR("File size of '" << af.fileName_ << "' is 0.");
         return 0;
     }
 
-    if (lfh.generalPurposeFlag != 0x0000) {
-        LERROR("The file " << af.fileName_ << " seems to make " <<
-            "use of advanced features this reader cannot deal with");
+    if ((lfh.generalPurposeFlag & (FLAG_ENCRYPTED | FLAG_STRONGENCRYPTION | FLAG_MASKEDHEADER)) != 0) {
+        LERROR("The file " << af.fileName_ << " is encrypted, which this reader cannot deal with");
         return 0;
     }
 
-    size_t fileOffset = (af.localHeaderOffset_ + SIZE_ZIPLOCALFILEHEADER
+    uint64_t fileOffset = (af.localHeaderOffset_ + SIZE_ZIPLOCALFILEHEADER
         + lfh.filenameLength + lfh.extraFieldLength);
     std::string zipFileName = ((keepDirectoryStructure == true) ? af.fileName_ 
         : FileSystem::fileName(af.fileName_));
@@ -193,20 +224,19 @@ File* ZipArchive::extractFile(const std::string& fileName, const ZipArchive::Arc
             LDEBUG("compression method: archive (no compression)");
             switch (target) {
                 case TARGET_DISK:
-                    return extractUncompressedToDisk(zipFileName, lfh.uncompressedSize, fileOffset);
+                    return extractUncompressedToDisk(zipFileName, af.uncompressedSize_, fileOffset);
                 case TARGET_MEMORY:
-                    return extractUncompressedToMemory(zipFileName, lfh.uncompressedSize, fileOffset);
+                    return extractUncompressedToMemory(zipFileName, af.uncompressedSize_, fileOffset);
             }
             break;
         case 8:
             LDEBUG("compression method: deflate");
             switch (target) {
                 case TARGET_DISK:
-                    return inflateToDisk(zipFileName, lfh.compressedSize, 
-                        lfh.uncompressedSize, fileOffset);
+                    return inflateToDisk(zipFileName, af.compressedSize_, 
+                        af.uncompressedSize_, fileOffset);
                 case TARGET_MEMORY:
-                    return inflateToMemory(zipFileName, lfh.compressedSize, 
-                        lfh.uncompressedSize, fileOffset);
+                    return inflateToMemory(zipFileName, af.fileName_, af.uncompressedSize_);
             }
             break;
         default:
@@ -253,6 +283,140 @@ size_t ZipArchive::getNumFilesInArchive() const {
     return files_.size();
 }
 
+uint64_t ZipArchive::getUncompressedSize(const std::string& fileName) const {
+    ArchiveMap::const_iterator it = files_.find(fileName);
+    if ((it == files_.end()) || (it->second.isNewInArchive_ == true))
+        return 0;
+    return it->second.uncompressedSize_;
+}
+
+bool ZipArchive::inflateFile(const std::string& fileName, void* dest, uint64_t numBytes,
+                             uint64_t offset) const
+{
+    ArchiveMap::const_iterator it = files_.find(fileName);
+    if ((it == files_.end()) || (it->second.isNewInArchive_ == true) || (dest == 0))
+        return false;
+
+    const ArchivedFile& af = it->second;
+    const ZipFileHeader& fileHeader = af.zipFileHader_;
+    if ((fileHeader.generalPurposeFlag & (FLAG_ENCRYPTED | FLAG_STRONGENCRYPTION | FLAG_MASKEDHEADER)) != 0)
+        return false;
+    if ((fileHeader.compressionMethod != 0) && (fileHeader.compressionMethod != 8))
+        return false;
+    if ((offset > af.uncompressedSize_) || (numBytes > af.uncompressedSize_ - offset))
+        return false;
+
+    // A separate handle is used instead of archive_, so that concurrent calls
+    // do not interfere with each other's file position.
+    //
+    FILE* fin = fopen(archiveName_.c_str(), "rb");
+    if (fin == 0)
+        return false;
+
+    // The extra field of the Local File Header may differ from the one in the
+    // Central Directory, so the header has to be read for locating the data.
+    //
+    ZipLocalFileHeader lfh;
+    bool success = seekFile(fin, af.localHeaderOffset_)
+        && (fread(&lfh, SIZE_ZIPLOCALFILEHEADER, 1, fin) == 1)
+        && (lfh.signature == SIGNATURE_ZIPLOCALFILEHEADER)
+        && seekFile(fin, af.localHeaderOffset_ + SIZE_ZIPLOCALFILEHEADER 
+            + lfh.filenameLength + lfh.extraFieldLength);
+
+    char* out = static_cast<char*>(dest);
+    if (success && (fileHeader.compressionMethod == 0)) {
+        // stored: read directly into the destination
+        if (offset > 0)
+            success = seekFile(fin, af.localHeaderOffset_ + SIZE_ZIPLOCALFILEHEADER 
+                + lfh.filenameLength + lfh.extraFieldLength + offset);
+        for (uint64_t left = numBytes; success && (left > 0); ) {
+            size_t chunk = static_cast<size_t>((left < (1 << 30)) ? left : (1 << 30));
+            success = (fread(out + (numBytes - left), 1, chunk, fin) == chunk);
+            left -= chunk;
+        }
+    }
+    else if (success) {
+        z_stream strm;
+        strm.zalloc = Z_NULL;
+        strm.zfree = Z_NULL;
+        strm.opaque = Z_NULL;
+        strm.avail_in = 0;
+        strm.next_in = Z_NULL;
+
+        char* inBuffer = 0;
+        char* skipBuffer = 0;
+        try {
+            inBuffer = new char[MAX_BUFFER_SIZE];
+            if (offset > 0)
+                skipBuffer = new char[MAX_BUFFER_SIZE];
+        } catch (std::bad_alloc&) {
+            delete [] inBuffer;
+            fclose(fin);
+            return false;
+        }
+
+        success = (inflateInit2(&strm, -15) == Z_OK);
+        if (success) {
+            uint64_t compressedLeft = af.compressedSize_;
+            uint64_t skipLeft = offset;
+            uint64_t outLeft = numBytes;
+            while (outLeft > 0) {
+                if (strm.avail_in == 0) {
+                    size_t toRead = static_cast<size_t>((compressedLeft < MAX_BUFFER_SIZE) ? compressedLeft : MAX_BUFFER_SIZE);
+                    size_t read = (toRead > 0) ? fread(inBuffer, 1, toRead, fin) : 0;
+                    if (read == 0) {
+                        success = false;
+                        break;
+                    }
+                    compressedLeft -= read;
+                    strm.avail_in = static_cast<uInt>(read);
+                    strm.next_in = reinterpret_cast<Bytef*>(inBuffer);
+                }
+
+                // Data in front of the requested range is inflated into a scratch
+                // buffer and discarded, everything else goes straight to the destination.
+                //
+                uInt chunk;
+                if (skipLeft > 0) {
+                    chunk = static_cast<uInt>((skipLeft < MAX_BUFFER_SIZE) ? skipLeft : MAX_BUFFER_SIZE);
+                    strm.next_out = reinterpret_cast<Bytef*>(skipBuffer);
+                }
+                else {
+                    chunk = static_cast<uInt>((outLeft < (1 << 30)) ? outLeft : (1 << 30));
+                    strm.next_out = reinterpret_cast<Bytef*>(out + (numBytes - outLeft));
+                }
+                strm.avail_out = chunk;
+
+                int res = inflate(&strm, Z_NO_FLUSH);
+                if ((res != Z_OK) && (res != Z_STREAM_END) && ((res != Z_BUF_ERROR) || (strm.avail_in > 0))) {
+                    success = false;
+                    break;
+                }
+
+                uInt produced = chunk - strm.avail_out;
+                if (skipLeft > 0)
+                    skipLeft -= produced;
+                else
+                    outLeft -= produced;
+
+                if ((res == Z_STREAM_END) && (outLeft > 0)) {
+                    success = false;
+                    break;
+                }
+            }
+            inflateEnd(&strm);
+        }
+        delete [] inBuffer;
+        delete [] skipBuffer;
+    }
+    fclose(fin);
+
+    if (success && (offset == 0) && (numBytes == af.uncompressedSize_))
+        success = (computeCRC(out, numBytes) == fileHeader.crc32);
+
+    return success;
+}
+
 bool ZipArchive::isOpen() const {
     return (archive_ && archive_->isOpen());
 }
@@ -372,8 +536,8 @@ bool ZipArchive::save() {
 //
 
 File* ZipArchive::extractUncompressedToDisk(const std::string& outFileName, 
-                                            const size_t uncompressedSize, 
-                                            const size_t archiveOffset)
+                                            const uint64_t uncompressedSize, 
+                                            const uint64_t archiveOffset)
 {
     if (checkFileHandleValid() == false)
         return 0;
@@ -387,7 +551,7 @@ File* ZipArchive::extractUncompressedToDisk(const std::string& outFileName,
 
     // Allocate buffers for in- and output
     //
-    size_t inBufferSize = (uncompressedSize < MAX_BUFFER_SIZE) ? uncompressedSize : MAX_BUFFER_SIZE;
+    size_t inBufferSize = static_cast<size_t>((uncompressedSize < MAX_BUFFER_SIZE) ? uncompressedSize : MAX_BUFFER_SIZE);
     char* inBuffer = 0;
 
     try {
@@ -397,15 +561,15 @@ File* ZipArchive::extractUncompressedToDisk(const std::string& outFileName,
         return 0;
     }
 
-    size_t readTotal = 0;
+    uint64_t readTotal = 0;
     archive_->seek(archiveOffset, File::BEGIN);
     do {
         // If the number of bytes left to read becomes smaller than the buffer's size
         // reduce the number of bytes to be read.
         //
-        size_t left = uncompressedSize - readTotal;
+        uint64_t left = uncompressedSize - readTotal;
         if (left < inBufferSize)
-            inBufferSize = left;
+            inBufferSize = static_cast<size_t>(left);
 
         size_t read = archive_->read(inBuffer, inBufferSize);
         readTotal += read;
@@ -423,15 +587,15 @@ File* ZipArchive::extractUncompressedToDisk(const std::string& outFileName,
 }
 
 File* ZipArchive::extractUncompressedToMemory(const std::string& outFileName, 
-                                              const size_t uncompressedSize, 
-                                              const size_t archiveOffset)
+                                              const uint64_t uncompressedSize, 
+                                              const uint64_t archiveOffset)
 {
     if (checkFileHandleValid() == false)
         return 0;
 
     // Allocate buffers for in- and output
     //
-    size_t inBufferSize = uncompressedSize;
+    size_t inBufferSize = static_cast<size_t>(uncompressedSize);
     char* inBuffer = 0;
 
     try {
@@ -446,7 +610,7 @@ File* ZipArchive::extractUncompressedToMemory(const std::string& outFileName,
     return new MemoryFile(inBuffer, read, outFileName, true);
 }
 
-size_t ZipArchive::deflateToDisk(File& inFile, std::ofstream& archive, unsigned long& crc) {
+uint64_t ZipArchive::deflateToDisk(File& inFile, std::ofstream& archive, unsigned long& crc) {
     if ((inFile.isOpen() == false) || (archive.is_open() == false)) {
         LERROR("deflateToDisk(): erroneous parameters! Handles might be closed.");
         return 0;
@@ -487,8 +651,8 @@ size_t ZipArchive::deflateToDisk(File& inFile, std::ofstream& archive, unsigned
     // While we are reading the input file, we can also compute the CRC32...
     //
     crc = crc32(crc, Z_NULL, 0);
-    size_t readTotal = 0;
-    size_t writtenTotal = 0;
+    uint64_t readTotal = 0;
+    uint64_t writtenTotal = 0;
     bool error = false;
     inFile.seek(0, File::BEGIN);
     do {
@@ -528,8 +692,8 @@ size_t ZipArchive::deflateToDisk(File& inFile, std::ofstream& archive, unsigned
     return writtenTotal;
 }
 
-File* ZipArchive::inflateToDisk(const std::string& outFileName, const size_t compressedSize,
-        const size_t uncompressedSize, size_t archiveOffset)
+File* ZipArchive::inflateToDisk(const std::string& outFileName, const uint64_t compressedSize,
+        const uint64_t uncompressedSize, uint64_t archiveOffset)
 {
     if (checkFileHandleValid() == false)
         return 0;
@@ -564,8 +728,8 @@ File* ZipArchive::inflateToDisk(const std::string& outFileName, const size_t com
 
     // Allocate buffers for in- and output
     //
-    size_t inBufferSize = (compressedSize < MAX_BUFFER_SIZE) ? compressedSize : MAX_BUFFER_SIZE;
-    size_t outBufferSize = (uncompressedSize < MAX_BUFFER_SIZE) ? uncompressedSize : MAX_BUFFER_SIZE;
+    size_t inBufferSize = static_cast<size_t>((compressedSize < MAX_BUFFER_SIZE) ? compressedSize : MAX_BUFFER_SIZE);
+    size_t outBufferSize = static_cast<size_t>((uncompressedSize < MAX_BUFFER_SIZE) ? uncompressedSize : MAX_BUFFER_SIZE);
     char* inBuffer = 0;
     char* outBuffer = 0;
 
@@ -584,16 +748,16 @@ File* ZipArchive::inflateToDisk(const std::string& outFileName, const size_t com
         return 0;
     }
 
-    size_t readTotal = 0;
-    size_t writtenTotal = 0;
+    uint64_t readTotal = 0;
+    uint64_t writtenTotal = 0;
     archive_->seek(archiveOffset, File::BEGIN);
     do {
         // If the number of bytes left to read becomes smaller than the buffer's size
         // reduce the number of bytes to be read.
         //
-        size_t left = compressedSize - readTotal;
+        uint64_t left = compressedSize - readTotal;
         if (left < inBufferSize)
-            inBufferSize = left;
+            inBufferSize = static_cast<size_t>(left);
 
         size_t read = archive_->read(inBuffer, inBufferSize);
         readTotal += read;
@@ -625,90 +789,30 @@ File* ZipArchive::inflateToDisk(const std::string& outFileName, const size_t com
     return new RegularFile(outFileName);
 }
 
-File* ZipArchive::inflateToMemory(const std::string& outFileName, const size_t compressedSize,
-        const size_t uncompressedSize, size_t archiveOffset)
+File* ZipArchive::inflateToMemory(const std::string& outFileName, const std::string& fileName,
+        const uint64_t uncompressedSize)
 {
     if (checkFileHandleValid() == false)
         return 0;
 
-    // Prepare z_stream structure for inflating
-    //
-    z_stream strm;
-    strm.zalloc = Z_NULL;
-    strm.zfree = Z_NULL;
-    strm.opaque = Z_NULL;
-    strm.avail_in = 0;
-    strm.next_in = Z_NULL;
-    strm.avail_out = 0;
-    strm.next_out = Z_NULL;
-
-    // Initialize inflate:
-    //
-    // NOTE: inflateInit2() is an undocumented macro. The second parameter ("windowBits")
-    // suppresses header and CRC32 check by the inflate() function if it is negative!
-    //
-    if (inflateInit2(&strm, -15) != Z_OK) {
-        LERROR("inflateToDisk(): call to zlib function inflateInit() failed!");
-        return 0;
-    }
-
-    // Allocate buffers for in- and output
+    // As the entire uncompressed file size is known, the buffer is allocated
+    // once and the data are inflated directly into it.
     //
-    size_t inBufferSize = (compressedSize < MAX_BUFFER_SIZE) ? compressedSize : MAX_BUFFER_SIZE;
-    size_t outBufferSize = uncompressedSize;
-    char* inBuffer = 0;
     char* outBuffer = 0;
-
     try {
-        inBuffer = new char[inBufferSize];
+        outBuffer = new char[static_cast<size_t>(uncompressedSize)];
     } catch (std::bad_alloc&) {
-        LERROR("inflateToMemory(): failed to allocate " << inBufferSize << " Bytes for input buffer!");
+        LERROR("inflateToMemory(): failed to allocate " << uncompressedSize << " Bytes for memory file!");
         return 0;
     }
 
-    try {
-        outBuffer = new char[outBufferSize];
-    } catch (std::bad_alloc&) {
-        LERROR("inflateToMemory(): failed to allocate " << outBufferSize << " Bytes for memory file!");
-        delete [] inBuffer;
+    if (inflateFile(fileName, outBuffer, uncompressedSize) == false) {
+        LERROR("inflateToMemory(): failed to inflate file '" << fileName << "'!");
+        delete [] outBuffer;
         return 0;
     }
 
-    size_t readTotal = 0;
-    size_t writtenTotal = 0;
-    strm.avail_out = static_cast<uInt>(outBufferSize);
-    strm.next_out = reinterpret_cast<Bytef*>(outBuffer);
-
-    archive_->seek(archiveOffset, File::BEGIN);
-    do {
-        // If the number of bytes left to read becomes smaller than the buffer's size
-        // reduce the number of bytes to be read.
-        //
-        size_t left = compressedSize - readTotal;
-        if (left < inBufferSize)
-            inBufferSize = left;
-
-        size_t read = archive_->read(inBuffer, inBufferSize);
-        readTotal += read;
-        strm.avail_in = static_cast<uInt>(read);
-        strm.next_in = reinterpret_cast<Bytef*>(inBuffer);
-
-        // As the entire uncompressed file size is known, the buffer has
-        // been allocated to be large enough to hold all inflated data and
-        // should therefore not need to be resized.
-        //
-        int res = inflate(&strm, Z_NO_FLUSH);
-        if ((res == Z_OK) || (res == Z_STREAM_END))
-            writtenTotal += outBufferSize - strm.avail_out;
-        if ((res == Z_STREAM_END) || (strm.avail_out > 0) || (writtenTotal >= uncompressedSize))
-            break;
-
-    } while ((archive_->eof() == false) && (readTotal < compressedSize));
-
-    inflateEnd(&strm);
-    delete [] inBuffer;
-    
-    return new MemoryFile(outBuffer, outBufferSize, outFileName, true);
+    return new MemoryFile(outBuffer, static_cast<size_t>(uncompressedSize), outFileName, true);
 }
 
 // TODO: similar functions already exist in .cpp file for tgt::FileSystem within an
@@ -756,9 +860,7 @@ std::string ZipArchive::adjustDirectoryStyle(const std::string& directory) const
 }
 
 bool ZipArchive::checkFileHandleValid() const {
-    if (((archiveExists_ == true) && (archive_ == 0)) || (archive_->isOpen() == false)) {
-		std::cout << "\teof()?: " << archive_->eof() << "\n";
-		std::cout << "\topen()?: " << archive_->isOpen() << "\n";
+    if ((archive_ == 0) || (archive_->isOpen() == false)) {
         LERROR("Archive is not opened for reading! Call open() first.");
         return false;
     }
@@ -786,7 +888,20 @@ size_t ZipArchive::copyExistingFiles(std::ofstream& ofs,
         else
             archive_->seek(existingFiles[i].localHeaderOffset_ + SIZE_ZIPLOCALFILEHEADER, File::BEGIN);
 
-        size_t read = SIZE_ZIPLOCALFILEHEADER;
+        // Entries using a Data Descriptor have no sizes in their Local File Header.
+        // As the descriptor is not copied, the values from the Central Directory
+        // are inserted instead.
+        //
+        if ((error == false) && ((lfh.generalPurposeFlag & FLAG_DATADESCRIPTOR) != 0)) {
+            ZipFileHeader& fileHeader = existingFiles[i].zipFileHader_;
+            lfh.generalPurposeFlag = static_cast<uint16_t>(lfh.generalPurposeFlag & ~FLAG_DATADESCRIPTOR);
+            fileHeader.generalPurposeFlag = static_cast<uint16_t>(fileHeader.generalPurposeFlag & ~FLAG_DATADESCRIPTOR);
+            lfh.crc32 = fileHeader.crc32;
+            lfh.compressedSize = fileHeader.compressedSize;
+            lfh.uncompressedSize = fileHeader.uncompressedSize;
+        }
+
+        uint64_t read = SIZE_ZIPLOCALFILEHEADER;
         if (error == false) {
             ofs.write(reinterpret_cast<char*>(&lfh), SIZE_ZIPLOCALFILEHEADER);
             error = ofs.fail();
@@ -813,19 +928,21 @@ size_t ZipArchive::copyExistingFiles(std::ofstream& ofs,
         }
 
         if (error == false) {
-            size_t bufferSize = (lfh.compressedSize < MAX_BUFFER_SIZE) ? lfh.compressedSize : MAX_BUFFER_SIZE;
+            const uint64_t compressedSize = existingFiles[i].compressedSize_;
+            size_t bufferSize = static_cast<size_t>((compressedSize < MAX_BUFFER_SIZE) ? compressedSize : MAX_BUFFER_SIZE);
             char* buffer = new char[bufferSize];
-            size_t readTotal = 0;
+            uint64_t readTotal = 0;
             do {
-                size_t r = archive_->read(buffer, bufferSize);
+                uint64_t left = compressedSize - readTotal;
+                size_t r = archive_->read(buffer, static_cast<size_t>((left < bufferSize) ? left : bufferSize));
                 readTotal += r;
                 ofs.write(buffer, r);
                 error = ofs.fail();
-                if (error == true)
+                if ((error == true) || (r == 0))
                     break;
-            } while ((readTotal < lfh.compressedSize) && (archive_->eof() == false));
+            } while ((readTotal < compressedSize) && (archive_->eof() == false));
             delete [] buffer;
-            read += lfh.compressedSize;
+            read += compressedSize;
         }
 
         if (error == true) {
@@ -833,11 +950,10 @@ size_t ZipArchive::copyExistingFiles(std::ofstream& ofs,
             break;
         }
 
-        // Adjust the offset of the LocalFileHeader structure for the new output file...
+        // Adjust the offset of the LocalFileHeader structure for the new output file.
+        // The Central Directory entry is derived from it by writeCentralDirectory().
         //
-        ZipFileHeader& fileHeader = existingFiles[i].zipFileHader_;
-        fileHeader.localHeaderOffset = (outFileOffset >= 0) ? static_cast<uint32_t>(outFileOffset) : 0xFFFFFFFF;
-        std::cout << "\tlocalHeaderOffset = " << outFileOffset << "\n";
+        existingFiles[i].localHeaderOffset_ = (outFileOffset >= 0) ? static_cast<uint64_t>(outFileOffset) : 0;
         ++counter;
     }   // for (i
     return counter;
@@ -861,7 +977,7 @@ bool ZipArchive::prepareDirectories(const std::string& zipFileName) const {
     return true;
 }
 
-bool ZipArchive::readEOCDHeaderRecord(ZipArchive::ZipEOCDHeaderRecord& eocdHeaderRec)
+bool ZipArchive::readEOCDHeaderRecord(ZipArchive::ZipEOCDHeaderRecord& eocdHeaderRec, uint64_t& eocdOffset)
 {
     if (checkFileHandleValid() == false)
         return false;
@@ -871,8 +987,10 @@ bool ZipArchive::readEOCDHeaderRecord(ZipArchive::ZipEOCDHeaderRecord& eocdHeade
     //
     archive_->seek(-SIZE_ZIPEOCDRECORD, File::END);
     archive_->read(&eocdHeaderRec, SIZE_ZIPEOCDRECORD);
-    if (eocdHeaderRec.signature == SIGNATURE_ZIPEOCDHEADERRECORD)
+    if (eocdHeaderRec.signature == SIGNATURE_ZIPEOCDHEADERRECORD) {
+        eocdOffset = archive_->size() - SIZE_ZIPEOCDRECORD;
         return true;
+    }
 
     memset(&eocdHeaderRec, 0, SIZE_ZIPEOCDRECORD);
 
@@ -892,8 +1010,8 @@ bool ZipArchive::readEOCDHeaderRecord(ZipArchive::ZipEOCDHeaderRecord& eocdHeade
     //
     std::string content(buffer, bufferSize);
     char signature[4] = {'P', 'K', 0x05, 0x06};
-    size_t pos = content.rfind(signature);
-    if (pos == std::string::npos) {
+    size_t pos = content.rfind(std::string(signature, 4));
+    if ((pos == std::string::npos) || (pos + SIZE_ZIPEOCDRECORD > content.size())) {
         delete [] buffer;
         return false;
     }
@@ -901,14 +1019,36 @@ bool ZipArchive::readEOCDHeaderRecord(ZipArchive::ZipEOCDHeaderRecord& eocdHeade
     // If the signature could be found, copy the EOCDHeaderRecord
     //
     memcpy(&eocdHeaderRec, (buffer + pos), SIZE_ZIPEOCDRECORD);
+    eocdOffset = fileSize - bufferSize + pos;
     delete [] buffer;
     return true;
 }
 
-bool ZipArchive::readFileHeader(ZipArchive::ZipFileHeader& fileHeader, size_t fileOffset) {
+bool ZipArchive::readZip64EOCDRecord(ZipArchive::Zip64EOCDRecord& eocd64, uint64_t eocdOffset) {
+    if ((checkFileHandleValid() == false) || (eocdOffset < SIZE_ZIP64EOCDLOCATOR))
+        return false;
+
+    // The locator immediately precedes the End Of Central Directory Record
+    //
+    Zip64EOCDLocator locator;
+    archive_->seek(static_cast<std::streamoff>(eocdOffset - SIZE_ZIP64EOCDLOCATOR), File::BEGIN);
+    if ((archive_->read(&locator, SIZE_ZIP64EOCDLOCATOR) != SIZE_ZIP64EOCDLOCATOR)
+        || (locator.signature != SIGNATURE_ZIP64EOCDLOCATOR))
+        return false;
+
+    archive_->seek(static_cast<std::streamoff>(locator.offsetEOCDRecord), File::BEGIN);
+    if ((archive_->read(&eocd64, SIZE_ZIP64EOCDRECORD) != SIZE_ZIP64EOCDRECORD)
+        || (eocd64.signature != SIGNATURE_ZIP64EOCDRECORD)) {
+        LERROR("Zip64 End Of Central Directory Record not found at offset " << locator.offsetEOCDRecord);
+        return false;
+    }
+    return true;
+}
+
+bool ZipArchive::readFileHeader(ZipArchive::ZipFileHeader& fileHeader, uint64_t fileOffset) {
     if (checkFileHandleValid() == false)
         return false;
-    archive_->seek(fileOffset, File::BEGIN);
+    archive_->seek(static_cast<std::streamoff>(fileOffset), File::BEGIN);
     archive_->read(&fileHeader, SIZE_ZIPFILEHEADER);
     if (fileHeader.signature == SIGNATURE_ZIPFILEHEADER)
         return true;
@@ -918,11 +1058,11 @@ bool ZipArchive::readFileHeader(ZipArchive::ZipFileHeader& fileHeader, size_t fi
 }
 
 bool ZipArchive::readLocalFileHeader(ZipArchive::ZipLocalFileHeader& localFileHeader, 
-                                         size_t fileOffset)
+                                         uint64_t fileOffset)
 {
     if (checkFileHandleValid() == false)
         return false;
-    archive_->seek(fileOffset, File::BEGIN);
+    archive_->seek(static_cast<std::streamoff>(fileOffset), File::BEGIN);
     archive_->read(&localFileHeader, SIZE_ZIPLOCALFILEHEADER);
     if (localFileHeader.signature == SIGNATURE_ZIPLOCALFILEHEADER)
         return true;
@@ -931,12 +1071,12 @@ bool ZipArchive::readLocalFileHeader(ZipArchive::ZipLocalFileHeader& localFileHe
     return false;
 }
 
-std::string ZipArchive::readString(size_t fileOffset, size_t numChars) {
+std::string ZipArchive::readString(uint64_t fileOffset, size_t numChars) {
     if ((checkFileHandleValid() == false) || (numChars == 0))
         return "";
 
     char* buffer = new char[numChars + 1];
-    archive_->seek(fileOffset, File::BEGIN);
+    archive_->seek(static_cast<std::streamoff>(fileOffset), File::BEGIN);
     archive_->read(buffer, numChars);
     buffer[numChars] = '\0';
 
@@ -950,7 +1090,8 @@ bool ZipArchive::readZipFile() {
         return false;
 
     ZipEOCDHeaderRecord eocdHeaderRec;
-    if (readEOCDHeaderRecord(eocdHeaderRec) == false)
+    uint64_t eocdOffset = 0;
+    if (readEOCDHeaderRecord(eocdHeaderRec, eocdOffset) == false)
         return false;
 
     if (eocdHeaderRec.numberOfDisk != eocdHeaderRec.numberOfDiskWithStartOfCD) {
@@ -958,19 +1099,45 @@ bool ZipArchive::readZipFile() {
         return false;
     }
 
-    if (eocdHeaderRec.numberOfEntriesInCD <= 0) {
+    uint64_t numberOfEntries = eocdHeaderRec.numberOfEntriesInCD;
+    uint64_t offset = eocdHeaderRec.offsetStartCD;
+
+    // Archives exceeding the limits of the End Of Central Directory Record store
+    // the actual values in the Zip64 End Of Central Directory Record.
+    //
+    Zip64EOCDRecord eocd64;
+    if (readZip64EOCDRecord(eocd64, eocdOffset) == true) {
+        if (eocd64.numberOfDisk != eocd64.numberOfDiskWithStartOfCD) {
+            LERROR("Need disk #" << eocd64.numberOfDiskWithStartOfCD << " to read central directory!");
+            return false;
+        }
+        numberOfEntries = eocd64.numberOfEntriesInCD;
+        offset = eocd64.offsetStartCD;
+    }
+
+    if (numberOfEntries == 0) {
         LERROR("Error: central directory does not contain any entries!");
         return false;
     }
 
-    size_t offset = eocdHeaderRec.offsetStartCD;
-    for (uint16_t i = 0; i < eocdHeaderRec.numberOfEntriesInCD; ++i) {
+    for (uint64_t i = 0; i < numberOfEntries; ++i) {
         ArchivedFile af;
         ZipFileHeader& fileHeader = af.zipFileHader_;
         bool res = readFileHeader(af.zipFileHader_, offset);
+        uint64_t entryOffset = offset;
+
+        // The next file header is found at the current offset plus the size of
+        // this FileHeader struct (constant) and plus the 3 variable length fields
+        //
+        offset += (SIZE_ZIPFILEHEADER + fileHeader.filenameLength 
+            + fileHeader.extraFieldLength + fileHeader.fileCommentLength);
+
         if (res == true) {
-            if (fileHeader.generalPurposeFlag != 0x0000) {
-                LWARNING("A file seems to make use of advanced features ");
+            // Data Descriptors and UTF-8 file names do not matter, as the sizes are
+            // taken from the Central Directory, but encrypted files cannot be read.
+            //
+            if ((fileHeader.generalPurposeFlag & (FLAG_ENCRYPTED | FLAG_STRONGENCRYPTION | FLAG_MASKEDHEADER)) != 0) {
+                LWARNING("A file seems to be encrypted, which ");
                 LWARNING("this reader is unable to understand. skipping...");
                 continue;
             }
@@ -991,9 +1158,9 @@ bool ZipArchive::readZipFile() {
                 continue;
             }
 
-            size_t fileNameOffset = (offset + SIZE_ZIPFILEHEADER);
-            size_t extraFieldOffset = fileNameOffset + fileHeader.filenameLength;
-            size_t commentOffset = extraFieldOffset + fileHeader.extraFieldLength;
+            uint64_t fileNameOffset = (entryOffset + SIZE_ZIPFILEHEADER);
+            uint64_t extraFieldOffset = fileNameOffset + fileHeader.filenameLength;
+            uint64_t commentOffset = extraFieldOffset + fileHeader.extraFieldLength;
 
             if (fileHeader.filenameLength > 0)
                 af.fileName_ = readString(fileNameOffset, fileHeader.filenameLength);
@@ -1006,53 +1173,129 @@ bool ZipArchive::readZipFile() {
 
             af.isNewInArchive_ = false;
             af.localHeaderOffset_ = fileHeader.localHeaderOffset;
+            af.compressedSize_ = fileHeader.compressedSize;
+            af.uncompressedSize_ = fileHeader.uncompressedSize;
+            readZip64ExtraField(af.fileExtra_, fileHeader, af);
+
             std::pair<ArchiveMap::iterator, bool> rs = 
                 files_.insert(std::make_pair(af.fileName_, af));
             if (rs.second == false)
                 LERROR("failed to extract directory entry for file '" << af.fileName_ << "'!");
         } else
             LERROR("Failed to read directory entry for entry #" << i << "!");
-
-        // The next file header is found at the current offset plus the size of
-        // this FileHeader struct (constant) and plus the 3 variable length fields
-        //
-        offset += (SIZE_ZIPFILEHEADER + fileHeader.filenameLength 
-            + fileHeader.extraFieldLength + fileHeader.fileCommentLength);
     }
 
     return true;
 }
 
+std::string ZipArchive::createZip64ExtraField(uint64_t uncompressedSize, uint64_t compressedSize,
+                                              uint64_t localHeaderOffset, bool includeOffset)
+{
+    std::string values;
+    if (uncompressedSize >= 0xFFFFFFFF)
+        values.append(reinterpret_cast<const char*>(&uncompressedSize), sizeof(uint64_t));
+    if (compressedSize >= 0xFFFFFFFF)
+        values.append(reinterpret_cast<const char*>(&compressedSize), sizeof(uint64_t));
+    if (includeOffset && (localHeaderOffset >= 0xFFFFFFFF))
+        values.append(reinterpret_cast<const char*>(&localHeaderOffset), sizeof(uint64_t));
+
+    if (values.empty())
+        return "";
+
+    uint16_t header[2] = { ZIP64_EXTRAFIELD, static_cast<uint16_t>(values.size()) };
+    return std::string(reinterpret_cast<const char*>(header), sizeof(header)) + values;
+}
+
+void ZipArchive::readZip64ExtraField(const std::string& extra, const ZipFileHeader& fileHeader,
+                                     ArchivedFile& af)
+{
+    // The extra field consists of blocks of a 2 byte header id, a 2 byte size and the data
+    //
+    for (size_t pos = 0; pos + 4 <= extra.size(); ) {
+        uint16_t id = 0;
+        uint16_t size = 0;
+        memcpy(&id, extra.data() + pos, 2);
+        memcpy(&size, extra.data() + pos + 2, 2);
+        pos += 4;
+
+        if (id == ZIP64_EXTRAFIELD) {
+            // only the values set to 0xFFFFFFFF in the header are present, in this order
+            size_t end = std::min(pos + size, extra.size());
+            if ((fileHeader.uncompressedSize == 0xFFFFFFFF) && (pos + 8 <= end)) {
+                memcpy(&af.uncompressedSize_, extra.data() + pos, 8);
+                pos += 8;
+            }
+            if ((fileHeader.compressedSize == 0xFFFFFFFF) && (pos + 8 <= end)) {
+                memcpy(&af.compressedSize_, extra.data() + pos, 8);
+                pos += 8;
+            }
+            if ((fileHeader.localHeaderOffset == 0xFFFFFFFF) && (pos + 8 <= end))
+                memcpy(&af.localHeaderOffset_, extra.data() + pos, 8);
+            return;
+        }
+        pos += size;
+    }
+}
+
+std::string ZipArchive::removeZip64ExtraField(const std::string& extra) {
+    std::string result;
+    for (size_t pos = 0; pos + 4 <= extra.size(); ) {
+        uint16_t id = 0;
+        uint16_t size = 0;
+        memcpy(&id, extra.data() + pos, 2);
+        memcpy(&size, extra.data() + pos + 2, 2);
+        if (id != ZIP64_EXTRAFIELD)
+            result += extra.substr(pos, 4 + size);
+        pos += 4 + size;
+    }
+    return result;
+}
+
 bool ZipArchive::writeCentralDirectory(std::ofstream& ofs, 
                                        const std::vector<ZipArchive::ArchivedFile>& files)
 {
     std::streampos offsetCD = ofs.tellp();
-    size_t sizeCD = 0;
+    uint64_t sizeCD = 0;
     bool error = false;
     for (size_t i = 0; i < files.size(); ++i) {
-        const ZipFileHeader& fileHeader = files[i].zipFileHader_;
+        const ArchivedFile& af = files[i];
+
+        // Sizes and offset exceeding 32 bit are moved to a Zip64 extra field, which
+        // replaces a possibly existing one.
+        //
+        ZipFileHeader fileHeader = af.zipFileHader_;
+        std::string zip64Extra = createZip64ExtraField(af.uncompressedSize_, af.compressedSize_,
+            af.localHeaderOffset_, true);
+        std::string extra = zip64Extra + removeZip64ExtraField(af.fileExtra_);
+        fileHeader.uncompressedSize = static_cast<uint32_t>(std::min<uint64_t>(af.uncompressedSize_, 0xFFFFFFFF));
+        fileHeader.compressedSize = static_cast<uint32_t>(std::min<uint64_t>(af.compressedSize_, 0xFFFFFFFF));
+        fileHeader.localHeaderOffset = static_cast<uint32_t>(std::min<uint64_t>(af.localHeaderOffset_, 0xFFFFFFFF));
+        fileHeader.extraFieldLength = static_cast<uint16_t>(extra.size());
+        if ((zip64Extra.empty() == false) && (fileHeader.versionNeeded < ZIP64_VERSION))
+            fileHeader.versionNeeded = ZIP64_VERSION;
+
         ofs.write(reinterpret_cast<const char*>(&fileHeader), SIZE_ZIPFILEHEADER);
         sizeCD += SIZE_ZIPFILEHEADER;
         error = ofs.fail();
 
-        size_t stringSize = files[i].fileName_.size();
+        size_t stringSize = af.fileName_.size();
         sizeCD += stringSize;
         if ((error == false) && (stringSize > 0) && (stringSize == fileHeader.filenameLength)) {
-            ofs.write(files[i].fileName_.c_str(), stringSize);
+            ofs.write(af.fileName_.c_str(), stringSize);
             error = ofs.fail();
         }
 
-        stringSize = files[i].fileExtra_.size();
+        stringSize = extra.size();
         sizeCD += stringSize;
-        if ((error == false) && (stringSize > 0) && (stringSize == fileHeader.extraFieldLength)) {
-            ofs.write(files[i].fileExtra_.c_str(), stringSize);
+        if ((error == false) && (stringSize > 0)) {
+            ofs.write(extra.c_str(), stringSize);
             error = ofs.fail();
         }
 
-        stringSize = files[i].fileComment_.size();
+        stringSize = af.fileComment_.size();
         sizeCD += stringSize;
         if ((error == false) && (stringSize > 0) && (stringSize == fileHeader.fileCommentLength)) {
-            ofs.write(files[i].fileComment_.c_str(), stringSize);
+            ofs.write(af.fileComment_.c_str(), stringSize);
             error = ofs.fail();
         }
 
@@ -1062,14 +1305,46 @@ bool ZipArchive::writeCentralDirectory(std::ofstream& ofs,
         }
     }   // for
 
+    // If the number of entries, the size or the offset of the Central Directory exceed
+    // the End Of Central Directory Record, a Zip64 record and its locator are written
+    // in front of it and the exceeding fields are set to their maximum.
+    //
+    uint64_t numEntries = files.size();
+    uint64_t startCD = (offsetCD >= 0) ? static_cast<uint64_t>(offsetCD) : 0;
+    if ((error == false) && ((numEntries >= 0xFFFF) || (sizeCD >= 0xFFFFFFFF) || (startCD >= 0xFFFFFFFF))) {
+        std::streampos offsetEOCD64 = ofs.tellp();
+
+        Zip64EOCDRecord eocd64;
+        eocd64.signature = SIGNATURE_ZIP64EOCDRECORD;
+        eocd64.sizeOfRecord = SIZE_ZIP64EOCDRECORD - 12;
+        eocd64.versionMadeBy = ZIP64_VERSION;
+        eocd64.versionNeeded = ZIP64_VERSION;
+        eocd64.numberOfDisk = 0;
+        eocd64.numberOfDiskWithStartOfCD = 0;
+        eocd64.numberOfEntriesInThisCD = numEntries;
+        eocd64.numberOfEntriesInCD = numEntries;
+        eocd64.sizeOfCD = sizeCD;
+        eocd64.offsetStartCD = startCD;
+
+        Zip64EOCDLocator locator;
+        locator.signature = SIGNATURE_ZIP64EOCDLOCATOR;
+        locator.numberOfDiskWithEOCDRecord = 0;
+        locator.offsetEOCDRecord = static_cast<uint64_t>(offsetEOCD64);
+        locator.totalNumberOfDisks = 1;
+
+        ofs.write(reinterpret_cast<char*>(&eocd64), SIZE_ZIP64EOCDRECORD);
+        ofs.write(reinterpret_cast<char*>(&locator), SIZE_ZIP64EOCDLOCATOR);
+        error = ofs.fail();
+    }
+
     ZipEOCDHeaderRecord eocd;
     eocd.signature = SIGNATURE_ZIPEOCDHEADERRECORD;
     eocd.numberOfDisk = 0;
     eocd.numberOfDiskWithStartOfCD = 0;
-    eocd.numberOfEntriesInThisCD = static_cast<uint16_t>(files.size());
-    eocd.numberOfEntriesInCD = static_cast<uint16_t>(files.size());
-    eocd.sizeOfCD = static_cast<uint32_t>(sizeCD);
-    eocd.offsetStartCD = (offsetCD >= 0) ? static_cast<uint32_t>(offsetCD) : 0;
+    eocd.numberOfEntriesInThisCD = static_cast<uint16_t>(std::min<uint64_t>(numEntries, 0xFFFF));
+    eocd.numberOfEntriesInCD = static_cast<uint16_t>(std::min<uint64_t>(numEntries, 0xFFFF));
+    eocd.sizeOfCD = static_cast<uint32_t>(std::min<uint64_t>(sizeCD, 0xFFFFFFFF));
+    eocd.offsetStartCD = static_cast<uint32_t>(std::min<uint64_t>(startCD, 0xFFFFFFFF));
     eocd.commmentLength = 0;
 
     if (error == false) {
@@ -1108,24 +1383,29 @@ size_t ZipArchive::writeNewFiles(std::ofstream& ofs,
         } else
             LINFO("Writing file " << newFiles[i].fileName_);
 
+        File* inFile = newFiles[i].extHandle_;
+        if (inFile == 0)
+            inFile = new RegularFile(newFiles[i].extFileName_);
+
+        // Files, whose compressed size may exceed 4 GB, get a Zip64 extra field with
+        // both sizes in the Local File Header. The threshold leaves room for the
+        // expansion of incompressible data by deflate.
+        //
+        const bool zip64 = (static_cast<uint64_t>(inFile->size()) >= 0xFF000000);
+        const size_t lfhExtraSize = (zip64 == true) ? 20 : 0;
+
         // Seek forward from the current position to skip the LocalFileHeader struct and the file
         // name. The space has to be kept free until we know all details which are available
         // when deflateToDisk() has finished.
         //
         std::streampos archiveOffset = ofs.tellp();
-        ofs.seekp(SIZE_ZIPLOCALFILEHEADER + newFiles[i].fileName_.size(), std::ios_base::cur);
+        ofs.seekp(SIZE_ZIPLOCALFILEHEADER + newFiles[i].fileName_.size() + lfhExtraSize, std::ios_base::cur);
 
         unsigned long crc32 = 0;
-        size_t compressedSize = 0;
-        size_t uncompressedSize = 0;
-        if ((newFiles[i].extFileName_.empty() == false) && (newFiles[i].extHandle_ == 0)) {
-            RegularFile inFile(newFiles[i].extFileName_);
-            compressedSize = deflateToDisk(inFile, ofs, crc32);
-            uncompressedSize = inFile.size();
-        } else if (newFiles[i].extHandle_ != 0) {
-            compressedSize = deflateToDisk(*(newFiles[i].extHandle_), ofs, crc32);
-            uncompressedSize = newFiles[i].extHandle_->size();
-        }
+        uint64_t compressedSize = deflateToDisk(*inFile, ofs, crc32);
+        uint64_t uncompressedSize = inFile->size();
+        if (inFile != newFiles[i].extHandle_)
+            delete inFile;
 
         error = (compressedSize == 0);
 
@@ -1135,16 +1415,16 @@ size_t ZipArchive::writeNewFiles(std::ofstream& ofs,
         if (error == false) {
             ZipLocalFileHeader& lfh = newFiles[i].zipLocalFileHeader_;
             lfh.signature = 0x04034b50;
-            lfh.versionNeeded = ZIP_VERSION;
+            lfh.versionNeeded = (zip64 == true) ? ZIP64_VERSION : ZIP_VERSION;
             lfh.generalPurposeFlag = 0;
             lfh.compressionMethod = 0x0008;
             lfh.lastModTime = 0;    // Argh! Need last modification time of file in DOS (!) style...
             lfh.lastModDate = 0;    // Argh! Need last modification date of file in DOS (!) style...
             lfh.crc32 = crc32;
-            lfh.compressedSize = static_cast<uint32_t>(compressedSize);
-            lfh.uncompressedSize = static_cast<uint32_t>(uncompressedSize);
+            lfh.compressedSize = (zip64 == true) ? 0xFFFFFFFF : static_cast<uint32_t>(compressedSize);
+            lfh.uncompressedSize = (zip64 == true) ? 0xFFFFFFFF : static_cast<uint32_t>(uncompressedSize);
             lfh.filenameLength = static_cast<uint16_t>(newFiles[i].fileName_.size());
-            lfh.extraFieldLength = 0;
+            lfh.extraFieldLength = static_cast<uint16_t>(lfhExtraSize);
 
             // Seek the position where the LocalFileHeader has to be placed
             //
@@ -1158,6 +1438,14 @@ size_t ZipArchive::writeNewFiles(std::ofstream& ofs,
             error = ofs.fail();
         }
 
+        if ((error == false) && (zip64 == true)) {
+            uint16_t header[2] = { ZIP64_EXTRAFIELD, 16 };
+            ofs.write(reinterpret_cast<char*>(header), sizeof(header));
+            ofs.write(reinterpret_cast<char*>(&uncompressedSize), sizeof(uint64_t));
+            ofs.write(reinterpret_cast<char*>(&compressedSize), sizeof(uint64_t));
+            error = ofs.fail();
+        }
+
         if (error == true) {
             LERROR("writeNewFiles(): an error has occured while writing to archive!");
             break;
@@ -1166,14 +1454,16 @@ size_t ZipArchive::writeNewFiles(std::ofstream& ofs,
             // the compressed data, so seek forward to find the position where the
             // next file can be written.
             //
-            ofs.seekp(compressedSize, std::ios_base::cur);
+            ofs.seekp(static_cast<std::streamoff>(compressedSize), std::ios_base::cur);
 
             // Adjust the state of the file within this archive: it is not new any longer
             // and the file name has been adjusted. Furthermore the file now has a
             // offset for the LocalFileHeader within this new archive...
             //
             newFiles[i].isNewInArchive_ = false;
-            newFiles[i].localHeaderOffset_ = static_cast<uint32_t>(archiveOffset);
+            newFiles[i].localHeaderOffset_ = static_cast<uint64_t>(archiveOffset);
+            newFiles[i].compressedSize_ = compressedSize;
+            newFiles[i].uncompressedSize_ = uncompressedSize;
             newFiles[i].fileExtra_ = "";
             newFiles[i].fileComment_ = "";
 
@@ -1188,15 +1478,15 @@ size_t ZipArchive::writeNewFiles(std::ofstream& ofs,
             fileHeader.lastModTime = 0;
             fileHeader.lastModDate = 0;
             fileHeader.crc32 = crc32;
-            fileHeader.compressedSize = static_cast<uint32_t>(compressedSize);
-            fileHeader.uncompressedSize = static_cast<uint32_t>(uncompressedSize);
+            fileHeader.compressedSize = static_cast<uint32_t>(std::min<uint64_t>(compressedSize, 0xFFFFFFFF));
+            fileHeader.uncompressedSize = static_cast<uint32_t>(std::min<uint64_t>(uncompressedSize, 0xFFFFFFFF));
             fileHeader.filenameLength = static_cast<uint16_t>(newFiles[i].fileName_.size());
             fileHeader.extraFieldLength = static_cast<uint16_t>(newFiles[i].fileExtra_.size());
             fileHeader.fileCommentLength = static_cast<uint16_t>(newFiles[i].fileComment_.size());
             fileHeader.diskNumberStart = 0;
             fileHeader.internalFileAttributes = 0;
             fileHeader.externalFileAttributes = 0;
-            fileHeader.localHeaderOffset = static_cast<uint32_t>(newFiles[i].localHeaderOffset_);
+            fileHeader.localHeaderOffset = static_cast<uint32_t>(std::min<uint64_t>(newFiles[i].localHeaderOffset_, 0xFFFFFFFF));
         }
         ++counter;
     }   // for (i
@@ -44,8 +44,10 @@ namespace voreen {
  * This reader is fairly simple: it can only read and write unencrypted zip files
  * using the deflate/inflate methods and depends on zlib (version 1.2.3). 
  *
- * Zip64 file format is not supported either yet and it is based on the appnote.txt
- * file by PKWARE version 6.3.2 (http://www.pkware.com/documents/casestudies/APPNOTE.TXT)
+ * Zip64 extensions are used for reading and writing archives whose entries,
+ * offsets or number of entries exceed the limits of the original format. The
+ * implementation is based on the appnote.txt file by PKWARE version 6.3.2
+ * (http://www.pkware.com/documents/casestudies/APPNOTE.TXT)
  * 
  * @author  Dirk Feldmann, November 2009
  */
@@ -159,6 +161,31 @@ public:
     size_t extractFilesToDirectory(const std::string& dirName, 
         const bool replaceExistingFiles = false);
 
+    /**
+     * Returns the uncompressed size of the given file in bytes, or 0 if the
+     * archive does not contain such a saved file.
+     */
+    uint64_t getUncompressedSize(const std::string& fileName) const;
+
+    /**
+     * Decompresses the given file directly into the passed buffer without
+     * creating a temporary file or an intermediate copy.
+     *
+     * The method opens its own handle to the archive and neither modifies the
+     * archive nor logs, so it may be called concurrently from several threads,
+     * e.g. for decompressing multiple files in parallel.
+     *
+     * @param   fileName    Name of the file within the archive.
+     * @param   dest    Buffer of at least numBytes bytes receiving the data.
+     * @param   numBytes    Number of bytes to decompress.
+     * @param   offset  Number of bytes to skip at the beginning of the
+     *                  uncompressed file.
+     * @return  true if numBytes bytes have been decompressed. If the entire
+     *          file has been decompressed, its CRC32 has also been verified.
+     */
+    bool inflateFile(const std::string& fileName, void* dest, uint64_t numBytes,
+        uint64_t offset = 0) const;
+
     /**
      * Returns the (internal) names (including possible directory names) of
      * all files which already exists within this archive or which have been
@@ -211,13 +238,28 @@ private:
         SIZE_ZIPLOCALFILEHEADER = 30,
         SIZE_ZIPDATADESCRIPTOR = 12,
         SIZE_ZIPFILEHEADER = 46,
-        SIZE_ZIPEOCDRECORD = 22
+        SIZE_ZIPEOCDRECORD = 22,
+        SIZE_ZIP64EOCDRECORD = 56,
+        SIZE_ZIP64EOCDLOCATOR = 20
     };
 
     enum { 
         SIGNATURE_ZIPLOCALFILEHEADER = 0x04034b50,
         SIGNATURE_ZIPFILEHEADER = 0x02014b50,
-        SIGNATURE_ZIPEOCDHEADERRECORD = 0x06054b50
+        SIGNATURE_ZIPEOCDHEADERRECORD = 0x06054b50,
+        SIGNATURE_ZIP64EOCDRECORD = 0x06064b50,
+        SIGNATURE_ZIP64EOCDLOCATOR = 0x07064b50
+    };
+
+    enum {
+        FLAG_ENCRYPTED = 0x0001,
+        FLAG_DATADESCRIPTOR = 0x0008,
+        FLAG_STRONGENCRYPTION = 0x0040,
+        FLAG_MASKEDHEADER = 0x2000
+    };
+
+    enum { 
+        ZIP64_EXTRAFIELD = 0x0001   ///< header id of the Zip64 extended information extra field
     };
 
 #pragma pack(push, 2)
@@ -265,6 +307,26 @@ private:
         uint32_t offsetStartCD;
         uint16_t commmentLength;
     };
+
+    struct Zip64EOCDRecord {
+        uint32_t signature;         // 0x06064b50
+        uint64_t sizeOfRecord;      // size of the remaining record (44)
+        uint16_t versionMadeBy;
+        uint16_t versionNeeded;
+        uint32_t numberOfDisk;
+        uint32_t numberOfDiskWithStartOfCD;
+        uint64_t numberOfEntriesInThisCD;
+        uint64_t numberOfEntriesInCD;
+        uint64_t sizeOfCD;
+        uint64_t offsetStartCD;
+    };
+
+    struct Zip64EOCDLocator {
+        uint32_t signature;         // 0x07064b50
+        uint32_t numberOfDiskWithEOCDRecord;
+        uint64_t offsetEOCDRecord;
+        uint32_t totalNumberOfDisks;
+    };
 #pragma pack(pop)
 
     struct VRN_MODULE_ZIP_API ArchivedFile {
@@ -274,7 +336,9 @@ private:
         std::string extFileName_;   // external file name for new files
         tgt::File* extHandle_;   // handle for external files (alternative to file names, e.g. for mmapped files)
         bool isNewInArchive_;       // indicates whether this file was alreay in archive or not
-        size_t localHeaderOffset_;  // offset of the Local File Header structure within the archive
+        uint64_t localHeaderOffset_;    // offset of the Local File Header structure within the archive
+        uint64_t compressedSize_;   // sizes of the file, taken from the Zip64 extra field if present
+        uint64_t uncompressedSize_;
         ZipFileHeader zipFileHader_;    // the File Header structure for the Central Directory
         ZipLocalFileHeader zipLocalFileHeader_; // the Local File Header structure for the file
 
@@ -286,6 +350,8 @@ private:
             , extHandle_(0)
             , isNewInArchive_(true)
             , localHeaderOffset_(0)
+            , compressedSize_(0)
+            , uncompressedSize_(0)
         {}
 
         /**
@@ -298,18 +364,37 @@ private:
 
 private:
     tgt::File* extractUncompressedToDisk(const std::string& outFileName, 
-        const size_t uncompressedSize, const size_t archiveOffset);
+        const uint64_t uncompressedSize, const uint64_t archiveOffset);
 
     tgt::File* extractUncompressedToMemory(const std::string& outFileName, 
-        const size_t uncompressedSize, const size_t archiveOffset);
+        const uint64_t uncompressedSize, const uint64_t archiveOffset);
+
+    uint64_t deflateToDisk(tgt::File& inFile, std::ofstream& archive, unsigned long& crc);
 
-    size_t deflateToDisk(tgt::File& inFile, std::ofstream& archive, unsigned long& crc);
+    tgt::File* inflateToDisk(const std::string& outFileName, const uint64_t compressedSize,
+        const uint64_t uncompressedSize, uint64_t archiveOffset);
 
-    tgt::File* inflateToDisk(const std::string& outFileName, const size_t compressedSize,
-        const size_t uncompressedSize, size_t archiveOffset);
+    tgt::File* inflateToMemory(const std::string& outFileName, const std::string& fileName,
+        const uint64_t uncompressedSize);
 
-    tgt::File* inflateToMemory(const std::string& outFileName, size_t compressedSize,
-        const size_t uncompressedSize, size_t archiveOffset);
+    /**
+     * Returns the Zip64 extended information extra field containing those of the
+     * passed values which exceed the 32 bit fields of the headers. The values are
+     * stored in the order required by the specification. Returns an empty string
+     * if none of the values exceeds.
+     */
+    static std::string createZip64ExtraField(uint64_t uncompressedSize, uint64_t compressedSize,
+        uint64_t localHeaderOffset, bool includeOffset);
+
+    /**
+     * Reads the sizes and the offset from the Zip64 extended information extra field, if
+     * the corresponding header fields indicate that they are stored there.
+     */
+    static void readZip64ExtraField(const std::string& extra, const ZipFileHeader& fileHeader,
+        ArchivedFile& af);
+
+    /// Returns the passed extra field without the Zip64 extended information extra field.
+    static std::string removeZip64ExtraField(const std::string& extra);
 
     /**
      * Converts the directory names and separators as required for zip files. In
@@ -348,13 +433,20 @@ private:
      */
     bool prepareDirectories(const std::string& zipFileName) const;
 
-    bool readEOCDHeaderRecord(ZipArchive::ZipEOCDHeaderRecord& eocdHeaderRec);
+    bool readEOCDHeaderRecord(ZipArchive::ZipEOCDHeaderRecord& eocdHeaderRec, uint64_t& eocdOffset);
+
+    /**
+     * Reads the Zip64 End Of Central Directory Record, if the archive contains
+     * a locator for it in front of the End Of Central Directory Record at the
+     * given offset.
+     */
+    bool readZip64EOCDRecord(ZipArchive::Zip64EOCDRecord& eocd64, uint64_t eocdOffset);
     
-    bool readFileHeader(ZipArchive::ZipFileHeader& fileHeader, size_t fileOffset);
+    bool readFileHeader(ZipArchive::ZipFileHeader& fileHeader, uint64_t fileOffset);
     
-    bool readLocalFileHeader(ZipArchive::ZipLocalFileHeader& localFileHeader, size_t fileOffset);
+    bool readLocalFileHeader(ZipArchive::ZipLocalFileHeader& localFileHeader, uint64_t fileOffset);
     
-    std::string readString(size_t fileOffset, size_t numChars);
+    std::string readString(uint64_t fileOffset, size_t numChars);
 
     bool readZipFile();
 
@@ -371,6 +463,7 @@ private:
     static const std::string loggerCat_;
     static const size_t MAX_BUFFER_SIZE;    /**< Controls memory consumption during (de-)compression */
     static const uint16_t ZIP_VERSION;      /**< Version of zip format this archive can understand (2.0). */
+    static const uint16_t ZIP64_VERSION;    /**< Version needed to extract Zip64 archives (4.5). */
 
     tgt::File* archive_;                     /**< Handle to the archived if opened */
     const std::string archiveName_;     /**< The archive's names */
@@ -29,7 +29,8 @@
 #include "zipvolumereader.h"
 
 #include "voreen/core/voreenapplication.h"
-#include "voreen/core/io/datvolumereader.h" // used to determine related .raw file name
+#include "voreen/core/io/datvolumereader.h"
+#include "voreen/core/io/rawvolumereader.h"
 #include "voreen/core/io/progressbar.h"
 #include "voreen/core/io/volumeserializerpopulator.h"
 #include "voreen/core/io/volumeserializer.h"
@@ -41,10 +42,107 @@
 #include "ziparchive.h"
 #include <fstream>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using std::string;
 
 namespace voreen {
 
+namespace {
+
+/// Raw data of a volume, which still have to be inflated from the archive.
+struct PendingData {
+    std::string entry_;
+    Volume* volume_;
+    uint64_t offset_;
+};
+
+/**
+ * Reads the raw data referenced by a .dat file, which has been extracted to extractPath,
+ * from the archive instead of the extracted files: the data are inflated directly into
+ * the volume. If a list for pending data is passed, the data of volumes not requiring
+ * any post-processing by RawVolumeReader are only collected there for inflating them
+ * in parallel later on.
+ */
+class ZipRawVolumeReader : public RawVolumeReader {
+public:
+    ZipRawVolumeReader(const ZipArchive& zip, const std::string& extractPath,
+                       std::vector<PendingData>* pending, ProgressBar* progress)
+        : RawVolumeReader(progress)
+        , zip_(zip)
+        , extractPath_(extractPath + "/")
+        , pending_(pending)
+    {}
+
+protected:
+    virtual void readVolumeData(Volume* volume, const std::string& fileName, uint64_t offset, bool checkEOF)
+        throw (tgt::CorruptedFileException, tgt::IOException)
+    {
+        // raw files not referenced relative to the .dat file are read from disk
+        if (fileName.find(extractPath_) != 0) {
+            RawVolumeReader::readVolumeData(volume, fileName, offset, checkEOF);
+            return;
+        }
+
+        std::string entry = fileName.substr(extractPath_.length());
+        if (!zip_.containsFile(entry))
+            throw tgt::IOException("Unable to open raw file for reading", entry);
+
+        uint64_t numBytes = volume->getNumBytes();
+        if (zip_.getUncompressedSize(entry) < offset + numBytes)
+            throw tgt::CorruptedFileException("unexpected EOF: raw file truncated or ObjectModel '" +
+                                              getReadHints().objectModel_ + "' invalid", entry);
+
+        // tensor layout, normalization, slice order and byte order are
+        // corrected by RawVolumeReader directly after reading
+        const ReadHints& h = getReadHints();
+        bool postProcessed = h.objectModel_.find("TENSOR_") == 0 || h.spreadMin_ != h.spreadMax_
+            || (!h.sliceOrder_.empty() && h.sliceOrder_[0] == '-') || h.bigEndianByteOrder_;
+
+        if (pending_ && !postProcessed) {
+            PendingData data;
+            data.entry_ = entry;
+            data.volume_ = volume;
+            data.offset_ = offset;
+            pending_->push_back(data);
+        }
+        else if (!zip_.inflateFile(entry, volume->getData(), numBytes, offset)) {
+            throw tgt::CorruptedFileException("failed to inflate raw file", entry);
+        }
+    }
+
+private:
+    const ZipArchive& zip_;
+    const std::string extractPath_;
+    std::vector<PendingData>* pending_;
+};
+
+/// Reads .dat files extracted from the archive using ZipRawVolumeReader.
+class ZipDatVolumeReader : public DatVolumeReader {
+public:
+    ZipDatVolumeReader(const ZipArchive& zip, const std::string& extractPath,
+                       std::vector<PendingData>* pending, ProgressBar* progress)
+        : DatVolumeReader(progress)
+        , zip_(zip)
+        , extractPath_(extractPath)
+        , pending_(pending)
+    {}
+
+protected:
+    virtual RawVolumeReader* createRawVolumeReader() {
+        return new ZipRawVolumeReader(zip_, extractPath_, pending_, getProgressBar());
+    }
+
+private:
+    const ZipArchive& zip_;
+    const std::string extractPath_;
+    std::vector<PendingData>* pending_;
+};
+
+} // namespace
+
 const std::string ZipVolumeReader::loggerCat_("voreen.zip.ZipVolumeReader");
 
 ZipVolumeReader::ZipVolumeReader(ProgressBar* progress)
@@ -77,18 +175,28 @@ VolumeHandleBase* ZipVolumeReader::read(const VolumeOrigin& origin)
     delete xFile;   // Free resources held by tgt::File
     xFile = 0;
 
-    // Check whether this file is a .dat file and has related .raw file. If so,
-    // extract that file, too, in order to enable the DatVolumeReader to find it.
+    // Only the .dat file is extracted, the related raw data are inflated
+    // from the archive directly into the volume.
     //
-    std::string additionalFileName = "";
     if (tgt::FileSystem::fileExtension(fileName, true) == "dat") {
-        additionalFileName = DatVolumeReader::getRelatedRawFileName(temporaryPath + "/" + fileName);
+        // without a time frame, the first one is returned, as for other archived volume files
+        std::string timeframe = origin.getSearchParameter("timeframe");
+        VolumeOrigin datOrigin(temporaryPath + "/" + fileName);
+        datOrigin.addSearchParameter("timeframe", timeframe.empty() ? "0" : timeframe);
+
+        ZipDatVolumeReader datReader(zip, temporaryPath, 0, getProgressBar());
+        try {
+            result = datReader.read(datOrigin);
+        }
+        catch (...) {
+            tgt::FileSystem::deleteFile(temporaryPath + "/" + fileName);
+            throw;
+        }
+        tgt::FileSystem::deleteFile(temporaryPath + "/" + fileName);
 
-        xFile = zip.extractFile(additionalFileName, ZipArchive::TARGET_DISK, temporaryPath);
-        if (xFile == 0)
-            throw tgt::FileNotFoundException("Specific file within zip file not found", origin.getPath());
-        delete xFile;
-        xFile = 0;
+        if (result)
+            result->setOrigin(origin);
+        return result;
     }
 
     VolumeSerializerPopulator populator(getProgressBar());
@@ -103,8 +211,6 @@ VolumeHandleBase* ZipVolumeReader::read(const VolumeOrigin& origin)
     // Delete extracted file
     //
     tgt::FileSystem::deleteFile(temporaryPath + "/" + fileName);
-    if (additionalFileName.empty() == false)
-        tgt::FileSystem::deleteFile(temporaryPath + "/" + additionalFileName);
 
     return result;
 }
@@ -132,13 +238,45 @@ VolumeCollection* ZipVolumeReader::read(const std::string& url)
         }
         file.close();
     }
+    else {
+        tgt::File* xFile = zip.extractFile("index.mv", ZipArchive::TARGET_DISK, temporaryPath, true, true);
+        delete xFile;
+    }
+
+    // If all listed volumes are .dat files within the archive, only these are extracted
+    // and the raw data are inflated directly into the volumes. Otherwise, all files are
+    // extracted and loaded with the help of a temporary multivolumereader.
+    //
+    VolumeSerializerPopulator populator(getProgressBar());
+    std::vector<VolumeOrigin> mvOrigins = MultiVolumeReader(&populator, getProgressBar()).listVolumes(indexFilePath);
+    std::vector<std::string> datFiles;
+    for (size_t i = 0; i < mvOrigins.size(); ++i) {
+        std::string refFilename = mvOrigins[i].getSearchParameter("file");
+        if (tgt::FileSystem::fileExtension(refFilename, true) != "dat" || !zip.containsFile(refFilename)) {
+            datFiles.clear();
+            break;
+        }
+        datFiles.push_back(refFilename);
+    }
+
+    VolumeCollection* volumeCollection = 0;
+    if (!datFiles.empty()) {
+        try {
+            volumeCollection = readDatFiles(zip, fileName, datFiles);
+        }
+        catch (...) {
+            tgt::FileSystem::deleteFile(indexFilePath);
+            throw;
+        }
+        tgt::FileSystem::deleteFile(indexFilePath);
+        return volumeCollection;
+    }
 
     // Extract all volumes from the archive and save them locally
     zip.extractFilesToDirectory(temporaryPath);
 
     // Load the volumes with the help of a temporary multivolumereader
-    VolumeSerializerPopulator populator(getProgressBar());
-    VolumeCollection* volumeCollection = MultiVolumeReader(&populator, getProgressBar()).read(indexFilePath);
+    volumeCollection = MultiVolumeReader(&populator, getProgressBar()).read(indexFilePath);
 
     // Set the correct origins
     for (size_t iter = 0; volumeCollection && iter < volumeCollection->size(); ++iter) {
@@ -155,6 +293,99 @@ VolumeCollection* ZipVolumeReader::read(const std::string& url)
     return volumeCollection;
 }
 
+VolumeCollection* ZipVolumeReader::readDatFiles(ZipArchive& zip, const std::string& zipName,
+                                                const std::vector<std::string>& datFiles)
+    throw (tgt::FileException, std::bad_alloc)
+{
+    std::string temporaryPath = VoreenApplication::app()->getTemporaryPath();
+
+    // First, all volumes are created from their .dat files, while the inflation
+    // of their raw data is deferred, unless they need post-processing.
+    //
+    std::vector<PendingData> pending;
+    ZipDatVolumeReader datReader(zip, temporaryPath, &pending, getProgressBar());
+    std::vector<VolumeHandleBase*> handles;
+    try {
+        for (size_t i = 0; i < datFiles.size(); ++i) {
+            tgt::File* xFile = zip.extractFile(datFiles[i], ZipArchive::TARGET_DISK,
+                temporaryPath, true, true);
+            if (xFile == 0)
+                throw tgt::FileNotFoundException("Specific file within zip file not found", zipName + "/" + datFiles[i]);
+            delete xFile;
+
+            VolumeCollection* datCollection = 0;
+            try {
+                datCollection = datReader.read(temporaryPath + "/" + datFiles[i]);
+            }
+            catch (...) {
+                tgt::FileSystem::deleteFile(temporaryPath + "/" + datFiles[i]);
+                throw;
+            }
+            tgt::FileSystem::deleteFile(temporaryPath + "/" + datFiles[i]);
+
+            for (size_t j = 0; datCollection && j < datCollection->size(); ++j) {
+                VolumeHandleBase* handle = datCollection->at(j);
+                VolumeOrigin zipOrigin("zip://" + zipName + "/" + datFiles[i]);
+                std::string timeframe = handle->getOrigin().getSearchParameter("timeframe");
+                if (!timeframe.empty())
+                    zipOrigin.addSearchParameter("timeframe", timeframe);
+                handle->setOrigin(zipOrigin);
+                handles.push_back(handle);
+            }
+            delete datCollection;
+        }
+    }
+    catch (...) {
+        for (size_t i = 0; i < handles.size(); ++i)
+            delete handles[i];
+        throw;
+    }
+
+    // Then the pending raw data of all volumes are inflated in parallel, each
+    // directly into its volume.
+    //
+    LINFO("Inflating " << pending.size() << " raw file(s) from " << zipName);
+    if (getProgressBar()) {
+        getProgressBar()->setTitle("Loading Volume");
+        getProgressBar()->setMessage("Inflating volumes from " + zipName);
+        getProgressBar()->show();
+    }
+
+    std::vector<char> failed(pending.size(), 0);
+    const int numPending = static_cast<int>(pending.size());
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic)
+    #endif
+    for (int i = 0; i < numPending; ++i) {
+        Volume* volume = pending[i].volume_;
+        if (!zip.inflateFile(pending[i].entry_, volume->getData(), volume->getNumBytes(), pending[i].offset_))
+            failed[i] = 1;
+
+#ifdef _OPENMP
+        // progress bars may only be updated from the calling thread
+        if (omp_get_thread_num() == 0)
+#endif
+        if (getProgressBar())
+            getProgressBar()->setProgress(static_cast<float>(i + 1) / static_cast<float>(numPending));
+    }
+
+    if (getProgressBar())
+        getProgressBar()->hide();
+
+    for (size_t i = 0; i < pending.size(); ++i) {
+        if (failed[i]) {
+            for (size_t j = 0; j < handles.size(); ++j)
+                delete handles[j];
+            throw tgt::CorruptedFileException("failed to inflate raw file", zipName + "/" + pending[i].entry_);
+        }
+    }
+
+    VolumeCollection* volumeCollection = new VolumeCollection();
+    for (size_t i = 0; i < handles.size(); ++i)
+        volumeCollection->add(handles[i]);
+    return volumeCollection;
+}
+
 std::vector<VolumeOrigin> ZipVolumeReader::listVolumes(const std::string& url) const 
     throw (tgt::FileException) 
 {
@@ -33,11 +33,17 @@
 
 namespace voreen {
 
+class ZipArchive;
+
 /**
  * Reads multiple raw-volumes stored in a container <tt>.zip</tt>-file. Each volume needs a
  * corresponding dat-file with the additional information.
  * The zip-file may contain another file called "index.mv" which dictates an order for the volumes.
  * If no such file exists, the volumes will be loaded alphabetically.
+ *
+ * Only the dat-files are extracted, the raw data are inflated from the archive directly
+ * into the volumes. If multiple volumes are loaded, e.g., the time steps of a series,
+ * their raw data are inflated in parallel.
  */
 class ZipVolumeReader : public VolumeReader {
 public:
@@ -62,6 +68,14 @@ public:
     virtual VolumeOrigin convertOriginToAbsolutePath(const VolumeOrigin& origin, std::string& basePath) const;
 
 protected:
+    /**
+     * Loads the volumes of the passed .dat files within the archive. Only the .dat files are
+     * extracted, the raw data of all volumes are inflated in parallel directly into the volumes.
+     */
+    VolumeCollection* readDatFiles(ZipArchive& zip, const std::string& zipName,
+        const std::vector<std::string>& datFiles)
+        throw (tgt::FileException, std::bad_alloc);
+
     static const std::string loggerCat_;
 };
 
@@ -0,0 +1,178 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#include "voreen/core/datastructures/cachedimagesequence.h"
+
+#include "tgt/assert.h"
+#include "tgt/logmanager.h"
+#include "tgt/texturemanager.h"
+
+#include <algorithm>
+
+namespace voreen {
+
+const std::string CachedImageSequence::loggerCat_ = "voreen.CachedImageSequence";
+
+namespace {
+
+size_t getTextureBytes(const tgt::Texture* texture) {
+    return static_cast<size_t>(tgt::hmul(texture->getDimensions())) * texture->getBpp();
+}
+
+}
+
+CachedImageSequence::CachedImageSequence(size_t cacheSize, tgt::Texture::Filter filter, bool uploadTextures)
+    : ImageSequence()
+    , cacheSize_(cacheSize)
+    , filter_(filter)
+    , uploadTextures_(uploadTextures)
+    , cachedBytes_(0)
+{}
+
+CachedImageSequence::~CachedImageSequence() {
+    clear();
+}
+
+void CachedImageSequence::addImage(const std::string& filename) {
+    tgtAssert(!filename.empty(), "empty file name");
+    textures_.push_back(new tgt::Texture());
+    filenames_.push_back(filename);
+}
+
+void CachedImageSequence::add(tgt::Texture* texture) {
+    ImageSequence::add(texture);
+    filenames_.push_back("");
+}
+
+void CachedImageSequence::remove(const tgt::Texture* texture) {
+    std::vector<tgt::Texture*>::iterator iter = std::find(textures_.begin(), textures_.end(), texture);
+    if (iter != textures_.end())
+        remove(iter - textures_.begin());
+}
+
+void CachedImageSequence::remove(size_t i) {
+    tgtAssert(i<size(), "Invalid index");
+    // the texture is handed over to the caller as it is
+    std::list<tgt::Texture*>::iterator iter = std::find(loaded_.begin(), loaded_.end(), textures_[i]);
+    if (iter != loaded_.end()) {
+        cachedBytes_ -= getTextureBytes(*iter);
+        loaded_.erase(iter);
+    }
+    failed_.erase(textures_[i]);
+    filenames_.erase(filenames_.begin() + i);
+    ImageSequence::remove(i);
+}
+
+tgt::Texture* CachedImageSequence::at(size_t i) const {
+    tgt::Texture* texture = ImageSequence::at(i);
+    if (filenames_[i].empty() || failed_.find(texture) != failed_.end())
+        return texture;
+
+    std::list<tgt::Texture*>::iterator iter = std::find(loaded_.begin(), loaded_.end(), texture);
+    if (iter != loaded_.end()) {
+        loaded_.splice(loaded_.begin(), loaded_, iter);
+    }
+    else if (load(i)) {
+        loaded_.push_front(texture);
+        cachedBytes_ += getTextureBytes(texture);
+        shrink();
+    }
+    else {
+        failed_.insert(texture);
+    }
+
+    return texture;
+}
+
+tgt::Texture* CachedImageSequence::front() const {
+    return (empty() ? 0 : at(0));
+}
+
+tgt::Texture* CachedImageSequence::back() const {
+    return (empty() ? 0 : at(size() - 1));
+}
+
+void CachedImageSequence::clear() {
+    for (size_t i=0; i<textures_.size(); i++) {
+        if (!filenames_[i].empty())
+            delete textures_[i];
+    }
+    ImageSequence::clear();
+    filenames_.clear();
+    loaded_.clear();
+    failed_.clear();
+    cachedBytes_ = 0;
+}
+
+void CachedImageSequence::setCacheSize(size_t cacheSize) {
+    cacheSize_ = cacheSize;
+    shrink();
+}
+
+size_t CachedImageSequence::getCacheSize() const {
+    return cacheSize_;
+}
+
+size_t CachedImageSequence::getNumCachedBytes() const {
+    return cachedBytes_;
+}
+
+bool CachedImageSequence::load(size_t i) const {
+    LDEBUG("Loading image " << filenames_[i] << " ...");
+    tgt::Texture* image = TexMgr.loadIgnorePath(filenames_[i], filter_, false, !uploadTextures_, uploadTextures_, false);
+    if (!image) {
+        LWARNING("Failed to load image: " << filenames_[i]);
+        return false;
+    }
+
+    // the texture object stays the same for the consumers, only its data is replaced
+    *textures_[i] = *image;
+    image->setId(0);
+    image->setPixelData(0);
+    delete image;
+    return true;
+}
+
+void CachedImageSequence::evict(tgt::Texture* texture) const {
+    GLuint id = texture->getId();
+    if (id)
+        glDeleteTextures(1, &id);
+    texture->setId(0);
+    texture->destroy();
+}
+
+void CachedImageSequence::shrink() const {
+    while (cachedBytes_ > cacheSize_ && loaded_.size() > 1) {
+        tgt::Texture* texture = loaded_.back();
+        loaded_.pop_back();
+        cachedBytes_ -= getTextureBytes(texture);
+        evict(texture);
+    }
+}
+
+} // namespace
@@ -0,0 +1,188 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#include "voreen/core/datastructures/transfunc/preintegrationtable.h"
+
+#include "tgt/logmanager.h"
+#include "tgt/texture.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace voreen {
+
+const std::string PreIntegrationTable::loggerCat_("voreen.PreIntegrationTable");
+
+const float PreIntegrationTable::SAMPLING_BASE_INTERVAL_RCP = 200.f;
+
+namespace {
+
+/// Extinction coefficient for the given opacity per base interval.
+inline double extinction(float alpha) {
+    // clamp to keep fully opaque entries finite
+    return -std::log(1.0 - std::min(static_cast<double>(alpha), 0.9999));
+}
+
+} // namespace
+
+PreIntegrationTable::PreIntegrationTable(size_t dimension)
+    : dimension_(std::max<size_t>(dimension, 1))
+    , samplingStepSize_(0.f)
+    , table_(dimension_ * dimension_, tgt::vec4(0.f))
+    , tex_(0)
+    , textureInvalid_(true)
+{}
+
+PreIntegrationTable::~PreIntegrationTable() {
+    delete tex_;
+}
+
+void PreIntegrationTable::compute(const std::vector<tgt::vec4>& classification, float samplingStepSize) {
+    if (classification.size() != dimension_) {
+        LERROR("Classification size " << classification.size() << " does not match table dimension " << dimension_);
+        return;
+    }
+
+    pointValues_ = classification;
+
+    // summed-area tables of the extinction and the extinction-weighted color,
+    // integrated with the trapezoidal rule between neighboring bins
+    extinctionIntegral_.assign(dimension_, 0.0);
+    colorIntegral_.assign(dimension_, tgt::dvec3(0.0));
+    double prevTau = extinction(pointValues_[0].a);
+    tgt::dvec3 prevColor = tgt::dvec3(pointValues_[0].xyz()) * prevTau;
+    for (size_t i = 1; i < dimension_; ++i) {
+        double tau = extinction(pointValues_[i].a);
+        tgt::dvec3 color = tgt::dvec3(pointValues_[i].xyz()) * tau;
+        extinctionIntegral_[i] = extinctionIntegral_[i-1] + 0.5 * (prevTau + tau);
+        colorIntegral_[i] = colorIntegral_[i-1] + 0.5 * (prevColor + color);
+        prevTau = tau;
+        prevColor = color;
+    }
+
+    samplingStepSize_ = samplingStepSize;
+    integrate();
+}
+
+void PreIntegrationTable::setSamplingStepSize(float samplingStepSize) {
+    if (samplingStepSize == samplingStepSize_ || pointValues_.empty())
+        return;
+
+    samplingStepSize_ = samplingStepSize;
+    integrate();
+}
+
+void PreIntegrationTable::integrate() {
+    const double segmentLength = samplingStepSize_ * SAMPLING_BASE_INTERVAL_RCP;
+    const int dim = static_cast<int>(dimension_);
+
+    #ifdef _OPENMP
+    #pragma omp parallel for
+    #endif
+    for (int back = 0; back < dim; ++back) {
+        tgt::vec4* row = &table_[back * dimension_];
+        for (int front = 0; front < dim; ++front) {
+            tgt::vec4 result;
+            if (front == back) {
+                const tgt::vec4& value = pointValues_[back];
+                result = tgt::vec4(value.xyz(), static_cast<float>(
+                    1.0 - std::exp(-segmentLength * extinction(value.a))));
+            }
+            else {
+                // average extinction and extinction-weighted color along the segment
+                double tau = extinctionIntegral_[back] - extinctionIntegral_[front];
+                tgt::dvec3 color = colorIntegral_[back] - colorIntegral_[front];
+                double avgTau = tau / (back - front);
+
+                if (std::abs(tau) > 1e-12)
+                    result.xyz() = tgt::vec3(tgt::clamp(color / tau, tgt::dvec3(0.0), tgt::dvec3(1.0)));
+                else
+                    result.xyz() = 0.5f * (pointValues_[front].xyz() + pointValues_[back].xyz());
+                result.a = static_cast<float>(1.0 - std::exp(-segmentLength * avgTau));
+            }
+            row[front] = result;
+        }
+    }
+
+    textureInvalid_ = true;
+}
+
+float PreIntegrationTable::getSamplingStepSize() const {
+    return samplingStepSize_;
+}
+
+size_t PreIntegrationTable::getDimension() const {
+    return dimension_;
+}
+
+tgt::vec4 PreIntegrationTable::getEntry(size_t front, size_t back) const {
+    tgtAssert(front < dimension_ && back < dimension_, "Invalid table position");
+    return table_[back * dimension_ + front];
+}
+
+tgt::vec4 PreIntegrationTable::lookup(float front, float back) const {
+    // entry i refers to the bin center (i+0.5)/dimension
+    float maxPos = static_cast<float>(dimension_ - 1);
+    float x = tgt::clamp(front * dimension_ - 0.5f, 0.f, maxPos);
+    float y = tgt::clamp(back * dimension_ - 0.5f, 0.f, maxPos);
+
+    size_t x0 = static_cast<size_t>(x);
+    size_t y0 = static_cast<size_t>(y);
+    size_t x1 = std::min(x0 + 1, dimension_ - 1);
+    size_t y1 = std::min(y0 + 1, dimension_ - 1);
+    float fx = x - x0;
+    float fy = y - y0;
+
+    tgt::vec4 lower = (1.f - fx) * getEntry(x0, y0) + fx * getEntry(x1, y0);
+    tgt::vec4 upper = (1.f - fx) * getEntry(x0, y1) + fx * getEntry(x1, y1);
+    return (1.f - fy) * lower + fy * upper;
+}
+
+const tgt::vec4* PreIntegrationTable::getData() const {
+    return &table_[0];
+}
+
+tgt::Texture* PreIntegrationTable::getTexture() {
+    if (!tex_) {
+        tgt::ivec3 dims(static_cast<int>(dimension_), static_cast<int>(dimension_), 1);
+        tex_ = new tgt::Texture(dims, GL_RGBA, GL_RGBA32F_ARB, GL_FLOAT, tgt::Texture::LINEAR);
+        tex_->setWrapping(tgt::Texture::CLAMP);
+        textureInvalid_ = true;
+    }
+
+    if (textureInvalid_) {
+        memcpy(tex_->getPixelData(), &table_[0], table_.size() * sizeof(tgt::vec4));
+        tex_->uploadTexture();
+        LGL_ERROR;
+        textureInvalid_ = false;
+    }
+
+    return tex_;
+}
+
+} // namespace voreen
@@ -29,6 +29,7 @@
 #include "voreen/core/datastructures/transfunc/transfuncintensity.h"
 #include "voreen/core/datastructures/transfunc/transfuncmappingkey.h"
 #include "voreen/core/datastructures/transfunc/transfuncfactory.h"
+#include "voreen/core/datastructures/transfunc/preintegrationtable.h"
 
 #ifdef VRN_MODULE_DEVIL
     #include <IL/il.h>
@@ -37,6 +38,7 @@
 #include "tgt/logmanager.h"
 
 #include <tinyxml/tinyxml.h>
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 
@@ -58,6 +60,7 @@ TransFuncIntensity::TransFuncIntensity(int width)
     , lowerThreshold_(0.f)
     , upperThreshold_(1.f)
     , domain_(0.0, 1.0f)
+    , preIntegrationTable_(0)
 {
     loadFileFormats_.push_back("tfi");
     loadFileFormats_.push_back("lut");
@@ -80,6 +83,7 @@ TransFuncIntensity::TransFuncIntensity(int width)
 TransFuncIntensity::TransFuncIntensity(const TransFuncIntensity& tf)
     : TransFunc(tf.dimensions_.x, tf.dimensions_.y, tf.dimensions_.z,
                 tf.format_, tf.dataType_, tf.filter_)
+    , preIntegrationTable_(0)
 {
     updateFrom(tf);
 }
@@ -87,6 +91,7 @@ TransFuncIntensity::TransFuncIntensity(const TransFuncIntensity& tf)
 TransFuncIntensity::~TransFuncIntensity() {
     for (size_t i = 0; i < keys_.size(); ++i)
         delete keys_[i];
+    delete preIntegrationTable_;
 }
 
 bool TransFuncIntensity::operator==(const TransFuncIntensity& tf) const {
@@ -131,37 +136,40 @@ tgt::vec4 TransFuncIntensity::getMeanValue(float segStart, float segEnd) const {
 }
 
 col4 TransFuncIntensity::getMappingForValue(float value) const {
+    return col4(tgt::iround(getMappingForValueFloat(value) * 255.f));
+}
+
+namespace {
+
+bool keyLessThanIntensity(const TransFuncMappingKey* key, float value) {
+    return key->getIntensity() < value;
+}
+
+} // namespace
+
+tgt::vec4 TransFuncIntensity::getMappingForValueFloat(float value) const {
     // If there are no keys, any further calculation is meaningless
     if (keys_.empty())
-        return col4(0, 0, 0, 0);
+        return tgt::vec4(0.f);
 
     // Restrict value to [0,1]
     value = (value < 0.f) ? 0.f : value;
     value = (value > 1.f) ? 1.f : value;
 
-    // iterate through all keys until we get to the correct position
-    std::vector<TransFuncMappingKey*>::const_iterator keyIterator = keys_.begin();
-
-    while ((keyIterator != keys_.end()) && (value > (*keyIterator)->getIntensity()))
-        keyIterator++;
+    // first key whose intensity is not less than the value
+    std::vector<TransFuncMappingKey*>::const_iterator keyIterator =
+        std::lower_bound(keys_.begin(), keys_.end(), value, keyLessThanIntensity);
 
     if (keyIterator == keys_.begin())
-        return keys_[0]->getColorL();
+        return tgt::vec4(keys_[0]->getColorL()) / 255.f;
     else if (keyIterator == keys_.end())
-        return (*(keyIterator-1))->getColorR();
-    else{
+        return tgt::vec4((*(keyIterator-1))->getColorR()) / 255.f;
+    else {
         // calculate the value weighted by the destination to the next left and right key
         TransFuncMappingKey* leftKey = *(keyIterator-1);
         TransFuncMappingKey* rightKey = *keyIterator;
         float fraction = (value - leftKey->getIntensity()) / (rightKey->getIntensity() - leftKey->getIntensity());
-        col4 leftDest = leftKey->getColorR();
-        col4 rightDest = rightKey->getColorL();
-        col4 result = leftDest;
-        result.r += static_cast<uint8_t>((rightDest.r - leftDest.r) * fraction);
-        result.g += static_cast<uint8_t>((rightDest.g - leftDest.g) * fraction);
-        result.b += static_cast<uint8_t>((rightDest.b - leftDest.b) * fraction);
-        result.a += static_cast<uint8_t>((rightDest.a - leftDest.a) * fraction);
-        return result;
+        return tgt::mix(tgt::vec4(leftKey->getColorR()), tgt::vec4(rightKey->getColorL()), fraction) / 255.f;
     }
 }
 
@@ -190,6 +198,77 @@ void TransFuncIntensity::updateTexture() {
     textureInvalid_ = false;
 }
 
+std::vector<float> TransFuncIntensity::getStateSignature(size_t resolution) const {
+    std::vector<float> signature;
+    signature.reserve(5 + keys_.size() * 10);
+    signature.push_back(static_cast<float>(resolution));
+    signature.push_back(lowerThreshold_);
+    signature.push_back(upperThreshold_);
+    signature.push_back(domain_.x);
+    signature.push_back(domain_.y);
+    for (size_t i = 0; i < keys_.size(); ++i) {
+        signature.push_back(keys_[i]->getIntensity());
+        for (int c = 0; c < 4; ++c) {
+            signature.push_back(keys_[i]->getColorL()[c]);
+            signature.push_back(keys_[i]->getColorR()[c]);
+        }
+        signature.push_back(keys_[i]->isSplit() ? 1.f : 0.f);
+    }
+    return signature;
+}
+
+const TransFuncLookupTable& TransFuncIntensity::getLookupTable(size_t resolution) {
+    resolution = std::max<size_t>(resolution, 2);
+
+    std::vector<float> signature = getStateSignature(resolution);
+    if (signature == lookupTableSignature_)
+        return lookupTable_;
+
+    lookupTable_.resize(resolution);
+    tgt::vec4* data = lookupTable_.getData();
+    const int size = static_cast<int>(resolution);
+
+    #ifdef _OPENMP
+    #pragma omp parallel for
+    #endif
+    for (int i = 0; i < size; ++i) {
+        float value = static_cast<float>(i) / (size - 1);
+        if (value >= lowerThreshold_ && value <= upperThreshold_)
+            data[i] = getMappingForValueFloat(value);
+    }
+    lookupTableSignature_ = signature;
+
+    return lookupTable_;
+}
+
+PreIntegrationTable* TransFuncIntensity::getPreIntegrationTable(float samplingStepSize, size_t dimension) {
+    if (dimension == 0)
+        dimension = static_cast<size_t>(dimensions_.x);
+
+    std::vector<float> signature = getStateSignature(dimension);
+    if (preIntegrationTable_ && signature == preIntegrationSignature_) {
+        preIntegrationTable_->setSamplingStepSize(samplingStepSize);
+        return preIntegrationTable_;
+    }
+
+    // sample the transfer function at the bin centers
+    std::vector<tgt::vec4> classification(dimension, tgt::vec4(0.f));
+    for (size_t i = 0; i < dimension; ++i) {
+        float value = (static_cast<float>(i) + 0.5f) / dimension;
+        if (value >= lowerThreshold_ && value < upperThreshold_)
+            classification[i] = getMappingForValueFloat(value);
+    }
+
+    if (!preIntegrationTable_ || preIntegrationTable_->getDimension() != dimension) {
+        delete preIntegrationTable_;
+        preIntegrationTable_ = new PreIntegrationTable(dimension);
+    }
+    preIntegrationTable_->compute(classification, samplingStepSize);
+    preIntegrationSignature_ = signature;
+
+    return preIntegrationTable_;
+}
+
 void TransFuncIntensity::setThresholds(float lower, float upper) {
     lowerThreshold_ = lower;
     upperThreshold_ = upper;
@@ -38,6 +38,8 @@
     #include <IL/il.h>
 #endif
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 
 using tgt::Texture;
@@ -46,6 +48,21 @@ namespace voreen {
 
 const std::string TransFuncIntensityGradient::loggerCat_("voreen.TransFuncIntensityGradient");
 
+namespace {
+
+/// Triangle of a primitive, set up for barycentric interpolation.
+struct LookupTriangle {
+    tgt::vec2 origin;
+    tgt::vec2 edge1;
+    tgt::vec2 edge2;
+    float invDet;
+    tgt::vec4 colors[3];
+    tgt::vec2 llf;
+    tgt::vec2 urb;
+};
+
+} // namespace
+
 TransFuncIntensityGradient::TransFuncIntensityGradient(int width, int height)
     : TransFunc(width, height, 1, GL_RGBA, GL_FLOAT, Texture::LINEAR)
     , fbo_(0)
@@ -315,6 +332,78 @@ void TransFuncIntensityGradient::updateTexture() {
     textureInvalid_ = false;
 }
 
+const TransFuncLookupTable& TransFuncIntensityGradient::getLookupTable() {
+    std::vector<tgt::vec2> vertices;
+    std::vector<tgt::vec4> colors;
+    for (size_t i = 0; i < primitives_.size(); ++i)
+        primitives_[i]->getTriangles(vertices, colors);
+
+    // the triangles determine the table completely
+    std::vector<float> signature;
+    signature.reserve(2 + vertices.size() * 6);
+    signature.push_back(static_cast<float>(dimensions_.x));
+    signature.push_back(static_cast<float>(dimensions_.y));
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        signature.insert(signature.end(), vertices[i].elem, vertices[i].elem + 2);
+        signature.insert(signature.end(), colors[i].elem, colors[i].elem + 4);
+    }
+    if (signature == lookupTableSignature_)
+        return lookupTable_;
+
+    std::vector<LookupTriangle> triangles;
+    for (size_t i = 0; i + 2 < vertices.size(); i += 3) {
+        LookupTriangle tri;
+        tri.origin = vertices[i];
+        tri.edge1 = vertices[i+1] - vertices[i];
+        tri.edge2 = vertices[i+2] - vertices[i];
+        float det = tri.edge1.x * tri.edge2.y - tri.edge1.y * tri.edge2.x;
+        if (std::abs(det) < 1e-12f)
+            continue; // degenerate, covers no texels
+        tri.invDet = 1.f / det;
+        tri.colors[0] = colors[i];
+        tri.colors[1] = colors[i+1];
+        tri.colors[2] = colors[i+2];
+        tri.llf = tgt::min(vertices[i], tgt::min(vertices[i+1], vertices[i+2]));
+        tri.urb = tgt::max(vertices[i], tgt::max(vertices[i+1], vertices[i+2]));
+        triangles.push_back(tri);
+    }
+
+    const int width = std::max(dimensions_.x, 2);
+    const int height = std::max(dimensions_.y, 2);
+    lookupTable_.resize(width, height);
+    tgt::vec4* data = lookupTable_.getData();
+
+    // rasterize the triangles in painting order, later ones overwrite earlier ones
+    // like in updateTexture(), which renders without blending
+    const float eps = 1e-5f;
+    #ifdef _OPENMP
+    #pragma omp parallel for
+    #endif
+    for (int y = 0; y < height; ++y) {
+        float posY = static_cast<float>(y) / (height - 1);
+        tgt::vec4* row = data + y * width;
+        for (size_t t = 0; t < triangles.size(); ++t) {
+            const LookupTriangle& tri = triangles[t];
+            if (posY < tri.llf.y - eps || posY > tri.urb.y + eps)
+                continue;
+
+            int xStart = std::max(0, static_cast<int>(std::ceil(tri.llf.x * (width - 1))));
+            int xEnd = std::min(width - 1, static_cast<int>(std::floor(tri.urb.x * (width - 1))));
+            for (int x = xStart; x <= xEnd; ++x) {
+                tgt::vec2 p = tgt::vec2(static_cast<float>(x) / (width - 1), posY) - tri.origin;
+                float b1 = (p.x * tri.edge2.y - p.y * tri.edge2.x) * tri.invDet;
+                float b2 = (tri.edge1.x * p.y - tri.edge1.y * p.x) * tri.invDet;
+                float b0 = 1.f - b1 - b2;
+                if (b0 >= -eps && b1 >= -eps && b2 >= -eps)
+                    row[x] = b0 * tri.colors[0] + b1 * tri.colors[1] + b2 * tri.colors[2];
+            }
+        }
+    }
+    lookupTableSignature_ = signature;
+
+    return lookupTable_;
+}
+
 void TransFuncIntensityGradient::paint() {
     for (size_t i = 0; i < primitives_.size(); ++i)
         primitives_[i]->paint();
@@ -0,0 +1,162 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#include "voreen/core/datastructures/transfunc/transfunclookuptable.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define VRN_TRANSFUNC_SSE2
+    #include <emmintrin.h>
+#endif
+
+namespace voreen {
+
+namespace {
+
+/**
+ * Maps a normalized coordinate to the lower of the two interpolated entries
+ * and the interpolation weight. NaNs are mapped to the first entry.
+ */
+inline void findCell(float coord, size_t size, size_t& index, float& fraction) {
+    if (!(coord > 0.f))
+        coord = 0.f;
+    else if (coord > 1.f)
+        coord = 1.f;
+
+    float pos = coord * static_cast<float>(size - 1);
+    index = std::min(static_cast<size_t>(pos), size - 2);
+    fraction = pos - static_cast<float>(index);
+}
+
+} // namespace
+
+TransFuncLookupTable::TransFuncLookupTable()
+    : width_(0)
+    , height_(0)
+{}
+
+void TransFuncLookupTable::resize(size_t width, size_t height) {
+    width_ = width;
+    height_ = height;
+    data_.assign(width * height, tgt::vec4(0.f));
+}
+
+size_t TransFuncLookupTable::getWidth() const {
+    return width_;
+}
+
+size_t TransFuncLookupTable::getHeight() const {
+    return height_;
+}
+
+tgt::vec4* TransFuncLookupTable::getData() {
+    return data_.empty() ? 0 : &data_[0];
+}
+
+const tgt::vec4* TransFuncLookupTable::getData() const {
+    return data_.empty() ? 0 : &data_[0];
+}
+
+tgt::vec4 TransFuncLookupTable::lookup(float intensity) const {
+    if (data_.empty())
+        return tgt::vec4(0.f);
+    if (width_ == 1)
+        return data_[0];
+
+    size_t index;
+    float fraction;
+    findCell(intensity, width_, index, fraction);
+    return tgt::mix(data_[index], data_[index + 1], fraction);
+}
+
+tgt::vec4 TransFuncLookupTable::lookup(float intensity, float gradientMagnitude) const {
+    if (height_ <= 1)
+        return lookup(intensity);
+
+    size_t row;
+    float rowFraction;
+    findCell(gradientMagnitude, height_, row, rowFraction);
+
+    if (width_ == 1)
+        return tgt::mix(data_[row], data_[row + 1], rowFraction);
+
+    size_t index;
+    float fraction;
+    findCell(intensity, width_, index, fraction);
+
+    const tgt::vec4* lower = &data_[row * width_ + index];
+    const tgt::vec4* upper = lower + width_;
+    return tgt::mix(tgt::mix(lower[0], lower[1], fraction),
+                    tgt::mix(upper[0], upper[1], fraction), rowFraction);
+}
+
+void TransFuncLookupTable::lookup(const float* intensities, tgt::vec4* colors, size_t count) const {
+    size_t i = 0;
+
+#ifdef VRN_TRANSFUNC_SSE2
+    if (width_ >= 2) {
+        // compute cell indices and weights of four values at once, then blend the
+        // RGBA entries as one vector each
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.f);
+        const __m128 scale = _mm_set1_ps(static_cast<float>(width_ - 1));
+        const __m128 maxIndex = _mm_set1_ps(static_cast<float>(width_ - 2));
+        const tgt::vec4* data = &data_[0];
+
+        int indices[4];
+        float fractions[4];
+        for (; i + 4 <= count; i += 4) {
+            // max/min return the second operand for NaNs, which maps them to zero
+            __m128 pos = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(intensities + i), zero), one), scale);
+            __m128i index = _mm_cvttps_epi32(_mm_min_ps(pos, maxIndex));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(indices), index);
+            _mm_storeu_ps(fractions, _mm_sub_ps(pos, _mm_cvtepi32_ps(index)));
+
+            for (int k = 0; k < 4; ++k) {
+                __m128 lower = _mm_loadu_ps(data[indices[k]].elem);
+                __m128 upper = _mm_loadu_ps(data[indices[k] + 1].elem);
+                __m128 weight = _mm_set1_ps(fractions[k]);
+                _mm_storeu_ps(colors[i + k].elem, _mm_add_ps(lower, _mm_mul_ps(weight, _mm_sub_ps(upper, lower))));
+            }
+        }
+    }
+#endif
+
+    for (; i < count; ++i)
+        colors[i] = lookup(intensities[i]);
+}
+
+void TransFuncLookupTable::lookup(const float* intensities, const float* gradientMagnitudes,
+                                  tgt::vec4* colors, size_t count) const
+{
+    for (size_t i = 0; i < count; ++i)
+        colors[i] = lookup(intensities[i], gradientMagnitudes[i]);
+}
+
+} // namespace voreen
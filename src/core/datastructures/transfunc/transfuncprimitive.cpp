@@ -189,6 +189,46 @@ void TransFuncQuad::paint() {
     glTranslatef(0.f, 0.f, 0.5f);
 }
 
+void TransFuncQuad::getTriangles(std::vector<tgt::vec2>& vertices, std::vector<tgt::vec4>& colors) const {
+    tgt::vec2 coords[4];
+    for (int i = 0; i < 4; ++i)
+        coords[i] = tgt::vec2(coords_[i].x, scaleFactor_ * coords_[i].y);
+
+    tgt::vec2 center = coords[0] + coords[1] + coords[2] + coords[3];
+    center /= 4.f;
+
+    tgt::vec4 color = tgt::vec4(color_) / 255.f;
+    tgt::vec4 transparent = tgt::vec4(color.xyz(), 0.f);
+
+    // the quads of paint(), each split into two triangles
+    tgt::vec2 quad[4];
+    tgt::vec4 quadColors[4];
+    for (int i = 1; i <= 5; ++i) {
+        if (i <= 4) {
+            // fuzzy border
+            quad[0] = coords[i-1];
+            quad[1] = coords[i%4];
+            quad[2] = fuzziness_ * coords[i%4] + (1.f - fuzziness_) * center;
+            quad[3] = fuzziness_ * coords[i-1] + (1.f - fuzziness_) * center;
+            quadColors[0] = quadColors[1] = transparent;
+            quadColors[2] = quadColors[3] = color;
+        }
+        else {
+            // opaque inner quad
+            for (int j = 0; j < 4; ++j) {
+                quad[j] = fuzziness_ * coords[j] + (1.f - fuzziness_) * center;
+                quadColors[j] = color;
+            }
+        }
+
+        const int indices[6] = { 0, 1, 2, 0, 2, 3 };
+        for (int j = 0; j < 6; ++j) {
+            vertices.push_back(quad[indices[j]]);
+            colors.push_back(quadColors[indices[j]]);
+        }
+    }
+}
+
 void TransFuncQuad::paintForSelection(GLubyte id) {
     glBegin(GL_QUADS);
         glColor3ub(id, 123, 123);
@@ -328,6 +368,49 @@ void TransFuncBanana::paint() {
     glTranslatef(0.f, 0.f, 0.5f);
 }
 
+void TransFuncBanana::getTriangles(std::vector<tgt::vec2>& vertices, std::vector<tgt::vec4>& colors) const {
+    tgt::vec2 coords[4];
+    for (int i = 0; i < 4; ++i)
+        coords[i] = tgt::vec2(coords_[i].x, scaleFactor_ * coords_[i].y);
+
+    tgt::vec2 t1 = (2.f * coords[1]) - (0.5f * coords[0]) - (0.5f * coords[3]);
+    tgt::vec2 t2 = (2.f * coords[2]) - (0.5f * coords[0]) - (0.5f * coords[3]);
+    tgt::vec2 tc = (t1 + t2) / 2.f;
+    tgt::vec2 t3 = fuzziness_ * t1 + (1.f - fuzziness_) * tc;
+    tgt::vec2 t4 = fuzziness_ * t2 + (1.f - fuzziness_) * tc;
+
+    tgt::vec4 color = tgt::vec4(color_) / 255.f;
+    tgt::vec4 transparent = tgt::vec4(color.xyz(), 0.f);
+
+    // vertices of the triangle strip painted by paintInner(): fuzzy outer band,
+    // opaque center, fuzzy inner band
+    const tgt::vec2 controls[3][2] = { { t1, t3 }, { t3, t4 }, { t4, t2 } };
+    const tgt::vec4 bandColors[3][2] = { { transparent, color }, { color, color }, { color, transparent } };
+    std::vector<tgt::vec2> strip;
+    std::vector<tgt::vec4> stripColors;
+    for (int band = 0; band < 3; ++band) {
+        strip.push_back(coords[0]);
+        stripColors.push_back(color);
+        for (int i = 0; i < steps_; ++i) {
+            float t = i / static_cast<float>(steps_ - 1);
+            for (int j = 0; j < 2; ++j) {
+                strip.push_back(((1 - t) * (1 - t)) * coords[0] + (2 * (1 - t) * t) * controls[band][j] + (t * t) * coords[3]);
+                stripColors.push_back(bandColors[band][j]);
+            }
+        }
+        // the last vertex keeps the current color
+        strip.push_back(coords[3]);
+        stripColors.push_back(stripColors.back());
+    }
+
+    for (size_t i = 0; i + 2 < strip.size(); ++i) {
+        for (size_t j = i; j < i + 3; ++j) {
+            vertices.push_back(strip[j]);
+            colors.push_back(stripColors[j]);
+        }
+    }
+}
+
 void TransFuncBanana::paintForSelection(GLubyte id) {
     glColor3ub(id, 123, 123);
     float t;
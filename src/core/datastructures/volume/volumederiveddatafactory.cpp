@@ -29,6 +29,8 @@
 #include "voreen/core/datastructures/volume/volumederiveddatafactory.h"
 
 #include "voreen/core/datastructures/volume/volumehash.h"
+#include "voreen/core/datastructures/volume/volumestatistics.h"
+#include "voreen/core/datastructures/volume/histogram.h"
 
 
 namespace voreen {
@@ -36,6 +38,10 @@ namespace voreen {
 const std::string VolumeDerivedDataFactory::getTypeString(const std::type_info& type) const {
     if (type == typeid(VolumeHash))
         return "VolumeHash";
+    else if (type == typeid(VolumeStatistics))
+        return "VolumeStatistics";
+    else if (type == typeid(HistogramIntensity))
+        return "HistogramIntensity";
     else 
         return "";
 }
@@ -43,6 +49,10 @@ const std::string VolumeDerivedDataFactory::getTypeString(const std::type_info&
 Serializable* VolumeDerivedDataFactory::createType(const std::string& typeString) {
     if (typeString == "VolumeHash")
         return new VolumeHash();
+    else if (typeString == "VolumeStatistics")
+        return new VolumeStatistics();
+    else if (typeString == "HistogramIntensity")
+        return new HistogramIntensity();
     else
         return 0;
 }
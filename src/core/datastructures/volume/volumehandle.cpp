@@ -434,6 +434,18 @@ MeshGeometry VolumeHandleBase::getBoundingBox(bool applyTransformation) const {
     return boundingBox;
 }
 
+void VolumeHandleBase::addDerivedData(VolumeDerivedData* data) {
+    tgtAssert(data, "null pointer passed");
+    for (std::set<VolumeDerivedData*>::iterator it=derivedData_.begin(); it!=derivedData_.end(); ++it) {
+        if (typeid(**it) == typeid(*data)) {
+            delete *it;
+            derivedData_.erase(it);
+            break;
+        }
+    }
+    derivedData_.insert(data);
+}
+
 void VolumeHandleBase::clearDerivedData() {
     for (std::set<VolumeDerivedData*>::iterator it=derivedData_.begin(); it!=derivedData_.end(); ++it) {
         delete *it;
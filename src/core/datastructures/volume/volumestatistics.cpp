@@ -0,0 +1,154 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#include "voreen/core/datastructures/volume/volumestatistics.h"
+#include "voreen/core/datastructures/volume/volumehandle.h"
+
+#include "voreen/core/io/serialization/xmlserializer.h"
+#include "voreen/core/io/serialization/xmldeserializer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace voreen {
+
+VolumeStatistics::VolumeStatistics() :
+    VolumeDerivedData()
+{}
+
+VolumeDerivedData* VolumeStatistics::createFrom(const VolumeHandleBase* handle) const {
+    tgtAssert(handle, "no volume handle");
+
+    const Volume* v = handle->getRepresentation<Volume>();
+    tgtAssert(v, "no volume");
+
+    const size_t numChannels = static_cast<size_t>(v->getNumChannels());
+    const size_t numVoxels = v->getNumVoxels();
+
+    // all channels are accumulated in a single pass over the voxels
+    std::vector<float> minValues(numChannels, std::numeric_limits<float>::max());
+    std::vector<float> maxValues(numChannels, -std::numeric_limits<float>::max());
+    std::vector<double> sums(numChannels, 0.0);
+    std::vector<double> sumsSquares(numChannels, 0.0);
+
+    const int numBlocks = static_cast<int>((numVoxels + 65535) / 65536);
+    #ifdef _OPENMP
+    #pragma omp parallel
+    #endif
+    {
+        std::vector<float> threadMin(minValues);
+        std::vector<float> threadMax(maxValues);
+        std::vector<double> threadSum(numChannels, 0.0);
+        std::vector<double> threadSumSquares(numChannels, 0.0);
+
+        #ifdef _OPENMP
+        #pragma omp for
+        #endif
+        for (int block = 0; block < numBlocks; ++block) {
+            const size_t end = std::min(static_cast<size_t>(block + 1) * 65536, numVoxels);
+            for (size_t i = static_cast<size_t>(block) * 65536; i < end; ++i) {
+                for (size_t c = 0; c < numChannels; ++c) {
+                    float value = v->getVoxelFloat(i, c);
+                    threadMin[c] = std::min(threadMin[c], value);
+                    threadMax[c] = std::max(threadMax[c], value);
+                    threadSum[c] += value;
+                    threadSumSquares[c] += static_cast<double>(value) * value;
+                }
+            }
+        }
+
+        #ifdef _OPENMP
+        #pragma omp critical
+        #endif
+        {
+            for (size_t c = 0; c < numChannels; ++c) {
+                minValues[c] = std::min(minValues[c], threadMin[c]);
+                maxValues[c] = std::max(maxValues[c], threadMax[c]);
+                sums[c] += threadSum[c];
+                sumsSquares[c] += threadSumSquares[c];
+            }
+        }
+    }
+
+    VolumeStatistics* result = new VolumeStatistics();
+    for (size_t c = 0; c < numChannels; ++c) {
+        double mean = (numVoxels > 0) ? sums[c] / numVoxels : 0.0;
+        double variance = (numVoxels > 0) ? std::max(sumsSquares[c] / numVoxels - mean * mean, 0.0) : 0.0;
+        result->min_.push_back(numVoxels > 0 ? minValues[c] : 0.f);
+        result->max_.push_back(numVoxels > 0 ? maxValues[c] : 0.f);
+        result->mean_.push_back(static_cast<float>(mean));
+        result->standardDeviation_.push_back(static_cast<float>(std::sqrt(variance)));
+    }
+
+    return result;
+}
+
+void VolumeStatistics::serialize(XmlSerializer& s) const  {
+    s.serialize("min", min_);
+    s.serialize("max", max_);
+    s.serialize("mean", mean_);
+    s.serialize("standardDeviation", standardDeviation_);
+}
+
+void VolumeStatistics::deserialize(XmlDeserializer& s) {
+    s.deserialize("min", min_);
+    s.deserialize("max", max_);
+    s.deserialize("mean", mean_);
+    s.deserialize("standardDeviation", standardDeviation_);
+}
+
+size_t VolumeStatistics::getNumChannels() const {
+    return min_.size();
+}
+
+float VolumeStatistics::getMin(size_t channel) const {
+    tgtAssert(channel < min_.size(), "invalid channel");
+    return min_[channel];
+}
+
+float VolumeStatistics::getMax(size_t channel) const {
+    tgtAssert(channel < max_.size(), "invalid channel");
+    return max_[channel];
+}
+
+float VolumeStatistics::getMean(size_t channel) const {
+    tgtAssert(channel < mean_.size(), "invalid channel");
+    return mean_[channel];
+}
+
+float VolumeStatistics::getStandardDeviation(size_t channel) const {
+    tgtAssert(channel < standardDeviation_.size(), "invalid channel");
+    return standardDeviation_[channel];
+}
+
+} // namespace voreen
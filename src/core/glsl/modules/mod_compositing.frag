@@ -52,7 +52,10 @@ vec4 compositeDVR(in vec4 curResult, in vec4 color, in float t, inout float tDep
     vec4 result = curResult;
 
     // apply opacity correction to accomodate for variable sampling intervals
+    // (pre-integrated colors already refer to the sampling interval)
+#ifndef RC_PREINTEGRATION
     color.a = 1.0 - pow(1.0 - color.a, samplingStepSize_ * SAMPLING_BASE_INTERVAL_RCP);
+#endif
 
     result.rgb = result.rgb + (1.0 - result.a) * color.a * color.rgb;
     result.a = result.a + (1.0 -result.a) * color.a;
@@ -104,7 +107,10 @@ vec4 compositeMIDAhelper(in vec4 curResult, in vec4 voxel, in vec4 color, inout
  */
 vec4 compositeMIDA(in vec4 curResult, in vec4 voxel, in vec4 color, inout float f_max_i, in float t, inout float tDepth, in float gamma) {
     // apply opacity correction to accomodate for variable sampling intervals
+    // (pre-integrated colors already refer to the sampling interval)
+#ifndef RC_PREINTEGRATION
     color.a = 1.0 - pow(1.0 - color.a, samplingStepSize_ * SAMPLING_BASE_INTERVAL_RCP);
+#endif
 
     vec4 result = curResult;
 
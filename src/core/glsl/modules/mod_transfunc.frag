@@ -92,6 +92,37 @@ vec4 applyTF(TransFunc2D transfunc, vec4 intensityGradient) {
     #endif
 }
 
+#ifdef RC_PREINTEGRATION
+
+// pre-integrated table of the 1D transfer function, indexed by front and back intensity
+uniform sampler2D preIntegrationTable_;
+
+// normalized intensity of the previous ray sample, negative before the first sample
+float previousIntensity_ = -1.0;
+
+/**
+ * Returns the pre-integrated color and opacity of the ray segment between the previous
+ * and the current sample. The opacity already accounts for the sampling step size,
+ * hence the compositing functions skip the opacity correction.
+ */
+vec4 applyPreIntegratedTF(TransFunc1D transfunc, vec4 intensity) {
+    float back = realWorldToTexture(transfunc, intensity.a);
+    float front = (previousIntensity_ < 0.0) ? back : previousIntensity_;
+    previousIntensity_ = back;
+    #if defined(GLSL_VERSION_130)
+        return texture(preIntegrationTable_, vec2(front, back));
+    #else
+        return texture2D(preIntegrationTable_, vec2(front, back));
+    #endif
+}
+
+// 2D transfer functions are not pre-integrated
+vec4 applyPreIntegratedTF(TransFunc2D transfunc, vec4 intensityGradient) {
+    return applyTF(transfunc, intensityGradient);
+}
+
+#endif
+
 #endif
 
 // Deprecated:
@@ -252,8 +252,6 @@ VolumeCollection* DatVolumeReader::readMetaFile(const std::string &fileName, siz
     h.spacing_ = sliceThickness;
 
     if (!error) {
-        RawVolumeReader rawReader(getProgressBar());
-
         // do we have a relative path?
         if ((objectFilename.substr(0, 1) != "/")  && (objectFilename.substr(0, 1) != "\\") &&
             (objectFilename.substr(1, 2) != ":/") && (objectFilename.substr(1, 2) != ":\\"))
@@ -273,12 +271,21 @@ VolumeCollection* DatVolumeReader::readMetaFile(const std::string &fileName, siz
             end = timeframe+1;
         }
 
+        RawVolumeReader* rawReader = createRawVolumeReader();
+
         VolumeCollection* toReturn = new VolumeCollection();
         for (int frame = start; frame < end; ++frame) {
             h.timeframe_ = frame;
-            rawReader.setReadHints(h);
+            rawReader->setReadHints(h);
 
-            VolumeCollection* volumeCollection = rawReader.readSlices(objectFilename, firstSlice, lastSlice);
+            VolumeCollection* volumeCollection = 0;
+            try {
+                volumeCollection = rawReader->readSlices(objectFilename, firstSlice, lastSlice);
+            }
+            catch (...) {
+                delete rawReader;
+                throw;
+            }
             if (!volumeCollection->empty()) {
                 VolumeOrigin origin(fileName);
                 origin.addSearchParameter("timeframe", itos(frame));
@@ -296,6 +303,7 @@ VolumeCollection* DatVolumeReader::readMetaFile(const std::string &fileName, siz
             }
             delete volumeCollection;
         }
+        delete rawReader;
         return toReturn;
     }
     else {
@@ -303,6 +311,10 @@ VolumeCollection* DatVolumeReader::readMetaFile(const std::string &fileName, siz
     }
 }
 
+RawVolumeReader* DatVolumeReader::createRawVolumeReader() {
+    return new RawVolumeReader(getProgressBar());
+}
+
 VolumeCollection* DatVolumeReader::readSlices(const std::string &url, size_t firstSlice, size_t lastSlice, int timeframe)
     throw (tgt::FileException, std::bad_alloc)
 {
@@ -310,6 +322,12 @@ VolumeCollection* DatVolumeReader::readSlices(const std::string &url, size_t fir
     return readMetaFile(origin.getPath(), firstSlice, lastSlice, timeframe);
 }
 
+VolumeCollection* DatVolumeReader::readSlices(const std::string &url, size_t firstSlice, size_t lastSlice)
+    throw (tgt::FileException, std::bad_alloc)
+{
+    return readSlices(url, firstSlice, lastSlice, -1);
+}
+
 VolumeCollection* DatVolumeReader::readBrick(const std::string& url, tgt::ivec3 brickStartPos, int brickSize)
     throw (tgt::FileException, std::bad_alloc)
 {
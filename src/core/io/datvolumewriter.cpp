@@ -27,6 +27,7 @@
  **********************************************************************/
 
 #include "voreen/core/io/datvolumewriter.h"
+#include "voreen/core/io/volumeslabwriter.h"
 #include "voreen/core/datastructures/volume/volumeatomic.h"
 #include "voreen/core/datastructures/volume/volumehandle.h"
 
@@ -56,31 +57,61 @@ void DatVolumeWriter::write(const std::string& filename, const VolumeHandleBase*
     std::string rawname = getFileNameWithoutExtension(filename) + ".raw";
     LINFO("saving " << datname << " and " << rawname);
 
-    std::fstream datout(datname.c_str(), std::ios::out);
-    std::fstream rawout(rawname.c_str(), std::ios::out | std::ios::binary);
+    Volume* outputVolume = createOutputVolume(volume);
+    try {
+        // the raw file is replaced first, so that a header never refers to incomplete data
+        VolumeSlabWriter rawout(rawname, getProgressBar());
+        rawout.writeVolume(volume, outputVolume);
+        rawout.commit();
 
-    if (!datout.is_open() || !rawout.is_open() || datout.bad() || rawout.bad())
-        throw tgt::IOException();
+        VolumeSlabWriter datout(datname);
+        datout.write(getDatFileString(volumeHandle, rawname, outputVolume));
+        datout.commit();
+    }
+    catch (...) {
+        delete outputVolume;
+        throw;
+    }
+    delete outputVolume;
+}
 
-    datout << getDatFileString(volumeHandle, rawname);
-    if (datout.bad())
-        throw tgt::IOException();
-    datout.close();
+void DatVolumeWriter::writeSlabs(const std::string& filename, VolumeSlabWriter::SlabSource* source)
+    throw (tgt::IOException)
+{
+    tgtAssert(source, "No source");
 
-    // write raw file
-    const char* data = static_cast<const char*>(volume->getData());
-    size_t numbytes = volume->getNumBytes();
-    rawout.write(data, numbytes);
-    if (rawout.bad())
-        throw tgt::IOException();
-    rawout.close();
+    std::string datname = filename;
+    std::string rawname = getFileNameWithoutExtension(filename) + ".raw";
+    LINFO("saving " << datname << " and " << rawname);
+
+    VolumeSlabWriter rawout(rawname);
+    rawout.writeSlabs(source);
+    rawout.commit();
+
+    // the header handle holds no data, hence no checksum is written
+    VolumeHandle* header = source->createHeader();
+    try {
+        VolumeSlabWriter datout(datname);
+        datout.write(getDatFileString(header, rawname, header->getRepresentation<Volume>()));
+        datout.commit();
+    }
+    catch (...) {
+        delete header;
+        throw;
+    }
+    delete header;
 }
 
-std::string DatVolumeWriter::getDatFileString(const VolumeHandleBase* const volumeHandle, const std::string& rawFileName)
+bool DatVolumeWriter::streamsSlabs() const {
+    return true;
+}
+
+std::string DatVolumeWriter::getDatFileString(const VolumeHandleBase* const volumeHandle, const std::string& rawFileName,
+                                              const Volume* outputVolume)
 {
     std::ostringstream datout;
     tgtAssert(volumeHandle, "No volume handle");
-    const Volume* volume = volumeHandle->getRepresentation<Volume>();
+    const Volume* volume = outputVolume ? outputVolume : volumeHandle->getRepresentation<Volume>();
     if (!volume) {
         LWARNING("No volume or no storage for casted volume data!");
         return "";
@@ -281,7 +312,9 @@ std::string DatVolumeWriter::getDatFileString(const VolumeHandleBase* const volu
     datout << "Format:\t\t" << format << std::endl;
     datout << "ObjectModel:\t" << model << std::endl;
     datout << "Modality:\t" << volumeHandle->getModality() << std::endl;
-    datout << "Checksum:\t" << volumeHandle->getHash() << std::endl;
+    // the hash of the handle does not match converted data
+    if (!outputVolume)
+        datout << "Checksum:\t" << volumeHandle->getHash() << std::endl;
 
     // write transformation matrix unless it is the identity matrix
     tgt::mat4 transformation = volumeHandle->getPhysicalToWorldMatrix();
@@ -33,11 +33,21 @@
 #include <iostream>
 #include <sstream>
 #include <limits>
+#include <map>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include "tgt/exception.h"
 #include "tgt/filesystem.h"
+#include "tgt/texturemanager.h"
 
+#include "voreen/core/voreenapplication.h"
+#include "voreen/core/voreenmodule.h"
 #include "voreen/core/io/progressbar.h"
+#include "voreen/core/utils/stringconversion.h"
+#include "voreen/core/datastructures/volume/volumefactory.h"
 #include "voreen/core/datastructures/volume/volumeatomic.h"
 #include "voreen/core/datastructures/volume/volumefusion.h"
 #include "voreen/core/datastructures/volume/operators/volumeoperatorresize.h"
@@ -49,6 +59,7 @@ using tgt::vec3;
 namespace voreen {
 
 const std::string RawVolumeReader::loggerCat_ = "voreen.RawVolumeReader";
+const int RawVolumeReader::MAX_READ_THREADS = 8;
 
 RawVolumeReader::ReadHints::ReadHints(tgt::ivec3 dimensions, tgt::vec3 spacing, int bitsStored,
                                       const std::string& objectModel, const std::string& format,
@@ -119,7 +130,8 @@ VolumeCollection* RawVolumeReader::readSlices(const std::string &url, size_t fir
     VolumeOrigin origin(url);
     std::string fileName = origin.getPath();
 
-    ReadHints& h = hints_;
+    // the hints keep describing the whole volume, the copy the slices read
+    ReadHints h = hints_;
 
     // check dimensions
     if (tgt::hor(tgt::lessThan(h.dimensions_, ivec3(0))) || tgt::hor(tgt::greaterThan(h.dimensions_, ivec3(10000)))) {
@@ -128,10 +140,12 @@ VolumeCollection* RawVolumeReader::readSlices(const std::string &url, size_t fir
     }
 
     // check if we have to read only some slices instead of the whole volume.
+    // The range is clamped to the volume, so that it may be read slab by slab without knowing its depth.
     if ( ! (firstSlice==0 && lastSlice==0)) {
-        if (lastSlice > firstSlice) {
-            h.dimensions_.z = static_cast<int>(lastSlice - firstSlice);
-        }
+        lastSlice = std::min(lastSlice, static_cast<size_t>(std::max(h.dimensions_.z, 0)));
+        if (firstSlice >= lastSlice)
+            throw tgt::CorruptedFileException("Invalid slice range", fileName);
+        h.dimensions_.z = static_cast<int>(lastSlice - firstSlice);
     }
 
     std::string info = "Loading raw file " + fileName + " ";
@@ -139,12 +153,6 @@ VolumeCollection* RawVolumeReader::readSlices(const std::string &url, size_t fir
     if (h.dimensions_ == tgt::ivec3::zero)
         throw tgt::CorruptedFileException("No readHints set.", fileName);
 
-    FILE* fin;
-    fin = fopen(fileName.c_str(),"rb");
-
-    if (fin == 0)
-        throw tgt::IOException("Unable to open raw file for reading", fileName);
-
     Volume* volume;
 
     if (h.objectModel_ == "I") {
@@ -204,7 +212,6 @@ VolumeCollection* RawVolumeReader::readSlices(const std::string &url, size_t fir
             volume = v;
         }
         else {
-            fclose(fin);
             throw tgt::CorruptedFileException("Format '" + h.format_ + "' not supported", fileName);
         }
     }
@@ -266,7 +273,6 @@ VolumeCollection* RawVolumeReader::readSlices(const std::string &url, size_t fir
             volume = v;
         }
         else {
-            fclose(fin);
             throw tgt::CorruptedFileException("Format '" + h.format_ + "' not supported", fileName);
         }
     }
@@ -327,7 +333,6 @@ VolumeCollection* RawVolumeReader::readSlices(const std::string &url, size_t fir
             volume = v;
         }
         else {
-            fclose(fin);
             throw tgt::CorruptedFileException("Format '" + h.format_ + "' not supported", fileName);
         }
     }
@@ -388,7 +393,6 @@ VolumeCollection* RawVolumeReader::readSlices(const std::string &url, size_t fir
             volume = v;
         }
         else {
-            fclose(fin);
             throw tgt::CorruptedFileException("Format '" + h.format_ + "' not supported", fileName);
         }
     }
@@ -407,14 +411,13 @@ VolumeCollection* RawVolumeReader::readSlices(const std::string &url, size_t fir
         }
     }
     else {
-        fclose(fin);
         throw tgt::CorruptedFileException("unsupported ObjectModel '" + h.objectModel_ + "'", fileName);
     }
 
     // Calculate additional skipping if we have to read only slices or not the first time frame
     uint64_t dimx = static_cast<uint64_t>(h.dimensions_.x);
     uint64_t dimy = static_cast<uint64_t>(h.dimensions_.y);
-    uint64_t dimz = static_cast<uint64_t>(h.dimensions_.z);
+    uint64_t dimz = static_cast<uint64_t>(hints_.dimensions_.z);
     uint64_t numBytes = static_cast<uint64_t>(volume->getBitsAllocated() / 8);
     uint64_t sliceSkip = dimx * dimy * static_cast<uint64_t>(firstSlice) * numBytes;
     uint64_t frameSkip = dimx * dimy * dimz * static_cast<uint64_t>(h.timeframe_) * numBytes;
@@ -422,12 +425,6 @@ VolumeCollection* RawVolumeReader::readSlices(const std::string &url, size_t fir
     // now add that to the headerskip we might have received
     uint64_t offset = h.headerskip_ + sliceSkip + frameSkip;
 
-    #ifdef _MSC_VER
-        _fseeki64(fin, offset, SEEK_SET);
-    #else
-        fseek(fin, offset, SEEK_SET);
-    #endif
-
     volume->clear();
 
     if (getProgressBar()) {
@@ -435,21 +432,16 @@ VolumeCollection* RawVolumeReader::readSlices(const std::string &url, size_t fir
         // getProgress()->setMessage("Loading volume: " + tgt::FileSystem::fileName(fileName));
         getProgressBar()->setMessage("Loading volume: " + fileName);
     }
-    VolumeReader::read(volume, fin);
 
-    if (lastSlice == 0) {
-        if (feof(fin) ) {
-            fclose(fin);
-            delete volume;
-            if (getProgressBar())
-                getProgressBar()->hide();
-            // throw exception
-            throw tgt::CorruptedFileException("unexpected EOF: raw file truncated or ObjectModel '" +
-                                              h.objectModel_ + "' invalid", fileName);
-        }
+    try {
+        readVolumeData(volume, fileName, offset, lastSlice == 0);
+    }
+    catch (...) {
+        delete volume;
+        if (getProgressBar())
+            getProgressBar()->hide();
+        throw;
     }
-
-    fclose(fin);
 
     // correct tensor layout
     if (h.objectModel_.find("TENSOR_") == 0 && h.format_ == "FLOAT") {
@@ -731,14 +723,29 @@ VolumeHandle* RawVolumeReader::readSliceStack(const std::vector<std::string>& sl
         hints_.dimensions_.z = 1;
     }
 
-    std::vector<Volume*> volumes;
-    for (size_t i=0; i<sliceFiles.size(); i++) {
+    if (sliceFiles.empty()) {
+        LWARNING("No slices");
+        return 0;
+    }
+    const int numSlices = static_cast<int>(sliceFiles.size());
+
+    // determine how each slice is decoded: by a module's volume reader, a texture reader or as raw data
+    std::vector<const VolumeReader*> sliceReaders(numSlices, static_cast<const VolumeReader*>(0));
+    std::vector<char> textureSlices(numSlices, 0);
+    for (int i=0; i<numSlices; i++) {
+        sliceReaders[i] = findSliceReader(sliceFiles[i]);
+        textureSlices[i] = !sliceReaders[i] && isTextureSlice(sliceFiles[i]);
+    }
+
+    // the first readable slice determines format and dimensions of the stack
+    std::vector<char> sliceDone(numSlices, 0);
+    Volume* result = 0;
+    bool rawStack = false;
+    for (int i=0; i<numSlices && !result; i++) {
+        Volume* slice = 0;
+        VolumeReader* reader = createSliceReader(sliceReaders[i], textureSlices[i] != 0);
         try {
-            VolumeCollection* collection = read(sliceFiles[i]);
-            if (!collection->empty() && collection->first()->getRepresentation<Volume>()) {
-                volumes.push_back(static_cast<VolumeHandle*>(collection->first())->getWritableRepresentation<Volume>());
-            }
-            delete collection;
+            slice = readSlice(sliceFiles[i], reader);
         }
         catch (tgt::FileException& e) {
             LWARNING("Reading slice '" << sliceFiles[i] << "' failed: " << e.what());
@@ -746,79 +753,316 @@ VolumeHandle* RawVolumeReader::readSliceStack(const std::vector<std::string>& sl
         catch (std::bad_alloc) {
             LWARNING("Reading slice '" << sliceFiles[i] << "' failed: bad allocation");
         }
-    }
+        delete reader;
+        sliceDone[i] = 1;
+        if (!slice)
+            continue;
+
+        tgt::svec3 dims(slice->getDimensions().x, slice->getDimensions().y, sliceFiles.size());
+        LINFO("Constructing volume from " << numSlices << " slices of dimensions " << dims.xy());
+        try {
+            result = slice->createNew(dims, VolumeRepresentation::VolumeBorders(), true);
+            result->clear();
 
-    if (volumes.empty()) {
+            // raw slices are read again along with the others, directly into the stack
+            rawStack = !sliceReaders[i] && !textureSlices[i] && hints_.objectModel_.find("TENSOR_") != 0;
+            if (rawStack)
+                sliceDone[i] = 0;
+            else
+                memcpy(static_cast<char*>(result->getData()) + i*slice->getNumBytes(), slice->getData(), slice->getNumBytes());
+        }
+        catch (std::bad_alloc) {
+            LERROR("Reading slice stack failed: bad allocation");
+            delete slice;
+            return 0;
+        }
+        delete slice;
+    }
+    if (!result) {
         LWARNING("No slices");
         return 0;
     }
 
-    LINFO("Constructing volume from " << volumes.size() << " slices of dimensions " << hints_.dimensions_.xy());
+    if (getProgressBar()) {
+        getProgressBar()->setTitle("Loading Volume");
+        getProgressBar()->setMessage("Loading slice stack: " + tgt::FileSystem::dirName(sliceFiles.front()));
+        getProgressBar()->setProgress(0.f);
+    }
 
-    Volume* result = 0;
-    try {
-        Volume* v = volumes.front();
-        VolumeHandle vh(v, hints_.spacing_, vec3(0.0f));
-        VolumeHandle* t = VolumeOperatorResize::APPLY_OP(&vh,
-            ivec3(hints_.dimensions_.x, hints_.dimensions_.y, static_cast<int>(volumes.size())));
-        result = t->getWritableRepresentation<Volume>();
-        t->releaseAllRepresentations();
-        delete t;
-        vh.releaseVolumes();
-        result->clear();
-        //result->setTransformation(tgt::mat4::identity);
-    }
-    catch (std::bad_alloc) {
-        LERROR("Reading slice stack failed: bad allocation");
-    }
-
-    // copy slices to output volume
-    if (result) {
-        size_t sliceDataSize = volumes.front()->getNumBytes();
-        tgtAssert(result->getNumBytes() == sliceDataSize*volumes.size(), "Invalid slice sizes");
-
-        for (size_t i=0; i<volumes.size(); i++) {
-
-            if (volumes[i]->getNumBytes() != sliceDataSize) {
-                LERROR("Slice '" << sliceFiles[i] << "' differs in size.");
+    const size_t sliceDataSize = result->getNumBytes() / sliceFiles.size();
+    char* data = static_cast<char*>(result->getData());
+    std::vector<std::string> errors(numSlices);
+
+    // read the remaining slices in parallel, each directly into its place in the stack
+#ifdef _OPENMP
+    int numThreads = std::max(1, std::min(std::min(omp_get_max_threads(), MAX_READ_THREADS), numSlices));
+    #pragma omp parallel num_threads(numThreads)
+#endif
+    {
+        // readers are not reentrant, each thread creates its own
+        std::map<const VolumeReader*, VolumeReader*> threadReaders;
+
+        #ifdef _OPENMP
+        #pragma omp for schedule(dynamic)
+        #endif
+        for (int i=0; i<numSlices; i++) {
+            if (sliceDone[i])
                 continue;
+
+            char* dest = data + i*sliceDataSize;
+            try {
+                if (rawStack && !sliceReaders[i] && !textureSlices[i]) {
+                    if (hints_.dimensions_.xy() != tgt::ivec2(result->getDimensions().xy()))
+                        throw tgt::CorruptedFileException("slice differs in size", sliceFiles[i]);
+                    readRawSlice(sliceFiles[i], dest, result);
+                }
+                else {
+                    // raw slices are keyed by the null reader, texture slices need none
+                    VolumeReader* reader = 0;
+                    if (!textureSlices[i]) {
+                        if (threadReaders.find(sliceReaders[i]) == threadReaders.end())
+                            threadReaders[sliceReaders[i]] = createSliceReader(sliceReaders[i], false);
+                        reader = threadReaders[sliceReaders[i]];
+                    }
+
+                    Volume* slice = readSlice(sliceFiles[i], reader);
+                    if (!slice || slice->getDimensions() != tgt::svec3(result->getDimensions().xy(), 1)
+                        || slice->getNumBytes() != sliceDataSize || slice->getNumChannels() != result->getNumChannels())
+                    {
+                        delete slice;
+                        throw tgt::CorruptedFileException("slice differs in size or format", sliceFiles[i]);
+                    }
+                    memcpy(dest, slice->getData(), sliceDataSize);
+                    delete slice;
+                }
+            }
+            catch (std::exception& e) {
+                errors[i] = e.what();
             }
 
-            memcpy(((char*)result->getData())+i*sliceDataSize, (char*)volumes[i]->getData(), sliceDataSize);
+#ifdef _OPENMP
+            // progress bars may only be updated from the calling thread
+            if (omp_get_thread_num() == 0)
+#endif
+            if (getProgressBar())
+                getProgressBar()->setProgress(static_cast<float>(i) / static_cast<float>(numSlices));
         }
+
+        for (std::map<const VolumeReader*, VolumeReader*>::iterator it = threadReaders.begin(); it != threadReaders.end(); ++it)
+            delete it->second;
     }
 
+    for (int i=0; i<numSlices; i++) {
+        if (!errors[i].empty())
+            LERROR("Reading slice '" << sliceFiles[i] << "' failed: " << errors[i]);
+    }
+
+    if (getProgressBar())
+        getProgressBar()->hide();
+
+    vec3 spacing = hints_.spacing_;
+    if (tgt::hor(tgt::lessThanEqual(spacing, vec3(0.f))))
+        spacing = vec3(1.f);
+    VolumeHandle* outputHandle = new VolumeHandle(result, spacing, vec3(0.0f));
+    outputHandle->setTimestep(hints_.timeStep_);
+
+    // encode raw parameters into search string (currently only first slice)
+    std::ostringstream searchStream;
+    searchStream << "objectModel=" << hints_.objectModel_ << "&";
+    searchStream << "format=" << hints_.format_ << "&";
+    searchStream << "headerskip=" << hints_.headerskip_ << "&";
+    if (hints_.bigEndianByteOrder_)
+        searchStream << "bigEndian=" << hints_.bigEndianByteOrder_ << "&";
+    searchStream << "dim_x=" << hints_.dimensions_.x << "&";
+    searchStream << "dim_y=" << hints_.dimensions_.y << "&";
+    searchStream << "dim_z=" << hints_.dimensions_.z << "&";
+    searchStream << "spacing_x=" << hints_.spacing_.x << "&";
+    searchStream << "spacing_y=" << hints_.spacing_.y << "&";
+    searchStream << "spacing_z=" << hints_.spacing_.z << "&";
+
+    outputHandle->setOrigin(VolumeOrigin("raw", sliceFiles.front(), searchStream.str()));
+
+    return outputHandle;
+}
+
+const VolumeReader* RawVolumeReader::findSliceReader(const std::string& fileName) const {
+    if (!VoreenApplication::app())
+        return 0;
 
-    // free slices
-    for (size_t i=0; i<volumes.size(); i++) {
-        delete volumes[i];
+    std::string extension = tgt::FileSystem::fileExtension(fileName, true);
+    const std::vector<VoreenModule*>& modules = VoreenApplication::app()->getModules();
+    for (size_t i=0; i<modules.size(); i++) {
+        const std::vector<VolumeReader*>& readers = modules[i]->getVolumeReaders();
+        for (size_t j=0; j<readers.size(); j++) {
+            const std::vector<std::string>& extensions = readers[j]->getSupportedExtensions();
+            if (std::find(extensions.begin(), extensions.end(), extension) != extensions.end())
+                return readers[j];
+        }
     }
+    return 0;
+}
 
-    if (result) {
-        VolumeHandle* outputHandle = new VolumeHandle(result, hints_.spacing_, vec3(0.0f));
-        outputHandle->setTimestep(hints_.timeStep_);
+bool RawVolumeReader::isTextureSlice(const std::string& fileName) const {
+    // DevIL claims raw files as well
+    return tgt::FileSystem::fileExtension(fileName, true) != "raw" && tgt::TextureManager::isInited()
+        && TexMgr.isSupported(fileName);
+}
 
-        // encode raw parameters into search string (currently only first slice)
-        std::ostringstream searchStream;
-        searchStream << "objectModel=" << hints_.objectModel_ << "&";
-        searchStream << "format=" << hints_.format_ << "&";
-        searchStream << "headerskip=" << hints_.headerskip_ << "&";
-        if (hints_.bigEndianByteOrder_)
-            searchStream << "bigEndian=" << hints_.bigEndianByteOrder_ << "&";
-        searchStream << "dim_x=" << hints_.dimensions_.x << "&";
-        searchStream << "dim_y=" << hints_.dimensions_.y << "&";
-        searchStream << "dim_z=" << hints_.dimensions_.z << "&";
-        searchStream << "spacing_x=" << hints_.spacing_.x << "&";
-        searchStream << "spacing_y=" << hints_.spacing_.y << "&";
-        searchStream << "spacing_z=" << hints_.spacing_.z << "&";
+VolumeReader* RawVolumeReader::createSliceReader(const VolumeReader* sliceReader, bool texture) const {
+    if (sliceReader)
+        return sliceReader->create();
+    else if (texture)
+        return 0;
 
-        outputHandle->setOrigin(VolumeOrigin("raw", sliceFiles.front(), searchStream.str()));
+    RawVolumeReader* rawReader = new RawVolumeReader();
+    rawReader->setReadHints(hints_);
+    return rawReader;
+}
 
-        return outputHandle;
+Volume* RawVolumeReader::readSlice(const std::string& fileName, VolumeReader* reader) const
+    throw (tgt::FileException, std::bad_alloc)
+{
+    if (!reader) {
+        tgt::Texture* texture = 0;
+        // texture readers are not reentrant
+        #ifdef _OPENMP
+        #pragma omp critical (RawVolumeReader_readSlice)
+        #endif
+        texture = TexMgr.loadIgnorePath(fileName, tgt::Texture::NEAREST, false, true, false, false);
+        if (!texture || !texture->getPixelData()) {
+            delete texture;
+            throw tgt::CorruptedFileException("failed to load image", fileName);
+        }
+
+        std::string type;
+        switch (texture->getDataType()) {
+            case GL_UNSIGNED_BYTE:  type = "uint8";     break;
+            case GL_BYTE:           type = "int8";      break;
+            case GL_UNSIGNED_SHORT: type = "uint16";    break;
+            case GL_SHORT:          type = "int16";     break;
+            case GL_UNSIGNED_INT:   type = "uint32";    break;
+            case GL_INT:            type = "int32";     break;
+            case GL_FLOAT:          type = "float";     break;
+        }
+        size_t numChannels = texture->getNumChannels();
+        if (numChannels > 1)
+            type = "Vector" + itos(numChannels) + "(" + type + ")";
+
+        Volume* volume = 0;
+        if (!type.empty() && numChannels <= 4)
+            volume = VolumeFactory().create(type, tgt::svec3(texture->getWidth(), texture->getHeight(), 1));
+        if (!volume || volume->getNumBytes() != texture->getArraySize()) {
+            delete volume;
+            delete texture;
+            throw tgt::CorruptedFileException("unsupported image format", fileName);
+        }
+        memcpy(volume->getData(), texture->getPixelData(), volume->getNumBytes());
+        delete texture;
+        return volume;
     }
-    else {
+
+    VolumeCollection* collection = reader->read(fileName);
+    if (!collection)
         return 0;
+
+    // the collection does not own its handles, only the first one's volume is kept
+    std::vector<VolumeHandleBase*> handles;
+    for (size_t i=0; i<collection->size(); i++)
+        handles.push_back(collection->at(i));
+    delete collection;
+
+    Volume* volume = 0;
+    for (size_t i=0; i<handles.size(); i++) {
+        VolumeHandle* handle = dynamic_cast<VolumeHandle*>(handles[i]);
+        if (i == 0 && handle && handle->getRepresentation<Volume>()) {
+            volume = handle->getWritableRepresentation<Volume>();
+            handle->releaseAllRepresentations();
+        }
+        delete handles[i];
     }
+    return volume;
+}
+
+void RawVolumeReader::readRawSlice(const std::string& fileName, char* data, const Volume* stack) const
+    throw (tgt::FileException)
+{
+    const tgt::ivec2 dims = stack->getDimensions().xy();
+    const size_t bytesPerVoxel = stack->getBytesPerVoxel();
+    const size_t numVoxels = static_cast<size_t>(tgt::hmul(dims));
+    const size_t numBytes = numVoxels * bytesPerVoxel;
+
+    FILE* fin = fopen(fileName.c_str(), "rb");
+    if (fin == 0)
+        throw tgt::IOException("Unable to open raw file for reading", fileName);
+
+    uint64_t offset = hints_.headerskip_ + static_cast<uint64_t>(numBytes) * static_cast<uint64_t>(hints_.timeframe_);
+    #ifdef _MSC_VER
+        _fseeki64(fin, offset, SEEK_SET);
+    #else
+        fseek(fin, offset, SEEK_SET);
+    #endif
+    size_t numRead = fread(data, 1, numBytes, fin);
+    fclose(fin);
+    if (numRead != numBytes)
+        throw tgt::CorruptedFileException("unexpected EOF: raw file truncated or ObjectModel '" +
+                                          hints_.objectModel_ + "' invalid", fileName);
+
+    // apply the conversions of readSlices() to the slice
+    if (hints_.bigEndianByteOrder_) {
+        const size_t elementSize = bytesPerVoxel / stack->getNumChannels();
+        for (size_t i=0; elementSize > 1 && i < numBytes; i += elementSize)
+            std::reverse(data + i, data + i + elementSize);
+    }
+
+    if (hints_.format_ == "FLOAT" && hints_.objectModel_ == "I" && hints_.spreadMin_ != hints_.spreadMax_) {
+        const float d = hints_.spreadMax_ - hints_.spreadMin_;
+        float* voxel = reinterpret_cast<float*>(data);
+        for (size_t i = 0; i < numVoxels; ++i)
+            voxel[i] = (voxel[i] - hints_.spreadMin_) / d;
+    }
+
+    if (hints_.sliceOrder_ == "-x") {
+        for (int y = 0; y < dims.y; ++y) {
+            char* row = data + y*dims.x*bytesPerVoxel;
+            for (int x = 0; x < dims.x / 2; ++x)
+                std::swap_ranges(row + x*bytesPerVoxel, row + (x+1)*bytesPerVoxel, row + (dims.x-1-x)*bytesPerVoxel);
+        }
+    }
+    else if (hints_.sliceOrder_ == "-y") {
+        const size_t rowBytes = dims.x*bytesPerVoxel;
+        for (int y = 0; y < dims.y / 2; ++y)
+            std::swap_ranges(data + y*rowBytes, data + (y+1)*rowBytes, data + (dims.y-1-y)*rowBytes);
+    }
+}
+
+void RawVolumeReader::readVolumeData(Volume* volume, const std::string& fileName, uint64_t offset, bool checkEOF)
+    throw (tgt::CorruptedFileException, tgt::IOException)
+{
+    FILE* fin;
+    fin = fopen(fileName.c_str(),"rb");
+
+    if (fin == 0)
+        throw tgt::IOException("Unable to open raw file for reading", fileName);
+
+    #ifdef _MSC_VER
+        _fseeki64(fin, offset, SEEK_SET);
+    #else
+        fseek(fin, offset, SEEK_SET);
+    #endif
+
+    VolumeReader::read(volume, fin);
+
+    if (checkEOF && feof(fin)) {
+        fclose(fin);
+        throw tgt::CorruptedFileException("unexpected EOF: raw file truncated or ObjectModel '" +
+                                          hints_.objectModel_ + "' invalid", fileName);
+    }
+
+    fclose(fin);
+}
+
+const RawVolumeReader::ReadHints& RawVolumeReader::getReadHints() const {
+    return hints_;
 }
 
 VolumeReader* RawVolumeReader::create(ProgressBar* progress) const {
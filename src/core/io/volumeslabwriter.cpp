@@ -0,0 +1,351 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#include "voreen/core/io/volumeslabwriter.h"
+#include "voreen/core/io/progressbar.h"
+#include "voreen/core/datastructures/volume/volumefactory.h"
+#include "voreen/core/utils/backgroundthread.h"
+
+#include "tgt/filesystem.h"
+
+#include <cstdio>
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+
+namespace voreen {
+
+namespace {
+
+bool isFloatingPointType(const std::string& type) {
+    return (type.find("float") != std::string::npos || type.find("double") != std::string::npos);
+}
+
+} // namespace
+
+class VolumeSlabWriter::WriteThread : public BackgroundThread {
+public:
+    WriteThread(std::fstream& stream, const char* data, size_t numBytes)
+        : stream_(stream)
+        , data_(data)
+        , numBytes_(numBytes)
+        , failed_(false)
+    {}
+
+    /// Returns whether writing has failed, valid after join().
+    bool hasFailed() const {
+        return failed_;
+    }
+
+protected:
+    virtual void run() {
+        stream_.write(data_, numBytes_);
+        failed_ = stream_.fail();
+    }
+
+private:
+    std::fstream& stream_;
+    const char* data_;
+    size_t numBytes_;
+    bool failed_;
+};
+
+//------------------------------------------------------------------------
+
+const std::string VolumeSlabWriter::loggerCat_("voreen.io.VolumeSlabWriter");
+
+const size_t VolumeSlabWriter::SLAB_SIZE = 1 << 26;
+
+VolumeSlabWriter::VolumeSlabWriter(const std::string& fileName, ProgressBar* progress)
+    throw (tgt::IOException)
+    : fileName_(fileName)
+    , progress_(progress)
+    , committed_(false)
+{
+    stream_.open(getTemporaryFileName().c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!stream_.is_open() || stream_.bad())
+        throw tgt::IOException("Failed to open file for writing", getTemporaryFileName());
+}
+
+VolumeSlabWriter::~VolumeSlabWriter() {
+    if (!committed_) {
+        if (stream_.is_open())
+            stream_.close();
+        tgt::FileSystem::deleteFile(getTemporaryFileName());
+    }
+}
+
+std::string VolumeSlabWriter::getFileName() const {
+    return fileName_;
+}
+
+std::string VolumeSlabWriter::getTemporaryFileName() const {
+    return fileName_ + ".tmp";
+}
+
+void VolumeSlabWriter::write(const void* data, size_t numBytes) throw (tgt::IOException) {
+    tgtAssert(!committed_, "file already committed");
+    stream_.write(static_cast<const char*>(data), numBytes);
+    if (stream_.fail())
+        throw tgt::IOException("Failed to write file", getTemporaryFileName());
+}
+
+void VolumeSlabWriter::write(const std::string& text) throw (tgt::IOException) {
+    write(text.c_str(), text.size());
+}
+
+uint64_t VolumeSlabWriter::writeVolume(const Volume* volume, const Volume* outputVolume, Encoder* encoder,
+                                       size_t sliceAlignment)
+    throw (tgt::IOException)
+{
+    tgtAssert(volume, "no volume");
+    tgtAssert(!outputVolume || outputVolume->getNumChannels() == volume->getNumChannels(), "channel count mismatch");
+
+    const tgt::svec3 dims = volume->getDimensions();
+    const size_t sliceSize = dims.x * dims.y * (outputVolume ? outputVolume : volume)->getBytesPerVoxel();
+    const size_t sourceSliceSize = dims.x * dims.y * volume->getBytesPerVoxel();
+    const char* data = static_cast<const char*>(volume->getData());
+
+    sliceAlignment = std::max<size_t>(sliceAlignment, 1);
+    size_t slabSlices = std::max<size_t>(SLAB_SIZE / std::max<size_t>(sliceSize, 1), 1);
+    slabSlices = std::max<size_t>(slabSlices / sliceAlignment, 1) * sliceAlignment;
+    // the encoder always receives a last slab, even for empty volumes
+    const size_t numSlabs = std::max<size_t>((dims.z + slabSlices - 1) / slabSlices, 1);
+
+    // nothing to prepare: the slabs are written from the volume directly
+    if (!outputVolume && !encoder) {
+        for (size_t i = 0; i < numSlabs; ++i) {
+            const size_t firstSlice = i * slabSlices;
+            const size_t numSlices = std::min(slabSlices, dims.z - std::min(firstSlice, dims.z));
+            write(data + firstSlice * sliceSize, numSlices * sliceSize);
+            if (progress_)
+                progress_->setProgress(static_cast<float>(i + 1) / static_cast<float>(numSlabs));
+        }
+        return static_cast<uint64_t>(dims.z) * sliceSize;
+    }
+
+    // floating point data is mapped from its intensity range, when converted into integers
+    std::vector<tgt::vec2> ranges;
+    VolumeFactory vf;
+    if (outputVolume && isFloatingPointType(vf.getType(volume)) && !isFloatingPointType(vf.getType(outputVolume))) {
+        for (int c = 0; c < volume->getNumChannels(); ++c)
+            ranges.push_back(tgt::vec2(volume->minValue(c), volume->maxValue(c)));
+    }
+
+    // double buffering: slab i is prepared, while slab i-1 is written
+    Volume* slabs[2] = { 0, 0 };
+    std::vector<char> encoded[2];
+    WriteThread* thread = 0;
+    uint64_t written = 0;
+
+    try {
+        for (size_t i = 0; i < numSlabs; ++i) {
+            const size_t firstSlice = i * slabSlices;
+            const size_t numSlices = std::min(slabSlices, dims.z - std::min(firstSlice, dims.z));
+            const int buffer = static_cast<int>(i % 2);
+
+            const char* slab = data + firstSlice * sourceSliceSize;
+            size_t slabSize = numSlices * sliceSize;
+
+            if (outputVolume && numSlices > 0) {
+                if (!slabs[buffer] || slabs[buffer]->getDimensions().z != numSlices) {
+                    delete slabs[buffer];
+                    slabs[buffer] = 0;
+                    slabs[buffer] = outputVolume->createNew(tgt::svec3(dims.x, dims.y, numSlices),
+                                                            VolumeRepresentation::VolumeBorders(), true);
+                }
+                convertSlab(volume, firstSlice, slabs[buffer], ranges);
+                slab = static_cast<const char*>(slabs[buffer]->getData());
+            }
+
+            if (encoder) {
+                encoder->encode(slab, slabSize, i == numSlabs - 1, encoded[buffer]);
+                slab = encoded[buffer].empty() ? 0 : &encoded[buffer][0];
+                slabSize = encoded[buffer].size();
+            }
+
+            finishWriting(thread);
+            if (slabSize > 0) {
+                thread = startWriting(slab, slabSize);
+                written += slabSize;
+            }
+
+            // progress bars may only be updated from the calling thread
+            if (progress_)
+                progress_->setProgress(static_cast<float>(i) / static_cast<float>(numSlabs));
+        }
+
+        finishWriting(thread);
+    }
+    catch (...) {
+        // the thread has to finish before its buffer is freed
+        delete thread;
+        delete slabs[0];
+        delete slabs[1];
+        throw;
+    }
+    delete slabs[0];
+    delete slabs[1];
+
+    if (progress_)
+        progress_->setProgress(1.f);
+
+    return written;
+}
+
+uint64_t VolumeSlabWriter::writeSlabs(SlabSource* source, Encoder* encoder) throw (tgt::IOException) {
+    tgtAssert(source, "no source");
+
+    // double buffering as in writeVolume(). The next slab is fetched in advance,
+    // since the encoder has to know the last one.
+    Volume* slabs[2] = { 0, 0 };
+    Volume* next = 0;
+    std::vector<char> encoded[2];
+    WriteThread* thread = 0;
+    uint64_t written = 0;
+
+    try {
+        next = source->nextSlab();
+        bool last = false;
+        // the encoder always receives a last slab, even for empty volumes
+        for (size_t i = 0; !last; ++i) {
+            const int buffer = static_cast<int>(i % 2);
+
+            // the slab in this buffer has been written by the thread finished in the previous iteration
+            delete slabs[buffer];
+            slabs[buffer] = next;
+            next = 0;
+            if (slabs[buffer])
+                next = source->nextSlab();
+            last = (next == 0);
+
+            const char* slab = slabs[buffer] ? static_cast<const char*>(slabs[buffer]->getData()) : 0;
+            size_t slabSize = slabs[buffer] ? slabs[buffer]->getNumBytes() : 0;
+
+            if (encoder) {
+                encoder->encode(slab, slabSize, last, encoded[buffer]);
+                slab = encoded[buffer].empty() ? 0 : &encoded[buffer][0];
+                slabSize = encoded[buffer].size();
+            }
+
+            finishWriting(thread);
+            if (slabSize > 0) {
+                thread = startWriting(slab, slabSize);
+                written += slabSize;
+            }
+        }
+
+        finishWriting(thread);
+    }
+    catch (...) {
+        // the thread has to finish before its buffer is freed
+        delete thread;
+        delete slabs[0];
+        delete slabs[1];
+        delete next;
+        throw;
+    }
+    delete slabs[0];
+    delete slabs[1];
+
+    return written;
+}
+
+VolumeSlabWriter::WriteThread* VolumeSlabWriter::startWriting(const char* data, size_t numBytes)
+    throw (tgt::IOException)
+{
+    WriteThread* thread = new WriteThread(stream_, data, numBytes);
+    try {
+        thread->start();
+    }
+    catch (VoreenException& e) {
+        LWARNING("Failed to start writing thread, writing synchronously: " << e.what());
+        delete thread;
+        write(data, numBytes);
+        return 0;
+    }
+    return thread;
+}
+
+void VolumeSlabWriter::finishWriting(WriteThread*& thread) throw (tgt::IOException) {
+    if (!thread)
+        return;
+
+    thread->join();
+    bool failed = thread->hasFailed();
+    delete thread;
+    thread = 0;
+    if (failed)
+        throw tgt::IOException("Failed to write file", getTemporaryFileName());
+}
+
+void VolumeSlabWriter::commit() throw (tgt::IOException) {
+    tgtAssert(!committed_, "file already committed");
+
+    stream_.close();
+    if (stream_.fail())
+        throw tgt::IOException("Failed to write file", getTemporaryFileName());
+
+    // replaces the target file at once, unlike deleting it before renaming
+#ifdef WIN32
+    bool success = (MoveFileExA(getTemporaryFileName().c_str(), fileName_.c_str(),
+                                MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0);
+#else
+    bool success = (std::rename(getTemporaryFileName().c_str(), fileName_.c_str()) == 0);
+#endif
+    if (!success)
+        throw tgt::IOException("Failed to replace file by " + getTemporaryFileName(), fileName_);
+
+    committed_ = true;
+}
+
+void VolumeSlabWriter::convertSlab(const Volume* volume, size_t firstSlice, Volume* slab,
+                                   const std::vector<tgt::vec2>& ranges) const
+{
+    const tgt::svec3 dims = volume->getDimensions();
+    const size_t offset = firstSlice * dims.x * dims.y;
+    const long numVoxels = static_cast<long>(slab->getNumVoxels());
+    const int numChannels = volume->getNumChannels();
+
+    #ifdef _OPENMP
+    #pragma omp parallel for
+    #endif
+    for (long i = 0; i < numVoxels; ++i) {
+        for (int c = 0; c < numChannels; ++c) {
+            float value = volume->getVoxelFloat(offset + i, c);
+            if (!ranges.empty()) {
+                const tgt::vec2& range = ranges[c];
+                value = (range.y > range.x) ? (value - range.x) / (range.y - range.x) : 0.f;
+            }
+            slab->setVoxelFloat(value, static_cast<size_t>(i), c);
+        }
+    }
+}
+
+} // namespace voreen
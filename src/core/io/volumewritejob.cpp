@@ -0,0 +1,160 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#include "voreen/core/io/volumewritejob.h"
+#include "voreen/core/io/progressbar.h"
+#include "voreen/core/io/volumeserializer.h"
+#include "voreen/core/io/volumeserializerpopulator.h"
+#include "voreen/core/io/volumewriter.h"
+#include "voreen/core/datastructures/volume/volumehandle.h"
+#include "voreen/core/utils/stringconversion.h"
+
+#include <algorithm>
+
+namespace voreen {
+
+class VolumeWriteJob::WriterProgressBar : public ProgressBar {
+public:
+    WriterProgressBar(VolumeWriteJob* job)
+        : job_(job)
+    {}
+
+    virtual void show() {}
+    virtual void hide() {}
+    virtual void forceUpdate() {}
+    virtual void update() {}
+
+    virtual void setProgress(float progress) {
+        ProgressBar::setProgress(progress);
+        job_->setVolumeProgress(progress);
+    }
+
+private:
+    VolumeWriteJob* job_;
+};
+
+//------------------------------------------------------------------------
+
+const std::string VolumeWriteJob::loggerCat_("voreen.io.VolumeWriteJob");
+
+VolumeWriteJob::VolumeWriteJob()
+    : BackgroundThread()
+    , compressed_(false)
+    , populator_(new VolumeSerializerPopulator())
+    , writerProgress_(0)
+    , progressBar_(0)
+    , currentVolume_(0)
+{
+    writerProgress_ = new WriterProgressBar(this);
+    populator_->getVolumeSerializer()->setProgressBar(writerProgress_);
+}
+
+VolumeWriteJob::~VolumeWriteJob() {
+    join();
+    delete populator_;
+    delete writerProgress_;
+    for (size_t i = 0; i < volumeCopies_.size(); ++i)
+        delete volumeCopies_[i];
+}
+
+void VolumeWriteJob::addVolume(const std::string& fileName, const VolumeHandleBase* volume, bool copy) {
+    tgtAssert(volume, "no volume");
+
+    const Volume* ramVolume = volume->getRepresentation<Volume>();
+    if (copy && ramVolume) {
+        VolumeHandle* volumeCopy = new VolumeHandle(ramVolume->clone(), volume);
+        volumeCopies_.push_back(volumeCopy);
+        volume = volumeCopy;
+    }
+
+    fileNames_.push_back(fileName);
+    volumes_.push_back(volume);
+}
+
+size_t VolumeWriteJob::getNumVolumes() const {
+    return volumes_.size();
+}
+
+void VolumeWriteJob::setOutputDataType(const std::string& dataType) {
+    dataType_ = dataType;
+}
+
+void VolumeWriteJob::setCompressed(bool compressed) {
+    compressed_ = compressed;
+}
+
+void VolumeWriteJob::setProgressBar(ProgressBar* progressBar) {
+    progressBar_ = progressBar;
+}
+
+void VolumeWriteJob::writeVolumes() {
+    VolumeSerializer* serializer = populator_->getVolumeSerializer();
+
+    for (currentVolume_ = 0; currentVolume_ < volumes_.size() && !isInterrupted(); ++currentVolume_) {
+        const std::string& fileName = fileNames_[currentVolume_];
+        const VolumeHandleBase* volume = volumes_[currentVolume_];
+        try {
+            // the output format has the channels of the volume
+            std::string format;
+            const Volume* ramVolume = volume->getRepresentation<Volume>();
+            if (!dataType_.empty() && ramVolume) {
+                int numChannels = ramVolume->getNumChannels();
+                format = (numChannels == 1) ? dataType_ : "Vector" + itos(numChannels) + "(" + dataType_ + ")";
+            }
+
+            std::vector<VolumeWriter*> writers = serializer->getWriters(fileName);
+            for (size_t i = 0; i < writers.size(); ++i) {
+                writers[i]->setOutputFormat(format);
+                writers[i]->setCompressed(compressed_);
+            }
+
+            serializer->write(fileName, volume);
+        }
+        catch (std::exception& e) {
+            errors_.push_back(fileName + ": " + e.what());
+        }
+        setVolumeProgress(1.f);
+    }
+}
+
+std::vector<std::string> VolumeWriteJob::getErrors() const {
+    return errors_;
+}
+
+void VolumeWriteJob::run() {
+    writeVolumes();
+}
+
+void VolumeWriteJob::setVolumeProgress(float progress) {
+    float jobProgress = (static_cast<float>(currentVolume_) + progress) / static_cast<float>(std::max<size_t>(volumes_.size(), 1));
+    setProgress(jobProgress);
+    if (progressBar_)
+        progressBar_->setProgress(jobProgress);
+}
+
+} // namespace voreen
@@ -28,15 +28,122 @@
 
 #include "voreen/core/io/volumewriter.h"
 #include "voreen/core/io/progressbar.h"
+#include "voreen/core/datastructures/volume/volumefactory.h"
+#include "voreen/core/datastructures/volume/volumehandle.h"
+
+#include <cstring>
 
 namespace voreen {
 
+namespace {
+
+/// Allocates a volume of the header's format and dimensions, but the passed depth.
+Volume* createSlabVolume(const VolumeHandle* header, size_t depth, const std::string& fileName)
+    throw (tgt::IOException)
+{
+    const Volume* prototype = header->getRepresentation<Volume>();
+    tgt::svec3 dims = prototype->getDimensions();
+    dims.z = depth;
+    try {
+        return prototype->createNew(dims, VolumeRepresentation::VolumeBorders(), true);
+    }
+    catch (std::bad_alloc&) {
+        throw tgt::IOException("Not enough memory for assembling the volume", fileName);
+    }
+}
+
+} // namespace
+
 const std::string VolumeWriter::loggerCat_("voreen.io.VolumeWriter");
 
 VolumeWriter::VolumeWriter(ProgressBar* progress)
     : progress_(progress)
+    , compressed_(false)
 {}
 
+void VolumeWriter::writeSlabs(const std::string& fileName, VolumeSlabWriter::SlabSource* source)
+    throw (tgt::IOException)
+{
+    tgtAssert(source, "no source");
+
+    // if the depth is known in advance, each slab is copied into the volume as it arrives,
+    // otherwise the slabs are collected until the volume can be allocated after the last one
+    const size_t depth = source->getNumSlices();
+    std::vector<Volume*> slabs;
+    Volume* slab = 0;
+    Volume* volume = 0;
+    VolumeHandle* header = 0;
+    VolumeHandle* handle = 0;
+    try {
+        size_t numSlices = 0;
+        while ((slab = source->nextSlab()) != 0) {
+            if (depth == 0) {
+                slabs.push_back(slab);
+                slab = 0;
+                continue;
+            }
+            if (!volume) {
+                header = source->createHeader();
+                volume = createSlabVolume(header, depth, fileName);
+                delete header;
+                header = 0;
+            }
+            const tgt::svec3 dims = slab->getDimensions();
+            if (numSlices + dims.z > depth)
+                throw tgt::IOException("More slices provided than announced", fileName);
+            memcpy(static_cast<char*>(volume->getData()) + numSlices * dims.x * dims.y * slab->getBytesPerVoxel(),
+                   slab->getData(), slab->getNumBytes());
+            numSlices += dims.z;
+            delete slab;
+            slab = 0;
+        }
+
+        header = source->createHeader();
+        if (depth == 0) {
+            volume = createSlabVolume(header, header->getDimensions().z, fileName);
+            char* dest = static_cast<char*>(volume->getData());
+            for (size_t i = 0; i < slabs.size(); ++i) {
+                memcpy(dest, slabs[i]->getData(), slabs[i]->getNumBytes());
+                dest += slabs[i]->getNumBytes();
+                delete slabs[i];
+                slabs[i] = 0;
+            }
+        }
+        else if (numSlices != depth) {
+            throw tgt::IOException("Fewer slices provided than announced", fileName);
+        }
+        handle = new VolumeHandle(volume, header);
+        volume = 0;
+
+        // the slabs are already in the format to be written
+        std::string outputFormat = outputFormat_;
+        outputFormat_ = "";
+        try {
+            write(fileName, handle);
+        }
+        catch (...) {
+            outputFormat_ = outputFormat;
+            throw;
+        }
+        outputFormat_ = outputFormat;
+    }
+    catch (...) {
+        for (size_t i = 0; i < slabs.size(); ++i)
+            delete slabs[i];
+        delete slab;
+        delete volume;
+        delete header;
+        delete handle;
+        throw;
+    }
+    delete header;
+    delete handle;
+}
+
+bool VolumeWriter::streamsSlabs() const {
+    return false;
+}
+
 const std::vector<std::string>& VolumeWriter::getSupportedExtensions() const {
     return extensions_;
 }
@@ -65,6 +172,41 @@ ProgressBar* VolumeWriter::getProgressBar() const {
     return progress_;
 }
 
+void VolumeWriter::setOutputFormat(const std::string& format) {
+    outputFormat_ = format;
+}
+
+std::string VolumeWriter::getOutputFormat() const {
+    return outputFormat_;
+}
+
+void VolumeWriter::setCompressed(bool compressed) {
+    compressed_ = compressed;
+}
+
+bool VolumeWriter::isCompressed() const {
+    return compressed_;
+}
+
+Volume* VolumeWriter::createOutputVolume(const Volume* volume) const throw (tgt::IOException) {
+    tgtAssert(volume, "no volume");
+    VolumeFactory vf;
+    if (outputFormat_.empty() || vf.getType(volume) == outputFormat_)
+        return 0;
+
+    Volume* prototype = vf.create(outputFormat_, tgt::svec3(1, 1, 1));
+    if (!prototype)
+        throw tgt::IOException("Unknown output format: " + outputFormat_);
+    if (prototype->getNumChannels() != volume->getNumChannels()) {
+        delete prototype;
+        throw tgt::IOException("Output format " + outputFormat_ + " does not match the volume's number of channels");
+    }
+
+    Volume* outputVolume = prototype->createNew(volume->getDimensions(), VolumeRepresentation::VolumeBorders(), false);
+    delete prototype;
+    return outputVolume;
+}
+
 
 
 } // namespace voreen
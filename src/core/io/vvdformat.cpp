@@ -28,12 +28,161 @@
 
 #include "voreen/core/io/vvdformat.h"
 #include "voreen/core/datastructures/volume/volumehash.h"
+#include "voreen/core/datastructures/volume/volumestatistics.h"
+#include "voreen/core/datastructures/volume/histogram.h"
 #include "voreen/core/datastructures/volume/volumefactory.h"
 #include "voreen/core/io/serialization/meta/primitivemetadata.h"
+#include "voreen/core/io/progressbar.h"
+#include "voreen/core/utils/stringconversion.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#ifdef VRN_MODULE_ZIP
+#include <zlib.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace voreen {
 
-VvdRawDataObject::VvdRawDataObject(const Volume* volume, std::string filename) : filename_(filename), dimensions_(volume->getDimensions()) {
+namespace {
+
+// uncompressed size the chunks are aiming at, a chunk contains at least one slice
+const size_t CHUNK_SIZE = 1 << 22;
+
+bool seekFile(FILE* file, uint64_t offset) {
+#if defined(_MSC_VER)
+    return (_fseeki64(file, static_cast<__int64>(offset), SEEK_SET) == 0);
+#elif defined(__MINGW32__)
+    return (fseeko64(file, static_cast<off64_t>(offset), SEEK_SET) == 0);
+#else
+    return (fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0);
+#endif
+}
+
+#ifdef VRN_MODULE_ZIP
+uint32_t computeChecksum(const char* data, size_t numBytes) {
+    return static_cast<uint32_t>(crc32(crc32(0L, Z_NULL, 0), reinterpret_cast<const Bytef*>(data), static_cast<uInt>(numBytes)));
+}
+
+/**
+ * Compresses the slabs passed by a VolumeSlabWriter in independent chunks,
+ * in parallel, and appends them to the chunk index.
+ */
+class ChunkEncoder : public VolumeSlabWriter::Encoder {
+public:
+    ChunkEncoder(size_t chunkSize, std::vector<VvdChunk>& chunks)
+        : chunkSize_(chunkSize)
+        , chunks_(chunks)
+    {}
+
+    virtual void encode(const char* data, size_t numBytes, bool /*last*/, std::vector<char>& out)
+        throw (tgt::IOException)
+    {
+        tgtAssert(chunkSize_ > 0, "no chunk size");
+        const int numChunks = static_cast<int>((numBytes + chunkSize_ - 1) / chunkSize_);
+        std::vector<std::vector<char> > compressed(numChunks);
+        std::vector<uint32_t> checksums(numChunks);
+        std::vector<char> failed(numChunks, 0);
+
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic)
+        #endif
+        for (int i = 0; i < numChunks; ++i) {
+            const char* chunk = data + i * chunkSize_;
+            const uLong size = static_cast<uLong>(std::min(chunkSize_, numBytes - i * chunkSize_));
+
+            // fastest zlib level, volume data is usually dominated by noise and large uniform regions
+            uLongf compressedSize = compressBound(size);
+            compressed[i].resize(compressedSize);
+            failed[i] = (compress2(reinterpret_cast<Bytef*>(&compressed[i][0]), &compressedSize,
+                                   reinterpret_cast<const Bytef*>(chunk), size, Z_BEST_SPEED) != Z_OK);
+            compressed[i].resize(compressedSize);
+            checksums[i] = computeChecksum(chunk, size);
+        }
+
+        out.clear();
+        for (int i = 0; i < numChunks; ++i) {
+            if (failed[i])
+                throw tgt::IOException("Failed to compress chunk " + itos(static_cast<int>(chunks_.size())));
+            out.insert(out.end(), compressed[i].begin(), compressed[i].end());
+            chunks_.push_back(VvdChunk(compressed[i].size(), checksums[i]));
+            std::vector<char>().swap(compressed[i]);
+        }
+    }
+
+protected:
+    size_t chunkSize_;
+
+private:
+    std::vector<VvdChunk>& chunks_;
+};
+
+/**
+ * Compresses the slabs of a SlabSource, whose size is only known with the first slab.
+ * The chunks consist of the largest divisor of the first slab's slices not exceeding
+ * CHUNK_SIZE, so that all chunks but the last one have the same number of slices,
+ * as long as the following slabs consist of whole chunks.
+ */
+class SlabChunkEncoder : public ChunkEncoder {
+public:
+    SlabChunkEncoder(size_t sliceSize, int& chunkSlices, std::vector<VvdChunk>& chunks)
+        : ChunkEncoder(0, chunks)
+        , sliceSize_(std::max<size_t>(sliceSize, 1))
+        , chunkSlices_(chunkSlices)
+    {}
+
+    virtual void encode(const char* data, size_t numBytes, bool last, std::vector<char>& out)
+        throw (tgt::IOException)
+    {
+        if (chunkSize_ == 0) {
+            const size_t slabSlices = std::max<size_t>(numBytes / sliceSize_, 1);
+            size_t slices = std::min(std::max<size_t>(CHUNK_SIZE / sliceSize_, 1), slabSlices);
+            while (slabSlices % slices != 0)
+                --slices;
+            chunkSlices_ = static_cast<int>(slices);
+            chunkSize_ = slices * sliceSize_;
+        }
+        else if (!last && numBytes % chunkSize_ != 0) {
+            throw tgt::IOException("Slabs of varying size can not be written in chunks");
+        }
+        ChunkEncoder::encode(data, numBytes, last, out);
+    }
+
+private:
+    size_t sliceSize_;
+    int& chunkSlices_;
+};
+#endif
+
+} // namespace
+
+void VvdChunk::serialize(XmlSerializer& s) const {
+    s.serialize("size", size_);
+    std::ostringstream checksum;
+    checksum << std::hex << checksum_;
+    s.serialize("crc32", checksum.str());
+}
+
+void VvdChunk::deserialize(XmlDeserializer& s) {
+    s.deserialize("size", size_);
+    std::string checksum;
+    s.deserialize("crc32", checksum);
+    std::istringstream checksumStream(checksum);
+    checksumStream >> std::hex >> checksum_;
+}
+
+//---------------------------------------------------------------------------
+
+VvdRawDataObject::VvdRawDataObject(const Volume* volume, std::string filename)
+    : filename_(filename), dimensions_(volume->getDimensions()), chunkSlices_(0)
+{
     VolumeFactory vf;
     format_ = vf.getType(volume);
     if(format_ == "")
@@ -49,6 +198,13 @@ void VvdRawDataObject::serialize(XmlSerializer& s) const {
     s.serialize("x", x);
     s.serialize("y", y);
     s.serialize("z", z);
+
+    // flat raw files are written as before
+    if (isChunked()) {
+        s.serialize("encoding", encoding_);
+        s.serialize("chunkSlices", chunkSlices_);
+        s.serialize("Chunks", chunks_, "Chunk");
+    }
 }
 
 void VvdRawDataObject::deserialize(XmlDeserializer& s) {
@@ -61,9 +217,199 @@ void VvdRawDataObject::deserialize(XmlDeserializer& s) {
     s.deserialize("y", y);
     s.deserialize("z", z);
     dimensions_ = tgt::ivec3(x,y,z);
+
+    encoding_ = "";
+    chunks_.clear();
+    try {
+        s.deserialize("encoding", encoding_);
+    }
+    catch (XmlSerializationNoSuchDataException&) {
+        // flat raw file
+        s.removeLastError();
+        return;
+    }
+    s.deserialize("chunkSlices", chunkSlices_);
+    s.deserialize("Chunks", chunks_, "Chunk");
+    if (chunkSlices_ <= 0)
+        throw SerializationException("Invalid number of slices per chunk: " + itos(chunkSlices_));
+}
+
+void VvdRawDataObject::writeChunks(const Volume* volume, VolumeSlabWriter& writer, const Volume* outputVolume)
+    throw (tgt::IOException)
+{
+#ifdef VRN_MODULE_ZIP
+    const tgt::svec3 dims = volume->getDimensions();
+    const size_t sliceSize = dims.x * dims.y * (outputVolume ? outputVolume : volume)->getBytesPerVoxel();
+
+    encoding_ = "zlib";
+    chunkSlices_ = static_cast<int>(std::min(std::max<size_t>(CHUNK_SIZE / std::max<size_t>(sliceSize, 1), 1), std::max<size_t>(dims.z, 1)));
+    chunks_.clear();
+
+    // the slabs consist of whole chunks
+    ChunkEncoder encoder(chunkSlices_ * sliceSize, chunks_);
+    writer.writeVolume(volume, outputVolume, &encoder, chunkSlices_);
+#else
+    throw tgt::IOException("Chunked volume data requires zlib, which is provided by the zip module", writer.getFileName());
+#endif
+}
+
+void VvdRawDataObject::writeChunks(VolumeSlabWriter::SlabSource* source, VolumeSlabWriter& writer)
+    throw (tgt::IOException)
+{
+    tgtAssert(source, "no source");
+#ifdef VRN_MODULE_ZIP
+    VolumeHandle* header = source->createHeader();
+    const tgt::svec3 dims = header->getDimensions();
+    const size_t sliceSize = dims.x * dims.y * header->getRepresentation<Volume>()->getBytesPerVoxel();
+    delete header;
+
+    encoding_ = "zlib";
+    chunkSlices_ = 1;
+    chunks_.clear();
+
+    SlabChunkEncoder encoder(sliceSize, chunkSlices_, chunks_);
+    writer.writeSlabs(source, &encoder);
+#else
+    throw tgt::IOException("Chunked volume data requires zlib, which is provided by the zip module", writer.getFileName());
+#endif
 }
 
-VvdObject::VvdObject(const VolumeHandleBase* vh, std::string rawFilename) : rawData_(vh->getRepresentation<Volume>(), rawFilename) {
+void VvdRawDataObject::setChunkIndex(const VvdRawDataObject& chunked) {
+    encoding_ = chunked.encoding_;
+    chunkSlices_ = chunked.chunkSlices_;
+    chunks_ = chunked.chunks_;
+}
+
+Volume* VvdRawDataObject::readSlices(const std::string& fileName, size_t firstSlice, size_t lastSlice, ProgressBar* progress) const
+    throw (tgt::FileException)
+{
+    const tgt::svec3 dims(dimensions_.x, dimensions_.y, dimensions_.z);
+    if (firstSlice == 0 && lastSlice == 0)
+        lastSlice = dims.z;
+    // clamped, so that the volume may be read slab by slab without knowing its depth
+    lastSlice = std::min(lastSlice, dims.z);
+    if (lastSlice <= firstSlice)
+        throw tgt::FileException("Invalid slice range [" + itos(static_cast<int>(firstSlice)) + ", "
+                                 + itos(static_cast<int>(lastSlice)) + ")", fileName);
+
+    VolumeFactory vf;
+    Volume* volume = vf.create(format_, tgt::svec3(dims.x, dims.y, lastSlice - firstSlice));
+    if (!volume)
+        throw tgt::FileException("Unsupported format: " + format_, fileName);
+
+    const size_t sliceSize = dims.x * dims.y * volume->getBytesPerVoxel();
+    char* dest = static_cast<char*>(volume->getData());
+
+    if (!isChunked()) {
+        FILE* file = fopen(fileName.c_str(), "rb");
+        if (!file) {
+            delete volume;
+            throw tgt::IOException("Unable to open raw file for reading", fileName);
+        }
+        bool success = seekFile(file, static_cast<uint64_t>(firstSlice) * sliceSize)
+            && (fread(dest, sliceSize * (lastSlice - firstSlice), 1, file) == 1);
+        fclose(file);
+        if (!success) {
+            delete volume;
+            throw tgt::CorruptedFileException("Unexpected end of raw file", fileName);
+        }
+        return volume;
+    }
+
+#ifdef VRN_MODULE_ZIP
+    const size_t firstChunk = firstSlice / chunkSlices_;
+    const size_t lastChunk = (lastSlice - 1) / chunkSlices_;
+    if (encoding_ != "zlib" || lastChunk >= chunks_.size()) {
+        delete volume;
+        throw tgt::CorruptedFileException((encoding_ != "zlib") ? "Unsupported encoding: " + encoding_
+                                          : "Chunk index does not cover the volume", fileName);
+    }
+
+    // the chunks are stored back to back
+    std::vector<uint64_t> offsets(chunks_.size(), 0);
+    for (size_t i = 1; i < chunks_.size(); ++i)
+        offsets[i] = offsets[i - 1] + chunks_[i - 1].getSize();
+
+    const int numChunks = static_cast<int>(lastChunk - firstChunk + 1);
+    std::vector<char> failed(numChunks, 0);
+    int numInflated = 0;
+    #ifdef _OPENMP
+    #pragma omp parallel
+    #endif
+    {
+        FILE* file = fopen(fileName.c_str(), "rb");
+        std::vector<char> in;
+        std::vector<char> out;
+
+        #ifdef _OPENMP
+        #pragma omp for schedule(dynamic)
+        #endif
+        for (int i = 0; i < numChunks; ++i) {
+            const size_t chunk = firstChunk + i;
+            const size_t chunkBegin = chunk * chunkSlices_;
+            const size_t chunkEnd = std::min<size_t>(chunkBegin + chunkSlices_, dims.z);
+            const size_t begin = std::max(chunkBegin, firstSlice);
+            const size_t end = std::min(chunkEnd, lastSlice);
+            const uLong chunkSize = static_cast<uLong>((chunkEnd - chunkBegin) * sliceSize);
+
+            // chunks lying completely inside the slice range are inflated directly into the volume
+            const bool direct = (begin == chunkBegin && end == chunkEnd);
+            char* target;
+            if (direct) {
+                target = dest + (chunkBegin - firstSlice) * sliceSize;
+            }
+            else {
+                out.resize(chunkSize);
+                target = &out[0];
+            }
+
+            in.resize(chunks_[chunk].getSize());
+            uLongf inflatedSize = chunkSize;
+            bool success = file && !in.empty() && seekFile(file, offsets[chunk])
+                && (fread(&in[0], in.size(), 1, file) == 1)
+                && (uncompress(reinterpret_cast<Bytef*>(target), &inflatedSize,
+                               reinterpret_cast<const Bytef*>(&in[0]), static_cast<uLong>(in.size())) == Z_OK)
+                && (inflatedSize == chunkSize)
+                && (computeChecksum(target, chunkSize) == chunks_[chunk].getChecksum());
+
+            if (success && !direct)
+                memcpy(dest + (begin - firstSlice) * sliceSize, target + (begin - chunkBegin) * sliceSize, (end - begin) * sliceSize);
+            failed[i] = !success;
+
+            #ifdef _OPENMP
+            #pragma omp atomic
+            #endif
+            ++numInflated;
+
+#ifdef _OPENMP
+            // progress bars may only be updated from the calling thread
+            if (omp_get_thread_num() == 0)
+#endif
+            if (progress)
+                progress->setProgress(static_cast<float>(numInflated) / static_cast<float>(numChunks));
+        }
+
+        if (file)
+            fclose(file);
+    }
+
+    for (int i = 0; i < numChunks; ++i) {
+        if (failed[i]) {
+            delete volume;
+            throw tgt::CorruptedFileException("Chunk " + itos(static_cast<int>(firstChunk + i))
+                                              + " is corrupted or its checksum does not match", fileName);
+        }
+    }
+    return volume;
+#else
+    delete volume;
+    throw tgt::FileException("Chunked volume data requires zlib, which is provided by the zip module", fileName);
+#endif
+}
+
+VvdObject::VvdObject(const VolumeHandleBase* vh, std::string rawFilename, const Volume* outputVolume)
+    : rawData_(outputVolume ? outputVolume : vh->getRepresentation<Volume>(), rawFilename)
+{
     std::vector<std::string> keys = vh->getMetaDataKeys();
     for(size_t i=0; i<keys.size(); i++) {
         const MetaDataBase* md = vh->getMetaData(keys[i]);
@@ -108,14 +454,40 @@ VvdObject::VvdObject(const VolumeHandleBase* vh, std::string rawFilename) : rawD
         }
     }
 
+    // derived data is stored in the header, so that it does not need to be recomputed on load,
+    // unless it does not match the written data due to a conversion
+    if (outputVolume)
+        return;
     derivedData_.insert(vh->getDerivedData<VolumeHash>());
+    derivedData_.insert(vh->getDerivedData<VolumeStatistics>());
+    if (vh->hasDerivedData<HistogramIntensity>())
+        derivedData_.insert(vh->getDerivedData<HistogramIntensity>());
 }
 
-VolumeHandle* VvdObject::createVolume(std::string directory) {
+VolumeHandle* VvdObject::createVolume(std::string directory, size_t firstSlice, size_t lastSlice, ProgressBar* progress) {
+    std::string fileName = directory + "/" + rawData_.getFilename();
+    bool partial = (firstSlice != 0 || lastSlice != 0);
+
     VolumeRepresentation* volume;
-    volume = (Volume*) new DiskRepresentation(directory+"/"+rawData_.getFilename(), rawData_.getFormat(), rawData_.getDimensions());
+    if (rawData_.isChunked() || partial)
+        volume = rawData_.readSlices(fileName, firstSlice, lastSlice, progress);
+    else
+        volume = (Volume*) new DiskRepresentation(fileName, rawData_.getFormat(), rawData_.getDimensions());
+
+    VolumeHandle* vh = new VolumeHandle(volume, &metaData_);
 
-    VolumeHandle* vh = new VolumeHandle(volume, &metaData_); //TODO: derived data
+    if (partial) {
+        // derived data refers to the whole volume
+        for (std::set<VolumeDerivedData*>::iterator it = derivedData_.begin(); it != derivedData_.end(); ++it)
+            delete *it;
+        vh->setOffset(vh->getOffset() + tgt::vec3(0.f, 0.f, vh->getSpacing().z * firstSlice));
+    }
+    else {
+        // the handle takes ownership of the restored derived data
+        for (std::set<VolumeDerivedData*>::iterator it = derivedData_.begin(); it != derivedData_.end(); ++it)
+            vh->addDerivedData(*it);
+    }
+    derivedData_.clear();
 
     return vh;
 }
@@ -56,10 +56,39 @@ VvdVolumeReader::VvdVolumeReader(ProgressBar* progress)
 
 VolumeCollection* VvdVolumeReader::read(const std::string &url)
     throw (tgt::FileException, std::bad_alloc)
+{
+    return readSlices(url, 0, 0);
+}
+
+VolumeCollection* VvdVolumeReader::readSlices(const std::string& url, size_t firstSlice, size_t lastSlice)
+    throw (tgt::FileException, std::bad_alloc)
 {
     VolumeOrigin origin(url);
     std::string fileName = origin.getPath();
 
+    std::vector<VvdObject> vec = readVvdFile(fileName);
+
+    VolumeCollection* vc = new VolumeCollection();
+    try {
+        for(size_t i=0; i<vec.size(); i++) {
+            VolumeHandle* vh = vec[i].createVolume(tgt::FileSystem::dirName(fileName), firstSlice, lastSlice, getProgressBar());
+            vh->setOrigin(origin);
+            vc->add(vh);
+        }
+    }
+    catch (...) {
+        for (size_t i = 0; i < vc->size(); ++i)
+            delete vc->at(i);
+        delete vc;
+        throw;
+    }
+
+    return vc;
+}
+
+std::vector<VvdObject> VvdVolumeReader::readVvdFile(const std::string& fileName) const
+    throw (tgt::FileException)
+{
     // open file for reading
     std::fstream fileStream(fileName.c_str(), std::ios_base::in);
     if (fileStream.fail()) {
@@ -93,14 +122,7 @@ VolumeCollection* VvdVolumeReader::read(const std::string &url)
         throw tgt::FileException("Deserialization from file '" + fileName + "' failed (unknown exception).");
     }
 
-    VolumeCollection* vc = new VolumeCollection();
-    for(size_t i=0; i<vec.size(); i++) {
-        VolumeHandle* vh = vec[i].createVolume(tgt::FileSystem::dirName(fileName));
-        vh->setOrigin(origin);
-        vc->add(vh);
-    }
-
-    return vc;
+    return vec;
 }
 
 VolumeReader* VvdVolumeReader::create(ProgressBar* progress) const {
@@ -28,6 +28,7 @@
 
 #include "voreen/core/io/vvdvolumewriter.h"
 #include "voreen/core/io/vvdformat.h"
+#include "voreen/core/io/volumeslabwriter.h"
 #include "voreen/core/datastructures/volume/volumeatomic.h"
 #include "voreen/core/datastructures/volume/volumehandle.h"
 
@@ -52,21 +53,92 @@ void VvdVolumeWriter::write(const std::string& filename, const VolumeHandleBase*
         return;
     }
 
+    bool compressed = useCompression();
     std::string vvdname = filename;
-    std::string rawname = getFileNameWithoutExtension(filename) + ".raw";
+    std::string rawname = getFileNameWithoutExtension(filename) + (compressed ? ".zraw" : ".raw");
     LINFO("saving " << vvdname << " and " << rawname);
 
-    // VVD: ---------------------------
+    Volume* outputVolume = createOutputVolume(volume);
+    try {
+        VvdObject o = VvdObject(volumeHandle, tgt::FileSystem::fileName(rawname), outputVolume);
+
+        // RAW: ---------------------------
+        // written first, since the header contains the chunk index
+
+        VolumeSlabWriter rawout(rawname, getProgressBar());
+        if (compressed)
+            o.getRawData().writeChunks(volume, rawout, outputVolume);
+        else
+            rawout.writeVolume(volume, outputVolume);
+        rawout.commit();
+
+        // VVD: ---------------------------
+
+        writeHeader(vvdname, o);
+    }
+    catch (...) {
+        delete outputVolume;
+        throw;
+    }
+    delete outputVolume;
+}
+
+void VvdVolumeWriter::writeSlabs(const std::string& filename, VolumeSlabWriter::SlabSource* source)
+    throw (tgt::IOException)
+{
+    tgtAssert(source, "No source");
+
+    bool compressed = useCompression();
+    std::string vvdname = filename;
+    std::string rawname = getFileNameWithoutExtension(filename) + (compressed ? ".zraw" : ".raw");
+    LINFO("saving " << vvdname << " and " << rawname);
 
+    // the chunk index is filled while writing, the dimensions are only known afterwards
+    VvdRawDataObject chunked;
+    VolumeSlabWriter rawout(rawname);
+    if (compressed)
+        chunked.writeChunks(source, rawout);
+    else
+        rawout.writeSlabs(source);
+    rawout.commit();
+
+    VolumeHandle* header = source->createHeader();
+    try {
+        // the header's volume holds no data, passing it as output volume skips the derived data
+        VvdObject o = VvdObject(header, tgt::FileSystem::fileName(rawname), header->getRepresentation<Volume>());
+        o.getRawData().setChunkIndex(chunked);
+        writeHeader(vvdname, o);
+    }
+    catch (...) {
+        delete header;
+        throw;
+    }
+    delete header;
+}
+
+bool VvdVolumeWriter::streamsSlabs() const {
+    return true;
+}
+
+bool VvdVolumeWriter::useCompression() const {
+#ifdef VRN_MODULE_ZIP
+    return isCompressed();
+#else
+    if (isCompressed())
+        LWARNING("Compression requires the zip module, writing raw data");
+    return false;
+#endif
+}
+
+void VvdVolumeWriter::writeHeader(const std::string& vvdname, const VvdObject& object) const throw (tgt::IOException) {
     XmlSerializer s(vvdname);
     s.setUseAttributes(true);
 
-    VvdObject o = VvdObject(volumeHandle, tgt::FileSystem::fileName(rawname));
     std::vector<VvdObject> vec;
-    vec.push_back(o);
+    vec.push_back(object);
 
     s.serialize("Volumes", vec, "Volume");
-    
+
     //errorList_ = s.getErrors();
 
     // write serialization data to temporary string stream
@@ -84,38 +156,10 @@ void VvdVolumeWriter::write(const std::string& filename, const VolumeHandleBase*
     }
 
     // Now we have a valid StringStream containing the serialization data.
-    // => Open output file and write it to the file.
-    std::fstream fileStream(vvdname.c_str(), std::ios_base::out);
-    if (fileStream.fail())
-        throw SerializationException("Failed to open file '" + vvdname + "' for writing.");
-
-    try {
-        fileStream << textStream.str();
-    }
-    catch (std::exception& e) {
-        throw SerializationException("Failed to write serialization data stream to file '"
-                                     + vvdname + "': " + std::string(e.what()));
-    }
-    catch (...) {
-        throw SerializationException("Failed to write serialization data stream to file '"
-                                     + vvdname + "' (unknown exception).");
-    }
-    fileStream.close();
-
-    std::fstream rawout(rawname.c_str(), std::ios::out | std::ios::binary);
-
-    if (!rawout.is_open() || rawout.bad())
-        throw tgt::IOException();
-
-    // RAW: ---------------------------
-    const char* data = static_cast<const char*>(volume->getData());
-    size_t numbytes = volume->getNumVoxels() * volume->getBytesPerVoxel();
-
-    rawout.write(data, numbytes);
-    if (rawout.bad())
-        throw tgt::IOException();
-
-    rawout.close();
+    // => Write it to the file, which replaces an existing one once it is complete.
+    VolumeSlabWriter vvdout(vvdname);
+    vvdout.write(textStream.str());
+    vvdout.commit();
 }
 
 VolumeWriter* VvdVolumeWriter::create(ProgressBar* /*progress*/) const {
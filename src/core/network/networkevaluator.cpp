@@ -33,11 +33,24 @@
 #include "voreen/core/network/networkgraph.h"
 #include "voreen/core/utils/exception.h"
 #include "voreen/core/processors/canvasrenderer.h"
+#include "voreen/core/properties/link/propertylink.h"
+#include "voreen/core/ports/volumeport.h"
+#include "voreen/core/datastructures/volume/volumehandle.h"
+#include "voreen/core/datastructures/volume/volumegl.h"
+#include "voreen/core/io/progressbar.h"
+#include "voreen/core/io/timetofinishreporter.h"
+#include "voreen/core/utils/stringconversion.h"
 
 #include "tgt/textureunit.h"
 #include "tgt/framebufferobject.h"
+#include "tgt/mutex.h"
 
 #include <vector>
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 using std::vector;
 
@@ -54,6 +67,7 @@ NetworkEvaluator::NetworkEvaluator(tgt::GLCanvas* sharedContext)
     , networkChanged_(false)
     , locked_(false)
     , processPending_(false)
+    , openGLEnabled_(true)
 {
 
 #ifdef VRN_DEBUG
@@ -74,6 +88,34 @@ NetworkEvaluator::~NetworkEvaluator() {
     clearProcessWrappers();
 }
 
+void NetworkEvaluator::setOpenGLEnabled(bool enabled) {
+    if (network_)
+        LWARNING("setOpenGLEnabled() called on evaluator with network");
+    openGLEnabled_ = enabled;
+
+#ifdef VRN_DEBUG
+    // the state check queries OpenGL before and after each processor
+    if (!openGLEnabled_) {
+        for (size_t i=0; i<processWrappers_.size(); ++i) {
+            if (dynamic_cast<CheckOpenGLStateProcessWrapper*>(processWrappers_[i])) {
+                delete processWrappers_[i];
+                processWrappers_.erase(processWrappers_.begin() + i);
+                break;
+            }
+        }
+    }
+#endif
+}
+
+bool NetworkEvaluator::isOpenGLEnabled() const {
+    return openGLEnabled_;
+}
+
+bool NetworkEvaluator::isSkipped(const Processor* processor) const {
+    tgtAssert(processor, "null pointer passed");
+    return !openGLEnabled_ && processor->requiresOpenGL();
+}
+
 void NetworkEvaluator::addProcessWrapper(ProcessWrapper* w) {
     processWrappers_.push_back(w);
 }
@@ -104,12 +146,20 @@ bool NetworkEvaluator::initializeNetwork()  {
     lock();
 
     // Voreen's default depth buffer settings
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
+    if (openGLEnabled_) {
+        glEnable(GL_DEPTH_TEST);
+        glDepthFunc(GL_LESS);
+    }
 
     bool failed = false;
     for (size_t i = 0; i < network_->getProcessors().size(); ++i) {
         Processor* processor = network_->getProcessors()[i];
+        if (isSkipped(processor)) {
+            if (!processor->isInitialized())
+                LWARNING("Skipping processor '" << processor->getName()
+                         << "' (" << processor->getClassName() << "): requires OpenGL");
+            continue;
+        }
         if (!processor->isInitialized()) {
             try {
                 if (sharedContext_)
@@ -140,7 +190,8 @@ bool NetworkEvaluator::initializeNetwork()  {
         }
     }
 
-    assignRenderTargets();
+    if (openGLEnabled_)
+        assignRenderTargets();
 
     unlock();
     return !failed;
@@ -243,6 +294,8 @@ void NetworkEvaluator::process() {
     // prevent parallel execution in multithreaded/event dispatching environments
     lock();
 
+    TraceSpan* networkSpan = (Profiler::isEnabled() ? new TraceSpan("NetworkEvaluator::process", "network") : 0);
+
     if (renderingOrder_.empty()) {
         LDEBUG("process(): rendering order is not defined!");
     }
@@ -270,105 +323,74 @@ void NetworkEvaluator::process() {
         processWrappers_[j]->beforeNetworkProcess();
     LGL_ERROR;
 
-    // Iterate over processing in rendering order
-    for (size_t i = 0; i < renderingOrder_.size(); ++i) {
-        Processor* const currentProcessor = renderingOrder_[i];
-
-        // all processors should have been initialized at this point
-        if (!currentProcessor->isInitialized()) {
-            LWARNING("process(): Skipping uninitialized processor '" << currentProcessor->getName()
-                     << "' (" << currentProcessor->getClassName() << ")");
-            continue;
-        }
-
-        bool needsProcessing = true;
-        if (currentProcessor->isValid())
-            needsProcessing = false;
-
-        // run the processor, if it needs processing and is ready
-        if (needsProcessing && currentProcessor->isReady()) {
-
-            // increase iteration counters
-            for (size_t j=0; j<loopPortMap_[currentProcessor].size(); ++j) {
-                Port* port = loopPortMap_[currentProcessor][j];
-                // note: modulo is required for nested loops
-                port->setLoopIteration((port->getLoopIteration()+1) % port->getNumLoopIterations());
+    // Evaluate independent CPU-only processors concurrently, if possible.
+    // Otherwise, iterate over processing in rendering order.
+    bool topologyChanged = false;
+    if (!processConcurrently(processed, topologyChanged)) {
+        for (size_t i = 0; i < renderingOrder_.size(); ++i) {
+            Processor* const currentProcessor = renderingOrder_[i];
+
+            // all processors should have been initialized at this point,
+            // except for those requiring OpenGL, if it is disabled
+            if (isSkipped(currentProcessor))
+                continue;
+            if (!currentProcessor->isInitialized()) {
+                LWARNING("process(): Skipping uninitialized processor '" << currentProcessor->getName()
+                         << "' (" << currentProcessor->getClassName() << ")");
+                continue;
             }
 
-            // notify process wrappers
-            for (size_t j=0; j < processWrappers_.size(); ++j)
-                processWrappers_[j]->beforeProcess(currentProcessor);
-            LGL_ERROR;
+            bool needsProcessing = true;
+            if (currentProcessor->isValid())
+                needsProcessing = false;
 
-            try {
-                currentProcessor->performanceRecord_.setName(currentProcessor->getName());
+            // run the processor, if it needs processing and is ready
+            if (needsProcessing && currentProcessor->isReady()) {
 
-                if (sharedContext_)
-                    sharedContext_->getGLFocus();
-                {
-                    ProfilingBlock block("beforeprocess", currentProcessor->performanceRecord_);
-                    currentProcessor->beforeProcess();
+                // increase iteration counters
+                for (size_t j=0; j<loopPortMap_[currentProcessor].size(); ++j) {
+                    Port* port = loopPortMap_[currentProcessor][j];
+                    // note: modulo is required for nested loops
+                    port->setLoopIteration((port->getLoopIteration()+1) % port->getNumLoopIterations());
                 }
-                if (sharedContext_)
-                    sharedContext_->getGLFocus();
-#ifdef VRN_PRINT_PROFILING
-                currentProcessor->performanceRecord_.getLastSample()->print(0, currentProcessor->getName()+".");
-#endif
+
+                // notify process wrappers
+                for (size_t j=0; j < processWrappers_.size(); ++j)
+                    processWrappers_[j]->beforeProcess(currentProcessor);
                 LGL_ERROR;
-                if (!currentProcessor->isValid())
-                {
-                    ProfilingBlock block("process", currentProcessor->performanceRecord_);
-                    currentProcessor->process();
-                }
+
+                // mark processor as processed during this rendering pass
+                if (processProcessor(currentProcessor, true))
+                    processed.insert(currentProcessor);
+
                 if (sharedContext_)
                     sharedContext_->getGLFocus();
-#ifdef VRN_PRINT_PROFILING
-                currentProcessor->performanceRecord_.getLastSample()->print(0, currentProcessor->getName()+".");
-#endif
+                // notify process wrappers
+                for (size_t j = 0; j < processWrappers_.size(); ++j)
+                    processWrappers_[j]->afterProcess(currentProcessor);
                 LGL_ERROR;
-                {
-                    ProfilingBlock block("afterprocess", currentProcessor->performanceRecord_);
-                    currentProcessor->afterProcess();
+
+                // break loop if network topology has changed (due to changes in loop port configurations)
+                if (checkForInvalidPorts()) {
+                    topologyChanged = true;
+                    break;
                 }
-#ifdef VRN_PRINT_PROFILING
-                currentProcessor->performanceRecord_.getLastSample()->print(0, currentProcessor->getName()+".");
-#endif
-                LGL_ERROR;
-                // mark processor as processed during this rendering pass
-                processed.insert(currentProcessor);
             }
-            catch (VoreenException& e) {
-                LERROR("process(): VoreenException from "
-                    << currentProcessor->getClassName()
-                    << " (" << currentProcessor->getName() << "): " << e.what());
-             }
-             catch (std::exception& e) {
-                LERROR("process(): Exception from "
-                    << currentProcessor->getClassName()
-                    << " (" << currentProcessor->getName() << "): " << e.what());
-             }
-
-             if (sharedContext_)
-                 sharedContext_->getGLFocus();
-             // notify process wrappers
-             for (size_t j = 0; j < processWrappers_.size(); ++j)
-                processWrappers_[j]->afterProcess(currentProcessor);
-             LGL_ERROR;
-
-             // break loop if network topology has changed (due to changes in loop port configurations)
-             if (checkForInvalidPorts()) {
-                 unlock();
-
-                 for (size_t j = 0; j < processWrappers_.size(); ++j)
-                     processWrappers_[j]->afterNetworkProcess();
-                 LGL_ERROR;
-
-                 onNetworkChange();
-                 return;
-             }
-        }
 
-    }   // for (rendering order)
+        }   // for (rendering order)
+    }
+
+    if (topologyChanged) {
+        delete networkSpan;
+        unlock();
+
+        for (size_t j = 0; j < processWrappers_.size(); ++j)
+            processWrappers_[j]->afterNetworkProcess();
+        LGL_ERROR;
+
+        onNetworkChange();
+        return;
+    }
 
     LGL_ERROR;
 
@@ -378,6 +400,12 @@ void NetworkEvaluator::process() {
             (*iter)->setValid();
     LGL_ERROR;
 
+    delete networkSpan;
+    if (Profiler::isGLTimingEnabled()) {
+        Profiler::collectGLQueries();
+        LGL_ERROR;
+    }
+
     unlock();
 
     // notify process wrappers
@@ -447,6 +475,419 @@ void NetworkEvaluator::forceUpdate() {
 // protected methods
 //
 
+bool NetworkEvaluator::processProcessor(Processor* processor, bool contextThread) {
+    processor->performanceRecord_.setName(processor->getName());
+
+    if (contextThread && sharedContext_)
+        sharedContext_->getGLFocus();
+    bool success = callProcessor(processor, &Processor::beforeProcess, "beforeprocess");
+    if (contextThread && sharedContext_)
+        sharedContext_->getGLFocus();
+    if (contextThread) {
+        LGL_ERROR;
+    }
+    if (!success)
+        return false;
+
+    if (!processor->isValid()) {
+        success = callProcessor(processor, &Processor::process, "process");
+        if (contextThread && sharedContext_)
+            sharedContext_->getGLFocus();
+        if (contextThread) {
+            LGL_ERROR;
+        }
+        if (!success)
+            return false;
+    }
+
+    success = callProcessor(processor, &Processor::afterProcess, "afterprocess");
+    if (contextThread) {
+        LGL_ERROR;
+    }
+    return success;
+}
+
+bool NetworkEvaluator::callProcessor(Processor* processor, void (Processor::*stage)(), const std::string& blockName) {
+    try {
+        {
+            ProfilingBlock block(blockName, processor->performanceRecord_);
+            if (processor->usesOpenGL() && Profiler::isGLTimingEnabled() && !Processor::isWorkerThread()) {
+                GLTraceSpan glSpan(processor->getName() + "." + blockName, "processor");
+                (processor->*stage)();
+            }
+            else
+                (processor->*stage)();
+        }
+#ifdef VRN_PRINT_PROFILING
+        processor->performanceRecord_.getLastSample()->print(0, processor->getName()+".");
+#endif
+        return true;
+    }
+    catch (VoreenException& e) {
+        LERROR("process(): VoreenException from "
+            << processor->getClassName()
+            << " (" << processor->getName() << "): " << e.what());
+    }
+    catch (std::exception& e) {
+        LERROR("process(): Exception from "
+            << processor->getClassName()
+            << " (" << processor->getName() << "): " << e.what());
+    }
+    return false;
+}
+
+void NetworkEvaluator::prepareConcurrentProcessing(Processor* processor) {
+    const std::vector<Port*>& inports = processor->getInports();
+    for (size_t i = 0; i < inports.size(); ++i) {
+        VolumePort* volumePort = dynamic_cast<VolumePort*>(inports[i]);
+        if (!volumePort)
+            continue;
+        TraceSpan span(volumePort->getQualifiedName(), "transfer");
+        // converting from a hardware volume requires the context
+        std::vector<const VolumeHandleBase*> volumes = volumePort->getAllData();
+        for (size_t j = 0; j < volumes.size(); ++j) {
+            if (volumes[j])
+                volumes[j]->getRepresentation<Volume>();
+        }
+    }
+
+    // owned output volumes are deleted, when the processor assigns new ones,
+    // so their textures have to be released here
+    const std::vector<Port*>& outports = processor->getOutports();
+    for (size_t i = 0; i < outports.size(); ++i) {
+        VolumePort* volumePort = dynamic_cast<VolumePort*>(outports[i]);
+        if (!volumePort || !volumePort->hasData() || !volumePort->ownsData())
+            continue;
+        VolumeHandle* handle = dynamic_cast<VolumeHandle*>(volumePort->getWritableData());
+        if (handle && handle->hasRepresentation<VolumeGL>())
+            handle->removeRepresentation<VolumeGL>();
+    }
+}
+
+bool NetworkEvaluator::processConcurrently(std::set<Processor*>& processed, bool& topologyChanged) {
+#ifdef _OPENMP
+    if (omp_in_parallel() || omp_get_max_threads() < 2)
+        return false;
+
+    const int numProcessors = static_cast<int>(renderingOrder_.size());
+
+    // loops require the sequential evaluation of the unrolled rendering order
+    std::map<Processor*, int> orderIndex;
+    for (int i = 0; i < numProcessors; ++i) {
+        Processor* processor = renderingOrder_[i];
+        if (!loopPortMap_[processor].empty() || orderIndex.find(processor) != orderIndex.end())
+            return false;
+        orderIndex[processor] = i;
+    }
+
+    // dependencies on preceding processors: port connections, property links
+    // and, for OpenGL processors, the previous OpenGL processor
+    std::vector<std::set<int> > predecessors(numProcessors);
+    int lastGLProcessor = -1;
+    for (int i = 0; i < numProcessors; ++i) {
+        std::vector<Port*> ports = renderingOrder_[i]->getPorts();
+        for (size_t j = 0; j < ports.size(); ++j) {
+            std::vector<const Port*> connected = ports[j]->getConnected();
+            for (size_t k = 0; k < connected.size(); ++k) {
+                std::map<Processor*, int>::const_iterator it = orderIndex.find(connected[k]->getProcessor());
+                if (it != orderIndex.end() && it->second < i)
+                    predecessors[i].insert(it->second);
+            }
+        }
+        if (renderingOrder_[i]->usesOpenGL()) {
+            if (lastGLProcessor >= 0)
+                predecessors[i].insert(lastGLProcessor);
+            lastGLProcessor = i;
+        }
+    }
+    const std::vector<PropertyLink*>& links = network_->getPropertyLinks();
+    for (size_t i = 0; i < links.size(); ++i) {
+        Processor* src = dynamic_cast<Processor*>(links[i]->getSourceProperty()->getOwner());
+        Processor* dest = dynamic_cast<Processor*>(links[i]->getDestinationProperty()->getOwner());
+        std::map<Processor*, int>::const_iterator srcIt = orderIndex.find(src);
+        std::map<Processor*, int>::const_iterator destIt = orderIndex.find(dest);
+        if (srcIt == orderIndex.end() || destIt == orderIndex.end() || srcIt->second == destIt->second)
+            continue;
+        if (srcIt->second < destIt->second)
+            predecessors[destIt->second].insert(srcIt->second);
+        else
+            predecessors[srcIt->second].insert(destIt->second);
+    }
+
+    // only worth the effort, if at least two CPU-only processors to be processed are independent
+    std::vector<std::vector<bool> > reachable(numProcessors, std::vector<bool>(numProcessors, false));
+    for (int i = 0; i < numProcessors; ++i) {
+        for (std::set<int>::const_iterator it = predecessors[i].begin(); it != predecessors[i].end(); ++it) {
+            reachable[i][*it] = true;
+            for (int j = 0; j < *it; ++j)
+                if (reachable[*it][j])
+                    reachable[i][j] = true;
+        }
+    }
+    std::vector<int> candidates;
+    for (int i = 0; i < numProcessors; ++i) {
+        Processor* processor = renderingOrder_[i];
+        if (!processor->usesOpenGL() && processor->isInitialized() && !processor->isValid())
+            candidates.push_back(i);
+    }
+    bool independent = false;
+    for (size_t i = 0; i < candidates.size() && !independent; ++i)
+        for (size_t j = i+1; j < candidates.size() && !independent; ++j)
+            independent = !reachable[candidates[j]][candidates[i]];
+    if (!independent)
+        return false;
+
+    std::vector<std::vector<int> > successors(numProcessors);
+    std::vector<int> numPending(numProcessors);
+    std::vector<int> ready;
+    for (int i = 0; i < numProcessors; ++i) {
+        numPending[i] = static_cast<int>(predecessors[i].size());
+        for (std::set<int>::const_iterator it = predecessors[i].begin(); it != predecessors[i].end(); ++it)
+            successors[*it].push_back(i);
+        if (numPending[i] == 0)
+            ready.push_back(i);
+    }
+
+    // shared between the context thread and the workers, guarded by the mutex;
+    // idle threads wait on the condition until a processor is dispatched or finished
+    tgt::Mutex queueMutex;
+    tgt::Condition queueCondition;
+    std::deque<int> workQueue;
+    std::vector<int> finishedQueue;
+    std::vector<char> succeeded(numProcessors, 0);
+    bool allDispatched = false;
+
+    // progress bars are GUI elements and must not be updated from worker threads
+    std::vector<ProgressBar*> progressBars(static_cast<size_t>(numProcessors), static_cast<ProgressBar*>(0));
+    std::vector<TimeToFinishReporter*> ttfReporters(static_cast<size_t>(numProcessors),
+        static_cast<TimeToFinishReporter*>(0));
+
+    #pragma omp parallel
+    {
+        if (omp_get_thread_num() == 0) {
+            // context thread: runs the OpenGL processors, dispatches the others
+            // and joins them after they have been processed
+            int numDone = 0;
+            int numRunning = 0;
+            bool stopped = false;
+            while (numDone < numProcessors) {
+                bool idle = true;
+
+                std::vector<int> finished;
+                queueMutex.lock();
+                finished.swap(finishedQueue);
+                queueMutex.unlock();
+
+                for (size_t i = 0; i < finished.size(); ++i) {
+                    Processor* processor = renderingOrder_[finished[i]];
+                    processor->progressBar_ = progressBars[finished[i]];
+                    processor->ttfReporter_ = ttfReporters[finished[i]];
+
+                    if (sharedContext_)
+                        sharedContext_->getGLFocus();
+                    if (succeeded[finished[i]] && callProcessor(processor, &Processor::afterProcess, "afterprocess"))
+                        processed.insert(processor);
+                    for (size_t j = 0; j < processWrappers_.size(); ++j)
+                        processWrappers_[j]->afterProcess(processor);
+                    LGL_ERROR;
+
+                    // propagate the invalidations the processor has triggered on its worker
+                    std::vector<Port*> ports = processor->getPorts();
+                    for (size_t j = 0; j < ports.size(); ++j) {
+                        if (ports[j]->invalidationDeferred_) {
+                            TraceSpan span(ports[j]->getQualifiedName(), "transfer");
+                            ports[j]->invalidationDeferred_ = false;
+                            ports[j]->invalidate();
+                        }
+                    }
+
+                    if (!stopped && checkForInvalidPorts())
+                        stopped = true;
+
+                    numRunning--;
+                    numDone++;
+                    for (size_t j = 0; j < successors[finished[i]].size(); ++j) {
+                        if (--numPending[successors[finished[i]][j]] == 0)
+                            ready.push_back(successors[finished[i]][j]);
+                    }
+                    idle = false;
+                }
+
+                std::vector<int> dispatch;
+                dispatch.swap(ready);
+                std::sort(dispatch.begin(), dispatch.end());
+                for (size_t i = 0; i < dispatch.size(); ++i) {
+                    const int index = dispatch[i];
+                    Processor* const processor = renderingOrder_[index];
+                    bool running = false;
+
+                    if (stopped || isSkipped(processor)) {
+                        // network topology has changed: skip the remaining processors,
+                        // OpenGL disabled: skip the processors requiring it
+                    }
+                    else if (!processor->isInitialized()) {
+                        LWARNING("process(): Skipping uninitialized processor '" << processor->getName()
+                                 << "' (" << processor->getClassName() << ")");
+                    }
+                    else if (!processor->isValid() && processor->isReady()) {
+                        for (size_t j = 0; j < processWrappers_.size(); ++j)
+                            processWrappers_[j]->beforeProcess(processor);
+                        LGL_ERROR;
+
+                        if (processor->usesOpenGL()) {
+                            if (processProcessor(processor, true))
+                                processed.insert(processor);
+
+                            if (sharedContext_)
+                                sharedContext_->getGLFocus();
+                            for (size_t j = 0; j < processWrappers_.size(); ++j)
+                                processWrappers_[j]->afterProcess(processor);
+                            LGL_ERROR;
+
+                            if (checkForInvalidPorts())
+                                stopped = true;
+                        }
+                        else {
+                            // only process() is run on a worker, the other stages remain on the context thread
+                            processor->performanceRecord_.setName(processor->getName());
+                            bool runOnWorker = callProcessor(processor, &Processor::beforeProcess, "beforeprocess");
+                            if (runOnWorker && processor->isValid()) {
+                                // restored from cache: nothing left to do on a worker
+                                if (callProcessor(processor, &Processor::afterProcess, "afterprocess"))
+                                    processed.insert(processor);
+                                runOnWorker = false;
+                            }
+
+                            if (!runOnWorker) {
+                                if (sharedContext_)
+                                    sharedContext_->getGLFocus();
+                                for (size_t j = 0; j < processWrappers_.size(); ++j)
+                                    processWrappers_[j]->afterProcess(processor);
+                                LGL_ERROR;
+
+                                if (checkForInvalidPorts())
+                                    stopped = true;
+                            }
+                            else {
+                                prepareConcurrentProcessing(processor);
+                                progressBars[index] = processor->progressBar_;
+                                ttfReporters[index] = processor->ttfReporter_;
+                                processor->progressBar_ = 0;
+                                processor->ttfReporter_ = 0;
+
+                                queueMutex.lock();
+                                workQueue.push_back(index);
+                                queueCondition.notifyAll();
+                                queueMutex.unlock();
+                                numRunning++;
+                                running = true;
+                            }
+                        }
+                    }
+
+                    if (!running) {
+                        numDone++;
+                        for (size_t j = 0; j < successors[index].size(); ++j) {
+                            if (--numPending[successors[index][j]] == 0)
+                                ready.push_back(successors[index][j]);
+                        }
+                    }
+                    idle = false;
+                }
+
+                if (idle && numRunning > 0) {
+                    // nothing to join or dispatch: help out with the queued processors,
+                    // otherwise wait for a worker to finish one
+                    int index = -1;
+                    queueMutex.lock();
+                    if (!workQueue.empty()) {
+                        index = workQueue.front();
+                        workQueue.pop_front();
+                    }
+                    else {
+                        while (finishedQueue.empty())
+                            queueCondition.wait(queueMutex);
+                    }
+                    queueMutex.unlock();
+
+                    if (index >= 0) {
+                        // defer the invalidations like on the workers, which may still read the same ports
+                        Processor::setWorkerThread(true);
+                        bool success = false;
+                        try {
+                            success = callProcessor(renderingOrder_[index], &Processor::process, "process");
+                        }
+                        catch (...) {
+                            LERROR("process(): Unknown exception from "
+                                << renderingOrder_[index]->getClassName()
+                                << " (" << renderingOrder_[index]->getName() << ")");
+                        }
+                        Processor::setWorkerThread(false);
+                        succeeded[index] = success;
+
+                        queueMutex.lock();
+                        finishedQueue.push_back(index);
+                        queueMutex.unlock();
+                    }
+                }
+            }
+
+            topologyChanged = stopped;
+
+            queueMutex.lock();
+            allDispatched = true;
+            queueCondition.notifyAll();
+            queueMutex.unlock();
+        }
+        else {
+            // worker thread: processes the dispatched CPU-only processors
+            Processor::setWorkerThread(true);
+            if (Profiler::isEnabled())
+                Profiler::setThreadName("NetworkEvaluator worker " + itos(omp_get_thread_num()));
+            while (true) {
+                // block until a processor is dispatched or the evaluation is done
+                int index = -1;
+                queueMutex.lock();
+                while (workQueue.empty() && !allDispatched)
+                    queueCondition.wait(queueMutex);
+                if (!workQueue.empty()) {
+                    index = workQueue.front();
+                    workQueue.pop_front();
+                }
+                queueMutex.unlock();
+
+                if (index < 0)
+                    break;
+
+                bool success = false;
+                try {
+                    success = callProcessor(renderingOrder_[index], &Processor::process, "process");
+                }
+                catch (...) {
+                    LERROR("process(): Unknown exception from "
+                        << renderingOrder_[index]->getClassName()
+                        << " (" << renderingOrder_[index]->getName() << ")");
+                }
+                succeeded[index] = success;
+
+                queueMutex.lock();
+                finishedQueue.push_back(index);
+                queueCondition.notifyAll();
+                queueMutex.unlock();
+            }
+            Processor::setWorkerThread(false);
+        }
+    }
+
+    return true;
+#else
+    // the evaluation is sequential without OpenMP
+    (void)processed;
+    (void)topologyChanged;
+    return false;
+#endif
+}
+
 void NetworkEvaluator::defineRenderingOrder() {
 
     tgtAssert(network_, "No processor network");
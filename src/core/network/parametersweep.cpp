@@ -0,0 +1,551 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#include "voreen/core/network/parametersweep.h"
+#include "voreen/core/network/processornetwork.h"
+#include "voreen/core/ports/volumeport.h"
+#include "voreen/core/processors/profiling.h"
+#include "voreen/core/properties/cameraproperty.h"
+#include "voreen/core/properties/volumehandleproperty.h"
+#include "voreen/core/properties/link/propertylink.h"
+#include "voreen/core/utils/variant.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace voreen {
+
+const std::string ParameterSweep::loggerCat_("voreen.ParameterSweep");
+
+namespace {
+
+// processors whose inports are reachable from the passed processors' outports, including themselves
+std::set<Processor*> getDownstreamProcessors(const std::set<Processor*>& processors) {
+    std::set<Processor*> result;
+    std::vector<Processor*> stack(processors.begin(), processors.end());
+    while (!stack.empty()) {
+        Processor* processor = stack.back();
+        stack.pop_back();
+        if (!result.insert(processor).second)
+            continue;
+        const std::vector<Port*>& outports = processor->getOutports();
+        for (size_t i = 0; i < outports.size(); ++i) {
+            std::vector<const Port*> connected = outports[i]->getConnected();
+            for (size_t j = 0; j < connected.size(); ++j)
+                stack.push_back(connected[j]->getProcessor());
+        }
+    }
+    return result;
+}
+
+// number of processors the passed processor depends on through its inports
+size_t getNumUpstreamProcessors(Processor* processor) {
+    std::set<Processor*> visited;
+    std::vector<Processor*> stack(1, processor);
+    while (!stack.empty()) {
+        Processor* current = stack.back();
+        stack.pop_back();
+        if (!visited.insert(current).second)
+            continue;
+        const std::vector<Port*>& inports = current->getInports();
+        for (size_t i = 0; i < inports.size(); ++i) {
+            std::vector<const Port*> connected = inports[i]->getConnected();
+            for (size_t j = 0; j < connected.size(); ++j)
+                stack.push_back(connected[j]->getProcessor());
+        }
+    }
+    return visited.size() - 1;
+}
+
+struct UpstreamComparator {
+    std::map<Processor*, size_t>* numUpstream_;
+    bool operator()(Processor* a, Processor* b) const {
+        return (*numUpstream_)[a] < (*numUpstream_)[b];
+    }
+};
+
+struct AffectedComparator {
+    const std::vector<std::set<Processor*> >* affected_;
+    bool operator()(size_t a, size_t b) const {
+        return (*affected_)[a].size() > (*affected_)[b].size();
+    }
+};
+
+std::string toCSVField(const std::string& field) {
+    if (field.find_first_of(",\"\n") == std::string::npos)
+        return field;
+    std::string result = "\"";
+    for (size_t i = 0; i < field.size(); ++i) {
+        if (field[i] == '"')
+            result += '"';
+        result += field[i];
+    }
+    return result + "\"";
+}
+
+} // namespace
+
+ParameterSweep::ParameterSweep(ProcessorNetwork* network, NetworkEvaluator* evaluator)
+    : network_(network)
+    , evaluator_(evaluator)
+    , maxCachedResults_(32)
+    , numCachedResults_(0)
+    , currentTiming_(0)
+    , numRestored_(0)
+{
+    tgtAssert(network_, "No network");
+    tgtAssert(evaluator_, "No evaluator");
+}
+
+ParameterSweep::~ParameterSweep() {
+    clearResults();
+}
+
+void ParameterSweep::addParameter(const std::string& propertyName, const std::vector<std::string>& values)
+    throw (VoreenException)
+{
+    Property* property = findProperty(network_, propertyName);
+    if (!property)
+        throw VoreenException("No property " + propertyName + " in network");
+    if (values.empty())
+        throw VoreenException("No values passed for property " + propertyName);
+
+    Parameter parameter;
+    parameter.property_ = property;
+    parameter.name_ = propertyName;
+    parameter.values_ = values;
+    parameters_.push_back(parameter);
+}
+
+size_t ParameterSweep::getNumParameters() const {
+    return parameters_.size();
+}
+
+std::string ParameterSweep::getParameterName(size_t parameter) const {
+    tgtAssert(parameter < parameters_.size(), "Invalid parameter");
+    return parameters_[parameter].name_;
+}
+
+size_t ParameterSweep::getNumPoints() const {
+    if (parameters_.empty())
+        return 0;
+    size_t numPoints = 1;
+    for (size_t i = 0; i < parameters_.size(); ++i)
+        numPoints *= parameters_[i].values_.size();
+    return numPoints;
+}
+
+std::vector<std::string> ParameterSweep::getPointValues(size_t point) const {
+    std::vector<size_t> valueIndices = getValueIndices(point);
+    std::vector<std::string> values(parameters_.size());
+    for (size_t k = 0; k < order_.size(); ++k)
+        values[order_[k]] = parameters_[order_[k]].values_[valueIndices[k]];
+    return values;
+}
+
+void ParameterSweep::setMaxCachedResults(size_t maxResults) {
+    maxCachedResults_ = maxResults;
+    evictResults();
+}
+
+size_t ParameterSweep::getNumRestoredResults() const {
+    return numRestored_;
+}
+
+void ParameterSweep::analyze() {
+    const std::vector<PropertyLink*>& links = network_->getPropertyLinks();
+
+    // processors invalidated by each parameter: its owner, processors linked to it and everything downstream
+    std::vector<std::set<Processor*> > affected(parameters_.size());
+    for (size_t i = 0; i < parameters_.size(); ++i) {
+        std::set<Property*> properties;
+        std::vector<Property*> stack(1, parameters_[i].property_);
+        while (!stack.empty()) {
+            Property* property = stack.back();
+            stack.pop_back();
+            if (!properties.insert(property).second)
+                continue;
+            for (size_t j = 0; j < links.size(); ++j) {
+                if (links[j]->getSourceProperty() == property)
+                    stack.push_back(links[j]->getDestinationProperty());
+            }
+        }
+        std::set<Processor*> owners;
+        for (std::set<Property*>::const_iterator it = properties.begin(); it != properties.end(); ++it) {
+            if (Processor* owner = dynamic_cast<Processor*>((*it)->getOwner()))
+                owners.insert(owner);
+        }
+        affected[i] = getDownstreamProcessors(owners);
+        parameters_[i].affected_ = affected[i];
+    }
+
+    // upstream parameters vary slowest
+    order_.clear();
+    for (size_t i = 0; i < parameters_.size(); ++i)
+        order_.push_back(i);
+    AffectedComparator affectedComparator;
+    affectedComparator.affected_ = &affected;
+    std::stable_sort(order_.begin(), order_.end(), affectedComparator);
+
+    // memoize processors that are recomputed for recurring parameter values,
+    // i.e., that do not depend on a prefix of the parameters in visiting order
+    memoized_.clear();
+    dependencies_.clear();
+    if (maxCachedResults_ == 0)
+        return;
+    std::map<Processor*, size_t> numUpstream;
+    const std::vector<Processor*>& processors = network_->getProcessors();
+    for (size_t i = 0; i < processors.size(); ++i) {
+        Processor* processor = processors[i];
+
+        std::vector<size_t> dependencies;
+        for (size_t k = 0; k < order_.size(); ++k) {
+            if (parameters_[order_[k]].affected_.count(processor))
+                dependencies.push_back(k);
+        }
+        if (dependencies.empty() || dependencies.back() + 1 == dependencies.size())
+            continue;
+
+        const std::vector<Port*>& outports = processor->getOutports();
+        bool volumeOutputs = !outports.empty() && processor->getCoProcessorOutports().empty();
+        for (size_t j = 0; j < outports.size() && volumeOutputs; ++j)
+            volumeOutputs = dynamic_cast<VolumePort*>(outports[j]) && !outports[j]->isLoopPort();
+        const std::vector<Port*>& inports = processor->getInports();
+        for (size_t j = 0; j < inports.size() && volumeOutputs; ++j)
+            volumeOutputs = !inports[j]->isLoopPort();
+        if (!volumeOutputs)
+            continue;
+
+        memoized_.push_back(processor);
+        dependencies_[processor] = dependencies;
+        numUpstream[processor] = getNumUpstreamProcessors(processor);
+    }
+
+    // restore in topological order, so that restored results are not invalidated by upstream ones
+    UpstreamComparator upstreamComparator;
+    upstreamComparator.numUpstream_ = &numUpstream;
+    std::stable_sort(memoized_.begin(), memoized_.end(), upstreamComparator);
+
+    for (size_t i = 0; i < memoized_.size(); ++i)
+        LDEBUG("Memoizing results of " << memoized_[i]->getName());
+}
+
+std::vector<size_t> ParameterSweep::getValueIndices(size_t point) const {
+    std::vector<size_t> valueIndices(order_.size());
+    for (size_t k = order_.size(); k > 0; --k) {
+        size_t numValues = parameters_[order_[k-1]].values_.size();
+        valueIndices[k-1] = point % numValues;
+        point /= numValues;
+    }
+    return valueIndices;
+}
+
+std::string ParameterSweep::getKey(Processor* processor, const std::vector<size_t>& valueIndices) const {
+    std::map<Processor*, std::vector<size_t> >::const_iterator it = dependencies_.find(processor);
+    tgtAssert(it != dependencies_.end(), "Processor not memoized");
+    std::ostringstream key;
+    for (size_t i = 0; i < it->second.size(); ++i)
+        key << valueIndices[it->second[i]] << " ";
+    return key.str();
+}
+
+void ParameterSweep::run() {
+    analyze();
+    timings_.clear();
+    numRestored_ = 0;
+
+    size_t numPoints = getNumPoints();
+    LINFO("Sweeping " << numPoints << " points, " << memoized_.size() << " processor(s) memoized");
+
+    evaluator_->addProcessWrapper(this);
+
+    std::vector<size_t> previousIndices;
+    for (size_t point = 0; point < numPoints; ++point) {
+        // assign the parameters that have changed
+        std::vector<size_t> valueIndices = getValueIndices(point);
+        for (size_t k = 0; k < order_.size(); ++k) {
+            if (!previousIndices.empty() && previousIndices[k] == valueIndices[k])
+                continue;
+            const Parameter& parameter = parameters_[order_[k]];
+            try {
+                setPropertyValue(parameter.property_, parameter.values_[valueIndices[k]]);
+            }
+            catch (const VoreenException& e) {
+                LERROR("Failed to assign '" << parameter.values_[valueIndices[k]] << "' to "
+                       << parameter.name_ << ": " << e.what());
+            }
+        }
+        previousIndices = valueIndices;
+
+        PointTiming timing;
+        timing.point_ = point;
+        timing.numRestored_ = restoreResults(valueIndices, point);
+        numRestored_ += timing.numRestored_;
+
+        currentTiming_ = &timing;
+        double start = Profiler::now();
+        evaluator_->process();
+        timing.duration_ = Profiler::now() - start;
+        currentTiming_ = 0;
+        timing.numProcessed_ = timing.processorDurations_.size();
+        timings_.push_back(timing);
+
+        storeResults(valueIndices, point);
+
+        std::vector<ParameterSweepObserver*> observers = getObservers();
+        for (size_t i = 0; i < observers.size(); ++i)
+            observers[i]->sweepPointEvaluated(this, point);
+    }
+
+    evaluator_->removeProcessWrapper(this);
+    LINFO("Sweep finished, " << numRestored_ << " processor evaluation(s) saved by memoization");
+}
+
+size_t ParameterSweep::restoreResults(const std::vector<size_t>& valueIndices, size_t point) {
+    size_t numRestored = 0;
+    for (size_t i = 0; i < memoized_.size(); ++i) {
+        Processor* processor = memoized_[i];
+        std::string key = getKey(processor, valueIndices);
+
+        // unchanged parameters: the processor has not been invalidated by them
+        std::map<Processor*, std::string>::iterator current = currentKeys_.find(processor);
+        if (current != currentKeys_.end() && current->second == key)
+            continue;
+
+        std::map<std::string, CachedResult>& results = results_[processor];
+        std::map<std::string, CachedResult>::iterator it = results.find(key);
+        if (it == results.end())
+            continue;
+
+        // invalidates the downstream processors
+        const std::vector<Port*>& outports = processor->getOutports();
+        for (size_t j = 0; j < outports.size(); ++j)
+            static_cast<VolumePort*>(outports[j])->setData(it->second.volumes_[j], false);
+        processor->setValid();
+
+        it->second.lastUse_ = point;
+        currentKeys_[processor] = key;
+        numRestored++;
+    }
+    return numRestored;
+}
+
+void ParameterSweep::storeResults(const std::vector<size_t>& valueIndices, size_t point) {
+    for (size_t i = 0; i < memoized_.size(); ++i) {
+        Processor* processor = memoized_[i];
+        if (!processor->isValid()) {
+            currentKeys_.erase(processor);
+            continue;
+        }
+
+        std::string key = getKey(processor, valueIndices);
+        currentKeys_[processor] = key;
+        std::map<std::string, CachedResult>& results = results_[processor];
+        std::map<std::string, CachedResult>::iterator it = results.find(key);
+        if (it != results.end()) {
+            it->second.lastUse_ = point;
+            continue;
+        }
+
+        // take over the results, if the outports own them
+        CachedResult result;
+        result.lastUse_ = point;
+        const std::vector<Port*>& outports = processor->getOutports();
+        bool owned = true;
+        for (size_t j = 0; j < outports.size() && owned; ++j) {
+            VolumePort* port = static_cast<VolumePort*>(outports[j]);
+            owned = port->hasData() && port->ownsData();
+            result.volumes_.push_back(port->getData());
+        }
+        if (!owned)
+            continue;
+
+        for (size_t j = 0; j < outports.size(); ++j)
+            static_cast<VolumePort*>(outports[j])->setDataOwnership(false);
+        results[key] = result;
+        numCachedResults_++;
+    }
+
+    evictResults();
+}
+
+bool ParameterSweep::isInPort(Processor* processor, const CachedResult& result) const {
+    const std::vector<Port*>& outports = processor->getOutports();
+    for (size_t i = 0; i < outports.size() && i < result.volumes_.size(); ++i) {
+        if (static_cast<VolumePort*>(outports[i])->getData() == result.volumes_[i])
+            return true;
+    }
+    return false;
+}
+
+void ParameterSweep::evictResults() {
+    while (numCachedResults_ > maxCachedResults_) {
+        Processor* lruProcessor = 0;
+        std::map<std::string, CachedResult>::iterator lru;
+        for (std::map<Processor*, std::map<std::string, CachedResult> >::iterator it = results_.begin(); it != results_.end(); ++it) {
+            for (std::map<std::string, CachedResult>::iterator entry = it->second.begin(); entry != it->second.end(); ++entry) {
+                if ((!lruProcessor || entry->second.lastUse_ < lru->second.lastUse_) && !isInPort(it->first, entry->second)) {
+                    lruProcessor = it->first;
+                    lru = entry;
+                }
+            }
+        }
+        if (!lruProcessor)
+            break;
+
+        for (size_t i = 0; i < lru->second.volumes_.size(); ++i)
+            delete lru->second.volumes_[i];
+        results_[lruProcessor].erase(lru);
+        numCachedResults_--;
+    }
+}
+
+void ParameterSweep::clearResults() {
+    for (std::map<Processor*, std::map<std::string, CachedResult> >::iterator it = results_.begin(); it != results_.end(); ++it) {
+        const std::vector<Port*>& outports = it->first->getOutports();
+        for (std::map<std::string, CachedResult>::iterator entry = it->second.begin(); entry != it->second.end(); ++entry) {
+            for (size_t i = 0; i < entry->second.volumes_.size(); ++i) {
+                VolumePort* port = static_cast<VolumePort*>(outports[i]);
+                if (port->getData() == entry->second.volumes_[i])
+                    port->setDataOwnership(true);
+                else
+                    delete entry->second.volumes_[i];
+            }
+        }
+    }
+    results_.clear();
+    currentKeys_.clear();
+    numCachedResults_ = 0;
+}
+
+void ParameterSweep::beforeProcess(Processor* p) {
+    processStart_[p] = Profiler::now();
+}
+
+void ParameterSweep::afterProcess(Processor* p) {
+    std::map<const Processor*, double>::iterator it = processStart_.find(p);
+    if (!currentTiming_ || it == processStart_.end())
+        return;
+    // loops process a processor several times per point
+    currentTiming_->processorDurations_[p] += Profiler::now() - it->second;
+    processStart_.erase(it);
+}
+
+bool ParameterSweep::writeTimings(const std::string& filename) const {
+    std::ofstream file(filename.c_str());
+    if (!file) {
+        LERROR("Unable to open file " << filename << " for writing");
+        return false;
+    }
+
+    // one column per processor processed at any point, in network order
+    std::vector<const Processor*> processors;
+    for (size_t i = 0; i < network_->getProcessors().size(); ++i) {
+        const Processor* processor = network_->getProcessors()[i];
+        for (size_t j = 0; j < timings_.size(); ++j) {
+            if (timings_[j].processorDurations_.count(processor)) {
+                processors.push_back(processor);
+                break;
+            }
+        }
+    }
+
+    file << "point";
+    for (size_t i = 0; i < parameters_.size(); ++i)
+        file << "," << toCSVField(parameters_[i].name_);
+    file << ",total [ms],processed,restored";
+    for (size_t i = 0; i < processors.size(); ++i)
+        file << "," << toCSVField(processors[i]->getName() + " [ms]");
+    file << "\n";
+
+    for (size_t i = 0; i < timings_.size(); ++i) {
+        const PointTiming& timing = timings_[i];
+        file << timing.point_;
+        std::vector<std::string> values = getPointValues(timing.point_);
+        for (size_t j = 0; j < values.size(); ++j)
+            file << "," << toCSVField(values[j]);
+        file << "," << timing.duration_ * 1000.0 << "," << timing.numProcessed_ << "," << timing.numRestored_;
+        for (size_t j = 0; j < processors.size(); ++j) {
+            file << ",";
+            std::map<const Processor*, double>::const_iterator it = timing.processorDurations_.find(processors[j]);
+            if (it != timing.processorDurations_.end())
+                file << it->second * 1000.0;
+        }
+        file << "\n";
+    }
+
+    return file.good();
+}
+
+Property* ParameterSweep::findProperty(const ProcessorNetwork* network, const std::string& propertyName) {
+    // processor names may contain dots, property ids do not
+    size_t separator = propertyName.rfind('.');
+    if (separator == std::string::npos)
+        return 0;
+    Processor* processor = network->getProcessor(propertyName.substr(0, separator));
+    return (processor ? processor->getProperty(propertyName.substr(separator + 1)) : 0);
+}
+
+void ParameterSweep::setPropertyValue(Property* property, const std::string& value) throw (VoreenException) {
+    tgtAssert(property, "null pointer passed");
+    try {
+        if (VolumeHandleProperty* volumeProperty = dynamic_cast<VolumeHandleProperty*>(property)) {
+            volumeProperty->loadVolume(value);
+        }
+        else if (CameraProperty* cameraProperty = dynamic_cast<CameraProperty*>(property)) {
+            std::string values = value;
+            for (size_t i = 0; i < values.size(); ++i) {
+                if (values[i] == ',' || values[i] == '(' || values[i] == ')')
+                    values[i] = ' ';
+            }
+            std::istringstream stream(values);
+            tgt::vec3 position, focus, up;
+            if (!(stream >> position.x >> position.y >> position.z
+                         >> focus.x >> focus.y >> focus.z
+                         >> up.x >> up.y >> up.z))
+                throw VoreenException("Invalid camera: " + value);
+            tgt::Camera camera = cameraProperty->get();
+            camera.setPosition(position);
+            camera.setFocus(focus);
+            camera.setUpVector(up);
+            cameraProperty->set(camera);
+        }
+        else {
+            property->setVariant(Variant(value));
+        }
+    }
+    catch (const VoreenException&) {
+        throw;
+    }
+    catch (const std::exception& e) {
+        throw VoreenException(e.what());
+    }
+}
+
+} // namespace voreen
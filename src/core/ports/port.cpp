@@ -51,6 +51,7 @@ Port::Port(const std::string& name, PortDirection direction, bool allowMultipleC
     , numLoopIterations_(1)
     , currentLoopIteration_(0)
     , initialized_(false)
+    , invalidationDeferred_(false)
 {
     if (isOutport())
         allowMultipleConnections_ = true;
@@ -240,6 +241,11 @@ bool Port::isConnectedTo(const Port* port) const {
 void Port::invalidate() {
     hasChanged_ = true;
     if (isOutport()) {
+        // successors must not be touched from a worker thread
+        if (Processor::isWorkerThread()) {
+            invalidationDeferred_ = true;
+            return;
+        }
         for (size_t i = 0; i <  connectedPorts_.size(); ++i)
              connectedPorts_[i]->invalidate();
     }
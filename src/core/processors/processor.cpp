@@ -50,6 +50,10 @@
 
 #include <sstream>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using tgt::vec3;
 using tgt::vec4;
 using tgt::Color;
@@ -269,6 +273,38 @@ bool Processor::isUtility() const {
     return false;
 }
 
+bool Processor::usesOpenGL() const {
+    return true;
+}
+
+bool Processor::requiresOpenGL() const {
+    return usesOpenGL();
+}
+
+#ifdef _OPENMP
+namespace {
+    // set for the threads the NetworkEvaluator runs CPU-only processors on
+    bool workerThread_ = false;
+    #pragma omp threadprivate(workerThread_)
+}
+#endif
+
+bool Processor::isWorkerThread() {
+#ifdef _OPENMP
+    return workerThread_;
+#else
+    return false;
+#endif
+}
+
+void Processor::setWorkerThread(bool workerThread) {
+#ifdef _OPENMP
+    workerThread_ = workerThread;
+#else
+    tgtAssert(!workerThread, "worker threads require OpenMP");
+#endif
+}
+
 const std::vector<Port*>& Processor::getInports() const {
     return inports_;
 }
@@ -28,16 +28,183 @@
 
 #include "voreen/core/processors/profiling.h"
 #include <iomanip>
+#include <sstream>
+#include <fstream>
+#include <map>
+#include <algorithm>
 #include "tgt/tgt_gl.h"
 #include "tgt/logmanager.h"
+#include "tgt/mutex.h"
 
-#ifdef _MSC_VER  // high-performance counter
+#ifdef WIN32  // high-performance counter
 #include <windows.h>
 #include <winbase.h>
+#elif defined(__APPLE__)
+#include <mach/mach_time.h>
+#endif
+
+#ifdef _MSC_VER
+#define VRN_PROFILER_THREAD_LOCAL __declspec(thread)
+#else
+#define VRN_PROFILER_THREAD_LOCAL __thread
 #endif
 
 namespace voreen {
 
+namespace {
+
+/// Absolute time of the monotonic high-resolution clock in seconds.
+double readClock() {
+#ifdef WIN32
+    static LARGE_INTEGER frequency;
+    static bool hasFrequency = (QueryPerformanceFrequency(&frequency) != 0);
+    LARGE_INTEGER counter;
+    if (hasFrequency && QueryPerformanceCounter(&counter))
+        return counter.QuadPart / static_cast<double>(frequency.QuadPart);
+    else
+        return GetTickCount() / 1000.0;
+#elif defined(__APPLE__)
+    static mach_timebase_info_data_t timebase;
+    if (timebase.denom == 0)
+        mach_timebase_info(&timebase);
+    return mach_absolute_time() * (static_cast<double>(timebase.numer) / timebase.denom) * 1e-9;
+#else
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+#endif
+}
+
+// initialized before main(), so that now() needs no synchronization
+const double clockEpoch = readClock();
+
+/**
+ * Events of a single thread. The mutex is only contended while the events
+ * are read, since each buffer is written by its own thread only.
+ */
+struct ThreadBuffer {
+    tgt::Mutex mutex_;
+    std::vector<Profiler::Event> events_;
+    size_t capacity_;
+    size_t next_;           ///< slot to be overwritten next, once the buffer is full
+    int thread_;
+    std::string threadName_;
+
+    void add(const std::string& name, const std::string& category, double start, double duration) {
+        tgt::MutexLock lock(mutex_);
+        Profiler::Event* event;
+        if (events_.size() < capacity_) {
+            events_.push_back(Profiler::Event());
+            event = &events_.back();
+        }
+        else {
+            event = &events_[next_];
+            next_ = (next_ + 1) % capacity_;
+        }
+        // assignment reuses the string buffers of overwritten events
+        event->name_ = name;
+        event->category_ = category;
+        event->start_ = start;
+        event->duration_ = duration;
+        event->thread_ = thread_;
+    }
+
+    void clear() {
+        tgt::MutexLock lock(mutex_);
+        events_.clear();
+        next_ = 0;
+    }
+};
+
+struct PendingGLQuery {
+    std::string name_;
+    std::string category_;
+    GLuint queries_[2];
+};
+
+struct ProfilerState {
+    tgt::Mutex mutex_;
+    std::vector<ThreadBuffer*> buffers_;    ///< buffers of all threads that have recorded events
+    ThreadBuffer gpuBuffer_;
+    size_t bufferSize_;
+
+    // accessed by the thread holding the GL context only
+    std::vector<PendingGLQuery> pendingQueries_;
+    bool glCalibrated_;
+    double glOffset_;                       ///< CPU time of GPU timestamp zero
+
+    ProfilerState() : bufferSize_(1 << 16), glCalibrated_(false), glOffset_(0.0) {
+        gpuBuffer_.capacity_ = bufferSize_;
+        gpuBuffer_.next_ = 0;
+        gpuBuffer_.thread_ = Profiler::gpuThread;
+        gpuBuffer_.threadName_ = "GPU";
+    }
+
+    ~ProfilerState() {
+        for (size_t i = 0; i < buffers_.size(); ++i)
+            delete buffers_[i];
+    }
+};
+
+// Constructed on first use. Profiler::setEnabled() is expected to be called
+// by the main thread before any worker records, which makes this safe.
+ProfilerState& profilerState() {
+    static ProfilerState state;
+    return state;
+}
+
+VRN_PROFILER_THREAD_LOCAL ThreadBuffer* threadBuffer = 0;
+
+ThreadBuffer* getThreadBuffer() {
+    if (!threadBuffer) {
+        ProfilerState& state = profilerState();
+        tgt::MutexLock lock(state.mutex_);
+        ThreadBuffer* buffer = new ThreadBuffer();
+        buffer->capacity_ = state.bufferSize_;
+        buffer->next_ = 0;
+        buffer->thread_ = static_cast<int>(state.buffers_.size());
+        state.buffers_.push_back(buffer);
+        threadBuffer = buffer;
+    }
+    return threadBuffer;
+}
+
+bool eventStartLess(const Profiler::Event& a, const Profiler::Event& b) {
+    return a.start_ < b.start_;
+}
+
+std::string escapeJSON(const std::string& str) {
+    std::string result;
+    result.reserve(str.size());
+    for (size_t i = 0; i < str.size(); ++i) {
+        char c = str[i];
+        if (c == '"' || c == '\\') {
+            result += '\\';
+            result += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+            result += ' ';
+        else
+            result += c;
+    }
+    return result;
+}
+
+struct SpanStatistics {
+    std::string name_;
+    std::string category_;
+    size_t count_;
+    double total_;
+    double min_;
+    double max_;
+};
+
+bool statisticsTotalGreater(const SpanStatistics& a, const SpanStatistics& b) {
+    return a.total_ > b.total_;
+}
+
+} // namespace
+
 //const std::string ProfilingBlock::loggerCat_ = "voreen.ProfilingBlock";
 const std::string PerformanceSample::loggerCat_ = "voreen.PerformanceSample";
 
@@ -220,46 +387,295 @@ ProfilingBlock::ProfilingBlock(std::string name, PerformanceRecord& pr) : name_(
     pr_.startBlock((const ProfilingBlock* const) this);
     //glFinish();
 
-#ifdef _MSC_VER  // use high-performance counter on windows, if available
-    if (QueryPerformanceFrequency(&hpfTicksPerSecond_) && QueryPerformanceCounter(&hpfStart_)) {
-        useHpf_ = true;
-    }
-    else { // hpf not available
-        useHpf_ = false;
-        start_ = clock();
-    }
-#else
-    start_ = clock();
-#endif
+    // wall clock instead of clock(), which measures the CPU time of the
+    // whole process and thereby includes concurrently running threads
+    start_ = Profiler::now();
 }
 
 ProfilingBlock::~ProfilingBlock() {
     //glFinish();
-#ifdef _MSC_VER
-    if (useHpf_)
-        QueryPerformanceCounter(&hpfEnd_);
-    else
-        end_ = clock();
-#else
-    end_ = clock();
-#endif
+    end_ = Profiler::now();
     //LINFO("Finishing Block " << name_);
     pr_.endBlock((const ProfilingBlock* const)this);
+
+    if (Profiler::isEnabled()) {
+        if (pr_.getName().empty())
+            Profiler::addEvent(name_, "processor", start_, end_ - start_);
+        else
+            Profiler::addEvent(pr_.getName() + "." + name_, "processor", start_, end_ - start_);
+    }
 }
 
 float ProfilingBlock::getTime() const {
-#ifdef _MSC_VER
-    if (useHpf_)
-        return ((hpfEnd_.QuadPart-hpfStart_.QuadPart) / static_cast<float>(hpfTicksPerSecond_.QuadPart));
-    else
-        return ((end_-start_) / static_cast<float>(CLOCKS_PER_SEC));
-#else
-    return ((end_-start_) / static_cast<float>(CLOCKS_PER_SEC));
-#endif
+    return static_cast<float>(end_ - start_);
 }
 
 std::string ProfilingBlock::getName() const {
     return name_;
 }
 
+//----------------------------------------------------------------
+
+const std::string Profiler::loggerCat_ = "voreen.Profiler";
+bool Profiler::enabled_ = false;
+bool Profiler::glTimingEnabled_ = false;
+
+void Profiler::setEnabled(bool enabled) {
+    profilerState();
+    enabled_ = enabled;
+}
+
+bool Profiler::isEnabled() {
+    return enabled_;
+}
+
+void Profiler::setGLTimingEnabled(bool enabled) {
+    if (enabled && !GLEW_ARB_timer_query) {
+        LWARNING("GL timing requires GL_ARB_timer_query, which is not supported");
+        enabled = false;
+    }
+    glTimingEnabled_ = enabled;
+    if (!enabled)
+        collectGLQueries(true);
+}
+
+bool Profiler::isGLTimingEnabled() {
+    return glTimingEnabled_;
+}
+
+void Profiler::setBufferSize(size_t numEvents) {
+    ProfilerState& state = profilerState();
+    tgt::MutexLock lock(state.mutex_);
+    state.bufferSize_ = (numEvents > 0 ? numEvents : 1);
+}
+
+double Profiler::now() {
+    return readClock() - clockEpoch;
+}
+
+void Profiler::addEvent(const std::string& name, const std::string& category, double start, double duration) {
+    if (!enabled_)
+        return;
+    getThreadBuffer()->add(name, category, start, duration);
+}
+
+void Profiler::setThreadName(const std::string& name) {
+    ThreadBuffer* buffer = getThreadBuffer();
+    tgt::MutexLock lock(buffer->mutex_);
+    buffer->threadName_ = name;
+}
+
+void Profiler::addGLQuery(const std::string& name, const std::string& category,
+                          unsigned int startQuery, unsigned int endQuery)
+{
+    PendingGLQuery query;
+    query.name_ = name;
+    query.category_ = category;
+    query.queries_[0] = startQuery;
+    query.queries_[1] = endQuery;
+    profilerState().pendingQueries_.push_back(query);
+}
+
+void Profiler::collectGLQueries(bool wait) {
+    ProfilerState& state = profilerState();
+    if (state.pendingQueries_.empty())
+        return;
+
+    if (!state.glCalibrated_) {
+        // map GPU timestamps onto the CPU clock by a timestamp taken on an idle pipeline
+        glFinish();
+        GLuint query;
+        glGenQueries(1, &query);
+        glQueryCounter(query, GL_TIMESTAMP);
+        GLuint64 timestamp = 0;
+        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &timestamp);
+        state.glOffset_ = now() - timestamp * 1e-9;
+        glDeleteQueries(1, &query);
+        state.glCalibrated_ = true;
+    }
+
+    // queries finish in issue order
+    size_t numCollected = 0;
+    for (; numCollected < state.pendingQueries_.size(); ++numCollected) {
+        PendingGLQuery& query = state.pendingQueries_[numCollected];
+        if (!wait) {
+            GLint available = 0;
+            glGetQueryObjectiv(query.queries_[1], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available)
+                break;
+        }
+        GLuint64 start = 0;
+        GLuint64 end = 0;
+        glGetQueryObjectui64v(query.queries_[0], GL_QUERY_RESULT, &start);
+        glGetQueryObjectui64v(query.queries_[1], GL_QUERY_RESULT, &end);
+        glDeleteQueries(2, query.queries_);
+        if (enabled_)
+            state.gpuBuffer_.add(query.name_, query.category_, state.glOffset_ + start * 1e-9,
+                                 (end > start ? (end - start) * 1e-9 : 0.0));
+    }
+    state.pendingQueries_.erase(state.pendingQueries_.begin(), state.pendingQueries_.begin() + numCollected);
+}
+
+std::vector<Profiler::Event> Profiler::getEvents() {
+    ProfilerState& state = profilerState();
+    std::vector<ThreadBuffer*> buffers;
+    {
+        tgt::MutexLock lock(state.mutex_);
+        buffers = state.buffers_;
+    }
+    buffers.push_back(&state.gpuBuffer_);
+
+    std::vector<Event> events;
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        tgt::MutexLock lock(buffers[i]->mutex_);
+        events.insert(events.end(), buffers[i]->events_.begin(), buffers[i]->events_.end());
+    }
+    std::stable_sort(events.begin(), events.end(), eventStartLess);
+    return events;
+}
+
+void Profiler::clear() {
+    ProfilerState& state = profilerState();
+    std::vector<ThreadBuffer*> buffers;
+    {
+        tgt::MutexLock lock(state.mutex_);
+        buffers = state.buffers_;
+    }
+    for (size_t i = 0; i < buffers.size(); ++i)
+        buffers[i]->clear();
+    state.gpuBuffer_.clear();
+}
+
+bool Profiler::writeChromeTrace(const std::string& filename) {
+    std::ofstream file(filename.c_str());
+    if (!file.good()) {
+        LERROR("Failed to open trace file for writing: " << filename);
+        return false;
+    }
+
+    ProfilerState& state = profilerState();
+    std::vector<ThreadBuffer*> buffers;
+    {
+        tgt::MutexLock lock(state.mutex_);
+        buffers = state.buffers_;
+    }
+    buffers.push_back(&state.gpuBuffer_);
+
+    file << "{\"traceEvents\":[" << std::endl;
+    bool first = true;
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        tgt::MutexLock lock(buffers[i]->mutex_);
+        if (buffers[i]->threadName_.empty())
+            continue;
+        file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+             << buffers[i]->thread_ << ",\"args\":{\"name\":\"" << escapeJSON(buffers[i]->threadName_) << "\"}}";
+        first = false;
+    }
+
+    // timestamps and durations in microseconds
+    std::vector<Event> events = getEvents();
+    file << std::fixed << std::setprecision(3);
+    for (size_t i = 0; i < events.size(); ++i) {
+        const Event& event = events[i];
+        file << (first ? "" : ",\n") << "{\"name\":\"" << escapeJSON(event.name_)
+             << "\",\"cat\":\"" << escapeJSON(event.category_)
+             << "\",\"ph\":\"X\",\"ts\":" << event.start_ * 1e6 << ",\"dur\":" << event.duration_ * 1e6
+             << ",\"pid\":1,\"tid\":" << event.thread_ << "}";
+        first = false;
+    }
+    file << std::endl << "]}" << std::endl;
+
+    if (!file.good()) {
+        LERROR("Failed to write trace file: " << filename);
+        return false;
+    }
+    LINFO("Wrote " << events.size() << " events to " << filename);
+    return true;
+}
+
+std::string Profiler::getSummary() {
+    std::vector<Event> events = getEvents();
+
+    std::map<std::string, size_t> indices;
+    std::vector<SpanStatistics> statistics;
+    for (size_t i = 0; i < events.size(); ++i) {
+        const Event& event = events[i];
+        // CPU and GPU time of the same span are listed separately
+        std::string key = event.category_ + "/" + event.name_ + (event.thread_ == gpuThread ? "/gpu" : "");
+        std::map<std::string, size_t>::iterator it = indices.find(key);
+        if (it == indices.end()) {
+            SpanStatistics stats;
+            stats.name_ = event.name_ + (event.thread_ == gpuThread ? " [GPU]" : "");
+            stats.category_ = event.category_;
+            stats.count_ = 0;
+            stats.total_ = 0.0;
+            stats.min_ = event.duration_;
+            stats.max_ = event.duration_;
+            it = indices.insert(std::make_pair(key, statistics.size())).first;
+            statistics.push_back(stats);
+        }
+        SpanStatistics& stats = statistics[it->second];
+        stats.count_++;
+        stats.total_ += event.duration_;
+        if (event.duration_ < stats.min_)
+            stats.min_ = event.duration_;
+        if (event.duration_ > stats.max_)
+            stats.max_ = event.duration_;
+    }
+    std::sort(statistics.begin(), statistics.end(), statisticsTotalGreater);
+
+    // times in milliseconds
+    std::ostringstream summary;
+    summary << std::left << std::setw(48) << "span" << std::setw(12) << "category" << std::right
+            << std::setw(8) << "count" << std::setw(12) << "total" << std::setw(12) << "mean"
+            << std::setw(12) << "min" << std::setw(12) << "max" << std::endl;
+    summary << std::fixed << std::setprecision(3);
+    for (size_t i = 0; i < statistics.size(); ++i) {
+        const SpanStatistics& stats = statistics[i];
+        summary << std::left << std::setw(48) << stats.name_ << std::setw(12) << stats.category_ << std::right
+                << std::setw(8) << stats.count_ << std::setw(12) << stats.total_ * 1e3
+                << std::setw(12) << stats.total_ * 1e3 / stats.count_ << std::setw(12) << stats.min_ * 1e3
+                << std::setw(12) << stats.max_ * 1e3 << std::endl;
+    }
+    return summary.str();
+}
+
+//----------------------------------------------------------------
+
+TraceSpan::TraceSpan(const std::string& name, const std::string& category)
+    : start_(-1.0)
+{
+    if (Profiler::isEnabled()) {
+        name_ = name;
+        category_ = category;
+        start_ = Profiler::now();
+    }
+}
+
+TraceSpan::~TraceSpan() {
+    if (start_ >= 0.0)
+        Profiler::addEvent(name_, category_, start_, Profiler::now() - start_);
+}
+
+//----------------------------------------------------------------
+
+GLTraceSpan::GLTraceSpan(const std::string& name, const std::string& category)
+    : active_(false)
+{
+    if (Profiler::isEnabled() && Profiler::isGLTimingEnabled()) {
+        name_ = name;
+        category_ = category;
+        glGenQueries(2, queries_);
+        glQueryCounter(queries_[0], GL_TIMESTAMP);
+        active_ = true;
+    }
+}
+
+GLTraceSpan::~GLTraceSpan() {
+    if (active_) {
+        glQueryCounter(queries_[1], GL_TIMESTAMP);
+        Profiler::addGLQuery(name_, category_, queries_[0], queries_[1]);
+    }
+}
+
 } // namespace
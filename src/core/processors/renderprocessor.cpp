@@ -34,6 +34,7 @@
 #include "tgt/gpucapabilities.h"
 
 #include "voreen/core/network/networkevaluator.h"
+#include "voreen/core/voreenapplication.h"
 
 #include "voreen/core/properties/cameraproperty.h"
 
@@ -172,6 +173,10 @@ void RenderProcessor::beforeProcess() {
 }
 
 void RenderProcessor::manageRenderTargets() {
+    // render targets cannot be created without an OpenGL context
+    if (!VoreenApplication::app() || !VoreenApplication::app()->isInitializedGL())
+        return;
+
     const std::vector<Port*> outports = getOutports();
     for (size_t i=0; i<outports.size(); ++i) {
         RenderPort* rp = dynamic_cast<RenderPort*>(outports[i]);
@@ -27,6 +27,13 @@
  **********************************************************************/
 
 #include "voreen/core/processors/volumeprocessor.h"
+#include "voreen/core/datastructures/volume/volume.h"
+#include "voreen/core/io/progressbar.h"
+#include "voreen/core/voreenapplication.h"
+
+#include "tgt/event/timeevent.h"
+
+#include <algorithm>
 
 namespace voreen {
 
@@ -100,4 +107,243 @@ void CachingVolumeProcessor::clearCache() {
     cache_.clearCache();
 }
 
+//------------------------------------------------------------------------
+
+AsyncVolumeProcessor::Job::Job()
+    : BackgroundThread()
+    , result_(0)
+    , progressBar_(0)
+{}
+
+AsyncVolumeProcessor::Job::~Job() {
+    join();
+    delete result_;
+    for (size_t i = 0; i < inputCopies_.size(); ++i)
+        delete inputCopies_[i];
+}
+
+size_t AsyncVolumeProcessor::Job::addInput(const VolumeHandleBase* input) {
+    inputs_.push_back(input);
+    return inputs_.size() - 1;
+}
+
+void AsyncVolumeProcessor::Job::copyInputs() {
+    for (size_t i = 0; i < inputs_.size(); ++i) {
+        const Volume* volume = inputs_[i] ? inputs_[i]->getRepresentation<Volume>() : 0;
+        if (!volume)
+            continue;
+        VolumeHandle* copy = new VolumeHandle(volume->clone(), inputs_[i]);
+        inputCopies_.push_back(copy);
+        inputs_[i] = copy;
+    }
+}
+
+const VolumeHandleBase* AsyncVolumeProcessor::Job::getInput(size_t index) const {
+    tgtAssert(index < inputs_.size(), "invalid input index");
+    return inputs_[index];
+}
+
+VolumeHandle* AsyncVolumeProcessor::Job::takeInputCopy(size_t index) {
+    tgtAssert(index < inputs_.size(), "invalid input index");
+    std::vector<VolumeHandle*>::iterator it = std::find(inputCopies_.begin(), inputCopies_.end(), inputs_[index]);
+    if (it == inputCopies_.end())
+        return 0;
+    VolumeHandle* copy = *it;
+    inputCopies_.erase(it);
+    return copy;
+}
+
+VolumeHandle* AsyncVolumeProcessor::Job::takeResult() {
+    VolumeHandle* result = result_;
+    result_ = 0;
+    return result;
+}
+
+std::string AsyncVolumeProcessor::Job::getErrorMessage() const {
+    return errorMessage_;
+}
+
+void AsyncVolumeProcessor::Job::setProgressBar(ProgressBar* progressBar) {
+    progressBar_ = progressBar;
+}
+
+void AsyncVolumeProcessor::Job::run() {
+    try {
+        result_ = compute();
+    }
+    catch (std::exception& e) {
+        errorMessage_ = e.what();
+    }
+
+    if (isInterrupted()) {
+        delete result_;
+        result_ = 0;
+    }
+}
+
+void AsyncVolumeProcessor::Job::setProgress(float progress) {
+    BackgroundThread::setProgress(progress);
+    if (progressBar_)
+        progressBar_->setProgress(progress);
+}
+
+//------------------------------------------------------------------------
+
+const std::string AsyncVolumeProcessor::loggerCat_("voreen.AsyncVolumeProcessor");
+
+AsyncVolumeProcessor::AsyncVolumeProcessor()
+    : CachingVolumeProcessor()
+    , computeInBackground_("computeInBackground", "Compute in Background", true, VALID)
+    , job_(0)
+    , timer_(0)
+    , eventHandler_()
+{
+    addProperty(computeInBackground_);
+
+    eventHandler_.addListenerToBack(this);
+}
+
+AsyncVolumeProcessor::~AsyncVolumeProcessor() {
+    delete timer_;
+    cancelComputation();
+    cleanupCancelledJobs(true);
+}
+
+void AsyncVolumeProcessor::initialize() throw (tgt::Exception) {
+    CachingVolumeProcessor::initialize();
+
+    // not created by the constructor, since processors are also instantiated as prototypes
+    if (VoreenApplication::app())
+        timer_ = VoreenApplication::app()->createTimer(&eventHandler_);
+}
+
+void AsyncVolumeProcessor::deinitialize() throw (tgt::Exception) {
+    if (timer_)
+        timer_->stop();
+    cancelComputation();
+    cleanupCancelledJobs(true);
+    delete timer_;
+    timer_ = 0;
+
+    CachingVolumeProcessor::deinitialize();
+}
+
+void AsyncVolumeProcessor::beforeProcess() {
+    if (job_ && job_->isFinished())
+        finishComputation();
+
+    CachingVolumeProcessor::beforeProcess();
+
+    // output has been restored from the cache: the running computation is obsolete
+    if (job_ && isValid())
+        cancelComputation();
+}
+
+void AsyncVolumeProcessor::afterProcess() {
+    if (job_) {
+        // the outport still holds the previous result, which must not be cached for the current state
+        VolumeProcessor::afterProcess();
+        if (timer_ && timer_->isStopped())
+            timer_->start(50);
+    }
+    else {
+        CachingVolumeProcessor::afterProcess();
+    }
+}
+
+void AsyncVolumeProcessor::timerEvent(tgt::TimeEvent* e) {
+    cleanupCancelledJobs(false);
+
+    if (!job_) {
+        if (cancelledJobs_.empty())
+            timer_->stop();
+    }
+    else if (!job_->isFinished()) {
+        setProgress(job_->getProgress());
+    }
+    else {
+        if (cancelledJobs_.empty())
+            timer_->stop();
+        setProgress(1.f);
+        // result is assigned during the next network evaluation
+        invalidate();
+    }
+
+    if (e)
+        e->accept();
+}
+
+void AsyncVolumeProcessor::startComputation() {
+    cancelComputation();
+
+    Job* job = createJob();
+    if (!job) {
+        setResult(0);
+        return;
+    }
+
+    if (computeInBackground_.get() && timer_) {
+        try {
+            job->copyInputs();
+            job->start();
+            job_ = job;
+            setProgress(0.f);
+            return;
+        }
+        catch (std::exception& e) {
+            LWARNING("Failed to start computation in background, computing synchronously: " << e.what());
+        }
+    }
+
+    // synchronous computation
+    VolumeHandle* result = 0;
+    job->setProgressBar(progressBar_);
+    try {
+        result = job->compute();
+    }
+    catch (std::exception& e) {
+        LERROR("Computation failed: " << e.what());
+    }
+    delete job;
+    setResult(result);
+}
+
+void AsyncVolumeProcessor::cancelComputation() {
+    if (!job_)
+        return;
+
+    job_->interrupt();
+    cancelledJobs_.push_back(job_);
+    job_ = 0;
+}
+
+bool AsyncVolumeProcessor::isComputing() const {
+    return (job_ != 0);
+}
+
+void AsyncVolumeProcessor::finishComputation() {
+    tgtAssert(job_ && job_->isFinished(), "no finished job");
+
+    Job* job = job_;
+    job_ = 0;
+    if (!job->getErrorMessage().empty())
+        LERROR("Computation failed: " << job->getErrorMessage());
+    VolumeHandle* result = job->takeResult();
+    delete job;
+    setResult(result);
+}
+
+void AsyncVolumeProcessor::cleanupCancelledJobs(bool wait) {
+    std::vector<Job*> running;
+    for (size_t i = 0; i < cancelledJobs_.size(); ++i) {
+        if (wait)
+            cancelledJobs_[i]->join();
+        if (cancelledJobs_[i]->isFinished())
+            delete cancelledJobs_[i];
+        else
+            running.push_back(cancelledJobs_[i]);
+    }
+    cancelledJobs_ = running;
+}
+
 }   // namespace
@@ -27,6 +27,7 @@
  **********************************************************************/
 
 #include "voreen/core/processors/volumeraycaster.h"
+#include "voreen/core/datastructures/transfunc/preintegrationtable.h"
 #include "voreen/core/utils/voreenpainter.h"
 
 #include "tgt/vector.h"
@@ -56,6 +57,7 @@ VolumeRaycaster::VolumeRaycaster()
     , useInterpolationCoarseness_("interpolation.coarseness","Use Interpolation Coarseness", false, Processor::INVALID_PROGRAM)
     , size_(128, 128)
     , switchToInteractionMode_(false)
+    , samplingStepSize_(0.f)
 {
     initProperties();
 }
@@ -83,6 +85,8 @@ std::string VolumeRaycaster::generateHeader(const tgt::GpuCapabilities::GlVersio
         headerSource += "voxel;\n";
     else if (classificationMode_.isSelected("transfer-function"))
         headerSource += "applyTF(transferFunc, voxel);\n";
+    else if (classificationMode_.isSelected("pre-integrated"))
+        headerSource += "applyPreIntegratedTF(transferFunc, voxel);\n#define RC_PREINTEGRATION\n";
 
     // configure shading mode
     headerSource += "#define RC_APPLY_SHADING(gradient, samplePos, volumeStruct, ka, kd, ks) ";
@@ -285,6 +289,7 @@ void VolumeRaycaster::bindVolumes(tgt::Shader* shader, const std::vector<VolumeS
 
             shader->setUniform("samplingStepSize_", samplingStepSize);
             shader->setUniform("samplingRate_", samplingRate);
+            samplingStepSize_ = samplingStepSize;
             
             LGL_ERROR;
         }
@@ -292,4 +297,21 @@ void VolumeRaycaster::bindVolumes(tgt::Shader* shader, const std::vector<VolumeS
     shader->setIgnoreUniformLocationError(false);
 }
 
+void VolumeRaycaster::bindPreIntegrationTable(tgt::Shader* shader, TransFunc* transFunc, tgt::TextureUnit& unit) {
+    if (!classificationMode_.isSelected("pre-integrated"))
+        return;
+
+    TransFuncIntensity* tfi = dynamic_cast<TransFuncIntensity*>(transFunc);
+    if (!tfi) {
+        LWARNING("Pre-integrated classification requires a 1D transfer function");
+        return;
+    }
+
+    PreIntegrationTable* table = tfi->getPreIntegrationTable(samplingStepSize_);
+    unit.activate();
+    table->getTexture()->bind();
+    shader->setUniform("preIntegrationTable_", unit.getUnitNumber());
+    LGL_ERROR;
+}
+
 } // namespace voreen
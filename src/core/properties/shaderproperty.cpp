@@ -349,7 +349,6 @@ void ShaderProperty::rebuild() {
     geom_ = 0;
 
     shader_ = new tgt::Shader();
-    //bool failedCompile = false;
 
     if (!value_.vertexFilename_.empty()) {
         vert_ = new tgt::ShaderObject(value_.vertexFilename_, tgt::ShaderObject::VERTEX_SHADER);
@@ -361,13 +360,7 @@ void ShaderProperty::rebuild() {
         else {
             vert_->setSource(value_.vertexSource_);
         }
-        vert_->compileShader();
-        if (vert_->isCompiled())
-            shader_->attachObject(vert_);
-        else {
-            //failedCompile = true;
-            LWARNINGC("voreen.ShaderProperty", "Failed to compile vertex shader: " << vert_->getCompilerLog());
-        }
+        shader_->attachObject(vert_);
     }
 
     if (!value_.fragmentFilename_.empty()) {
@@ -380,13 +373,7 @@ void ShaderProperty::rebuild() {
         else {
             frag_->setSource(value_.fragmentSource_);
         }
-        frag_->compileShader();
-        if (frag_->isCompiled())
-            shader_->attachObject(frag_);
-        else {
-            //failedCompile = true;
-            LWARNINGC("voreen.ShaderProperty", "Failed to compile fragment shader: " << frag_->getCompilerLog());
-        }
+        shader_->attachObject(frag_);
     }
 
     if (!value_.geometryFilename_.empty()) {
@@ -399,21 +386,12 @@ void ShaderProperty::rebuild() {
         else {
             geom_->setSource(value_.geometrySource_);
         }
-        geom_->compileShader();
-        if (geom_->isCompiled())
-            shader_->attachObject(geom_);
-        else {
-            //failedCompile = true;
-            LWARNINGC("voreen.ShaderProperty", "Failed to compile geometry shader: " << geom_->getCompilerLog());
-        }
+        shader_->attachObject(geom_);
     }
 
-    //if(!failedCompile) {
-        shader_->linkProgram();
-        if(!shader_->isLinked()) {
-            LWARNINGC("voreen.ShaderProperty", "Failed to link shader: " << shader_->getLinkerLog());
-        }
-    //}
+    // compiles and links the objects, unless the program binary is cached
+    if (!shader_->rebuild())
+        LWARNINGC("voreen.ShaderProperty", "Failed to build shader");
 
     updateWidgets();
 }
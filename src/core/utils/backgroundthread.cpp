@@ -0,0 +1,163 @@
+/**********************************************************************
+ *                                                                    *
+ * Voreen - The Volume Rendering Engine                               *
+ *                                                                    *
+ * Created between 2005 and 2012 by The Voreen Team                   *
+ * as listed in CREDITS.TXT <http://www.voreen.org>                   *
+ *                                                                    *
+ * This file is part of the Voreen software package. Voreen is free   *
+ * software: you can redistribute it and/or modify it under the terms *
+ * of the GNU General Public License version 2 as published by the    *
+ * Free Software Foundation.                                          *
+ *                                                                    *
+ * Voreen is distributed in the hope that it will be useful,          *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of     *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the       *
+ * GNU General Public License for more details.                       *
+ *                                                                    *
+ * You should have received a copy of the GNU General Public License  *
+ * in the file "LICENSE.txt" along with this program.                 *
+ * If not, see <http://www.gnu.org/licenses/>.                        *
+ *                                                                    *
+ * The authors reserve all rights not expressly granted herein. For   *
+ * non-commercial academic use see the license exception specified in *
+ * the file "LICENSE-academic.txt". To get information about          *
+ * commercial licensing please contact the authors.                   *
+ *                                                                    *
+ **********************************************************************/
+
+#include "voreen/core/utils/backgroundthread.h"
+#include "voreen/core/processors/profiling.h"
+
+#include "tgt/logmanager.h"
+#include "tgt/assert.h"
+#include "tgt/mutex.h"
+
+#ifdef WIN32
+#include <windows.h>
+#include <process.h>
+#else
+#include <pthread.h>
+#endif
+
+namespace voreen {
+
+const std::string BackgroundThread::loggerCat_("voreen.BackgroundThread");
+
+#ifdef WIN32
+
+struct BackgroundThread::ThreadData {
+    HANDLE handle;
+    tgt::Mutex mutex;
+
+    ThreadData() : handle(0) {}
+};
+
+unsigned __stdcall BackgroundThread::win32ThreadEntry(void* thread) {
+    threadEntry(thread);
+    return 0;
+}
+
+#else
+
+struct BackgroundThread::ThreadData {
+    pthread_t handle;
+    tgt::Mutex mutex;
+};
+
+#endif
+
+BackgroundThread::BackgroundThread()
+    : data_(new ThreadData())
+    , started_(false)
+    , joined_(false)
+    , interrupted_(false)
+    , finished_(false)
+    , progress_(0.f)
+{}
+
+BackgroundThread::~BackgroundThread() {
+    if (started_ && !joined_) {
+        interrupt();
+        join();
+    }
+    delete data_;
+}
+
+void BackgroundThread::start() throw (VoreenException) {
+    tgtAssert(!started_, "thread already started");
+
+#ifdef WIN32
+    data_->handle = reinterpret_cast<HANDLE>(_beginthreadex(0, 0, &BackgroundThread::win32ThreadEntry, this, 0, 0));
+    if (!data_->handle)
+        throw VoreenException("Failed to create background thread");
+#else
+    if (pthread_create(&data_->handle, 0, &BackgroundThread::threadEntry, this) != 0)
+        throw VoreenException("Failed to create background thread");
+#endif
+    started_ = true;
+}
+
+void BackgroundThread::join() {
+    if (!started_ || joined_)
+        return;
+
+#ifdef WIN32
+    WaitForSingleObject(data_->handle, INFINITE);
+    CloseHandle(data_->handle);
+#else
+    pthread_join(data_->handle, 0);
+#endif
+    joined_ = true;
+}
+
+void BackgroundThread::interrupt() {
+    data_->mutex.lock();
+    interrupted_ = true;
+    data_->mutex.unlock();
+}
+
+bool BackgroundThread::isInterrupted() const {
+    data_->mutex.lock();
+    bool interrupted = interrupted_;
+    data_->mutex.unlock();
+    return interrupted;
+}
+
+bool BackgroundThread::isFinished() const {
+    data_->mutex.lock();
+    bool finished = finished_;
+    data_->mutex.unlock();
+    return finished;
+}
+
+float BackgroundThread::getProgress() const {
+    data_->mutex.lock();
+    float progress = progress_;
+    data_->mutex.unlock();
+    return progress;
+}
+
+void BackgroundThread::setProgress(float progress) {
+    data_->mutex.lock();
+    progress_ = progress;
+    data_->mutex.unlock();
+}
+
+void* BackgroundThread::threadEntry(void* thread) {
+    BackgroundThread* t = static_cast<BackgroundThread*>(thread);
+    try {
+        TraceSpan span("BackgroundThread::run", "background");
+        t->run();
+    }
+    catch (std::exception& e) {
+        LERROR("Uncaught exception in background thread: " << e.what());
+    }
+
+    t->data_->mutex.lock();
+    t->finished_ = true;
+    t->data_->mutex.unlock();
+    return 0;
+}
+
+} // namespace
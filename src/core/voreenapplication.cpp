@@ -36,6 +36,7 @@
 #include "voreen/core/processors/processor.h"
 #include "voreen/core/processors/processorwidget.h"
 #include "voreen/core/processors/processorwidgetfactory.h"
+#include "voreen/core/processors/profiling.h"
 #include "voreen/core/properties/property.h"
 #include "voreen/core/properties/propertywidget.h"
 #include "voreen/core/properties/propertywidgetfactory.h"
@@ -221,6 +222,10 @@ void VoreenApplication::prepareCommandParser() {
     cmdParser_.addCommand(new SingleCommand<std::string>(&overrideGLSLVersion_,
         "--glslVersion", "",
         "Overrides the detected GLSL version", "<1.10|1.20|1.30|1.40|1.50|3.30|4.00>"));
+
+    cmdParser_.addCommand(new SingleCommand<std::string>(&traceFile_,
+        "--trace", "",
+        "Records a trace of the network evaluation and writes it to the passed file in the Chrome trace format", "<filename>"));
 }
 
 void VoreenApplication::initialize() {
@@ -236,6 +241,11 @@ void VoreenApplication::initialize() {
     prepareCommandParser();
     cmdParser_.execute();
 
+    if (!traceFile_.empty()) {
+        Profiler::setEnabled(true);
+        Profiler::setThreadName("main");
+    }
+
     //
     // tgt initialization
     //
@@ -381,6 +391,12 @@ void VoreenApplication::deinitialize() {
     delete schedulingTimer_;
     schedulingTimer_ = 0;
 
+    if (!traceFile_.empty()) {
+        Profiler::setEnabled(false);
+        Profiler::writeChromeTrace(traceFile_);
+        LINFO("Trace summary (times in ms):\n" << Profiler::getSummary());
+    }
+
     // clear modules
     LDEBUG("Deleting modules ...");
     for (int i=(int)modules_.size()-1; i>=0; i--) {
@@ -425,6 +441,10 @@ void VoreenApplication::initializeGL() throw (VoreenException) {
 #endif
     ShdrMgr.addPath(getShaderPath());
     ShdrMgr.addPath(getShaderPath("utils"));
+    ShdrMgr.setProgramCachePath(getCachePath("shaders"));
+
+    if (Profiler::isEnabled())
+        Profiler::setGLTimingEnabled(true);
 
     // initialize modules
     for (size_t i=0; i<modules_.size(); i++) {
@@ -450,6 +470,10 @@ void VoreenApplication::initializeGL() throw (VoreenException) {
     initializedGL_ = true;
 }
 
+bool VoreenApplication::isInitializedGL() const {
+    return initializedGL_;
+}
+
 void VoreenApplication::deinitializeGL() throw (VoreenException) {
 
     if (!initializedGL_) {
@@ -482,6 +506,10 @@ void VoreenApplication::deinitializeGL() throw (VoreenException) {
         }
     }
 
+    // resolve the pending timer queries while the context is still available
+    if (Profiler::isGLTimingEnabled())
+        Profiler::setGLTimingEnabled(false);
+
     LDEBUG("tgt::deinitGL");
     tgt::deinitGL();
 
@@ -74,6 +74,8 @@ win64-msvc { # win 64 bit configuration
 
 unix {
     LIBS += -ltgt
+    LIBS += -lpthread
+    !macx: LIBS += -lrt
 }
 
 macx {
@@ -188,6 +190,7 @@ SOURCES += \
     animation/interpolation/volumecollectioninterpolationfunctions.cpp \
     animation/interpolation/volumehandleinterpolationfunctions.cpp
 SOURCES += \
+    datastructures/cachedimagesequence.cpp \
     datastructures/datetime.cpp \
     datastructures/imagesequence.cpp \
     datastructures/rendertarget.cpp \
@@ -197,10 +200,12 @@ SOURCES += \
     datastructures/geometry/meshgeometry.cpp \
     datastructures/geometry/meshlistgeometry.cpp \
     datastructures/geometry/vertexgeometry.cpp \
+    datastructures/transfunc/preintegrationtable.cpp \
     datastructures/transfunc/transfunc.cpp \
     datastructures/transfunc/transfuncfactory.cpp \
     datastructures/transfunc/transfuncintensity.cpp \
     datastructures/transfunc/transfuncintensitygradient.cpp \
+    datastructures/transfunc/transfunclookuptable.cpp \
     datastructures/transfunc/transfuncmappingkey.cpp \
     datastructures/transfunc/transfuncprimitive.cpp \
     datastructures/volume/gradient.cpp \
@@ -219,6 +224,7 @@ SOURCES += \
     datastructures/volume/volumehandledecorator.cpp \
     datastructures/volume/volumehash.cpp \
     datastructures/volume/volumerepresentation.cpp \
+    datastructures/volume/volumestatistics.cpp \
     datastructures/volume/volumetexture.cpp 
 
 SOURCES += \
@@ -246,7 +252,9 @@ SOURCES += \
     io/volumereader.cpp \
     io/volumeserializer.cpp \
     io/volumeserializerpopulator.cpp \
+    io/volumeslabwriter.cpp \
     io/volumewriter.cpp \
+    io/volumewritejob.cpp \
     io/vvdformat.cpp \
     io/vvdvolumereader.cpp \
     io/vvdvolumewriter.cpp \
@@ -267,6 +275,7 @@ SOURCES += \
     network/networkevaluator.cpp \
     network/networkgraph.cpp \
     network/networkserializer.cpp \
+    network/parametersweep.cpp \
     network/portconnection.cpp \
     network/processornetwork.cpp \
     network/processornetworkobserver.cpp \
@@ -334,6 +343,7 @@ SOURCES += \
     properties/link/linkevaluatoridnormalized.cpp \
     properties/link/propertylink.cpp
 SOURCES += \
+    utils/backgroundthread.cpp \
     utils/glsl.cpp \
     utils/hashing.cpp \
     utils/observer.cpp \
@@ -453,6 +463,7 @@ HEADERS += \
     ../../include/voreen/core/animation/interpolation/volumecollectioninterpolationfunctions.h \
     ../../include/voreen/core/animation/interpolation/volumehandleinterpolationfunctions.h
 HEADERS += \
+    ../../include/voreen/core/datastructures/cachedimagesequence.h \
     ../../include/voreen/core/datastructures/datetime.h \
     ../../include/voreen/core/datastructures/imagesequence.h \
     ../../include/voreen/core/datastructures/rendertarget.h \
@@ -467,10 +478,12 @@ HEADERS += \
     ../../include/voreen/core/datastructures/geometry/pointsegmentlistgeometry.h \
     ../../include/voreen/core/datastructures/geometry/scalargeometry.h \
     ../../include/voreen/core/datastructures/geometry/vertexgeometry.h \
+    ../../include/voreen/core/datastructures/transfunc/preintegrationtable.h \
     ../../include/voreen/core/datastructures/transfunc/transfunc.h \
     ../../include/voreen/core/datastructures/transfunc/transfuncfactory.h \
     ../../include/voreen/core/datastructures/transfunc/transfuncintensity.h \
     ../../include/voreen/core/datastructures/transfunc/transfuncintensitygradient.h \
+    ../../include/voreen/core/datastructures/transfunc/transfunclookuptable.h \
     ../../include/voreen/core/datastructures/transfunc/transfuncmappingkey.h \
     ../../include/voreen/core/datastructures/transfunc/transfuncprimitive.h \
     ../../include/voreen/core/datastructures/volume/gradient.h \
@@ -492,6 +505,7 @@ HEADERS += \
     ../../include/voreen/core/datastructures/volume/volumehash.h \
     ../../include/voreen/core/datastructures/volume/volumeoperator.h \
     ../../include/voreen/core/datastructures/volume/volumerepresentation.h \
+    ../../include/voreen/core/datastructures/volume/volumestatistics.h \
     ../../include/voreen/core/datastructures/volume/volumetexture.h \
     ../../include/voreen/core/datastructures/volume/operators/volumeoperatorcalcerror.h \
     ../../include/voreen/core/datastructures/volume/operators/volumeoperatorconvert.h \
@@ -536,7 +550,9 @@ HEADERS += \
     ../../include/voreen/core/io/volumereader.h \
     ../../include/voreen/core/io/volumeserializer.h \
     ../../include/voreen/core/io/volumeserializerpopulator.h \
+    ../../include/voreen/core/io/volumeslabwriter.h \
     ../../include/voreen/core/io/volumewriter.h \
+    ../../include/voreen/core/io/volumewritejob.h \
     ../../include/voreen/core/io/vvdformat.h \
     ../../include/voreen/core/io/vvdvolumereader.h \
     ../../include/voreen/core/io/vvdvolumewriter.h \
@@ -567,6 +583,7 @@ HEADERS += \
     ../../include/voreen/core/network/networkevaluator.h \
     ../../include/voreen/core/network/networkgraph.h \
     ../../include/voreen/core/network/networkserializer.h \
+    ../../include/voreen/core/network/parametersweep.h \
     ../../include/voreen/core/network/portconnection.h \
     ../../include/voreen/core/network/processornetwork.h \
     ../../include/voreen/core/network/processornetworkobserver.h \
@@ -648,6 +665,7 @@ HEADERS += \
     ../../include/voreen/core/properties/link/linkevaluatoridnormalized.h \
     ../../include/voreen/core/properties/link/propertylink.h
 HEADERS += \
+    ../../include/voreen/core/utils/backgroundthread.h \
     ../../include/voreen/core/utils/exception.h \
     ../../include/voreen/core/utils/glsl.h \
     ../../include/voreen/core/utils/hashing.h \
@@ -36,6 +36,7 @@
 #include <QScrollBar>
 #include <QMenu>
 #include <QSettings>
+#include <QThread>
 
 namespace voreen {
 
@@ -180,11 +181,21 @@ void ConsolePlugin::disableToggled(){
 }
 
 void ConsolePlugin::log(const std::string& msg) {
+    // messages logged by background threads are passed to the GUI thread,
+    // since the text box must only be accessed by it
+    if (QThread::currentThread() != thread()) {
+        QMetaObject::invokeMethod(this, "appendMessage", Qt::QueuedConnection, Q_ARG(QString, QString(msg.c_str())));
+        return;
+    }
+    appendMessage(msg.c_str());
+}
+
+void ConsolePlugin::appendMessage(const QString& msg) {
     if (disableAction_->isChecked())
         return;
 
     // write log message to text box
-    consoleText_->append(msg.c_str());
+    consoleText_->append(msg);
 
     // scroll to bottom
     if (autoScroll_ && isVisible()) {
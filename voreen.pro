@@ -13,6 +13,7 @@ contains(VRN_PROJECTS, core):     SUBDIRS += sub_core
 contains(VRN_PROJECTS, qt):       SUBDIRS += sub_qt
 contains(VRN_PROJECTS, voreenve): SUBDIRS += sub_voreenve
 contains(VRN_PROJECTS, voltool):  SUBDIRS += sub_voltool
+contains(VRN_PROJECTS, voreenbatch):  SUBDIRS += sub_voreenbatch
 contains(VRN_PROJECTS, simple-qt):  SUBDIRS += sub_simple-qt
 contains(VRN_PROJECTS, simple-glut):  SUBDIRS += sub_simple-glut
 contains(VRN_PROJECTS, sgct-client): SUBDIRS += sub_sgct-client
@@ -39,6 +40,9 @@ sub_voreenve.depends = sub_tgt sub_core sub_qt
 sub_voltool.file = apps/voltool/voltool.pro
 sub_voltool.depends = sub_tgt sub_core
 
+sub_voreenbatch.file = apps/voreenbatch/voreenbatch.pro
+sub_voreenbatch.depends = sub_tgt sub_core
+
 sub_simple-qt.file = apps/simple/simple-qt.pro
 sub_simple-qt.depends = sub_tgt sub_core sub_qt
 